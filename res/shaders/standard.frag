@@ -653,6 +653,10 @@ void main()
         light_offset += uint(ERHE_LIGHT_COUNT_SPOT_SHADOWMAPPED);
 
         // Spot - non-shadow suffix
+#if defined(ERHE_USE_CLUSTERED_LIGHTS)
+        // Shaded from the cluster light lists below; skip their slots.
+        light_offset += light_cluster.grid.w;
+#else
         for (uint i = 0u; i < uint(ERHE_LIGHT_COUNT_SPOT_NOT_SHADOWMAPPED); ++i) {
             uint  light_index    = light_offset + i;
             Light light          = light_block.lights[light_index];
@@ -667,6 +671,7 @@ void main()
             }
         }
         light_offset += uint(ERHE_LIGHT_COUNT_SPOT_NOT_SHADOWMAPPED);
+#endif
 
         // Point - shadow-mapped prefix. Sample the omnidirectional shadow cube
         // by the fragment->light direction; the cube-array layer for this light
@@ -686,6 +691,36 @@ void main()
         }
         light_offset += uint(ERHE_LIGHT_COUNT_POINT_SHADOWMAPPED);
 
+#if defined(ERHE_USE_CLUSTERED_LIGHTS)
+        // Non-shadow spot and point lights of this fragment's cluster. Same
+        // cluster lookup as erhe::scene_renderer::Light_clusters::find_cluster().
+        uvec3 cluster_grid = light_cluster.grid.xyz;
+        if (cluster_grid.x != 0u) {
+            vec4  cluster_clip   = light_cluster.clip_from_world * vec4(v_position.xyz, 1.0);
+            vec2  cluster_ndc    = cluster_clip.xy / cluster_clip.w;
+            float cluster_depth  = max(dot(light_cluster.depth_plane, vec4(v_position.xyz, 1.0)), light_cluster.slice_params.x);
+            vec2  cluster_tile   = clamp(floor((cluster_ndc * 0.5 + 0.5) * vec2(cluster_grid.xy)), vec2(0.0), vec2(cluster_grid.xy) - 1.0);
+            float cluster_slice  = clamp(floor(log(cluster_depth) * light_cluster.slice_params.y + light_cluster.slice_params.z), 0.0, float(cluster_grid.z) - 1.0);
+            uint  cluster_index  = (uint(cluster_slice) * cluster_grid.y + uint(cluster_tile.y)) * cluster_grid.x + uint(cluster_tile.x);
+            uint  cluster_offset = light_cluster.data[2u * cluster_index];
+            uint  cluster_count  = light_cluster.data[2u * cluster_index + 1u];
+            for (uint i = 0u; i < cluster_count; ++i) {
+                uint  packed_index   = light_cluster.data[cluster_offset + i];
+                Light light          = light_block.lights[packed_index & 0x7fffffffu];
+                vec3  point_to_light = light.position_and_inner_spot_cos.xyz - v_position.xyz;
+                vec3  L              = normalize(point_to_light);
+                float N_dot_L        = dot(N, L);
+                if (N_dot_L > 0.0) {
+                    float range_attenuation = get_range_attenuation(light.radiance_and_range.w, length(point_to_light));
+                    float spot_attenuation  = ((packed_index & 0x80000000u) != 0u)
+                        ? get_spot_attenuation(-point_to_light, light.direction_and_outer_spot_cos.xyz, light.direction_and_outer_spot_cos.w, light.position_and_inner_spot_cos.w)
+                        : 1.0;
+                    vec3  intensity         = range_attenuation * spot_attenuation * light.radiance_and_range.rgb;
+                    color += intensity * BXDF_CALL(L);
+                }
+            }
+        }
+#else
         // Point - non-shadow suffix
         for (uint i = 0u; i < uint(ERHE_LIGHT_COUNT_POINT_NOT_SHADOWMAPPED); ++i) {
             uint  light_index    = light_offset + i;
@@ -699,6 +734,7 @@ void main()
                 color += intensity * BXDF_CALL(L);
             }
         }
+#endif
 
         } // !lightmap_valid - analytic lights gated off for lightmapped draws
 #  undef BXDF_CALL
@@ -765,7 +801,8 @@ void main()
         // First light is used as the L direction for V/L/H dot-product
         // visualizations and for the shadow-map texel pattern. Skipped
         // when no light is configured.
-#  if ((ERHE_LIGHT_COUNT_DIRECTIONAL_SHADOWMAPPED + \
+#  if defined(ERHE_USE_CLUSTERED_LIGHTS) || \
+     ((ERHE_LIGHT_COUNT_DIRECTIONAL_SHADOWMAPPED + \
         ERHE_LIGHT_COUNT_DIRECTIONAL_NOT_SHADOWMAPPED + \
         ERHE_LIGHT_COUNT_SPOT_SHADOWMAPPED + \
         ERHE_LIGHT_COUNT_SPOT_NOT_SHADOWMAPPED + \
@@ -93,6 +93,7 @@ void set_keyframe_value(
     const erhe::scene::Animation_channel& channel = animation.channels.at(channel_index);
     erhe::scene::Animation_sampler&       sampler = animation.samplers.at(channel.sampler_index);
     sampler.data.at(get_key_value_index(animation, channel_index, key_index, component)) = value;
+    animation.mark_data_changed();
 }
 
 auto set_keyframe_time(
@@ -216,6 +217,7 @@ void reset_channel_seek_state(erhe::scene::Animation& animation)
     for (erhe::scene::Animation_channel& channel : animation.channels) {
         channel.start_position = 0;
     }
+    animation.mark_data_changed();
 }
 
 auto is_component_animated(
@@ -347,6 +349,7 @@ auto ensure_channel(
         sampler.data.push_back(value[static_cast<glm::vec4::length_type>(component)]);
     }
     animation.samplers.push_back(std::move(sampler));
+    animation.mark_data_changed();
 
     animation.channels.push_back(
         erhe::scene::Animation_channel{
@@ -89,7 +89,8 @@ auto delete_keyframe(
     std::size_t             key_index
 ) -> bool;
 
-// Resets the cached seek position of every channel; must be called after any
+// Resets the cached seek position of every channel and marks the animation
+// data changed (compiled playback copies rebuild); must be called after any
 // edit that changes key count or ordering.
 void reset_channel_seek_state(erhe::scene::Animation& animation);
 
@@ -7,6 +7,7 @@
 
 #include "erhe_profile/profile.hpp"
 #include "erhe_scene/animation.hpp"
+#include "erhe_scene/compiled_animation.hpp"
 #include "erhe_scene/node.hpp"
 #include "erhe_scene/scene.hpp"
 
@@ -29,6 +30,8 @@ Animation_player::Animation_player(App_context& context, App_message_bus& app_me
     );
 }
 
+Animation_player::~Animation_player() noexcept = default;
+
 void Animation_player::on_items_removed(const Removed_items& removed)
 {
     // The played animation left the editor (undo of its import, or its
@@ -98,6 +101,7 @@ void Animation_player::set_animation(const std::shared_ptr<erhe::scene::Animatio
         return;
     }
     m_animation = animation;
+    m_instance  = m_animation ? std::make_unique<erhe::scene::Animation_instance>(m_animation) : nullptr;
     m_playing   = false;
     refresh_time_range();
     // Keep the playhead where it is (the timeline range is independent of the
@@ -246,7 +250,8 @@ void Animation_player::apply()
         return;
     }
 
-    m_animation->apply(m_time);
+    m_instance->set_time(m_time);
+    m_instance->apply();
 
     m_context.app_message_bus->animation_update.send_message(Animation_update_message{});
 
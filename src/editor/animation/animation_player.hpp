@@ -8,7 +8,7 @@
 #include <memory>
 
 namespace erhe        { class Item_host; }
-namespace erhe::scene { class Animation; }
+namespace erhe::scene { class Animation; class Animation_instance; }
 
 namespace editor {
 
@@ -27,6 +27,7 @@ class Animation_player
 {
 public:
     Animation_player(App_context& context, App_message_bus& app_message_bus);
+    ~Animation_player() noexcept;
 
     // Called once per frame from Editor::tick() with the wall-clock frame
     // duration in seconds.
@@ -86,7 +87,9 @@ private:
     erhe::message_bus::Subscription<Close_scene_message>   m_close_scene_subscription;
     erhe::message_bus::Subscription<Items_removed_message> m_items_removed_subscription;
 
-    std::shared_ptr<erhe::scene::Animation> m_animation;
+    std::shared_ptr<erhe::scene::Animation>          m_animation;
+    // Compiled playback state of m_animation; recompiles itself after edits.
+    std::unique_ptr<erhe::scene::Animation_instance> m_instance;
 
     Autokey_mode m_autokey_mode{Autokey_mode::off};
 
@@ -32,6 +32,7 @@ namespace erhe::scene_renderer {
 }
 namespace erhe::commands { class Commands; }
 namespace erhe::frame_pacing { class Frame_pacing_observer; }
+namespace erhe::scheduler { class Scheduler; }
 namespace erhe::window { class Context_window; }
 
 namespace tf {
@@ -110,6 +111,7 @@ class Scale_tool;
 class Scene_builder;
 class Scene_commands;
 class Scene_commit_queue;
+class Scene_save_queue;
 class Bone_visualization;
 class Weight_display;
 class Weight_paint_tool;
@@ -163,11 +165,16 @@ public:
     Editor_settings_config* editor_settings      {nullptr};
 
     tf::Executor*                           executor              {nullptr};
+    // Priority lanes and per-frame accounting on executor; asset loads and
+    // other background work go through its e_background lane.
+    erhe::scheduler::Scheduler*             scheduler             {nullptr};
     std::atomic_int                         pending_async_ops     {};
     std::atomic_int                         running_async_ops     {};
     // Worker-produced scene mutations waiting for the main thread; applied
     // once per tick by Editor::tick() (see scene/scene_commit_queue.hpp).
     Scene_commit_queue*                     scene_commit_queue    {nullptr};
+    // Background scene saves and glTF exports (see scene/scene_save_queue.hpp).
+    Scene_save_queue*                       scene_save_queue      {nullptr};
 
     // Async work that has not yet landed in a scene: worker tasks pending
     // or running, operations queued for the main thread, scene commits
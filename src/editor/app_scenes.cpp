@@ -145,7 +145,7 @@ void App_scenes::before_physics_simulation_steps()
     }
 }
 
-void App_scenes::flush_draw_lists()
+void App_scenes::flush_draw_lists(erhe::graphics::Command_buffer& command_buffer)
 {
     ERHE_PROFILE_FUNCTION();
 
@@ -158,7 +158,7 @@ void App_scenes::flush_draw_lists()
         scene_roots = m_scene_roots;
     }
     for (const std::shared_ptr<Scene_root>& scene_root : scene_roots) {
-        scene_root->flush_draw_lists();
+        scene_root->flush_draw_lists(command_buffer);
     }
 }
 
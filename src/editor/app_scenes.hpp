@@ -9,6 +9,9 @@
 namespace erhe {
     class Item_host;
 }
+namespace erhe::graphics {
+    class Command_buffer;
+}
 
 namespace editor {
 
@@ -37,8 +40,9 @@ public:
     void update_node_transforms              ();
     // Main thread, once per frame before any scene renders: applies queued
     // draw list changes of every registered scene root
-    // (doc/draw_list_renderer_plan.md, threading contract).
-    void flush_draw_lists                    ();
+    // (doc/draw_list_renderer_plan.md, threading contract) and records
+    // their resident record uploads into command_buffer.
+    void flush_draw_lists                    (erhe::graphics::Command_buffer& command_buffer);
 
     [[nodiscard]] auto get_scene_roots() -> const std::vector<std::shared_ptr<Scene_root>>&;
 
@@ -29,6 +29,7 @@
 #include "erhe_primitive/build_info.hpp"
 #include "erhe_primitive/material.hpp"
 #include "erhe_profile/profile.hpp"
+#include "erhe_scheduler/scheduler.hpp"
 
 #include <fmt/format.h>
 #include <imgui/imgui.h>
@@ -328,14 +329,15 @@ void ensure_scanned(App_context& context, Asset_file_gltf& gltf)
     if (source_path == nullptr) {
         return;
     }
-    if (context.executor == nullptr) {
+    if (context.scheduler == nullptr) {
         ensure_scanned_blocking(gltf);
         return;
     }
     auto request = std::make_shared<Gltf_scan_request>();
     gltf.scan_request = request;
     const std::filesystem::path path = *source_path;
-    context.executor->silent_async(
+    context.scheduler->silent_async(
+        erhe::scheduler::Lane::e_background,
         [request, path]() {
             Gltf_scan_summary summary = scan_gltf(path);
             request->contents        = std::move(summary.contents);
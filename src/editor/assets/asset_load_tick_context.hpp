@@ -10,6 +10,9 @@ namespace erhe::graphics {
     class Command_buffer;
     class Device;
 }
+namespace erhe::scheduler {
+    class Scheduler;
+}
 
 // Codegen emits the config structs at global scope
 // (build/src/editor/config/generated/load_config.hpp).
@@ -82,6 +85,8 @@ public:
     erhe::graphics::Device&         graphics_device;
     erhe::graphics::Command_buffer& command_buffer;
     tf::Executor&                   executor;
+    // Load workers go through its background lane
+    erhe::scheduler::Scheduler&     scheduler;
     Frame_load_budget&              budget;
 
     // Standing backpressure cap (plan 2.4): a task must not schedule further
@@ -868,6 +868,7 @@ void Asset_manager::mark_item_dirty(const erhe::Item_base& item)
         if (!holds_item) {
             continue;
         }
+        ++record->edit_serial;
         if (!record->dirty) {
             record->dirty = true;
             log_asset->info(
@@ -881,17 +882,31 @@ void Asset_manager::mark_item_dirty(const erhe::Item_base& item)
     }
 }
 
-void Asset_manager::on_scene_saved(Scene_root& scene_root)
+void Asset_manager::on_scene_saved(Scene_root& scene_root, const std::optional<std::uint64_t> edit_serial)
 {
     verify_main_thread();
     const std::shared_ptr<Asset_container_record> record = find_scene_record(&scene_root);
     if (!record || !record->dirty) {
         return;
     }
+    if (edit_serial.has_value() && (edit_serial.value() != record->edit_serial)) {
+        log_asset->info("scene '{}' saved; container record {} was edited during the save and stays dirty", scene_root.get_name(), record->id);
+        return;
+    }
     record->dirty = false;
     log_asset->info("scene '{}' saved; container record {} is clean", scene_root.get_name(), record->id);
 }
 
+auto Asset_manager::get_scene_edit_serial(Scene_root& scene_root) -> std::optional<std::uint64_t>
+{
+    verify_main_thread();
+    const std::shared_ptr<Asset_container_record> record = find_scene_record(&scene_root);
+    if (!record) {
+        return std::nullopt;
+    }
+    return record->edit_serial;
+}
+
 auto Asset_manager::save_container(const std::filesystem::path& path, std::string& out_error) -> bool
 {
     verify_main_thread();
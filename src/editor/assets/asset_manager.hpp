@@ -106,6 +106,10 @@ public:
     std::shared_ptr<erhe::scene::Node> root_node;
     std::vector<std::string>           errors;          // decision-11 identifiability violations
     bool                               dirty{false};    // live asset edits not yet written back (used from R5 on)
+    // Bumped by every mark_item_dirty() hit, dirty or not: a background
+    // scene save compares it with the value taken at its snapshot, so an
+    // edit made while the file was being written keeps the record dirty.
+    std::uint64_t                      edit_serial{0};
     // R7 make-external: a record created around a LIVE object by
     // rehome_definition_to_container - no parse, no gltf_data. Only such
     // authored material containers may be rewritten by save_container: a
@@ -403,8 +407,11 @@ public:
     // items.
     void mark_item_dirty(const erhe::Item_base& item);
     // Scene save clears the scene's own record (called by save_scene_gltf
-    // after a successful write).
-    void on_scene_saved(Scene_root& scene_root);
+    // after a successful write). With edit_serial (taken with
+    // get_scene_edit_serial() when the save snapshot was made) the record
+    // stays dirty if it was edited since.
+    void on_scene_saved(Scene_root& scene_root, std::optional<std::uint64_t> edit_serial = std::nullopt);
+    [[nodiscard]] auto get_scene_edit_serial(Scene_root& scene_root) -> std::optional<std::uint64_t>;
 
     // R5.8 save_container v1: a record open as a scene delegates to the
     // scene save (clearing dirty via on_scene_saved); a non-scene container
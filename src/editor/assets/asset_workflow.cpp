@@ -38,12 +38,12 @@ auto write_material_container_file(
         .image_source_provider = image_source_provider,
         .extra_materials       = materials,
     };
-    const std::string gltf = erhe::gltf::export_gltf(export_arguments);
-    if (gltf.empty()) {
+    const std::shared_ptr<erhe::gltf::Gltf_export_snapshot> snapshot = erhe::gltf::make_gltf_export_snapshot(export_arguments);
+    if (!snapshot) {
         out_error = fmt::format("material container export produced no data for '{}'", erhe::file::to_string(path));
         return false;
     }
-    if (!erhe::file::write_file(path, gltf)) {
+    if (!erhe::gltf::write_gltf_export_snapshot(*snapshot, path)) {
         out_error = fmt::format("failed to write material container '{}'", erhe::file::to_string(path));
         return false;
     }
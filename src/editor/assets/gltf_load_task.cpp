@@ -18,6 +18,7 @@
 #include "erhe_scene/mesh.hpp"
 #include "erhe_scene/node.hpp"
 #include "erhe_scene/scene.hpp"
+#include "erhe_scheduler/scheduler.hpp"
 #include "erhe_verify/verify.hpp"
 
 #include <taskflow/taskflow.hpp>
@@ -88,7 +89,8 @@ void Gltf_load_task::start_scan(Asset_load_tick_context& tick_context)
     auto scan_result = std::make_shared<Scan_result>();
     const std::filesystem::path path = m_handle->get_path();
     m_scan_result = scan_result;
-    tick_context.executor.silent_async(
+    tick_context.scheduler.silent_async(
+        erhe::scheduler::Lane::e_background,
         [scan_result, path]() {
             try {
                 const Gltf_scan_summary summary = editor::scan_gltf(path);
@@ -116,20 +118,16 @@ void Gltf_load_task::start_build(Asset_load_tick_context& tick_context)
     // budget-drained instead of "all of it, this frame". It is only legal
     // because publish below gates on the watermark (plan 2.6).
     const erhe::primitive::Build_info build_info = make_import_build_info(m_context, erhe::scene_renderer::Mesh_memory_queue::loader);
-    const erhe::primitive::Build_info skinned_build_info{
-        .primitive_types = build_info.primitive_types,
-        .buffer_info     = mesh_memory->make_skinned_primitive_buffer_info(erhe::scene_renderer::Mesh_memory_queue::loader),
-        .constant_color  = build_info.constant_color,
-        .keep_geometry   = build_info.keep_geometry,
-        .normal_style    = build_info.normal_style,
-        .vertex_id_vec3  = build_info.vertex_id_vec3,
-        .autocolor       = build_info.autocolor
-    };
+    const erhe::primitive::Build_info skinned_build_info = make_skinned_import_build_info(
+        build_info,
+        mesh_memory->make_skinned_primitive_buffer_info(erhe::scene_renderer::Mesh_memory_queue::loader)
+    );
 
     auto build_result = std::make_shared<Build_result>();
     auto parse_result = m_parse_result;
     m_build_result    = build_result;
-    tick_context.executor.silent_async(
+    tick_context.scheduler.silent_async(
+        erhe::scheduler::Lane::e_background,
         [build_result, parse_result, build_info, skinned_build_info]() {
             try {
                 build_imported_buffer_meshes(build_info, skinned_build_info, parse_result->gltf_data);
@@ -180,11 +178,13 @@ void Gltf_load_task::start_parse(Asset_load_tick_context& tick_context)
         .mesh_layer_id   = m_mesh_layer_id,
         .path            = path,
         .parallel        = (m_context.editor_settings == nullptr) || m_context.editor_settings->load.parallel_gltf_parse,
-        .fix_spot_lights = m_context.fix_gltf_spot_lights
+        .fix_spot_lights = m_context.fix_gltf_spot_lights,
+        .compressed_image_cache = (m_context.editor_settings == nullptr) || m_context.editor_settings->load.compressed_texture_cache
     };
 
     m_parse_result = parse_result;
-    tick_context.executor.silent_async(
+    tick_context.scheduler.silent_async(
+        erhe::scheduler::Lane::e_background,
         [parse_result, parse_arguments, path]() mutable {
             const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
             try {
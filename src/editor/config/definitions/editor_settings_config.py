@@ -1,7 +1,7 @@
 from erhe_codegen import *
 
 struct("Editor_settings_config",
-    version=3,
+    version=7,
     short_desc="Editor settings",
     long_desc="Runtime-editable settings saved to editor_settings.json.",
     developer=False,
@@ -62,6 +62,9 @@ struct("Editor_settings_config",
         field("sky",                  StructRef("Sky_config"),             added_in=1),
         field("thumbnails",           StructRef("Thumbnails_config"),      added_in=1),
         field("transform_tool",       StructRef("Transform_tool_config"), added_in=1),
+        # Operation_stack memory budget: compaction / disk spill of old
+        # mesh operation entries (operations/notes.md).
+        field("undo_history",         StructRef("Undo_history_config"),   added_in=7),
         field("viewport",             StructRef("Viewport_config_data"),  added_in=1),
         field("graphics_preset_name", String, added_in=1, default='"Medium"'),
         field("imgui",                StructRef("Imgui_settings_config"), added_in=1),
@@ -96,6 +99,46 @@ struct("Editor_settings_config",
         # lit scene and should not drag the camera framing out to the horizon.
         # They still count toward the camera far plane, so the backdrop stays
         # visible.
+        # Screen-space-error LOD pick of the draw-list path: the coarsest
+        # level of detail whose simplification error projects to at most this
+        # many pixels is drawn. Only meshes built with LOD index ranges (glTF
+        # import) are affected; 0 draws full detail everywhere.
+        field(
+            "lod_max_pixel_error",
+            Float,
+            added_in=4,
+            default="1.0f",
+            short_desc="LOD Pixel Error",
+            long_desc="Draw lists pick the coarsest level of detail whose error is at most this many pixels on screen. 0 = always full detail.",
+            visible=True,
+            developer=False
+        ),
+        # Meshlet level culling of the draw-list path: full detail entries
+        # built with meshlets (glTF import, large meshes) draw only the
+        # meshlets inside the view frustum that face the camera.
+        field(
+            "use_cluster_culling",
+            Bool,
+            added_in=5,
+            default="true",
+            short_desc="Cluster Culling",
+            long_desc="Draw lists cull the meshlets of large meshes against the view frustum and their normal cones, and draw one command per visible meshlet.",
+            visible=True,
+            developer=False
+        ),
+        # Clustered light assignment of the forward renderer: single view
+        # passes shade each fragment with the non-shadow spot and point
+        # lights binned into its view space cluster only.
+        field(
+            "use_clustered_lights",
+            Bool,
+            added_in=6,
+            default="true",
+            short_desc="Clustered Lights",
+            long_desc="Non-shadow spot and point lights are binned into view space clusters on the CPU and each fragment shades only the lights of its cluster. Needs shader storage buffers; XR multiview passes always loop over all lights.",
+            visible=True,
+            developer=False
+        ),
         field(
             "exclude_unlit_primitives",
             Bool,
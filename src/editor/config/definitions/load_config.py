@@ -2,7 +2,7 @@ from erhe_codegen import *
 
 struct("Load_config",
     reflect=True,
-    version=2,
+    version=3,
     short_desc="Loading",
     long_desc="glTF import/open performance options.",
     developer=False,
@@ -37,6 +37,16 @@ struct("Load_config",
             visible=True,
             developer=False
         ),
+        field(
+            "compressed_texture_cache",
+            Bool,
+            added_in=3,
+            default="true",
+            short_desc="Compressed Texture Cache",
+            long_desc="On GPUs that support BC7, keep BC7 compressed copies of PNG / JPEG glTF images under cache/textures. The first load decodes as usual and encodes the cache entry in a background task; later loads of the same image upload the cached BC7 mip chain without decoding it.",
+            visible=True,
+            developer=False
+        ),
         # Asynchronous loading (doc/async-asset-loading-plan.md). The master
         # switch selects between the blocking load path (whole glTF inside one
         # tick) and Asset_load_tasks advanced a bounded amount from
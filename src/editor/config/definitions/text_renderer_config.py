@@ -2,7 +2,7 @@ from erhe_codegen import *
 
 struct("Text_renderer_config",
     reflect=True,
-    version=1,
+    version=2,
     short_desc="",
     long_desc="",
     developer=False,
@@ -27,5 +27,15 @@ struct("Text_renderer_config",
             visible=True,
             developer=False
         ),
+        field(
+            "glyph_cache",
+            Bool,
+            added_in=2,
+            default="true",
+            short_desc="Glyph Cache",
+            long_desc="Keep rasterized glyphs in cache/fonts/ so later runs do not rasterize them again",
+            visible=True,
+            developer=False
+        ),
     ],
 )
@@ -1,7 +1,7 @@
 from erhe_codegen import *
 
 struct("Threading_config",
-    version=1,
+    version=2,
     short_desc="",
     long_desc="",
     developer=False,
@@ -16,5 +16,15 @@ struct("Threading_config",
             visible=True,
             developer=False
         ),
+        field(
+            "background_thread_limit",
+            Int,
+            added_in=2,
+            default="0",
+            short_desc="Background worker limit",
+            long_desc="Maximum number of workers running background jobs (asset loads, asset browser scans, lightmap tile reads) at the same time, keeping the rest free for physics and interactive work. 0 uses half of the workers.",
+            visible=True,
+            developer=False
+        ),
     ],
 )
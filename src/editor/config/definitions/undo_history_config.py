@@ -0,0 +1,44 @@
+from erhe_codegen import *
+
+struct("Undo_history_config",
+    reflect=True,
+    version=1,
+    short_desc="Undo History",
+    long_desc="Memory budget of the undo / redo history (see operations/notes.md).",
+    developer=False,
+    fields=[
+        field(
+            "memory_budget_mb",
+            Int,
+            added_in=1,
+            default="1024",
+            short_desc="Memory Budget (MB)",
+            long_desc="Geometry and GPU mesh memory the undo / redo history may hold before the entries farthest from the current state are compacted and, if that is not enough, spilled to a temporary file. 0 = unlimited.",
+            visible=True,
+            developer=False,
+            ui_min="0",
+            ui_max="16384",
+            hard_min="0"
+        ),
+        field(
+            "compact",
+            Bool,
+            added_in=1,
+            default="true",
+            short_desc="Compact Entries",
+            long_desc="Over budget, mesh operation entries keep the version that is not in the scene as a delta against the one that is, instead of a full geometry and GPU mesh. Undo / redo rebuilds it bit-exact.",
+            visible=True,
+            developer=False
+        ),
+        field(
+            "spill_to_disk",
+            Bool,
+            added_in=1,
+            default="true",
+            short_desc="Spill To Disk",
+            long_desc="When compacting alone does not bring the history under budget, move the deltas of the oldest entries to a temporary file that is deleted on exit.",
+            visible=True,
+            developer=False
+        ),
+    ],
+)
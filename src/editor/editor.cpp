@@ -100,6 +100,7 @@
 #include "prefabs/prefab_library.hpp"
 #include "scene/scene_builder.hpp"
 #include "scene/scene_commit_queue.hpp"
+#include "scene/scene_save_queue.hpp"
 #include "scene/scene_commands.hpp"
 #include "scene/scene_root.hpp"
 #include "scene/scene_settings_resolve.hpp"
@@ -128,6 +129,7 @@
 #include "windows/inventory_window.hpp"
 #include "windows/properties.hpp"
 #include "windows/settings_window.hpp"
+#include "windows/scheduler_lane_plots.hpp"
 #include "windows/transform_update_stats.hpp"
 #include "windows/viewport_config_window.hpp"
 #include "windows/scene_view_config_window.hpp"
@@ -179,6 +181,7 @@
 #include "erhe_net/net_log.hpp"
 #include "erhe_physics/physics_log.hpp"
 #include "erhe_physics/iworld.hpp"
+#include "erhe_physics/physics_scheduler.hpp"
 #if defined(ERHE_PHYSICS_LIBRARY_JOLT) && defined(JPH_DEBUG_RENDERER)
 #   include "erhe_renderer/jolt_debug_renderer.hpp"
 #endif
@@ -193,7 +196,9 @@
 #include "erhe_rendergraph/rendergraph.hpp"
 #include "erhe_rendergraph/rendergraph_log.hpp"
 #include "erhe_scene/scene.hpp"
+#include "erhe_scene/scene_executor.hpp"
 #include "erhe_scene/scene_log.hpp"
+#include "erhe_scheduler/scheduler.hpp"
 #include "erhe_scene_renderer/forward_renderer.hpp"
 #include "erhe_scene_renderer/program_interface.hpp"
 #include "erhe_scene_renderer/scene_renderer_log.hpp"
@@ -605,6 +610,9 @@ public:
         // Everything below - pointer / hover raytrace, physics, commands,
         // MCP, operations, transforms, draw list flush, rendering - then
         // sees scenes that only the main thread changes.
+        // Closes the per-lane worker time accounting of the previous frame.
+        m_scheduler->end_frame();
+
         erhe::log::set_breadcrumb("tick: scene_commit_queue flush");
         m_scene_commit_queue.flush();
 
@@ -622,6 +630,7 @@ public:
                 .graphics_device             = *m_graphics_device,
                 .command_buffer              = command_buffer,
                 .executor                    = *m_app_context.executor,
+                .scheduler                   = *m_app_context.scheduler,
                 .budget                      = budget,
                 .max_decoded_bytes_in_flight = static_cast<std::size_t>(
                     std::max(0, m_app_context.editor_settings->load.max_decoded_bytes_in_flight)
@@ -741,6 +750,13 @@ public:
         // (after the operation stack so this frame's edits are seen).
         m_geometry_graph_window->update_evaluation();
 
+        // MCP scene snapshot: captured after the operation stack has run the
+        // operations queued by this frame's MCP requests, so a query answered
+        // from it sees every edit whose call has returned.
+        if (m_mcp_server) {
+            m_mcp_server->publish_scene_snapshot();
+        }
+
         // Texture graph: synchronous dirty-flag evaluation (cheap GLSL
         // composition, no background engine), run once per frame so the graph
         // stays current even when the window is hidden.
@@ -841,7 +857,7 @@ public:
         // shadow nodes, headset). Thumbnails above render preview roots,
         // which have no Draw_list_scene. Main thread only.
         erhe::log::set_breadcrumb("tick: flush_draw_lists");
-        m_app_scenes->flush_draw_lists();
+        m_app_scenes->flush_draw_lists(command_buffer);
 
         // Dynamic diffuse global illumination (doc/ddgi-plan.md): refit the
         // probe volume and record this frame's probe update into the frame
@@ -885,6 +901,7 @@ public:
         {
             const Lightmap_config& lightmap_config = m_app_context.editor_settings->lightmap;
             m_forward_renderer->set_lightmap_bicubic(lightmap_config.bicubic_sampling);
+            m_forward_renderer->set_clustered_lights(m_app_context.editor_settings->use_clustered_lights);
             if (m_lightmap_partitioner) {
                 // Commit or discard a finished async prepare job. After the
                 // operation stack (:694) and transform updates, so the
@@ -1414,6 +1431,24 @@ public:
         // Scene level raytrace BVH builds run on the executor, so that they
         // never land on the frame.
         erhe::raytrace::set_executor(m_executor.get());
+        // Level-parallel world transform propagation of large dirty sets
+        // (Scene::update_node_transforms()).
+        erhe::scene::set_executor(m_executor.get());
+
+        // The executor is the only worker pool: Jolt physics jobs run on it
+        // too (erhe::physics::set_scheduler() - before any Scene_root makes
+        // a physics world). The background lane (asset loads, scans,
+        // lightmap tile reads) is capped so a large import can not hold
+        // every worker while a physics step queues its jobs.
+        m_scheduler = std::make_unique<erhe::scheduler::Scheduler>(*m_executor.get());
+        const int configured_background_thread_limit = m_editor_settings.threading.background_thread_limit;
+        m_scheduler->set_lane_concurrency(
+            erhe::scheduler::Lane::e_background,
+            (configured_background_thread_limit > 0)
+                ? static_cast<std::size_t>(configured_background_thread_limit)
+                : std::max<std::size_t>(thread_count / 2, 1)
+        );
+        erhe::physics::set_scheduler(m_scheduler.get());
 
         // Declared outside the try so the loading screen survives past
         // the parallel-init catch block; the post-task init phase
@@ -1674,7 +1709,8 @@ public:
                 *m_app_context.current_command_buffer,
                 m_text_renderer_config.enabled,
                 m_text_renderer_config.font_size,
-                xr_view_count
+                xr_view_count,
+                m_text_renderer_config.glyph_cache
             );
 
             // Stack-local: the status display is only useful during init,
@@ -2192,6 +2228,7 @@ public:
                 m_app_context.performance_window = m_performance_window.get();
                 m_transform_update_stats_tracker = std::make_unique<Transform_update_stats_tracker>(*m_performance_window.get());
                 m_app_context.transform_update_stats_tracker = m_transform_update_stats_tracker.get();
+                m_scheduler_lane_plots           = std::make_unique<Scheduler_lane_plots>(*m_performance_window.get(), *m_scheduler.get());
                 m_pipelines              = std::make_unique<erhe::imgui::Pipelines          >(*m_imgui_renderer.get(), *m_imgui_windows.get());
             }
             ERHE_TASK_FOOTER(
@@ -2712,6 +2749,24 @@ public:
                             );
                             ImGui::SameLine();
                         }
+
+                        // Background scene saves (Scene_save_queue): oldest
+                        // first, the others wait for it.
+                        const std::vector<std::shared_ptr<Scene_save_queue::Save_state>>& saves = m_scene_save_queue.get_in_flight();
+                        if (!saves.empty()) {
+                            const Scene_save_queue::Save_state& save = *saves.front();
+                            const std::size_t byte_count    = save.byte_count   .load(std::memory_order_relaxed);
+                            const std::size_t bytes_written = save.bytes_written.load(std::memory_order_relaxed);
+                            const float       fraction      = (byte_count > 0) ? static_cast<float>(bytes_written) / static_cast<float>(byte_count) : 0.0f;
+                            if (saves.size() > 1) {
+                                ImGui::Text("Saving (%d queued)", static_cast<int>(saves.size() - 1));
+                            } else {
+                                ImGui::TextUnformatted("Saving");
+                            }
+                            ImGui::SameLine();
+                            ImGui::ProgressBar(fraction, ImVec2{160.0f, 0.0f});
+                            ImGui::SameLine();
+                        }
                     }
                     struct Input_record
                     {
@@ -3000,7 +3055,14 @@ public:
         // Commits the drained workers left behind own scene roots / shapes;
         // drop them now, while mesh memory and scenes are still alive.
         m_scene_commit_queue.clear();
+        // Saves in flight have been written by now; only their main-thread
+        // completion (dirty flags, asset browser rescan) is dropped above.
+        m_scene_save_queue.clear();
         erhe::raytrace::set_executor(nullptr);
+        erhe::scene::set_executor(nullptr);
+        // Physics worlds still alive keep their Jolt_job_system, which is
+        // idle now; m_scheduler itself is destroyed with the Editor.
+        erhe::physics::set_scheduler(nullptr);
         m_executor.reset();
 
         if (m_mcp_server) {
@@ -3024,7 +3086,9 @@ public:
         ERHE_PROFILE_FUNCTION();
 
         m_app_context.executor                 = m_executor.get();
+        m_app_context.scheduler                = m_scheduler.get();
         m_app_context.scene_commit_queue       = &m_scene_commit_queue;
+        m_app_context.scene_save_queue         = &m_scene_save_queue;
 
         m_app_context.commands                 = m_commands              .get();
         m_app_context.graphics_device          = m_graphics_device       .get();
@@ -4046,10 +4110,12 @@ public:
     Editor_settings_config&             m_editor_settings{m_app_settings.config()};
 
     std::unique_ptr<tf::Executor>       m_executor;
+    std::unique_ptr<erhe::scheduler::Scheduler> m_scheduler;
     Item_async_task_guard               m_item_task_guard; // destroyed before m_executor
     Scene_commit_queue                  m_scene_commit_queue; // cleared in shutdown after m_executor->wait_for_all()
 
     App_context                         m_app_context;
+    Scene_save_queue                    m_scene_save_queue{m_app_context}; // cleared in shutdown after m_executor->wait_for_all()
 
     // Reused by the status-bar callback so reading Geogram progress allocates no
     // heap memory in steady-state frames (its std::string keeps capacity).
@@ -4206,6 +4272,7 @@ public:
     // Declared after m_performance_window: destroyed first, so the tracker's
     // plots unregister while the window is still alive.
     std::unique_ptr<Transform_update_stats_tracker  >        m_transform_update_stats_tracker;
+    std::unique_ptr<Scheduler_lane_plots            >        m_scheduler_lane_plots;
     std::unique_ptr<erhe::imgui::Pipelines          >        m_pipelines;
 
     std::unique_ptr<Tools            >                       m_tools;
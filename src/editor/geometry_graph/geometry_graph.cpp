@@ -1,12 +1,59 @@
 #include "geometry_graph/geometry_graph.hpp"
+#include "geometry_graph/geometry_graph_cache.hpp"
 #include "geometry_graph/geometry_graph_node.hpp"
+#include "geometry_graph/geometry_graph_schedule.hpp"
 #include "editor_log.hpp"
 
 #include "erhe_graph/link.hpp"
 #include "erhe_graph/pin.hpp"
+#include "erhe_profile/profile.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace editor {
 
+namespace {
+
+// Geometry_graph_cache key of node's next evaluation, or std::nullopt when
+// the node is not memoizable. Reads the outputs linked to node's inputs,
+// so it must run after the upstream nodes have evaluated.
+[[nodiscard]] auto make_memoization_key(
+    const Geometry_graph_node&     node,
+    std::vector<Geometry_payload>& out_sources
+) -> std::optional<std::string>
+{
+    if (!node.is_memoizable()) {
+        return std::nullopt;
+    }
+    nlohmann::json parameters = nlohmann::json::object();
+    node.write_parameters(parameters);
+    std::string state;
+    node.append_memoization_key(state);
+
+    // Per input pin, the linked source outputs in link order: exactly what
+    // accumulate_input_from_links() combines.
+    std::vector<std::vector<const Geometry_payload*>> pin_inputs;
+    pin_inputs.reserve(node.get_input_pins().size());
+    for (const erhe::graph::Pin& input_pin : node.get_input_pins()) {
+        std::vector<const Geometry_payload*>& payloads = pin_inputs.emplace_back();
+        for (const erhe::graph::Link* link : input_pin.get_links()) {
+            const erhe::graph::Pin*    source_pin  = link->get_source();
+            const Geometry_graph_node* source_node = dynamic_cast<const Geometry_graph_node*>(source_pin->get_owner_node());
+            if (source_node != nullptr) {
+                payloads.push_back(&source_node->get_output(source_pin->get_slot()));
+            }
+        }
+    }
+    return Geometry_graph_cache::make_key(node.get_factory_type_name(), parameters.dump(), state, pin_inputs, out_sources);
+}
+
+} // anonymous namespace
+
 void Geometry_graph::mark_dirty()
 {
     m_dirty = true;
@@ -93,6 +140,24 @@ void Geometry_graph::set_preview_mesh_memory(erhe::scene_renderer::Mesh_memory*
     m_preview_mesh_memory = mesh_memory;
 }
 
+void Geometry_graph::set_executor(tf::Executor* const executor)
+{
+    m_executor = executor;
+}
+
+auto Geometry_graph::get_evaluation_cache() -> const std::shared_ptr<Geometry_graph_cache>&
+{
+    if (!m_evaluation_cache) {
+        m_evaluation_cache = std::make_shared<Geometry_graph_cache>();
+    }
+    return m_evaluation_cache;
+}
+
+void Geometry_graph::set_evaluation_cache(const std::shared_ptr<Geometry_graph_cache>& cache)
+{
+    m_evaluation_cache = cache;
+}
+
 void Geometry_graph::mark_scene_output_nodes_dirty()
 {
     for (erhe::graph::Node* node : m_nodes) {
@@ -111,19 +176,66 @@ void Geometry_graph::evaluate_if_dirty()
     evaluate();
 }
 
+void Geometry_graph::evaluate_node(Geometry_graph_node& node)
+{
+    log_graph_editor->trace("Geometry_graph: evaluating node '{}' {}", node.get_name(), node.get_log_id());
+
+    // Memoized result for the same type, parameters and inputs: adopt the
+    // payloads evaluate() produced back then.
+    std::optional<std::string>    key{};
+    std::vector<Geometry_payload> key_sources{};
+    bool                          adopted = false;
+    if (m_evaluation_cache) {
+        key = make_memoization_key(node, key_sources);
+        if (key.has_value()) {
+            const std::shared_ptr<const Geometry_graph_cache::Entry> entry = m_evaluation_cache->find(key.value());
+            if (
+                entry &&
+                (entry->inputs.size()  == node.get_input_payloads ().size()) &&
+                (entry->outputs.size() == node.get_output_payloads().size())
+            ) {
+                for (std::size_t slot = 0, end = entry->inputs.size(); slot < end; ++slot) {
+                    node.set_input(slot, entry->inputs[slot]);
+                }
+                for (std::size_t slot = 0, end = entry->outputs.size(); slot < end; ++slot) {
+                    node.set_output(slot, entry->outputs[slot]);
+                }
+                adopted = true;
+                log_graph_editor->trace("Geometry_graph: node '{}' {} reused a memoized result", node.get_name(), node.get_log_id());
+            }
+        }
+    }
+    if (!adopted) {
+        node.evaluate(*this);
+        if (key.has_value()) {
+            m_evaluation_cache->insert(key.value(), std::move(key_sources), node.get_input_payloads(), node.get_output_payloads());
+        }
+    }
+    node.clear_dirty();
+    if (m_preview_mesh_memory != nullptr) {
+        node.build_preview_primitive(*m_preview_mesh_memory);
+    }
+}
+
 void Geometry_graph::evaluate()
 {
+    ERHE_PROFILE_FUNCTION();
+
     sort();
     const bool evaluate_all = m_dirty;
 
-    // Phase 1: every node except the scene outputs, in topological order.
-    // The scene outputs are deferred to phase 2 because the display / ghost
-    // designation lets them read ANOTHER node's cached output payload, and
-    // that node may be an unconnected subtree the topological sort placed
-    // after them (sort() only constrains linked nodes).
+    // Phase 1: every node except the scene outputs. The scene outputs are
+    // deferred to phase 2 because the display / ghost designation lets
+    // them read ANOTHER node's cached output payload, and that node may be
+    // an unconnected subtree the topological sort placed after them
+    // (sort() only constrains linked nodes).
+    //
+    // First the dirty set, in topological order: marking link sinks dirty
+    // while walking reaches every downstream node in this same pass.
     const Geometry_graph_node* display_node = find_node_by_log_id(m_display_node_id);
     const Geometry_graph_node* ghost_node   = find_node_by_log_id(m_ghost_node_id);
     bool designated_node_evaluated = false;
+    std::vector<Geometry_graph_node*> dirty_nodes;
     for (erhe::graph::Node* node : m_nodes) {
         Geometry_graph_node* geometry_graph_node = dynamic_cast<Geometry_graph_node*>(node);
         if (geometry_graph_node == nullptr) {
@@ -138,17 +250,10 @@ void Geometry_graph::evaluate()
         if (!geometry_graph_node->is_dirty()) {
             continue; // clean node keeps its cached output payloads
         }
-        log_graph_editor->trace("Geometry_graph: evaluating node '{}' {}", geometry_graph_node->get_name(), geometry_graph_node->get_log_id());
-        geometry_graph_node->evaluate(*this);
-        geometry_graph_node->clear_dirty();
-        if (m_preview_mesh_memory != nullptr) {
-            geometry_graph_node->build_preview_primitive(*m_preview_mesh_memory);
-        }
+        dirty_nodes.push_back(geometry_graph_node);
         if ((geometry_graph_node == display_node) || (geometry_graph_node == ghost_node)) {
             designated_node_evaluated = true;
         }
-        // Nodes are visited in topological order, so marking link sinks
-        // dirty here reaches every downstream node in this same pass.
         for (erhe::graph::Pin& pin : geometry_graph_node->get_output_pins()) {
             for (erhe::graph::Link* link : pin.get_links()) {
                 Geometry_graph_node* sink_node = dynamic_cast<Geometry_graph_node*>(link->get_sink()->get_owner_node());
@@ -159,6 +264,37 @@ void Geometry_graph::evaluate()
         }
     }
 
+    // Then evaluate them: serially in topological order, or as a task
+    // graph whose edges are the links between dirty nodes, so branches
+    // that do not feed each other run concurrently. Nodes only write their
+    // own payload slots and read upstream outputs that their predecessors
+    // finished, and geometry operations on different Geometry objects are
+    // safe to run concurrently (erhe::geometry concurrency tests).
+    std::unordered_map<const Geometry_graph_node*, std::size_t> dirty_indices;
+    dirty_indices.reserve(dirty_nodes.size());
+    for (std::size_t i = 0, end = dirty_nodes.size(); i < end; ++i) {
+        dirty_indices.emplace(dirty_nodes[i], i);
+    }
+    std::vector<std::vector<std::size_t>> successors(dirty_nodes.size());
+    for (std::size_t i = 0, end = dirty_nodes.size(); i < end; ++i) {
+        for (erhe::graph::Pin& pin : dirty_nodes[i]->get_output_pins()) {
+            for (erhe::graph::Link* link : pin.get_links()) {
+                const Geometry_graph_node* sink_node = dynamic_cast<const Geometry_graph_node*>(link->get_sink()->get_owner_node());
+                const auto sink = dirty_indices.find(sink_node);
+                if (sink != dirty_indices.end()) {
+                    successors[i].push_back(sink->second);
+                }
+            }
+        }
+    }
+    run_node_evaluations(
+        m_executor,
+        successors,
+        [this, &dirty_nodes](const std::size_t i) {
+            evaluate_node(*dirty_nodes[i]);
+        }
+    );
+
     // Phase 2: scene-output nodes. Every phase-1 payload is final now, so a
     // display / ghost designation resolves to fresh data; a re-evaluated
     // designated node forces a re-bake even when the output's wired input
@@ -3,11 +3,14 @@
 #include "erhe_graph/graph.hpp"
 
 #include <cstddef>
+#include <memory>
 
 namespace erhe::scene_renderer { class Mesh_memory; }
+namespace tf                   { class Executor; }
 
 namespace editor {
 
+class Geometry_graph_cache;
 class Geometry_graph_node;
 
 // Geometry node graph: erhe::graph::Graph with eager, dirty-flag driven
@@ -19,6 +22,12 @@ class Geometry_graph_node;
 // dependents re-run; clean nodes keep their cached output payloads.
 // Structural edits mark the affected nodes dirty at the edit site
 // (Geometry_graph_window insert / erase / connect / disconnect).
+//
+// With an executor set, the dirty nodes form a task graph following the
+// links, so independent branches evaluate concurrently; with an
+// evaluation cache set, a dirty node whose type, parameters and inputs
+// match an earlier evaluation adopts that result instead of re-running
+// (see Geometry_graph_cache).
 class Geometry_graph : public erhe::graph::Graph
 {
 public:
@@ -76,14 +85,30 @@ public:
     // default) disables preview builds.
     void set_preview_mesh_memory(erhe::scene_renderer::Mesh_memory* mesh_memory);
 
+    // Parallel evaluation of independent branches (background-evaluation
+    // shadow graphs; set by Geometry_graph_window::launch_evaluation). Null
+    // (the default) evaluates serially on the calling thread. Called from
+    // an executor worker, evaluation co-runs instead of blocking it.
+    void set_executor(tf::Executor* executor);
+
+    // Memoization cache. get_evaluation_cache() creates the graph's own
+    // cache on first use (live graphs); set_evaluation_cache() shares it
+    // with the shadow graph of a background run. Null disables
+    // memoization.
+    [[nodiscard]] auto get_evaluation_cache() -> const std::shared_ptr<Geometry_graph_cache>&;
+    void set_evaluation_cache(const std::shared_ptr<Geometry_graph_cache>& cache);
+
 private:
     void evaluate();
+    void evaluate_node(Geometry_graph_node& node);
     void mark_scene_output_nodes_dirty();
 
-    bool                               m_dirty{true};
-    std::size_t                        m_display_node_id{0};
-    std::size_t                        m_ghost_node_id{0};
-    erhe::scene_renderer::Mesh_memory* m_preview_mesh_memory{nullptr};
+    bool                                  m_dirty{true};
+    std::size_t                           m_display_node_id{0};
+    std::size_t                           m_ghost_node_id{0};
+    erhe::scene_renderer::Mesh_memory*    m_preview_mesh_memory{nullptr};
+    tf::Executor*                         m_executor{nullptr};
+    std::shared_ptr<Geometry_graph_cache> m_evaluation_cache;
 };
 
 }
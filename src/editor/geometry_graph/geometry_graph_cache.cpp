@@ -0,0 +1,186 @@
+#include "geometry_graph/geometry_graph_cache.hpp"
+
+#include "erhe_geometry/geometry.hpp"
+#include "erhe_geometry/geometry_delta.hpp"
+
+#if defined(ERHE_VOXEL_LIBRARY_OPENVDB)
+#   include "erhe_voxel/voxel.hpp"
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+#include <variant>
+
+namespace editor {
+
+namespace {
+
+void append_bytes(std::string& key, const void* data, const std::size_t byte_count)
+{
+    const std::size_t offset = key.size();
+    key.resize(offset + byte_count);
+    std::memcpy(key.data() + offset, data, byte_count);
+}
+
+void append_payload_key(std::string& key, const Geometry_payload& payload, std::vector<Geometry_payload>& out_sources)
+{
+    key.push_back(static_cast<char>(payload.value.index()));
+    std::visit(
+        [&key, &payload, &out_sources](const auto& value) {
+            using T = std::decay_t<decltype(value)>;
+            if constexpr (std::is_same_v<T, std::monostate>) {
+                // type index only
+            } else if constexpr (std::is_trivially_copyable_v<T>) {
+                append_bytes(key, &value, sizeof(T));
+            } else {
+                // Shared payload: identity, kept alive by the entry.
+                const void* const pointer = value.get();
+                append_bytes(key, &pointer, sizeof(pointer));
+                if (pointer != nullptr) {
+                    out_sources.push_back(payload);
+                }
+            }
+        },
+        payload.value
+    );
+}
+
+[[nodiscard]] auto get_payload_byte_count(const Geometry_payload& payload) -> std::size_t
+{
+    if (const std::shared_ptr<erhe::geometry::Geometry> geometry = payload.get_geometry()) {
+        return erhe::geometry::get_flat_data_byte_count(*geometry);
+    }
+    if (const std::shared_ptr<Point_cloud> points = payload.get_points()) {
+        return (points->positions.size() + points->normals.size()) * sizeof(glm::vec3);
+    }
+    if (const std::shared_ptr<Geometry_instances> instances = payload.get_instances()) {
+        std::size_t byte_count = 0;
+        for (const Geometry_instances::Entry& entry : instances->entries) {
+            byte_count += entry.transforms.size() * sizeof(glm::mat4);
+        }
+        return byte_count;
+    }
+#if defined(ERHE_VOXEL_LIBRARY_OPENVDB)
+    if (const std::shared_ptr<erhe::voxel::Grid> sdf = payload.get_sdf()) {
+        return static_cast<std::size_t>(std::max<std::int64_t>(0, sdf->get_memory_usage()));
+    }
+#endif
+    return sizeof(Geometry_payload);
+}
+
+} // anonymous namespace
+
+Geometry_graph_cache::Geometry_graph_cache(const std::size_t max_entry_count, const std::size_t max_byte_count)
+    : m_max_entry_count{max_entry_count}
+    , m_max_byte_count {max_byte_count}
+{
+}
+
+auto Geometry_graph_cache::make_key(
+    const std::string_view                                   type_name,
+    const std::string_view                                   parameters,
+    const std::string_view                                   state,
+    const std::vector<std::vector<const Geometry_payload*>>& pin_inputs,
+    std::vector<Geometry_payload>&                           out_sources
+) -> std::string
+{
+    ERHE_PROFILE_FUNCTION();
+
+    std::string key{type_name};
+    key.push_back('\0');
+    key += parameters;
+    key.push_back('\0');
+    key += state;
+    for (const std::vector<const Geometry_payload*>& payloads : pin_inputs) {
+        key.push_back('\1');
+        for (const Geometry_payload* payload : payloads) {
+            append_payload_key(key, *payload, out_sources);
+        }
+    }
+    return key;
+}
+
+auto Geometry_graph_cache::find(const std::string& key) -> std::shared_ptr<const Entry>
+{
+    const std::lock_guard<ERHE_PROFILE_LOCKABLE_BASE(std::mutex)> lock{m_mutex};
+    const auto i = m_slots.find(key);
+    if (i == m_slots.end()) {
+        ++m_miss_count;
+        return {};
+    }
+    ++m_hit_count;
+    i->second.last_use = ++m_use_serial;
+    return i->second.entry;
+}
+
+void Geometry_graph_cache::insert(
+    const std::string&                   key,
+    std::vector<Geometry_payload>&&      sources,
+    const std::vector<Geometry_payload>& inputs,
+    const std::vector<Geometry_payload>& outputs
+)
+{
+    std::shared_ptr<Entry> entry = std::make_shared<Entry>();
+    entry->sources = std::move(sources);
+    entry->inputs  = inputs;
+    entry->outputs = outputs;
+    entry->byte_count = key.size();
+    for (const Geometry_payload& payload : entry->outputs) {
+        entry->byte_count += get_payload_byte_count(payload);
+    }
+    // A single result larger than the whole budget would only evict
+    // everything else and then itself.
+    if (entry->byte_count > m_max_byte_count) {
+        return;
+    }
+
+    const std::lock_guard<ERHE_PROFILE_LOCKABLE_BASE(std::mutex)> lock{m_mutex};
+    Slot& slot = m_slots[key];
+    if (slot.entry) {
+        m_byte_count -= slot.entry->byte_count;
+    }
+    m_byte_count += entry->byte_count;
+    slot.entry    = std::move(entry);
+    slot.last_use = ++m_use_serial;
+    evict();
+}
+
+void Geometry_graph_cache::evict()
+{
+    // Linear scans: the entry count is bounded and small.
+    while (!m_slots.empty() && ((m_slots.size() > m_max_entry_count) || (m_byte_count > m_max_byte_count))) {
+        auto oldest = m_slots.begin();
+        for (auto i = m_slots.begin(), end = m_slots.end(); i != end; ++i) {
+            if (i->second.last_use < oldest->second.last_use) {
+                oldest = i;
+            }
+        }
+        m_byte_count -= oldest->second.entry->byte_count;
+        m_slots.erase(oldest);
+    }
+}
+
+void Geometry_graph_cache::clear()
+{
+    std::unordered_map<std::string, Slot> dropped;
+    {
+        const std::lock_guard<ERHE_PROFILE_LOCKABLE_BASE(std::mutex)> lock{m_mutex};
+        dropped.swap(m_slots);
+        m_byte_count = 0;
+    }
+    // Payloads are released outside the lock.
+}
+
+auto Geometry_graph_cache::get_statistics() -> Statistics
+{
+    const std::lock_guard<ERHE_PROFILE_LOCKABLE_BASE(std::mutex)> lock{m_mutex};
+    return Statistics{
+        .entry_count = m_slots.size(),
+        .byte_count  = m_byte_count,
+        .hit_count   = m_hit_count,
+        .miss_count  = m_miss_count
+    };
+}
+
+}
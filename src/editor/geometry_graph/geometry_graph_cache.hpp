@@ -0,0 +1,113 @@
+#pragma once
+
+#include "geometry_graph/geometry_payload.hpp"
+
+#include "erhe_profile/profile.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace editor {
+
+// Bounded memoization of geometry graph node evaluations.
+//
+// A node's evaluation is keyed by its factory type name, its serialized
+// parameters (write_parameters(), plus append_memoization_key() for state
+// captured outside the parameters) and the payloads on its input links.
+// Scrubbing a parameter back to an earlier value, or reconnecting a branch
+// that was evaluated before, then adopts the earlier outputs instead of
+// re-running the operation.
+//
+// Scalar and vector payloads enter the key by value. Shared payloads
+// (geometry, point clouds, instances, SDF grids, materials) enter it by
+// identity: payloads are never mutated after a node publishes them, and
+// every entry keeps the source payloads of its key alive, so an address
+// in a live key can not be reused by different content. Upstream hits
+// return the same shared payloads, so identities stay stable down a chain
+// of memoized nodes.
+//
+// Owned by the live graph (Geometry_graph::get_evaluation_cache()) and
+// shared with the shadow graph of each background evaluation run, so
+// entries survive across runs. Thread safe: nodes of one run evaluate
+// concurrently. Evicts least recently used entries beyond the entry count
+// and byte budgets; the byte estimate counts geometry through
+// erhe::geometry::get_flat_data_byte_count().
+class Geometry_graph_cache
+{
+public:
+    class Entry
+    {
+    public:
+        std::vector<Geometry_payload> sources; // keeps the identities in the key alive
+        std::vector<Geometry_payload> inputs;
+        std::vector<Geometry_payload> outputs;
+        std::size_t                   byte_count{0};
+    };
+
+    class Statistics
+    {
+    public:
+        std::size_t   entry_count{0};
+        std::size_t   byte_count {0};
+        std::uint64_t hit_count  {0};
+        std::uint64_t miss_count {0};
+    };
+
+    static constexpr std::size_t c_default_max_entry_count = 256;
+    static constexpr std::size_t c_default_max_byte_count  = std::size_t{256} * 1024 * 1024;
+
+    explicit Geometry_graph_cache(
+        std::size_t max_entry_count = c_default_max_entry_count,
+        std::size_t max_byte_count  = c_default_max_byte_count
+    );
+
+    // Key of an evaluation: the node's factory type name, its serialized
+    // parameters, the state append_memoization_key() added, and per input
+    // pin the payloads on its links, in link order. out_sources receives
+    // the shared payloads referenced by the key (pass them to insert()).
+    [[nodiscard]] static auto make_key(
+        std::string_view                                         type_name,
+        std::string_view                                         parameters,
+        std::string_view                                         state,
+        const std::vector<std::vector<const Geometry_payload*>>& pin_inputs,
+        std::vector<Geometry_payload>&                           out_sources
+    ) -> std::string;
+
+    [[nodiscard]] auto find  (const std::string& key) -> std::shared_ptr<const Entry>;
+    void               insert(
+        const std::string&                   key,
+        std::vector<Geometry_payload>&&      sources,
+        const std::vector<Geometry_payload>& inputs,
+        const std::vector<Geometry_payload>& outputs
+    );
+    void               clear ();
+
+    [[nodiscard]] auto get_statistics() -> Statistics;
+
+private:
+    class Slot
+    {
+    public:
+        std::shared_ptr<const Entry> entry;
+        std::uint64_t                last_use{0};
+    };
+
+    void evict();
+
+    ERHE_PROFILE_MUTEX(std::mutex, m_mutex);
+    std::unordered_map<std::string, Slot> m_slots;
+    std::size_t                           m_max_entry_count;
+    std::size_t                           m_max_byte_count;
+    std::size_t                           m_byte_count{0};
+    std::uint64_t                         m_use_serial{0};
+    std::uint64_t                         m_hit_count {0};
+    std::uint64_t                         m_miss_count{0};
+};
+
+}
@@ -58,17 +58,6 @@ void Geometry_graph_node::commit_parameter_operation(App_context& app_context, s
     );
 }
 
-void process_for_graph(erhe::geometry::Geometry& geometry)
-{
-    geometry.process(
-        {
-            .flags =
-                erhe::geometry::Geometry::process_flag_connect |
-                erhe::geometry::Geometry::process_flag_build_edges
-        }
-    );
-}
-
 void write_vec3(nlohmann::json& out, const char* key, const glm::vec3& value)
 {
     out[key] = { value.x, value.y, value.z };
@@ -146,6 +135,16 @@ auto Geometry_graph_node::get_output(const std::size_t i) const -> const Geometr
     return m_output_payloads.at(i);
 }
 
+auto Geometry_graph_node::get_input_payloads() const -> const std::vector<Geometry_payload>&
+{
+    return m_input_payloads;
+}
+
+auto Geometry_graph_node::get_output_payloads() const -> const std::vector<Geometry_payload>&
+{
+    return m_output_payloads;
+}
+
 void Geometry_graph_node::set_input(const std::size_t i, const Geometry_payload& payload)
 {
     m_input_payloads.at(i) = payload;
@@ -179,6 +178,15 @@ auto Geometry_graph_node::is_scene_output() const -> bool
     return false;
 }
 
+auto Geometry_graph_node::is_memoizable() const -> bool
+{
+    return !is_scene_output();
+}
+
+void Geometry_graph_node::append_memoization_key(std::string&) const
+{
+}
+
 void Geometry_graph_node::after_node_content(App_context& context)
 {
     // Houdini-style display ("D") / ghost ("G") designation badges. Hidden
@@ -23,13 +23,6 @@ class App_context;
 class Geometry_graph;
 class Graph_mesh;
 
-// Applies the Geometry::process() flags every generator / operation node
-// needs on its output geometry, so downstream operation nodes find
-// connectivity and edges present. Final render oriented processing
-// (normals, tangents, texture coordinates) happens in the scene output
-// node.
-void process_for_graph(erhe::geometry::Geometry& geometry);
-
 // JSON helpers for node parameter (de)serialization.
 void write_vec3 (nlohmann::json& out, const char* key, const glm::vec3& value);
 void write_vec4 (nlohmann::json& out, const char* key, const glm::vec4& value);
@@ -64,6 +57,8 @@ public:
 
     [[nodiscard]] auto get_input (std::size_t i) const -> const Geometry_payload&;
     [[nodiscard]] auto get_output(std::size_t i) const -> const Geometry_payload&;
+    [[nodiscard]] auto get_input_payloads () const -> const std::vector<Geometry_payload>&;
+    [[nodiscard]] auto get_output_payloads() const -> const std::vector<Geometry_payload>&;
     void set_input      (std::size_t i, const Geometry_payload& payload);
     void set_output     (std::size_t i, const Geometry_payload& payload);
     // multi_link marks a Blender-style multi-input socket: the pin accepts
@@ -83,6 +78,17 @@ public:
     // scene output.
     [[nodiscard]] virtual auto is_scene_output() const -> bool;
 
+    // Evaluation memoization (Geometry_graph_cache). A memoizable node's
+    // evaluate() must be a pure function of its factory type, its
+    // write_parameters() JSON, its input payloads and whatever
+    // append_memoization_key() adds, and must only write its payload
+    // slots. Scene outputs are never memoized; nodes with side effects or
+    // with evaluation state that can not be keyed override this to false.
+    [[nodiscard]] virtual auto is_memoizable() const -> bool;
+    // Appends evaluation state captured outside the parameters (see
+    // capture_evaluation_state()) to the memoization key.
+    virtual void append_memoization_key(std::string& key) const;
+
     // Called when the node leaves the graph (deletion, undo of add,
     // graph clear / load). The node object may stay alive in the undo
     // stack, so side effects outside the graph - like the scene mesh
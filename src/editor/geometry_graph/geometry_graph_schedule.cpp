@@ -0,0 +1,70 @@
+#include "geometry_graph/geometry_graph_schedule.hpp"
+
+#include "erhe_profile/profile.hpp"
+
+#include <taskflow/taskflow.hpp>
+
+#include <atomic>
+#include <exception>
+#include <mutex>
+
+namespace editor {
+
+void run_node_evaluations(
+    tf::Executor* const                          executor,
+    const std::vector<std::vector<std::size_t>>& successors,
+    const std::function<void(std::size_t)>&      evaluate
+)
+{
+    ERHE_PROFILE_FUNCTION();
+
+    const std::size_t node_count = successors.size();
+    if ((executor == nullptr) || (node_count < 2)) {
+        for (std::size_t i = 0; i < node_count; ++i) {
+            evaluate(i);
+        }
+        return;
+    }
+
+    tf::Taskflow          taskflow;
+    std::atomic<bool>     failed{false};
+    std::mutex            exception_mutex;
+    std::exception_ptr    exception{};
+    std::vector<tf::Task> tasks;
+    tasks.reserve(node_count);
+    for (std::size_t i = 0; i < node_count; ++i) {
+        tasks.push_back(
+            taskflow.emplace(
+                [i, &evaluate, &failed, &exception_mutex, &exception]() {
+                    if (failed.load()) {
+                        return;
+                    }
+                    try {
+                        evaluate(i);
+                    } catch (...) {
+                        const std::lock_guard<std::mutex> lock{exception_mutex};
+                        if (!exception) {
+                            exception = std::current_exception();
+                        }
+                        failed.store(true);
+                    }
+                }
+            )
+        );
+    }
+    for (std::size_t i = 0; i < node_count; ++i) {
+        for (const std::size_t successor : successors[i]) {
+            tasks[i].precede(tasks[successor]);
+        }
+    }
+    if (executor->this_worker_id() >= 0) {
+        executor->corun(taskflow);
+    } else {
+        executor->run(taskflow).wait();
+    }
+    if (exception) {
+        std::rethrow_exception(exception);
+    }
+}
+
+}
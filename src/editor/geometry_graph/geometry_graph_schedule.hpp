@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace tf { class Executor; }
+
+namespace editor {
+
+// Runs evaluate(i) once for every node i of a dependency graph whose nodes
+// are numbered in topological order: successors[i] lists the nodes that
+// read node i's outputs, all numbered above i.
+//
+// Without an executor, or with fewer than two nodes, the nodes run serially
+// in index order. Otherwise they run as a task graph following successors,
+// so nodes that do not feed each other run concurrently; called from a
+// worker of executor, the run co-runs instead of blocking that worker.
+//
+// The first exception evaluate() throws is rethrown once the run ends.
+// Nodes that have not started by then are skipped, as a serial run stops at
+// the throw.
+void run_node_evaluations(
+    tf::Executor*                                executor,
+    const std::vector<std::vector<std::size_t>>& successors,
+    const std::function<void(std::size_t)>&      evaluate
+);
+
+}
@@ -3,6 +3,7 @@
 #endif
 
 #include "geometry_graph/geometry_graph_window.hpp"
+#include "geometry_graph/geometry_graph_cache.hpp"
 #include "geometry_graph/geometry_graph_node.hpp"
 #include "geometry_graph/geometry_graph_node_factory.hpp"
 #include "geometry_graph/geometry_graph_mesh.hpp"
@@ -40,6 +41,7 @@
 #include "erhe_scene/mesh.hpp"
 #include "erhe_scene/node.hpp"
 #include "erhe_scene/scene.hpp"
+#include "erhe_scheduler/scheduler.hpp"
 
 #include <imgui/imgui.h>
 #include <imgui/imgui_internal.h>
@@ -700,6 +702,11 @@ void Geometry_graph_window::launch_evaluation(const std::shared_ptr<Graph_mesh>&
     if ((m_app_context.editor_settings != nullptr) && m_app_context.editor_settings->graph_node_previews.enabled) {
         run->shadow_graph.set_preview_mesh_memory(m_app_context.mesh_memory);
     }
+    // Independent branches fan out on the executor (the run co-runs them
+    // from its own worker), and memoized node results are shared with the
+    // live graph's cache so they survive across runs.
+    run->shadow_graph.set_executor(m_app_context.executor);
+    run->shadow_graph.set_evaluation_cache(live_graph.get_evaluation_cache());
     // A fresh Geometry_graph is born forced-full (so a graph's first
     // evaluation runs every node); the snapshot's per-node dirty flags
     // already carry the live state, so discard the shadow's birth flag
@@ -725,6 +732,7 @@ void Geometry_graph_window::launch_evaluation(const std::shared_ptr<Graph_mesh>&
             // would terminate the process. Catch at the task boundary:
             // the affected nodes simply keep stale payloads (their edits
             // re-mark them dirty).
+            const erhe::scheduler::Lane_timer lane_timer{context.scheduler, erhe::scheduler::Lane::e_interactive};
             try {
                 run->shadow_graph.evaluate_if_dirty();
             } catch (const std::exception& e) {
@@ -1197,6 +1205,20 @@ void Geometry_graph_window::controls_imgui()
     if (m_evaluation_run) {
         ImGui::TextUnformatted("Evaluating graph in background...");
     }
+
+    const std::shared_ptr<Geometry_graph_cache>& cache = m_graph_mesh->graph().get_evaluation_cache();
+    const Geometry_graph_cache::Statistics statistics = cache->get_statistics();
+    ImGui::Text(
+        "Memoized results: %zu (%.1f MiB), %llu hits, %llu misses",
+        statistics.entry_count,
+        static_cast<double>(statistics.byte_count) / (1024.0 * 1024.0),
+        static_cast<unsigned long long>(statistics.hit_count),
+        static_cast<unsigned long long>(statistics.miss_count)
+    );
+    ImGui::SameLine();
+    if (ImGui::SmallButton("Clear")) {
+        cache->clear();
+    }
 }
 
 void Geometry_graph_window::imgui()
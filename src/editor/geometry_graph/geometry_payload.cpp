@@ -1,7 +1,5 @@
 #include "geometry_graph/geometry_payload.hpp"
 
-#include "geometry_graph/geometry_graph_node.hpp"
-
 #include "erhe_geometry/geometry.hpp"
 
 #if defined(ERHE_VOXEL_LIBRARY_OPENVDB)
@@ -10,6 +8,17 @@
 
 namespace editor {
 
+void process_for_graph(erhe::geometry::Geometry& geometry)
+{
+    geometry.process(
+        {
+            .flags =
+                erhe::geometry::Geometry::process_flag_connect |
+                erhe::geometry::Geometry::process_flag_build_edges
+        }
+    );
+}
+
 auto Geometry_payload::has_value() const -> bool
 {
     return !std::holds_alternative<std::monostate>(value);
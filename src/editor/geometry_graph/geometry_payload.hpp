@@ -13,6 +13,13 @@ namespace erhe::voxel     { class Grid; }
 
 namespace editor {
 
+// Applies the Geometry::process() flags every generator / operation node
+// needs on its output geometry, so downstream operation nodes find
+// connectivity and edges present. Final render oriented processing
+// (normals, tangents, texture coordinates) happens in the scene output
+// node.
+void process_for_graph(erhe::geometry::Geometry& geometry);
+
 // Pin keys used by the geometry graph. erhe::graph::Graph::connect() rejects
 // links between pins whose keys differ, so giving each payload type its own
 // key makes connections type safe (geometry pins only connect to geometry
@@ -41,6 +41,9 @@ public:
     void read_parameters (const nlohmann::json& in) override;
     void prepare_for_evaluation() override;
     void capture_evaluation_state(const Geometry_graph_node& live_node) override;
+    // Publishes the captured geometry as is; nothing to save, and the
+    // capture is not part of the parameters.
+    [[nodiscard]] auto is_memoizable() const -> bool override { return false; }
 
     // Binds the brush and captures its geometry (main thread; used by the
     // canvas drag-drop and the picker).
@@ -68,6 +71,9 @@ public:
     void read_parameters (const nlohmann::json& in) override;
     void prepare_for_evaluation() override;
     void capture_evaluation_state(const Geometry_graph_node& live_node) override;
+    // Publishes the captured geometry as is; nothing to save, and the
+    // capture is not part of the parameters.
+    [[nodiscard]] auto is_memoizable() const -> bool override { return false; }
 
     // Binds the mesh and captures its primitives' geometries (main thread).
     // The geometry is the mesh's local-space shape; the scene node's
@@ -27,6 +27,7 @@ public:
 
     void evaluate(Geometry_graph&) override;
     void imgui   () override;
+    [[nodiscard]] auto is_memoizable() const -> bool override { return false; } // output set from outside
 };
 
 // Interface node inside a group asset: the geometry arriving here is the
@@ -39,6 +40,7 @@ public:
 
     void evaluate(Geometry_graph&) override;
     void imgui   () override;
+    [[nodiscard]] auto is_memoizable() const -> bool override { return false; } // read from outside
 };
 
 // Reusable subgraph node: loads a graph asset (a JSON file saved by the
@@ -60,6 +62,9 @@ public:
     void evaluate(Geometry_graph&) override;
     void imgui   () override;
     void on_removed_from_graph() override;
+    // The subgraph (loaded from a file, possibly holding scene outputs) is
+    // not part of the parameters.
+    [[nodiscard]] auto is_memoizable() const -> bool override { return false; }
     void write_parameters(nlohmann::json& out) const override;
     void read_parameters (const nlohmann::json& in) override;
 
@@ -125,6 +125,12 @@ void Lattice_node::capture_evaluation_state(const Geometry_graph_node& live_node
     }
 }
 
+void Lattice_node::append_memoization_key(std::string& key) const
+{
+    // The captured cage frame is evaluation state outside the parameters.
+    key.append(reinterpret_cast<const char*>(&m_captured_transform), sizeof(m_captured_transform));
+}
+
 auto Lattice_node::has_deformation() const -> bool
 {
     return std::any_of(
@@ -38,6 +38,7 @@ public:
     void update_live() override;
     void prepare_for_evaluation() override;
     void capture_evaluation_state(const Geometry_graph_node& live_node) override;
+    void append_memoization_key(std::string& key) const override;
 
     // Viewport editing API (Lattice_tool / Lattice_point_transform). Main
     // thread, live node only.
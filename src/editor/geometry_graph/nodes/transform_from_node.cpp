@@ -89,6 +89,12 @@ void Transform_from_node::capture_evaluation_state(const Geometry_graph_node& li
     }
 }
 
+void Transform_from_node::append_memoization_key(std::string& key) const
+{
+    // The captured transform is evaluation state outside the parameters.
+    key.append(reinterpret_cast<const char*>(&m_captured_transform), sizeof(m_captured_transform));
+}
+
 void Transform_from_node::evaluate(Geometry_graph&)
 {
     pull_inputs();
@@ -40,6 +40,7 @@ public:
     void update_live() override;
     void prepare_for_evaluation() override;
     void capture_evaluation_state(const Geometry_graph_node& live_node) override;
+    void append_memoization_key(std::string& key) const override;
 
     // Binds the driver node and captures its transform (main thread; null clears).
     void set_transform_node(const std::shared_ptr<erhe::scene::Node>& node);
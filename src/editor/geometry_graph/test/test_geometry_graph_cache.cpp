@@ -0,0 +1,210 @@
+// Geometry_graph_cache: what enters the memoization key (type, parameters,
+// captured state, input values and input identities, pin boundaries), hits
+// and misses, least recently used eviction by entry count and by bytes,
+// and the key sources an entry keeps alive.
+
+#include "geometry_graph/geometry_graph_cache.hpp"
+#include "geometry_graph/geometry_payload.hpp"
+
+#include "erhe_geometry/geometry.hpp"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+using editor::Geometry_graph_cache;
+using editor::Geometry_payload;
+using editor::Point_cloud;
+using Pin_inputs = std::vector<std::vector<const Geometry_payload*>>;
+
+auto make_key(const Pin_inputs& pin_inputs, std::vector<Geometry_payload>& sources) -> std::string
+{
+    return Geometry_graph_cache::make_key("Transform", R"({"scale":2.0})", "", pin_inputs, sources);
+}
+
+auto make_key(const Pin_inputs& pin_inputs) -> std::string
+{
+    std::vector<Geometry_payload> sources;
+    return make_key(pin_inputs, sources);
+}
+
+auto make_points(const std::size_t count) -> Geometry_payload
+{
+    std::shared_ptr<Point_cloud> points = std::make_shared<Point_cloud>();
+    points->positions.resize(count);
+    points->normals.resize(count);
+    return Geometry_payload{.value = points};
+}
+
+// An entry with the given outputs under key, with no inputs or sources
+void insert(Geometry_graph_cache& cache, const std::string& key, const std::vector<Geometry_payload>& outputs)
+{
+    cache.insert(key, {}, {}, outputs);
+}
+
+TEST(GeometryGraphCacheKey, TypeParametersAndStateAreKeyed)
+{
+    const Geometry_payload input{.value = 1.0f};
+    const Pin_inputs       pin_inputs{{&input}};
+    std::vector<Geometry_payload> sources;
+    const std::string key = Geometry_graph_cache::make_key("Transform", "{}", "", pin_inputs, sources);
+    EXPECT_EQ(key, Geometry_graph_cache::make_key("Transform", "{}", "", pin_inputs, sources));
+    EXPECT_NE(key, Geometry_graph_cache::make_key("Subdivide", "{}", "", pin_inputs, sources));
+    EXPECT_NE(key, Geometry_graph_cache::make_key("Transform", R"({"scale":2.0})", "", pin_inputs, sources));
+    EXPECT_NE(key, Geometry_graph_cache::make_key("Transform", "{}", "captured", pin_inputs, sources));
+
+    // Fields are separated: moving bytes from one to the next changes the key
+    EXPECT_NE(
+        Geometry_graph_cache::make_key("ab", "c", "", {}, sources),
+        Geometry_graph_cache::make_key("a", "bc", "", {}, sources)
+    );
+    // Values are keyed by value: nothing to keep alive
+    EXPECT_TRUE(sources.empty());
+}
+
+TEST(GeometryGraphCacheKey, ValuesAreKeyedByTypeAndValue)
+{
+    const Geometry_payload one_float{.value = 1.0f};
+    const Geometry_payload two_float{.value = 2.0f};
+    const Geometry_payload one_int  {.value = 1};
+    const Geometry_payload empty    {};
+
+    const std::string key = make_key({{&one_float}});
+    EXPECT_NE(key, make_key({{&two_float}}));
+    EXPECT_NE(key, make_key({{&one_int}}));
+    EXPECT_NE(key, make_key({{&empty}}));
+    EXPECT_NE(key, make_key({{}}));
+
+    // Scrubbing back to an earlier value gives the earlier key
+    const Geometry_payload one_again{.value = 1.0f};
+    EXPECT_EQ(key, make_key({{&one_again}}));
+}
+
+TEST(GeometryGraphCacheKey, PinBoundariesAndLinkOrderAreKeyed)
+{
+    const Geometry_payload a{.value = 1.0f};
+    const Geometry_payload b{.value = 2.0f};
+    EXPECT_NE(make_key({{&a, &b}}),     make_key({{&b, &a}}));
+    EXPECT_NE(make_key({{&a, &b}, {}}), make_key({{&a}, {&b}}));
+    EXPECT_NE(make_key({{&a}}),         make_key({{&a}, {}}));
+}
+
+TEST(GeometryGraphCacheKey, SharedPayloadsAreKeyedByIdentity)
+{
+    const std::shared_ptr<erhe::geometry::Geometry> geometry = std::make_shared<erhe::geometry::Geometry>("a");
+    const std::shared_ptr<erhe::geometry::Geometry> same     = std::make_shared<erhe::geometry::Geometry>("a");
+    const Geometry_payload input      {.value = geometry};
+    const Geometry_payload input_copy {.value = geometry};
+    const Geometry_payload other_input{.value = same};
+
+    std::vector<Geometry_payload> sources;
+    const std::string key = make_key({{&input}}, sources);
+    ASSERT_EQ(sources.size(), 1u);
+    EXPECT_EQ(sources.front().get_geometry(), geometry);
+
+    // The same object through another payload: same key. Equal content in
+    // a different object: a different key.
+    EXPECT_EQ(key, make_key({{&input_copy}}));
+    EXPECT_NE(key, make_key({{&other_input}}));
+
+    // A null geometry is keyed but has nothing to keep alive
+    const Geometry_payload null_geometry{.value = std::shared_ptr<erhe::geometry::Geometry>{}};
+    sources.clear();
+    EXPECT_NE(key, make_key({{&null_geometry}}, sources));
+    EXPECT_TRUE(sources.empty());
+}
+
+TEST(GeometryGraphCache, MissThenHit)
+{
+    Geometry_graph_cache cache;
+    EXPECT_EQ(cache.find("a"), nullptr);
+
+    const Geometry_payload output{.value = 3.0f};
+    cache.insert("a", {}, {Geometry_payload{.value = 1.0f}}, {output});
+    const std::shared_ptr<const Geometry_graph_cache::Entry> entry = cache.find("a");
+    ASSERT_NE(entry, nullptr);
+    ASSERT_EQ(entry->inputs.size(), 1u);
+    EXPECT_EQ(entry->inputs.front().get_float(), 1.0f);
+    ASSERT_EQ(entry->outputs.size(), 1u);
+    EXPECT_EQ(entry->outputs.front().get_float(), 3.0f);
+
+    const Geometry_graph_cache::Statistics statistics = cache.get_statistics();
+    EXPECT_EQ(statistics.entry_count, 1u);
+    EXPECT_EQ(statistics.hit_count,   1u);
+    EXPECT_EQ(statistics.miss_count,  1u);
+
+    cache.clear();
+    EXPECT_EQ(cache.find("a"), nullptr);
+    EXPECT_EQ(cache.get_statistics().entry_count, 0u);
+    EXPECT_EQ(cache.get_statistics().byte_count,  0u);
+}
+
+TEST(GeometryGraphCache, EvictsLeastRecentlyUsedEntries)
+{
+    Geometry_graph_cache cache{3};
+    insert(cache, "a", {Geometry_payload{.value = 1.0f}});
+    insert(cache, "b", {Geometry_payload{.value = 2.0f}});
+    insert(cache, "c", {Geometry_payload{.value = 3.0f}});
+
+    // A hit makes a the most recently used, so the fourth entry evicts b
+    EXPECT_NE(cache.find("a"), nullptr);
+    insert(cache, "d", {Geometry_payload{.value = 4.0f}});
+    EXPECT_EQ(cache.get_statistics().entry_count, 3u);
+    EXPECT_NE(cache.find("a"), nullptr);
+    EXPECT_EQ(cache.find("b"), nullptr);
+    EXPECT_NE(cache.find("c"), nullptr);
+    EXPECT_NE(cache.find("d"), nullptr);
+
+    // Replacing an entry under the same key does not grow the cache
+    insert(cache, "d", {Geometry_payload{.value = 5.0f}});
+    EXPECT_EQ(cache.get_statistics().entry_count, 3u);
+    EXPECT_EQ(cache.find("d")->outputs.front().get_float(), 5.0f);
+}
+
+TEST(GeometryGraphCache, EvictsToByteBudget)
+{
+    // Each entry: a one byte key and 100 points of 24 bytes
+    constexpr std::size_t entry_byte_count = 1 + 100 * 24;
+    Geometry_graph_cache cache{256, 2 * entry_byte_count};
+
+    insert(cache, "a", {make_points(100)});
+    insert(cache, "b", {make_points(100)});
+    EXPECT_EQ(cache.get_statistics().byte_count, 2 * entry_byte_count);
+
+    insert(cache, "c", {make_points(100)});
+    EXPECT_EQ(cache.get_statistics().entry_count, 2u);
+    EXPECT_EQ(cache.get_statistics().byte_count, 2 * entry_byte_count);
+    EXPECT_EQ(cache.find("a"), nullptr);
+
+    // A result larger than the whole budget is not cached, and does not
+    // evict anything on the way
+    insert(cache, "d", {make_points(1000)});
+    EXPECT_EQ(cache.find("d"), nullptr);
+    EXPECT_NE(cache.find("b"), nullptr);
+    EXPECT_NE(cache.find("c"), nullptr);
+}
+
+TEST(GeometryGraphCache, EntriesKeepKeySourcesAlive)
+{
+    Geometry_graph_cache cache{1};
+    std::weak_ptr<erhe::geometry::Geometry> weak_geometry;
+    {
+        const Geometry_payload input{.value = std::make_shared<erhe::geometry::Geometry>("input")};
+        weak_geometry = input.get_geometry();
+        std::vector<Geometry_payload> sources;
+        const std::string key = make_key({{&input}}, sources);
+        cache.insert(key, std::move(sources), {}, {Geometry_payload{.value = 1.0f}});
+    }
+    // While the entry lives, its key's address can not be reused by a
+    // different geometry
+    EXPECT_FALSE(weak_geometry.expired());
+
+    insert(cache, "other", {Geometry_payload{.value = 2.0f}});
+    EXPECT_TRUE(weak_geometry.expired());
+}
+
+} // anonymous namespace
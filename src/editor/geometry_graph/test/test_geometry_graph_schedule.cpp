@@ -0,0 +1,311 @@
+// run_node_evaluations(), the scheduler behind Geometry_graph::evaluate():
+// serial and parallel runs of the same graph give the same geometry, with
+// and without Geometry_graph_cache hits; parallel runs respect every
+// dependency, co-run on the calling worker, and stop at the first throw.
+
+#include "geometry_graph/geometry_graph_cache.hpp"
+#include "geometry_graph/geometry_graph_schedule.hpp"
+#include "geometry_graph/geometry_payload.hpp"
+
+#include "erhe_geometry/geometry.hpp"
+#include "erhe_geometry/geometry_delta.hpp"
+#include "erhe_geometry/geometry_serialization.hpp"
+#include "erhe_geometry/operation/conway/subdivide.hpp"
+#include "erhe_geometry/shapes/box.hpp"
+#include "erhe_geometry/shapes/torus.hpp"
+
+#include <gtest/gtest.h>
+#include <taskflow/taskflow.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+using editor::Geometry_graph_cache;
+using editor::Geometry_payload;
+using editor::run_node_evaluations;
+using erhe::geometry::Geometry;
+
+auto make_torus(const float size) -> Geometry_payload
+{
+    std::shared_ptr<Geometry> geometry = std::make_shared<Geometry>("torus");
+    erhe::geometry::shapes::make_torus(geometry->get_mesh(), size, 0.25f * size, 16, 12);
+    editor::process_for_graph(*geometry);
+    return Geometry_payload{.value = geometry};
+}
+
+auto make_box(const float size) -> Geometry_payload
+{
+    std::shared_ptr<Geometry> geometry = std::make_shared<Geometry>("box");
+    erhe::geometry::shapes::make_box(geometry->get_mesh(), size);
+    editor::process_for_graph(*geometry);
+    return Geometry_payload{.value = geometry};
+}
+
+auto subdivide(const Geometry_payload& input) -> Geometry_payload
+{
+    std::shared_ptr<Geometry> geometry = std::make_shared<Geometry>("subdivided");
+    erhe::geometry::operation::subdivide(*input.get_geometry(), *geometry);
+    editor::process_for_graph(*geometry);
+    return Geometry_payload{.value = geometry};
+}
+
+auto join(const Geometry_payload& lhs, const Geometry_payload& rhs) -> Geometry_payload
+{
+    Geometry_payload result = lhs;
+    result += rhs;
+    return result;
+}
+
+auto get_hash(const Geometry_payload& payload) -> uint64_t
+{
+    return erhe::geometry::get_flat_data_hash(erhe::geometry::geometry_to_flat_data(*payload.get_geometry()));
+}
+
+// A stand-in for Geometry_graph nodes: type, parameters and inputs, and an
+// evaluation that memoizes the way Geometry_graph::evaluate_node() does
+class Test_node
+{
+public:
+    std::string              type;
+    float                    size{1.0f};
+    std::vector<std::size_t> inputs;
+    Geometry_payload         output;
+};
+
+class Test_graph
+{
+public:
+    // Nodes in topological order: two branches of subdivided tori and a
+    // box branch, joined pairwise
+    Test_graph()
+    {
+        nodes = {
+            Test_node{.type = "torus",     .size = 1.0f, .inputs = {}},     // 0
+            Test_node{.type = "torus",     .size = 2.0f, .inputs = {}},     // 1
+            Test_node{.type = "box",       .size = 1.5f, .inputs = {}},     // 2
+            Test_node{.type = "subdivide", .size = 0.0f, .inputs = {0}},    // 3
+            Test_node{.type = "subdivide", .size = 0.0f, .inputs = {1}},    // 4
+            Test_node{.type = "join",      .size = 0.0f, .inputs = {3, 2}}, // 5
+            Test_node{.type = "join",      .size = 0.0f, .inputs = {4, 5}}, // 6
+            Test_node{.type = "subdivide", .size = 0.0f, .inputs = {2}},    // 7
+            Test_node{.type = "join",      .size = 0.0f, .inputs = {6, 7}}  // 8
+        };
+    }
+
+    void run(tf::Executor* executor)
+    {
+        std::vector<std::vector<std::size_t>> successors(nodes.size());
+        for (std::size_t i = 0; i < nodes.size(); ++i) {
+            for (const std::size_t input : nodes[i].inputs) {
+                successors[input].push_back(i);
+            }
+        }
+        run_node_evaluations(executor, successors, [this](const std::size_t i) { evaluate(nodes[i]); });
+    }
+
+    void evaluate(Test_node& node)
+    {
+        std::string                   key;
+        std::vector<Geometry_payload> key_sources;
+        if (cache) {
+            std::vector<std::vector<const Geometry_payload*>> pin_inputs;
+            for (const std::size_t input : node.inputs) {
+                pin_inputs.push_back({&nodes[input].output});
+            }
+            key = Geometry_graph_cache::make_key(node.type, std::to_string(node.size), "", pin_inputs, key_sources);
+            const std::shared_ptr<const Geometry_graph_cache::Entry> entry = cache->find(key);
+            if (entry) {
+                node.output = entry->outputs.front();
+                return;
+            }
+        }
+        ++evaluation_count;
+        if (node.type == "torus") {
+            node.output = make_torus(node.size);
+        } else if (node.type == "box") {
+            node.output = make_box(node.size);
+        } else if (node.type == "subdivide") {
+            node.output = subdivide(nodes[node.inputs[0]].output);
+        } else {
+            node.output = join(nodes[node.inputs[0]].output, nodes[node.inputs[1]].output);
+        }
+        if (cache) {
+            cache->insert(key, std::move(key_sources), {}, {node.output});
+        }
+    }
+
+    [[nodiscard]] auto get_hashes() const -> std::vector<uint64_t>
+    {
+        std::vector<uint64_t> hashes;
+        for (const Test_node& node : nodes) {
+            hashes.push_back(get_hash(node.output));
+        }
+        return hashes;
+    }
+
+    std::vector<Test_node>                nodes;
+    std::shared_ptr<Geometry_graph_cache> cache;
+    std::atomic<int>                      evaluation_count{0};
+};
+
+TEST(GeometryGraphSchedule, ParallelMatchesSerial)
+{
+    Test_graph serial;
+    serial.run(nullptr);
+    EXPECT_EQ(serial.evaluation_count.load(), 9);
+    EXPECT_GT(serial.nodes.back().output.get_geometry()->get_mesh().facets.nb(), 0u);
+
+    tf::Executor executor{4};
+    for (int run = 0; run < 4; ++run) {
+        Test_graph parallel;
+        parallel.run(&executor);
+        EXPECT_EQ(parallel.evaluation_count.load(), 9);
+        EXPECT_EQ(parallel.get_hashes(), serial.get_hashes()) << "run " << run;
+    }
+}
+
+TEST(GeometryGraphSchedule, MemoizedRunsMatchSerial)
+{
+    Test_graph serial;
+    serial.run(nullptr);
+
+    tf::Executor executor{4};
+    Test_graph   graph;
+    graph.cache = std::make_shared<Geometry_graph_cache>();
+    graph.run(&executor);
+    EXPECT_EQ(graph.evaluation_count.load(), 9);
+    EXPECT_EQ(graph.get_hashes(), serial.get_hashes());
+    const std::shared_ptr<Geometry> first_result = graph.nodes.back().output.get_geometry();
+
+    // Everything is a hit, down to the same result object
+    graph.evaluation_count = 0;
+    graph.run(&executor);
+    EXPECT_EQ(graph.evaluation_count.load(), 0);
+    EXPECT_EQ(graph.nodes.back().output.get_geometry(), first_result);
+
+    // A box edit re-runs the box and what depends on it: 2, 5, 6, 7 and 8
+    graph.evaluation_count = 0;
+    graph.nodes[2].size = 3.0f;
+    graph.run(&executor);
+    EXPECT_EQ(graph.evaluation_count.load(), 5);
+    EXPECT_NE(graph.get_hashes().back(), serial.get_hashes().back());
+
+    // Scrubbing back adopts the first results again
+    graph.evaluation_count = 0;
+    graph.nodes[2].size = 1.5f;
+    graph.run(&executor);
+    EXPECT_EQ(graph.evaluation_count.load(), 0);
+    EXPECT_EQ(graph.nodes.back().output.get_geometry(), first_result);
+    EXPECT_EQ(graph.get_hashes(), serial.get_hashes());
+}
+
+// A random graph of 200 nodes in topological order. Each node checks that
+// all its inputs have finished and combines their values.
+class Random_graph
+{
+public:
+    explicit Random_graph(const uint32_t seed)
+    {
+        std::mt19937 random{seed};
+        inputs.resize(200);
+        successors.resize(200);
+        for (std::size_t i = 1; i < inputs.size(); ++i) {
+            const std::size_t input_count = random() % 4u;
+            for (std::size_t j = 0; j < input_count; ++j) {
+                const std::size_t input = random() % i;
+                inputs[i].push_back(input);
+                successors[input].push_back(i);
+            }
+        }
+    }
+
+    void run(tf::Executor* executor)
+    {
+        values   = std::vector<uint64_t>(inputs.size(), 0);
+        finished = std::vector<std::atomic<bool>>(inputs.size());
+        run_node_evaluations(
+            executor,
+            successors,
+            [this](const std::size_t i) {
+                uint64_t value = i + 1;
+                for (const std::size_t input : inputs[i]) {
+                    if (!finished[input].load()) {
+                        ++order_violations;
+                    }
+                    value = (value * 1099511628211ull) ^ values[input];
+                }
+                values[i] = value;
+                finished[i].store(true);
+            }
+        );
+    }
+
+    std::vector<std::vector<std::size_t>> inputs;
+    std::vector<std::vector<std::size_t>> successors;
+    std::vector<uint64_t>                 values;
+    std::vector<std::atomic<bool>>        finished;
+    std::atomic<int>                      order_violations{0};
+};
+
+TEST(GeometryGraphSchedule, ParallelRespectsDependencies)
+{
+    tf::Executor executor{8};
+    for (uint32_t seed = 1; seed <= 8; ++seed) {
+        Random_graph graph{seed};
+        graph.run(nullptr);
+        const std::vector<uint64_t> serial_values = graph.values;
+        graph.run(&executor);
+        EXPECT_EQ(graph.order_violations.load(), 0) << "seed " << seed;
+        EXPECT_EQ(graph.values, serial_values) << "seed " << seed;
+    }
+}
+
+TEST(GeometryGraphSchedule, CorunsOnCallingWorker)
+{
+    // The background evaluation runs on a worker of the same executor; with
+    // a single worker, blocking it on the run would never finish
+    tf::Executor executor{1};
+    Random_graph graph{1};
+    executor.async([&graph, &executor]() { graph.run(&executor); }).get();
+    EXPECT_EQ(graph.order_violations.load(), 0);
+    for (const std::atomic<bool>& finished : graph.finished) {
+        EXPECT_TRUE(finished.load());
+    }
+}
+
+TEST(GeometryGraphSchedule, StopsAtFirstThrow)
+{
+    // A chain 0 -> 1 -> 2 -> 3 where 1 throws
+    const std::vector<std::vector<std::size_t>> successors{{1}, {2}, {3}, {}};
+    tf::Executor executor{4};
+    for (tf::Executor* run_executor : {static_cast<tf::Executor*>(nullptr), &executor}) {
+        std::vector<std::atomic<bool>> evaluated(successors.size());
+        EXPECT_THROW(
+            run_node_evaluations(
+                run_executor,
+                successors,
+                [&evaluated](const std::size_t i) {
+                    evaluated[i].store(true);
+                    if (i == 1) {
+                        throw std::runtime_error{"node 1 failed"};
+                    }
+                }
+            ),
+            std::runtime_error
+        );
+        EXPECT_TRUE (evaluated[0].load());
+        EXPECT_TRUE (evaluated[1].load());
+        EXPECT_FALSE(evaluated[2].load());
+        EXPECT_FALSE(evaluated[3].load());
+    }
+}
+
+} // anonymous namespace
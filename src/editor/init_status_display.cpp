@@ -70,6 +70,25 @@ constexpr std::array<double, 4> c_clear_color_text_disabled = desaturate(c_clear
 // surrounding room shows through ("floating panel" look).
 constexpr std::array<double, 4> c_clear_color_transparent{0.0, 0.0, 0.0, 0.0};
 
+// Measures each line, which rasterizes glyphs the font has not drawn before,
+// then uploads those glyphs. Must run before the render pass begins: print()
+// skips glyphs that are not uploaded yet, so without this a line would show
+// up incomplete - or not at all - on the frame that first draws it.
+[[nodiscard]] auto measure_and_upload_lines(
+    erhe::renderer::Text_renderer&  text_renderer,
+    const std::vector<std::string>& lines,
+    erhe::graphics::Command_buffer& command_buffer
+) -> std::vector<erhe::ui::Rectangle>
+{
+    std::vector<erhe::ui::Rectangle> bounds;
+    bounds.reserve(lines.size());
+    for (const std::string& line : lines) {
+        bounds.push_back(line.empty() ? erhe::ui::Rectangle{} : text_renderer.measure(line));
+    }
+    text_renderer.upload_glyphs(command_buffer);
+    return bounds;
+}
+
 } // namespace
 
 Init_status_display::Init_status_display(
@@ -152,6 +171,10 @@ void Init_status_display::render_text_overlay(
     render_pass_descriptor.view_mask            = view_mask;
     render_pass_descriptor.debug_label          = erhe::utility::Debug_label{std::string_view{debug_label}};
 
+    const std::vector<erhe::ui::Rectangle> line_bounds = draw_text
+        ? measure_and_upload_lines(m_text_renderer, m_render_lines, command_buffer)
+        : std::vector<erhe::ui::Rectangle>{};
+
     erhe::graphics::Render_pass            xr_render_pass{m_graphics_device, render_pass_descriptor};
     erhe::graphics::Render_command_encoder encoder = m_graphics_device.make_render_command_encoder(command_buffer);
     {
@@ -183,7 +206,7 @@ void Init_status_display::render_text_overlay(
                 if (line.empty()) {
                     continue;
                 }
-                const erhe::ui::Rectangle bounds = m_text_renderer.measure(line);
+                const erhe::ui::Rectangle& bounds = line_bounds[i];
                 const float text_width  = static_cast<float>(bounds.size().x);
                 const float x           = (static_cast<float>(width) - text_width) * 0.5f;
                 const float offset_from_center =
@@ -350,6 +373,8 @@ void Init_status_display::render_present_desktop()
         render_pass_descriptor.render_target_height               = height;
         render_pass_descriptor.debug_label                        = "Init_status_display";
 
+        const std::vector<erhe::ui::Rectangle> line_bounds = measure_and_upload_lines(m_text_renderer, m_render_lines, swap_cb);
+
         erhe::graphics::Render_pass        render_pass{m_graphics_device, render_pass_descriptor};
         erhe::graphics::Render_command_encoder encoder = m_graphics_device.make_render_command_encoder(swap_cb);
         {
@@ -379,7 +404,7 @@ void Init_status_display::render_present_desktop()
                 if (line.empty()) {
                     continue;
                 }
-                const erhe::ui::Rectangle bounds = m_text_renderer.measure(line);
+                const erhe::ui::Rectangle& bounds = line_bounds[i];
                 const float text_width  = static_cast<float>(bounds.size().x);
                 const float x           = (static_cast<float>(width) - text_width) * 0.5f;
                 const float offset_from_center =
@@ -10,6 +10,7 @@
 #include "erhe_geometry/geometry.hpp"
 #include "erhe_scene/mesh.hpp"
 #include "erhe_scene/node.hpp"
+#include "erhe_scheduler/scheduler.hpp"
 #include "erhe_verify/verify.hpp"
 
 #include <taskflow/taskflow.hpp>
@@ -171,6 +172,7 @@ void async_for_nodes_with_mesh(
         [&context, op, items, selected_facets = std::move(selected_facets), component_selection = std::move(component_selection)]()
         {
             ++context.running_async_ops;
+            const erhe::scheduler::Lane_timer lane_timer{context.scheduler, erhe::scheduler::Lane::e_interactive};
             // Geometry operations call into Geogram, whose assertion mechanism
             // throws by default (GEO::ASSERT_THROW). An exception escaping this
             // worker task would call std::terminate (process abort + a modal
@@ -0,0 +1,178 @@
+#include "mcp/mcp_json_writer.hpp"
+
+#include <fmt/format.h>
+
+#include <charconv>
+#include <cmath>
+
+namespace editor {
+
+Mcp_json_writer::Mcp_json_writer(std::string& out, const bool embed_as_string)
+    : m_out  {out}
+    , m_embed{embed_as_string}
+{
+}
+
+void Mcp_json_writer::raw(const char c)
+{
+    if (!m_embed) {
+        m_out.push_back(c);
+        return;
+    }
+    // The document itself never contains raw control characters (value()
+    // escapes them), so only quote and backslash need a second escape.
+    if ((c == '"') || (c == '\\')) {
+        m_out.push_back('\\');
+    }
+    m_out.push_back(c);
+}
+
+void Mcp_json_writer::raw(const std::string_view text)
+{
+    if (!m_embed) {
+        m_out.append(text);
+        return;
+    }
+    for (const char c : text) {
+        raw(c);
+    }
+}
+
+void Mcp_json_writer::separator()
+{
+    if (m_need_comma) {
+        raw(',');
+    }
+    m_need_comma = true;
+}
+
+void Mcp_json_writer::begin_object()
+{
+    separator();
+    raw('{');
+    m_need_comma = false;
+}
+
+void Mcp_json_writer::end_object()
+{
+    raw('}');
+    m_need_comma = true;
+}
+
+void Mcp_json_writer::begin_array()
+{
+    separator();
+    raw('[');
+    m_need_comma = false;
+}
+
+void Mcp_json_writer::end_array()
+{
+    raw(']');
+    m_need_comma = true;
+}
+
+void Mcp_json_writer::key(const std::string_view name)
+{
+    value(name);
+    raw(':');
+    m_need_comma = false;
+}
+
+void Mcp_json_writer::value(const std::string_view v)
+{
+    static constexpr char c_hex[] = "0123456789abcdef";
+    separator();
+    raw('"');
+    for (const char c : v) {
+        switch (c) {
+            case '"':  raw("\\\""); break;
+            case '\\': raw("\\\\"); break;
+            case '\b': raw("\\b");  break;
+            case '\f': raw("\\f");  break;
+            case '\n': raw("\\n");  break;
+            case '\r': raw("\\r");  break;
+            case '\t': raw("\\t");  break;
+            default: {
+                const unsigned char u = static_cast<unsigned char>(c);
+                if (u < 0x20u) {
+                    const char escape[] = { '\\', 'u', '0', '0', c_hex[u >> 4u], c_hex[u & 0xfu] };
+                    raw(std::string_view{escape, sizeof(escape)});
+                } else {
+                    raw(c);
+                }
+                break;
+            }
+        }
+    }
+    raw('"');
+}
+
+void Mcp_json_writer::value(const char* const v)
+{
+    value(std::string_view{v});
+}
+
+void Mcp_json_writer::value(const bool v)
+{
+    separator();
+    raw(v ? std::string_view{"true"} : std::string_view{"false"});
+}
+
+void Mcp_json_writer::value(const float v)
+{
+    if (!std::isfinite(v)) {
+        null();
+        return;
+    }
+    char buffer[32];
+    const auto result = fmt::format_to_n(buffer, sizeof(buffer), "{}", v);
+    separator();
+    raw(std::string_view{buffer, result.size});
+}
+
+void Mcp_json_writer::value(const double v)
+{
+    if (!std::isfinite(v)) {
+        null();
+        return;
+    }
+    char buffer[32];
+    const auto result = fmt::format_to_n(buffer, sizeof(buffer), "{}", v);
+    separator();
+    raw(std::string_view{buffer, result.size});
+}
+
+void Mcp_json_writer::null()
+{
+    separator();
+    raw("null");
+}
+
+void Mcp_json_writer::write_integer(const int64_t v)
+{
+    char buffer[24];
+    const std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), v);
+    separator();
+    raw(std::string_view{buffer, static_cast<std::size_t>(result.ptr - buffer)});
+}
+
+void Mcp_json_writer::write_unsigned(const uint64_t v)
+{
+    char buffer[24];
+    const std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), v);
+    separator();
+    raw(std::string_view{buffer, static_cast<std::size_t>(result.ptr - buffer)});
+}
+
+void begin_json_text_content(std::string& out)
+{
+    out.append(R"({"content":[{"type":"text","text":")");
+}
+
+void end_json_text_content(std::string& out)
+{
+    out.append(R"("}]})");
+}
+
+} // namespace editor
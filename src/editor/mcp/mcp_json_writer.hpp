@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace editor {
+
+// Appends compact JSON to a string while it is produced, without building a
+// nlohmann::json tree first. Used by the query tools whose results grow with
+// the scene (see mcp_scene_snapshot.hpp).
+//
+// With embed_as_string the output is escaped once more, as the contents of a
+// JSON string literal: a tool result document can then be written straight
+// into the "text" member of a content block (begin_json_text_content() /
+// end_json_text_content()) instead of being dumped and escaped as a copy.
+//
+// No structure checks are made; callers pair begin / end and put a key()
+// before each object member.
+class Mcp_json_writer
+{
+public:
+    explicit Mcp_json_writer(std::string& out, bool embed_as_string = false);
+
+    void begin_object();
+    void end_object  ();
+    void begin_array ();
+    void end_array   ();
+    void key         (std::string_view name);
+
+    void value(std::string_view v);
+    void value(const char* v);
+    void value(bool v);
+    void value(float v);  // non-finite values are written as null, as nlohmann does
+    void value(double v);
+    void null ();
+
+    template <typename T>
+        requires (std::is_integral_v<T> && !std::is_same_v<T, bool>)
+    void value(const T v)
+    {
+        if constexpr (std::is_signed_v<T>) {
+            write_integer(static_cast<int64_t>(v));
+        } else {
+            write_unsigned(static_cast<uint64_t>(v));
+        }
+    }
+
+private:
+    void separator     ();
+    void raw           (char c);
+    void raw           (std::string_view text);
+    void write_integer (int64_t v);
+    void write_unsigned(uint64_t v);
+
+    std::string& m_out;
+    bool         m_embed     {false};
+    bool         m_need_comma{false};
+};
+
+// {"content":[{"type":"text","text":" ... "}]} around a document written with
+// an embed_as_string writer; the same shape as make_json_content().
+void begin_json_text_content(std::string& out);
+void end_json_text_content  (std::string& out);
+
+} // namespace editor
@@ -0,0 +1,757 @@
+// Read-only scene snapshot for MCP queries served off the main thread.
+
+#include "mcp/mcp_scene_snapshot.hpp"
+#include "mcp/mcp_json_writer.hpp"
+#include "mcp/mcp_server_shared.hpp"
+
+#include "app_context.hpp"
+#include "app_rendering.hpp"
+#include "app_scenes.hpp"
+#include "content_library/content_library.hpp"
+#include "rendergraph/shadow_render_node.hpp"
+#include "scene/scene_root.hpp"
+
+#include "erhe_primitive/material.hpp"
+#include "erhe_scene/camera.hpp"
+#include "erhe_scene/light.hpp"
+#include "erhe_scene/node.hpp"
+#include "erhe_scene/scene.hpp"
+#include "erhe_scene/trs_transform.hpp"
+#include "erhe_scene_renderer/light_buffer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <limits>
+#include <span>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+namespace editor {
+
+using namespace mcp_server_detail;
+
+namespace {
+
+[[nodiscard]] auto light_type_name(const erhe::scene::Light_type type) -> const char*
+{
+    switch (type) {
+        case erhe::scene::Light_type::directional: return "directional";
+        case erhe::scene::Light_type::point:       return "point";
+        case erhe::scene::Light_type::spot:        return "spot";
+        default:                                   return "unknown";
+    }
+}
+
+[[nodiscard]] auto find_light_projections(App_context& context, const Scene_root& scene_root) -> const erhe::scene_renderer::Light_projections*
+{
+    if (context.app_rendering == nullptr) {
+        return nullptr;
+    }
+    for (const std::shared_ptr<Shadow_render_node>& shadow_node : context.app_rendering->get_all_shadow_nodes()) {
+        if (!shadow_node) {
+            continue;
+        }
+        const std::shared_ptr<Scene_root> node_scene_root = shadow_node->get_scene_view().get_scene_root();
+        if (node_scene_root.get() == &scene_root) {
+            return &shadow_node->get_light_projections();
+        }
+    }
+    return nullptr;
+}
+
+// Records [first, end) of a list; see capture_scene_record()
+class Record_range
+{
+public:
+    Record_range(const std::size_t first, const std::size_t count)
+        : first{first}
+        , end  {(count > std::numeric_limits<std::size_t>::max() - first) ? std::numeric_limits<std::size_t>::max() : first + count}
+    {
+    }
+
+    std::size_t first;
+    std::size_t end;
+};
+
+void capture_node(const erhe::scene::Node& node, Mcp_scene_snapshot::Node_record& record)
+{
+    const erhe::scene::Trs_transform& trs = node.parent_from_node_transform();
+    const std::shared_ptr<erhe::scene::Node> parent_node = node.get_parent_node();
+    record.name        = node.get_name();
+    record.id          = node.get_id();
+    record.parent_name = parent_node ? parent_node->get_name() : std::string{};
+    record.parent_id   = parent_node ? std::optional<std::size_t>{parent_node->get_id()} : std::nullopt;
+    record.translation = trs.get_translation();
+    record.rotation    = trs.get_rotation();
+    record.scale       = trs.get_scale();
+    for (const auto& attachment : node.get_attachments()) {
+        record.attachment_types.emplace_back(attachment->get_type_name());
+    }
+    record.locked      = node.is_lock_edit();
+    record.import_root = (node.get_flag_bits() & erhe::Item_flags::import_root) != 0;
+    for (const auto& tag : node.get_tags()) {
+        record.tags.emplace_back(tag);
+    }
+}
+
+void capture_nodes(const erhe::scene::Scene& scene, const Record_range range, std::vector<Mcp_scene_snapshot::Node_record>& out)
+{
+    out.reserve(std::min(scene.get_node_count(), range.end) - std::min(scene.get_node_count(), range.first));
+
+    // Node positions run through both node buckets in Scene::for_each_node()
+    // order. The page is indexed directly, so a page deep into a large scene
+    // costs its own size, not its offset.
+    std::size_t bucket_first = 0;
+    for (const std::vector<std::shared_ptr<erhe::scene::Node>>* nodes : {&scene.get_transform_update_nodes(), &scene.get_no_transform_update_nodes()}) {
+        const std::size_t bucket_end = bucket_first + nodes->size();
+        for (std::size_t index = std::max(range.first, bucket_first), end = std::min(range.end, bucket_end); index < end; ++index) {
+            capture_node(*(*nodes)[index - bucket_first].get(), out.emplace_back());
+        }
+        bucket_first = bucket_end;
+    }
+}
+
+void capture_cameras(const erhe::scene::Scene& scene, const Record_range range, std::vector<Mcp_scene_snapshot::Camera_record>& out)
+{
+    // "selectable": offered in camera-selection UI (see get_selectable_cameras);
+    // false for cameras embedded in content (prefab instances, import wrappers).
+    const std::vector<std::shared_ptr<erhe::scene::Camera>> selectable_cameras = get_selectable_cameras(scene);
+    const auto& cameras = scene.get_cameras();
+    for (std::size_t index = range.first, end = std::min(range.end, cameras.size()); index < end; ++index) {
+        const std::shared_ptr<erhe::scene::Camera>& camera = cameras[index];
+        const erhe::scene::Node*       node       = camera->get_node();
+        const erhe::scene::Projection* projection = camera->projection();
+        out.push_back(
+            Mcp_scene_snapshot::Camera_record{
+                .name         = camera->get_name(),
+                .id           = camera->get_id(),
+                .node_name    = (node != nullptr) ? node->get_name() : std::string{},
+                .exposure     = camera->get_exposure(),
+                .shadow_range = camera->get_shadow_range(),
+                .fov_y        = (projection != nullptr) ? projection->fov_y : 0.0f,
+                .selectable   = std::find(selectable_cameras.begin(), selectable_cameras.end(), camera) != selectable_cameras.end()
+            }
+        );
+    }
+}
+
+void capture_lights(
+    const erhe::scene::Scene&                       scene,
+    const erhe::scene_renderer::Light_projections*  light_projections,
+    const Record_range                              range,
+    std::vector<Mcp_scene_snapshot::Light_record>&  out
+)
+{
+    constexpr std::size_t no_index = std::numeric_limits<std::size_t>::max();
+    std::size_t layer_first = 0;
+    for (const auto& light_layer : scene.get_light_layers()) {
+        const std::size_t layer_end = layer_first + light_layer->lights.size();
+        const std::size_t end       = std::min(range.end, layer_end);
+        for (std::size_t index = std::max(range.first, layer_first); index < end; ++index) {
+            const std::shared_ptr<erhe::scene::Light>& light = light_layer->lights[index - layer_first];
+            const erhe::scene::Node* node = light->get_node();
+            Mcp_scene_snapshot::Light_record& record = out.emplace_back();
+            record.name        = light->get_name();
+            record.id          = light->get_id();
+            record.node_name   = (node != nullptr) ? node->get_name() : std::string{};
+            record.type        = light_type_name(light->type);
+            record.color       = light->color;
+            record.intensity   = light->intensity;
+            record.range       = light->range;
+            record.cast_shadow = light->cast_shadow;
+            const erhe::scene::Light_projection_transforms* transforms = (light_projections != nullptr)
+                ? light_projections->get_light_projection_transforms_for_light(light.get())
+                : nullptr;
+            if (transforms != nullptr) {
+                record.has_projection = true;
+                record.shaded         = (transforms->index != no_index);
+                record.shadow_mapped  = transforms->is_shadow_mapped();
+                if (transforms->shadow_index != no_index) {
+                    record.shadow_index = transforms->shadow_index;
+                }
+                if (transforms->point_shadow_index != no_index) {
+                    record.point_shadow_index = transforms->point_shadow_index;
+                }
+            }
+        }
+        layer_first = layer_end;
+    }
+}
+
+void capture_materials(const Scene_root& scene_root, const Record_range range, std::vector<Mcp_scene_snapshot::Material_record>& out)
+{
+    const std::shared_ptr<Content_library> library = scene_root.get_content_library();
+    if (!library || !library->materials) {
+        return;
+    }
+    const std::vector<std::shared_ptr<erhe::primitive::Material>>& materials = library->materials->get_all<erhe::primitive::Material>();
+    for (std::size_t index = range.first, end = std::min(range.end, materials.size()); index < end; ++index) {
+        const std::shared_ptr<erhe::primitive::Material>& material = materials[index];
+        out.push_back(
+            Mcp_scene_snapshot::Material_record{
+                .name       = material->get_name(),
+                .id         = material->get_id(),
+                .base_color = glm::vec3{material->data.base_color},
+                .metallic   = material->data.metallic,
+                .roughness  = material->data.roughness.x,
+                .emissive   = glm::vec3{material->data.emissive}
+            }
+        );
+    }
+}
+
+void write_vec3(Mcp_json_writer& w, const glm::vec3 v)
+{
+    w.begin_array();
+    w.value(v.x);
+    w.value(v.y);
+    w.value(v.z);
+    w.end_array();
+}
+
+// Record property names in the order they are written. The position of a
+// name is its bit in Mcp_query_page::field_mask.
+namespace node_field {
+    enum : std::size_t { name, id, parent, parent_id, position, rotation_xyzw, scale, attachment_types, locked, import_root, tags, count };
+}
+constexpr std::array<std::string_view, node_field::count> c_node_fields{
+    "name", "id", "parent", "parent_id", "position", "rotation_xyzw", "scale", "attachment_types", "locked", "import_root", "tags"
+};
+
+namespace camera_field {
+    enum : std::size_t { name, id, node, exposure, shadow_range, fov_y, selectable, count };
+}
+constexpr std::array<std::string_view, camera_field::count> c_camera_fields{
+    "name", "id", "node", "exposure", "shadow_range", "fov_y", "selectable"
+};
+
+namespace light_field {
+    enum : std::size_t { name, id, node, type, color, intensity, range, cast_shadow, shaded, shadow_mapped, shadow_index, point_shadow_index, count };
+}
+constexpr std::array<std::string_view, light_field::count> c_light_fields{
+    "name", "id", "node", "type", "color", "intensity", "range", "cast_shadow", "shaded", "shadow_mapped", "shadow_index", "point_shadow_index"
+};
+
+namespace material_field {
+    enum : std::size_t { name, id, base_color, metallic, roughness, emissive, count };
+}
+constexpr std::array<std::string_view, material_field::count> c_material_fields{
+    "name", "id", "base_color", "metallic", "roughness", "emissive"
+};
+
+[[nodiscard]] auto get_tool_fields(const std::string& tool_name) -> std::span<const std::string_view>
+{
+    if (tool_name == "get_scene_nodes"    ) { return c_node_fields; }
+    if (tool_name == "get_scene_cameras"  ) { return c_camera_fields; }
+    if (tool_name == "get_scene_lights"   ) { return c_light_fields; }
+    if (tool_name == "get_scene_materials") { return c_material_fields; }
+    return {};
+}
+
+[[nodiscard]] auto get_tool_scene_parts(const std::string& tool_name) -> uint32_t
+{
+    if (tool_name == "get_scene_nodes"    ) { return Mcp_scene_snapshot::c_nodes; }
+    if (tool_name == "get_scene_cameras"  ) { return Mcp_scene_snapshot::c_cameras; }
+    if (tool_name == "get_scene_lights"   ) { return Mcp_scene_snapshot::c_lights; }
+    if (tool_name == "get_scene_materials") { return Mcp_scene_snapshot::c_materials; }
+    return 0;
+}
+
+// Writes the key of a record property, if the page projection includes it
+class Projection
+{
+public:
+    Projection(Mcp_json_writer& writer, const Mcp_query_page& page, const std::span<const std::string_view> names)
+        : m_writer{writer}
+        , m_page  {page}
+        , m_names {names}
+    {
+    }
+
+    [[nodiscard]] auto field(const std::size_t index) -> bool
+    {
+        if (!m_page.wants(index)) {
+            return false;
+        }
+        m_writer.key(m_names[index]);
+        return true;
+    }
+
+private:
+    Mcp_json_writer&                    m_writer;
+    const Mcp_query_page&               m_page;
+    std::span<const std::string_view>   m_names;
+};
+
+// {"<list_name>":[records of the page],"total":N,"next_cursor":"M"}, with
+// records holding the list from position record_offset on.
+template <typename Record, typename Write_record>
+auto format_page(
+    const std::string_view     list_name,
+    const std::vector<Record>& records,
+    const std::size_t          record_offset,
+    const std::size_t          total,
+    const Mcp_query_page&      page,
+    const std::size_t          bytes_per_record,
+    Write_record&&             write_record
+) -> std::string
+{
+    const Record_range range{page.offset, page.limit};
+    const std::size_t  first = std::max(range.first, record_offset) - record_offset;
+    const std::size_t  last  = std::max(std::min(range.end, record_offset + records.size()), record_offset) - record_offset;
+
+    std::string out;
+    out.reserve(128 + ((last > first) ? (last - first) * bytes_per_record : 0));
+    begin_json_text_content(out);
+    Mcp_json_writer w{out, true};
+    w.begin_object();
+    w.key(list_name);
+    w.begin_array();
+    for (std::size_t i = first; i < last; ++i) {
+        w.begin_object();
+        write_record(w, records[i]);
+        w.end_object();
+    }
+    w.end_array();
+    w.key("total");
+    w.value(total);
+    if (range.end < total) {
+        w.key("next_cursor");
+        w.value(std::to_string(range.end));
+    }
+    w.end_object();
+    end_json_text_content(out);
+    return out;
+}
+
+[[nodiscard]] auto format_scene_query(
+    const Mcp_scene_snapshot::Scene_record& scene,
+    const std::string&                      tool_name,
+    const Mcp_query_page&                   page
+) -> std::string
+{
+    if (tool_name == "get_scene_nodes") {
+        return format_scene_nodes(scene, page);
+    }
+    if (tool_name == "get_scene_cameras") {
+        return format_scene_cameras(scene, page);
+    }
+    if (tool_name == "get_scene_lights") {
+        return format_scene_lights(scene, page);
+    }
+    return format_scene_materials(scene, page);
+}
+
+} // anonymous namespace
+
+auto Mcp_scene_snapshot::find_scene(const std::string& name) const -> const Scene_record*
+{
+    for (const Scene_record& scene : scenes) {
+        if (scene.name == name) {
+            return &scene;
+        }
+    }
+    return nullptr;
+}
+
+auto capture_scene_record(
+    App_context&      context,
+    Scene_root&       scene_root,
+    const uint32_t    parts,
+    const std::size_t first,
+    const std::size_t count
+) -> Mcp_scene_snapshot::Scene_record
+{
+    const erhe::scene::Scene& scene = scene_root.get_scene();
+
+    Mcp_scene_snapshot::Scene_record record;
+    record.name                = scene_root.get_name();
+    record.id                  = scene.get_id(); // Scene item id (selectable, issue #240)
+    record.node_count          = scene.get_node_count();
+    record.camera_count        = scene.get_cameras().size();
+    record.trigger_event_count = scene_root.get_trigger_event_count();
+    record.record_offset       = first;
+    for (const auto& light_layer : scene.get_light_layers()) {
+        record.light_count += light_layer->lights.size();
+    }
+    const std::shared_ptr<Content_library> library = scene_root.get_content_library();
+    if (library && library->materials) {
+        record.material_count = library->materials->get_all<erhe::primitive::Material>().size();
+    }
+    const Record_range range{first, count};
+    if ((parts & Mcp_scene_snapshot::c_nodes) != 0) {
+        capture_nodes(scene, range, record.nodes);
+    }
+    if ((parts & Mcp_scene_snapshot::c_cameras) != 0) {
+        capture_cameras(scene, range, record.cameras);
+    }
+    if ((parts & Mcp_scene_snapshot::c_lights) != 0) {
+        capture_lights(scene, find_light_projections(context, scene_root), range, record.lights);
+    }
+    if ((parts & Mcp_scene_snapshot::c_materials) != 0) {
+        capture_materials(scene_root, range, record.materials);
+    }
+    return record;
+}
+
+auto capture_scene_snapshot(App_context& context, const uint64_t version) -> std::shared_ptr<const Mcp_scene_snapshot>
+{
+    auto snapshot = std::make_shared<Mcp_scene_snapshot>();
+    snapshot->version = version;
+    if (context.app_scenes) {
+        for (const auto& scene_root : context.app_scenes->get_scene_roots()) {
+            snapshot->scenes.push_back(capture_scene_record(context, *scene_root.get(), Mcp_scene_snapshot::c_all));
+        }
+    }
+    return snapshot;
+}
+
+auto parse_query_page(const std::string& tool_name, const json& arguments, Mcp_query_page& page) -> std::string
+{
+    page = Mcp_query_page{};
+
+    const auto cursor = arguments.find("cursor");
+    if ((cursor != arguments.end()) && !cursor->is_null()) {
+        const std::string*           text   = cursor->get_ptr<const std::string*>();
+        const std::from_chars_result result = (text != nullptr)
+            ? std::from_chars(text->data(), text->data() + text->size(), page.offset)
+            : std::from_chars_result{};
+        if ((text == nullptr) || text->empty() || (result.ec != std::errc{}) || (result.ptr != text->data() + text->size())) {
+            return "Invalid cursor: " + cursor->dump() + " (pass next_cursor of the previous page)";
+        }
+    }
+
+    const auto limit = arguments.find("limit");
+    if ((limit != arguments.end()) && !limit->is_null()) {
+        if (!limit->is_number_integer() || (limit->get<int64_t>() < 1)) {
+            return "Invalid limit: " + limit->dump() + " (expected a positive integer)";
+        }
+        page.limit = std::min(limit->get<std::size_t>(), Mcp_query_page::c_max_limit);
+    }
+
+    const auto fields = arguments.find("fields");
+    if ((fields != arguments.end()) && !fields->is_null()) {
+        const std::span<const std::string_view> names = get_tool_fields(tool_name);
+        if (!fields->is_array() || fields->empty()) {
+            return "Invalid fields: expected a non-empty array of field names";
+        }
+        page.field_mask = 0;
+        for (const json& field : *fields) {
+            const std::string* name = field.get_ptr<const std::string*>();
+            const auto i = (name != nullptr) ? std::find(names.begin(), names.end(), *name) : names.end();
+            if (i == names.end()) {
+                std::string valid;
+                for (const std::string_view valid_name : names) {
+                    valid += valid.empty() ? "" : ", ";
+                    valid += valid_name;
+                }
+                return "Unknown field: " + field.dump() + " (valid: " + valid + ")";
+            }
+            page.field_mask |= uint32_t{1} << static_cast<uint32_t>(i - names.begin());
+        }
+    }
+    return {};
+}
+
+auto format_list_scenes(const std::vector<Mcp_scene_snapshot::Scene_record>& scenes) -> std::string
+{
+    std::string out;
+    begin_json_text_content(out);
+    Mcp_json_writer w{out, true};
+    w.begin_object();
+    w.key("scenes");
+    w.begin_array();
+    for (const Mcp_scene_snapshot::Scene_record& scene : scenes) {
+        w.begin_object();
+        w.key("name");                w.value(scene.name);
+        w.key("id");                  w.value(scene.id);
+        w.key("node_count");          w.value(scene.node_count);
+        w.key("camera_count");        w.value(scene.camera_count);
+        w.key("light_count");         w.value(scene.light_count);
+        w.key("material_count");      w.value(scene.material_count);
+        w.key("trigger_event_count"); w.value(scene.trigger_event_count);
+        w.end_object();
+    }
+    w.end_array();
+    w.end_object();
+    end_json_text_content(out);
+    return out;
+}
+
+auto format_scene_nodes(const Mcp_scene_snapshot::Scene_record& scene, const Mcp_query_page& page) -> std::string
+{
+    return format_page(
+        "nodes", scene.nodes, scene.record_offset, scene.node_count, page, 320,
+        [&page](Mcp_json_writer& w, const Mcp_scene_snapshot::Node_record& node) {
+            Projection p{w, page, c_node_fields};
+            if (p.field(node_field::name)) {
+                w.value(node.name);
+            }
+            if (p.field(node_field::id)) {
+                w.value(node.id);
+            }
+            if (p.field(node_field::parent)) {
+                w.value(node.parent_name);
+            }
+            if (p.field(node_field::parent_id)) {
+                if (node.parent_id.has_value()) {
+                    w.value(node.parent_id.value());
+                } else {
+                    w.null();
+                }
+            }
+            if (p.field(node_field::position)) {
+                write_vec3(w, node.translation);
+            }
+            if (p.field(node_field::rotation_xyzw)) {
+                w.begin_array();
+                w.value(node.rotation.x);
+                w.value(node.rotation.y);
+                w.value(node.rotation.z);
+                w.value(node.rotation.w);
+                w.end_array();
+            }
+            if (p.field(node_field::scale)) {
+                write_vec3(w, node.scale);
+            }
+            if (p.field(node_field::attachment_types)) {
+                w.begin_array();
+                for (const std::string& type : node.attachment_types) {
+                    w.value(type);
+                }
+                w.end_array();
+            }
+            if (p.field(node_field::locked)) {
+                w.value(node.locked);
+            }
+            if (p.field(node_field::import_root)) {
+                w.value(node.import_root);
+            }
+            if (p.field(node_field::tags)) {
+                w.begin_array();
+                for (const std::string& tag : node.tags) {
+                    w.value(tag);
+                }
+                w.end_array();
+            }
+        }
+    );
+}
+
+auto format_scene_cameras(const Mcp_scene_snapshot::Scene_record& scene, const Mcp_query_page& page) -> std::string
+{
+    return format_page(
+        "cameras", scene.cameras, scene.record_offset, scene.camera_count, page, 160,
+        [&page](Mcp_json_writer& w, const Mcp_scene_snapshot::Camera_record& camera) {
+            Projection p{w, page, c_camera_fields};
+            if (p.field(camera_field::name)) {
+                w.value(camera.name);
+            }
+            if (p.field(camera_field::id)) {
+                w.value(camera.id);
+            }
+            if (p.field(camera_field::node)) {
+                w.value(camera.node_name);
+            }
+            if (p.field(camera_field::exposure)) {
+                w.value(camera.exposure);
+            }
+            if (p.field(camera_field::shadow_range)) {
+                w.value(camera.shadow_range);
+            }
+            if (p.field(camera_field::fov_y)) {
+                w.value(camera.fov_y);
+            }
+            if (p.field(camera_field::selectable)) {
+                w.value(camera.selectable);
+            }
+        }
+    );
+}
+
+auto format_scene_lights(const Mcp_scene_snapshot::Scene_record& scene, const Mcp_query_page& page) -> std::string
+{
+    // Light slot / shadow map assignment as of the last shadow pass of a view
+    // showing this scene, under the active graphics preset's per light type
+    // limits: shaded = got a light UBO slot (within *_shadow_light_count +
+    // *_unshadowed_light_count of its type), shadow_mapped = also got a shadow
+    // layer (within *_shadow_light_count). Shadow casters beyond the shadow
+    // limit report cast_shadow true / shadow_mapped false; lights beyond the
+    // unshadowed limit report shaded false.
+    return format_page(
+        "lights", scene.lights, scene.record_offset, scene.light_count, page, 240,
+        [&page](Mcp_json_writer& w, const Mcp_scene_snapshot::Light_record& light) {
+            Projection p{w, page, c_light_fields};
+            if (p.field(light_field::name)) {
+                w.value(light.name);
+            }
+            if (p.field(light_field::id)) {
+                w.value(light.id);
+            }
+            if (p.field(light_field::node)) {
+                w.value(light.node_name);
+            }
+            if (p.field(light_field::type)) {
+                w.value(light.type);
+            }
+            if (p.field(light_field::color)) {
+                write_vec3(w, light.color);
+            }
+            if (p.field(light_field::intensity)) {
+                w.value(light.intensity);
+            }
+            if (p.field(light_field::range)) {
+                w.value(light.range);
+            }
+            if (p.field(light_field::cast_shadow)) {
+                w.value(light.cast_shadow);
+            }
+            if (!light.has_projection) {
+                return;
+            }
+            if (p.field(light_field::shaded)) {
+                w.value(light.shaded);
+            }
+            if (p.field(light_field::shadow_mapped)) {
+                w.value(light.shadow_mapped);
+            }
+            if (light.shadow_index.has_value() && p.field(light_field::shadow_index)) {
+                w.value(light.shadow_index.value());
+            }
+            if (light.point_shadow_index.has_value() && p.field(light_field::point_shadow_index)) {
+                w.value(light.point_shadow_index.value());
+            }
+        }
+    );
+}
+
+auto format_scene_materials(const Mcp_scene_snapshot::Scene_record& scene, const Mcp_query_page& page) -> std::string
+{
+    return format_page(
+        "materials", scene.materials, scene.record_offset, scene.material_count, page, 200,
+        [&page](Mcp_json_writer& w, const Mcp_scene_snapshot::Material_record& material) {
+            Projection p{w, page, c_material_fields};
+            if (p.field(material_field::name)) {
+                w.value(material.name);
+            }
+            if (p.field(material_field::id)) {
+                w.value(material.id);
+            }
+            if (p.field(material_field::base_color)) {
+                write_vec3(w, material.base_color);
+            }
+            if (p.field(material_field::metallic)) {
+                w.value(material.metallic);
+            }
+            if (p.field(material_field::roughness)) {
+                w.value(material.roughness);
+            }
+            if (p.field(material_field::emissive)) {
+                write_vec3(w, material.emissive);
+            }
+        }
+    );
+}
+
+auto format_scene_not_found(const std::string& scene_name) -> std::string
+{
+    json r = make_text_content("Scene not found: " + scene_name);
+    r["isError"] = true;
+    return r.dump();
+}
+
+auto is_scene_snapshot_tool(const std::string& tool_name) -> bool
+{
+    return
+        (tool_name == "list_scenes"        ) ||
+        (tool_name == "get_scene_nodes"    ) ||
+        (tool_name == "get_scene_cameras"  ) ||
+        (tool_name == "get_scene_lights"   ) ||
+        (tool_name == "get_scene_materials");
+}
+
+auto answer_from_scene_snapshot(
+    const Mcp_scene_snapshot& snapshot,
+    const std::string&        tool_name,
+    const json&               arguments
+) -> std::optional<std::string>
+{
+    if (tool_name == "list_scenes") {
+        return format_list_scenes(snapshot.scenes);
+    }
+    if (!is_scene_snapshot_tool(tool_name)) {
+        return std::nullopt;
+    }
+    const std::string                       scene_name = arguments.value("scene_name", "");
+    const Mcp_scene_snapshot::Scene_record* scene      = snapshot.find_scene(scene_name);
+    if (scene == nullptr) {
+        return format_scene_not_found(scene_name);
+    }
+    Mcp_query_page    page;
+    const std::string error = parse_query_page(tool_name, arguments, page);
+    if (!error.empty()) {
+        return make_error_content(error);
+    }
+    return format_scene_query(*scene, tool_name, page);
+}
+
+auto answer_from_scene(
+    App_context&       context,
+    Scene_root* const  scene_root,
+    const std::string& tool_name,
+    const json&        arguments
+) -> std::string
+{
+    if (scene_root == nullptr) {
+        return format_scene_not_found(arguments.value("scene_name", ""));
+    }
+    Mcp_query_page    page;
+    const std::string error = parse_query_page(tool_name, arguments, page);
+    if (!error.empty()) {
+        return make_error_content(error);
+    }
+    const Mcp_scene_snapshot::Scene_record scene = capture_scene_record(
+        context, *scene_root, get_tool_scene_parts(tool_name), page.offset, page.limit
+    );
+    return format_scene_query(scene, tool_name, page);
+}
+
+auto Mcp_scene_snapshot_publisher::acquire() const -> std::shared_ptr<const Mcp_scene_snapshot>
+{
+    std::lock_guard<std::mutex> lock{m_mutex};
+    return m_current;
+}
+
+void Mcp_scene_snapshot_publisher::note_demand()
+{
+    m_demand.store(true, std::memory_order_relaxed);
+}
+
+void Mcp_scene_snapshot_publisher::publish(std::shared_ptr<const Mcp_scene_snapshot> snapshot)
+{
+    // The previous snapshot is released after unlocking: when no reader holds
+    // it, freeing a large scene copy must not stall readers on the mutex.
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        std::swap(m_current, snapshot);
+    }
+}
+
+void Mcp_scene_snapshot_publisher::withdraw()
+{
+    publish({});
+}
+
+auto Mcp_scene_snapshot_publisher::take_demand() -> bool
+{
+    return m_demand.exchange(false, std::memory_order_relaxed);
+}
+
+auto Mcp_scene_snapshot_publisher::next_version() -> uint64_t
+{
+    return ++m_version;
+}
+
+} // namespace editor
@@ -0,0 +1,218 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <nlohmann/json.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace editor {
+
+class App_context;
+class Scene_root;
+
+// Immutable copy of the scene state that the read-only MCP scene queries
+// (list_scenes, get_scene_nodes, get_scene_cameras, get_scene_lights,
+// get_scene_materials) report. Captured on the main thread; after
+// publication any thread may read it and format responses from it.
+//
+// The main thread handlers of these tools capture the same records for one
+// scene and format them with the same functions, so a response looks the
+// same whether it came from the frame queue or from a snapshot.
+class Mcp_scene_snapshot
+{
+public:
+    class Node_record
+    {
+    public:
+        std::string                name;
+        std::size_t                id{0};
+        std::string                parent_name;
+        std::optional<std::size_t> parent_id;
+        glm::vec3                  translation{0.0f};
+        glm::quat                  rotation   {1.0f, 0.0f, 0.0f, 0.0f};
+        glm::vec3                  scale      {1.0f};
+        std::vector<std::string>   attachment_types;
+        bool                       locked     {false};
+        bool                       import_root{false};
+        std::vector<std::string>   tags;
+    };
+
+    class Camera_record
+    {
+    public:
+        std::string name;
+        std::size_t id          {0};
+        std::string node_name;
+        float       exposure    {0.0f};
+        float       shadow_range{0.0f};
+        float       fov_y       {0.0f};
+        bool        selectable  {false};
+    };
+
+    class Light_record
+    {
+    public:
+        std::string name;
+        std::size_t id         {0};
+        std::string node_name;
+        const char* type       {"unknown"};
+        glm::vec3   color      {0.0f};
+        float       intensity  {0.0f};
+        float       range      {0.0f};
+        bool        cast_shadow{false};
+        // Light slot / shadow map assignment of the last shadow pass of a
+        // view showing the scene; unset when no such pass placed the light.
+        bool                       has_projection{false};
+        bool                       shaded        {false};
+        bool                       shadow_mapped {false};
+        std::optional<std::size_t> shadow_index;
+        std::optional<std::size_t> point_shadow_index;
+    };
+
+    class Material_record
+    {
+    public:
+        std::string name;
+        std::size_t id        {0};
+        glm::vec3   base_color{0.0f};
+        float       metallic  {0.0f};
+        float       roughness {0.0f};
+        glm::vec3   emissive  {0.0f};
+    };
+
+    class Scene_record
+    {
+    public:
+        std::string                  name;
+        std::size_t                  id                 {0};
+        std::size_t                  node_count         {0};
+        std::size_t                  camera_count       {0};
+        std::size_t                  light_count        {0};
+        std::size_t                  material_count     {0};
+        uint64_t                     trigger_event_count{0};
+        std::size_t                  record_offset      {0}; // position of the first record in each list below
+        std::vector<Node_record>     nodes;
+        std::vector<Camera_record>   cameras;
+        std::vector<Light_record>    lights;
+        std::vector<Material_record> materials;
+    };
+
+    // Bits for capture_scene_record(), selecting which record lists to fill
+    static constexpr uint32_t c_nodes     = (1u << 0u);
+    static constexpr uint32_t c_cameras   = (1u << 1u);
+    static constexpr uint32_t c_lights    = (1u << 2u);
+    static constexpr uint32_t c_materials = (1u << 3u);
+    static constexpr uint32_t c_all       = c_nodes | c_cameras | c_lights | c_materials;
+
+    [[nodiscard]] auto find_scene(const std::string& name) const -> const Scene_record*;
+
+    uint64_t                  version{0};
+    std::vector<Scene_record> scenes;
+};
+
+// Paging and field projection of the scene list queries (get_scene_nodes,
+// get_scene_cameras, get_scene_lights, get_scene_materials), from the tool
+// arguments:
+//   cursor - next_cursor of the previous page; absent for the first page
+//   limit  - records per page, at most c_max_limit; when absent, every
+//            record from the cursor on
+//   fields - names of the record properties to include; all when absent
+// A page reports the records, "total" and, unless it is the last page,
+// "next_cursor". A cursor is a record position: records added or removed
+// between pages shift the following pages.
+class Mcp_query_page
+{
+public:
+    static constexpr std::size_t c_max_limit = 10000;
+
+    [[nodiscard]] auto wants(std::size_t field) const -> bool { return (field_mask & (uint32_t{1} << field)) != 0; }
+
+    std::size_t offset    {0};
+    std::size_t limit     {std::numeric_limits<std::size_t>::max()};
+    uint32_t    field_mask{~uint32_t{0}};
+};
+
+// Any thread. Returns an error message, empty on success.
+[[nodiscard]] auto parse_query_page(const std::string& tool_name, const nlohmann::json& arguments, Mcp_query_page& page) -> std::string;
+
+// Main thread only. The scene summary (name, id, counts) is always filled
+// in, the record lists only for the Mcp_scene_snapshot::c_* bits in parts,
+// and only with records [first, first + count) of each list.
+[[nodiscard]] auto capture_scene_record(
+    App_context& context,
+    Scene_root&  scene_root,
+    uint32_t     parts,
+    std::size_t  first = 0,
+    std::size_t  count = std::numeric_limits<std::size_t>::max()
+) -> Mcp_scene_snapshot::Scene_record;
+[[nodiscard]] auto capture_scene_snapshot(App_context& context, uint64_t version) -> std::shared_ptr<const Mcp_scene_snapshot>;
+
+// Any thread. Each returns the complete tools/call result (content block)
+// as compact JSON, written without building a json document.
+[[nodiscard]] auto format_list_scenes    (const std::vector<Mcp_scene_snapshot::Scene_record>& scenes) -> std::string;
+[[nodiscard]] auto format_scene_nodes    (const Mcp_scene_snapshot::Scene_record& scene, const Mcp_query_page& page) -> std::string;
+[[nodiscard]] auto format_scene_cameras  (const Mcp_scene_snapshot::Scene_record& scene, const Mcp_query_page& page) -> std::string;
+[[nodiscard]] auto format_scene_lights   (const Mcp_scene_snapshot::Scene_record& scene, const Mcp_query_page& page) -> std::string;
+[[nodiscard]] auto format_scene_materials(const Mcp_scene_snapshot::Scene_record& scene, const Mcp_query_page& page) -> std::string;
+[[nodiscard]] auto format_scene_not_found(const std::string& scene_name) -> std::string;
+
+[[nodiscard]] auto is_scene_snapshot_tool(const std::string& tool_name) -> bool;
+
+// Answers a read-only scene query from snapshot. Returns nullopt for tools
+// a snapshot cannot answer; those go through the frame queue.
+[[nodiscard]] auto answer_from_scene_snapshot(
+    const Mcp_scene_snapshot& snapshot,
+    const std::string&        tool_name,
+    const nlohmann::json&     arguments
+) -> std::optional<std::string>;
+
+// Main thread only. Answers a scene list query (not list_scenes) from the
+// live scene, capturing only the requested page. scene_root is the scene
+// named by arguments["scene_name"], nullptr when there is none.
+[[nodiscard]] auto answer_from_scene(
+    App_context&          context,
+    Scene_root*           scene_root,
+    const std::string&    tool_name,
+    const nlohmann::json& arguments
+) -> std::string;
+
+// Single writer (main thread), many readers (HTTP threads), RCU style:
+// publish() swaps in a new immutable snapshot, readers get a reference to
+// whichever snapshot was current and keep it alive for as long as they
+// format from it. The mutex only covers the pointer copy, never capture or
+// formatting, so readers never wait for frame work and the main thread
+// never waits for a reader.
+//
+// Publication is demand driven: capture costs O(scene), so the main thread
+// only captures at the end of frames in which snapshot tools were asked for
+// (note_demand()), and withdraws the snapshot otherwise.
+class Mcp_scene_snapshot_publisher
+{
+public:
+    // Any thread
+    [[nodiscard]] auto acquire() const -> std::shared_ptr<const Mcp_scene_snapshot>;
+    void note_demand();
+
+    // Main thread
+    void publish  (std::shared_ptr<const Mcp_scene_snapshot> snapshot);
+    void withdraw ();
+    [[nodiscard]] auto take_demand() -> bool;
+    [[nodiscard]] auto next_version() -> uint64_t;
+
+private:
+    mutable std::mutex                        m_mutex;
+    std::shared_ptr<const Mcp_scene_snapshot> m_current;
+    std::atomic<bool>                         m_demand{false};
+    uint64_t                                  m_version{0};
+};
+
+} // namespace editor
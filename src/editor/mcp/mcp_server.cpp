@@ -2,6 +2,7 @@
 // Split out of mcp_server.cpp; shares helpers via mcp_server_shared.hpp.
 
 #include "mcp/mcp_server.hpp"
+#include "mcp/mcp_scene_snapshot.hpp"
 #include "mcp/mcp_server_shared.hpp"
 
 #include "app_context.hpp"
@@ -357,6 +358,25 @@ auto Mcp_server::handle_tools_call(
     const json&        arguments
 ) -> std::string
 {
+    // Read-only scene queries are answered on this (HTTP) thread from the
+    // last published scene snapshot, without waiting for a frame. The first
+    // such call after a quiet period finds no snapshot and goes through the
+    // queue; its demand makes the main thread capture one at the end of the
+    // frame.
+    if (is_scene_snapshot_tool(tool_name)) {
+        m_scene_snapshot.note_demand();
+        const std::shared_ptr<const Mcp_scene_snapshot> snapshot = m_scene_snapshot.acquire();
+        if (snapshot) {
+            const std::optional<std::string> result_json = answer_from_scene_snapshot(*snapshot.get(), tool_name, arguments);
+            if (result_json.has_value()) {
+                if (!json::accept(result_json.value())) {
+                    return make_jsonrpc_error(id, -32000, "Internal error processing: " + tool_name);
+                }
+                return make_jsonrpc_response_raw(id, result_json.value());
+            }
+        }
+    }
+
     auto queued = std::make_unique<Queued_request>();
     queued->tool_name = tool_name;
     queued->arguments = arguments;
@@ -393,11 +413,12 @@ auto Mcp_server::handle_tools_call(
         log_mcp->warn("MCP server: future_error in handle_tools_call: {}", e.what());
         return make_jsonrpc_error(id, -32000, "Internal: request abandoned: " + tool_name);
     }
-    json result = json::parse(result_json, nullptr, false);
-    if (result.is_discarded()) {
+    // Validated without building a document: scene query results can be
+    // large, and are spliced into the response as they are.
+    if (!json::accept(result_json)) {
         return make_jsonrpc_error(id, -32000, "Internal error processing: " + tool_name);
     }
-    return make_jsonrpc_response(id, result);
+    return make_jsonrpc_response_raw(id, result_json);
 }
 
 auto Mcp_server::handle_error(const json& id, int code, const std::string& message) -> std::string
@@ -426,7 +447,8 @@ auto Mcp_server::process_queued_requests() -> int
     }
 
     const auto now = std::chrono::steady_clock::now();
-    int count = 0;
+    int  count              = 0;
+    bool snapshot_withdrawn = false;
     for (auto& req : requests) {
         // Drop entries whose HTTP client has already given up (wait_for
         // returned timeout in handle_tools_call). Without this guard
@@ -441,6 +463,16 @@ auto Mcp_server::process_queued_requests() -> int
             continue;
         }
 
+        // Any tool other than a snapshot query may change the scene. Withdraw
+        // the snapshot before running it so that no query sent after this
+        // request completes can be answered from the scene as it was before.
+        // The next snapshot is published by publish_scene_snapshot(), after
+        // the operations the tool queued have run.
+        if (!snapshot_withdrawn && !is_scene_snapshot_tool(req->tool_name)) {
+            m_scene_snapshot.withdraw();
+            snapshot_withdrawn = true;
+        }
+
         // Per-request exception boundary. process_queued_requests() runs on the
         // main thread, so a handler that throws would skip the set_value() below,
         // break the waiting HTTP thread's promise (observed as
@@ -476,6 +508,19 @@ auto Mcp_server::process_queued_requests() -> int
     return count;
 }
 
+void Mcp_server::publish_scene_snapshot()
+{
+    // Nothing tracks scene edits made outside MCP, so a snapshot is only
+    // good for the frame it was captured in: without queries this frame
+    // there is nothing to capture for, and the old snapshot is dropped
+    // rather than left to go stale.
+    if (!m_scene_snapshot.take_demand()) {
+        m_scene_snapshot.withdraw();
+        return;
+    }
+    m_scene_snapshot.publish(capture_scene_snapshot(m_context, m_scene_snapshot.next_version()));
+}
+
 auto Mcp_server::get_dispatch_table() -> std::span<const Mcp_server::Tool_dispatch_entry>
 {
     // Member-function-local: the handlers are private members, so their
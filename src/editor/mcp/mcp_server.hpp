@@ -1,5 +1,7 @@
 #pragma once
 
+#include "mcp/mcp_scene_snapshot.hpp"
+
 #include <atomic>
 #include <chrono>
 #include <cstdint>
@@ -64,8 +66,12 @@ struct Mcp_tool_info
 //   get_scene_cameras, get_scene_lights, get_scene_materials,
 //   get_material_details, get_selection, get_shadow_fit_debug
 //
-// The server runs on a background thread and dispatches all requests
-// to the main editor thread for thread safety.
+// The server runs on a background thread and dispatches requests to the
+// main editor thread for thread safety. The read-only scene queries
+// (list_scenes, get_scene_nodes, get_scene_cameras, get_scene_lights,
+// get_scene_materials) are answered on the server thread instead, from an
+// immutable scene snapshot the main thread publishes once per frame while
+// such queries keep coming (see Mcp_scene_snapshot_publisher).
 class Mcp_server
 {
 public:
@@ -87,6 +93,12 @@ public:
     // Called once per frame from the main thread.
     auto process_queued_requests() -> int;
 
+    // Called once per frame from the main thread, after the operation stack
+    // has run the operations queued by this frame's requests: captures and
+    // publishes a new scene snapshot when snapshot queries were seen since
+    // the previous call, withdraws it otherwise.
+    void publish_scene_snapshot();
+
     // Name -> handler dispatch shared by process_queued_requests and
     // action_batch; unknown names fall through to execute_command
     // (registered editor commands are tools too).
@@ -421,6 +433,9 @@ private:
     bool                                             m_defer_current_request{false};
     std::vector<std::unique_ptr<Queued_request>>     m_deferred_requests;
 
+    // Read-only scene snapshot for the HTTP threads
+    Mcp_scene_snapshot_publisher                     m_scene_snapshot;
+
     // Saved per-view shader debug modes for push_shader_debug /
     // pop_shader_debug (LIFO). Views that disappear between push and pop
     // (weak_ptr expired) are skipped on restore.
@@ -1970,11 +1970,8 @@ auto Mcp_server::action_create_shape(const json& args) -> std::string
                 return r.dump();
             }
             auto geometry = std::make_shared<erhe::geometry::Geometry>("convex_hull");
-            {
-                // make_convex_hull reaches Geogram (Delaunay)
-                const std::lock_guard<std::recursive_mutex> geogram_guard{erhe::geometry::geogram_lock()};
-                erhe::geometry::shapes::make_convex_hull(geometry->get_mesh(), points);
-            }
+            // make_convex_hull takes geogram_lock() around its Delaunay
+            erhe::geometry::shapes::make_convex_hull(geometry->get_mesh(), points);
             if (geometry->get_mesh().facets.nb() == 0) {
                 json r = make_text_content("convex_hull produced no facets - are the points coplanar?");
                 r["isError"] = true;
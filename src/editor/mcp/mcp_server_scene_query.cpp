@@ -2,6 +2,7 @@
 // Split out of mcp_server.cpp; shares helpers via mcp_server_shared.hpp.
 
 #include "mcp/mcp_server.hpp"
+#include "mcp/mcp_scene_snapshot.hpp"
 #include "mcp/mcp_server_shared.hpp"
 
 #include "app_context.hpp"
@@ -134,6 +135,8 @@ auto Mcp_server::query_composition_passes(const json& args) -> std::string
             {"last_scene_view",      pass->get_last_scene_view_name()},
             {"last_mesh_count",      pass->get_last_mesh_count()},
             {"last_draw_list_entry_count", pass->get_last_draw_list_entry_count()},
+            {"last_draw_list_culled_count", pass->get_last_draw_list_culled_count()},
+            {"last_draw_list_lod_count", pass->get_last_draw_list_lod_count()},
             {"last_cpu_time_us",     pass->get_last_cpu_time_us()},
             {"total_cpu_time_us",    pass->get_total_cpu_time_us()},
             {"render_call_count",    pass->get_render_call_count()}
@@ -239,7 +242,25 @@ auto Mcp_server::query_draw_lists(const json& args) -> std::string
         // refresh hook and the draw-time GPU-slot sync.
         {"transform_update_count",         draw_list_scene->get_transform_update_count()},
         {"refresh_count",                  draw_list_scene->get_refresh_count()},
-        {"slot_sync_count",                draw_list_scene->get_slot_sync_count()}
+        {"slot_sync_count",                draw_list_scene->get_slot_sync_count()},
+        // Frustum culling (doc/draw_list_performance_improvements.md): entries
+        // tested against the pass cull volumes and entries rejected, summed
+        // over color and shadow passes since the scene was created.
+        {"cull_tested_count",              draw_list_scene->get_cull_tested_count()},
+        {"culled_count",                   draw_list_scene->get_culled_count()},
+        // Color pass entries drawn at a coarser level of detail (screen
+        // space error LOD pick) since the scene was created.
+        {"lod_entry_count",                draw_list_scene->get_lod_entry_count()},
+        // Cluster culling: meshlet draw commands emitted and meshlets culled
+        // (frustum or normal cone) in color passes since the scene was created.
+        {"cluster_draw_count",             draw_list_scene->get_cluster_draw_count()},
+        {"culled_cluster_count",           draw_list_scene->get_culled_cluster_count()},
+        // Resident records of static lists: entries drawn from them and
+        // bytes uploaded to them since the scene was created, and the bytes
+        // currently allocated.
+        {"resident_entry_count",           draw_list_scene->get_resident_entry_count()},
+        {"resident_upload_byte_count",     draw_list_scene->get_resident_upload_byte_count()},
+        {"resident_byte_count",            draw_list_scene->get_resident_byte_count()}
     };
     if (verbose) {
         result["draw_lists"] = lists;
@@ -270,82 +291,16 @@ auto Mcp_server::query_list_scenes(const json& args) -> std::string
         return make_text_content("No scenes available").dump();
     }
 
-    json scenes = json::array();
+    std::vector<Mcp_scene_snapshot::Scene_record> scenes;
     for (const auto& sr : m_context.app_scenes->get_scene_roots()) {
-        const auto& scene = sr->get_scene();
-        const auto  library = sr->get_content_library();
-
-        int material_count = 0;
-        if (library && library->materials) {
-            material_count = static_cast<int>(library->materials->get_all<erhe::primitive::Material>().size());
-        }
-
-        int light_count = 0;
-        for (const auto& ll : scene.get_light_layers()) {
-            light_count += static_cast<int>(ll->lights.size());
-        }
-
-        scenes.push_back({
-            {"name",                sr->get_name()},
-            {"id",                  scene.get_id()}, // Scene item id (selectable, issue #240)
-            {"node_count",          static_cast<int>(scene.get_node_count())},
-            {"camera_count",        static_cast<int>(scene.get_cameras().size())},
-            {"light_count",         light_count},
-            {"material_count",      material_count},
-            {"trigger_event_count", sr->get_trigger_event_count()}
-        });
+        scenes.push_back(capture_scene_record(m_context, *sr.get(), 0));
     }
-
-    return make_json_content({{"scenes", scenes}}).dump();
+    return format_list_scenes(scenes);
 }
 
 auto Mcp_server::query_scene_nodes(const json& args) -> std::string
 {
-    const std::string scene_name = args.value("scene_name", "");
-    auto* sr = find_scene(scene_name);
-    if (!sr) {
-        json r = make_text_content("Scene not found: " + scene_name);
-        r["isError"] = true;
-        return r.dump();
-    }
-
-    const auto& scene = sr->get_scene();
-    json nodes = json::array();
-    scene.for_each_node([&](const std::shared_ptr<erhe::scene::Node>& node) {
-        const auto& trs = node->parent_from_node_transform();
-        const glm::vec3 t = trs.get_translation();
-        const glm::quat r = trs.get_rotation();
-        const glm::vec3 s = trs.get_scale();
-
-        json attachment_types = json::array();
-        for (const auto& att : node->get_attachments()) {
-            attachment_types.push_back(std::string{att->get_type_name()});
-        }
-
-        auto parent_node = node->get_parent_node();
-
-        json tags_arr = json::array();
-        for (const auto& tag : node->get_tags()) {
-            tags_arr.push_back(tag);
-        }
-
-        nodes.push_back({
-            {"name",             node->get_name()},
-            {"id",               node->get_id()},
-            {"parent",           parent_node ? parent_node->get_name() : ""},
-            {"parent_id",        parent_node ? json(parent_node->get_id()) : json()},
-            {"position",         {t.x, t.y, t.z}},
-            {"rotation_xyzw",    {r.x, r.y, r.z, r.w}},
-            {"scale",            {s.x, s.y, s.z}},
-            {"attachment_types", attachment_types},
-            {"locked",           node->is_lock_edit()},
-            {"import_root",      (node->get_flag_bits() & erhe::Item_flags::import_root) != 0},
-            {"tags",             tags_arr}
-        });
-        return true;
-    });
-
-    return make_json_content({{"nodes", nodes}}).dump();
+    return answer_from_scene(m_context, find_scene(args.value("scene_name", "")), "get_scene_nodes", args);
 }
 
 auto Mcp_server::query_node_details(const json& args) -> std::string
@@ -577,34 +532,7 @@ auto Mcp_server::query_node_details(const json& args) -> std::string
 
 auto Mcp_server::query_scene_cameras(const json& args) -> std::string
 {
-    const std::string scene_name = args.value("scene_name", "");
-    auto* sr = find_scene(scene_name);
-    if (!sr) {
-        json r = make_text_content("Scene not found: " + scene_name);
-        r["isError"] = true;
-        return r.dump();
-    }
-
-    // "selectable": offered in camera-selection UI (see get_selectable_cameras);
-    // false for cameras embedded in content (prefab instances, import wrappers).
-    const std::vector<std::shared_ptr<erhe::scene::Camera>> selectable_cameras = get_selectable_cameras(sr->get_scene());
-    json cameras = json::array();
-    for (const auto& camera : sr->get_scene().get_cameras()) {
-        const auto* node = camera->get_node();
-        const erhe::scene::Projection* projection = camera->projection();
-        const bool selectable = std::find(selectable_cameras.begin(), selectable_cameras.end(), camera) != selectable_cameras.end();
-        cameras.push_back({
-            {"name",         camera->get_name()},
-            {"id",           camera->get_id()},
-            {"node",         node ? node->get_name() : ""},
-            {"exposure",     camera->get_exposure()},
-            {"shadow_range", camera->get_shadow_range()},
-            {"fov_y",        (projection != nullptr) ? projection->fov_y : 0.0f},
-            {"selectable",   selectable}
-        });
-    }
-
-    return make_json_content({{"cameras", cameras}}).dump();
+    return answer_from_scene(m_context, find_scene(args.value("scene_name", "")), "get_scene_cameras", args);
 }
 
 auto Mcp_server::query_viewports(const json& args) -> std::string
@@ -784,72 +712,7 @@ auto Mcp_server::query_scene_settings(const json& args) -> std::string
 
 auto Mcp_server::query_scene_lights(const json& args) -> std::string
 {
-    const std::string scene_name = args.value("scene_name", "");
-    auto* sr = find_scene(scene_name);
-    if (!sr) {
-        json r = make_text_content("Scene not found: " + scene_name);
-        r["isError"] = true;
-        return r.dump();
-    }
-
-    // Light slot / shadow map assignment as of the last shadow pass of a view
-    // showing this scene, under the active graphics preset's per light type
-    // limits: shaded = got a light UBO slot (within *_shadow_light_count +
-    // *_unshadowed_light_count of its type), shadow_mapped = also got a shadow
-    // layer (within *_shadow_light_count). Shadow casters beyond the shadow
-    // limit report cast_shadow true / shadow_mapped false; lights beyond the
-    // unshadowed limit report shaded false.
-    const erhe::scene_renderer::Light_projections* light_projections = nullptr;
-    if (m_context.app_rendering != nullptr) {
-        for (const std::shared_ptr<Shadow_render_node>& shadow_node : m_context.app_rendering->get_all_shadow_nodes()) {
-            if (!shadow_node) {
-                continue;
-            }
-            const std::shared_ptr<Scene_root> node_scene_root = shadow_node->get_scene_view().get_scene_root();
-            if (node_scene_root.get() == sr) {
-                light_projections = &shadow_node->get_light_projections();
-                break;
-            }
-        }
-    }
-
-    json lights = json::array();
-    for (const auto& ll : sr->get_scene().get_light_layers()) {
-        for (const auto& light : ll->lights) {
-            const auto* node = light->get_node();
-            const char* type_str = (light->type == erhe::scene::Light_type::directional) ? "directional"
-                                 : (light->type == erhe::scene::Light_type::point)       ? "point"
-                                 : (light->type == erhe::scene::Light_type::spot)         ? "spot"
-                                 : "unknown";
-            json light_json{
-                {"name",        light->get_name()},
-                {"id",          light->get_id()},
-                {"node",        node ? node->get_name() : ""},
-                {"type",        type_str},
-                {"color",       {light->color.x, light->color.y, light->color.z}},
-                {"intensity",   light->intensity},
-                {"range",       light->range},
-                {"cast_shadow", light->cast_shadow}
-            };
-            const erhe::scene::Light_projection_transforms* transforms = (light_projections != nullptr)
-                ? light_projections->get_light_projection_transforms_for_light(light.get())
-                : nullptr;
-            if (transforms != nullptr) {
-                constexpr std::size_t no_index = std::numeric_limits<std::size_t>::max();
-                light_json["shaded"]        = (transforms->index != no_index);
-                light_json["shadow_mapped"] = transforms->is_shadow_mapped();
-                if (transforms->shadow_index != no_index) {
-                    light_json["shadow_index"] = transforms->shadow_index;
-                }
-                if (transforms->point_shadow_index != no_index) {
-                    light_json["point_shadow_index"] = transforms->point_shadow_index;
-                }
-            }
-            lights.push_back(light_json);
-        }
-    }
-
-    return make_json_content({{"lights", lights}}).dump();
+    return answer_from_scene(m_context, find_scene(args.value("scene_name", "")), "get_scene_lights", args);
 }
 
 auto Mcp_server::query_raycast(const json& args) -> std::string
@@ -1172,33 +1035,7 @@ auto Mcp_server::query_shadow_fit_debug(const json& args) -> std::string
 
 auto Mcp_server::query_scene_materials(const json& args) -> std::string
 {
-    const std::string scene_name = args.value("scene_name", "");
-    auto* sr = find_scene(scene_name);
-    if (!sr) {
-        json r = make_text_content("Scene not found: " + scene_name);
-        r["isError"] = true;
-        return r.dump();
-    }
-
-    auto library = sr->get_content_library();
-    if (!library || !library->materials) {
-        return make_json_content({{"materials", json::array()}}).dump();
-    }
-
-    json materials = json::array();
-    const auto& mat_list = library->materials->get_all<erhe::primitive::Material>();
-    for (const auto& mat : mat_list) {
-        materials.push_back({
-            {"name",       mat->get_name()},
-            {"id",         mat->get_id()},
-            {"base_color", {mat->data.base_color.x, mat->data.base_color.y, mat->data.base_color.z}},
-            {"metallic",   mat->data.metallic},
-            {"roughness",  mat->data.roughness.x},
-            {"emissive",   {mat->data.emissive.x, mat->data.emissive.y, mat->data.emissive.z}}
-        });
-    }
-
-    return make_json_content({{"materials", materials}}).dump();
+    return answer_from_scene(m_context, find_scene(args.value("scene_name", "")), "get_scene_materials", args);
 }
 
 auto Mcp_server::query_server_info(const json& args) -> std::string
@@ -1604,22 +1441,28 @@ auto Mcp_server::query_transform_update_stats(const json& args) -> std::string
 
     json result = {
         {"last_frame", {
-            {"pass_count",    frame.pass_count},
-            {"dirty_count",   frame.dirty_count},
-            {"visited_count", frame.visited_count},
-            {"lock_wait_ms",  frame.lock_wait_ms},
-            {"sort_ms",       frame.sort_ms},
-            {"propagate_ms",  frame.propagate_ms},
-            {"total_ms",      frame.total_ms()}
+            {"pass_count",       frame.pass_count},
+            {"table_pass_count", frame.table_pass_count},
+            {"dirty_count",      frame.dirty_count},
+            {"visited_count",    frame.visited_count},
+            {"lock_wait_ms",     frame.lock_wait_ms},
+            {"sort_ms",          frame.sort_ms},
+            {"flatten_ms",       frame.flatten_ms},
+            {"propagate_ms",     frame.propagate_ms},
+            {"apply_ms",         frame.apply_ms},
+            {"total_ms",         frame.total_ms()}
         }},
         {"aggregate", {
             {"frames",             frames},
-            {"avg_pass_count",     static_cast<double>(aggregate.pass_count)    * per_frame},
-            {"avg_dirty_count",    static_cast<double>(aggregate.dirty_count)   * per_frame},
-            {"avg_visited_count",  static_cast<double>(aggregate.visited_count) * per_frame},
-            {"avg_lock_wait_ms",   aggregate.lock_wait_ms * per_frame},
-            {"avg_sort_ms",        aggregate.sort_ms      * per_frame},
-            {"avg_propagate_ms",   aggregate.propagate_ms * per_frame},
+            {"avg_pass_count",       static_cast<double>(aggregate.pass_count)       * per_frame},
+            {"avg_table_pass_count", static_cast<double>(aggregate.table_pass_count) * per_frame},
+            {"avg_dirty_count",      static_cast<double>(aggregate.dirty_count)      * per_frame},
+            {"avg_visited_count",    static_cast<double>(aggregate.visited_count)    * per_frame},
+            {"avg_lock_wait_ms",     aggregate.lock_wait_ms * per_frame},
+            {"avg_sort_ms",          aggregate.sort_ms      * per_frame},
+            {"avg_flatten_ms",       aggregate.flatten_ms   * per_frame},
+            {"avg_propagate_ms",     aggregate.propagate_ms * per_frame},
+            {"avg_apply_ms",         aggregate.apply_ms     * per_frame},
             {"avg_total_ms",       aggregate.total_ms()   * per_frame},
             {"peak_total_ms",      tracker->get_peak_total_ms()}
         }}
@@ -72,6 +72,20 @@ auto make_jsonrpc_response(const json& id, const json& result) -> std::string
     return response.dump();
 }
 
+auto make_jsonrpc_response_raw(const json& id, const std::string_view result_json) -> std::string
+{
+    // Same member order as make_jsonrpc_response (json objects sort keys)
+    const std::string id_json = id.dump();
+    std::string response;
+    response.reserve(40 + id_json.size() + result_json.size());
+    response.append(R"({"id":)");
+    response.append(id_json);
+    response.append(R"(,"jsonrpc":"2.0","result":)");
+    response.append(result_json);
+    response.push_back('}');
+    return response;
+}
+
 auto make_jsonrpc_error(const json& id, int code, const std::string& message) -> std::string
 {
     json response = {
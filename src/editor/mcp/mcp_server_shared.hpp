@@ -59,6 +59,10 @@ extern const char* const c_mcp_build_timestamp;
 // the same type as the request id (a numeric id must not come back as a
 // string). Pass nullptr when no request id is known (parse error, auth).
 auto make_jsonrpc_response(const json& id, const json& result) -> std::string;
+// As make_jsonrpc_response, for a result that is already serialized: the
+// result text is spliced in verbatim instead of being parsed and dumped
+// again. The caller validates it (json::accept).
+auto make_jsonrpc_response_raw(const json& id, std::string_view result_json) -> std::string;
 auto make_jsonrpc_error(const json& id, int code, const std::string& message) -> std::string;
 auto make_text_content(const std::string& text) -> json;
 auto make_json_content(const json& data) -> json;
@@ -0,0 +1,179 @@
+// Mcp_json_writer on its own, no editor: plain and embed_as_string output
+// read back with nlohmann::json, string escapes (quotes, backslashes and
+// control characters) in both modes, non-finite numbers, and the commas
+// between members and elements of nested containers.
+
+#include "mcp/mcp_json_writer.hpp"
+
+#include <gtest/gtest.h>
+#include <nlohmann/json.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <string>
+
+namespace {
+
+using editor::Mcp_json_writer;
+using json = nlohmann::json;
+
+// The same document written plainly and embedded into a text content block;
+// parsing the block and then its "text" member must give the plain document
+auto write_both(const std::function<void(Mcp_json_writer&)>& write) -> json
+{
+    std::string plain;
+    Mcp_json_writer plain_writer{plain};
+    write(plain_writer);
+
+    std::string embedded;
+    editor::begin_json_text_content(embedded);
+    Mcp_json_writer embedded_writer{embedded, true};
+    write(embedded_writer);
+    editor::end_json_text_content(embedded);
+
+    const json plain_document = json::parse(plain, nullptr, false);
+    EXPECT_FALSE(plain_document.is_discarded()) << plain;
+
+    const json content = json::parse(embedded, nullptr, false);
+    EXPECT_FALSE(content.is_discarded()) << embedded;
+    if (content.is_discarded()) {
+        return plain_document;
+    }
+    EXPECT_EQ(content["content"][0]["type"], "text");
+    const std::string text = content["content"][0]["text"].get<std::string>();
+    EXPECT_EQ(text, plain);
+    EXPECT_EQ(json::parse(text, nullptr, false), plain_document);
+    return plain_document;
+}
+
+TEST(Mcp_json_writer, nested_containers_are_comma_separated)
+{
+    const json document = write_both([](Mcp_json_writer& w) {
+        w.begin_object();
+        w.key("empty_object"); w.begin_object(); w.end_object();
+        w.key("empty_array");  w.begin_array();  w.end_array();
+        w.key("items");
+        w.begin_array();
+        for (int i = 0; i < 3; ++i) {
+            w.begin_object();
+            w.key("id");   w.value(i);
+            w.key("tags"); w.begin_array(); w.value("a"); w.value("b"); w.end_array();
+            w.end_object();
+        }
+        w.begin_array(); w.begin_array(); w.end_array(); w.value(1); w.end_array();
+        w.end_array();
+        w.key("last"); w.null();
+        w.end_object();
+    });
+    const json expected = json::parse(R"({
+        "empty_object": {},
+        "empty_array":  [],
+        "items": [
+            {"id": 0, "tags": ["a", "b"]},
+            {"id": 1, "tags": ["a", "b"]},
+            {"id": 2, "tags": ["a", "b"]},
+            [[], 1]
+        ],
+        "last": null
+    })");
+    EXPECT_EQ(document, expected);
+}
+
+TEST(Mcp_json_writer, integers_and_bools)
+{
+    const json document = write_both([](Mcp_json_writer& w) {
+        w.begin_array();
+        w.value(true);
+        w.value(false);
+        w.value(0);
+        w.value(-1);
+        w.value(std::numeric_limits<int64_t>::min());
+        w.value(std::numeric_limits<int64_t>::max());
+        w.value(std::numeric_limits<uint64_t>::max());
+        w.value(static_cast<uint8_t>(255));
+        w.end_array();
+    });
+    ASSERT_EQ(document.size(), 8u);
+    EXPECT_EQ(document[0], true);
+    EXPECT_EQ(document[1], false);
+    EXPECT_EQ(document[2].get<int64_t>(), 0);
+    EXPECT_EQ(document[3].get<int64_t>(), -1);
+    EXPECT_EQ(document[4].get<int64_t>(), std::numeric_limits<int64_t>::min());
+    EXPECT_EQ(document[5].get<int64_t>(), std::numeric_limits<int64_t>::max());
+    EXPECT_EQ(document[6].get<uint64_t>(), std::numeric_limits<uint64_t>::max());
+    EXPECT_EQ(document[7].get<int64_t>(), 255);
+}
+
+TEST(Mcp_json_writer, strings_are_escaped_in_both_modes)
+{
+    const std::string text{"quote \" backslash \\ slash / newline \n tab \t cr \r bs \b ff \f x01 \x01 x1f \x1f del \x7f \xc3\xa4"};
+    const std::string tricky_key{"key \"with\" \\ and \n"};
+    const json document = write_both([&](Mcp_json_writer& w) {
+        w.begin_object();
+        w.key(tricky_key);
+        w.value(text);
+        w.key("nul");
+        w.value(std::string_view{"a\0b", 3});
+        w.key("c_string");
+        w.value("\"\\");
+        w.end_object();
+    });
+    EXPECT_EQ(document[tricky_key].get<std::string>(), text);
+    EXPECT_EQ(document["nul"].get<std::string>(), std::string("a\0b", 3));
+    EXPECT_EQ(document["c_string"].get<std::string>(), "\"\\");
+
+    // Control characters never appear raw, so the embedded form only
+    // doubles backslashes and quotes
+    std::string plain;
+    Mcp_json_writer writer{plain};
+    writer.value("\x01\n\"");
+    EXPECT_EQ(plain, R"("\u0001\n\"")");
+
+    std::string embedded;
+    Mcp_json_writer embedded_writer{embedded, true};
+    embedded_writer.value("\x01\n\"");
+    EXPECT_EQ(embedded, R"(\"\\u0001\\n\\\"\")");
+}
+
+TEST(Mcp_json_writer, non_finite_numbers_are_null)
+{
+    const json document = write_both([](Mcp_json_writer& w) {
+        w.begin_array();
+        w.value(std::numeric_limits<float>::quiet_NaN());
+        w.value(std::numeric_limits<float>::infinity());
+        w.value(-std::numeric_limits<float>::infinity());
+        w.value(std::numeric_limits<double>::quiet_NaN());
+        w.value(std::numeric_limits<double>::infinity());
+        w.value(-std::numeric_limits<double>::infinity());
+        w.value(0.5f);
+        w.value(-2.25);
+        w.end_array();
+    });
+    ASSERT_EQ(document.size(), 8u);
+    for (std::size_t i = 0; i < 6; ++i) {
+        EXPECT_TRUE(document[i].is_null()) << i;
+    }
+    EXPECT_EQ(document[6].get<double>(), 0.5);
+    EXPECT_EQ(document[7].get<double>(), -2.25);
+}
+
+TEST(Mcp_json_writer, floats_round_trip)
+{
+    const float  f = 0.1f;
+    const double d = 1.0 / 3.0;
+    const json document = write_both([&](Mcp_json_writer& w) {
+        w.begin_array();
+        w.value(f);
+        w.value(d);
+        w.value(std::numeric_limits<float>::max());
+        w.value(std::numeric_limits<double>::denorm_min());
+        w.end_array();
+    });
+    EXPECT_EQ(document[0].get<float>(), f);
+    EXPECT_EQ(document[1].get<double>(), d);
+    EXPECT_EQ(document[2].get<float>(), std::numeric_limits<float>::max());
+    EXPECT_EQ(document[3].get<double>(), std::numeric_limits<double>::denorm_min());
+}
+
+} // anonymous namespace
@@ -19,6 +19,7 @@
 #include <cstdlib>
 #include <map>
 #include <optional>
+#include <set>
 #include <string>
 #include <thread>
 #include <vector>
@@ -336,6 +337,49 @@ TEST_F(Mcp_test, get_scene_materials_returns_array_with_basic_fields)
     EXPECT_TRUE(first.contains("emissive"));
 }
 
+// Paging: walking get_scene_nodes with a small limit visits every node once,
+// and fields limits each record to the requested properties.
+TEST_F(Mcp_test, get_scene_nodes_pages_and_projects_fields)
+{
+    Mcp_env& env = Mcp_env::get();
+    Mcp_client::Tool_result all = env.client().call_tool(
+        "get_scene_nodes", json{{"scene_name", env.scene_name()}, {"fields", json::array({"id"})}}
+    );
+    ASSERT_FALSE(all.is_error) << all.text;
+    const std::size_t total = all.payload.value("total", std::size_t{0});
+    ASSERT_EQ(all.payload["nodes"].size(), total);
+
+    std::set<std::size_t> ids;
+    std::string           cursor;
+    for (int page = 0; page < 10000; ++page) {
+        json args{{"scene_name", env.scene_name()}, {"limit", 3}, {"fields", json::array({"id", "name"})}};
+        if (!cursor.empty()) {
+            args["cursor"] = cursor;
+        }
+        Mcp_client::Tool_result r = env.client().call_tool("get_scene_nodes", args);
+        ASSERT_FALSE(r.is_error) << r.text;
+        ASSERT_LE(r.payload["nodes"].size(), 3u);
+        for (const json& node : r.payload["nodes"]) {
+            EXPECT_EQ(node.size(), 2u) << node.dump();
+            ids.insert(node["id"].get<std::size_t>());
+        }
+        if (!r.payload.contains("next_cursor")) {
+            break;
+        }
+        cursor = r.payload["next_cursor"].get<std::string>();
+    }
+    EXPECT_EQ(ids.size(), total);
+
+    Mcp_client::Tool_result bad_field = env.client().call_tool(
+        "get_scene_nodes", json{{"scene_name", env.scene_name()}, {"fields", json::array({"no_such_field"})}}
+    );
+    EXPECT_TRUE(bad_field.is_error);
+    Mcp_client::Tool_result bad_cursor = env.client().call_tool(
+        "get_scene_nodes", json{{"scene_name", env.scene_name()}, {"cursor", "not-a-cursor"}}
+    );
+    EXPECT_TRUE(bad_cursor.is_error);
+}
+
 TEST_F(Mcp_test, get_scene_textures_responds_with_array)
 {
     Mcp_env& env = Mcp_env::get();
@@ -811,6 +855,137 @@ TEST_F(Mcp_test, create_material_roundtrip_and_duplicate_rejected)
     EXPECT_TRUE(dup.is_error);
 }
 
+// Scene snapshot queries: answered off the main thread, so many concurrent
+// calls all succeed, and a query sent after a mutation has completed sees
+// the mutation (the snapshot is withdrawn before any other tool runs, and
+// published again only after the frame's queued operations have run).
+TEST_F(Mcp_test, scene_snapshot_queries_are_concurrent_and_read_your_writes)
+{
+    Mcp_env& env = Mcp_env::get();
+    const std::string host = env_or    ("ERHE_MCP_TEST_HOST", "127.0.0.1");
+    const int         port = env_or_int("ERHE_MCP_TEST_PORT", 3743);
+
+    constexpr int            kRequestCount = 32;
+    std::vector<std::thread> threads;
+    std::atomic<int>         ok_count{0};
+    threads.reserve(kRequestCount);
+    for (int i = 0; i < kRequestCount; ++i) {
+        threads.emplace_back([&, i]() {
+            httplib::Client c{host, port};
+            c.set_read_timeout(10, 0);
+            const char* tool = ((i % 2) == 0) ? "get_scene_nodes" : "get_scene_materials";
+            json req = {
+                {"jsonrpc", "2.0"},
+                {"id",      i},
+                {"method",  "tools/call"},
+                {"params",  {{"name", tool}, {"arguments", {{"scene_name", env.scene_name()}}}}}
+            };
+            httplib::Result res = c.Post("/mcp", req.dump(), "application/json");
+            if (!res || res->status != 200) {
+                return;
+            }
+            json body = json::parse(res->body, nullptr, false);
+            if (!body.is_discarded() && body.contains("result")) {
+                ok_count.fetch_add(1);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(ok_count.load(), kRequestCount);
+
+    const std::string name =
+        "__mcp_test_snapshot_mat_" +
+        std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+    Mcp_client::Tool_result created = env.client().call_tool("create_material", json{
+        {"scene_name", env.scene_name()},
+        {"name",       name}
+    });
+    ASSERT_FALSE(created.is_error) << "create_material errored: " << created.text;
+
+    Mcp_client::Tool_result mats = env.client().call_tool(
+        "get_scene_materials", json{{"scene_name", env.scene_name()}}
+    );
+    ASSERT_FALSE(mats.is_error) << mats.text;
+    bool found = false;
+    for (const json& m : mats.payload["materials"]) {
+        if (m.value("name", std::string{}) == name) {
+            found = true;
+        }
+    }
+    EXPECT_TRUE(found) << "get_scene_materials did not list material created just before: " << name;
+
+    // reparent_node only queues an operation; the operation stack runs it
+    // later in the frame. A query sent after the call returns must still see
+    // the new parent, not a snapshot captured before the operation ran.
+    const auto get_parent_ids = [&env]() -> std::map<std::size_t, std::optional<std::size_t>> {
+        Mcp_client::Tool_result r = env.client().call_tool(
+            "get_scene_nodes", json{{"scene_name", env.scene_name()}, {"fields", json::array({"id", "parent_id"})}}
+        );
+        EXPECT_FALSE(r.is_error) << r.text;
+        std::map<std::size_t, std::optional<std::size_t>> parent_ids;
+        for (const json& node : r.payload["nodes"]) {
+            const json& parent_id = node["parent_id"];
+            parent_ids[node["id"].get<std::size_t>()] = parent_id.is_number()
+                ? std::optional<std::size_t>{parent_id.get<std::size_t>()}
+                : std::nullopt;
+        }
+        return parent_ids;
+    };
+    const std::map<std::size_t, std::optional<std::size_t>> parent_ids_before = get_parent_ids();
+
+    // A leaf node, so that any other node can become its parent. The scene
+    // root is the one node without a parent; it is neither moved nor used as
+    // the new parent.
+    std::set<std::size_t> parents;
+    for (const auto& [id, parent_id] : parent_ids_before) {
+        if (parent_id.has_value()) {
+            parents.insert(parent_id.value());
+        }
+    }
+    std::optional<std::size_t> child_id;
+    for (const auto& [id, parent_id] : parent_ids_before) {
+        if (parent_id.has_value() && !parents.contains(id)) {
+            child_id = id;
+            break;
+        }
+    }
+    std::optional<std::size_t> new_parent_id;
+    for (const auto& [id, parent_id] : parent_ids_before) {
+        if (parent_id.has_value() && child_id.has_value() && (id != child_id.value()) && (id != parent_ids_before.at(child_id.value()))) {
+            new_parent_id = id;
+            break;
+        }
+    }
+    if (!child_id.has_value() || !new_parent_id.has_value()) {
+        return; // scene too small to reparent anything
+    }
+
+    Mcp_client::Tool_result reparented = env.client().call_tool("reparent_node", json{
+        {"scene_name",     env.scene_name()},
+        {"node_id",        child_id.value()},
+        {"parent_node_id", new_parent_id.value()}
+    });
+    ASSERT_FALSE(reparented.is_error) << "reparent_node errored: " << reparented.text;
+    EXPECT_EQ(get_parent_ids()[child_id.value()], new_parent_id)
+        << "get_scene_nodes right after reparent_node did not show the new parent";
+
+    // Back to where it was; parent_node_id 0 is the scene root
+    const std::optional<std::size_t> old_parent_id = parent_ids_before.at(child_id.value());
+    const auto old_parent = parent_ids_before.find(old_parent_id.value());
+    const std::size_t restore_parent_id = ((old_parent != parent_ids_before.end()) && old_parent->second.has_value())
+        ? old_parent_id.value()
+        : std::size_t{0};
+    Mcp_client::Tool_result restored = env.client().call_tool("reparent_node", json{
+        {"scene_name",     env.scene_name()},
+        {"node_id",        child_id.value()},
+        {"parent_node_id", restore_parent_id}
+    });
+    ASSERT_FALSE(restored.is_error) << "reparent_node errored: " << restored.text;
+    EXPECT_EQ(get_parent_ids()[child_id.value()], old_parent_id);
+}
+
 TEST_F(Mcp_test, create_material_requires_name)
 {
     Mcp_client::Tool_result r = Mcp_env::get().client().call_tool("create_material", json{
@@ -1153,8 +1328,10 @@ TEST_F(Mcp_test, queue_overflow_returns_busy_error)
     const int         port = env_or_int("ERHE_MCP_TEST_PORT", 3743);
 
     // Spam more requests than the server's k_max_queue_depth (64) in
-    // parallel. Use list_scenes (a query that the main thread can
+    // parallel. Use get_server_info (a query that the main thread can
     // process quickly) so we depend on contention to fill the queue.
+    // Not list_scenes: scene snapshot queries are answered on the server
+    // thread and mostly bypass the queue.
     constexpr int        kRequestCount = 96;
     std::vector<std::thread> threads;
     std::atomic<int>         busy_count{0};
@@ -1168,7 +1345,7 @@ TEST_F(Mcp_test, queue_overflow_returns_busy_error)
                 {"jsonrpc", "2.0"},
                 {"id",      "queue-overflow"},
                 {"method",  "tools/call"},
-                {"params",  {{"name", "list_scenes"}, {"arguments", json::object()}}}
+                {"params",  {{"name", "get_server_info"}, {"arguments", json::object()}}}
             };
             httplib::Result res = c.Post("/mcp", req.dump(), "application/json");
             if (!res || res->status != 200) {
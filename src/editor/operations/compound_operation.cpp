@@ -57,4 +57,39 @@ void Compound_operation::collect_item_references(std::unordered_set<const erhe::
     }
 }
 
+void Compound_operation::collect_history_memory(History_resources& out_resources) const
+{
+    for (const std::shared_ptr<Operation>& operation : m_parameters.operations) {
+        operation->collect_history_memory(out_resources);
+    }
+}
+
+void Compound_operation::compact_history(const std::unordered_set<const erhe::geometry::Geometry*>& pinned_geometries)
+{
+    for (const std::shared_ptr<Operation>& operation : m_parameters.operations) {
+        operation->compact_history(pinned_geometries);
+    }
+}
+
+void Compound_operation::spill_history(const std::shared_ptr<History_spill_file>& spill_file)
+{
+    for (const std::shared_ptr<Operation>& operation : m_parameters.operations) {
+        operation->spill_history(spill_file);
+    }
+}
+
+void Compound_operation::collect_in_place_geometries(std::unordered_set<const erhe::geometry::Geometry*>& out_geometries) const
+{
+    for (const std::shared_ptr<Operation>& operation : m_parameters.operations) {
+        operation->collect_in_place_geometries(out_geometries);
+    }
+}
+
+void Compound_operation::expand_history(const std::unordered_set<const erhe::geometry::Geometry*>& geometries)
+{
+    for (const std::shared_ptr<Operation>& operation : m_parameters.operations) {
+        operation->expand_history(geometries);
+    }
+}
+
 }
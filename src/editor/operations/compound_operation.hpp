@@ -23,6 +23,11 @@ public:
     void execute (App_context& context) override;
     void undo    (App_context& context) override;
     void collect_item_references(std::unordered_set<const erhe::Item_base*>& out_items) const override;
+    void collect_history_memory     (History_resources& out_resources) const override;
+    void compact_history            (const std::unordered_set<const erhe::geometry::Geometry*>& pinned_geometries) override;
+    void spill_history              (const std::shared_ptr<History_spill_file>& spill_file) override;
+    void collect_in_place_geometries(std::unordered_set<const erhe::geometry::Geometry*>& out_geometries) const override;
+    void expand_history             (const std::unordered_set<const erhe::geometry::Geometry*>& geometries) override;
 
 private:
     Parameters m_parameters;
@@ -421,12 +421,6 @@ Make_atlas_operation::Make_atlas_operation(
     : Mesh_operation{std::move(context)}
 {
     set_description("Make atlas");
-    // make_atlas() takes geogram_lock() internally, only around its
-    // Geogram-parameterizer branch - the per-facet branch reaches no Geogram
-    // algorithm. Skipping the blanket make_entries() wrap lets per-facet
-    // unwraps of different meshes run concurrently on worker threads
-    // (Generate Lightmap UVs / Reorder Charts queue one operation per mesh).
-    m_callback_requires_geogram_lock = false;
     Lightmap_report* const report = m_parameters.context.lightmap_report;
     make_entries(
         [usage_index, hard_angles_threshold, parameterizer, packer, lightmap_texels_per_meter, chart_gutter_texels, chart_min_side_texels, report, per_facet_chart_order = std::move(per_facet_chart_order)](
@@ -643,12 +637,11 @@ auto Binary_mesh_operation::make_operations(
     }
     std::lock_guard<ERHE_PROFILE_LOCKABLE_BASE(std::mutex)> scene_lock{item_host->item_host_mutex};
 
-    // Merge inputs into the target's local space and run the boolean. The CSG
-    // implementations (and merge) reach Geogram, which must not run
-    // concurrently with other Geogram invocations - see geogram_lock().
+    // Merge inputs into the target's local space and run the boolean. Merge
+    // is mesh-local; the boolean takes geogram_lock() itself around
+    // mesh_boolean_operation().
     std::shared_ptr<erhe::geometry::Geometry> out_geometry = std::make_shared<erhe::geometry::Geometry>(operation_name);
     {
-        const std::lock_guard<std::recursive_mutex> geogram_guard{erhe::geometry::geogram_lock()};
         erhe::geometry::Geometry transformed_lhs{};
         erhe::geometry::Geometry transformed_rhs{};
         for (const Entry& entry : lhs_entries) {
@@ -0,0 +1,83 @@
+#include "operations/history_geometry_delta.hpp"
+
+#include "editor_log.hpp"
+
+#include "erhe_geometry/geometry.hpp"
+#include "erhe_geometry/geometry_delta.hpp"
+#include "erhe_geometry/geometry_serialization.hpp"
+#include "erhe_profile/profile.hpp"
+
+#include <span>
+
+namespace editor {
+
+namespace {
+
+[[nodiscard]] auto get_flat_data(const erhe::geometry::Geometry* geometry) -> erhe::geometry::Geometry_flat_data
+{
+    return (geometry != nullptr) ? erhe::geometry::geometry_to_flat_data(*geometry) : erhe::geometry::Geometry_flat_data{};
+}
+
+} // anonymous namespace
+
+auto make_history_geometry_delta(
+    const erhe::geometry::Geometry* reference,
+    const erhe::geometry::Geometry& target
+) -> History_geometry_delta
+{
+    ERHE_PROFILE_FUNCTION();
+
+    const erhe::geometry::Geometry_flat_data reference_data = get_flat_data(reference);
+    return History_geometry_delta{
+        .reference_hash = erhe::geometry::get_flat_data_hash(reference_data),
+        .delta          = erhe::geometry::make_geometry_delta(reference_data, erhe::geometry::geometry_to_flat_data(target))
+    };
+}
+
+auto spill_history_geometry_delta(History_geometry_delta& geometry_delta, History_spill_file& spill_file) -> bool
+{
+    if (geometry_delta.spill_record.has_value() || geometry_delta.delta.empty()) {
+        return false;
+    }
+    const std::optional<History_spill_file::Record> record = spill_file.write(geometry_delta.delta);
+    if (!record.has_value()) {
+        return false;
+    }
+    geometry_delta.spill_record = record;
+    geometry_delta.delta.clear();
+    geometry_delta.delta.shrink_to_fit();
+    return true;
+}
+
+auto restore_history_geometry(
+    const erhe::geometry::Geometry* reference,
+    const History_geometry_delta&   geometry_delta,
+    History_spill_file*             spill_file,
+    const std::string_view          name
+) -> std::shared_ptr<erhe::geometry::Geometry>
+{
+    ERHE_PROFILE_FUNCTION();
+
+    const erhe::geometry::Geometry_flat_data reference_data = get_flat_data(reference);
+    if (erhe::geometry::get_flat_data_hash(reference_data) != geometry_delta.reference_hash) {
+        log_operations->trace("Undo history: delta reference for '{}' changed", name);
+        return {};
+    }
+
+    std::vector<std::byte>     spilled_delta;
+    std::span<const std::byte> delta{geometry_delta.delta};
+    if (geometry_delta.spill_record.has_value()) {
+        if ((spill_file == nullptr) || !spill_file->read(geometry_delta.spill_record.value(), spilled_delta)) {
+            return {};
+        }
+        delta = spilled_delta;
+    }
+    erhe::geometry::Geometry_flat_data target{};
+    if (!erhe::geometry::apply_geometry_delta(reference_data, delta, target)) {
+        log_operations->trace("Undo history: delta for '{}' does not apply", name);
+        return {};
+    }
+    return erhe::geometry::make_geometry_from_flat_data(target, name);
+}
+
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "operations/history_spill_file.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace erhe::geometry {
+    class Geometry;
+}
+
+namespace editor {
+
+// One geometry of a compacted undo history entry (see
+// Mesh_operation::compact_history()): a delta (erhe_geometry/geometry_delta.hpp)
+// against a reference geometry, held in memory or spilled to a
+// History_spill_file. The reference is not kept; it is passed in again to
+// rebuild the geometry.
+class History_geometry_delta
+{
+public:
+    uint64_t                                  reference_hash{0};
+    std::vector<std::byte>                    delta{};
+    std::optional<History_spill_file::Record> spill_record{};
+};
+
+// reference nullptr makes a delta against empty flat data.
+[[nodiscard]] auto make_history_geometry_delta(
+    const erhe::geometry::Geometry* reference,
+    const erhe::geometry::Geometry& target
+) -> History_geometry_delta;
+
+// Moves the in-memory delta to spill_file. Returns false, keeping the delta
+// in memory, when it is already spilled or the write fails.
+[[nodiscard]] auto spill_history_geometry_delta(History_geometry_delta& geometry_delta, History_spill_file& spill_file) -> bool;
+
+// Rebuilds the target geometry bit-exact. Returns nullptr when reference
+// is not the geometry the delta was made against, or the spilled delta
+// cannot be read back. spill_file is needed only for a spilled delta.
+[[nodiscard]] auto restore_history_geometry(
+    const erhe::geometry::Geometry* reference,
+    const History_geometry_delta&   geometry_delta,
+    History_spill_file*             spill_file,
+    std::string_view                name
+) -> std::shared_ptr<erhe::geometry::Geometry>;
+
+}
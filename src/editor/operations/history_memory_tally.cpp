@@ -0,0 +1,49 @@
+#include "operations/history_memory_tally.hpp"
+
+#include "erhe_verify/verify.hpp"
+
+namespace editor {
+
+void History_memory_tally::add(const History_resources& resources)
+{
+    for (const auto& [address, byte_count] : resources) {
+        Resource& resource = m_resources[address];
+        if (resource.holder_count == 0) {
+            resource.byte_count = byte_count;
+            m_byte_count += byte_count;
+        }
+        ++resource.holder_count;
+    }
+}
+
+void History_memory_tally::remove(const History_resources& resources)
+{
+    for (const auto& [address, byte_count] : resources) {
+        const auto i = m_resources.find(address);
+        ERHE_VERIFY(i != m_resources.end());
+        Resource& resource = i->second;
+        ERHE_VERIFY(resource.holder_count > 0);
+        if (--resource.holder_count == 0) {
+            m_byte_count -= resource.byte_count;
+            m_resources.erase(i);
+        }
+    }
+}
+
+void History_memory_tally::clear()
+{
+    m_resources.clear();
+    m_byte_count = 0;
+}
+
+auto History_memory_tally::get_byte_count() const -> std::size_t
+{
+    return m_byte_count;
+}
+
+auto History_memory_tally::get_resource_count() const -> std::size_t
+{
+    return m_resources.size();
+}
+
+}
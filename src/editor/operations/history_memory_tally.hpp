@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <unordered_map>
+
+namespace editor {
+
+// Resources one recorded operation holds for undo / redo, by address, with
+// their byte counts (Operation::collect_history_memory()).
+using History_resources = std::unordered_map<const void*, std::size_t>;
+
+// Running total of the undo history memory: every resource counted once
+// however many operations hold it. Operation_stack::enforce_history_budget()
+// adds each operation's resources once, then updates the total per
+// compacted or spilled operation by removing what it held before and
+// adding what it holds after - linear in the history size, where a full
+// recount after every step would be quadratic.
+//
+// Remove an operation's old resources before adding its new ones: an
+// address freed by the change may be reused by a new allocation.
+class History_memory_tally
+{
+public:
+    void add   (const History_resources& resources);
+    void remove(const History_resources& resources);
+    void clear ();
+
+    [[nodiscard]] auto get_byte_count    () const -> std::size_t;
+    [[nodiscard]] auto get_resource_count() const -> std::size_t;
+
+private:
+    class Resource
+    {
+    public:
+        std::size_t byte_count  {0};
+        std::size_t holder_count{0};
+    };
+
+    std::unordered_map<const void*, Resource> m_resources;
+    std::size_t                               m_byte_count{0};
+};
+
+}
@@ -0,0 +1,207 @@
+#include "operations/history_spill_file.hpp"
+
+#include "editor_log.hpp"
+
+#include "erhe_profile/profile.hpp"
+#include "erhe_verify/verify.hpp"
+
+#include <fmt/format.h>
+#include <fmt/std.h>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <system_error>
+
+namespace editor {
+
+History_spill_file::History_spill_file()
+{
+    // Unique per editor instance: several editors may run at once.
+    const std::chrono::system_clock::duration now = std::chrono::system_clock::now().time_since_epoch();
+    const std::string file_name = fmt::format("erhe_undo_history_{}_{}.bin", now.count(), reinterpret_cast<std::uintptr_t>(this));
+    std::error_code error_code{};
+    std::filesystem::path directory = std::filesystem::temp_directory_path(error_code);
+    if (error_code) {
+        directory = std::filesystem::path{"cache"} / std::filesystem::path{"undo"};
+    }
+    m_path = directory / std::filesystem::path{file_name};
+}
+
+History_spill_file::~History_spill_file() noexcept
+{
+    close_and_remove();
+}
+
+auto History_spill_file::open() -> bool
+{
+    if (m_file.is_open()) {
+        return true;
+    }
+    std::error_code error_code{};
+    std::filesystem::create_directories(m_path.parent_path(), error_code);
+    m_file.open(m_path, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc);
+    if (!m_file.is_open()) {
+        log_operations->warn("Undo history: cannot create spill file '{}'", m_path);
+        return false;
+    }
+    m_file_byte_count = 0;
+    log_operations->info("Undo history: spilling to '{}'", m_path);
+    return true;
+}
+
+void History_spill_file::close_and_remove()
+{
+    if (!m_file.is_open()) {
+        return;
+    }
+    m_file.close();
+    std::error_code error_code{};
+    std::filesystem::remove(m_path, error_code);
+    m_file_byte_count = 0;
+    m_free_byte_count = 0;
+    m_free_ranges.clear();
+}
+
+auto History_spill_file::take_free_range(const std::uint64_t byte_count) -> std::optional<std::uint64_t>
+{
+    if (byte_count == 0) {
+        return {};
+    }
+    for (auto i = m_free_ranges.begin(), end = m_free_ranges.end(); i != end; ++i) {
+        const auto [offset, range_byte_count] = *i;
+        if (range_byte_count < byte_count) {
+            continue;
+        }
+        m_free_ranges.erase(i);
+        if (range_byte_count > byte_count) {
+            m_free_ranges.emplace(offset + byte_count, range_byte_count - byte_count);
+        }
+        m_free_byte_count -= static_cast<std::size_t>(byte_count);
+        return offset;
+    }
+    return {};
+}
+
+void History_spill_file::add_free_range(std::uint64_t offset, std::uint64_t byte_count)
+{
+    if (byte_count == 0) {
+        return;
+    }
+    m_free_byte_count += static_cast<std::size_t>(byte_count);
+
+    // Merge with the free neighbours on both sides
+    const auto next = m_free_ranges.find(offset + byte_count);
+    if (next != m_free_ranges.end()) {
+        byte_count += next->second;
+        m_free_ranges.erase(next);
+    }
+    auto previous = m_free_ranges.lower_bound(offset);
+    if (previous != m_free_ranges.begin()) {
+        --previous;
+        if (previous->first + previous->second == offset) {
+            offset      = previous->first;
+            byte_count += previous->second;
+            m_free_ranges.erase(previous);
+        }
+    }
+
+    if (offset + byte_count < m_file_byte_count) {
+        m_free_ranges.emplace(offset, byte_count);
+        return;
+    }
+
+    // Free tail: give it back to the file system. If truncating fails the
+    // bytes past the end are simply overwritten by later writes.
+    m_free_byte_count -= static_cast<std::size_t>(byte_count);
+    m_file_byte_count  = static_cast<std::size_t>(offset);
+    m_file.flush();
+    std::error_code error_code{};
+    std::filesystem::resize_file(m_path, m_file_byte_count, error_code);
+}
+
+auto History_spill_file::write(const std::span<const std::byte> bytes) -> std::optional<Record>
+{
+    ERHE_PROFILE_FUNCTION();
+
+    if (!open()) {
+        return {};
+    }
+    const std::optional<std::uint64_t> reused_offset = take_free_range(bytes.size());
+    const Record record{
+        .offset     = reused_offset.value_or(m_file_byte_count),
+        .byte_count = bytes.size()
+    };
+    m_file.clear();
+    m_file.seekp(static_cast<std::streamoff>(record.offset));
+    m_file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    m_file.flush();
+    if (!m_file) {
+        log_operations->warn("Undo history: writing {} bytes to spill file '{}' failed", bytes.size(), m_path);
+        m_file.clear();
+        if (reused_offset.has_value()) {
+            add_free_range(record.offset, record.byte_count);
+        }
+        return {};
+    }
+    if (!reused_offset.has_value()) {
+        m_file_byte_count += bytes.size();
+    }
+    m_live_byte_count   += bytes.size();
+    m_live_record_count += 1;
+    return record;
+}
+
+auto History_spill_file::read(const Record& record, std::vector<std::byte>& out) -> bool
+{
+    ERHE_PROFILE_FUNCTION();
+
+    if (!m_file.is_open() || (record.offset + record.byte_count > m_file_byte_count)) {
+        return false;
+    }
+    out.resize(static_cast<std::size_t>(record.byte_count));
+    m_file.clear();
+    m_file.seekg(static_cast<std::streamoff>(record.offset));
+    m_file.read(reinterpret_cast<char*>(out.data()), static_cast<std::streamsize>(record.byte_count));
+    if (!m_file) {
+        log_operations->error("Undo history: reading {} bytes at {} from spill file '{}' failed", record.byte_count, record.offset, m_path);
+        m_file.clear();
+        return false;
+    }
+    return true;
+}
+
+void History_spill_file::release(const Record& record)
+{
+    ERHE_VERIFY(m_live_record_count > 0);
+    ERHE_VERIFY(m_live_byte_count >= record.byte_count);
+    m_live_byte_count   -= static_cast<std::size_t>(record.byte_count);
+    m_live_record_count -= 1;
+    if (m_live_record_count == 0) {
+        close_and_remove();
+        return;
+    }
+    add_free_range(record.offset, record.byte_count);
+}
+
+auto History_spill_file::get_live_byte_count() const -> std::size_t
+{
+    return m_live_byte_count;
+}
+
+auto History_spill_file::get_file_byte_count() const -> std::size_t
+{
+    return m_file_byte_count;
+}
+
+auto History_spill_file::get_free_byte_count() const -> std::size_t
+{
+    return m_free_byte_count;
+}
+
+auto History_spill_file::get_path() const -> const std::filesystem::path&
+{
+    return m_path;
+}
+
+}
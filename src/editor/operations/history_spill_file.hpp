@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace editor {
+
+// Temporary file the undo history moves compacted entries to when
+// compacting alone does not meet the memory budget (see
+// Operation_stack::enforce_history_budget()).
+//
+// A record keeps its offset for as long as it is live; reading it back
+// does not free its space. Released ranges are merged with free
+// neighbours and reused first fit by later writes, and a free range at
+// the end of the file is truncated away, so the file stays about as large
+// as the live records. The file is deleted when the last live record is
+// released, which happens at the latest when the history is cleared, and
+// with the object. Shared (std::shared_ptr) by the records' owners, so an
+// operation that outlives the Operation_stack can still release or read
+// its records. Main thread only.
+class History_spill_file
+{
+public:
+    class Record
+    {
+    public:
+        std::uint64_t offset    {0};
+        std::uint64_t byte_count{0};
+    };
+
+    History_spill_file();
+    ~History_spill_file() noexcept;
+
+    History_spill_file(const History_spill_file&) = delete;
+    History_spill_file& operator=(const History_spill_file&) = delete;
+
+    // Returns std::nullopt when the file cannot be created or written; the
+    // caller then keeps the data in memory.
+    [[nodiscard]] auto write(std::span<const std::byte> bytes) -> std::optional<Record>;
+    [[nodiscard]] auto read (const Record& record, std::vector<std::byte>& out) -> bool;
+    void release(const Record& record);
+
+    [[nodiscard]] auto get_live_byte_count() const -> std::size_t;
+    [[nodiscard]] auto get_file_byte_count() const -> std::size_t; // live and free ranges
+    [[nodiscard]] auto get_free_byte_count() const -> std::size_t;
+    [[nodiscard]] auto get_path           () const -> const std::filesystem::path&;
+
+private:
+    [[nodiscard]] auto open() -> bool;
+    void close_and_remove();
+    [[nodiscard]] auto take_free_range(std::uint64_t byte_count) -> std::optional<std::uint64_t>;
+    void add_free_range(std::uint64_t offset, std::uint64_t byte_count);
+
+    std::filesystem::path m_path;
+    std::fstream          m_file;
+    std::size_t           m_file_byte_count  {0};
+    std::size_t           m_live_byte_count  {0};
+    std::size_t           m_live_record_count{0};
+    std::size_t           m_free_byte_count  {0};
+
+    // Released ranges inside m_file_byte_count, offset -> byte count,
+    // never adjacent to each other or to the end of the file.
+    std::map<std::uint64_t, std::uint64_t> m_free_ranges;
+};
+
+}
@@ -4,13 +4,17 @@
 #include "app_message_bus.hpp"
 #include "editor_log.hpp"
 #include "app_settings.hpp"
+#include "operations/history_geometry_delta.hpp"
 #include "items.hpp"
 #include "scene/node_physics.hpp"
 #include "scene/scene_root.hpp"
 #include "tools/mesh_component_selection.hpp"
 
 #include "erhe_geometry/geometry.hpp"
+#include "erhe_geometry/geometry_delta.hpp"
 #include "erhe_physics/icollision_shape.hpp"
+#include "erhe_primitive/buffer_mesh.hpp"
+#include "erhe_primitive/primitive.hpp"
 #include "erhe_scene/scene.hpp"
 #include "erhe_scene/node.hpp"
 
@@ -47,7 +51,12 @@ auto Mesh_operation::describe_entries() const -> std::string
     return ss.str();
 }
 
-Mesh_operation::~Mesh_operation() noexcept = default;
+Mesh_operation::~Mesh_operation() noexcept
+{
+    for (Entry& entry : m_entries) {
+        release_spill_records(entry);
+    }
+}
 
 void Mesh_operation::execute(App_context& context)
 {
@@ -79,6 +88,12 @@ void Mesh_operation::execute(App_context& context)
     }
     std::lock_guard<ERHE_PROFILE_LOCKABLE_BASE(std::mutex)> scene_lock{item_host->item_host_mutex};
 
+    if (!expand_all_entries()) {
+        set_error("Compacted undo history does not match the scene");
+        log_operations->error("Op Execute {} failed: {}", describe(), get_error());
+        return;
+    }
+
     log_operations->trace("Op Execute Begin {}", describe());
 
     for (const auto& entry : m_entries) {
@@ -104,6 +119,8 @@ void Mesh_operation::execute(App_context& context)
         node->set_parent(parent);
     }
 
+    m_applied = true;
+
     log_operations->trace("Op Execute End {}", describe());
 
     // Announce the geometry swap (eager housekeeping for the component-selection
@@ -154,6 +171,12 @@ void Mesh_operation::undo(App_context& context)
     if (item_host == nullptr) { return; }
     std::lock_guard<ERHE_PROFILE_LOCKABLE_BASE(std::mutex)> scene_lock{item_host->item_host_mutex};
 
+    if (!expand_all_entries()) {
+        set_error("Compacted undo history does not match the scene");
+        log_operations->error("Op Undo {} failed: {}", describe(), get_error());
+        return;
+    }
+
     log_operations->trace("Op Undo Begin {}", describe());
 
     for (const auto& entry : m_entries) {
@@ -179,6 +202,8 @@ void Mesh_operation::undo(App_context& context)
         node->set_parent(parent);
     }
 
+    m_applied = false;
+
     log_operations->trace("Op Undo End {}", describe());
 
     // Announce the geometry restore. The component-selection store re-binds the
@@ -191,6 +216,334 @@ void Mesh_operation::undo(App_context& context)
     }
 }
 
+namespace {
+
+// A primitive whose render shape can be rebuilt from its Geometry alone
+// with Mesh_operation_parameters::build_info: no separate collision
+// shape, no build products the operation build info does not ask for,
+// and a Geometry nothing edits in place.
+[[nodiscard]] auto is_compactable(
+    const erhe::scene::Mesh_primitive&                          mesh_primitive,
+    const std::unordered_set<const erhe::geometry::Geometry*>& pinned_geometries
+) -> bool
+{
+    const erhe::primitive::Primitive* primitive = mesh_primitive.primitive.get();
+    if ((primitive == nullptr) || !primitive->render_shape || primitive->collision_shape) {
+        return false;
+    }
+    const std::shared_ptr<erhe::geometry::Geometry>& geometry = primitive->render_shape->get_geometry_const();
+    if (!geometry || pinned_geometries.contains(geometry.get())) {
+        return false;
+    }
+    const erhe::primitive::Buffer_mesh& buffer_mesh = primitive->render_shape->get_renderable_mesh();
+    return buffer_mesh.triangle_fill_lods.empty() && buffer_mesh.triangle_fill_meshlets.empty();
+}
+
+[[nodiscard]] auto get_geometry(const erhe::scene::Mesh_primitive& mesh_primitive) -> const erhe::geometry::Geometry*
+{
+    const erhe::primitive::Primitive* primitive = mesh_primitive.primitive.get();
+    if ((primitive == nullptr) || !primitive->render_shape) {
+        return nullptr;
+    }
+    return primitive->render_shape->get_geometry_const().get();
+}
+
+void collect_primitive_resources(const erhe::scene::Mesh_primitive& mesh_primitive, History_resources& out_resources)
+{
+    const erhe::primitive::Primitive* primitive = mesh_primitive.primitive.get();
+    if ((primitive == nullptr) || !primitive->render_shape) {
+        return;
+    }
+    const erhe::geometry::Geometry* geometry = primitive->render_shape->get_geometry_const().get();
+    if ((geometry != nullptr) && !out_resources.contains(geometry)) {
+        out_resources.emplace(geometry, erhe::geometry::get_flat_data_byte_count(*geometry));
+    }
+    const erhe::primitive::Buffer_mesh& buffer_mesh = primitive->render_shape->get_renderable_mesh();
+    if (!out_resources.contains(&buffer_mesh)) {
+        std::size_t byte_count = 0;
+        for (const erhe::buffer::Buffer_allocation& allocation : buffer_mesh.vertex_allocations) {
+            byte_count += allocation.get_byte_count();
+        }
+        for (const erhe::buffer::Buffer_allocation& allocation : buffer_mesh.expanded_vertex_allocations) {
+            byte_count += allocation.get_byte_count();
+        }
+        byte_count += buffer_mesh.index_allocation           .get_byte_count();
+        byte_count += buffer_mesh.edge_line_vertex_allocation.get_byte_count();
+        byte_count += buffer_mesh.edge_line_joint_allocation .get_byte_count();
+        out_resources.emplace(&buffer_mesh, byte_count);
+    }
+}
+
+} // anonymous namespace
+
+auto Mesh_operation::get_out_version(Entry& entry) -> Entry::Version&
+{
+    return m_applied ? entry.before : entry.after;
+}
+
+auto Mesh_operation::get_in_version(Entry& entry) -> Entry::Version&
+{
+    return m_applied ? entry.after : entry.before;
+}
+
+void Mesh_operation::collect_history_memory(History_resources& out_resources) const
+{
+    // Only the side that is not in the scene is history cost: the other
+    // side is the current scene content, or the out side of the operation
+    // recorded after this one, which counts it.
+    for (const Entry& entry : m_entries) {
+        if (entry.compact.active) {
+            for (const Entry::Compact_primitive& compact_primitive : entry.compact.primitives) {
+                const std::vector<std::byte>& delta = compact_primitive.geometry_delta.delta;
+                if (!delta.empty()) {
+                    out_resources.emplace(delta.data(), delta.size());
+                }
+                if (compact_primitive.resident.has_value()) {
+                    collect_primitive_resources(compact_primitive.resident.value(), out_resources);
+                }
+            }
+            continue;
+        }
+        const Entry::Version& out = m_applied ? entry.before : entry.after;
+        for (const erhe::scene::Mesh_primitive& mesh_primitive : out.primitives) {
+            collect_primitive_resources(mesh_primitive, out_resources);
+        }
+    }
+}
+
+void Mesh_operation::compact_history(const std::unordered_set<const erhe::geometry::Geometry*>& pinned_geometries)
+{
+    ERHE_PROFILE_FUNCTION();
+
+    if (has_error()) {
+        return;
+    }
+    for (Entry& entry : m_entries) {
+        if (entry.compact.active || !entry.scene_mesh || entry.scene_mesh->skin) {
+            continue;
+        }
+        Entry::Version& out = get_out_version(entry);
+        Entry::Version& in  = get_in_version(entry);
+
+        std::unordered_set<const erhe::geometry::Geometry*> in_geometries;
+        for (const erhe::scene::Mesh_primitive& mesh_primitive : in.primitives) {
+            in_geometries.insert(get_geometry(mesh_primitive));
+        }
+
+        Entry::Compact compact{
+            .active             = true,
+            .in_primitive_count = in.primitives.size()
+        };
+        bool any_delta = false;
+        for (std::size_t i = 0, end = out.primitives.size(); i < end; ++i) {
+            const erhe::scene::Mesh_primitive& mesh_primitive = out.primitives[i];
+            Entry::Compact_primitive compact_primitive{
+                .material                 = mesh_primitive.material,
+                .lightmap_uv_scale_offset = mesh_primitive.lightmap_uv_scale_offset
+            };
+            if (!is_compactable(mesh_primitive, pinned_geometries) || in_geometries.contains(get_geometry(mesh_primitive))) {
+                compact_primitive.resident = mesh_primitive;
+                compact.primitives.push_back(std::move(compact_primitive));
+                continue;
+            }
+            const erhe::primitive::Primitive_render_shape& render_shape = *mesh_primitive.primitive->render_shape.get();
+            const erhe::geometry::Geometry& geometry = *render_shape.get_geometry_const().get();
+            compact_primitive.normal_style  = render_shape.get_normal_style();
+            compact_primitive.geometry_name = geometry.get_name();
+
+            // The reference is the primitive at the same index on the in
+            // side. Operations map primitives one to one, so this is the
+            // geometry the out side was made from or into.
+            const erhe::geometry::Geometry* reference = nullptr;
+            if ((i < in.primitives.size()) && is_compactable(in.primitives[i], pinned_geometries)) {
+                reference = get_geometry(in.primitives[i]);
+                compact_primitive.reference_index = i;
+            }
+            compact_primitive.geometry_delta = make_history_geometry_delta(reference, geometry);
+            compact.primitives.push_back(std::move(compact_primitive));
+            any_delta = true;
+        }
+        if (!any_delta) {
+            continue;
+        }
+
+        const std::size_t before_byte_count = [&]() {
+            History_resources resources;
+            for (const erhe::scene::Mesh_primitive& mesh_primitive : out.primitives) {
+                collect_primitive_resources(mesh_primitive, resources);
+            }
+            std::size_t byte_count = 0;
+            for (const auto& [address, resource_byte_count] : resources) {
+                byte_count += resource_byte_count;
+            }
+            return byte_count;
+        }();
+        entry.compact = std::move(compact);
+        out.primitives.clear();
+        out.primitives.shrink_to_fit();
+        in.primitives.clear();
+        in.primitives.shrink_to_fit();
+        for (Entry::Selection_remap& remap : entry.selection_remaps) {
+            remap.after_geometry.reset();
+        }
+        std::size_t delta_byte_count = 0;
+        for (const Entry::Compact_primitive& compact_primitive : entry.compact.primitives) {
+            delta_byte_count += compact_primitive.geometry_delta.delta.size();
+        }
+        log_operations->trace(
+            "Op {} mesh '{}' compacted: {} -> {} bytes",
+            describe(), entry.scene_mesh->get_name(), before_byte_count, delta_byte_count
+        );
+    }
+}
+
+void Mesh_operation::spill_history(const std::shared_ptr<History_spill_file>& spill_file)
+{
+    if (!spill_file) {
+        return;
+    }
+    for (Entry& entry : m_entries) {
+        if (!entry.compact.active) {
+            continue;
+        }
+        for (Entry::Compact_primitive& compact_primitive : entry.compact.primitives) {
+            History_geometry_delta& geometry_delta = compact_primitive.geometry_delta;
+            if (geometry_delta.spill_record.has_value() || geometry_delta.delta.empty()) {
+                continue;
+            }
+            // All records of one operation live in one file.
+            if (m_spill_file && (m_spill_file != spill_file)) {
+                return;
+            }
+            if (!spill_history_geometry_delta(geometry_delta, *spill_file.get())) {
+                return; // keep in memory
+            }
+            m_spill_file = spill_file;
+        }
+    }
+}
+
+void Mesh_operation::release_spill_records(Entry& entry)
+{
+    for (Entry::Compact_primitive& compact_primitive : entry.compact.primitives) {
+        std::optional<History_spill_file::Record>& spill_record = compact_primitive.geometry_delta.spill_record;
+        if (spill_record.has_value()) {
+            ERHE_VERIFY(m_spill_file);
+            m_spill_file->release(spill_record.value());
+            spill_record.reset();
+        }
+    }
+}
+
+auto Mesh_operation::rebuild_out_primitives(Entry& entry, std::vector<erhe::scene::Mesh_primitive>& out_primitives) -> bool
+{
+    ERHE_PROFILE_FUNCTION();
+
+    // The in side is whatever the scene mesh displays now. The reference
+    // hashes make sure it still is what the deltas were made against.
+    const std::vector<erhe::scene::Mesh_primitive>& in_primitives = entry.scene_mesh->get_primitives();
+    if (in_primitives.size() != entry.compact.in_primitive_count) {
+        log_operations->trace(
+            "Op {} mesh '{}': scene has {} primitives, compacted entry expects {}",
+            describe(), entry.scene_mesh->get_name(), in_primitives.size(), entry.compact.in_primitive_count
+        );
+        return false;
+    }
+
+    out_primitives.clear();
+    out_primitives.reserve(entry.compact.primitives.size());
+    for (const Entry::Compact_primitive& compact_primitive : entry.compact.primitives) {
+        if (compact_primitive.resident.has_value()) {
+            out_primitives.push_back(compact_primitive.resident.value());
+            continue;
+        }
+        const erhe::geometry::Geometry* reference = nullptr;
+        if (compact_primitive.reference_index != Entry::Compact_primitive::no_reference) {
+            reference = get_geometry(in_primitives[compact_primitive.reference_index]);
+            if (reference == nullptr) {
+                return false;
+            }
+        }
+        const std::shared_ptr<erhe::geometry::Geometry> geometry = restore_history_geometry(
+            reference, compact_primitive.geometry_delta, m_spill_file.get(), compact_primitive.geometry_name
+        );
+        if (!geometry) {
+            log_operations->trace("Op {} mesh '{}': cannot rebuild compacted primitive", describe(), entry.scene_mesh->get_name());
+            return false;
+        }
+        std::shared_ptr<erhe::primitive::Primitive> primitive = std::make_shared<erhe::primitive::Primitive>(geometry);
+        const bool renderable_ok = primitive->make_renderable_mesh(m_parameters.build_info, compact_primitive.normal_style);
+        const bool raytrace_ok   = primitive->make_raytrace();
+        if (!renderable_ok || !raytrace_ok) {
+            return false;
+        }
+        out_primitives.push_back(
+            erhe::scene::Mesh_primitive{
+                .primitive                = primitive,
+                .material                 = compact_primitive.material,
+                .lightmap_uv_scale_offset = compact_primitive.lightmap_uv_scale_offset
+            }
+        );
+    }
+    return true;
+}
+
+void Mesh_operation::expand_entry(Entry& entry, std::vector<erhe::scene::Mesh_primitive>&& out_primitives)
+{
+    release_spill_records(entry);
+    get_in_version (entry).primitives = entry.scene_mesh->get_primitives();
+    get_out_version(entry).primitives = std::move(out_primitives);
+    entry.compact = Entry::Compact{};
+    for (Entry::Selection_remap& remap : entry.selection_remaps) {
+        if (remap.primitive_index < entry.after.primitives.size()) {
+            const erhe::scene::Mesh_primitive& mesh_primitive = entry.after.primitives[remap.primitive_index];
+            if (mesh_primitive.primitive && mesh_primitive.primitive->render_shape) {
+                remap.after_geometry = mesh_primitive.primitive->render_shape->get_geometry();
+            }
+        }
+    }
+}
+
+auto Mesh_operation::expand_all_entries() -> bool
+{
+    // All or nothing: a failure leaves every entry and the scene as they
+    // were.
+    std::vector<std::vector<erhe::scene::Mesh_primitive>> rebuilt(m_entries.size());
+    for (std::size_t i = 0, end = m_entries.size(); i < end; ++i) {
+        if (m_entries[i].compact.active && !rebuild_out_primitives(m_entries[i], rebuilt[i])) {
+            return false;
+        }
+    }
+    for (std::size_t i = 0, end = m_entries.size(); i < end; ++i) {
+        if (m_entries[i].compact.active) {
+            expand_entry(m_entries[i], std::move(rebuilt[i]));
+        }
+    }
+    return true;
+}
+
+void Mesh_operation::expand_history(const std::unordered_set<const erhe::geometry::Geometry*>& geometries)
+{
+    for (Entry& entry : m_entries) {
+        if (!entry.compact.active) {
+            continue;
+        }
+        bool displays_geometry = false;
+        for (const erhe::scene::Mesh_primitive& mesh_primitive : entry.scene_mesh->get_primitives()) {
+            if (geometries.contains(get_geometry(mesh_primitive))) {
+                displays_geometry = true;
+                break;
+            }
+        }
+        // Failing to rebuild means the scene mesh is not at this entry's
+        // in state, so the geometry is not this entry's delta reference.
+        std::vector<erhe::scene::Mesh_primitive> out_primitives;
+        if (displays_geometry && rebuild_out_primitives(entry, out_primitives)) {
+            expand_entry(entry, std::move(out_primitives));
+        }
+    }
+}
+
 void Mesh_operation::make_entries(
     const std::function<void(const erhe::geometry::Geometry& before_geometry, erhe::geometry::Geometry& after_geometry)> geometry_operation
 )
@@ -281,23 +634,13 @@ void Mesh_operation::make_entries(
                 erhe::geometry::operation::Geometry_component_selection remap_destination;
 
                 auto after_geometry = std::make_shared<erhe::geometry::Geometry>();
-                {
-                    // The operation implementations reach geogram algorithms
-                    // (mesh_repair, CVT remesh/smooth, booleans, Delaunay)
-                    // which must not run concurrently with other geogram
-                    // invocations - deferred glTF finalize tasks and sibling
-                    // async operations run on other workers. See
-                    // erhe::geometry::geogram_lock(). Scoped to the geometry
-                    // operation only: the buffer-mesh / raytrace builds below
-                    // take their own (inner) locks. Skipped for operations
-                    // that lock internally exactly where Geogram is involved
-                    // (m_callback_requires_geogram_lock in the header).
-                    std::unique_lock<std::recursive_mutex> geogram_guard{erhe::geometry::geogram_lock(), std::defer_lock};
-                    if (m_callback_requires_geogram_lock) {
-                        geogram_guard.lock();
-                    }
-                    geometry_operation(*before_geometry.get(), *after_geometry.get(), node, selected_facets, remap_source, &remap_destination);
-                }
+                // No caller lock: the erhe::geometry operations take
+                // erhe::geometry::geogram_lock() themselves, around the
+                // geogram algorithm calls only (mesh_repair, CVT
+                // remesh/smooth, booleans, Delaunay, atlas, frame field), so
+                // operations on different meshes run concurrently on the
+                // workers. See erhe::geometry::geogram_lock().
+                geometry_operation(*before_geometry.get(), *after_geometry.get(), node, selected_facets, remap_source, &remap_destination);
 
                 auto sanitize_warnings = after_geometry->sanitize();
                 if (!sanitize_warnings.empty()) {
@@ -1,18 +1,25 @@
 #pragma once
 
+#include "operations/history_geometry_delta.hpp"
+#include "operations/history_spill_file.hpp"
 #include "operations/operation.hpp"
 
 #include "erhe_geometry/operation/geometry_operation.hpp"
 #include "erhe_primitive/build_info.hpp"
+#include "erhe_primitive/enums.hpp"
 #include "erhe_scene/mesh.hpp"
 
 #include <geogram/basic/numeric.h>
 #include <glm/glm.hpp>
 
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <optional>
 #include <set>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -110,6 +117,37 @@ public:
             erhe::geometry::operation::Geometry_component_selection components{};
         };
         std::vector<Selection_remap> selection_remaps{};
+
+        // Compacted form of the entry (compact_history()). The side of the
+        // entry that is not in the scene - before while the operation is
+        // applied, after while it is undone - is kept per primitive as a
+        // geometry delta (erhe_geometry/geometry_delta.hpp) against the
+        // primitive at the same index on the other side. The other side is
+        // not kept at all: it is what the scene mesh displays whenever this
+        // entry is toggled next, so execute() / undo() take it from there.
+        // Primitives that cannot be rebuilt from their Geometry alone stay
+        // resident as they are.
+        class Compact_primitive
+        {
+        public:
+            static constexpr std::size_t no_reference = std::numeric_limits<std::size_t>::max();
+
+            std::shared_ptr<erhe::primitive::Material> material{};
+            glm::vec4                                  lightmap_uv_scale_offset{0.0f};
+            erhe::primitive::Normal_style              normal_style{erhe::primitive::Normal_style::corner_normals};
+            std::string                                geometry_name{};
+            std::size_t                                reference_index{no_reference}; // no_reference: delta against empty flat data
+            History_geometry_delta                     geometry_delta{};
+            std::optional<erhe::scene::Mesh_primitive> resident{};
+        };
+        class Compact
+        {
+        public:
+            bool                           active{false};
+            std::size_t                    in_primitive_count{0}; // primitives the scene mesh must display on toggle
+            std::vector<Compact_primitive> primitives{};
+        };
+        Compact compact{};
     };
 
     explicit Mesh_operation(Mesh_operation_parameters&& parameters);
@@ -118,6 +156,10 @@ public:
     // Implements Operation
     void execute (App_context& context)  override;
     void undo    (App_context& context)  override;
+    void collect_history_memory  (History_resources& out_resources) const override;
+    void compact_history         (const std::unordered_set<const erhe::geometry::Geometry*>& pinned_geometries) override;
+    void spill_history           (const std::shared_ptr<History_spill_file>& spill_file) override;
+    void expand_history          (const std::unordered_set<const erhe::geometry::Geometry*>& geometries) override;
 
     // Public API
     void add_entry   (Entry&& entry);
@@ -166,15 +208,17 @@ protected:
 
     Mesh_operation_parameters m_parameters;
     std::vector<Entry>        m_entries;
-    // make_entries() wraps the geometry-operation callback in
-    // erhe::geometry::geogram_lock() by default, because most operation
-    // implementations reach Geogram algorithms without locking themselves.
-    // An operation whose implementation takes the lock internally exactly
-    // where Geogram is involved (e.g. Make_atlas_operation - make_atlas
-    // locks only its Geogram-parameterizer branch, so per-facet unwraps of
-    // different meshes run in parallel on worker threads) sets this false
-    // in its constructor BEFORE calling make_entries().
-    bool                      m_callback_requires_geogram_lock{true};
+
+private:
+    [[nodiscard]] auto get_out_version(Entry& entry) -> Entry::Version&;
+    [[nodiscard]] auto get_in_version (Entry& entry) -> Entry::Version&;
+    [[nodiscard]] auto rebuild_out_primitives(Entry& entry, std::vector<erhe::scene::Mesh_primitive>& out_primitives) -> bool;
+    [[nodiscard]] auto expand_all_entries() -> bool;
+    void expand_entry         (Entry& entry, std::vector<erhe::scene::Mesh_primitive>&& out_primitives);
+    void release_spill_records(Entry& entry);
+
+    bool                                m_applied{false}; // before (false) or after (true) is in the scene
+    std::shared_ptr<History_spill_file> m_spill_file{};
 };
 
 }
@@ -75,6 +75,13 @@ void Move_mesh_vertices_operation::undo(App_context& context)
     apply(context, m_parameters.before_positions);
 }
 
+void Move_mesh_vertices_operation::collect_in_place_geometries(std::unordered_set<const erhe::geometry::Geometry*>& out_geometries) const
+{
+    if (m_parameters.geometry) {
+        out_geometries.insert(m_parameters.geometry.get());
+    }
+}
+
 void Move_mesh_vertices_operation::apply(App_context& context, const std::vector<glm::vec3>& positions)
 {
     if (!m_parameters.mesh || !m_parameters.geometry) {
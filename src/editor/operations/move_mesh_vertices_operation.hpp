@@ -50,6 +50,7 @@ public:
     // Implements Operation
     void execute(App_context& context) override;
     void undo   (App_context& context) override;
+    void collect_in_place_geometries(std::unordered_set<const erhe::geometry::Geometry*>& out_geometries) const override;
 
 private:
     void apply(App_context& context, const std::vector<glm::vec3>& positions);
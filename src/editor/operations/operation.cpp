@@ -21,6 +21,31 @@ void Operation::collect_item_references(std::unordered_set<const erhe::Item_base
     static_cast<void>(out_items);
 }
 
+void Operation::collect_history_memory(History_resources& out_resources) const
+{
+    static_cast<void>(out_resources);
+}
+
+void Operation::compact_history(const std::unordered_set<const erhe::geometry::Geometry*>& pinned_geometries)
+{
+    static_cast<void>(pinned_geometries);
+}
+
+void Operation::spill_history(const std::shared_ptr<History_spill_file>& spill_file)
+{
+    static_cast<void>(spill_file);
+}
+
+void Operation::collect_in_place_geometries(std::unordered_set<const erhe::geometry::Geometry*>& out_geometries) const
+{
+    static_cast<void>(out_geometries);
+}
+
+void Operation::expand_history(const std::unordered_set<const erhe::geometry::Geometry*>& geometries)
+{
+    static_cast<void>(geometries);
+}
+
 void Operation::set_description(std::string&& description)
 {
     m_description = std::move(description);
@@ -1,17 +1,25 @@
 #pragma once
 
+#include "operations/history_memory_tally.hpp"
+
 #include "erhe_item/unique_id.hpp"
 
+#include <cstddef>
+#include <memory>
 #include <string>
 #include <unordered_set>
 
 namespace erhe {
     class Item_base;
 }
+namespace erhe::geometry {
+    class Geometry;
+}
 
 namespace editor {
 
 class App_context;
+class History_spill_file;
 
 class Operation
 {
@@ -55,6 +63,34 @@ public:
     // raw references to what is being dropped (doc/reloadable-asset-loads.md).
     virtual void drop_payload();
 
+    // Undo history memory budget (Operation_stack::enforce_history_budget(),
+    // operations/notes.md). Adds the resources this operation holds for
+    // undo / redo to out_resources, by address, so History_memory_tally
+    // counts what is shared with another recorded operation once.
+    // Default: nothing.
+    virtual void collect_history_memory(History_resources& out_resources) const;
+
+    // Re-encodes what the operation holds into a smaller form that
+    // execute() / undo() rebuild bit-exact from. pinned_geometries are
+    // edited in place by some recorded operation and must keep their
+    // identity; they are neither dropped nor used as a delta reference.
+    // Default: keep everything.
+    virtual void compact_history(const std::unordered_set<const erhe::geometry::Geometry*>& pinned_geometries);
+
+    // Moves the compacted form to spill_file. Default: nothing to spill.
+    virtual void spill_history(const std::shared_ptr<History_spill_file>& spill_file);
+
+    // Geometries this operation edits in place (it holds the Geometry and
+    // mutates it on execute and undo, instead of swapping in a new one).
+    // Default: none.
+    virtual void collect_in_place_geometries(std::unordered_set<const erhe::geometry::Geometry*>& out_geometries) const;
+
+    // Called on every recorded operation before an operation that edits
+    // geometries in place executes or undoes: a compacted entry whose delta
+    // reference is one of geometries must return to its full form first,
+    // because the reference content is about to change. Default: no-op.
+    virtual void expand_history(const std::unordered_set<const erhe::geometry::Geometry*>& geometries);
+
     [[nodiscard]] auto        describe  () const -> const std::string&;
     [[nodiscard]] inline auto get_serial() const -> std::size_t { return m_id.get_id(); }
     [[nodiscard]] auto        get_error () const -> const std::string&;
@@ -1,8 +1,12 @@
 #include "operations/operation_stack.hpp"
 
 #include "app_context.hpp"
+#include "config/generated/editor_settings_config.hpp"
+#include "config/generated/undo_history_config.hpp"
 #include "editor_log.hpp"
 #include "operations/compound_operation.hpp"
+#include "operations/history_memory_tally.hpp"
+#include "operations/history_spill_file.hpp"
 #include "operations/operation.hpp"
 
 #include "erhe_commands/commands.hpp"
@@ -12,7 +16,9 @@
 
 #include <imgui/imgui.h>
 
+#include <algorithm>
 #include <thread>
+#include <utility>
 
 namespace editor {
 
@@ -108,6 +114,7 @@ void Operation_stack::queue(const std::shared_ptr<Operation>& operation)
     // illegal, so a follow-up queued BY an executing operation keeps the
     // deferred semantics (and lands outside the group).
     if (m_grouping && !m_executing) {
+        prepare_history_for(*operation);
         m_executing = true;
         operation->execute(m_context);
         m_executing = false;
@@ -138,6 +145,7 @@ void Operation_stack::execute_now(const std::shared_ptr<Operation>& operation)
     verify_main_thread();
     ERHE_VERIFY(!m_executing);
 
+    prepare_history_for(*operation);
     m_executing = true;
     operation->execute(m_context);
     m_executing = false;
@@ -147,6 +155,7 @@ void Operation_stack::execute_now(const std::shared_ptr<Operation>& operation)
     }
     m_executed.push_back(operation);
     m_undone.clear();
+    enforce_history_budget();
 }
 
 void Operation_stack::begin_group()
@@ -180,6 +189,7 @@ auto Operation_stack::end_group() -> std::size_t
         m_undone.clear();
     }
     m_group_collected.clear();
+    enforce_history_budget();
     return count;
 }
 
@@ -212,6 +222,7 @@ void Operation_stack::update()
     // queue() follow-up operations, growing (and reallocating) m_queued.
     for (std::size_t i = 0; i < m_queued.size(); ++i) {
         std::shared_ptr<Operation> operation = m_queued[i];
+        prepare_history_for(*operation);
         m_executing = true;
         operation->execute(m_context);
         m_executing = false;
@@ -219,6 +230,7 @@ void Operation_stack::update()
     }
     m_queued.clear();
     m_undone.clear();
+    enforce_history_budget();
 }
 
 void Operation_stack::undo()
@@ -231,6 +243,7 @@ void Operation_stack::undo()
     }
     auto operation = m_executed.back(); // intentionally not a reference, otherwise pop_back() below will invalidate
     m_executed.pop_back();
+    prepare_history_for(*operation);
     m_executing = true;
     operation->undo(m_context);
     m_executing = false;
@@ -246,6 +259,8 @@ void Operation_stack::undo()
     if (m_undone.size() == 1) {
         operation->on_lossless_undo(m_context);
     }
+
+    enforce_history_budget();
 }
 
 auto Operation_stack::free_undone_loads() -> Operation_stack::Free_undone_loads_result
@@ -285,6 +300,7 @@ auto Operation_stack::free_undone_loads() -> Operation_stack::Free_undone_loads_
         result.discarded_count,
         (result.discarded_count == 1) ? "y" : "ies"
     );
+    enforce_history_budget();
     return result;
 }
 
@@ -295,6 +311,123 @@ void Operation_stack::clear_history()
 
     m_executed.clear();
     m_undone.clear();
+
+    // Operations still referenced elsewhere keep the file alive through
+    // their own reference; the next spill starts a new one.
+    m_spill_file.reset();
+    m_history_byte_count = 0;
+}
+
+void Operation_stack::prepare_history_for(const Operation& operation)
+{
+    std::unordered_set<const erhe::geometry::Geometry*> geometries;
+    operation.collect_in_place_geometries(geometries);
+    if (geometries.empty()) {
+        return;
+    }
+    for (const std::shared_ptr<Operation>& recorded : m_executed) {
+        recorded->expand_history(geometries);
+    }
+    for (const std::shared_ptr<Operation>& recorded : m_undone) {
+        recorded->expand_history(geometries);
+    }
+}
+
+auto Operation_stack::get_history_memory_usage() const -> std::size_t
+{
+    return m_history_byte_count;
+}
+
+namespace {
+
+class History_candidate
+{
+public:
+    std::size_t       distance {0}; // undo / redo steps from the current state
+    Operation*        operation{nullptr};
+    History_resources resources{};
+};
+
+} // anonymous namespace
+
+void Operation_stack::enforce_history_budget()
+{
+    ERHE_PROFILE_FUNCTION();
+
+    // Each operation is collected once here and again only after it is
+    // compacted or spilled; the tally keeps the total in between.
+    // m_executed.back() and m_undone.back() are both one step away.
+    std::vector<History_candidate> candidates;
+    candidates.reserve(m_executed.size() + m_undone.size());
+    for (std::size_t i = 0, end = m_executed.size(); i < end; ++i) {
+        candidates.push_back(History_candidate{.distance = end - i, .operation = m_executed[i].get()});
+    }
+    for (std::size_t i = 0, end = m_undone.size(); i < end; ++i) {
+        candidates.push_back(History_candidate{.distance = end - i, .operation = m_undone[i].get()});
+    }
+    History_memory_tally tally;
+    for (History_candidate& candidate : candidates) {
+        candidate.operation->collect_history_memory(candidate.resources);
+        tally.add(candidate.resources);
+    }
+    m_history_byte_count = tally.get_byte_count();
+
+    if (m_context.editor_settings == nullptr) {
+        return;
+    }
+    const Undo_history_config& config = m_context.editor_settings->undo_history;
+    if ((config.memory_budget_mb <= 0) || !config.compact) {
+        return;
+    }
+    const std::size_t budget = static_cast<std::size_t>(config.memory_budget_mb) * 1024 * 1024;
+    if (m_history_byte_count <= budget) {
+        return;
+    }
+
+    std::stable_sort(
+        candidates.begin(), candidates.end(),
+        [](const History_candidate& lhs, const History_candidate& rhs) {
+            return lhs.distance > rhs.distance;
+        }
+    );
+
+    // Geometries edited in place must keep their identity.
+    std::unordered_set<const erhe::geometry::Geometry*> pinned_geometries;
+    for (const History_candidate& candidate : candidates) {
+        candidate.operation->collect_in_place_geometries(pinned_geometries);
+    }
+
+    const auto recollect = [&tally](History_candidate& candidate) {
+        tally.remove(candidate.resources);
+        candidate.resources.clear();
+        candidate.operation->collect_history_memory(candidate.resources);
+        tally.add(candidate.resources);
+    };
+    for (History_candidate& candidate : candidates) {
+        candidate.operation->compact_history(pinned_geometries);
+        recollect(candidate);
+        if (tally.get_byte_count() <= budget) {
+            break;
+        }
+    }
+    if ((tally.get_byte_count() > budget) && config.spill_to_disk) {
+        if (!m_spill_file) {
+            m_spill_file = std::make_shared<History_spill_file>();
+        }
+        for (History_candidate& candidate : candidates) {
+            candidate.operation->spill_history(m_spill_file);
+            recollect(candidate);
+            if (tally.get_byte_count() <= budget) {
+                break;
+            }
+        }
+    }
+    const std::size_t start_usage = m_history_byte_count;
+    m_history_byte_count = tally.get_byte_count();
+    log_operations->debug(
+        "Undo history: {} -> {} bytes, budget {} bytes{}",
+        start_usage, m_history_byte_count, budget, (m_history_byte_count > budget) ? " (not met)" : ""
+    );
 }
 
 void Operation_stack::collect_item_references(std::unordered_set<const erhe::Item_base*>& out_items) const
@@ -321,10 +454,12 @@ void Operation_stack::redo()
     }
     auto operation = m_undone.back(); // intentionally not a reference, otherwise pop_back() below will invalidate
     m_undone.pop_back();
+    prepare_history_for(*operation);
     m_executing = true;
     operation->execute(m_context);
     m_executing = false;
     m_executed.push_back(operation);
+    enforce_history_budget();
 }
 
 auto Operation_stack::can_undo() const -> bool
@@ -376,6 +511,20 @@ void Operation_stack::imgui()
 {
     ERHE_PROFILE_FUNCTION();
 
+    const std::size_t history_byte_count = m_history_byte_count;
+    if ((m_context.editor_settings != nullptr) && (m_context.editor_settings->undo_history.memory_budget_mb > 0)) {
+        ImGui::Text(
+            "History memory: %.1f / %d MiB",
+            static_cast<double>(history_byte_count) / (1024.0 * 1024.0),
+            m_context.editor_settings->undo_history.memory_budget_mb
+        );
+    } else {
+        ImGui::Text("History memory: %.1f MiB", static_cast<double>(history_byte_count) / (1024.0 * 1024.0));
+    }
+    if (m_spill_file && (m_spill_file->get_live_byte_count() > 0)) {
+        ImGui::Text("Spilled to disk: %.1f MiB", static_cast<double>(m_spill_file->get_live_byte_count()) / (1024.0 * 1024.0));
+    }
+
     imgui("Executed", m_executed);
     imgui("Undone",   m_undone);
 }
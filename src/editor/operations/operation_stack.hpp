@@ -6,6 +6,7 @@
 #include "erhe_imgui/imgui_window.hpp"
 #include "erhe_profile/profile.hpp"
 
+#include <cstddef>
 #include <memory>
 #include <mutex>
 #include <unordered_set>
@@ -15,11 +16,13 @@
 namespace erhe            { class Item_base; }
 namespace erhe::commands  { class Commands; }
 namespace erhe::imgui     { class Imgui_windows; }
+namespace erhe::geometry  { class Geometry; }
 
 namespace editor {
 
 class App_context;
 class App_message_bus;
+class History_spill_file;
 class Operation;
 class Mcp_server;
 class Operation_stack;
@@ -160,6 +163,12 @@ public:
 
     void update();
 
+    // Undo history memory budget (Undo_history_config). Bytes the recorded
+    // operations hold for undo / redo, see Operation::collect_history_memory().
+    // Counted by enforce_history_budget() whenever the history changes, so
+    // this is cheap enough to show every frame.
+    [[nodiscard]] auto get_history_memory_usage() const -> std::size_t;
+
     // Implements Window
     void imgui() override;
 
@@ -173,6 +182,17 @@ private:
 
     void verify_main_thread() const;
 
+    // Before operation executes or undoes: returns compacted history
+    // entries whose delta reference operation is about to edit in place to
+    // their full form (Operation::expand_history()).
+    void prepare_history_for(const Operation& operation);
+
+    // After recording, undo, redo and free_undone_loads(): counts the
+    // history into m_history_byte_count and, while it is over
+    // Undo_history_config::memory_budget_mb, compacts and then spills the
+    // entries farthest from the current state first.
+    void enforce_history_budget();
+
     App_context&  m_context;
     Undo_command  m_undo_command;
     Free_undone_loads_command m_free_undone_loads_command;
@@ -183,6 +203,10 @@ private:
     std::vector<std::shared_ptr<Operation>> m_undone;
     std::vector<std::shared_ptr<Operation>> m_queued;
 
+    // Created on first spill, dropped with the history.
+    std::shared_ptr<History_spill_file>     m_spill_file;
+    std::size_t                             m_history_byte_count{0};
+
     // Undo-group scope state (begin_group / end_group).
     bool                                    m_grouping{false};
     std::vector<std::shared_ptr<Operation>> m_group_collected;
@@ -30,6 +30,7 @@
 #include "scene/scene_commands.hpp"
 #include "scene/scene_commit_queue.hpp"
 #include "scene/scene_root.hpp"
+#include "scene/scene_save_queue.hpp"
 
 #include <algorithm>
 #include "scene/viewport_scene_views.hpp"
@@ -2508,7 +2509,7 @@ void Operations::export_callback(const char* const* filelist, int filter)
         const erhe::gltf::Gltf_physics_data physics_data = build_gltf_physics_data(scene, scene_root->get_content_library().get());
         // Prefab instances export as glTF 2.1 externalAsset references
         // instead of flattened content.
-        std::string gltf = erhe::gltf::export_gltf(
+        const std::shared_ptr<erhe::gltf::Gltf_export_snapshot> snapshot = erhe::gltf::make_gltf_export_snapshot(
             erhe::gltf::Gltf_export_arguments{
                 .root_node             = *root_node.get(),
                 .binary                = binary,
@@ -2518,7 +2519,9 @@ void Operations::export_callback(const char* const* filelist, int filter)
                 .animations            = collect_gltf_export_animations(scene_root->get_content_library())
             }
         );
-        erhe::file::write_file(path.value(), gltf);
+        if (snapshot) {
+            static_cast<void>(m_context.scene_save_queue->write(snapshot, path.value()));
+        }
     }
 }
 
@@ -2584,20 +2587,33 @@ void Operations::save_scene()
             return;
         }
     }
-    save_scene_to_file(*scene_root, path);
+    save_scene_to_file(scene_root, path);
 }
 
-void Operations::save_scene_to_file(Scene_root& scene_root, const std::filesystem::path& path)
+void Operations::save_scene_to_file(const std::shared_ptr<Scene_root>& scene_root, const std::filesystem::path& path)
 {
+    // Snapshot now, write in the background (Scene_save_queue); the status
+    // bar shows the progress.
     try {
-        if (editor::save_scene_gltf(m_context, scene_root, path)) {
-            if (scene_root.get_source_path().empty()) {
-                // The scene now lives in this file: further saves write back
-                // to it without confirmation.
-                scene_root.set_source_path(path);
-            }
-            log_operations->info("Scene '{}' saved to '{}'", scene_root.get_name(), erhe::file::to_string(path));
-        }
+        const std::weak_ptr<Scene_root> weak_scene_root = scene_root;
+        static_cast<void>(
+            m_context.scene_save_queue->save(
+                scene_root,
+                path,
+                [weak_scene_root, path](const bool ok) {
+                    const std::shared_ptr<Scene_root> saved_scene_root = weak_scene_root.lock();
+                    if (!ok || !saved_scene_root) {
+                        return;
+                    }
+                    if (saved_scene_root->get_source_path().empty()) {
+                        // The scene now lives in this file: further saves write
+                        // back to it without confirmation.
+                        saved_scene_root->set_source_path(path);
+                    }
+                    log_operations->info("Scene '{}' saved to '{}'", saved_scene_root->get_name(), erhe::file::to_string(path));
+                }
+            )
+        );
     } catch (...) {
         log_operations->error("exception: save scene");
     }
@@ -2658,7 +2674,7 @@ void Operations::imgui_modal_dialogs()
         ImGui::Text("'%s' already exists.", erhe::file::to_string(m_save_confirm_path).c_str());
         ImGui::Separator();
         if (ImGui::Button("Overwrite")) {
-            save_scene_to_file(*m_save_confirm_scene_root, m_save_confirm_path);
+            save_scene_to_file(m_save_confirm_scene_root, m_save_confirm_path);
             m_save_confirm_scene_root.reset();
             m_save_confirm_imgui_context = nullptr;
             ImGui::CloseCurrentPopup();
@@ -219,7 +219,7 @@ public:
 private:
     // Saves the scene as a single erhe-authored glTF file (shared by
     // save_scene and the overwrite-confirmation modal).
-    void save_scene_to_file(Scene_root& scene_root, const std::filesystem::path& path);
+    void save_scene_to_file(const std::shared_ptr<Scene_root>& scene_root, const std::filesystem::path& path);
 
     void async_for_selected_nodes_with_mesh(std::function<void(Mesh_operation_parameters&&)> op, bool selection_aware = false);
 
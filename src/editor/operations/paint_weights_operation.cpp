@@ -35,6 +35,13 @@ void Paint_weights_operation::undo(App_context& context)
     apply(context, m_parameters.before_joint_indices, m_parameters.before_joint_weights);
 }
 
+void Paint_weights_operation::collect_in_place_geometries(std::unordered_set<const erhe::geometry::Geometry*>& out_geometries) const
+{
+    if (m_parameters.geometry) {
+        out_geometries.insert(m_parameters.geometry.get());
+    }
+}
+
 void Paint_weights_operation::apply(
     App_context&                   context,
     const std::vector<glm::uvec4>& joint_indices,
@@ -52,4 +52,11 @@ void Set_edge_sharpness_operation::undo(App_context&)
     }
 }
 
+void Set_edge_sharpness_operation::collect_in_place_geometries(std::unordered_set<const erhe::geometry::Geometry*>& out_geometries) const
+{
+    if (m_parameters.geometry) {
+        out_geometries.insert(m_parameters.geometry.get());
+    }
+}
+
 }
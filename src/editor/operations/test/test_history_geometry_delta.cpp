@@ -0,0 +1,154 @@
+// The geometry half of the undo history compact -> spill -> undo path, as
+// Mesh_operation drives it: the side of an applied operation that is not in
+// the scene becomes a delta against the side that is, the delta moves to the
+// spill file, and undo rebuilds it bit-exact from the scene geometry and the
+// spilled bytes. The GPU buffer mesh and raytrace rebuild on top of this
+// need a graphics device and are not covered here.
+
+#include "operations/history_geometry_delta.hpp"
+#include "operations/history_spill_file.hpp"
+
+#include "erhe_geometry/geometry.hpp"
+#include "erhe_geometry/geometry_delta.hpp"
+#include "erhe_geometry/geometry_serialization.hpp"
+#include "erhe_geometry/operation/conway/subdivide.hpp"
+#include "erhe_geometry/shapes/torus.hpp"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <memory>
+
+namespace {
+
+using editor::History_geometry_delta;
+using editor::History_spill_file;
+using erhe::geometry::Geometry;
+
+constexpr uint64_t k_process_flags =
+    Geometry::process_flag_connect                       |
+    Geometry::process_flag_build_edges                   |
+    Geometry::process_flag_compute_facet_centroids       |
+    Geometry::process_flag_compute_smooth_vertex_normals |
+    Geometry::process_flag_generate_facet_texture_coordinates;
+
+auto make_torus(const int major_steps) -> std::shared_ptr<Geometry>
+{
+    std::shared_ptr<Geometry> geometry = std::make_shared<Geometry>("torus");
+    erhe::geometry::shapes::make_torus(geometry->get_mesh(), 1.0f, 0.25f, major_steps, 16);
+    geometry->process({.flags = k_process_flags});
+    return geometry;
+}
+
+auto make_subdivided(const Geometry& source) -> std::shared_ptr<Geometry>
+{
+    std::shared_ptr<Geometry> geometry = std::make_shared<Geometry>("subdivided");
+    erhe::geometry::operation::subdivide(source, *geometry);
+    geometry->process({.flags = k_process_flags});
+    return geometry;
+}
+
+auto get_hash(const Geometry& geometry) -> uint64_t
+{
+    return erhe::geometry::get_flat_data_hash(erhe::geometry::geometry_to_flat_data(geometry));
+}
+
+TEST(HistoryGeometryDelta, CompactSpillUndoRoundTrip)
+{
+    // Subdivide applied: the scene shows after, the history holds before
+    const std::shared_ptr<Geometry> before = make_torus(24);
+    const std::shared_ptr<Geometry> after  = make_subdivided(*before);
+
+    // Compact
+    History_geometry_delta geometry_delta = editor::make_history_geometry_delta(after.get(), *before);
+    EXPECT_FALSE(geometry_delta.delta.empty());
+    EXPECT_FALSE(geometry_delta.spill_record.has_value());
+
+    // Spill
+    History_spill_file spill_file;
+    const std::size_t delta_byte_count = geometry_delta.delta.size();
+    ASSERT_TRUE(editor::spill_history_geometry_delta(geometry_delta, spill_file));
+    EXPECT_TRUE(geometry_delta.delta.empty());
+    ASSERT_TRUE(geometry_delta.spill_record.has_value());
+    EXPECT_EQ(spill_file.get_live_byte_count(), delta_byte_count);
+
+    // Already spilled: nothing more to do
+    EXPECT_FALSE(editor::spill_history_geometry_delta(geometry_delta, spill_file));
+
+    // Undo: rebuild before from the scene geometry and the spilled delta
+    const std::shared_ptr<Geometry> restored = editor::restore_history_geometry(after.get(), geometry_delta, &spill_file, "torus");
+    ASSERT_TRUE(restored);
+    EXPECT_EQ(restored->get_name(), "torus");
+    EXPECT_EQ(get_hash(*restored), get_hash(*before));
+    EXPECT_EQ(restored->get_mesh().facets.nb(), before->get_mesh().facets.nb());
+
+    // Expanding releases the record, which removes the file
+    spill_file.release(geometry_delta.spill_record.value());
+    EXPECT_FALSE(std::filesystem::exists(spill_file.get_path()));
+}
+
+TEST(HistoryGeometryDelta, InMemoryRoundTripWithoutReference)
+{
+    // A primitive without a compactable counterpart is a delta against
+    // empty flat data
+    const std::shared_ptr<Geometry> before = make_torus(12);
+    const History_geometry_delta geometry_delta = editor::make_history_geometry_delta(nullptr, *before);
+    const std::shared_ptr<Geometry> restored = editor::restore_history_geometry(nullptr, geometry_delta, nullptr, "torus");
+    ASSERT_TRUE(restored);
+    EXPECT_EQ(get_hash(*restored), get_hash(*before));
+}
+
+TEST(HistoryGeometryDelta, ChangedReferenceIsRejected)
+{
+    const std::shared_ptr<Geometry> before = make_torus(24);
+    const std::shared_ptr<Geometry> after  = make_subdivided(*before);
+    const History_geometry_delta geometry_delta = editor::make_history_geometry_delta(after.get(), *before);
+
+    // The scene no longer displays the reference
+    EXPECT_FALSE(editor::restore_history_geometry(before.get(), geometry_delta, nullptr, "torus"));
+    EXPECT_FALSE(editor::restore_history_geometry(nullptr, geometry_delta, nullptr, "torus"));
+}
+
+TEST(HistoryGeometryDelta, SpilledDeltaNeedsItsFile)
+{
+    const std::shared_ptr<Geometry> before = make_torus(24);
+    const std::shared_ptr<Geometry> after  = make_subdivided(*before);
+    History_geometry_delta geometry_delta = editor::make_history_geometry_delta(after.get(), *before);
+    History_spill_file spill_file;
+    ASSERT_TRUE(editor::spill_history_geometry_delta(geometry_delta, spill_file));
+    EXPECT_FALSE(editor::restore_history_geometry(after.get(), geometry_delta, nullptr, "torus"));
+    spill_file.release(geometry_delta.spill_record.value());
+}
+
+TEST(HistoryGeometryDelta, ReusedSpillSpaceKeepsOtherDeltas)
+{
+    // Two operations spill, the first is expanded, a third reuses its space:
+    // the second still rebuilds bit-exact
+    const std::shared_ptr<Geometry> torus_a = make_torus(24);
+    const std::shared_ptr<Geometry> torus_b = make_torus(32);
+    const std::shared_ptr<Geometry> after_a = make_subdivided(*torus_a);
+    const std::shared_ptr<Geometry> after_b = make_subdivided(*torus_b);
+
+    History_spill_file spill_file;
+    History_geometry_delta delta_a = editor::make_history_geometry_delta(after_a.get(), *torus_a);
+    History_geometry_delta delta_b = editor::make_history_geometry_delta(after_b.get(), *torus_b);
+    ASSERT_TRUE(editor::spill_history_geometry_delta(delta_a, spill_file));
+    ASSERT_TRUE(editor::spill_history_geometry_delta(delta_b, spill_file));
+    const std::size_t file_byte_count = spill_file.get_file_byte_count();
+
+    spill_file.release(delta_a.spill_record.value());
+    History_geometry_delta delta_c = editor::make_history_geometry_delta(after_a.get(), *torus_a);
+    ASSERT_TRUE(editor::spill_history_geometry_delta(delta_c, spill_file));
+    EXPECT_EQ(delta_c.spill_record->offset, 0u);
+    EXPECT_EQ(spill_file.get_file_byte_count(), file_byte_count);
+
+    const std::shared_ptr<Geometry> restored_b = editor::restore_history_geometry(after_b.get(), delta_b, &spill_file, "b");
+    const std::shared_ptr<Geometry> restored_c = editor::restore_history_geometry(after_a.get(), delta_c, &spill_file, "c");
+    ASSERT_TRUE(restored_b && restored_c);
+    EXPECT_EQ(get_hash(*restored_b), get_hash(*torus_b));
+    EXPECT_EQ(get_hash(*restored_c), get_hash(*torus_a));
+    spill_file.release(delta_b.spill_record.value());
+    spill_file.release(delta_c.spill_record.value());
+}
+
+} // anonymous namespace
@@ -0,0 +1,115 @@
+// History_memory_tally: the running undo history total that
+// Operation_stack::enforce_history_budget() updates per compacted operation
+// must match a full recount of the union of what every operation holds.
+
+#include "operations/history_memory_tally.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+using editor::History_memory_tally;
+using editor::History_resources;
+
+// Stand-in resource addresses
+const int g_resources[8]{};
+
+auto address(const int index) -> const void*
+{
+    return &g_resources[index];
+}
+
+auto recount(const std::vector<History_resources>& operations) -> std::size_t
+{
+    History_resources all;
+    for (const History_resources& resources : operations) {
+        all.insert(resources.begin(), resources.end());
+    }
+    std::size_t byte_count = 0;
+    for (const auto& [resource, resource_byte_count] : all) {
+        byte_count += resource_byte_count;
+    }
+    return byte_count;
+}
+
+TEST(HistoryMemoryTally, SharedResourcesCountOnce)
+{
+    History_memory_tally tally;
+    const History_resources a{{address(0), 100}, {address(1), 10}};
+    const History_resources b{{address(1), 10}, {address(2), 1}};
+    tally.add(a);
+    tally.add(b);
+    EXPECT_EQ(tally.get_byte_count(), 111u);
+    EXPECT_EQ(tally.get_resource_count(), 3u);
+
+    // address(1) is still held by b
+    tally.remove(a);
+    EXPECT_EQ(tally.get_byte_count(), 11u);
+    tally.remove(b);
+    EXPECT_EQ(tally.get_byte_count(), 0u);
+    EXPECT_EQ(tally.get_resource_count(), 0u);
+}
+
+TEST(HistoryMemoryTally, ReplacingOneOperationMatchesRecount)
+{
+    // A compacted operation drops its geometry (address 0, shared with
+    // nobody) and its buffer mesh (address 1, shared with the next
+    // operation), and now holds a delta (address 3).
+    std::vector<History_resources> operations{
+        {{address(0), 1000}, {address(1), 500}},
+        {{address(1), 500},  {address(2), 700}}
+    };
+    History_memory_tally tally;
+    for (const History_resources& resources : operations) {
+        tally.add(resources);
+    }
+    EXPECT_EQ(tally.get_byte_count(), recount(operations));
+
+    tally.remove(operations[0]);
+    operations[0] = {{address(3), 40}};
+    tally.add(operations[0]);
+    EXPECT_EQ(tally.get_byte_count(), 1240u);
+    EXPECT_EQ(tally.get_byte_count(), recount(operations));
+}
+
+TEST(HistoryMemoryTally, RandomReplacementsMatchRecount)
+{
+    std::mt19937 random{99u};
+    std::vector<std::size_t> byte_counts(8);
+    for (std::size_t& byte_count : byte_counts) {
+        byte_count = 1 + random() % 1000u;
+    }
+    const auto make_resources = [&]() {
+        History_resources resources;
+        for (int i = 0; i < 8; ++i) {
+            if ((random() % 3u) == 0u) {
+                resources.emplace(address(i), byte_counts[static_cast<std::size_t>(i)]);
+            }
+        }
+        return resources;
+    };
+
+    std::vector<History_resources> operations(16);
+    History_memory_tally tally;
+    for (History_resources& resources : operations) {
+        resources = make_resources();
+        tally.add(resources);
+    }
+    for (int step = 0; step < 500; ++step) {
+        History_resources& resources = operations[random() % operations.size()];
+        tally.remove(resources);
+        resources = make_resources();
+        tally.add(resources);
+        ASSERT_EQ(tally.get_byte_count(), recount(operations)) << "step " << step;
+    }
+
+    tally.clear();
+    EXPECT_EQ(tally.get_byte_count(), 0u);
+}
+
+} // anonymous namespace
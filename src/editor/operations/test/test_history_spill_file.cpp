@@ -0,0 +1,203 @@
+// History_spill_file: records read back as written, released ranges are
+// merged and reused so the file does not grow without bound, a free tail is
+// truncated, and the file goes away with the last live record.
+
+#include "operations/history_spill_file.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <random>
+#include <vector>
+
+namespace {
+
+using editor::History_spill_file;
+using Record = History_spill_file::Record;
+
+auto make_bytes(const std::size_t byte_count, const std::uint8_t seed) -> std::vector<std::byte>
+{
+    std::vector<std::byte> bytes(byte_count);
+    for (std::size_t i = 0; i < byte_count; ++i) {
+        bytes[i] = static_cast<std::byte>((seed + i * 7u) & 0xffu);
+    }
+    return bytes;
+}
+
+auto write(History_spill_file& file, const std::size_t byte_count, const std::uint8_t seed) -> Record
+{
+    const std::optional<Record> record = file.write(make_bytes(byte_count, seed));
+    EXPECT_TRUE(record.has_value());
+    return record.value_or(Record{});
+}
+
+auto read(History_spill_file& file, const Record& record) -> std::vector<std::byte>
+{
+    std::vector<std::byte> bytes;
+    EXPECT_TRUE(file.read(record, bytes));
+    return bytes;
+}
+
+TEST(HistorySpillFile, WriteReadRelease)
+{
+    History_spill_file file;
+    EXPECT_FALSE(std::filesystem::exists(file.get_path()));
+
+    const Record a = write(file, 100, 1);
+    const Record b = write(file, 50,  2);
+    EXPECT_TRUE(std::filesystem::exists(file.get_path()));
+    EXPECT_EQ(a.offset, 0u);
+    EXPECT_EQ(b.offset, 100u);
+    EXPECT_EQ(file.get_live_byte_count(), 150u);
+    EXPECT_EQ(file.get_file_byte_count(), 150u);
+    EXPECT_EQ(read(file, a), make_bytes(100, 1));
+    EXPECT_EQ(read(file, b), make_bytes(50,  2));
+
+    // Reading does not release
+    EXPECT_EQ(read(file, a), make_bytes(100, 1));
+    EXPECT_EQ(file.get_live_byte_count(), 150u);
+
+    file.release(a);
+    EXPECT_EQ(file.get_live_byte_count(), 50u);
+    EXPECT_EQ(read(file, b), make_bytes(50, 2));
+    file.release(b);
+    EXPECT_EQ(file.get_live_byte_count(), 0u);
+    EXPECT_EQ(file.get_file_byte_count(), 0u);
+    EXPECT_FALSE(std::filesystem::exists(file.get_path()));
+
+    // A later write starts a new file
+    const Record c = write(file, 10, 3);
+    EXPECT_EQ(c.offset, 0u);
+    EXPECT_EQ(read(file, c), make_bytes(10, 3));
+}
+
+TEST(HistorySpillFile, ReadRejectsRecordsPastTheEnd)
+{
+    History_spill_file file;
+    std::vector<std::byte> bytes;
+    EXPECT_FALSE(file.read(Record{.offset = 0, .byte_count = 1}, bytes));
+    const Record a = write(file, 16, 1);
+    EXPECT_FALSE(file.read(Record{.offset = a.offset + 8, .byte_count = 16}, bytes));
+}
+
+TEST(HistorySpillFile, ReleasedRangesAreReused)
+{
+    History_spill_file file;
+    const Record a = write(file, 100, 1);
+    const Record b = write(file, 50,  2);
+    const Record c = write(file, 100, 3);
+    file.release(a);
+    EXPECT_EQ(file.get_free_byte_count(), 100u);
+    EXPECT_EQ(file.get_file_byte_count(), 250u);
+
+    // First fit into the hole a left; the rest of it stays free
+    const Record d = write(file, 60, 4);
+    EXPECT_EQ(d.offset, 0u);
+    EXPECT_EQ(file.get_free_byte_count(), 40u);
+    const Record e = write(file, 40, 5);
+    EXPECT_EQ(e.offset, 60u);
+    EXPECT_EQ(file.get_free_byte_count(), 0u);
+    EXPECT_EQ(file.get_file_byte_count(), 250u);
+
+    // Does not fit any hole: appended
+    file.release(b);
+    const Record f = write(file, 80, 6);
+    EXPECT_EQ(f.offset, 250u);
+
+    for (const auto& [record, seed] : {std::pair{c, 3}, std::pair{d, 4}, std::pair{e, 5}, std::pair{f, 6}}) {
+        EXPECT_EQ(read(file, record), make_bytes(static_cast<std::size_t>(record.byte_count), static_cast<std::uint8_t>(seed)));
+    }
+}
+
+TEST(HistorySpillFile, NeighbouringRangesMerge)
+{
+    History_spill_file file;
+    const Record a = write(file, 100, 1);
+    const Record b = write(file, 100, 2);
+    const Record c = write(file, 100, 3);
+    const Record d = write(file, 10,  4);
+
+    // Released out of order: c joins b on its left, then a joins both
+    file.release(c);
+    file.release(a);
+    EXPECT_EQ(file.get_free_byte_count(), 200u);
+    file.release(b);
+    EXPECT_EQ(file.get_free_byte_count(), 300u);
+
+    const Record e = write(file, 300, 5);
+    EXPECT_EQ(e.offset, 0u);
+    EXPECT_EQ(file.get_file_byte_count(), 310u);
+    EXPECT_EQ(read(file, d), make_bytes(10, 4));
+}
+
+TEST(HistorySpillFile, FreeTailIsTruncated)
+{
+    History_spill_file file;
+    const Record a = write(file, 100, 1);
+    const Record b = write(file, 100, 2);
+    const Record c = write(file, 100, 3);
+
+    // b is a hole; releasing c frees it and the tail together
+    file.release(b);
+    file.release(c);
+    EXPECT_EQ(file.get_file_byte_count(), 100u);
+    EXPECT_EQ(file.get_free_byte_count(), 0u);
+    EXPECT_EQ(std::filesystem::file_size(file.get_path()), 100u);
+
+    const Record d = write(file, 20, 4);
+    EXPECT_EQ(d.offset, 100u);
+    EXPECT_EQ(read(file, a), make_bytes(100, 1));
+    EXPECT_EQ(read(file, d), make_bytes(20,  4));
+}
+
+TEST(HistorySpillFile, ChurnKeepsLiveRecordsAndBoundsTheFile)
+{
+    // Random writes and releases around a steady set of live records: every
+    // live record reads back as written, and reusing released ranges keeps
+    // the file within a small factor of the live bytes at their peak, where
+    // an append-only file would hold everything ever written.
+    History_spill_file file;
+    std::mt19937 random{4321u};
+    std::uniform_int_distribution<std::size_t> size_distribution{1, 512};
+
+    class Live
+    {
+    public:
+        Record       record;
+        std::uint8_t seed;
+    };
+    std::vector<Live> live;
+    std::size_t peak_live_byte_count = 0;
+    std::size_t written_byte_count   = 0;
+    for (int step = 0; step < 3000; ++step) {
+        if ((live.size() >= 64) || (!live.empty() && ((random() % 3u) == 0u))) {
+            const std::size_t index = random() % live.size();
+            ASSERT_EQ(
+                read(file, live[index].record),
+                make_bytes(static_cast<std::size_t>(live[index].record.byte_count), live[index].seed)
+            ) << "step " << step;
+            file.release(live[index].record);
+            live[index] = live.back();
+            live.pop_back();
+            continue;
+        }
+        const std::uint8_t seed = static_cast<std::uint8_t>(step);
+        live.push_back(Live{.record = write(file, size_distribution(random), seed), .seed = seed});
+        written_byte_count += static_cast<std::size_t>(live.back().record.byte_count);
+        peak_live_byte_count = std::max(peak_live_byte_count, file.get_live_byte_count());
+        ASSERT_EQ(file.get_file_byte_count(), file.get_live_byte_count() + file.get_free_byte_count());
+    }
+    EXPECT_LT(file.get_file_byte_count(), 2 * peak_live_byte_count);
+    EXPECT_LT(10 * peak_live_byte_count, written_byte_count);
+    for (const Live& entry : live) {
+        EXPECT_EQ(read(file, entry.record), make_bytes(static_cast<std::size_t>(entry.record.byte_count), entry.seed));
+        file.release(entry.record);
+    }
+    EXPECT_FALSE(std::filesystem::exists(file.get_path()));
+}
+
+} // anonymous namespace
@@ -529,6 +529,8 @@ auto make_import_build_info(
         .primitive_types = {
             .fill_triangles          = true,
             .fill_triangles_expanded = true,
+            .fill_triangle_lods      = true,
+            .fill_triangle_meshlets  = true,
             .edge_lines              = true,
             .corner_points           = true,
             .centroid_points         = true
@@ -537,6 +539,33 @@ auto make_import_build_info(
     };
 }
 
+auto make_skinned_import_build_info(
+    const erhe::primitive::Build_info&  build_info,
+    const erhe::primitive::Buffer_info& skinned_buffer_info
+) -> erhe::primitive::Build_info
+{
+    // The skinned buffer_info uses vertex_format_skinned so the GPU vertex
+    // buffer carries joint_indices + joint_weights. Without this,
+    // Shader_key::derive won't set USE_SKINNING (it checks the vertex_format
+    // for joint attributes), and the standard.vert skinning branch is dead
+    // code.
+    // No level of detail or meshlet index ranges for skinned meshes: the
+    // draw-list LOD pick and cluster culling skip skinned lists (deformed
+    // bounds), so they would never be used.
+    erhe::primitive::Primitive_types skinned_primitive_types = build_info.primitive_types;
+    skinned_primitive_types.fill_triangle_lods     = false;
+    skinned_primitive_types.fill_triangle_meshlets = false;
+    return erhe::primitive::Build_info{
+        .primitive_types = skinned_primitive_types,
+        .buffer_info     = skinned_buffer_info,
+        .constant_color  = build_info.constant_color,
+        .keep_geometry   = build_info.keep_geometry,
+        .normal_style    = build_info.normal_style,
+        .vertex_id_vec3  = build_info.vertex_id_vec3,
+        .autocolor       = build_info.autocolor
+    };
+}
+
 // Worker-side half of finalize_imported_meshes (async-asset-loading plan
 // phase 3a): builds every imported primitive's Buffer_mesh. Everything else
 // finalize_imported_meshes does - the raytrace proxy, update_rt_primitives,
@@ -617,20 +646,10 @@ void finalize_imported_meshes(
     const bool defer_edge_lines = (context.editor_settings != nullptr) && context.editor_settings->load.deferred_edge_lines;
     const bool defer_raytrace   = (context.editor_settings != nullptr) && context.editor_settings->load.deferred_raytrace;
 
-    // Build_info variant for skinned meshes -- same as the caller's
-    // build_info but with vertex_format_skinned so the GPU vertex buffer
-    // carries joint_indices + joint_weights. Without this, Shader_key::derive
-    // won't set USE_SKINNING (it checks the vertex_format for joint
-    // attributes), and the standard.vert skinning branch is dead code.
-    const erhe::primitive::Build_info skinned_build_info{
-        .primitive_types = build_info.primitive_types,
-        .buffer_info     = context.mesh_memory->make_skinned_primitive_buffer_info(),
-        .constant_color  = build_info.constant_color,
-        .keep_geometry   = build_info.keep_geometry,
-        .normal_style    = build_info.normal_style,
-        .vertex_id_vec3  = build_info.vertex_id_vec3,
-        .autocolor       = build_info.autocolor
-    };
+    const erhe::primitive::Build_info skinned_build_info = make_skinned_import_build_info(
+        build_info,
+        context.mesh_memory->make_skinned_primitive_buffer_info()
+    );
 
     for (const std::shared_ptr<erhe::scene::Node>& node : gltf_data.nodes) {
         if (!node) {
@@ -786,6 +805,7 @@ auto make_import_gltf_operation(
             .path            = path,
             .parallel        = (context.editor_settings == nullptr) || context.editor_settings->load.parallel_gltf_parse,
             .fix_spot_lights = context.fix_gltf_spot_lights,
+            .compressed_image_cache = (context.editor_settings == nullptr) || context.editor_settings->load.compressed_texture_cache,
         };
         const std::chrono::steady_clock::time_point parse_start_time = std::chrono::steady_clock::now();
         gltf_data = erhe::gltf::parse_gltf(parse_arguments);
@@ -1285,13 +1305,15 @@ auto collect_gltf_export_animations(const std::shared_ptr<Content_library>& cont
     return content_library->animations->get_all<erhe::scene::Animation>();
 }
 
-auto save_scene_gltf(Scene_root& scene_root, const std::filesystem::path& path) -> bool
+auto make_scene_gltf_snapshot(Scene_root& scene_root, const std::filesystem::path& path) -> std::shared_ptr<erhe::gltf::Gltf_export_snapshot>
 {
+    ERHE_PROFILE_FUNCTION();
+
     const erhe::scene::Scene& scene = scene_root.get_scene();
     const std::shared_ptr<erhe::scene::Node> root_node = scene.get_root_node();
     if (!root_node) {
         log_parsers->error("save_scene_gltf: scene '{}' has no root node", scene_root.get_name());
-        return false;
+        return {};
     }
     const erhe::gltf::Gltf_physics_data physics_data = build_gltf_physics_data(scene, scene_root.get_content_library().get());
     erhe::gltf::Gltf_export_arguments export_arguments{
@@ -1306,23 +1328,33 @@ auto save_scene_gltf(Scene_root& scene_root, const std::filesystem::path& path)
     // what makes the file a full scene save instead of an interchange export
     // (ERHE_scene in extensionsUsed is the erhe-authored marker).
     add_gltf_editor_state(export_arguments, scene_root, path);
-    const std::string gltf = erhe::gltf::export_gltf(export_arguments);
-    if (!erhe::file::write_file(path, gltf)) {
+    return erhe::gltf::make_gltf_export_snapshot(export_arguments);
+}
+
+auto save_scene_gltf(Scene_root& scene_root, const std::filesystem::path& path) -> bool
+{
+    const std::shared_ptr<erhe::gltf::Gltf_export_snapshot> snapshot = make_scene_gltf_snapshot(scene_root, path);
+    if (!snapshot) {
+        return false;
+    }
+    if (!erhe::gltf::write_gltf_export_snapshot(*snapshot, path)) {
         log_parsers->error("save_scene_gltf: failed to write '{}'", erhe::file::to_string(path));
         return false;
     }
     return true;
 }
 
-auto save_scene_gltf(App_context& context, Scene_root& scene_root, const std::filesystem::path& path) -> bool
+void finish_save_scene_gltf(
+    App_context&                       context,
+    Scene_root* const                  scene_root,
+    const std::filesystem::path&       path,
+    const std::optional<std::uint64_t> asset_edit_serial
+)
 {
-    if (!save_scene_gltf(scene_root, path)) {
-        return false;
-    }
     // R5.8: a successful save clears the scene's container record dirty flag
     // (the file now matches the live asset state).
-    if (context.asset_manager != nullptr) {
-        context.asset_manager->on_scene_saved(scene_root);
+    if ((context.asset_manager != nullptr) && (scene_root != nullptr)) {
+        context.asset_manager->on_scene_saved(*scene_root, asset_edit_serial);
     }
     // Rescan the asset browser so the freshly saved scene appears without a
     // manual Scan (#256).
@@ -1339,6 +1371,14 @@ auto save_scene_gltf(App_context& context, Scene_root& scene_root, const std::fi
             context.prefab_library->reload(canonical_path);
         }
     }
+}
+
+auto save_scene_gltf(App_context& context, Scene_root& scene_root, const std::filesystem::path& path) -> bool
+{
+    if (!save_scene_gltf(scene_root, path)) {
+        return false;
+    }
+    finish_save_scene_gltf(context, &scene_root, path);
     return true;
 }
 
@@ -1525,6 +1565,7 @@ auto open_scene_gltf(
             .path            = path,
             .parallel        = (context.editor_settings == nullptr) || context.editor_settings->load.parallel_gltf_parse,
             .fix_spot_lights = context.fix_gltf_spot_lights,
+            .compressed_image_cache = (context.editor_settings == nullptr) || context.editor_settings->load.compressed_texture_cache,
         };
         const std::chrono::steady_clock::time_point parse_start_time = std::chrono::steady_clock::now();
         parsed_gltf_data = erhe::gltf::parse_gltf(parse_arguments);
@@ -4,6 +4,7 @@
 #include "erhe_math/aabb.hpp"
 #include "erhe_scene_renderer/mesh_memory.hpp"
 
+#include <cstdint>
 #include <filesystem>
 #include <functional>
 #include <memory>
@@ -14,7 +15,7 @@
 namespace erhe {
     class Item_base;
 }
-namespace erhe::gltf      { class Gltf_data; class Gltf_image_source; class Image_transfer; }
+namespace erhe::gltf      { class Gltf_data; class Gltf_export_snapshot; class Gltf_image_source; class Image_transfer; }
 namespace erhe::graphics  { class Device; class Texture; }
 namespace erhe::primitive { class Build_info; }
 namespace erhe::scene     { class Animation; class Node; }
@@ -119,6 +120,15 @@ void import_gltf(
     erhe::scene_renderer::Mesh_memory_queue   queue = erhe::scene_renderer::Mesh_memory_queue::interactive
 ) -> erhe::primitive::Build_info;
 
+// The Build_info for skinned meshes, derived from a make_import_build_info()
+// result: same settings, but with buffer_info from
+// Mesh_memory::make_skinned_primitive_buffer_info() and without the index
+// ranges draw lists never use for skinned meshes.
+[[nodiscard]] auto make_skinned_import_build_info(
+    const erhe::primitive::Build_info& build_info,
+    const erhe::primitive::Buffer_info& skinned_buffer_info
+) -> erhe::primitive::Build_info;
+
 // Make freshly parsed glTF meshes renderable: build geometry edges +
 // smooth vertex normals, allocate GPU buffers in Mesh_memory (skinned
 // meshes get the skinned vertex format), and update raytrace primitives.
@@ -170,19 +180,46 @@ public:
 // a full Scene_root instead of imported as an asset.
 [[nodiscard]] auto is_erhe_scene(const std::vector<std::string>& extensions_used) -> bool;
 
-// Scene save (doc/gltf-scene-roundtrip-plan.md phase 4): one export_gltf()
-// call writing the whole scene state into a single glTF file - render
-// content plus physics data, prefab external-asset references, embedded
-// texture sources, animations, and every editor-domain ERHE_* extension
-// payload (add_gltf_editor_state). Binary .glb unless the path ends in
-// .gltf. Returns false when the scene has no root node or the write fails.
+// Scene save (doc/gltf-scene-roundtrip-plan.md phase 4): one export
+// writing the whole scene state into a single glTF file - render content
+// plus physics data, prefab external-asset references, embedded texture
+// sources, animations, and every editor-domain ERHE_* extension payload
+// (add_gltf_editor_state). Binary .glb unless the path ends in .gltf.
+// Returns false when the scene has no root node or the write fails; the
+// file is written to a temporary name and renamed over 'path', so a failed
+// save never leaves a truncated scene file behind.
 [[nodiscard]] auto save_scene_gltf(Scene_root& scene_root, const std::filesystem::path& path) -> bool;
 
-// THE scene save entry point (File > Save Scene, MCP save_scene): writes the
-// scene with save_scene_gltf() above, sends Scene_saved_message (asset
-// browser rescan), and, when 'path' is a loaded prefab source, reloads the
-// prefab so every instance in every scene reflects the edit (this replaced
-// the separate Save Prefab command).
+// The two halves of save_scene_gltf() for background saves (see
+// scene/scene_save_queue.hpp). make_scene_gltf_snapshot() reads the scene
+// and must run on the main thread; the snapshot it returns is written with
+// erhe::gltf::write_gltf_export_snapshot() on any thread. Returns nullptr
+// when the scene has no root node.
+[[nodiscard]] auto make_scene_gltf_snapshot(
+    Scene_root&                  scene_root,
+    const std::filesystem::path& path
+) -> std::shared_ptr<erhe::gltf::Gltf_export_snapshot>;
+
+// Main-thread side effects of a successful scene write: clears the scene's
+// asset container dirty flag unless the scene's assets were edited after
+// asset_edit_serial was taken (Asset_manager::get_scene_edit_serial(); the
+// file then no longer matches), sends Scene_saved_message and reloads the
+// prefab when 'path' is a loaded prefab source. scene_root may be null when
+// the scene was closed while its save was in flight.
+void finish_save_scene_gltf(
+    App_context&                 context,
+    Scene_root*                  scene_root,
+    const std::filesystem::path& path,
+    std::optional<std::uint64_t> asset_edit_serial = std::nullopt
+);
+
+// Synchronous scene save entry point (MCP save_scene, Asset_manager
+// save_container): writes the scene with save_scene_gltf() above, sends
+// Scene_saved_message (asset browser rescan), and, when 'path' is a loaded
+// prefab source, reloads the prefab so every instance in every scene
+// reflects the edit (this replaced the separate Save Prefab command).
+// File > Save Scene goes through Scene_save_queue instead, which does the
+// same without blocking the frame.
 [[nodiscard]] auto save_scene_gltf(
     App_context&                 context,
     Scene_root&                  scene_root,
@@ -96,9 +96,12 @@ void Composition_pass::render(const Render_context& context)
     };
     const Cpu_timer_scope cpu_timer_scope{*this};
 
-    m_last_scene_view_name       = context.scene_view.get_settings_key();
-    m_last_mesh_count            = 0;
-    m_last_draw_list_entry_count = 0;
+    m_last_scene_view_name        = context.scene_view.get_settings_key();
+    m_last_mesh_count             = 0;
+    m_last_draw_list_entry_count  = 0;
+    m_last_draw_list_culled_count = 0;
+    m_last_draw_list_lod_count    = 0;
+    m_last_draw_list_cluster_count = 0;
 
     if (!data.enabled) {
         m_last_result = Composition_pass_result::disabled;
@@ -378,9 +381,14 @@ void Composition_pass::render(const Render_context& context)
                         .debug_joint_colors    = context.app_context.app_rendering->debug_joint_colors,
                         .debug_target_joint    = debug_target_joint.get(),
                         .color_blend_override  = nullptr,
+                        .lod_max_pixel_error   = context.app_context.editor_settings->lod_max_pixel_error,
+                        .cluster_culling       = context.app_context.editor_settings->use_cluster_culling,
                     }
                 );
-                m_last_draw_list_entry_count = statistics.entry_count;
+                m_last_draw_list_entry_count  = statistics.entry_count;
+                m_last_draw_list_culled_count = statistics.culled_entry_count;
+                m_last_draw_list_lod_count    = statistics.lod_entry_count;
+                m_last_draw_list_cluster_count = statistics.cluster_draw_count;
                 m_last_result = Composition_pass_result::submitted_draw_lists;
                 return;
             }
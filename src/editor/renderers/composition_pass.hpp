@@ -147,6 +147,15 @@ public:
     // Entries drawn by the draw-list path in the most recent render() (0 when
     // the pass went through Forward_renderer::render()).
     [[nodiscard]] auto get_last_draw_list_entry_count() const -> std::size_t        { return m_last_draw_list_entry_count; }
+    // Entries the draw-list path skipped as outside every view frustum in
+    // the most recent render().
+    [[nodiscard]] auto get_last_draw_list_culled_count() const -> std::size_t       { return m_last_draw_list_culled_count; }
+    // Entries the draw-list path drew at a coarser level of detail in the
+    // most recent render().
+    [[nodiscard]] auto get_last_draw_list_lod_count() const -> std::size_t          { return m_last_draw_list_lod_count; }
+    // Meshlet draw commands the draw-list path emitted for cluster culled
+    // entries in the most recent render().
+    [[nodiscard]] auto get_last_draw_list_cluster_count() const -> std::size_t      { return m_last_draw_list_cluster_count; }
     // CPU wall time spent inside render() for the most recent call, and the
     // running total / call count since the last reset (P4 measurement:
     // doc/draw_list_renderer_requirements.md).
@@ -161,6 +170,9 @@ private:
     std::string                                                     m_last_scene_view_name{};
     std::size_t                                                     m_last_mesh_count{0};
     std::size_t                                                     m_last_draw_list_entry_count{0};
+    std::size_t                                                     m_last_draw_list_culled_count{0};
+    std::size_t                                                     m_last_draw_list_lod_count{0};
+    std::size_t                                                     m_last_draw_list_cluster_count{0};
     double                                                          m_last_cpu_time_us{0.0};
     double                                                          m_total_cpu_time_us{0.0};
     std::size_t                                                     m_render_call_count{0};
@@ -17,9 +17,9 @@
 #include "erhe_scene/mesh.hpp"
 #include "erhe_scene/node.hpp"
 #include "erhe_scene/scene.hpp"
+#include "erhe_scheduler/scheduler.hpp"
 
 #include <fmt/format.h>
-#include <taskflow/taskflow.hpp>
 
 #include <algorithm>
 #include <cmath>
@@ -295,8 +295,8 @@ void Lightmap_streamer::start_load(const int tile, const int slot)
         }
         pending->ready.store(true, std::memory_order_release);
     };
-    if (m_context.executor != nullptr) {
-        m_context.executor->silent_async(load);
+    if (m_context.scheduler != nullptr) {
+        m_context.scheduler->silent_async(erhe::scheduler::Lane::e_background, load);
     } else {
         load();
     }
@@ -4,6 +4,7 @@
 #include "app_rendering.hpp"
 #include "app_scenes.hpp"
 #include "app_settings.hpp"
+#include "config/generated/editor_settings_config.hpp"
 #include "content_library/content_library.hpp"
 #include "editor_log.hpp"
 #include "preview/brush_preview.hpp"
@@ -75,6 +76,9 @@ void prewarm_all(
     const uint32_t shadow_depth_bits = (context.app_settings != nullptr)
         ? static_cast<uint32_t>(context.app_settings->graphics.current_graphics_preset.shadow_depth_bits)
         : 0u;
+    // Clustered light path: selected per frame from the same setting
+    // (Editor::update), so the single view variants follow it.
+    const bool clustered_lights = (context.editor_settings != nullptr) && context.editor_settings->use_clustered_lights;
     // Light count limits: the runtime partitions lights with the preset's per
     // light type limits (Shadow_render_node); use the same limits here so the
     // prewarmed light-count variants match when a scene has more lights than
@@ -186,7 +190,8 @@ void prewarm_all(
                 .shadow_filter                 = shadow_filter,
                 .shadow_bias                   = shadow_bias,
                 .shadow_technique              = shadow_technique,
-                .shadow_depth_bits             = shadow_depth_bits
+                .shadow_depth_bits             = shadow_depth_bits,
+                .clustered_lights              = clustered_lights
             };
             forward_pipeline_warmups += context.forward_renderer->prewarm_standard_variants(params);
         }
@@ -1416,7 +1416,7 @@ auto Scene_root::get_draw_list_scene() -> erhe::scene_renderer::Draw_list_scene*
     return m_draw_list_scene.get();
 }
 
-void Scene_root::flush_draw_lists()
+void Scene_root::flush_draw_lists(erhe::graphics::Command_buffer& command_buffer)
 {
     if (!m_draw_list_scene) {
         return;
@@ -1428,6 +1428,7 @@ void Scene_root::flush_draw_lists()
     // registration reads. Lock order: item_host_mutex -> pending mutex.
     const std::lock_guard<ERHE_PROFILE_LOCKABLE_BASE(std::mutex)> lock{item_host_mutex};
     m_draw_list_scene->flush_pending();
+    m_draw_list_scene->update_resident_records(command_buffer);
 }
 
 void Scene_root::register_node_physics(const std::shared_ptr<Node_physics>& node_physics)
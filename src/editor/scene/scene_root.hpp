@@ -29,6 +29,7 @@ namespace erhe::geometry {
 namespace erhe::graphics {
     class Buffer;
     class Buffer_transfer_queue;
+    class Command_buffer;
     class Vertex_format;
 }
 namespace erhe::imgui {
@@ -190,8 +191,9 @@ public:
     [[nodiscard]] auto get_draw_list_scene() -> erhe::scene_renderer::Draw_list_scene*;
     // Main thread, once per frame before any rendering of this scene:
     // applies queued register / unregister / flag changes under
-    // item_host_mutex. No-op without a Draw_list_scene.
-    void flush_draw_lists();
+    // item_host_mutex, then records the resident record uploads of static
+    // draw lists into command_buffer. No-op without a Draw_list_scene.
+    void flush_draw_lists(erhe::graphics::Command_buffer& command_buffer);
     auto get_hosted_scene () -> erhe::scene::Scene* override;
 
     void begin_mesh_rt_update(const std::shared_ptr<erhe::scene::Mesh>& mesh);
@@ -0,0 +1,152 @@
+#include "scene/scene_save_queue.hpp"
+
+#include "app_context.hpp"
+#include "assets/asset_manager.hpp"
+#include "editor_log.hpp"
+#include "parsers/gltf.hpp"
+#include "scene/scene_commit_queue.hpp"
+#include "scene/scene_root.hpp"
+
+#include "erhe_file/file.hpp"
+#include "erhe_gltf/gltf.hpp"
+#include "erhe_profile/profile.hpp"
+#include "erhe_scheduler/scheduler.hpp"
+#include "erhe_verify/verify.hpp"
+
+#include <taskflow/taskflow.hpp>
+
+#include <algorithm>
+#include <exception>
+#include <optional>
+
+namespace editor {
+
+Scene_save_queue::Scene_save_queue(App_context& context)
+    : m_context{context}
+{
+}
+
+Scene_save_queue::~Scene_save_queue() noexcept = default;
+
+auto Scene_save_queue::save(
+    const std::shared_ptr<Scene_root>& scene_root,
+    const std::filesystem::path&       path,
+    Done_callback                      on_done
+) -> std::shared_ptr<Save_state>
+{
+    ERHE_PROFILE_FUNCTION();
+
+    ERHE_VERIFY(scene_root);
+    const std::shared_ptr<erhe::gltf::Gltf_export_snapshot> snapshot = make_scene_gltf_snapshot(*scene_root, path);
+    if (!snapshot) {
+        return {};
+    }
+    // Taken with the snapshot: asset edits after this point are not in the
+    // file, and keep the scene's container record dirty.
+    const std::optional<std::uint64_t> asset_edit_serial = (m_context.asset_manager != nullptr)
+        ? m_context.asset_manager->get_scene_edit_serial(*scene_root)
+        : std::nullopt;
+
+    // Weak: a save in flight must not keep a closed scene alive.
+    return write(
+        snapshot,
+        path,
+        [&context = m_context, weak_scene_root = std::weak_ptr<Scene_root>{scene_root}, path, asset_edit_serial, on_done = std::move(on_done)](const bool ok) {
+            if (ok) {
+                const std::shared_ptr<Scene_root> scene_root = weak_scene_root.lock();
+                finish_save_scene_gltf(context, scene_root.get(), path, asset_edit_serial);
+            }
+            if (on_done) {
+                on_done(ok);
+            }
+        }
+    );
+}
+
+auto Scene_save_queue::write(
+    const std::shared_ptr<erhe::gltf::Gltf_export_snapshot>& snapshot,
+    const std::filesystem::path&                             path,
+    Done_callback                                            on_done
+) -> std::shared_ptr<Save_state>
+{
+    ERHE_VERIFY(snapshot);
+    ERHE_VERIFY(m_context.executor != nullptr);
+    ERHE_VERIFY(m_context.scene_commit_queue != nullptr);
+
+    if (m_last_write && m_last_write->is_done()) {
+        m_last_write.reset();
+    }
+
+    std::shared_ptr<Save_state> state = std::make_shared<Save_state>();
+    state->path = path;
+    m_in_flight.push_back(state);
+
+    std::vector<tf::AsyncTask> dependencies;
+    if (m_last_write) {
+        dependencies.push_back(*m_last_write);
+    }
+
+    App_context& context = m_context;
+    ++context.pending_async_ops;
+    tf::AsyncTask task = context.executor->silent_dependent_async(
+        // Non-const copy of the snapshot pointer, so the task can release it
+        [this, &context, snapshot = std::shared_ptr<erhe::gltf::Gltf_export_snapshot>{snapshot}, state, on_done = std::move(on_done)]() mutable {
+            ++context.running_async_ops;
+            bool ok = false;
+            // Chained writes need a dependent task, which lanes do not
+            // offer; the write is still accounted as background work.
+            const erhe::scheduler::Lane_timer lane_timer{context.scheduler, erhe::scheduler::Lane::e_background};
+            try {
+                ok = erhe::gltf::write_gltf_export_snapshot(
+                    *snapshot,
+                    state->path,
+                    [&state](const std::size_t bytes_written, const std::size_t byte_count) {
+                        state->byte_count   .store(byte_count,    std::memory_order_relaxed);
+                        state->bytes_written.store(bytes_written, std::memory_order_relaxed);
+                    }
+                );
+            } catch (const std::exception& e) {
+                log_scene->error("Saving '{}' failed: {}", erhe::file::to_string(state->path), e.what());
+            } catch (...) {
+                log_scene->error("Saving '{}' failed: unknown exception", erhe::file::to_string(state->path));
+            }
+            // The task handle may outlive the write (m_last_write); drop the
+            // snapshot now instead of with the handle.
+            snapshot.reset();
+            if (!ok) {
+                log_scene->error("Saving '{}' failed", erhe::file::to_string(state->path));
+            }
+            state->ok.store(ok);
+            state->finished.store(true);
+            context.scene_commit_queue->enqueue(
+                [this, state, on_done = std::move(on_done)]() {
+                    std::erase(m_in_flight, state);
+                    if (m_last_write && m_last_write->is_done()) {
+                        m_last_write.reset();
+                    }
+                    if (on_done) {
+                        on_done(state->ok.load());
+                    }
+                }
+            );
+            --context.running_async_ops;
+            --context.pending_async_ops;
+        },
+        dependencies.begin(), dependencies.end()
+    );
+    m_last_write = std::make_unique<tf::AsyncTask>(std::move(task));
+    return state;
+}
+
+auto Scene_save_queue::get_in_flight() const -> const std::vector<std::shared_ptr<Save_state>>&
+{
+    return m_in_flight;
+}
+
+void Scene_save_queue::clear()
+{
+    m_last_write.reset();
+    m_in_flight.clear();
+}
+
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace erhe::gltf { class Gltf_export_snapshot; }
+namespace tf         { class AsyncTask; }
+
+namespace editor {
+
+class App_context;
+class Scene_root;
+
+// Background glTF writes for scene saves and exports.
+//
+// A save is split where the scene stops being read: save() takes the
+// export snapshot on the calling (main) thread - the exporter passes that
+// read nodes, meshes, geometry and materials - and hands the snapshot to a
+// tf::Executor worker, which serializes it and streams it to a temporary
+// file next to the destination that is renamed over it when complete
+// (erhe::gltf::write_gltf_export_snapshot()). The frame only pays for the
+// snapshot; edits made meanwhile land in the next save. The completion
+// (asset dirty state, Scene_saved_message, prefab reload, on_done) is
+// applied on the main thread through the Scene_commit_queue.
+//
+// Writes run one at a time in submission order, so a later save of the
+// same file always wins. Main thread only, except for the Save_state
+// counters, which the writer updates while the main thread polls them.
+class Scene_save_queue
+{
+public:
+    class Save_state
+    {
+    public:
+        std::filesystem::path    path;
+        std::atomic<std::size_t> bytes_written{0};
+        std::atomic<std::size_t> byte_count   {0};
+        std::atomic<bool>        finished     {false};
+        std::atomic<bool>        ok           {false};
+    };
+
+    // Main thread, with the write result.
+    using Done_callback = std::function<void(bool ok)>;
+
+    explicit Scene_save_queue(App_context& context);
+    ~Scene_save_queue() noexcept;
+
+    Scene_save_queue(const Scene_save_queue&) = delete;
+    Scene_save_queue& operator=(const Scene_save_queue&) = delete;
+
+    // Scene save (see save_scene_gltf()). Returns nullptr, without calling
+    // on_done, when the scene cannot be snapshotted.
+    auto save(
+        const std::shared_ptr<Scene_root>& scene_root,
+        const std::filesystem::path&       path,
+        Done_callback                      on_done = {}
+    ) -> std::shared_ptr<Save_state>;
+
+    // Writes an already taken snapshot (e.g. a plain glTF export).
+    auto write(
+        const std::shared_ptr<erhe::gltf::Gltf_export_snapshot>& snapshot,
+        const std::filesystem::path&                             path,
+        Done_callback                                            on_done = {}
+    ) -> std::shared_ptr<Save_state>;
+
+    // Saves submitted and not yet completed, oldest first (progress display).
+    [[nodiscard]] auto get_in_flight() const -> const std::vector<std::shared_ptr<Save_state>>&;
+
+    // Shutdown, after the executor has drained: drops the task handle.
+    void clear();
+
+private:
+    App_context&                             m_context;
+    std::vector<std::shared_ptr<Save_state>> m_in_flight;
+    // Last submitted write; the next one depends on it. Released once done,
+    // so a completed write does not pin its snapshot (see items.cpp).
+    std::unique_ptr<tf::AsyncTask>           m_last_write;
+};
+
+}
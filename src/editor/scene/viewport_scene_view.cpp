@@ -157,7 +157,13 @@ Viewport_scene_view::Viewport_scene_view(
             // Store depth/stencil so the post-processing overlay pass can load
             // the same attachment and depth-test the tool / rendertarget meshes
             // against the content (issue #230).
-            .store_depth_stencil  = enable_post_processing
+            .store_depth_stencil  = enable_post_processing,
+            // With post processing the output is only read through the graph
+            // (Post_processing_node, then the forwarding overlay and ImGui
+            // host), so the textures can come from the transient pool: the
+            // multisampled color of several viewports is live only while each
+            // one renders and is shared between them.
+            .transient            = enable_post_processing
         }
     }
     , m_name           {name}
@@ -645,6 +651,12 @@ void Viewport_scene_view::execute_rendergraph_node(erhe::graphics::Command_buffe
 
     ERHE_VERIFY(m_render_target.get_render_pass());
 
+    // Text_renderer uploads glyphs rasterized since its last upload. Text
+    // drawn inline in this pass gets glyphs it prints for the first time
+    // one frame later; the post-processing path draws text in the overlay
+    // pass, which uploads again before it starts.
+    m_context.text_renderer->upload_glyphs(command_buffer);
+
     erhe::graphics::Render_command_encoder encoder = graphics_device.make_render_command_encoder(command_buffer);
     erhe::graphics::Scoped_render_pass scoped_render_pass{*m_render_target.get_render_pass(), command_buffer};
     context.encoder     = &encoder;
@@ -839,6 +851,12 @@ void Viewport_scene_view::render_overlay_pass(
         return;
     }
 
+    // Glyphs first printed during this view's content pass: the text is
+    // drawn in this pass, so they show up in the same frame.
+    if (m_debug_renderer_frame_pending) {
+        m_context.text_renderer->upload_glyphs(command_buffer);
+    }
+
     erhe::graphics::Device&                 graphics_device = m_rendergraph.get_graphics_device();
     erhe::graphics::Render_command_encoder  encoder         = graphics_device.make_render_command_encoder(command_buffer);
     erhe::graphics::Scoped_render_pass      scoped_render_pass{*m_overlay_render_pass, command_buffer};
@@ -0,0 +1,55 @@
+#include "windows/scheduler_lane_plots.hpp"
+
+#include <algorithm>
+
+namespace editor {
+
+Scheduler_lane_plots::Lane_plot::Lane_plot(
+    erhe::scheduler::Scheduler& scheduler,
+    const erhe::scheduler::Lane lane,
+    const char*                 label
+)
+    : m_scheduler{scheduler}
+    , m_lane     {lane}
+    , m_label    {label}
+{
+    m_values.resize(256);
+    m_max_great       = 4.0f;
+    m_max_ok          = 16.0f;
+    m_scale_max_limit = 4.0f;
+}
+
+void Scheduler_lane_plots::Lane_plot::sample()
+{
+    const erhe::scheduler::Lane_statistics& statistics = m_scheduler.get_frame_statistics().lanes[static_cast<std::size_t>(m_lane)];
+    m_values[m_offset % m_values.size()] = static_cast<float>(static_cast<double>(statistics.busy_ns) / 1'000'000.0);
+    m_value_count = std::min(m_value_count + 1, m_values.size());
+    m_offset++;
+}
+
+auto Scheduler_lane_plots::Lane_plot::label() const -> const char*
+{
+    return m_label;
+}
+
+Scheduler_lane_plots::Scheduler_lane_plots(erhe::imgui::Performance_window& performance_window, erhe::scheduler::Scheduler& scheduler)
+    : m_performance_window{performance_window}
+    , m_plots{
+        Lane_plot{scheduler, erhe::scheduler::Lane::e_frame,       "Workers: frame lane"},
+        Lane_plot{scheduler, erhe::scheduler::Lane::e_interactive, "Workers: interactive lane"},
+        Lane_plot{scheduler, erhe::scheduler::Lane::e_background,  "Workers: background lane"}
+    }
+{
+    for (Lane_plot& plot : m_plots) {
+        m_performance_window.register_plot(&plot);
+    }
+}
+
+Scheduler_lane_plots::~Scheduler_lane_plots() noexcept
+{
+    for (Lane_plot& plot : m_plots) {
+        m_performance_window.unregister_plot(&plot);
+    }
+}
+
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "erhe_imgui/windows/performance_window.hpp"
+#include "erhe_scheduler/scheduler.hpp"
+
+#include <array>
+
+namespace editor {
+
+// Worker time per erhe::scheduler lane in the Performance window: summed
+// run time of the jobs each lane finished in the last frame
+// (Scheduler::get_frame_statistics(), published by Editor::tick()).
+// Physics jobs show up in the frame lane, asset loads and saves in the
+// background lane.
+class Scheduler_lane_plots
+{
+public:
+    Scheduler_lane_plots(erhe::imgui::Performance_window& performance_window, erhe::scheduler::Scheduler& scheduler);
+    ~Scheduler_lane_plots() noexcept;
+
+private:
+    class Lane_plot : public erhe::imgui::Plot
+    {
+    public:
+        Lane_plot(erhe::scheduler::Scheduler& scheduler, erhe::scheduler::Lane lane, const char* label);
+
+        void sample() override;
+        auto label() const -> const char* override;
+
+    private:
+        erhe::scheduler::Scheduler& m_scheduler;
+        erhe::scheduler::Lane       m_lane;
+        const char*                 m_label;
+    };
+
+    erhe::imgui::Performance_window&                        m_performance_window;
+    std::array<Lane_plot, erhe::scheduler::c_lane_count>    m_plots;
+};
+
+}
@@ -54,6 +54,7 @@
 #include "config/generated/threading_config_serialization.hpp"
 #include "config/generated/thumbnails_config_serialization.hpp"
 #include "config/generated/transform_tool_config_serialization.hpp"
+#include "config/generated/undo_history_config_serialization.hpp"
 #include "config/generated/viewport_config_data_serialization.hpp"
 #include "config/generated/window_config_serialization.hpp"
 #include "erhe_graphics/generated/graphics_config_serialization.hpp"
@@ -594,6 +595,15 @@ void Settings_window::imgui()
         add_entry("Draw Lists", [&settings](){
             ImGui::Checkbox("##", &settings.use_draw_lists);
         }, "Render content fill and shadow maps through persistent per-scene draw lists (doc/draw_list_renderer_requirements.md). Off = classic per-pass bucketing.");
+        add_entry("LOD Pixel Error", [&settings](){
+            ImGui::DragFloat("##", &settings.lod_max_pixel_error, 0.05f, 0.0f, 16.0f, "%.2f");
+        }, "Draw lists pick the coarsest level of detail whose error is at most this many pixels on screen. 0 = always full detail.");
+        add_entry("Cluster Culling", [&settings](){
+            ImGui::Checkbox("##", &settings.use_cluster_culling);
+        }, "Draw lists cull the meshlets of large meshes against the view frustum and their normal cones, and draw one command per visible meshlet.");
+        add_entry("Clustered Lights", [&settings](){
+            ImGui::Checkbox("##", &settings.use_clustered_lights);
+        }, "Non-shadow spot and point lights are binned into view space clusters on the CPU and each fragment shades only the lights of its cluster. Needs shader storage buffers; XR multiview passes always loop over all lights.");
         add_entry("Exclude Unlit Primitives", [&settings](){
             ImGui::Checkbox("##", &settings.exclude_unlit_primitives);
         }, "Unlit (KHR_materials_unlit) primitives - sky domes, backdrops, emissive decals - do not cast shadows and are ignored when framing the camera on scene open. They still count toward the camera far plane.");
@@ -654,6 +664,7 @@ void Settings_window::imgui()
         add_config_section(settings.sky);
         add_config_section(settings.thumbnails);
         add_config_section(settings.transform_tool);
+        add_config_section(settings.undo_history);
 
         add_entry("", [this, button_size, &settings](){
             if (ImGui::Button("Save Settings", button_size)) {
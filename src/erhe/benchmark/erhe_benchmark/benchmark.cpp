@@ -0,0 +1,23 @@
+#include "erhe_benchmark/benchmark.hpp"
+
+namespace erhe::benchmark {
+
+Stopwatch::Stopwatch()
+    : m_start{std::chrono::steady_clock::now()}
+{
+}
+
+auto Stopwatch::lap_ms() -> double
+{
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    const double ms = std::chrono::duration<double, std::milli>(now - m_start).count();
+    m_start = now;
+    return ms;
+}
+
+auto Stopwatch::elapsed_ms() const -> double
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_start).count();
+}
+
+} // namespace erhe::benchmark
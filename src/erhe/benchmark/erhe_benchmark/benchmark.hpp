@@ -0,0 +1,43 @@
+#pragma once
+
+#include <chrono>
+
+// Microbenchmarks live with the unit tests of the library they measure. A
+// benchmark is registered as the disabled test suite.DISABLED_benchmark_name,
+// so the regular test run skips it; run benchmarks explicitly (Release
+// build, no profiler) with:
+//
+//   <library>_tests --gtest_also_run_disabled_tests --gtest_filter=*benchmark*
+//
+// The file using ERHE_BENCHMARK() includes <gtest/gtest.h> itself.
+#define ERHE_BENCHMARK(suite, name) TEST(suite, DISABLED_benchmark_ ## name)
+
+namespace erhe::benchmark {
+
+// Wall clock time of benchmark phases
+class Stopwatch
+{
+public:
+    Stopwatch();
+
+    // Milliseconds since construction or the previous lap_ms() call; starts
+    // the next lap
+    [[nodiscard]] auto lap_ms() -> double;
+
+    // Milliseconds since construction or the previous lap_ms() call
+    [[nodiscard]] auto elapsed_ms() const -> double;
+
+private:
+    std::chrono::steady_clock::time_point m_start;
+};
+
+// Milliseconds spent in function()
+template <typename Function>
+[[nodiscard]] auto time_ms(const Function& function) -> double
+{
+    const Stopwatch stopwatch;
+    function();
+    return stopwatch.elapsed_ms();
+}
+
+} // namespace erhe::benchmark
@@ -0,0 +1,343 @@
+#include "erhe_dataformat/vertex_column.hpp"
+#include "erhe_verify/verify.hpp"
+
+#include <glm/gtc/packing.hpp>
+
+#include <cstring>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#   define ERHE_DATAFORMAT_COLUMN_SSE2 1
+#   include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#   define ERHE_DATAFORMAT_COLUMN_NEON 1
+#   include <arm_neon.h>
+#endif
+
+namespace erhe::dataformat {
+
+namespace {
+
+enum class Float_target : unsigned int {
+    float32,
+    float16,
+    unorm8,
+    snorm8,
+    unorm16,
+    snorm16
+};
+
+class Column_format
+{
+public:
+    bool         valid          {false};
+    Float_target float_target   {Float_target::float32}; // convert_float_column()
+    std::size_t  component_size {0};                     // bytes; convert_uint_column()
+    std::size_t  component_count{0};
+};
+
+[[nodiscard]] auto get_float_column_format(const Format format) -> Column_format
+{
+    switch (format) {
+        case Format::format_32_scalar_float: return Column_format{true, Float_target::float32, 4, 1};
+        case Format::format_32_vec2_float:   return Column_format{true, Float_target::float32, 4, 2};
+        case Format::format_32_vec3_float:   return Column_format{true, Float_target::float32, 4, 3};
+        case Format::format_32_vec4_float:   return Column_format{true, Float_target::float32, 4, 4};
+        case Format::format_16_scalar_float: return Column_format{true, Float_target::float16, 2, 1};
+        case Format::format_16_vec2_float:   return Column_format{true, Float_target::float16, 2, 2};
+        case Format::format_16_vec3_float:   return Column_format{true, Float_target::float16, 2, 3};
+        case Format::format_16_vec4_float:   return Column_format{true, Float_target::float16, 2, 4};
+        case Format::format_8_scalar_unorm:  return Column_format{true, Float_target::unorm8,  1, 1};
+        case Format::format_8_vec2_unorm:    return Column_format{true, Float_target::unorm8,  1, 2};
+        case Format::format_8_vec3_unorm:    return Column_format{true, Float_target::unorm8,  1, 3};
+        case Format::format_8_vec4_unorm:    return Column_format{true, Float_target::unorm8,  1, 4};
+        case Format::format_8_scalar_snorm:  return Column_format{true, Float_target::snorm8,  1, 1};
+        case Format::format_8_vec2_snorm:    return Column_format{true, Float_target::snorm8,  1, 2};
+        case Format::format_8_vec3_snorm:    return Column_format{true, Float_target::snorm8,  1, 3};
+        case Format::format_8_vec4_snorm:    return Column_format{true, Float_target::snorm8,  1, 4};
+        case Format::format_16_scalar_unorm: return Column_format{true, Float_target::unorm16, 2, 1};
+        case Format::format_16_vec2_unorm:   return Column_format{true, Float_target::unorm16, 2, 2};
+        case Format::format_16_vec3_unorm:   return Column_format{true, Float_target::unorm16, 2, 3};
+        case Format::format_16_vec4_unorm:   return Column_format{true, Float_target::unorm16, 2, 4};
+        case Format::format_16_scalar_snorm: return Column_format{true, Float_target::snorm16, 2, 1};
+        case Format::format_16_vec2_snorm:   return Column_format{true, Float_target::snorm16, 2, 2};
+        case Format::format_16_vec3_snorm:   return Column_format{true, Float_target::snorm16, 2, 3};
+        case Format::format_16_vec4_snorm:   return Column_format{true, Float_target::snorm16, 2, 4};
+        default:                             return Column_format{};
+    }
+}
+
+[[nodiscard]] auto get_uint_column_format(const Format format) -> Column_format
+{
+    switch (format) {
+        case Format::format_8_scalar_uint:  return Column_format{true, Float_target::float32, 1, 1};
+        case Format::format_8_vec2_uint:    return Column_format{true, Float_target::float32, 1, 2};
+        case Format::format_8_vec3_uint:    return Column_format{true, Float_target::float32, 1, 3};
+        case Format::format_8_vec4_uint:    return Column_format{true, Float_target::float32, 1, 4};
+        case Format::format_16_scalar_uint: return Column_format{true, Float_target::float32, 2, 1};
+        case Format::format_16_vec2_uint:   return Column_format{true, Float_target::float32, 2, 2};
+        case Format::format_16_vec3_uint:   return Column_format{true, Float_target::float32, 2, 3};
+        case Format::format_16_vec4_uint:   return Column_format{true, Float_target::float32, 2, 4};
+        case Format::format_32_scalar_uint: return Column_format{true, Float_target::float32, 4, 1};
+        case Format::format_32_vec2_uint:   return Column_format{true, Float_target::float32, 4, 2};
+        case Format::format_32_vec3_uint:   return Column_format{true, Float_target::float32, 4, 3};
+        case Format::format_32_vec4_uint:   return Column_format{true, Float_target::float32, 4, 4};
+        default:                            return Column_format{};
+    }
+}
+
+#if defined(ERHE_DATAFORMAT_COLUMN_SSE2)
+
+// N floats into the low lanes, zero above. Reading a whole vector is safe
+// when another value follows in the column (stride >= N floats).
+template <std::size_t N>
+[[nodiscard]] inline auto load_value(const float* value, const bool last) -> __m128
+{
+    if constexpr (N == 4) {
+        return _mm_loadu_ps(value);
+    } else if constexpr (N == 1) {
+        return _mm_load_ss(value);
+    } else if constexpr (N == 2) {
+        return _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(value)));
+    } else {
+        if (!last) {
+            return _mm_and_ps(_mm_loadu_ps(value), _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0)));
+        }
+        return _mm_setr_ps(value[0], value[1], value[2], 0.0f);
+    }
+}
+
+// Same arithmetic as float_to_unorm8() / float_to_snorm8() /
+// float_to_unorm16() / float_to_snorm16(), four components at a time.
+template <Float_target Target, std::size_t N>
+inline void convert_normalized(const float* value, const bool last, std::uint8_t* out)
+{
+    const __m128 v    = load_value<N>(value, last);
+    const __m128 zero = _mm_setzero_ps();
+    __m128i packed;
+    if constexpr ((Target == Float_target::unorm8) || (Target == Float_target::unorm16)) {
+        const float  scale = (Target == Float_target::unorm8) ? 255.0f : 65535.0f;
+        const __m128 a     = _mm_add_ps(_mm_mul_ps(v, _mm_set1_ps(scale)), _mm_set1_ps(0.5f));
+        const __m128 c     = _mm_min_ps(_mm_max_ps(a, zero), _mm_set1_ps(scale));
+        const __m128i i32  = _mm_cvttps_epi32(c);
+        if constexpr (Target == Float_target::unorm8) {
+            const __m128i i16 = _mm_packs_epi32(i32, i32);
+            packed = _mm_packus_epi16(i16, i16);
+        } else {
+            // No unsigned 32 -> 16 saturating pack in SSE2: bias into the
+            // signed range, pack, flip the top bit back.
+            const __m128i biased = _mm_sub_epi32(i32, _mm_set1_epi32(32768));
+            packed = _mm_xor_si128(_mm_packs_epi32(biased, biased), _mm_set1_epi16(static_cast<short>(0x8000)));
+        }
+    } else {
+        const float   scale        = (Target == Float_target::snorm8) ? 127.0f : 32767.0f;
+        const float   low          = (Target == Float_target::snorm8) ? -128.0f : -32768.0f;
+        const __m128  non_negative = _mm_cmpge_ps(v, zero);
+        const __m128  half         = _mm_or_ps(_mm_and_ps(non_negative, _mm_set1_ps(0.5f)), _mm_andnot_ps(non_negative, _mm_set1_ps(-0.5f)));
+        const __m128  a            = _mm_add_ps(_mm_mul_ps(v, _mm_set1_ps(scale)), half);
+        const __m128  c            = _mm_min_ps(_mm_max_ps(a, _mm_set1_ps(low)), _mm_set1_ps(scale));
+        const __m128i i32          = _mm_cvttps_epi32(c);
+        const __m128i i16          = _mm_packs_epi32(i32, i32);
+        packed = (Target == Float_target::snorm8) ? _mm_packs_epi16(i16, i16) : i16;
+    }
+    constexpr std::size_t component_size = ((Target == Float_target::unorm8) || (Target == Float_target::snorm8)) ? 1 : 2;
+    alignas(16) std::uint8_t lanes[16];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), packed);
+    std::memcpy(out, lanes, N * component_size);
+}
+
+#elif defined(ERHE_DATAFORMAT_COLUMN_NEON)
+
+template <Float_target Target, std::size_t N>
+inline void convert_normalized(const float* value, bool, std::uint8_t* out)
+{
+    float lanes_in[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    std::memcpy(lanes_in, value, N * sizeof(float));
+    const float32x4_t v    = vld1q_f32(lanes_in);
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    if constexpr ((Target == Float_target::unorm8) || (Target == Float_target::unorm16)) {
+        const float       scale = (Target == Float_target::unorm8) ? 255.0f : 65535.0f;
+        const float32x4_t a     = vaddq_f32(vmulq_n_f32(v, scale), vdupq_n_f32(0.5f));
+        const float32x4_t c     = vminq_f32(vmaxq_f32(a, zero), vdupq_n_f32(scale));
+        const int32x4_t   i32   = vcvtq_s32_f32(c);
+        if constexpr (Target == Float_target::unorm8) {
+            const int16x4_t i16 = vqmovn_s32(i32);
+            uint8_t lanes[8];
+            vst1_u8(lanes, vqmovun_s16(vcombine_s16(i16, i16)));
+            std::memcpy(out, lanes, N);
+        } else {
+            uint16_t lanes[4];
+            vst1_u16(lanes, vqmovun_s32(i32));
+            std::memcpy(out, lanes, N * 2);
+        }
+    } else {
+        const float       scale        = (Target == Float_target::snorm8) ? 127.0f : 32767.0f;
+        const float       low          = (Target == Float_target::snorm8) ? -128.0f : -32768.0f;
+        const uint32x4_t  non_negative = vcgeq_f32(v, zero);
+        const float32x4_t half         = vbslq_f32(non_negative, vdupq_n_f32(0.5f), vdupq_n_f32(-0.5f));
+        const float32x4_t a            = vaddq_f32(vmulq_n_f32(v, scale), half);
+        const float32x4_t c            = vminq_f32(vmaxq_f32(a, vdupq_n_f32(low)), vdupq_n_f32(scale));
+        const int16x4_t   i16          = vqmovn_s32(vcvtq_s32_f32(c));
+        if constexpr (Target == Float_target::snorm8) {
+            int8_t lanes[8];
+            vst1_s8(lanes, vqmovn_s16(vcombine_s16(i16, i16)));
+            std::memcpy(out, lanes, N);
+        } else {
+            int16_t lanes[4];
+            vst1_s16(lanes, i16);
+            std::memcpy(out, lanes, N * 2);
+        }
+    }
+}
+
+#else
+
+template <Float_target Target, std::size_t N>
+inline void convert_normalized(const float* value, bool, std::uint8_t* out)
+{
+    for (std::size_t c = 0; c < N; ++c) {
+        if constexpr (Target == Float_target::unorm8) {
+            out[c] = float_to_unorm8(value[c]);
+        } else if constexpr (Target == Float_target::snorm8) {
+            const int8_t s = float_to_snorm8(value[c]);
+            std::memcpy(out + c, &s, 1);
+        } else if constexpr (Target == Float_target::unorm16) {
+            const uint16_t u = float_to_unorm16(value[c]);
+            std::memcpy(out + 2 * c, &u, 2);
+        } else {
+            const int16_t s = float_to_snorm16(value[c]);
+            std::memcpy(out + 2 * c, &s, 2);
+        }
+    }
+}
+
+#endif
+
+template <Float_target Target, std::size_t N>
+void convert_float_values(
+    const float*        src,
+    const std::size_t   src_stride,
+    std::uint8_t* const dst,
+    const std::size_t   dst_stride,
+    const std::size_t   count
+)
+{
+    const std::uint8_t* const src_bytes = reinterpret_cast<const std::uint8_t*>(src);
+    for (std::size_t i = 0; i < count; ++i) {
+        const float*  value = reinterpret_cast<const float*>(src_bytes + i * src_stride);
+        std::uint8_t* out   = dst + i * dst_stride;
+        if constexpr (Target == Float_target::float32) {
+            std::memcpy(out, value, N * sizeof(float));
+        } else if constexpr (Target == Float_target::float16) {
+            for (std::size_t c = 0; c < N; ++c) {
+                const uint16_t h = glm::packHalf1x16(value[c]);
+                std::memcpy(out + 2 * c, &h, 2);
+            }
+        } else {
+            convert_normalized<Target, N>(value, (i + 1) == count, out);
+        }
+    }
+}
+
+template <Float_target Target>
+void convert_float_values(
+    const std::size_t   component_count,
+    const float*        src,
+    const std::size_t   src_stride,
+    std::uint8_t* const dst,
+    const std::size_t   dst_stride,
+    const std::size_t   count
+)
+{
+    switch (component_count) {
+        case 1: convert_float_values<Target, 1>(src, src_stride, dst, dst_stride, count); break;
+        case 2: convert_float_values<Target, 2>(src, src_stride, dst, dst_stride, count); break;
+        case 3: convert_float_values<Target, 3>(src, src_stride, dst, dst_stride, count); break;
+        case 4: convert_float_values<Target, 4>(src, src_stride, dst, dst_stride, count); break;
+        default: ERHE_FATAL("bad component count"); break;
+    }
+}
+
+template <typename T>
+void convert_uint_values(
+    const std::uint32_t* src,
+    const std::size_t    src_stride,
+    const std::size_t    component_count,
+    std::uint8_t* const  dst,
+    const std::size_t    dst_stride,
+    const std::size_t    count
+)
+{
+    const std::uint8_t* const src_bytes = reinterpret_cast<const std::uint8_t*>(src);
+    for (std::size_t i = 0; i < count; ++i) {
+        const std::uint32_t* value = reinterpret_cast<const std::uint32_t*>(src_bytes + i * src_stride);
+        std::uint8_t*        out   = dst + i * dst_stride;
+        for (std::size_t c = 0; c < component_count; ++c) {
+            ERHE_VERIFY(value[c] <= std::numeric_limits<T>::max());
+            const T narrowed = static_cast<T>(value[c]);
+            std::memcpy(out + c * sizeof(T), &narrowed, sizeof(T));
+        }
+    }
+}
+
+} // anonymous namespace
+
+auto convert_float_column(
+    const float*        src,
+    const std::size_t   src_stride,
+    const std::size_t   component_count,
+    std::uint8_t* const dst,
+    const std::size_t   dst_stride,
+    const Format        format,
+    const std::size_t   count
+) -> bool
+{
+    const Column_format column_format = get_float_column_format(format);
+    if (!column_format.valid || (column_format.component_count != component_count)) {
+        return false;
+    }
+    if (count == 0) {
+        return true;
+    }
+    ERHE_VERIFY((src != nullptr) && (dst != nullptr));
+    ERHE_VERIFY(src_stride >= component_count * sizeof(float));
+    switch (column_format.float_target) {
+        case Float_target::float32: convert_float_values<Float_target::float32>(component_count, src, src_stride, dst, dst_stride, count); break;
+        case Float_target::float16: convert_float_values<Float_target::float16>(component_count, src, src_stride, dst, dst_stride, count); break;
+        case Float_target::unorm8:  convert_float_values<Float_target::unorm8 >(component_count, src, src_stride, dst, dst_stride, count); break;
+        case Float_target::snorm8:  convert_float_values<Float_target::snorm8 >(component_count, src, src_stride, dst, dst_stride, count); break;
+        case Float_target::unorm16: convert_float_values<Float_target::unorm16>(component_count, src, src_stride, dst, dst_stride, count); break;
+        case Float_target::snorm16: convert_float_values<Float_target::snorm16>(component_count, src, src_stride, dst, dst_stride, count); break;
+    }
+    return true;
+}
+
+auto convert_uint_column(
+    const std::uint32_t* src,
+    const std::size_t    src_stride,
+    const std::size_t    component_count,
+    std::uint8_t* const  dst,
+    const std::size_t    dst_stride,
+    const Format         format,
+    const std::size_t    count
+) -> bool
+{
+    const Column_format column_format = get_uint_column_format(format);
+    if (!column_format.valid || (column_format.component_count != component_count)) {
+        return false;
+    }
+    if (count == 0) {
+        return true;
+    }
+    ERHE_VERIFY((src != nullptr) && (dst != nullptr));
+    ERHE_VERIFY(src_stride >= component_count * sizeof(std::uint32_t));
+    switch (column_format.component_size) {
+        case 1: convert_uint_values<std::uint8_t >(src, src_stride, component_count, dst, dst_stride, count); break;
+        case 2: convert_uint_values<std::uint16_t>(src, src_stride, component_count, dst, dst_stride, count); break;
+        case 4: convert_uint_values<std::uint32_t>(src, src_stride, component_count, dst, dst_stride, count); break;
+        default: ERHE_FATAL("bad component size"); break;
+    }
+    return true;
+}
+
+} // namespace erhe::dataformat
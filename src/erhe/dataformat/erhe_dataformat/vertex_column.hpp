@@ -0,0 +1,43 @@
+#pragma once
+
+#include "erhe_dataformat/dataformat.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace erhe::dataformat {
+
+// Column conversion of vertex attribute data: count source values of
+// component_count (1..4) components, src_stride bytes apart, converted to
+// format and written dst_stride bytes apart (interleaved vertex buffers).
+//
+// The format is dispatched once per column; the per value conversion runs
+// one value per SSE2 / NEON vector where available (scalar otherwise), with
+// the same scaling, rounding and clamping as float_to_unorm8() and friends.
+//
+// Float sources convert to 32-bit float, 16-bit float (glm::packHalf1x16()),
+// unorm8 / snorm8 / unorm16 / snorm16 formats with the same component
+// count. Uint sources convert to 8 / 16 / 32-bit uint formats with the same
+// component count; values must fit (ERHE_VERIFY). Both return false, and
+// write nothing, for any other format.
+[[nodiscard]] auto convert_float_column(
+    const float*  src,
+    std::size_t   src_stride,
+    std::size_t   component_count,
+    std::uint8_t* dst,
+    std::size_t   dst_stride,
+    Format        format,
+    std::size_t   count
+) -> bool;
+
+[[nodiscard]] auto convert_uint_column(
+    const std::uint32_t* src,
+    std::size_t          src_stride,
+    std::size_t          component_count,
+    std::uint8_t*        dst,
+    std::size_t          dst_stride,
+    Format               format,
+    std::size_t          count
+) -> bool;
+
+} // namespace erhe::dataformat
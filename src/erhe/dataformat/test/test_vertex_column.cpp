@@ -0,0 +1,206 @@
+// convert_float_column() / convert_uint_column() must produce the same bytes
+// as the scalar per value conversions (float_to_unorm8() and friends) for
+// every supported format, honoring source and destination strides.
+
+#include <gtest/gtest.h>
+
+#include "erhe_benchmark/benchmark.hpp"
+#include "erhe_dataformat/dataformat.hpp"
+#include "erhe_dataformat/vertex_column.hpp"
+
+#include <fmt/format.h>
+
+#include <cstring>
+#include <vector>
+
+using erhe::dataformat::Format;
+using erhe::dataformat::convert_float_column;
+using erhe::dataformat::convert_uint_column;
+
+namespace {
+
+// Interesting values: out of range, rounding midpoints, signed zero.
+const std::vector<float> test_values{
+    -2.0f, -1.0f, -0.99f, -0.5f, -0.25f, -1.0f / 254.0f, -0.0f, 0.0f,
+    1.0f / 510.0f, 0.1f, 0.25f, 0.5f, 0.75f, 0.999f, 1.0f, 1.5f, 100.0f
+};
+
+enum class Encoding : unsigned int { float32, unorm, snorm };
+
+// Format_kind reports normalized formats as float; tell them apart here.
+[[nodiscard]] auto get_encoding(const Format format) -> Encoding
+{
+    switch (format) {
+        case Format::format_8_scalar_unorm:  case Format::format_8_vec2_unorm:  case Format::format_8_vec3_unorm:  case Format::format_8_vec4_unorm:
+        case Format::format_16_scalar_unorm: case Format::format_16_vec2_unorm: case Format::format_16_vec3_unorm: case Format::format_16_vec4_unorm:
+            return Encoding::unorm;
+        case Format::format_8_scalar_snorm:  case Format::format_8_vec2_snorm:  case Format::format_8_vec3_snorm:  case Format::format_8_vec4_snorm:
+        case Format::format_16_scalar_snorm: case Format::format_16_vec2_snorm: case Format::format_16_vec3_snorm: case Format::format_16_vec4_snorm:
+            return Encoding::snorm;
+        default:
+            return Encoding::float32;
+    }
+}
+
+// Scalar reference: one value, format switched per component.
+void convert_reference(const float* value, const Format format, std::uint8_t* out)
+{
+    const std::size_t component_count = erhe::dataformat::get_component_count    (format);
+    const std::size_t component_size  = erhe::dataformat::get_component_byte_size(format);
+    const Encoding    encoding        = get_encoding(format);
+    for (std::size_t c = 0; c < component_count; ++c) {
+        std::uint8_t* component = out + c * component_size;
+        if (encoding == Encoding::float32) {
+            std::memcpy(component, &value[c], 4);
+            continue;
+        }
+        const bool is_signed = (encoding == Encoding::snorm);
+        if (component_size == 1) {
+            const std::uint8_t v = is_signed
+                ? static_cast<std::uint8_t>(erhe::dataformat::float_to_snorm8(value[c]))
+                : erhe::dataformat::float_to_unorm8(value[c]);
+            std::memcpy(component, &v, 1);
+        } else {
+            const std::uint16_t v = is_signed
+                ? static_cast<std::uint16_t>(erhe::dataformat::float_to_snorm16(value[c]))
+                : erhe::dataformat::float_to_unorm16(value[c]);
+            std::memcpy(component, &v, 2);
+        }
+    }
+}
+
+const Format normalized_and_float_formats[] = {
+    Format::format_8_scalar_unorm,  Format::format_8_vec2_unorm,  Format::format_8_vec3_unorm,  Format::format_8_vec4_unorm,
+    Format::format_8_scalar_snorm,  Format::format_8_vec2_snorm,  Format::format_8_vec3_snorm,  Format::format_8_vec4_snorm,
+    Format::format_16_scalar_unorm, Format::format_16_vec2_unorm, Format::format_16_vec3_unorm, Format::format_16_vec4_unorm,
+    Format::format_16_scalar_snorm, Format::format_16_vec2_snorm, Format::format_16_vec3_snorm, Format::format_16_vec4_snorm,
+    Format::format_32_scalar_float, Format::format_32_vec2_float, Format::format_32_vec3_float, Format::format_32_vec4_float
+};
+
+} // anonymous namespace
+
+TEST(VertexColumn, float_column_matches_scalar_conversion)
+{
+    const std::size_t count = test_values.size();
+    for (const Format format : normalized_and_float_formats) {
+        const std::size_t component_count = erhe::dataformat::get_component_count(format);
+        const std::size_t value_size      = erhe::dataformat::get_format_size_bytes(format);
+
+        // Tightly packed source (the last value of a vec3 column must not
+        // read past the end), destination interleaved with a gap.
+        std::vector<float> src(count * component_count);
+        for (std::size_t i = 0; i < count; ++i) {
+            for (std::size_t c = 0; c < component_count; ++c) {
+                src[i * component_count + c] = test_values[(i + c * 5) % count];
+            }
+        }
+        const std::size_t dst_stride = value_size + 3;
+        std::vector<std::uint8_t> column   (count * dst_stride, 0xcd);
+        std::vector<std::uint8_t> reference(count * dst_stride, 0xcd);
+        ASSERT_TRUE(convert_float_column(src.data(), component_count * sizeof(float), component_count, column.data(), dst_stride, format, count));
+        for (std::size_t i = 0; i < count; ++i) {
+            convert_reference(&src[i * component_count], format, &reference[i * dst_stride]);
+        }
+        EXPECT_EQ(column, reference) << erhe::dataformat::c_str(format);
+    }
+}
+
+TEST(VertexColumn, float_column_half)
+{
+    const float src[] = { 0.0f, 1.0f, -2.0f, 0.5f, 65504.0f, -0.25f };
+    std::uint16_t dst[6]{};
+    ASSERT_TRUE(convert_float_column(src, 2 * sizeof(float), 2, reinterpret_cast<std::uint8_t*>(dst), 2 * sizeof(std::uint16_t), Format::format_16_vec2_float, 3));
+    const std::uint16_t expected[] = { 0x0000, 0x3c00, 0xc000, 0x3800, 0x7bff, 0xb400 };
+    for (std::size_t i = 0; i < 6; ++i) {
+        EXPECT_EQ(dst[i], expected[i]) << i;
+    }
+}
+
+TEST(VertexColumn, uint_column_narrows)
+{
+    const std::uint32_t src[] = { 0, 1, 2, 3, 250, 251, 252, 253 };
+    std::uint8_t dst[8]{};
+    ASSERT_TRUE(convert_uint_column(src, 4 * sizeof(std::uint32_t), 4, dst, 4, Format::format_8_vec4_uint, 2));
+    for (std::size_t i = 0; i < 8; ++i) {
+        EXPECT_EQ(dst[i], src[i]);
+    }
+    std::uint16_t dst16[8]{};
+    ASSERT_TRUE(convert_uint_column(src, 4 * sizeof(std::uint32_t), 4, reinterpret_cast<std::uint8_t*>(dst16), 8, Format::format_16_vec4_uint, 2));
+    for (std::size_t i = 0; i < 8; ++i) {
+        EXPECT_EQ(dst16[i], src[i]);
+    }
+}
+
+TEST(VertexColumn, unsupported_format_writes_nothing)
+{
+    const float src[4] = { 1.0f, 2.0f, 3.0f, 4.0f };
+    std::uint8_t dst[16];
+    std::memset(dst, 0xcd, sizeof(dst));
+    EXPECT_FALSE(convert_float_column(src, 16, 4, dst, 16, Format::format_8_vec4_uint,   1));
+    EXPECT_FALSE(convert_float_column(src, 16, 3, dst, 16, Format::format_8_vec4_unorm,  1)); // component count mismatch
+    EXPECT_FALSE(convert_uint_column (reinterpret_cast<const std::uint32_t*>(src), 16, 4, dst, 16, Format::format_32_vec4_float, 1));
+    for (const std::uint8_t byte : dst) {
+        EXPECT_EQ(byte, 0xcd);
+    }
+}
+
+// Build_context::build_polygon_fill() attribute write, before and after: a
+// format switch per value versus one column conversion per attribute. The
+// layout is a typical fill stream (position, normal, tangent, texcoord, color
+// as float3 / snorm16x3 / snorm16x4 / unorm16x2 / unorm8x4).
+ERHE_BENCHMARK(VertexColumn, fill_stream)
+{
+    constexpr std::size_t vertex_count = 1024 * 1024; // ~ corners of a 512x512 quad sphere
+    constexpr std::size_t stride       = 12 + 8 + 8 + 4 + 4;
+
+    std::vector<float> position(3 * vertex_count);
+    std::vector<float> normal  (3 * vertex_count);
+    std::vector<float> tangent (4 * vertex_count);
+    std::vector<float> texcoord(2 * vertex_count);
+    std::vector<float> color   (4 * vertex_count);
+    for (std::size_t i = 0; i < vertex_count; ++i) {
+        const float t = static_cast<float>(i) / static_cast<float>(vertex_count);
+        for (std::size_t c = 0; c < 4; ++c) {
+            const float v = t * static_cast<float>(c + 1) - 0.5f;
+            if (c < 3) position[3 * i + c] = 10.0f * v;
+            if (c < 3) normal  [3 * i + c] = v;
+            if (c < 2) texcoord[2 * i + c] = t;
+            tangent[4 * i + c] = v;
+            color  [4 * i + c] = t;
+        }
+    }
+
+    class Column
+    {
+    public:
+        const float* values;
+        std::size_t  component_count;
+        Format       format;
+        std::size_t  offset;
+    };
+    const Column columns[] = {
+        { position.data(), 3, Format::format_32_vec3_float,  0 },
+        { normal  .data(), 3, Format::format_16_vec3_snorm, 12 },
+        { tangent .data(), 4, Format::format_16_vec4_snorm, 20 },
+        { texcoord.data(), 2, Format::format_16_vec2_unorm, 28 },
+        { color   .data(), 4, Format::format_8_vec4_unorm,  32 },
+    };
+
+    std::vector<std::uint8_t> per_value_data(vertex_count * stride);
+    std::vector<std::uint8_t> column_data   (vertex_count * stride);
+
+    erhe::benchmark::Stopwatch stopwatch;
+    for (std::size_t i = 0; i < vertex_count; ++i) {
+        for (const Column& column : columns) {
+            convert_reference(column.values + i * column.component_count, column.format, per_value_data.data() + i * stride + column.offset);
+        }
+    }
+    const double per_value_ms = stopwatch.lap_ms();
+    for (const Column& column : columns) {
+        ASSERT_TRUE(convert_float_column(column.values, column.component_count * sizeof(float), column.component_count, column_data.data() + column.offset, stride, column.format, vertex_count));
+    }
+    const double column_ms = stopwatch.lap_ms();
+
+    EXPECT_EQ(per_value_data, column_data);
+    fmt::print("{} vertices, stride {}: per value {:.2f} ms, column {:.2f} ms ({:.1f}x)\n", vertex_count, stride, per_value_ms, column_ms, per_value_ms / column_ms);
+}
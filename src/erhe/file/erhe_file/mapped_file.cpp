@@ -0,0 +1,196 @@
+#include "erhe_file/mapped_file.hpp"
+#include "erhe_file/file.hpp"
+#include "erhe_file/file_log.hpp"
+
+#include <fmt/std.h>
+
+#include <cstdint>
+#include <utility>
+
+#if defined(ERHE_OS_WINDOWS)
+#   include <Windows.h>
+#else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+namespace erhe::file {
+
+namespace {
+
+[[nodiscard]] auto get_page_size() -> std::size_t
+{
+#if defined(ERHE_OS_WINDOWS)
+    SYSTEM_INFO system_info{};
+    GetSystemInfo(&system_info);
+    return static_cast<std::size_t>(system_info.dwPageSize);
+#else
+    const long page_size = sysconf(_SC_PAGESIZE);
+    return (page_size > 0) ? static_cast<std::size_t>(page_size) : std::size_t{4096};
+#endif
+}
+
+} // anonymous namespace
+
+Mapped_file::~Mapped_file() noexcept
+{
+    unmap();
+}
+
+Mapped_file::Mapped_file(Mapped_file&& other) noexcept
+    : m_path          {std::move(other.m_path)}
+    , m_data          {std::exchange(other.m_data, nullptr)}
+    , m_size          {std::exchange(other.m_size, 0)}
+#if defined(ERHE_OS_WINDOWS)
+    , m_file_handle   {std::exchange(other.m_file_handle, nullptr)}
+    , m_mapping_handle{std::exchange(other.m_mapping_handle, nullptr)}
+#endif
+{
+}
+
+auto Mapped_file::operator=(Mapped_file&& other) noexcept -> Mapped_file&
+{
+    if (this != &other) {
+        unmap();
+        m_path           = std::move(other.m_path);
+        m_data           = std::exchange(other.m_data, nullptr);
+        m_size           = std::exchange(other.m_size, 0);
+#if defined(ERHE_OS_WINDOWS)
+        m_file_handle    = std::exchange(other.m_file_handle, nullptr);
+        m_mapping_handle = std::exchange(other.m_mapping_handle, nullptr);
+#endif
+    }
+    return *this;
+}
+
+void Mapped_file::unmap() noexcept
+{
+#if defined(ERHE_OS_WINDOWS)
+    if (m_data != nullptr) {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mapping_handle != nullptr) {
+        CloseHandle(static_cast<HANDLE>(m_mapping_handle));
+    }
+    if (m_file_handle != nullptr) {
+        CloseHandle(static_cast<HANDLE>(m_file_handle));
+    }
+    m_file_handle    = nullptr;
+    m_mapping_handle = nullptr;
+#else
+    if (m_data != nullptr) {
+        munmap(const_cast<std::byte*>(m_data), m_size);
+    }
+#endif
+    m_data = nullptr;
+    m_size = 0;
+}
+
+auto Mapped_file::open(
+    const std::string_view       description,
+    const std::filesystem::path& path,
+    const Access_pattern         access_pattern
+) -> std::optional<Mapped_file>
+{
+    if (!check_is_existing_non_empty_regular_file(description, path)) {
+        return {};
+    }
+
+    Mapped_file mapped_file;
+    mapped_file.m_path = path;
+
+#if defined(ERHE_OS_WINDOWS)
+    const DWORD flags =
+        (access_pattern == Access_pattern::sequential) ? FILE_FLAG_SEQUENTIAL_SCAN :
+        (access_pattern == Access_pattern::random    ) ? FILE_FLAG_RANDOM_ACCESS   : FILE_ATTRIBUTE_NORMAL;
+    const HANDLE file_handle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+    if (file_handle == INVALID_HANDLE_VALUE) {
+        log_file->warn("{}: CreateFileW() failed for '{}', error {}", description, path, GetLastError());
+        return {};
+    }
+    mapped_file.m_file_handle = file_handle;
+    LARGE_INTEGER file_size{};
+    if (!GetFileSizeEx(file_handle, &file_size) || (file_size.QuadPart <= 0)) {
+        log_file->warn("{}: GetFileSizeEx() failed for '{}'", description, path);
+        return {};
+    }
+    const HANDLE mapping_handle = CreateFileMappingW(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_handle == nullptr) {
+        log_file->warn("{}: CreateFileMappingW() failed for '{}', error {}", description, path, GetLastError());
+        return {};
+    }
+    mapped_file.m_mapping_handle = mapping_handle;
+    const void* data = MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0);
+    if (data == nullptr) {
+        log_file->warn("{}: MapViewOfFile() failed for '{}', error {}", description, path, GetLastError());
+        return {};
+    }
+    mapped_file.m_data = static_cast<const std::byte*>(data);
+    mapped_file.m_size = static_cast<std::size_t>(file_size.QuadPart);
+#else
+    const int file_descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file_descriptor < 0) {
+        log_file->warn("{}: open() failed for '{}'", description, path);
+        return {};
+    }
+    struct stat file_status{};
+    if ((fstat(file_descriptor, &file_status) != 0) || (file_status.st_size <= 0)) {
+        log_file->warn("{}: fstat() failed for '{}'", description, path);
+        ::close(file_descriptor);
+        return {};
+    }
+    const std::size_t size = static_cast<std::size_t>(file_status.st_size);
+    void* const data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+    // The mapping keeps its own reference to the file.
+    ::close(file_descriptor);
+    if (data == MAP_FAILED) {
+        log_file->warn("{}: mmap() failed for '{}'", description, path);
+        return {};
+    }
+    mapped_file.m_data = static_cast<const std::byte*>(data);
+    mapped_file.m_size = size;
+
+    const int advice =
+        (access_pattern == Access_pattern::sequential) ? MADV_SEQUENTIAL :
+        (access_pattern == Access_pattern::random    ) ? MADV_RANDOM     : MADV_NORMAL;
+    if (advice != MADV_NORMAL) {
+        madvise(data, size, advice); // only a hint; failure is not an error
+    }
+#endif
+
+    log_file->trace("{}: mapped '{}', {} bytes", description, path, mapped_file.m_size);
+    return std::optional<Mapped_file>{std::move(mapped_file)};
+}
+
+auto Mapped_file::get_bytes() const -> std::span<const std::byte>
+{
+    return std::span<const std::byte>{m_data, m_size};
+}
+
+auto Mapped_file::get_path() const -> const std::filesystem::path&
+{
+    return m_path;
+}
+
+void Mapped_file::prefetch(const std::span<const std::byte> bytes)
+{
+    if (bytes.empty()) {
+        return;
+    }
+    static const std::size_t page_size = get_page_size();
+    const std::uintptr_t begin = reinterpret_cast<std::uintptr_t>(bytes.data()) & ~(static_cast<std::uintptr_t>(page_size) - 1);
+    const std::uintptr_t end   = reinterpret_cast<std::uintptr_t>(bytes.data()) + bytes.size();
+#if defined(ERHE_OS_WINDOWS)
+    WIN32_MEMORY_RANGE_ENTRY range{
+        .VirtualAddress = reinterpret_cast<void*>(begin),
+        .NumberOfBytes  = static_cast<SIZE_T>(end - begin)
+    };
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#else
+    madvise(reinterpret_cast<void*>(begin), static_cast<std::size_t>(end - begin), MADV_WILLNEED);
+#endif
+}
+
+} // namespace erhe::file
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string_view>
+
+namespace erhe::file {
+
+// Read-only memory mapping of a whole file (mmap on Linux / macOS / Android,
+// MapViewOfFile on Windows). Pages are faulted in from the page cache on
+// first access, so mapping a multi-GB file costs nothing up front and the
+// bytes are never copied into the heap. The mapping stays valid until the
+// Mapped_file is destroyed; spans handed out must not outlive it.
+class Mapped_file
+{
+public:
+    // Hints for the pager. Sequential: the file is read front to back, read
+    // ahead aggressively and drop pages behind. Random: no read ahead.
+    enum class Access_pattern : unsigned int
+    {
+        normal = 0,
+        sequential,
+        random
+    };
+
+    Mapped_file() = default;
+    ~Mapped_file() noexcept;
+    Mapped_file(const Mapped_file&) = delete;
+    auto operator=(const Mapped_file&) -> Mapped_file& = delete;
+    Mapped_file(Mapped_file&& other) noexcept;
+    auto operator=(Mapped_file&& other) noexcept -> Mapped_file&;
+
+    // Returns nullopt (after logging) if the file does not exist, is empty
+    // or cannot be mapped - for example an Android APK asset, which is not a
+    // file on the filesystem. Callers fall back to reading the file.
+    [[nodiscard]] static auto open(
+        std::string_view             description,
+        const std::filesystem::path& path,
+        Access_pattern               access_pattern = Access_pattern::sequential
+    ) -> std::optional<Mapped_file>;
+
+    [[nodiscard]] auto get_bytes() const -> std::span<const std::byte>;
+    [[nodiscard]] auto get_path () const -> const std::filesystem::path&;
+
+    // Starts asynchronous read of the pages covering bytes, so that the
+    // first access does not stall on a page fault per 4 KB. bytes may point
+    // into any mapping (or heap memory, where this does nothing useful but
+    // is harmless); the range is widened to page boundaries.
+    static void prefetch(std::span<const std::byte> bytes);
+
+private:
+    void unmap() noexcept;
+
+    std::filesystem::path m_path;
+    const std::byte*      m_data{nullptr};
+    std::size_t           m_size{0};
+#if defined(ERHE_OS_WINDOWS)
+    void*                 m_file_handle   {nullptr};
+    void*                 m_mapping_handle{nullptr};
+#endif
+};
+
+} // namespace erhe::file
@@ -316,11 +316,7 @@ void Mesh_attributes::bind()
     edge_sharpness           .bind(m_mesh.edges        .attributes());
 }
 
-Mesh_attributes::~Mesh_attributes() noexcept
-{
-    static int counter = 0;
-    ++counter;
-}
+Mesh_attributes::~Mesh_attributes() noexcept = default;
 
 auto count_mesh_facet_triangles(const GEO::Mesh& mesh) -> std::size_t
 {
@@ -836,11 +832,9 @@ void write_geogram_delaunay_repro(GEO::index_t dim, GEO::index_t nb_pts, const G
 
 auto make_convex_hull(const GEO::Mesh& source, GEO::Mesh& destination) -> bool
 {
-    // See geogram_lock(): the (non-default) Delaunay branch below must not
-    // run concurrently with other geogram algorithm invocations; the default
-    // QuickHull branch is erhe code and the lock costs nothing measurable.
-    const std::lock_guard<std::recursive_mutex> geogram_guard{geogram_lock()};
-
+    // The default QuickHull branch is erhe code and runs without a lock;
+    // the (non-default) Delaunay branch takes geogram_lock() around the
+    // geogram calls.
     try {
         const GEO::index_t nb_pts = source.vertices.nb();
 #if ERHE_CONVEX_HULL_USE_QUICKHULL
@@ -907,6 +901,7 @@ auto make_convex_hull(const GEO::Mesh& source, GEO::Mesh& destination) -> bool
         // otherwise FMA contraction breaks its exact predicates and this call
         // spins forever in locate_inexact() on degenerate input such as a cone's
         // coplanar base ring (ARM-only, intermittent).
+        const std::lock_guard<std::recursive_mutex> geogram_guard{geogram_lock()};
         GEO::Delaunay_var delaunay = GEO::Delaunay::create(GEO::coord_index_t(dim), "BDEL");
         delaunay->set_keeps_infinite(true);
 #if ERHE_CAPTURE_DELAUNAY_REPRO
@@ -1436,12 +1431,47 @@ void Geometry::build_edges()
     }
 }
 
-void Geometry::process(const Geometry_process_parameters& parameters)
+void Geometry::index_edges()
 {
-    // See geogram_lock(): xatlas / repair / parallel_for-using steps below
-    // must not run concurrently with other geogram algorithm invocations.
-    const std::lock_guard<std::recursive_mutex> geogram_guard{geogram_lock()};
+    // Same table layout build_edges() produces: it creates edges in index
+    // order and appends each one to both of its vertices, and edge to facets
+    // is filled walking the facet corners in order.
+    m_vertex_pair_to_edge.clear();
+    m_vertex_to_edges.clear();
+    m_vertex_to_edges.resize(m_mesh.vertices.nb());
+    for (GEO::index_t edge : m_mesh.edges) {
+        const GEO::index_t a  = m_mesh.edges.vertex(edge, 0);
+        const GEO::index_t b  = m_mesh.edges.vertex(edge, 1);
+        const GEO::index_t lo = std::min(a, b);
+        const GEO::index_t hi = std::max(a, b);
+        m_vertex_pair_to_edge.insert({{lo, hi}, edge});
+        m_vertex_to_edges[a].push_back(edge);
+        m_vertex_to_edges[b].push_back(edge);
+    }
 
+    m_edge_to_facets.clear();
+    m_edge_to_facets.resize(m_mesh.edges.nb());
+    for (GEO::index_t facet : m_mesh.facets) {
+        const GEO::index_t facet_corner_count = m_mesh.facets.nb_corners(facet);
+        for (GEO::index_t local_facet_corner = 0; local_facet_corner < facet_corner_count; ++local_facet_corner) {
+            const GEO::index_t corner      = m_mesh.facets.corner(facet, local_facet_corner);
+            const GEO::index_t next_corner = m_mesh.facets.corner(facet, (local_facet_corner + 1) % facet_corner_count);
+            const GEO::index_t a           = m_mesh.facet_corners.vertex(corner);
+            const GEO::index_t b           = m_mesh.facet_corners.vertex(next_corner);
+            const auto i = m_vertex_pair_to_edge.find({std::min(a, b), std::max(a, b)});
+            if (i != m_vertex_pair_to_edge.end()) {
+                m_edge_to_facets[i->second].push_back(facet);
+            }
+        }
+    }
+}
+
+void Geometry::process(const Geometry_process_parameters& parameters)
+{
+    // No geogram_lock() here: the steps below are mesh-local erhe code,
+    // except the atlas step, which locks inside make_atlas() around the
+    // Geogram parameterizer only. process() on different geometries runs
+    // concurrently.
     const uint64_t flags = parameters.flags;
     //GEO::mesh_reorder(m_mesh);
 
@@ -46,18 +46,30 @@ namespace erhe::geometry {
 // Geogram is not safe to call concurrently from multiple threads: its own
 // tracker (BrunoLevy/geogram#68, open) lists global static state in CVT /
 // (HL)BFGS optimizers and cites "Delaunay on two meshes in parallel" as
-// unsupported, and its Windows thread-pool manager corrupts thread-id
-// assignment when parallel_for is entered from two threads at once
-// (process_win.cpp static threadCounter_; observed as GEO::Geom::colocate()
-// old2new corruption). Every erhe entry point that reaches a geogram
-// *algorithm* (parallel_for users, Delaunay, mesh_repair, CVT, xatlas via
-// process(), colocate via mesh_from_triangle_soup, make_convex_hull, the
-// geometry-operation implementations) must hold this lock. Pure per-mesh
-// element/attribute construction (create_vertices, facets.connect, attribute
-// binds) is mesh-local and does not need it. Recursive so the choke points
-// can nest (a geometry operation that calls Geometry::process()). Geogram
-// still parallelizes each call internally across cores, so serializing the
-// outer calls costs little throughput.
+// unsupported, its progress system keeps a process-global task stack, and its
+// Windows thread-pool manager corrupts thread-id assignment when parallel_for
+// is entered from two threads at once (process_win.cpp static threadCounter_;
+// observed as GEO::Geom::colocate() old2new corruption).
+//
+// This lock guards exactly those non-reentrant entry points, and each erhe
+// function that reaches one takes it itself, scoped to the geogram call:
+//   - Delaunay: make_convex_hull() (BDEL branch), shapes::make_convex_hull()
+//   - mesh_repair / MeshSurfaceIntersection: operation::repair(), weld()
+//   - CVT remesh / smoothing, mesh_decimate: operation/remesh.cpp
+//   - mesh_boolean_operation: Geometry_operation::run_mesh_boolean_operation()
+//   - mesh_make_atlas (Geogram parameterizer branch): make_atlas.cpp
+//   - FrameField: operation::generate_frame_field_tangents()
+//   - Geom::colocate (parallel_for): erhe::primitive::mesh_from_triangle_soup()
+// Everything else - Geometry::process() (the atlas step locks inside
+// make_atlas), the Conway / subdivision / clip operations, merges and
+// attribute work - is mesh-local (element / attribute stores are per mesh,
+// with spinlocked observers and read-only type registries at the geogram
+// pin), so operations on DIFFERENT Geometry objects run concurrently without
+// a caller lock. Concurrent reads of one shared source are fine; concurrent
+// writes to one Geometry are not. Code calling a geogram algorithm directly
+// (outside erhe::geometry) must take this lock around that call only.
+// Recursive so the entry points can nest (a boolean operation's
+// post-processing reaching make_atlas).
 [[nodiscard]] auto geogram_lock() -> std::recursive_mutex&;
 
 enum class Transform_mode : unsigned int {
@@ -870,6 +882,12 @@ public:
     void process(const Geometry_process_parameters& parameters);
     void generate_mesh_facet_texture_coordinates(std::size_t usage_index = 1);
     void build_edges();
+    // Rebuilds the edge lookups build_edges() fills (vertex pair to edge,
+    // vertex to edges, edge to facets) over the edges already in the mesh,
+    // without recreating them. For geometry restored with
+    // geometry_from_flat_data(), where the edges and their attributes come
+    // from the dump and must not be renumbered.
+    void index_edges();
     void update_connectivity();
     void merge_coplanar_neighbors();
 
@@ -0,0 +1,425 @@
+#include "erhe_geometry/geometry_delta.hpp"
+#include "erhe_geometry/geometry.hpp"
+#include "erhe_geometry/geometry_log.hpp"
+#include "erhe_geometry/geometry_serialization.hpp"
+
+#include "erhe_hash/hash.hpp"
+#include "erhe_profile/profile.hpp"
+
+#include <geogram/basic/attributes.h>
+#include <geogram/mesh/mesh.h>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+namespace erhe::geometry {
+
+namespace {
+
+constexpr uint32_t c_delta_magic   = 0x544c4447; // "GDLT"
+constexpr uint32_t c_delta_version = 1;
+
+template <typename T>
+[[nodiscard]] auto as_byte_span(const std::vector<T>& values) -> std::span<const std::byte>
+{
+    return std::span<const std::byte>{reinterpret_cast<const std::byte*>(values.data()), values.size() * sizeof(T)};
+}
+
+class Delta_writer
+{
+public:
+    explicit Delta_writer(std::vector<std::byte>& out)
+        : m_out{out}
+    {
+    }
+
+    template <typename T>
+    void write(const T& value)
+    {
+        append(&value, sizeof(T));
+    }
+
+    void write_string(const std::string& value)
+    {
+        write<uint64_t>(value.size());
+        append(value.data(), value.size());
+    }
+
+    void append(const void* data, const std::size_t byte_count)
+    {
+        const std::byte* bytes = static_cast<const std::byte*>(data);
+        m_out.insert(m_out.end(), bytes, bytes + byte_count);
+    }
+
+private:
+    std::vector<std::byte>& m_out;
+};
+
+class Delta_reader
+{
+public:
+    explicit Delta_reader(const std::span<const std::byte> in)
+        : m_in{in}
+    {
+    }
+
+    template <typename T>
+    [[nodiscard]] auto read(T& value) -> bool
+    {
+        const std::byte* bytes = take(sizeof(T));
+        if (bytes == nullptr) {
+            return false;
+        }
+        std::memcpy(&value, bytes, sizeof(T));
+        return true;
+    }
+
+    [[nodiscard]] auto read_string(std::string& value) -> bool
+    {
+        uint64_t length = 0;
+        if (!read(length)) {
+            return false;
+        }
+        const std::byte* bytes = take(static_cast<std::size_t>(length));
+        if (bytes == nullptr) {
+            return false;
+        }
+        value.assign(reinterpret_cast<const char*>(bytes), static_cast<std::size_t>(length));
+        return true;
+    }
+
+    // Returns nullptr when fewer than byte_count bytes remain.
+    [[nodiscard]] auto take(const std::size_t byte_count) -> const std::byte*
+    {
+        if (byte_count > (m_in.size() - m_offset)) {
+            return nullptr;
+        }
+        const std::byte* bytes = m_in.data() + m_offset;
+        m_offset += byte_count;
+        return bytes;
+    }
+
+    [[nodiscard]] auto at_end() const -> bool
+    {
+        return m_offset == m_in.size();
+    }
+
+private:
+    std::span<const std::byte> m_in;
+    std::size_t                m_offset{0};
+};
+
+// Array delta layout: target byte count, run count, then per run the
+// offset, byte count and the target bytes. Differing blocks that touch
+// merge into one run.
+void write_array_delta(
+    Delta_writer&                    writer,
+    const std::span<const std::byte> reference,
+    const std::span<const std::byte> target
+)
+{
+    class Run
+    {
+    public:
+        std::size_t offset    {0};
+        std::size_t byte_count{0};
+    };
+    std::vector<Run> runs;
+    const std::size_t common_byte_count = std::min(reference.size(), target.size());
+    for (std::size_t offset = 0; offset < target.size(); ) {
+        const std::size_t block_end = std::min(offset + c_geometry_delta_block_size, target.size());
+        const bool differs =
+            (block_end > common_byte_count) ||
+            (std::memcmp(reference.data() + offset, target.data() + offset, block_end - offset) != 0);
+        if (differs) {
+            if (!runs.empty() && (runs.back().offset + runs.back().byte_count == offset)) {
+                runs.back().byte_count = block_end - runs.back().offset;
+            } else {
+                runs.push_back(Run{.offset = offset, .byte_count = block_end - offset});
+            }
+        }
+        offset = block_end;
+    }
+
+    writer.write<uint64_t>(target.size());
+    writer.write<uint64_t>(runs.size());
+    for (const Run& run : runs) {
+        writer.write<uint64_t>(run.offset);
+        writer.write<uint64_t>(run.byte_count);
+        writer.append(target.data() + run.offset, run.byte_count);
+    }
+}
+
+[[nodiscard]] auto read_array_delta(
+    Delta_reader&                    reader,
+    const std::span<const std::byte> reference,
+    std::vector<std::byte>&          out
+) -> bool
+{
+    uint64_t target_byte_count = 0;
+    uint64_t run_count         = 0;
+    if (!reader.read(target_byte_count) || !reader.read(run_count)) {
+        return false;
+    }
+    const std::size_t prefix_byte_count = std::min(reference.size(), static_cast<std::size_t>(target_byte_count));
+    out.assign(reference.begin(), reference.begin() + static_cast<std::ptrdiff_t>(prefix_byte_count));
+    out.resize(static_cast<std::size_t>(target_byte_count));
+    for (uint64_t i = 0; i < run_count; ++i) {
+        uint64_t offset     = 0;
+        uint64_t byte_count = 0;
+        if (!reader.read(offset) || !reader.read(byte_count)) {
+            return false;
+        }
+        if ((offset > target_byte_count) || (byte_count > target_byte_count - offset)) {
+            return false;
+        }
+        const std::byte* bytes = reader.take(static_cast<std::size_t>(byte_count));
+        if (bytes == nullptr) {
+            return false;
+        }
+        std::memcpy(out.data() + offset, bytes, static_cast<std::size_t>(byte_count));
+    }
+    return true;
+}
+
+template <typename T>
+[[nodiscard]] auto read_array_delta(
+    Delta_reader&         reader,
+    const std::vector<T>& reference,
+    std::vector<T>&       out
+) -> bool
+{
+    std::vector<std::byte> bytes;
+    if (!read_array_delta(reader, as_byte_span(reference), bytes)) {
+        return false;
+    }
+    if ((bytes.size() % sizeof(T)) != 0) {
+        return false;
+    }
+    out.resize(bytes.size() / sizeof(T));
+    if (!bytes.empty()) {
+        std::memcpy(out.data(), bytes.data(), bytes.size());
+    }
+    return true;
+}
+
+// The reference attribute a target attribute is encoded against: same
+// element and name, and a store of the same shape.
+[[nodiscard]] auto find_reference_attribute(
+    const Geometry_flat_data&        reference,
+    const Geometry_attribute_record& record
+) -> std::span<const std::byte>
+{
+    for (const Geometry_attribute_record& candidate : reference.attributes) {
+        if (
+            (candidate.element      == record.element)      &&
+            (candidate.name         == record.name)         &&
+            (candidate.element_type == record.element_type) &&
+            (candidate.element_size == record.element_size) &&
+            (candidate.dimension    == record.dimension)
+        ) {
+            return std::span<const std::byte>{candidate.bytes.data(), candidate.bytes.size()};
+        }
+    }
+    return {};
+}
+
+[[nodiscard]] auto get_attribute_store_byte_count(const std::string& element, GEO::AttributesManager& attributes_manager) -> std::size_t
+{
+    std::size_t byte_count = 0;
+    GEO::vector<std::string> attribute_names;
+    attributes_manager.list_attribute_names(attribute_names);
+    for (GEO::index_t i = 0; i < attribute_names.size(); ++i) {
+        const std::string& name = attribute_names[i];
+        // Positions are counted by the caller (see is_structural_attribute()
+        // in geometry_serialization.cpp).
+        if ((element == "vertex") && ((name == "point") || (name == "point_fp32"))) {
+            continue;
+        }
+        const GEO::AttributeStore* store = attributes_manager.find_attribute_store(name);
+        if (store == nullptr) {
+            continue;
+        }
+        byte_count += static_cast<std::size_t>(attributes_manager.size()) * store->dimension() * store->element_size();
+    }
+    return byte_count;
+}
+
+} // anonymous namespace
+
+auto get_flat_data_hash(const Geometry_flat_data& data) -> uint64_t
+{
+    ERHE_PROFILE_FUNCTION();
+
+    uint64_t hash = erhe::hash::c_seed;
+    hash = erhe::hash::hash(static_cast<uint64_t>(data.vertex_count), hash);
+    hash = erhe::hash::hash(static_cast<uint64_t>(data.facet_count),  hash);
+    hash = erhe::hash::hash(static_cast<uint64_t>(data.corner_count), hash);
+    hash = erhe::hash::hash(static_cast<uint64_t>(data.edge_count),   hash);
+    const auto hash_bytes = [&hash](const std::span<const std::byte> bytes) {
+        hash = erhe::hash::hash(static_cast<uint64_t>(bytes.size()), hash);
+        hash = erhe::hash::hash(bytes.data(), bytes.size(), hash);
+    };
+    hash_bytes(as_byte_span(data.positions));
+    hash_bytes(as_byte_span(data.triangle_indices));
+    hash_bytes(as_byte_span(data.facet_vertex_counts));
+    hash_bytes(as_byte_span(data.facet_vertex_indices));
+    hash_bytes(as_byte_span(data.edge_vertex_indices));
+    for (const Geometry_attribute_record& record : data.attributes) {
+        hash = erhe::hash::hash(record.name.data(),         record.name.size(),         hash);
+        hash = erhe::hash::hash(record.element.data(),      record.element.size(),      hash);
+        hash = erhe::hash::hash(record.element_type.data(), record.element_type.size(), hash);
+        hash_bytes(as_byte_span(record.bytes));
+    }
+    return hash;
+}
+
+auto make_geometry_delta(const Geometry_flat_data& reference, const Geometry_flat_data& target) -> std::vector<std::byte>
+{
+    ERHE_PROFILE_FUNCTION();
+
+    std::vector<std::byte> delta;
+    Delta_writer writer{delta};
+    writer.write<uint32_t>(c_delta_magic);
+    writer.write<uint32_t>(c_delta_version);
+    writer.write<uint64_t>(get_flat_data_hash(reference));
+    writer.write<uint64_t>(target.vertex_count);
+    writer.write<uint64_t>(target.facet_count);
+    writer.write<uint64_t>(target.corner_count);
+    writer.write<uint64_t>(target.edge_count);
+
+    write_array_delta(writer, as_byte_span(reference.positions),            as_byte_span(target.positions));
+    write_array_delta(writer, as_byte_span(reference.triangle_indices),     as_byte_span(target.triangle_indices));
+    write_array_delta(writer, as_byte_span(reference.facet_vertex_counts),  as_byte_span(target.facet_vertex_counts));
+    write_array_delta(writer, as_byte_span(reference.facet_vertex_indices), as_byte_span(target.facet_vertex_indices));
+    write_array_delta(writer, as_byte_span(reference.edge_vertex_indices),  as_byte_span(target.edge_vertex_indices));
+
+    writer.write<uint64_t>(target.attributes.size());
+    for (const Geometry_attribute_record& record : target.attributes) {
+        writer.write_string(record.name);
+        writer.write_string(record.element);
+        writer.write_string(record.element_type);
+        writer.write<uint64_t>(record.element_size);
+        writer.write<uint64_t>(record.dimension);
+        writer.write<uint64_t>(record.item_count);
+        write_array_delta(writer, find_reference_attribute(reference, record), as_byte_span(record.bytes));
+    }
+    return delta;
+}
+
+auto apply_geometry_delta(
+    const Geometry_flat_data&  reference,
+    std::span<const std::byte> delta,
+    Geometry_flat_data&        target
+) -> bool
+{
+    ERHE_PROFILE_FUNCTION();
+
+    Delta_reader reader{delta};
+    uint32_t magic          = 0;
+    uint32_t version        = 0;
+    uint64_t reference_hash = 0;
+    if (!reader.read(magic) || !reader.read(version) || !reader.read(reference_hash)) {
+        return false;
+    }
+    if ((magic != c_delta_magic) || (version != c_delta_version)) {
+        log_geometry->warn("apply_geometry_delta: not a geometry delta");
+        return false;
+    }
+    if (reference_hash != get_flat_data_hash(reference)) {
+        log_geometry->warn("apply_geometry_delta: delta was made against a different reference");
+        return false;
+    }
+
+    Geometry_flat_data data;
+    uint64_t vertex_count = 0;
+    uint64_t facet_count  = 0;
+    uint64_t corner_count = 0;
+    uint64_t edge_count   = 0;
+    if (!reader.read(vertex_count) || !reader.read(facet_count) || !reader.read(corner_count) || !reader.read(edge_count)) {
+        return false;
+    }
+    data.vertex_count = static_cast<std::size_t>(vertex_count);
+    data.facet_count  = static_cast<std::size_t>(facet_count);
+    data.corner_count = static_cast<std::size_t>(corner_count);
+    data.edge_count   = static_cast<std::size_t>(edge_count);
+
+    if (
+        !read_array_delta(reader, reference.positions,            data.positions)            ||
+        !read_array_delta(reader, reference.triangle_indices,     data.triangle_indices)     ||
+        !read_array_delta(reader, reference.facet_vertex_counts,  data.facet_vertex_counts)  ||
+        !read_array_delta(reader, reference.facet_vertex_indices, data.facet_vertex_indices) ||
+        !read_array_delta(reader, reference.edge_vertex_indices,  data.edge_vertex_indices)
+    ) {
+        return false;
+    }
+
+    uint64_t attribute_count = 0;
+    if (!reader.read(attribute_count)) {
+        return false;
+    }
+    for (uint64_t i = 0; i < attribute_count; ++i) {
+        Geometry_attribute_record record;
+        uint64_t element_size = 0;
+        uint64_t dimension    = 0;
+        uint64_t item_count   = 0;
+        if (
+            !reader.read_string(record.name)         ||
+            !reader.read_string(record.element)      ||
+            !reader.read_string(record.element_type) ||
+            !reader.read(element_size)               ||
+            !reader.read(dimension)                  ||
+            !reader.read(item_count)
+        ) {
+            return false;
+        }
+        record.element_size = static_cast<std::size_t>(element_size);
+        record.dimension    = static_cast<std::size_t>(dimension);
+        record.item_count   = static_cast<std::size_t>(item_count);
+        if (!read_array_delta(reader, find_reference_attribute(reference, record), record.bytes)) {
+            return false;
+        }
+        data.attributes.push_back(std::move(record));
+    }
+    if (!reader.at_end()) {
+        return false;
+    }
+    target = std::move(data);
+    return true;
+}
+
+auto get_flat_data_byte_count(const Geometry& geometry) -> std::size_t
+{
+    const GEO::Mesh& mesh = geometry.get_mesh();
+    const std::size_t vertex_count   = mesh.vertices.nb();
+    const std::size_t facet_count    = mesh.facets.nb();
+    const std::size_t corner_count   = mesh.facet_corners.nb();
+    const std::size_t edge_count     = mesh.edges.nb();
+    const std::size_t triangle_count = (corner_count > 2 * facet_count) ? (corner_count - 2 * facet_count) : 0;
+    return
+        (vertex_count * 3 * sizeof(float)) +
+        (triangle_count * 3 * sizeof(uint32_t)) +
+        (facet_count * sizeof(uint32_t)) +
+        (corner_count * sizeof(uint32_t)) +
+        (edge_count * 2 * sizeof(uint32_t)) +
+        get_attribute_store_byte_count("vertex", mesh.vertices     .attributes()) +
+        get_attribute_store_byte_count("facet",  mesh.facets       .attributes()) +
+        get_attribute_store_byte_count("corner", mesh.facet_corners.attributes()) +
+        get_attribute_store_byte_count("edge",   mesh.edges        .attributes());
+}
+
+auto make_geometry_from_flat_data(const Geometry_flat_data& data, const std::string_view name) -> std::shared_ptr<Geometry>
+{
+    ERHE_PROFILE_FUNCTION();
+
+    std::shared_ptr<Geometry> geometry = std::make_shared<Geometry>(name);
+    if (!geometry_from_flat_data(data, *geometry)) {
+        return {};
+    }
+    geometry->update_connectivity();
+    geometry->index_edges();
+    return geometry;
+}
+
+}
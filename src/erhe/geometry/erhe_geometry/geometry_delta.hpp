@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace erhe::geometry {
+
+class Geometry;
+class Geometry_flat_data;
+
+// Compact encoding of one Geometry version relative to a neighbouring one,
+// built on the raw store dump of geometry_serialization.hpp. Used by the
+// editor undo history to keep the side of a mesh operation that is not in
+// the scene as a delta against the side that is.
+//
+// Each flat data array (positions, facet rings, edges, every attribute
+// store) is compared with the same array of the reference in blocks of
+// c_geometry_delta_block_size bytes; the delta keeps the target size of
+// the array and the byte runs that differ. Attributes are matched by
+// element and name; an attribute without a compatible counterpart (other
+// element type, size or dimension) is stored whole. Operations that only
+// move vertices or rewrite a few attributes produce small deltas, while
+// topology changes that renumber everything degrade to about the size of
+// the target.
+//
+// The delta is a self-contained byte blob in native byte order, meant for
+// the process that made it (memory, or a temporary spill file). It embeds
+// a hash of the reference; apply_geometry_delta() refuses a different
+// reference, so a delta is either reproduced bit-exact or not at all.
+constexpr std::size_t c_geometry_delta_block_size = 64;
+
+[[nodiscard]] auto make_geometry_delta(
+    const Geometry_flat_data& reference,
+    const Geometry_flat_data& target
+) -> std::vector<std::byte>;
+
+// Rebuilds the target flat data from the reference and a delta made
+// against it. Returns false when the delta is malformed or was made
+// against a different reference.
+[[nodiscard]] auto apply_geometry_delta(
+    const Geometry_flat_data& reference,
+    std::span<const std::byte> delta,
+    Geometry_flat_data&       target
+) -> bool;
+
+// Hash of every byte of the flat data, as embedded in deltas.
+[[nodiscard]] auto get_flat_data_hash(const Geometry_flat_data& data) -> uint64_t;
+
+// Bytes geometry_to_flat_data() would produce for geometry, summed from
+// the mesh element counts and attribute stores without copying anything.
+// A memory use estimate for the geometry itself.
+[[nodiscard]] auto get_flat_data_byte_count(const Geometry& geometry) -> std::size_t;
+
+// geometry_from_flat_data() into a new Geometry, plus the derived lookups
+// process() would have built (vertex corners, edge tables). The dump
+// already carries every attribute, so nothing is recomputed. Returns
+// nullptr when the flat data is inconsistent.
+[[nodiscard]] auto make_geometry_from_flat_data(
+    const Geometry_flat_data& data,
+    std::string_view          name
+) -> std::shared_ptr<Geometry>;
+
+}
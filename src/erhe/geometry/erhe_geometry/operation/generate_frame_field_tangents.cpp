@@ -7,6 +7,7 @@
 #include <geogram/mesh/mesh_frame_field.h>
 
 #include <cmath>
+#include <mutex>
 
 namespace erhe::geometry::operation {
 
@@ -38,6 +39,10 @@ void compute_frame_field_tangents(GEO::Mesh& mesh, Mesh_attributes& attributes,
         return;
     }
 
+    // Geogram algorithm (FrameField solver, kd-tree) - see geogram_lock().
+    // Held until frame_field is destroyed, after the per-facet queries.
+    const std::lock_guard<std::recursive_mutex> geogram_guard{geogram_lock()};
+
     // use_NN_ defaults to true, so create_from_surface_mesh() builds the spatial
     // search that get_nearest_frame() below queries.
     GEO::FrameField frame_field;
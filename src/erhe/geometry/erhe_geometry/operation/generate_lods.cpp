@@ -0,0 +1,543 @@
+#include "erhe_geometry/operation/generate_lods.hpp"
+#include "erhe_geometry/geometry.hpp"
+#include "erhe_profile/profile.hpp"
+
+#include <geogram/mesh/mesh.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <queue>
+
+namespace erhe::geometry::operation {
+
+namespace {
+
+// Symmetric 4x4 matrix, upper triangle. Sum of squared distances to a set of
+// planes: evaluate(p) = sum((n . p + d)^2).
+class Quadric
+{
+public:
+    [[nodiscard]] static auto from_plane(const double a, const double b, const double c, const double d) -> Quadric
+    {
+        return Quadric{
+            a * a, a * b, a * c, a * d,
+                   b * b, b * c, b * d,
+                          c * c, c * d,
+                                 d * d
+        };
+    }
+
+    void add(const Quadric& other)
+    {
+        a00 += other.a00; a01 += other.a01; a02 += other.a02; a03 += other.a03;
+        a11 += other.a11; a12 += other.a12; a13 += other.a13;
+        a22 += other.a22; a23 += other.a23;
+        a33 += other.a33;
+    }
+
+    [[nodiscard]] auto evaluate(const GEO::vec3& p) const -> double
+    {
+        const double x = p.x;
+        const double y = p.y;
+        const double z = p.z;
+        return
+            x * (a00 * x + 2.0 * (a01 * y + a02 * z + a03)) +
+            y * (a11 * y + 2.0 * (a12 * z + a13)) +
+            z * (a22 * z + 2.0 * a23) +
+            a33;
+    }
+
+    double a00{0.0}, a01{0.0}, a02{0.0}, a03{0.0};
+    double a11{0.0}, a12{0.0}, a13{0.0};
+    double a22{0.0}, a23{0.0};
+    double a33{0.0};
+};
+
+template <GEO::index_t DIM>
+[[nodiscard]] auto nearly_equal(const GEO::vecng<DIM, float>& a, const GEO::vecng<DIM, float>& b) -> bool
+{
+    constexpr float tolerance = 1.0e-5f;
+    for (GEO::index_t i = 0; i < DIM; ++i) {
+        if (std::abs(a[i] - b[i]) > tolerance) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename T>
+[[nodiscard]] auto nearly_equal(const std::optional<T>& a, const std::optional<T>& b) -> bool
+{
+    if (a.has_value() != b.has_value()) {
+        return false;
+    }
+    return !a.has_value() || nearly_equal(a.value(), b.value());
+}
+
+// Compares the vertex data the primitive builder would write for two
+// corners of the same vertex. Only the corner and facet attributes can
+// differ; vertex attributes are shared by construction.
+class Corner_data_compare
+{
+public:
+    explicit Corner_data_compare(const GEO::Mesh& mesh)
+        : m_mesh      {mesh}
+        , m_attributes{mesh}
+    {
+    }
+
+    [[nodiscard]] auto same(const GEO::index_t corner_a, const GEO::index_t corner_b) const -> bool
+    {
+        if (corner_a == corner_b) {
+            return true;
+        }
+        const GEO::index_t facet_a  = m_mesh.facet_corners.facet(corner_a);
+        const GEO::index_t facet_b  = m_mesh.facet_corners.facet(corner_b);
+        const GEO::index_t vertex   = m_mesh.facet_corners.vertex(corner_a);
+        return
+            nearly_equal(normal (corner_a, facet_a, vertex), normal (corner_b, facet_b, vertex)) &&
+            nearly_equal(tangent(corner_a, facet_a),         tangent(corner_b, facet_b)) &&
+            nearly_equal(m_attributes.corner_texcoord_0.try_get(corner_a), m_attributes.corner_texcoord_0.try_get(corner_b)) &&
+            nearly_equal(m_attributes.corner_texcoord_1.try_get(corner_a), m_attributes.corner_texcoord_1.try_get(corner_b)) &&
+            nearly_equal(m_attributes.corner_texcoord_2.try_get(corner_a), m_attributes.corner_texcoord_2.try_get(corner_b)) &&
+            nearly_equal(color(m_attributes.corner_color_0, m_attributes.facet_color_0, corner_a, facet_a), color(m_attributes.corner_color_0, m_attributes.facet_color_0, corner_b, facet_b)) &&
+            nearly_equal(color(m_attributes.corner_color_1, m_attributes.facet_color_1, corner_a, facet_a), color(m_attributes.corner_color_1, m_attributes.facet_color_1, corner_b, facet_b));
+    }
+
+private:
+    // Same resolution order as Build_context::build_tangent_frame() with
+    // Normal_style::corner_normals.
+    [[nodiscard]] auto normal(const GEO::index_t corner, const GEO::index_t facet, const GEO::index_t vertex) const -> GEO::vec3f
+    {
+        const std::optional<GEO::vec3f> corner_normal = m_attributes.corner_normal.try_get(corner);
+        if (corner_normal.has_value()) {
+            return corner_normal.value();
+        }
+        const std::optional<GEO::vec3f> facet_normal = m_attributes.facet_normal.try_get(facet);
+        if (facet_normal.has_value()) {
+            return facet_normal.value();
+        }
+        const std::optional<GEO::vec3f> vertex_normal = m_attributes.vertex_normal.try_get(vertex);
+        if (vertex_normal.has_value()) {
+            return vertex_normal.value();
+        }
+        return GEO::normalize(mesh_facet_normalf(m_mesh, facet));
+    }
+
+    [[nodiscard]] auto tangent(const GEO::index_t corner, const GEO::index_t facet) const -> std::optional<GEO::vec4f>
+    {
+        const std::optional<GEO::vec4f> corner_tangent = m_attributes.corner_tangent.try_get(corner);
+        return corner_tangent.has_value() ? corner_tangent : m_attributes.facet_tangent.try_get(facet);
+    }
+
+    [[nodiscard]] static auto color(
+        const Attribute_present<GEO::vec4f>& corner_color,
+        const Attribute_present<GEO::vec4f>& facet_color,
+        const GEO::index_t                   corner,
+        const GEO::index_t                   facet
+    ) -> std::optional<GEO::vec4f>
+    {
+        const std::optional<GEO::vec4f> value = corner_color.try_get(corner);
+        return value.has_value() ? value : facet_color.try_get(facet);
+    }
+
+    const GEO::Mesh& m_mesh;
+    Mesh_attributes  m_attributes;
+};
+
+class Collapse_candidate
+{
+public:
+    double       cost;
+    GEO::index_t from;         // removed vertex
+    GEO::index_t to;           // surviving vertex
+    uint32_t     from_version;
+    uint32_t     to_version;
+
+    auto operator>(const Collapse_candidate& other) const -> bool { return cost > other.cost; }
+};
+
+class Simplifier
+{
+public:
+    explicit Simplifier(const GEO::Mesh& mesh)
+        : m_mesh        {mesh}
+        , m_corner_data {mesh}
+    {
+        triangulate();
+        compute_quadrics();
+        lock_vertices();
+        for (uint32_t triangle = 0, end = static_cast<uint32_t>(m_triangles.size()); triangle < end; ++triangle) {
+            for (int i = 0; i < 3; ++i) {
+                push_candidate(vertex(m_triangles[triangle][i]), vertex(m_triangles[triangle][(i + 1) % 3]));
+            }
+        }
+    }
+
+    [[nodiscard]] auto live_triangle_count() const -> std::size_t { return m_live_triangle_count; }
+    [[nodiscard]] auto max_applied_cost   () const -> double      { return m_max_applied_cost; }
+
+    // Collapses the cheapest valid edges until at most target_triangle_count
+    // triangles remain. Returns false when it ran out of candidates (or of
+    // candidates within max_cost) first.
+    auto collapse_until(const std::size_t target_triangle_count, const double max_cost) -> bool
+    {
+        while (m_live_triangle_count > target_triangle_count) {
+            if (m_queue.empty()) {
+                return false;
+            }
+            const Collapse_candidate candidate = m_queue.top();
+            if ((max_cost > 0.0) && (candidate.cost > max_cost)) {
+                return false;
+            }
+            m_queue.pop();
+            if (
+                m_removed[candidate.from] ||
+                m_removed[candidate.to] ||
+                (m_version[candidate.from] != candidate.from_version) ||
+                (m_version[candidate.to] != candidate.to_version)
+            ) {
+                continue; // stale
+            }
+            try_collapse(candidate.from, candidate.to, candidate.cost);
+        }
+        return true;
+    }
+
+    [[nodiscard]] auto live_triangle_corners() const -> std::vector<GEO::index_t>
+    {
+        std::vector<GEO::index_t> corners;
+        corners.reserve(3 * m_live_triangle_count);
+        for (std::size_t triangle = 0, end = m_triangles.size(); triangle < end; ++triangle) {
+            if (m_triangle_alive[triangle]) {
+                corners.insert(corners.end(), m_triangles[triangle].begin(), m_triangles[triangle].end());
+            }
+        }
+        return corners;
+    }
+
+private:
+    [[nodiscard]] auto vertex(const GEO::index_t corner) const -> GEO::index_t
+    {
+        return m_mesh.facet_corners.vertex(corner);
+    }
+
+    [[nodiscard]] auto position(const GEO::index_t vertex_index) const -> GEO::vec3
+    {
+        const GEO::vec3f p = get_pointf(m_mesh.vertices, vertex_index);
+        return GEO::vec3{p.x, p.y, p.z};
+    }
+
+    // Same fan as Build_context::build_triangle_fill_index(): (c0, c[i-1], c[i])
+    void triangulate()
+    {
+        const GEO::index_t vertex_count = m_mesh.vertices.nb();
+        m_vertex_triangles.resize(vertex_count);
+        m_quadrics        .resize(vertex_count);
+        m_locked          .resize(vertex_count, 0);
+        m_removed         .resize(vertex_count, 0);
+        m_version         .resize(vertex_count, 0);
+        for (GEO::index_t facet : m_mesh.facets) {
+            const GEO::index_t corner_count = m_mesh.facets.nb_corners(facet);
+            const GEO::index_t c0           = m_mesh.facets.corner(facet, 0);
+            for (GEO::index_t i = 2; i < corner_count; ++i) {
+                const std::array<GEO::index_t, 3> triangle{c0, m_mesh.facets.corner(facet, i - 1), m_mesh.facets.corner(facet, i)};
+                const GEO::index_t v0 = vertex(triangle[0]);
+                const GEO::index_t v1 = vertex(triangle[1]);
+                const GEO::index_t v2 = vertex(triangle[2]);
+                if ((v0 == v1) || (v1 == v2) || (v2 == v0)) {
+                    continue;
+                }
+                const uint32_t triangle_index = static_cast<uint32_t>(m_triangles.size());
+                m_triangles     .push_back(triangle);
+                m_triangle_alive.push_back(1);
+                m_vertex_triangles[v0].push_back(triangle_index);
+                m_vertex_triangles[v1].push_back(triangle_index);
+                m_vertex_triangles[v2].push_back(triangle_index);
+            }
+        }
+        m_live_triangle_count = m_triangles.size();
+    }
+
+    void compute_quadrics()
+    {
+        for (const std::array<GEO::index_t, 3>& triangle : m_triangles) {
+            const GEO::vec3 p0     = position(vertex(triangle[0]));
+            const GEO::vec3 p1     = position(vertex(triangle[1]));
+            const GEO::vec3 p2     = position(vertex(triangle[2]));
+            const GEO::vec3 normal = GEO::cross(p1 - p0, p2 - p0);
+            const double    length = GEO::length(normal);
+            if (length <= 0.0) {
+                continue;
+            }
+            const GEO::vec3 n = normal / length;
+            const Quadric   plane_quadric = Quadric::from_plane(n.x, n.y, n.z, -GEO::dot(n, p0));
+            for (int i = 0; i < 3; ++i) {
+                m_quadrics[vertex(triangle[i])].add(plane_quadric);
+            }
+        }
+    }
+
+    // Locks border, non-manifold and attribute seam vertices. A vertex is
+    // removable only when its triangles form one closed fan and all its
+    // corners carry the same vertex data.
+    void lock_vertices()
+    {
+        std::vector<std::array<GEO::index_t, 2>> fan; // the two other vertices of each triangle, in winding order
+        std::vector<uint8_t>                     visited;
+        for (GEO::index_t v = 0, end = static_cast<GEO::index_t>(m_vertex_triangles.size()); v < end; ++v) {
+            const std::vector<uint32_t>& triangles = m_vertex_triangles[v];
+            if (triangles.size() < 3) {
+                m_locked[v] = 1;
+                continue;
+            }
+            fan.clear();
+            GEO::index_t first_corner = GEO::NO_INDEX;
+            bool         seam         = false;
+            for (const uint32_t triangle_index : triangles) {
+                const std::array<GEO::index_t, 3>& triangle = m_triangles[triangle_index];
+                for (int i = 0; i < 3; ++i) {
+                    if (vertex(triangle[i]) != v) {
+                        continue;
+                    }
+                    fan.push_back({vertex(triangle[(i + 1) % 3]), vertex(triangle[(i + 2) % 3])});
+                    if (first_corner == GEO::NO_INDEX) {
+                        first_corner = triangle[i];
+                    } else if (!m_corner_data.same(first_corner, triangle[i])) {
+                        seam = true;
+                    }
+                }
+            }
+            if (seam || !is_single_closed_fan(fan, visited)) {
+                m_locked[v] = 1;
+            }
+        }
+    }
+
+    // Walks the fan (a[i] -> b[i] edges) from the first triangle: a single
+    // closed fan returns to its start after visiting every triangle once.
+    [[nodiscard]] static auto is_single_closed_fan(
+        const std::vector<std::array<GEO::index_t, 2>>& fan,
+        std::vector<uint8_t>&                           visited
+    ) -> bool
+    {
+        visited.assign(fan.size(), 0);
+        visited[0] = 1;
+        GEO::index_t current = fan[0][1];
+        for (std::size_t step = 1; step < fan.size(); ++step) {
+            std::size_t next = fan.size();
+            for (std::size_t i = 0; i < fan.size(); ++i) {
+                if (fan[i][0] == current) {
+                    if (next != fan.size()) {
+                        return false; // edge used by more than two triangles
+                    }
+                    next = i;
+                }
+            }
+            if ((next == fan.size()) || visited[next]) {
+                return false;
+            }
+            visited[next] = 1;
+            current = fan[next][1];
+        }
+        return current == fan[0][0];
+    }
+
+    void push_candidate(const GEO::index_t from, const GEO::index_t to)
+    {
+        if (m_locked[from] || m_removed[from] || m_removed[to]) {
+            return;
+        }
+        Quadric quadric = m_quadrics[from];
+        quadric.add(m_quadrics[to]);
+        const double cost = std::max(0.0, quadric.evaluate(position(to)));
+        m_queue.push(Collapse_candidate{cost, from, to, m_version[from], m_version[to]});
+    }
+
+    // Live triangles of a vertex; prunes the dead ones from its list.
+    auto live_triangles(const GEO::index_t v) -> std::vector<uint32_t>&
+    {
+        std::vector<uint32_t>& triangles = m_vertex_triangles[v];
+        triangles.erase(
+            std::remove_if(triangles.begin(), triangles.end(), [this](const uint32_t t) { return m_triangle_alive[t] == 0; }),
+            triangles.end()
+        );
+        return triangles;
+    }
+
+    void collect_neighbors(const GEO::index_t v, std::vector<GEO::index_t>& neighbors)
+    {
+        neighbors.clear();
+        for (const uint32_t triangle_index : live_triangles(v)) {
+            for (const GEO::index_t corner : m_triangles[triangle_index]) {
+                const GEO::index_t w = vertex(corner);
+                if (w != v) {
+                    neighbors.push_back(w);
+                }
+            }
+        }
+        std::sort(neighbors.begin(), neighbors.end());
+        neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+    }
+
+    [[nodiscard]] auto corner_of(const uint32_t triangle_index, const GEO::index_t v) const -> int
+    {
+        const std::array<GEO::index_t, 3>& triangle = m_triangles[triangle_index];
+        for (int i = 0; i < 3; ++i) {
+            if (vertex(triangle[i]) == v) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    void try_collapse(const GEO::index_t from, const GEO::index_t to, const double cost)
+    {
+        const std::vector<uint32_t>& from_triangles = live_triangles(from);
+
+        // The two triangles sharing the edge
+        std::array<uint32_t, 2> edge_triangles{};
+        std::size_t             edge_triangle_count = 0;
+        for (const uint32_t triangle_index : from_triangles) {
+            if (corner_of(triangle_index, to) >= 0) {
+                if (edge_triangle_count == 2) {
+                    return;
+                }
+                edge_triangles[edge_triangle_count++] = triangle_index;
+            }
+        }
+        if (edge_triangle_count != 2) {
+            return;
+        }
+
+        // The surviving vertex takes over the removed vertex's triangles with
+        // its corner from the collapsed triangles; both must agree, or the
+        // edge is an attribute seam of the surviving vertex.
+        const GEO::index_t to_corner = m_triangles[edge_triangles[0]][corner_of(edge_triangles[0], to)];
+        if (!m_corner_data.same(to_corner, m_triangles[edge_triangles[1]][corner_of(edge_triangles[1], to)])) {
+            return;
+        }
+
+        // Link condition: the only common neighbors are the two vertices
+        // opposite to the edge. Otherwise the collapse pinches the surface.
+        collect_neighbors(from, m_from_neighbors);
+        collect_neighbors(to,   m_to_neighbors);
+        std::size_t common_count = 0;
+        for (const GEO::index_t w : m_from_neighbors) {
+            if (std::binary_search(m_to_neighbors.begin(), m_to_neighbors.end(), w)) {
+                ++common_count;
+            }
+        }
+        if (common_count != 2) {
+            return;
+        }
+        // A tetrahedron would collapse into two coincident triangles
+        if ((m_from_neighbors.size() <= 3) && (m_to_neighbors.size() <= 3)) {
+            return;
+        }
+
+        // Reject flipped or degenerate triangles
+        const GEO::vec3 to_position = position(to);
+        for (const uint32_t triangle_index : from_triangles) {
+            if ((triangle_index == edge_triangles[0]) || (triangle_index == edge_triangles[1])) {
+                continue;
+            }
+            const std::array<GEO::index_t, 3>& triangle = m_triangles[triangle_index];
+            const int       i       = corner_of(triangle_index, from);
+            const GEO::vec3 p0      = position(vertex(triangle[0]));
+            const GEO::vec3 p1      = position(vertex(triangle[1]));
+            const GEO::vec3 p2      = position(vertex(triangle[2]));
+            const GEO::vec3 q0      = (i == 0) ? to_position : p0;
+            const GEO::vec3 q1      = (i == 1) ? to_position : p1;
+            const GEO::vec3 q2      = (i == 2) ? to_position : p2;
+            const GEO::vec3 before  = GEO::cross(p1 - p0, p2 - p0);
+            const GEO::vec3 after   = GEO::cross(q1 - q0, q2 - q0);
+            const double    length  = GEO::length(before) * GEO::length(after);
+            if ((length <= 0.0) || (GEO::dot(before, after) < 0.2 * length)) {
+                return;
+            }
+        }
+
+        // Apply
+        for (const uint32_t triangle_index : edge_triangles) {
+            m_triangle_alive[triangle_index] = 0;
+        }
+        m_live_triangle_count -= 2;
+        std::vector<uint32_t>& to_triangles = m_vertex_triangles[to];
+        for (const uint32_t triangle_index : from_triangles) {
+            if (m_triangle_alive[triangle_index] == 0) {
+                continue;
+            }
+            m_triangles[triangle_index][corner_of(triangle_index, from)] = to_corner;
+            to_triangles.push_back(triangle_index);
+        }
+        m_vertex_triangles[from].clear();
+        m_quadrics[to].add(m_quadrics[from]);
+        m_removed[from] = 1;
+        ++m_version[to];
+        m_max_applied_cost = std::max(m_max_applied_cost, cost);
+
+        collect_neighbors(to, m_to_neighbors);
+        for (const GEO::index_t w : m_to_neighbors) {
+            push_candidate(w, to);
+            push_candidate(to, w);
+        }
+    }
+
+    const GEO::Mesh&                         m_mesh;
+    Corner_data_compare                      m_corner_data;
+    std::vector<std::array<GEO::index_t, 3>> m_triangles;        // source corners
+    std::vector<uint8_t>                     m_triangle_alive;
+    std::vector<std::vector<uint32_t>>       m_vertex_triangles;
+    std::vector<Quadric>                     m_quadrics;
+    std::vector<uint8_t>                     m_locked;
+    std::vector<uint8_t>                     m_removed;
+    std::vector<uint32_t>                    m_version;
+    std::vector<GEO::index_t>                m_from_neighbors;
+    std::vector<GEO::index_t>                m_to_neighbors;
+    std::size_t                              m_live_triangle_count{0};
+    double                                   m_max_applied_cost   {0.0};
+    std::priority_queue<Collapse_candidate, std::vector<Collapse_candidate>, std::greater<Collapse_candidate>> m_queue;
+};
+
+} // anonymous namespace
+
+auto generate_lods(const GEO::Mesh& mesh, const Lod_settings& settings) -> std::vector<Lod_level>
+{
+    ERHE_PROFILE_FUNCTION();
+
+    std::vector<Lod_level> levels;
+    if (settings.triangle_ratios.empty() || (mesh.facets.nb() == 0)) {
+        return levels;
+    }
+
+    Simplifier simplifier{mesh};
+    const std::size_t source_triangle_count = simplifier.live_triangle_count();
+    const double      max_cost              = static_cast<double>(settings.max_error) * static_cast<double>(settings.max_error);
+    std::size_t       previous_count        = source_triangle_count;
+    for (const float ratio : settings.triangle_ratios) {
+        const std::size_t target  = static_cast<std::size_t>(static_cast<double>(ratio) * static_cast<double>(source_triangle_count));
+        const bool        reached = simplifier.collapse_until(std::max<std::size_t>(target, 1), max_cost);
+        const std::size_t count   = simplifier.live_triangle_count();
+        if (static_cast<double>(count) > static_cast<double>(settings.min_reduction) * static_cast<double>(previous_count)) {
+            break;
+        }
+        levels.push_back(
+            Lod_level{
+                .triangle_corners = simplifier.live_triangle_corners(),
+                .error            = static_cast<float>(std::sqrt(simplifier.max_applied_cost()))
+            }
+        );
+        previous_count = count;
+        if (!reached) {
+            break; // further levels would be identical
+        }
+    }
+    return levels;
+}
+
+} // namespace erhe::geometry::operation
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <geogram/basic/numeric.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace GEO { class Mesh; }
+
+namespace erhe::geometry::operation {
+
+class Lod_settings
+{
+public:
+    // Target triangle count of each generated level, as a fraction of the
+    // fan-triangulated source triangle count. Finest first, decreasing.
+    std::vector<float> triangle_ratios{0.5f, 0.25f, 0.125f};
+    // Collapses whose geometric error (object space distance) would exceed
+    // this are not done; the chain ends early when the next target can not be
+    // reached within it. <= 0.0f: no limit.
+    float              max_error      {0.0f};
+    // A level that keeps more than this fraction of the previous level's
+    // triangles is not worth its index range; the chain ends there.
+    float              min_reduction  {0.85f};
+};
+
+// One coarser level of detail. The triangles reference facet corners of the
+// SOURCE mesh: simplification is by half-edge collapse, which only removes
+// vertices and never moves the surviving ones, so every level reuses the
+// per-corner vertex data of the full detail build. A renderable level is an
+// index range over the same vertex buffer.
+class Lod_level
+{
+public:
+    [[nodiscard]] auto triangle_count() const -> std::size_t { return triangle_corners.size() / 3; }
+
+    std::vector<GEO::index_t> triangle_corners; // 3 source facet corners per triangle
+    // Object space estimate of the surface deviation from the source: square
+    // root of the largest accumulated quadric error of an applied collapse.
+    float                     error{0.0f};
+};
+
+// Quadric error metric simplification (Garland-Heckbert, half-edge collapse
+// variant) of the fan-triangulated source mesh into a chain of levels, one
+// per reachable entry of Lod_settings::triangle_ratios.
+//
+// Vertices are kept where removing them would show: border and non-manifold
+// vertices, and vertices on an attribute seam - where the corners around the
+// vertex do not all resolve to the same normal, tangent, texture coordinates
+// and colors (resolved like the corner_normals build). Flat shaded meshes
+// (per facet normals) only simplify inside planar regions.
+//
+// Does not modify the source mesh topology or attribute values; safe to call
+// concurrently for different meshes (no Geogram algorithm entry points are
+// used, so no geogram_lock()).
+[[nodiscard]] auto generate_lods(const GEO::Mesh& mesh, const Lod_settings& settings = {}) -> std::vector<Lod_level>;
+
+} // namespace erhe::geometry::operation
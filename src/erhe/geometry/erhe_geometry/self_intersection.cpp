@@ -1,9 +1,17 @@
 #include "erhe_geometry/self_intersection.hpp"
+#include "erhe_profile/profile.hpp"
 
 #include <geogram/basic/geometry.h>
 #include <geogram/mesh/mesh.h>
 
+#include <taskflow/taskflow.hpp>
+#include <taskflow/algorithm/for_each.hpp>
+
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <cstdint>
+#include <memory>
 #include <vector>
 
 namespace erhe::geometry {
@@ -131,9 +139,156 @@ auto get_vertex_position(const GEO::Mesh& mesh, GEO::index_t vertex) -> GEO::vec
     return GEO::vec3f{p[0], p[1], p[2]};
 }
 
-} // anonymous namespace
+class Box
+{
+public:
+    GEO::vec3f min;
+    GEO::vec3f max;
+
+    [[nodiscard]] auto overlaps(const Box& other) const -> bool
+    {
+        return
+            (min.x <= other.max.x) && (other.min.x <= max.x) &&
+            (min.y <= other.max.y) && (other.min.y <= max.y) &&
+            (min.z <= other.max.z) && (other.min.z <= max.z);
+    }
+    void include(const Box& other)
+    {
+        min.x = std::min(min.x, other.min.x); max.x = std::max(max.x, other.max.x);
+        min.y = std::min(min.y, other.min.y); max.y = std::max(max.y, other.max.y);
+        min.z = std::min(min.z, other.min.z); max.z = std::max(max.z, other.max.z);
+    }
+};
+
+// The narrow phase accepts points up to bary_margin outside a triangle, which
+// is at most 2e-5 of the triangle's bounding box diagonal away from it. The
+// padding covers that with room for rounding, so the broad phase never drops
+// a pair that brute force would report.
+constexpr float c_box_padding = 1e-4f;
+
+auto get_padded_box(const Triangle& triangle) -> Box
+{
+    Box box{triangle.v[0], triangle.v[0]};
+    for (int i = 1; i < 3; ++i) {
+        box.include(Box{triangle.v[i], triangle.v[i]});
+    }
+    const GEO::vec3f diagonal = box.max - box.min;
+    const float      pad      = c_box_padding * std::sqrt(GEO::dot(diagonal, diagonal)) + 1e-7f;
+    box.min -= GEO::vec3f{pad, pad, pad};
+    box.max += GEO::vec3f{pad, pad, pad};
+    return box;
+}
+
+// Bounding volume hierarchy over the triangle boxes: median split on the
+// longest axis of the centroid bounds, built once per query.
+class Triangle_bvh
+{
+public:
+    explicit Triangle_bvh(const std::vector<Box>& boxes)
+    {
+        ERHE_PROFILE_FUNCTION();
+
+        const uint32_t count = static_cast<uint32_t>(boxes.size());
+        m_indices.resize(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            m_indices[i] = i;
+        }
+        if (count == 0) {
+            return;
+        }
+        m_nodes.reserve(2 * (count / c_leaf_size) + 1);
+        m_nodes.push_back(Node{});
+        build(boxes, 0, 0, count);
+    }
+
+    // Calls visitor(index) for every box overlapping query_box.
+    template <typename Visitor>
+    void query(const Box& query_box, Visitor&& visitor) const
+    {
+        if (m_nodes.empty()) {
+            return;
+        }
+        uint32_t stack[64];
+        int      stack_size = 0;
+        stack[stack_size++] = 0;
+        while (stack_size > 0) {
+            const Node& node = m_nodes[stack[--stack_size]];
+            if (!node.box.overlaps(query_box)) {
+                continue;
+            }
+            if (node.count > 0) {
+                for (uint32_t i = node.first, end = node.first + node.count; i < end; ++i) {
+                    visitor(m_indices[i]);
+                }
+                continue;
+            }
+            stack[stack_size++] = node.left;
+            stack[stack_size++] = node.left + 1;
+        }
+    }
+
+private:
+    static constexpr uint32_t c_leaf_size = 4;
+
+    class Node
+    {
+    public:
+        Box      box  {};
+        uint32_t first{0};
+        uint32_t count{0}; // 0 for inner nodes
+        uint32_t left {0}; // right child is left + 1
+    };
+
+    void build(const std::vector<Box>& boxes, const uint32_t node_index, const uint32_t first, const uint32_t count)
+    {
+        Box box      = boxes[m_indices[first]];
+        Box centroid = Box{centroid_of(box), centroid_of(box)};
+        for (uint32_t i = first + 1; i < first + count; ++i) {
+            const Box& triangle_box = boxes[m_indices[i]];
+            const GEO::vec3f c = centroid_of(triangle_box);
+            box.include(triangle_box);
+            centroid.include(Box{c, c});
+        }
+        m_nodes[node_index].box = box;
+
+        // Depth stays below the query stack size: every split halves the
+        // range, so depth is log2(count / c_leaf_size) + 1.
+        if (count <= c_leaf_size) {
+            m_nodes[node_index].first = first;
+            m_nodes[node_index].count = count;
+            return;
+        }
+
+        const GEO::vec3f extent = centroid.max - centroid.min;
+        const int axis = ((extent.x >= extent.y) && (extent.x >= extent.z)) ? 0 : (extent.y >= extent.z) ? 1 : 2;
+        const uint32_t half = count / 2;
+        std::nth_element(
+            m_indices.begin() + first,
+            m_indices.begin() + first + half,
+            m_indices.begin() + first + count,
+            [&boxes, axis](const uint32_t lhs, const uint32_t rhs) {
+                return centroid_of(boxes[lhs])[axis] < centroid_of(boxes[rhs])[axis];
+            }
+        );
+
+        const uint32_t left = static_cast<uint32_t>(m_nodes.size());
+        m_nodes[node_index].left = left;
+        m_nodes.push_back(Node{});
+        m_nodes.push_back(Node{});
+        build(boxes, left,     first,        half);
+        build(boxes, left + 1, first + half, count - half);
+    }
+
+    [[nodiscard]] static auto centroid_of(const Box& box) -> GEO::vec3f
+    {
+        return 0.5f * (box.min + box.max);
+    }
+
+    std::vector<Node>     m_nodes;
+    std::vector<uint32_t> m_indices;
+};
 
-auto has_self_intersections(const GEO::Mesh& mesh) -> bool
+auto collect_triangles(const GEO::Mesh& mesh) -> std::vector<Triangle>
 {
     // Triangulate all facets using fan triangulation and collect triangles
     std::vector<Triangle> triangles;
@@ -166,22 +321,161 @@ auto has_self_intersections(const GEO::Mesh& mesh) -> bool
             triangles.push_back(tri);
         }
     }
+    return triangles;
+}
 
-    // O(n^2) pair-wise triangle intersection test
-    const std::size_t tri_count = triangles.size();
-    for (std::size_t i = 0; i < tri_count; ++i) {
-        for (std::size_t j = i + 1; j < tri_count; ++j) {
-            // Skip triangles from the same facet
-            if (triangles[i].facet_index == triangles[j].facet_index) {
-                continue;
+// Triangles per task when the test is split over an executor, and the
+// smallest triangle count worth splitting.
+constexpr std::size_t c_range_size          = 256;
+constexpr std::size_t c_min_parallel_count = 1024;
+
+// Tests every triangle pair (i, j), i < j, of different facets once, for i
+// in [begin, end). on_pair(i, j) is called for intersecting pairs; the test
+// stops early once stop is set.
+class Pair_tester
+{
+public:
+    Pair_tester(const std::vector<Triangle>& triangles, const Self_intersection_method method)
+        : m_triangles{triangles}
+        , m_method   {method}
+    {
+        if (m_method == Self_intersection_method::bvh) {
+            m_boxes.reserve(triangles.size());
+            for (const Triangle& triangle : triangles) {
+                m_boxes.push_back(get_padded_box(triangle));
             }
-            if (triangles_intersect(triangles[i], triangles[j])) {
-                return true;
+            m_bvh = std::make_unique<Triangle_bvh>(m_boxes);
+        }
+    }
+
+    template <typename On_pair>
+    void test_range(const std::size_t begin, const std::size_t end, const std::atomic<bool>& stop, On_pair&& on_pair) const
+    {
+        const std::size_t triangle_count = m_triangles.size();
+        for (std::size_t i = begin; i < end; ++i) {
+            if (stop.load(std::memory_order_relaxed)) {
+                return;
+            }
+            const Triangle& a = m_triangles[i];
+            const auto test_pair = [&](const std::size_t j) {
+                const Triangle& b = m_triangles[j];
+                // Skip triangles from the same facet
+                if (a.facet_index == b.facet_index) {
+                    return;
+                }
+                if (triangles_intersect(a, b)) {
+                    on_pair(i, j);
+                }
+            };
+            if (m_method == Self_intersection_method::brute_force) {
+                for (std::size_t j = i + 1; j < triangle_count; ++j) {
+                    test_pair(j);
+                }
+            } else {
+                m_bvh->query(m_boxes[i], [&](const uint32_t j) {
+                    if (j > i) {
+                        test_pair(j);
+                    }
+                });
             }
         }
     }
 
-    return false;
+private:
+    const std::vector<Triangle>&  m_triangles;
+    Self_intersection_method      m_method;
+    std::vector<Box>              m_boxes;
+    std::unique_ptr<Triangle_bvh> m_bvh;
+};
+
+// Calls range_function(range_index, begin, end) over ranges covering
+// [0, count), on the executor when one is given and count is large enough.
+template <typename Range_function>
+void for_each_range(tf::Executor* const executor, const std::size_t count, Range_function&& range_function)
+{
+    const std::size_t range_count = (count + c_range_size - 1) / c_range_size;
+    if ((executor == nullptr) || (count < c_min_parallel_count)) {
+        for (std::size_t range = 0; range < range_count; ++range) {
+            range_function(range, range * c_range_size, std::min(count, (range + 1) * c_range_size));
+        }
+        return;
+    }
+    tf::Taskflow taskflow;
+    taskflow.for_each_index(
+        std::size_t{0},
+        range_count,
+        std::size_t{1},
+        [&](const std::size_t range) {
+            range_function(range, range * c_range_size, std::min(count, (range + 1) * c_range_size));
+        }
+    );
+    if (executor->this_worker_id() >= 0) {
+        executor->corun(taskflow);
+    } else {
+        executor->run(taskflow).wait();
+    }
+}
+
+} // anonymous namespace
+
+auto has_self_intersections(const GEO::Mesh& mesh, const Self_intersection_settings& settings) -> bool
+{
+    ERHE_PROFILE_FUNCTION();
+
+    const std::vector<Triangle> triangles = collect_triangles(mesh);
+    const Pair_tester           tester{triangles, settings.method};
+
+    std::atomic<bool> found{false};
+    for_each_range(
+        settings.executor,
+        triangles.size(),
+        [&](const std::size_t, const std::size_t begin, const std::size_t end) {
+            tester.test_range(begin, end, found, [&found](const std::size_t, const std::size_t) {
+                found.store(true, std::memory_order_relaxed);
+            });
+        }
+    );
+    return found.load();
+}
+
+auto find_self_intersections(const GEO::Mesh& mesh, const Self_intersection_settings& settings) -> std::vector<Self_intersection>
+{
+    ERHE_PROFILE_FUNCTION();
+
+    const std::vector<Triangle> triangles = collect_triangles(mesh);
+    const Pair_tester           tester{triangles, settings.method};
+
+    // One output vector per range: no sharing between tasks, and the merge
+    // below does not depend on task scheduling.
+    const std::size_t range_count = (triangles.size() + c_range_size - 1) / c_range_size;
+    std::vector<std::vector<Self_intersection>> range_results(range_count);
+    const std::atomic<bool> never_stop{false};
+    for_each_range(
+        settings.executor,
+        triangles.size(),
+        [&](const std::size_t range, const std::size_t begin, const std::size_t end) {
+            std::vector<Self_intersection>& result = range_results[range];
+            tester.test_range(begin, end, never_stop, [&](const std::size_t i, const std::size_t j) {
+                const GEO::index_t facet_i = triangles[i].facet_index;
+                const GEO::index_t facet_j = triangles[j].facet_index;
+                result.push_back(Self_intersection{std::min(facet_i, facet_j), std::max(facet_i, facet_j)});
+            });
+        }
+    );
+
+    std::vector<Self_intersection> intersections;
+    for (const std::vector<Self_intersection>& result : range_results) {
+        intersections.insert(intersections.end(), result.begin(), result.end());
+    }
+    std::sort(
+        intersections.begin(),
+        intersections.end(),
+        [](const Self_intersection& lhs, const Self_intersection& rhs) {
+            return (lhs.facet_a != rhs.facet_a) ? (lhs.facet_a < rhs.facet_a) : (lhs.facet_b < rhs.facet_b);
+        }
+    );
+    intersections.erase(std::unique(intersections.begin(), intersections.end()), intersections.end());
+    return intersections;
 }
 
 } // namespace erhe::geometry
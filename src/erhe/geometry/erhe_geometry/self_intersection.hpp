@@ -1,16 +1,54 @@
 #pragma once
 
+#include <geogram/basic/numeric.h>
+
+#include <vector>
+
 namespace GEO { class Mesh; }
+namespace tf  { class Executor; }
 
 namespace erhe::geometry {
 
+enum class Self_intersection_method : unsigned int {
+    // Every triangle pair is tested. Kept as the reference for verifying the
+    // accelerated path.
+    brute_force = 0,
+    // Triangle bounding boxes in a BVH select the candidate pairs. Boxes are
+    // padded to cover the narrow phase tolerances, so the reported pairs are
+    // the same as with brute_force.
+    bvh         = 1
+};
+
+class Self_intersection_settings
+{
+public:
+    Self_intersection_method method  {Self_intersection_method::bvh};
+    // When set, the triangles are split in ranges and tested on this
+    // executor. The calling thread waits (or coruns when it is a worker of
+    // the executor).
+    tf::Executor*            executor{nullptr};
+};
+
+// A pair of intersecting non-adjacent facets, facet_a < facet_b.
+class Self_intersection
+{
+public:
+    GEO::index_t facet_a;
+    GEO::index_t facet_b;
+
+    auto operator==(const Self_intersection& other) const -> bool = default;
+};
+
 // Checks if any two non-adjacent facets of the mesh intersect.
 // Triangulates facets internally (fan triangulation) for the test.
 // Returns true if any self-intersection is found.
 //
 // This is a generic mesh quality check that can be used after any
-// geometry operation. Uses O(n^2) pair-wise triangle testing, so
-// it is suitable for validation and testing, not real-time use.
-auto has_self_intersections(const GEO::Mesh& mesh) -> bool;
+// geometry operation.
+auto has_self_intersections(const GEO::Mesh& mesh, const Self_intersection_settings& settings = {}) -> bool;
+
+// All intersecting facet pairs, sorted and without duplicates (a facet pair
+// is reported once even when several of their triangles intersect).
+auto find_self_intersections(const GEO::Mesh& mesh, const Self_intersection_settings& settings = {}) -> std::vector<Self_intersection>;
 
 } // namespace erhe::geometry
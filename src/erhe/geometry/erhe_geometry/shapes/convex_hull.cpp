@@ -1,4 +1,5 @@
 #include "erhe_geometry/shapes/convex_hull.hpp"
+#include "erhe_geometry/geometry.hpp"
 #include "erhe_geometry/geometry_log.hpp"
 
 #include <geogram/mesh/mesh.h>
@@ -9,6 +10,8 @@
 #include <geogram/basic/command_line.h>
 #include <geogram/delaunay/delaunay.h>
 
+#include <mutex>
+
 namespace erhe::geometry::shapes {
 
 void make_convex_hull(GEO::Mesh& mesh, const std::vector<glm::vec3>& in_points)
@@ -26,7 +29,9 @@ void make_convex_hull(GEO::Mesh& mesh, const std::vector<glm::vec3>& in_points)
 
     // Parallel 3D Delaunay ("PDEL"); create(dim, name) avoids the process-global
     // set_arg. Requires geogram built with -ffp-contract=off (see CMakeLists.txt
-    // and the twin call in erhe_geometry/geometry.cpp).
+    // and the twin call in erhe_geometry/geometry.cpp). Geogram algorithm -
+    // see geogram_lock().
+    const std::lock_guard<std::recursive_mutex> geogram_guard{geogram_lock()};
     GEO::Delaunay_var delaunay = GEO::Delaunay::create(3, "PDEL");
     delaunay->set_keeps_infinite(true); // keep "vertex at infinity" (makes it easier to find the convex hull
     delaunay->set_vertices(point_count, points.data());
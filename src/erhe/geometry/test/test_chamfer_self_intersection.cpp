@@ -9,6 +9,8 @@
 
 #include <gtest/gtest.h>
 
+#include <taskflow/taskflow.hpp>
+
 using erhe::geometry::get_pointf;
 using erhe::geometry::mesh_facet_centerf;
 using erhe::geometry::mesh_facet_normalf;
@@ -492,3 +494,86 @@ TEST(ChamferConvexity, DISABLED_Icosahedron_RepeatedChamfer)
 }
 
 // (Reference comparison and StraightSkel tests removed - chamfer2 was a dead end)
+
+//
+// === BVH broad phase and parallel narrow phase must match brute force ===
+//
+
+namespace {
+
+// Appends a copy of the mesh, moved by offset, to the mesh itself. With a
+// small offset every facet of the copy crosses facets of the original.
+void append_moved_copy(GEO::Mesh& mesh, const GEO::vec3f offset)
+{
+    const GEO::index_t vertex_count = mesh.vertices.nb();
+    const GEO::index_t facet_count  = mesh.facets.nb();
+    const GEO::index_t first_vertex = mesh.vertices.create_vertices(vertex_count);
+    for (GEO::index_t v = 0; v < vertex_count; ++v) {
+        erhe::geometry::set_pointf(mesh.vertices, first_vertex + v, erhe::geometry::get_pointf(mesh.vertices, v) + offset);
+    }
+    for (GEO::index_t f = 0; f < facet_count; ++f) {
+        const GEO::index_t corner_count = mesh.facets.nb_corners(f);
+        GEO::vector<GEO::index_t> vertices(corner_count);
+        for (GEO::index_t c = 0; c < corner_count; ++c) {
+            vertices[c] = first_vertex + mesh.facets.vertex(f, c);
+        }
+        mesh.facets.create_polygon(vertices);
+    }
+}
+
+void expect_methods_match(const GEO::Mesh& mesh, const bool expect_intersections)
+{
+    using namespace erhe::geometry;
+    const std::vector<Self_intersection> reference = find_self_intersections(mesh, {.method = Self_intersection_method::brute_force});
+    EXPECT_EQ(!reference.empty(), expect_intersections);
+
+    tf::Executor executor{4};
+    for (tf::Executor* const settings_executor : {static_cast<tf::Executor*>(nullptr), &executor}) {
+        for (const Self_intersection_method method : {Self_intersection_method::brute_force, Self_intersection_method::bvh}) {
+            const Self_intersection_settings settings{.method = method, .executor = settings_executor};
+            EXPECT_EQ(find_self_intersections(mesh, settings), reference);
+            EXPECT_EQ(has_self_intersections(mesh, settings), expect_intersections);
+        }
+    }
+}
+
+} // anonymous namespace
+
+TEST(SelfIntersectionBvh, ChamferedPlatonics_MatchBruteForce)
+{
+    for (const auto make_fn : {
+        erhe::geometry::shapes::make_tetrahedron,
+        erhe::geometry::shapes::make_cube,
+        erhe::geometry::shapes::make_octahedron,
+        erhe::geometry::shapes::make_dodecahedron,
+        erhe::geometry::shapes::make_icosahedron
+    }) {
+        std::unique_ptr<erhe::geometry::Geometry> solid     = make_platonic("solid", make_fn);
+        std::unique_ptr<erhe::geometry::Geometry> chamfered = apply_chamfer(*solid);
+        expect_methods_match(chamfered->get_mesh(), false);
+    }
+}
+
+TEST(SelfIntersectionBvh, Sphere_MatchBruteForce)
+{
+    // 48 x 32 sphere: enough triangles for the parallel split.
+    erhe::geometry::Geometry sphere{"sphere"};
+    erhe::geometry::shapes::make_sphere(sphere.get_mesh(), 1.0f, 48, 32);
+    sphere.process({.flags = process_flags});
+    expect_methods_match(sphere.get_mesh(), false);
+}
+
+TEST(SelfIntersectionBvh, OverlappingSpheres_MatchBruteForce)
+{
+    erhe::geometry::Geometry sphere{"spheres"};
+    erhe::geometry::shapes::make_sphere(sphere.get_mesh(), 1.0f, 48, 32);
+    append_moved_copy(sphere.get_mesh(), GEO::vec3f{0.5f, 0.25f, 0.125f});
+    expect_methods_match(sphere.get_mesh(), true);
+}
+
+TEST(SelfIntersectionBvh, OverlappingCubes_MatchBruteForce)
+{
+    std::unique_ptr<erhe::geometry::Geometry> cube = make_platonic("cube", erhe::geometry::shapes::make_cube);
+    append_moved_copy(cube->get_mesh(), GEO::vec3f{0.3f, 0.2f, 0.1f});
+    expect_methods_match(cube->get_mesh(), true);
+}
@@ -0,0 +1,118 @@
+// generate_lods(): every level must be a valid, closed triangle mesh over the
+// source facet corners, with fewer triangles and no smaller error than the
+// level before it, and attribute seams must stop the simplification.
+
+#include "erhe_geometry/geometry.hpp"
+#include "erhe_geometry/operation/generate_lods.hpp"
+#include "erhe_geometry/shapes/regular_polyhedron.hpp"
+#include "erhe_geometry/shapes/sphere.hpp"
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using erhe::geometry::Geometry;
+using erhe::geometry::operation::Lod_level;
+using erhe::geometry::operation::generate_lods;
+
+constexpr uint64_t process_flags =
+    Geometry::process_flag_connect |
+    Geometry::process_flag_build_edges |
+    Geometry::process_flag_compute_facet_centroids;
+
+auto make_sphere_geometry() -> std::unique_ptr<Geometry>
+{
+    std::unique_ptr<Geometry> geometry = std::make_unique<Geometry>("sphere");
+    erhe::geometry::shapes::make_sphere(geometry->get_mesh(), 1.0f, 32, 16);
+    geometry->process({.flags = process_flags});
+    return geometry;
+}
+
+auto get_triangle_count(const GEO::Mesh& mesh) -> std::size_t
+{
+    std::size_t count = 0;
+    for (GEO::index_t facet : mesh.facets) {
+        count += mesh.facets.nb_vertices(facet) - 2;
+    }
+    return count;
+}
+
+// Closed two-manifold check: every directed edge (by vertex) is used exactly
+// once, and its reverse is used too.
+void expect_valid_closed_level(const GEO::Mesh& mesh, const Lod_level& level, const std::size_t level_index)
+{
+    ASSERT_EQ(level.triangle_corners.size() % 3, 0u) << "level " << level_index;
+    std::map<std::pair<GEO::index_t, GEO::index_t>, int> edge_use_count;
+    for (std::size_t i = 0, end = level.triangle_corners.size(); i < end; i += 3) {
+        GEO::index_t v[3];
+        for (std::size_t j = 0; j < 3; ++j) {
+            const GEO::index_t corner = level.triangle_corners[i + j];
+            ASSERT_LT(corner, mesh.facet_corners.nb()) << "level " << level_index;
+            v[j] = mesh.facet_corners.vertex(corner);
+        }
+        EXPECT_NE(v[0], v[1]) << "degenerate triangle, level " << level_index;
+        EXPECT_NE(v[1], v[2]) << "degenerate triangle, level " << level_index;
+        EXPECT_NE(v[2], v[0]) << "degenerate triangle, level " << level_index;
+        for (std::size_t j = 0; j < 3; ++j) {
+            ++edge_use_count[std::make_pair(v[j], v[(j + 1) % 3])];
+        }
+    }
+    for (const auto& [edge, count] : edge_use_count) {
+        EXPECT_EQ(count, 1) << "level " << level_index;
+        EXPECT_TRUE(edge_use_count.contains(std::make_pair(edge.second, edge.first))) << "open edge, level " << level_index;
+    }
+}
+
+TEST(GenerateLods, SphereChainIsValidAndDecreasing)
+{
+    const std::unique_ptr<Geometry> geometry = make_sphere_geometry();
+    const GEO::Mesh& mesh = geometry->get_mesh();
+
+    const std::vector<Lod_level> lods = generate_lods(mesh);
+    ASSERT_FALSE(lods.empty());
+
+    std::size_t previous_triangle_count = get_triangle_count(mesh);
+    float       previous_error          = 0.0f;
+    for (std::size_t i = 0, end = lods.size(); i < end; ++i) {
+        const Lod_level& level = lods[i];
+        EXPECT_LT(level.triangle_count(), previous_triangle_count) << "level " << i;
+        EXPECT_GE(level.error, previous_error) << "level " << i;
+        expect_valid_closed_level(mesh, level, i);
+        previous_triangle_count = level.triangle_count();
+        previous_error          = level.error;
+    }
+    // The first level targets half of the source triangles.
+    EXPECT_LE(lods.front().triangle_count(), (get_triangle_count(mesh) * 3) / 4);
+}
+
+TEST(GenerateLods, MaxErrorLimitsChain)
+{
+    const std::unique_ptr<Geometry> geometry = make_sphere_geometry();
+    const GEO::Mesh& mesh = geometry->get_mesh();
+
+    const std::vector<Lod_level> unlimited = generate_lods(mesh);
+    const std::vector<Lod_level> limited   = generate_lods(mesh, {.max_error = 0.01f});
+    EXPECT_LE(limited.size(), unlimited.size());
+    for (const Lod_level& level : limited) {
+        EXPECT_LE(level.error, 0.01f);
+    }
+}
+
+TEST(GenerateLods, FlatShadedCubeIsNotSimplified)
+{
+    // Without normals the facet normal is used, so every cube vertex sits on
+    // a normal seam and must be kept.
+    std::unique_ptr<Geometry> geometry = std::make_unique<Geometry>("cube");
+    erhe::geometry::shapes::make_cube(geometry->get_mesh(), 1.0f);
+    geometry->process({.flags = process_flags});
+
+    const std::vector<Lod_level> lods = generate_lods(geometry->get_mesh());
+    EXPECT_TRUE(lods.empty());
+}
+
+} // anonymous namespace
@@ -0,0 +1,186 @@
+// Operations on different Geometry objects must run concurrently without a
+// caller lock (see erhe::geometry::geogram_lock()): runs the same operation
+// chain on many geometries serially and on a taskflow executor, and checks
+// that every parallel result matches its serial counterpart exactly, and
+// benchmarks how that scales with the worker count.
+
+#include "erhe_benchmark/benchmark.hpp"
+#include "erhe_geometry/geometry.hpp"
+#include "erhe_geometry/operation/conway/chamfer3.hpp"
+#include "erhe_geometry/operation/conway/kis.hpp"
+#include "erhe_geometry/operation/subdivision/catmull_clark_subdivision.hpp"
+#include "erhe_geometry/shapes/regular_polyhedron.hpp"
+#include "erhe_geometry/shapes/sphere.hpp"
+
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+
+#include <taskflow/taskflow.hpp>
+#include <taskflow/algorithm/for_each.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using erhe::benchmark::time_ms;
+using erhe::geometry::Geometry;
+
+constexpr uint64_t process_flags =
+    Geometry::process_flag_connect |
+    Geometry::process_flag_build_edges |
+    Geometry::process_flag_compute_facet_centroids |
+    Geometry::process_flag_compute_smooth_vertex_normals |
+    Geometry::process_flag_generate_facet_texture_coordinates;
+
+// What the comparison looks at: topology counts and every vertex position,
+// bit exact, of both the operation result and its convex hull.
+class Result
+{
+public:
+    GEO::index_t            facet_count      {0};
+    GEO::index_t            corner_count     {0};
+    std::vector<GEO::vec3f> positions;
+    GEO::index_t            hull_facet_count {0};
+    GEO::index_t            hull_vertex_count{0};
+};
+
+auto make_source(const std::size_t i) -> std::unique_ptr<Geometry>
+{
+    std::unique_ptr<Geometry> geometry = std::make_unique<Geometry>("source");
+    GEO::Mesh& mesh = geometry->get_mesh();
+    switch (i % 4) {
+        case 0:  erhe::geometry::shapes::make_cube       (mesh, 1.0f); break;
+        case 1:  erhe::geometry::shapes::make_icosahedron(mesh, 1.0f); break;
+        case 2:  erhe::geometry::shapes::make_dodecahedron(mesh, 1.0f); break;
+        default: erhe::geometry::shapes::make_sphere(mesh, 1.0f, 8 + static_cast<unsigned int>(i % 5), 6); break;
+    }
+    geometry->process({.flags = process_flags});
+    return geometry;
+}
+
+// Subdivision, Conway operators and process() (all mesh-local), then a
+// convex hull of the result.
+auto run_chain(const Geometry& source, const int subdivision_count) -> Result
+{
+    std::unique_ptr<Geometry> current = std::make_unique<Geometry>("kis");
+    erhe::geometry::operation::kis(source, *current, 0.1f);
+    for (int i = 0; i < subdivision_count; ++i) {
+        std::unique_ptr<Geometry> next = std::make_unique<Geometry>("catmull_clark");
+        erhe::geometry::operation::catmull_clark_subdivision(*current, *next, nullptr, nullptr, process_flags, process_flags);
+        current = std::move(next);
+    }
+    std::unique_ptr<Geometry> chamfered = std::make_unique<Geometry>("chamfer");
+    erhe::geometry::operation::chamfer3(*current, *chamfered);
+    chamfered->process({.flags = process_flags | Geometry::process_flag_generate_tangents});
+
+    const GEO::Mesh& mesh = chamfered->get_mesh();
+    Result result;
+    result.facet_count  = mesh.facets.nb();
+    result.corner_count = mesh.facet_corners.nb();
+    result.positions.reserve(mesh.vertices.nb());
+    for (GEO::index_t vertex : mesh.vertices) {
+        result.positions.push_back(erhe::geometry::get_pointf(mesh.vertices, vertex));
+    }
+
+    GEO::Mesh hull;
+    if (erhe::geometry::make_convex_hull(mesh, hull)) {
+        result.hull_facet_count  = hull.facets.nb();
+        result.hull_vertex_count = hull.vertices.nb();
+    }
+    return result;
+}
+
+void expect_same(const Result& serial, const Result& parallel, const std::size_t i)
+{
+    EXPECT_EQ(serial.facet_count,       parallel.facet_count      ) << "geometry " << i;
+    EXPECT_EQ(serial.corner_count,      parallel.corner_count     ) << "geometry " << i;
+    EXPECT_EQ(serial.hull_facet_count,  parallel.hull_facet_count ) << "geometry " << i;
+    EXPECT_EQ(serial.hull_vertex_count, parallel.hull_vertex_count) << "geometry " << i;
+    ASSERT_EQ(serial.positions.size(), parallel.positions.size()) << "geometry " << i;
+    for (std::size_t v = 0, end = serial.positions.size(); v < end; ++v) {
+        ASSERT_EQ(serial.positions[v].x, parallel.positions[v].x) << "geometry " << i << " vertex " << v;
+        ASSERT_EQ(serial.positions[v].y, parallel.positions[v].y) << "geometry " << i << " vertex " << v;
+        ASSERT_EQ(serial.positions[v].z, parallel.positions[v].z) << "geometry " << i << " vertex " << v;
+    }
+}
+
+class Workload
+{
+public:
+    Workload(const std::size_t geometry_count, const int subdivision_count)
+        : subdivision_count{subdivision_count}
+    {
+        for (std::size_t i = 0; i < geometry_count; ++i) {
+            sources.push_back(make_source(i));
+        }
+    }
+
+    void run_serial(std::vector<Result>& results) const
+    {
+        results.resize(sources.size());
+        for (std::size_t i = 0, end = sources.size(); i < end; ++i) {
+            results[i] = run_chain(*sources[i], subdivision_count);
+        }
+    }
+
+    void run_parallel(tf::Executor& executor, std::vector<Result>& results) const
+    {
+        results.resize(sources.size());
+        tf::Taskflow taskflow;
+        taskflow.for_each_index(
+            std::size_t{0},
+            sources.size(),
+            std::size_t{1},
+            [this, &results](const std::size_t i) {
+                results[i] = run_chain(*sources[i], subdivision_count);
+            }
+        );
+        executor.run(taskflow).wait();
+    }
+
+    int                                    subdivision_count;
+    std::vector<std::unique_ptr<Geometry>> sources;
+};
+
+TEST(GeometryConcurrency, ParallelOperationsMatchSerial)
+{
+    const Workload workload{24, 1};
+
+    std::vector<Result> serial;
+    workload.run_serial(serial);
+
+    tf::Executor executor{4};
+    for (int repeat = 0; repeat < 3; ++repeat) {
+        std::vector<Result> parallel;
+        workload.run_parallel(executor, parallel);
+        for (std::size_t i = 0, end = serial.size(); i < end; ++i) {
+            expect_same(serial[i], parallel[i], i);
+        }
+    }
+}
+
+ERHE_BENCHMARK(GeometryConcurrency, scaling)
+{
+    const Workload workload{64, 2};
+
+    std::vector<Result> serial;
+    const double serial_ms = time_ms([&]() { workload.run_serial(serial); });
+
+    const std::size_t max_workers = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    fmt::print("\n{:>8} {:>12} {:>9}\n", "workers", "ms", "speedup");
+    fmt::print("{:>8} {:>12.3f} {:>9.2f}\n", "serial", serial_ms, 1.0);
+    for (std::size_t worker_count = 1; worker_count <= max_workers; worker_count *= 2) {
+        tf::Executor        executor{worker_count};
+        std::vector<Result> parallel;
+        const double parallel_ms = time_ms([&]() { workload.run_parallel(executor, parallel); });
+        for (std::size_t i = 0, end = serial.size(); i < end; ++i) {
+            expect_same(serial[i], parallel[i], i);
+        }
+        fmt::print("{:>8} {:>12.3f} {:>9.2f}\n", worker_count, parallel_ms, (parallel_ms > 0.0) ? (serial_ms / parallel_ms) : 0.0);
+    }
+}
+
+} // anonymous namespace
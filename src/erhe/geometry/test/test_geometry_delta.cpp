@@ -0,0 +1,153 @@
+// Geometry_flat_data deltas (erhe_geometry/geometry_delta.hpp), used by the
+// editor undo history to store one side of a mesh operation relative to the
+// other. Applying a delta must reproduce the target bit-exact, and the
+// Geometry rebuilt from it must answer the connectivity queries like the
+// processed original.
+
+#include "erhe_geometry/geometry.hpp"
+#include "erhe_geometry/geometry_delta.hpp"
+#include "erhe_geometry/geometry_serialization.hpp"
+#include "erhe_geometry/operation/conway/subdivide.hpp"
+#include "erhe_geometry/shapes/torus.hpp"
+
+#include <geogram/mesh/mesh.h>
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <memory>
+
+namespace {
+
+using erhe::geometry::Geometry;
+using erhe::geometry::Geometry_attribute_record;
+using erhe::geometry::Geometry_flat_data;
+
+constexpr uint64_t k_process_flags =
+    Geometry::process_flag_connect                       |
+    Geometry::process_flag_build_edges                   |
+    Geometry::process_flag_compute_facet_centroids       |
+    Geometry::process_flag_compute_smooth_vertex_normals |
+    Geometry::process_flag_generate_facet_texture_coordinates;
+
+[[nodiscard]] auto make_processed_torus() -> std::shared_ptr<Geometry>
+{
+    std::shared_ptr<Geometry> geometry = std::make_shared<Geometry>("torus");
+    erhe::geometry::shapes::make_torus(geometry->get_mesh(), 1.0f, 0.25f, 24, 16);
+    geometry->process({.flags = k_process_flags});
+    return geometry;
+}
+
+[[nodiscard]] auto flat_data_equal(const Geometry_flat_data& lhs, const Geometry_flat_data& rhs) -> bool
+{
+    if (
+        (lhs.vertex_count         != rhs.vertex_count)         ||
+        (lhs.facet_count          != rhs.facet_count)          ||
+        (lhs.corner_count         != rhs.corner_count)         ||
+        (lhs.edge_count           != rhs.edge_count)           ||
+        (lhs.triangle_indices     != rhs.triangle_indices)     ||
+        (lhs.facet_vertex_counts  != rhs.facet_vertex_counts)  ||
+        (lhs.facet_vertex_indices != rhs.facet_vertex_indices) ||
+        (lhs.edge_vertex_indices  != rhs.edge_vertex_indices)  ||
+        (lhs.positions.size()     != rhs.positions.size())     ||
+        (lhs.attributes.size()    != rhs.attributes.size())
+    ) {
+        return false;
+    }
+    if (std::memcmp(lhs.positions.data(), rhs.positions.data(), lhs.positions.size() * sizeof(float)) != 0) {
+        return false;
+    }
+    for (std::size_t i = 0; i < lhs.attributes.size(); ++i) {
+        const Geometry_attribute_record& l = lhs.attributes[i];
+        const Geometry_attribute_record& r = rhs.attributes[i];
+        if (
+            (l.name != r.name) || (l.element != r.element) || (l.element_type != r.element_type) ||
+            (l.element_size != r.element_size) || (l.dimension != r.dimension) || (l.item_count != r.item_count) ||
+            (l.bytes != r.bytes)
+        ) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+TEST(GeometryDelta, VertexMoveIsSmallAndBitExact)
+{
+    const std::shared_ptr<Geometry> before = make_processed_torus();
+    const std::shared_ptr<Geometry> after  = make_processed_torus();
+    GEO::Mesh& mesh = after->get_mesh();
+    float* p = mesh.vertices.single_precision_point_ptr(5);
+    p[1] += 0.125f;
+
+    const Geometry_flat_data before_flat = erhe::geometry::geometry_to_flat_data(*before);
+    const Geometry_flat_data after_flat  = erhe::geometry::geometry_to_flat_data(*after);
+    const std::vector<std::byte> delta = erhe::geometry::make_geometry_delta(before_flat, after_flat);
+
+    // One position block differs; everything else is shared with the reference.
+    EXPECT_LT(delta.size(), erhe::geometry::get_flat_data_byte_count(*after) / 16);
+
+    Geometry_flat_data restored;
+    ASSERT_TRUE(erhe::geometry::apply_geometry_delta(before_flat, delta, restored));
+    EXPECT_TRUE(flat_data_equal(restored, after_flat));
+}
+
+TEST(GeometryDelta, TopologyChangeRoundTripsBothWays)
+{
+    const std::shared_ptr<Geometry> before = make_processed_torus();
+    std::shared_ptr<Geometry> after = std::make_shared<Geometry>("subdivided");
+    erhe::geometry::operation::subdivide(*before, *after);
+    after->process({.flags = k_process_flags});
+
+    const Geometry_flat_data before_flat = erhe::geometry::geometry_to_flat_data(*before);
+    const Geometry_flat_data after_flat  = erhe::geometry::geometry_to_flat_data(*after);
+
+    // Redo direction: after from before, and undo direction: before from after.
+    Geometry_flat_data restored_after;
+    ASSERT_TRUE(erhe::geometry::apply_geometry_delta(before_flat, erhe::geometry::make_geometry_delta(before_flat, after_flat), restored_after));
+    EXPECT_TRUE(flat_data_equal(restored_after, after_flat));
+    Geometry_flat_data restored_before;
+    ASSERT_TRUE(erhe::geometry::apply_geometry_delta(after_flat, erhe::geometry::make_geometry_delta(after_flat, before_flat), restored_before));
+    EXPECT_TRUE(flat_data_equal(restored_before, before_flat));
+}
+
+TEST(GeometryDelta, WrongReferenceAndTruncationAreRejected)
+{
+    const std::shared_ptr<Geometry> before = make_processed_torus();
+    const std::shared_ptr<Geometry> after  = make_processed_torus();
+    after->get_mesh().vertices.single_precision_point_ptr(0)[0] += 1.0f;
+
+    const Geometry_flat_data before_flat = erhe::geometry::geometry_to_flat_data(*before);
+    const Geometry_flat_data after_flat  = erhe::geometry::geometry_to_flat_data(*after);
+    const std::vector<std::byte> delta = erhe::geometry::make_geometry_delta(before_flat, after_flat);
+
+    Geometry_flat_data restored;
+    EXPECT_FALSE(erhe::geometry::apply_geometry_delta(after_flat, delta, restored));
+    EXPECT_FALSE(erhe::geometry::apply_geometry_delta(before_flat, std::span<const std::byte>{delta.data(), delta.size() - 1}, restored));
+}
+
+TEST(GeometryDelta, RestoredGeometryMatchesProcessedConnectivity)
+{
+    const std::shared_ptr<Geometry> original = make_processed_torus();
+    const Geometry_flat_data flat = erhe::geometry::geometry_to_flat_data(*original);
+    const std::shared_ptr<Geometry> restored = erhe::geometry::make_geometry_from_flat_data(flat, original->get_name());
+    ASSERT_TRUE(restored);
+    EXPECT_EQ(restored->get_name(), original->get_name());
+    EXPECT_TRUE(flat_data_equal(erhe::geometry::geometry_to_flat_data(*restored), flat));
+
+    const GEO::Mesh& mesh = original->get_mesh();
+    for (GEO::index_t vertex : mesh.vertices) {
+        EXPECT_EQ(restored->get_vertex_corners(vertex), original->get_vertex_corners(vertex));
+        EXPECT_EQ(restored->get_vertex_edges(vertex),   original->get_vertex_edges(vertex));
+    }
+    for (GEO::index_t corner : mesh.facet_corners) {
+        EXPECT_EQ(restored->get_corner_facet(corner), original->get_corner_facet(corner));
+    }
+    for (GEO::index_t edge : mesh.edges) {
+        EXPECT_EQ(restored->get_edge_facets(edge), original->get_edge_facets(edge));
+        const GEO::index_t a = mesh.edges.vertex(edge, 0);
+        const GEO::index_t b = mesh.edges.vertex(edge, 1);
+        EXPECT_EQ(restored->get_edge(a, b), original->get_edge(a, b));
+    }
+}
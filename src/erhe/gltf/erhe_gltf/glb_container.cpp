@@ -0,0 +1,171 @@
+#include "glb_container.hpp"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+
+namespace erhe::gltf {
+
+namespace {
+
+[[nodiscard]] auto read_u32_le(const std::span<const std::byte> bytes, const std::size_t offset) -> uint32_t
+{
+    const std::byte* p = bytes.data() + offset;
+    return
+        (static_cast<uint32_t>(p[0])      ) |
+        (static_cast<uint32_t>(p[1]) <<  8) |
+        (static_cast<uint32_t>(p[2]) << 16) |
+        (static_cast<uint32_t>(p[3]) << 24);
+}
+
+void write_u32_le(std::vector<std::byte>& out, const uint32_t value)
+{
+    out.push_back(static_cast<std::byte>( value        & 0xffu));
+    out.push_back(static_cast<std::byte>((value >>  8) & 0xffu));
+    out.push_back(static_cast<std::byte>((value >> 16) & 0xffu));
+    out.push_back(static_cast<std::byte>((value >> 24) & 0xffu));
+}
+
+[[nodiscard]] auto align_4(const std::size_t value) -> std::size_t
+{
+    return (value + 3) & ~std::size_t{3};
+}
+
+void set_u32_le(std::byte* out, const uint32_t value)
+{
+    out[0] = static_cast<std::byte>( value        & 0xffu);
+    out[1] = static_cast<std::byte>((value >>  8) & 0xffu);
+    out[2] = static_cast<std::byte>((value >> 16) & 0xffu);
+    out[3] = static_cast<std::byte>((value >> 24) & 0xffu);
+}
+
+[[nodiscard]] auto make_chunk_header(const std::size_t length, const uint32_t type) -> std::array<std::byte, 8>
+{
+    std::array<std::byte, 8> header{};
+    set_u32_le(header.data(),     static_cast<uint32_t>(length));
+    set_u32_le(header.data() + 4, type);
+    return header;
+}
+
+} // anonymous namespace
+
+auto split_glb(const std::span<const std::byte> bytes) -> std::optional<Glb_chunks>
+{
+    constexpr std::size_t header_size       = 12;
+    constexpr std::size_t chunk_header_size = 8;
+    if ((bytes.size() < header_size + chunk_header_size) || (read_u32_le(bytes, 0) != glb_magic) || (read_u32_le(bytes, 4) != 2)) {
+        return {};
+    }
+    // A length past the end of bytes is a truncated file
+    const std::size_t length = read_u32_le(bytes, 8);
+    if ((length < header_size + chunk_header_size) || (length > bytes.size())) {
+        return {};
+    }
+    Glb_chunks chunks;
+    std::size_t offset = header_size;
+    const std::size_t json_length = read_u32_le(bytes, offset);
+    if ((read_u32_le(bytes, offset + 4) != glb_chunk_json) || (json_length > length - offset - chunk_header_size)) {
+        return {};
+    }
+    chunks.json = bytes.subspan(offset + chunk_header_size, json_length);
+    offset += chunk_header_size + json_length;
+    if (length >= offset + chunk_header_size) {
+        const std::size_t bin_length = read_u32_le(bytes, offset);
+        if ((read_u32_le(bytes, offset + 4) != glb_chunk_bin) || (bin_length > length - offset - chunk_header_size)) {
+            return {};
+        }
+        chunks.bin = bytes.subspan(offset + chunk_header_size, bin_length);
+    }
+    return chunks;
+}
+
+auto make_json_only_glb(const std::span<const std::byte> json) -> std::vector<std::byte>
+{
+    constexpr uint32_t placeholder_length = 4;
+    const std::size_t  total_length       = 12 + 8 + json.size() + 8 + placeholder_length;
+    std::vector<std::byte> glb;
+    glb.reserve(total_length);
+    write_u32_le(glb, glb_magic);
+    write_u32_le(glb, 2);
+    write_u32_le(glb, static_cast<uint32_t>(total_length));
+    write_u32_le(glb, static_cast<uint32_t>(json.size()));
+    write_u32_le(glb, glb_chunk_json);
+    glb.insert(glb.end(), json.begin(), json.end());
+    write_u32_le(glb, placeholder_length);
+    write_u32_le(glb, glb_chunk_bin);
+    glb.resize(total_length, std::byte{0});
+    return glb;
+}
+
+auto get_glb_byte_count(const std::size_t json_byte_count, const std::size_t bin_byte_count) -> std::size_t
+{
+    std::size_t byte_count = 12 + 8 + align_4(json_byte_count);
+    if (bin_byte_count > 0) {
+        byte_count += 8 + align_4(bin_byte_count);
+    }
+    return byte_count;
+}
+
+auto write_glb(
+    const std::span<const std::byte>                       json,
+    const std::span<const Glb_bin_part>                    parts,
+    const std::size_t                                      bin_byte_count,
+    const std::function<bool(std::span<const std::byte>)>& write
+) -> bool
+{
+    const std::size_t total_length = get_glb_byte_count(json.size(), bin_byte_count);
+    if (total_length > std::numeric_limits<uint32_t>::max()) {
+        return false;
+    }
+    std::size_t end = 0;
+    for (const Glb_bin_part& part : parts) {
+        if ((part.offset < end) || (part.offset + part.bytes.size() > bin_byte_count)) {
+            return false;
+        }
+        end = part.offset + part.bytes.size();
+    }
+
+    std::array<std::byte, 12> header{};
+    set_u32_le(header.data(),     glb_magic);
+    set_u32_le(header.data() + 4, 2);
+    set_u32_le(header.data() + 8, static_cast<uint32_t>(total_length));
+    const std::array<std::byte, 8> json_header = make_chunk_header(align_4(json.size()), glb_chunk_json);
+    constexpr std::array<std::byte, 3> json_padding{std::byte{' '}, std::byte{' '}, std::byte{' '}};
+    if (
+        !write(header) ||
+        !write(json_header) ||
+        !write(json) ||
+        !write(std::span<const std::byte>{json_padding}.first(align_4(json.size()) - json.size()))
+    ) {
+        return false;
+    }
+    if (bin_byte_count == 0) {
+        return true;
+    }
+
+    const std::array<std::byte, 8> bin_header = make_chunk_header(align_4(bin_byte_count), glb_chunk_bin);
+    if (!write(bin_header)) {
+        return false;
+    }
+    static constexpr std::array<std::byte, 4096> zeros{};
+    const auto write_zeros = [&write](std::size_t count) -> bool {
+        while (count > 0) {
+            const std::size_t piece = std::min(count, zeros.size());
+            if (!write(std::span<const std::byte>{zeros.data(), piece})) {
+                return false;
+            }
+            count -= piece;
+        }
+        return true;
+    };
+    std::size_t offset = 0;
+    for (const Glb_bin_part& part : parts) {
+        if (!write_zeros(part.offset - offset) || (!part.bytes.empty() && !write(part.bytes))) {
+            return false;
+        }
+        offset = part.offset + part.bytes.size();
+    }
+    return write_zeros(align_4(bin_byte_count) - offset);
+}
+
+} // namespace erhe::gltf
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace erhe::gltf {
+
+// Binary glTF container (glTF 2.0 spec, "GLB File Format Specification"):
+// a 12 byte header (magic, version, length) followed by a JSON chunk and an
+// optional BIN chunk, each with an 8 byte (length, type) chunk header. All
+// values are little endian.
+class Glb_chunks
+{
+public:
+    std::span<const std::byte> json;
+    std::span<const std::byte> bin;
+};
+
+constexpr uint32_t glb_magic      = 0x46546C67u; // "glTF"
+constexpr uint32_t glb_chunk_json = 0x4E4F534Au; // "JSON"
+constexpr uint32_t glb_chunk_bin  = 0x004E4942u; // "BIN\0"
+
+// Views of the chunks of bytes, or nullopt when bytes is not a well formed
+// GLB (a .gltf JSON file, or a broken GLB - which fastgltf then reports in
+// detail). The header length may be less than bytes.size() (trailing bytes
+// are ignored), never more.
+[[nodiscard]] auto split_glb(std::span<const std::byte> bytes) -> std::optional<Glb_chunks>;
+
+// A GLB holding only the JSON chunk of the original and a 4 byte
+// placeholder BIN chunk. fastgltf copies the BIN chunk of what it is given
+// into the heap before returning the asset; handing it this stand-in keeps
+// that copy at 4 bytes, and parse_gltf() then points buffer 0 at the real
+// BIN chunk in place. (The placeholder cannot be empty: fastgltf treats a
+// zero length BIN chunk as absent and then rejects buffer 0 for having no
+// uri.)
+[[nodiscard]] auto make_json_only_glb(std::span<const std::byte> json) -> std::vector<std::byte>;
+
+// One piece of a BIN chunk written by write_glb(): bytes placed at offset
+// from the start of the chunk.
+class Glb_bin_part
+{
+public:
+    std::size_t                offset{0};
+    std::span<const std::byte> bytes;
+};
+
+// Size of the GLB write_glb() produces for a JSON chunk of json_byte_count
+// and a BIN chunk of bin_byte_count bytes, before padding.
+[[nodiscard]] auto get_glb_byte_count(std::size_t json_byte_count, std::size_t bin_byte_count) -> std::size_t;
+
+// Writes a GLB to write in consecutive pieces, without assembling it in
+// memory: header, the JSON chunk padded with spaces, and, when
+// bin_byte_count is not 0, a BIN chunk of bin_byte_count bytes padded with
+// zeros, with parts at their offsets and zeros in the gaps. parts must be
+// sorted by offset, must not overlap and must end within bin_byte_count.
+// Returns false without writing anything when parts break those rules or
+// the file would not fit the 32 bit GLB length, and stops and returns false
+// at the first write that returns false.
+[[nodiscard]] auto write_glb(
+    std::span<const std::byte>                             json,
+    std::span<const Glb_bin_part>                          parts,
+    std::size_t                                            bin_byte_count,
+    const std::function<bool(std::span<const std::byte>)>& write
+) -> bool;
+
+} // namespace erhe::gltf
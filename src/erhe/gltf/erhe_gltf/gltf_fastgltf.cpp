@@ -1,13 +1,16 @@
 // #define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_TRACE
 
 #include "gltf_fastgltf.hpp"
+#include "glb_container.hpp"
 #include "gltf_item_flags.hpp"
 #include "gltf_log.hpp"
+#include "image_cache.hpp"
 #include "image_transfer.hpp"
 
 #include "erhe_buffer/ibuffer.hpp"
 #include "erhe_dataformat/vertex_format.hpp"
 #include "erhe_file/file.hpp"
+#include "erhe_file/mapped_file.hpp"
 #include "erhe_geometry/geometry.hpp"
 #include "erhe_geometry/geometry_serialization.hpp"
 #include "erhe_graphics/device.hpp"
@@ -48,8 +51,10 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cstdint>
 #include <cstring>
 #include <filesystem>
+#include <fstream>
 #include <future>
 #include <limits>
 #include <optional>
@@ -58,6 +63,7 @@
 #include <sstream>
 #include <string_view>
 #include <string>
+#include <system_error>
 #include <unordered_set>
 #include <variant>
 #include <vector>
@@ -902,6 +908,41 @@ namespace {
     return directory;
 }
 
+// Bytes of a loaded buffer: a heap copy made by fastgltf (data: URI, or
+// every buffer when not memory mapping) or a view into a memory mapping /
+// the caller's glb_data (sources::ByteView, see parse_gltf()). Empty when
+// the buffer is not loaded.
+[[nodiscard]] auto get_buffer_bytes(const fastgltf::Buffer& buffer) -> std::span<const std::byte>
+{
+    if (const fastgltf::sources::Array* array = std::get_if<fastgltf::sources::Array>(&buffer.data)) {
+        return std::span<const std::byte>{array->bytes.data(), array->bytes.size()};
+    }
+    if (const fastgltf::sources::Vector* vector = std::get_if<fastgltf::sources::Vector>(&buffer.data)) {
+        return std::span<const std::byte>{vector->bytes.data(), vector->bytes.size()};
+    }
+    if (const fastgltf::sources::ByteView* byte_view = std::get_if<fastgltf::sources::ByteView>(&buffer.data)) {
+        return std::span<const std::byte>{byte_view->bytes.data(), byte_view->bytes.size()};
+    }
+    return {};
+}
+
+// Empty when the buffer is not loaded or the view does not fit in it.
+[[nodiscard]] auto get_buffer_view_bytes(const fastgltf::Asset& asset, const std::size_t buffer_view_index) -> std::span<const std::byte>
+{
+    if (buffer_view_index >= asset.bufferViews.size()) {
+        return {};
+    }
+    const fastgltf::BufferView& buffer_view = asset.bufferViews[buffer_view_index];
+    if (buffer_view.bufferIndex >= asset.buffers.size()) {
+        return {};
+    }
+    const std::span<const std::byte> buffer_bytes = get_buffer_bytes(asset.buffers[buffer_view.bufferIndex]);
+    if ((buffer_view.byteOffset > buffer_bytes.size()) || (buffer_view.byteLength > (buffer_bytes.size() - buffer_view.byteOffset))) {
+        return {};
+    }
+    return buffer_bytes.subspan(buffer_view.byteOffset, buffer_view.byteLength);
+}
+
 } // namespace
 
 class Gltf_parser
@@ -954,6 +995,35 @@ public:
         }
     }
 
+    // Buffers viewed in place from a memory mapping fault their pages in on
+    // first touch; ask for the pages of a view up front, so a decode task
+    // does not stall once per page. Heap buffers are already resident.
+    void prefetch_buffer_view(const std::size_t buffer_view_index) const
+    {
+        if (buffer_view_index >= m_asset->bufferViews.size()) {
+            return;
+        }
+        const fastgltf::BufferView& buffer_view = m_asset->bufferViews[buffer_view_index];
+        if (
+            (buffer_view.bufferIndex >= m_asset->buffers.size()) ||
+            !std::holds_alternative<fastgltf::sources::ByteView>(m_asset->buffers[buffer_view.bufferIndex].data)
+        ) {
+            return;
+        }
+        erhe::file::Mapped_file::prefetch(get_buffer_view_bytes(m_asset.get(), buffer_view_index));
+    }
+
+    void prefetch_accessor(const std::size_t accessor_index) const
+    {
+        if (accessor_index >= m_asset->accessors.size()) {
+            return;
+        }
+        const fastgltf::Accessor& accessor = m_asset->accessors[accessor_index];
+        if (accessor.bufferViewIndex.has_value()) {
+            prefetch_buffer_view(accessor.bufferViewIndex.value());
+        }
+    }
+
     void parse_and_build()
     {
         ERHE_PROFILE_FUNCTION();
@@ -1327,6 +1397,7 @@ private:
         const fastgltf::Image& image = m_asset->images[image_index];
         decoded.name = safe_resource_name(image.name, "image", image_index);
 
+        std::optional<Compressed_image_cache_key> cache_miss_key{};
         std::visit(
             fastgltf::visitor {
                 [&](auto& arg) {
@@ -1334,46 +1405,19 @@ private:
                     log_gltf->error("Image '{}': unsupported image source", decoded.name);
                 },
                 [&](const fastgltf::sources::BufferView& buffer_view_source) {
-                    const fastgltf::BufferView& buffer_view = m_asset->bufferViews[buffer_view_source.bufferViewIndex];
-                    const fastgltf::Buffer&     buffer      = m_asset->buffers.at(buffer_view.bufferIndex);
-                    const fastgltf::sources::Array* array_source = std::get_if<fastgltf::sources::Array>(&buffer.data);
-                    if (array_source == nullptr) {
+                    const std::span<const std::byte> encoded_bytes = get_buffer_view_bytes(m_asset.get(), buffer_view_source.bufferViewIndex);
+                    if (encoded_bytes.empty()) {
                         log_gltf->error("Image '{}': buffer view source buffer is not loaded", decoded.name);
                         return;
                     }
-                    const std::span<const std::uint8_t> image_encoded_buffer_view{
-                        reinterpret_cast<const std::uint8_t*>(array_source->bytes.data()) + buffer_view.byteOffset,
-                        buffer_view.byteLength
-                    };
-                    erhe::graphics::Image_loader loader;
-                    if (!loader.open(image_encoded_buffer_view, decoded.info, linear, m_transcode_format_preference)) {
-                        log_gltf->error("Failed to parse image from buffer view '{}'", decoded.name);
-                        return;
-                    }
-                    // TODO Handle depth > 1
-                    if (erhe::dataformat::is_block_compressed(decoded.info.format) || (decoded.info.level_count > 1)) {
-                        // Container formats (DDS) carry a tightly packed mip chain
-                        decoded.pixels.resize(
-                            erhe::dataformat::get_mip_chain_byte_count(
-                                decoded.info.format,
-                                static_cast<std::size_t>(decoded.info.width),
-                                static_cast<std::size_t>(decoded.info.height),
-                                static_cast<std::size_t>(decoded.info.level_count)
-                            )
-                        );
-                    } else {
-                        ERHE_VERIFY(decoded.info.width * erhe::dataformat::get_format_size_bytes(decoded.info.format) == decoded.info.row_stride);
-                        decoded.pixels.resize(static_cast<std::size_t>(decoded.info.row_stride) * static_cast<std::size_t>(decoded.info.height));
-                    }
-                    decoded.ok = loader.load(std::span<std::uint8_t>{decoded.pixels.data(), decoded.pixels.size()});
-                    loader.close();
+                    prefetch_buffer_view(buffer_view_source.bufferViewIndex);
                     decoded.source_path = m_arguments.path;
+                    cache_miss_key = decode_encoded_image(decoded, encoded_bytes, linear);
                     if (decoded.ok) {
                         // Retain the encoded source stream for byte-exact
                         // re-embedding on export (phase 0).
-                        const std::byte* start = reinterpret_cast<const std::byte*>(array_source->bytes.data()) + buffer_view.byteOffset;
                         decoded.source = std::make_shared<Gltf_image_source>();
-                        decoded.source->encoded_bytes.assign(start, start + buffer_view.byteLength);
+                        decoded.source->encoded_bytes.assign(encoded_bytes.begin(), encoded_bytes.end());
                     }
                 },
                 [&](const fastgltf::sources::URI& uri) {
@@ -1387,35 +1431,20 @@ private:
                     if (!file_is_ok) {
                         return;
                     }
-                    erhe::graphics::Image_loader loader;
-                    if (!loader.open(image_path, decoded.info, linear, m_transcode_format_preference)) {
+                    // Read once: the same bytes are decoded, hashed for the
+                    // compressed image cache and retained for export.
+                    const std::optional<std::string> file_content = erhe::file::read("Gltf_parser::decode_image", image_path);
+                    if (!file_content.has_value() || file_content->empty()) {
                         return;
                     }
-                    // TODO Handle depth > 1
-                    if (erhe::dataformat::is_block_compressed(decoded.info.format) || (decoded.info.level_count > 1)) {
-                        // Container formats (DDS) carry a tightly packed mip chain
-                        decoded.pixels.resize(
-                            erhe::dataformat::get_mip_chain_byte_count(
-                                decoded.info.format,
-                                static_cast<std::size_t>(decoded.info.width),
-                                static_cast<std::size_t>(decoded.info.height),
-                                static_cast<std::size_t>(decoded.info.level_count)
-                            )
-                        );
-                    } else {
-                        ERHE_VERIFY(decoded.info.width * erhe::dataformat::get_format_size_bytes(decoded.info.format) == decoded.info.row_stride);
-                        decoded.pixels.resize(static_cast<std::size_t>(decoded.info.row_stride) * static_cast<std::size_t>(decoded.info.height));
-                    }
-                    decoded.ok = loader.load(std::span<std::uint8_t>{decoded.pixels.data(), decoded.pixels.size()});
-                    loader.close();
+                    const std::byte* start = reinterpret_cast<const std::byte*>(file_content->data());
+                    decoded.source = std::make_shared<Gltf_image_source>();
+                    decoded.source->encoded_bytes.assign(start, start + file_content->size());
                     decoded.source_path = image_path;
-                    if (decoded.ok) {
-                        const std::optional<std::string> file_content = erhe::file::read("gltf image source retention", image_path);
-                        if (file_content.has_value() && !file_content->empty()) {
-                            const std::byte* start = reinterpret_cast<const std::byte*>(file_content->data());
-                            decoded.source = std::make_shared<Gltf_image_source>();
-                            decoded.source->encoded_bytes.assign(start, start + file_content->size());
-                        }
+                    const std::vector<std::byte>& encoded_bytes = decoded.source->encoded_bytes;
+                    cache_miss_key = decode_encoded_image(decoded, std::span<const std::byte>{encoded_bytes.data(), encoded_bytes.size()}, linear);
+                    if (!decoded.ok) {
+                        decoded.source.reset();
                     }
                 }
             },
@@ -1424,10 +1453,73 @@ private:
 
         if (decoded.source) {
             decoded.source->mime_type = sniff_image_mime_type(decoded.source->encoded_bytes);
+            if (cache_miss_key.has_value() && decoded.ok) {
+                // The encode task shares ownership of the retained source
+                // stream instead of copying the decoded pixels: it decodes
+                // again on its own, so queued tasks cost the encoded size.
+                schedule_compressed_image_encode(
+                    m_arguments.executor,
+                    cache_miss_key.value(),
+                    std::shared_ptr<const std::vector<std::byte>>{decoded.source, &decoded.source->encoded_bytes}
+                );
+            }
         }
         return decoded;
     }
 
+    // Decodes one encoded image into decoded.info / decoded.pixels and sets
+    // decoded.ok. With the compressed image cache enabled and a BC7 capable
+    // device, a cached BC7 mip chain is used instead of decoding; on a miss
+    // the cache key is returned so the caller can schedule the encode once
+    // the source stream is retained.
+    [[nodiscard]] auto decode_encoded_image(
+        Gltf_decoded_image&              decoded,
+        const std::span<const std::byte> encoded_bytes,
+        const bool                       linear
+    ) -> std::optional<Compressed_image_cache_key>
+    {
+        std::optional<Compressed_image_cache_key> cache_key{};
+        if (
+            m_arguments.compressed_image_cache &&
+            (m_transcode_format_preference == erhe::graphics::Transcode_format_preference::bc7) &&
+            is_compressed_image_cache_candidate(encoded_bytes)
+        ) {
+            cache_key = make_compressed_image_cache_key(encoded_bytes, linear);
+            if (load_compressed_image(cache_key.value(), decoded.info, decoded.pixels)) {
+                decoded.ok = true;
+                return {};
+            }
+        }
+
+        const std::span<const std::uint8_t> image_encoded_buffer_view{
+            reinterpret_cast<const std::uint8_t*>(encoded_bytes.data()),
+            encoded_bytes.size()
+        };
+        erhe::graphics::Image_loader loader;
+        if (!loader.open(image_encoded_buffer_view, decoded.info, linear, m_transcode_format_preference)) {
+            log_gltf->error("Failed to parse image '{}'", decoded.name);
+            return {};
+        }
+        // TODO Handle depth > 1
+        if (erhe::dataformat::is_block_compressed(decoded.info.format) || (decoded.info.level_count > 1)) {
+            // Container formats (DDS) carry a tightly packed mip chain
+            decoded.pixels.resize(
+                erhe::dataformat::get_mip_chain_byte_count(
+                    decoded.info.format,
+                    static_cast<std::size_t>(decoded.info.width),
+                    static_cast<std::size_t>(decoded.info.height),
+                    static_cast<std::size_t>(decoded.info.level_count)
+                )
+            );
+        } else {
+            ERHE_VERIFY(decoded.info.width * erhe::dataformat::get_format_size_bytes(decoded.info.format) == decoded.info.row_stride);
+            decoded.pixels.resize(static_cast<std::size_t>(decoded.info.row_stride) * static_cast<std::size_t>(decoded.info.height));
+        }
+        decoded.ok = loader.load(std::span<std::uint8_t>{decoded.pixels.data(), decoded.pixels.size()});
+        loader.close();
+        return decoded.ok ? cache_key : std::optional<Compressed_image_cache_key>{};
+    }
+
 
     // Decode every image referenced by a material texture slot, in parallel
     // executor tasks when enabled. No GPU object is created here - the
@@ -1938,6 +2030,11 @@ private:
             return;
         }
 
+        prefetch_accessor(primitive.indicesAccessor.value());
+        for (const fastgltf::Attribute& attribute : primitive.attributes) {
+            prefetch_accessor(attribute.accessorIndex);
+        }
+
         primitive_entry.triangle_soup = std::make_shared<erhe::primitive::Triangle_soup>();
         erhe::primitive::Triangle_soup& triangle_soup = *primitive_entry.triangle_soup.get();
 
@@ -2437,15 +2534,12 @@ private:
                     log_gltf->warn("ERHE_geometry: primitive '{}' attribute '{}' has an out-of-range buffer view", name, record.name);
                     return {};
                 }
-                const fastgltf::BufferView& buffer_view = m_asset->bufferViews[number_value];
-                const fastgltf::Buffer&     buffer      = m_asset->buffers.at(buffer_view.bufferIndex);
-                const auto* array_source = std::get_if<fastgltf::sources::Array>(&buffer.data);
-                if (array_source == nullptr) {
+                const std::span<const std::byte> view_bytes = get_buffer_view_bytes(m_asset.get(), static_cast<std::size_t>(number_value));
+                if (view_bytes.empty() && (m_asset->bufferViews[number_value].byteLength > 0)) {
                     log_gltf->warn("ERHE_geometry: primitive '{}' attribute '{}' buffer is not loaded", name, record.name);
                     return {};
                 }
-                const std::byte* start = reinterpret_cast<const std::byte*>(array_source->bytes.data()) + buffer_view.byteOffset;
-                record.bytes.assign(start, start + buffer_view.byteLength);
+                record.bytes.assign(view_bytes.begin(), view_bytes.end());
                 flat.attributes.push_back(std::move(record));
             }
         }
@@ -3352,9 +3446,35 @@ auto parse_gltf(const Gltf_parse_arguments& arguments) -> Gltf_data
     erhe::time::Timer timer{"parse_gltf"};
     timer.begin();
 
-    fastgltf::Expected<fastgltf::GltfDataBuffer> data = arguments.glb_data.empty()
-        ? fastgltf::GltfDataBuffer::FromPath(arguments.path)
-        : fastgltf::GltfDataBuffer::FromBytes(arguments.glb_data.data(), arguments.glb_data.size());
+    // The mappings are viewed in place by the asset's buffers, so they must
+    // outlive the parse below.
+    std::optional<erhe::file::Mapped_file> mapped_file;
+    std::vector<erhe::file::Mapped_file>   mapped_buffer_files;
+
+    // Only the JSON is read front to back. Buffer views are read in any
+    // order by the decode tasks, which prefetch each view before reading it,
+    // so the mapping gets no whole file advice (sequential advice would also
+    // let the kernel drop pages behind the JSON that are still to be read).
+    std::span<const std::byte> input_bytes = arguments.glb_data;
+    if (input_bytes.empty() && arguments.memory_map) {
+        mapped_file = erhe::file::Mapped_file::open("parse_gltf", arguments.path, erhe::file::Mapped_file::Access_pattern::normal);
+        if (mapped_file.has_value()) {
+            input_bytes = mapped_file->get_bytes();
+        }
+    }
+    const std::optional<Glb_chunks> glb_chunks = input_bytes.empty() ? std::optional<Glb_chunks>{} : split_glb(input_bytes);
+    std::vector<std::byte> json_only_glb;
+    if (glb_chunks.has_value()) {
+        erhe::file::Mapped_file::prefetch(glb_chunks->json);
+        json_only_glb = make_json_only_glb(glb_chunks->json);
+    } else if (mapped_file.has_value()) {
+        erhe::file::Mapped_file::prefetch(input_bytes); // .gltf: all JSON
+    }
+
+    fastgltf::Expected<fastgltf::GltfDataBuffer> data =
+        glb_chunks.has_value() ? fastgltf::GltfDataBuffer::FromBytes(json_only_glb.data(), json_only_glb.size()) :
+        !input_bytes.empty()   ? fastgltf::GltfDataBuffer::FromBytes(input_bytes.data(), input_bytes.size())     :
+                                 fastgltf::GltfDataBuffer::FromPath(arguments.path);
     if (data.error() != fastgltf::Error::None) {
         log_gltf->error("glTF load error: {}", fastgltf::getErrorMessage(data.error()));
         return {};
@@ -3540,16 +3660,71 @@ auto parse_gltf(const Gltf_parse_arguments& arguments) -> Gltf_data
         }
     );
 
+    // When memory mapping, external buffer files are mapped below instead
+    // of read into the heap by fastgltf. data: URIs are decoded either way.
     fastgltf::Expected<fastgltf::Asset> asset = fastgltf_parser.loadGltf(
         data.get(),
         gltf_base_directory(arguments.path),
-        fastgltf::Options::LoadExternalBuffers // TODO Consider | fastgltf::Options::DecomposeNodeMatrices
+        arguments.memory_map
+            ? fastgltf::Options::None
+            : fastgltf::Options::LoadExternalBuffers // TODO Consider | fastgltf::Options::DecomposeNodeMatrices
     );
     if (auto error = asset.error(); error != fastgltf::Error::None) {
         log_gltf->error("glTF parse error: {}", fastgltf::getErrorMessage(error));
         return {};
     }
 
+    for (std::size_t buffer_index = 0, end = asset->buffers.size(); buffer_index < end; ++buffer_index) {
+        fastgltf::Buffer& buffer = asset->buffers[buffer_index];
+
+        // The GLB BIN chunk: replace the placeholder with a view of the real
+        // chunk in the mapping (or in the caller's glb_data).
+        if ((buffer_index == 0) && glb_chunks.has_value() && std::holds_alternative<fastgltf::sources::Array>(buffer.data)) {
+            if (glb_chunks->bin.size() < buffer.byteLength) {
+                log_gltf->error("glTF GLB BIN chunk has {} bytes, buffer 0 declares {}", glb_chunks->bin.size(), buffer.byteLength);
+                return {};
+            }
+            buffer.data = fastgltf::sources::ByteView{
+                .bytes    = fastgltf::span<const std::byte>{glb_chunks->bin.data(), glb_chunks->bin.size()},
+                .mimeType = fastgltf::MimeType::GltfBuffer
+            };
+            continue;
+        }
+
+        const fastgltf::sources::URI* uri = std::get_if<fastgltf::sources::URI>(&buffer.data);
+        if ((uri == nullptr) || !uri->uri.isLocalPath()) {
+            continue;
+        }
+        const std::filesystem::path buffer_path = gltf_base_directory(arguments.path) / uri->uri.fspath();
+        const std::size_t           offset      = uri->fileByteOffset;
+        std::optional<erhe::file::Mapped_file> mapped_buffer_file = erhe::file::Mapped_file::open("parse_gltf buffer", buffer_path, erhe::file::Mapped_file::Access_pattern::normal);
+        if (mapped_buffer_file.has_value()) {
+            const std::span<const std::byte> file_bytes = mapped_buffer_file->get_bytes();
+            if ((offset > file_bytes.size()) || (buffer.byteLength > (file_bytes.size() - offset))) {
+                log_gltf->error("glTF buffer {} '{}' is shorter than its declared {} bytes", buffer_index, buffer_path.string(), buffer.byteLength);
+                return {};
+            }
+            buffer.data = fastgltf::sources::ByteView{
+                .bytes    = fastgltf::span<const std::byte>{file_bytes.data() + offset, buffer.byteLength},
+                .mimeType = fastgltf::MimeType::GltfBuffer
+            };
+            mapped_buffer_files.push_back(std::move(mapped_buffer_file.value()));
+            continue;
+        }
+
+        // Not mappable (an Android APK asset, for example): read it.
+        const std::optional<std::string> file_content = erhe::file::read("parse_gltf buffer", buffer_path);
+        if (!file_content.has_value() || (offset > file_content->size()) || (buffer.byteLength > (file_content->size() - offset))) {
+            log_gltf->error("glTF buffer {} '{}' could not be loaded", buffer_index, buffer_path.string());
+            return {};
+        }
+        const std::byte* start = reinterpret_cast<const std::byte*>(file_content->data()) + offset;
+        buffer.data = fastgltf::sources::Vector{
+            .bytes    = std::vector<std::byte>{start, start + buffer.byteLength},
+            .mimeType = fastgltf::MimeType::GltfBuffer
+        };
+    }
+
 
     Gltf_data result;
     Gltf_parser erhe_parser{std::move(asset), result, arguments};
@@ -4075,6 +4250,70 @@ auto scan_gltf(std::filesystem::path path) -> Gltf_scan
     return result;
 }
 
+using Export_byte_vector = decltype(fastgltf::sources::Vector::bytes);
+
+// Extensions write context: the ERHE_* extension members (raw JSON, keyed
+// by glTF index) served to the generic extensions write callback.
+class Gltf_export_extras
+{
+public:
+    std::string                                                asset_extensions;
+    std::string                                                scene_extensions;
+    std::unordered_map<std::size_t, std::string>               node_extensions;
+    std::unordered_map<std::size_t, std::string>               camera_extensions;
+    std::unordered_map<std::size_t, std::string>               material_extensions;
+    std::unordered_map<std::size_t, std::string>               mesh_extensions;
+    std::map<std::pair<std::size_t, std::size_t>, std::string> mesh_primitive_extensions;
+};
+
+// Output of the scene-reading export passes (see make_gltf_export_snapshot()).
+//
+// The single binary buffer of the final file is only planned here: the
+// buffer views already point into buffers[0] at their combined offsets and
+// buffers[0] declares the combined byte length, but its data stays in the
+// per-buffer byte vectors the passes produced. A GLB streams them into its
+// BIN chunk as they are (write_glb()); only a .gltf, which fastgltf writes
+// in one piece, has them combined by assemble_buffer() on the writing
+// thread.
+class Gltf_export_snapshot
+{
+public:
+    void assemble_buffer();
+
+    fastgltf::Asset                 asset;
+    Gltf_export_extras              extras;
+    std::vector<Export_byte_vector> buffer_parts;
+    std::vector<std::size_t>        buffer_part_offsets;
+    std::size_t                     buffer_byte_count{0};
+    bool                            binary           {true};
+    bool                            written          {false};
+};
+
+void Gltf_export_snapshot::assemble_buffer()
+{
+    ERHE_PROFILE_FUNCTION();
+
+    if (asset.buffers.empty()) {
+        return;
+    }
+    ERHE_VERIFY(buffer_parts.size() == buffer_part_offsets.size());
+
+    fastgltf::sources::Vector combined_buffer;
+    combined_buffer.bytes.resize(buffer_byte_count, std::byte{0});
+    for (std::size_t i = 0, end = buffer_parts.size(); i < end; ++i) {
+        Export_byte_vector& part = buffer_parts[i];
+        ERHE_VERIFY(buffer_part_offsets[i] + part.size() <= buffer_byte_count);
+        if (!part.empty()) {
+            std::memcpy(combined_buffer.bytes.data() + buffer_part_offsets[i], part.data(), part.size());
+        }
+        // Release each part once copied, so the peak stays near one copy.
+        part = Export_byte_vector{};
+    }
+    buffer_parts.clear();
+    buffer_part_offsets.clear();
+    asset.buffers.front().data = std::move(combined_buffer);
+}
+
 class Gltf_exporter
 {
 public:
@@ -4083,7 +4322,7 @@ public:
     {
     }
 
-    [[nodiscard]] auto export_gltf() -> std::string;
+    [[nodiscard]] auto make_snapshot() -> std::shared_ptr<Gltf_export_snapshot>;
 
 private:
     [[nodiscard]] static auto from_erhe(const erhe::scene::Trs_transform& erhe_trs_transform) -> fastgltf::TRS
@@ -6218,7 +6457,11 @@ private:
         }
     }
 
-    void combine_buffers()
+    // Plans the single binary buffer of the file: buffer views are moved
+    // to their offsets in buffer 0 and the source byte vectors are handed
+    // to the snapshot, which assembles them on the writing thread (see
+    // Gltf_export_snapshot).
+    void combine_buffers(Gltf_export_snapshot& snapshot)
     {
         // A material-only asset container can legitimately have no buffers
         // at all; combining would emit an invalid zero-length buffer entry.
@@ -6228,36 +6471,28 @@ private:
 
         validate_buffers();
 
-        fastgltf::sources::Vector combined_buffer;
-        std::vector<std::size_t> buffer_offsets;
-        buffer_offsets.reserve(m_gltf_asset.buffers.size());
+        std::size_t combined_buffer_size = 0;
+        snapshot.buffer_parts.reserve(m_gltf_asset.buffers.size());
+        snapshot.buffer_part_offsets.reserve(m_gltf_asset.buffers.size());
         for (fastgltf::Buffer& buffer : m_gltf_asset.buffers) {
-            const fastgltf::sources::Vector& byte_view = std::get<fastgltf::sources::Vector>(buffer.data);
-            std::span<const std::byte> source_span{byte_view.bytes.data(), byte_view.bytes.size()};
+            fastgltf::sources::Vector& byte_view = std::get<fastgltf::sources::Vector>(buffer.data);
 
             // Padding
-            std::size_t combined_buffer_size = combined_buffer.bytes.size();
-            while ((combined_buffer_size & 3) != 0) {
-                combined_buffer.bytes.push_back(std::byte{0});
-                ++combined_buffer_size;
-            }
-            buffer_offsets.push_back(combined_buffer_size);
-
-            combined_buffer.bytes.insert(
-                combined_buffer.bytes.end(),
-                source_span.begin(),
-                source_span.end()
-            );
+            combined_buffer_size = (combined_buffer_size + 3) & ~std::size_t{3};
+            snapshot.buffer_part_offsets.push_back(combined_buffer_size);
+            combined_buffer_size += byte_view.bytes.size();
+            snapshot.buffer_parts.push_back(std::move(byte_view.bytes));
         }
 
         for (fastgltf::BufferView& buffer_view : m_gltf_asset.bufferViews) {
             std::size_t original_buffer = buffer_view.bufferIndex;
             buffer_view.bufferIndex = 0;
-            buffer_view.byteOffset += buffer_offsets[original_buffer];
+            buffer_view.byteOffset += snapshot.buffer_part_offsets[original_buffer];
         }
 
         m_gltf_asset.buffers.clear();
-        m_gltf_asset.buffers.emplace_back(combined_buffer.bytes.size(), std::move(combined_buffer));
+        m_gltf_asset.buffers.emplace_back(combined_buffer_size, fastgltf::sources::Vector{});
+        snapshot.buffer_byte_count = combined_buffer_size;
 
         validate_buffers();
     }
@@ -6288,8 +6523,13 @@ private:
     }
 };
 
-auto Gltf_exporter::export_gltf() -> std::string
+auto Gltf_exporter::make_snapshot() -> std::shared_ptr<Gltf_export_snapshot>
 {
+    ERHE_PROFILE_FUNCTION();
+
+    std::shared_ptr<Gltf_export_snapshot> snapshot = std::make_shared<Gltf_export_snapshot>();
+    snapshot->binary = m_arguments.binary;
+
     m_gltf_asset.assetInfo = fastgltf::AssetInfo{
         .gltfVersion = "2.0",
         .minVersion  = "",
@@ -6353,27 +6593,14 @@ auto Gltf_exporter::export_gltf() -> std::string
         m_gltf_asset.extensionsUsed.emplace_back("KHR_texture_transform");
     }
 
-    combine_buffers();
+    combine_buffers(*snapshot);
 
     // After every pass that adds top-level objects or names (nodes, physics,
     // extra meshes, skins, animations, buffer combining): the uid pass needs
     // the complete identifier namespace of the final file.
     stamp_uids();
 
-    // Extensions write context: the ERHE_* extension members (raw JSON,
-    // keyed by glTF index) served to the generic extensions write callback.
-    class Export_extras_context
-    {
-    public:
-        std::string                                                asset_extensions;
-        std::string                                                scene_extensions;
-        std::unordered_map<std::size_t, std::string>               node_extensions;
-        std::unordered_map<std::size_t, std::string>               camera_extensions;
-        std::unordered_map<std::size_t, std::string>               material_extensions;
-        std::unordered_map<std::size_t, std::string>               mesh_extensions;
-        std::map<std::pair<std::size_t, std::size_t>, std::string> mesh_primitive_extensions;
-    };
-    Export_extras_context export_extras_context;
+    Gltf_export_extras& export_extras_context = snapshot->extras;
 
     // Resolve extension payloads from erhe objects to glTF indices; payloads
     // whose object did not end up in the export are skipped with a warning.
@@ -6500,11 +6727,41 @@ auto Gltf_exporter::export_gltf() -> std::string
         declare_extension_used(extension_name);
     }
 
+    snapshot->asset = std::move(m_gltf_asset);
+    return snapshot;
+}
+
+namespace {
+
+// Destination of serialize_gltf_export_snapshot(): begin() is called once
+// with the size of the whole file, then write() with consecutive pieces of
+// it. Either returning false aborts the export.
+class Gltf_export_output
+{
+public:
+    std::function<bool(std::size_t byte_count)>           begin;
+    std::function<bool(std::span<const std::byte> bytes)> write;
+};
+
+// Serializes a snapshot to output. Consumes the snapshot's buffer data.
+[[nodiscard]] auto serialize_gltf_export_snapshot(
+    Gltf_export_snapshot&     snapshot,
+    const Gltf_export_output& output
+) -> bool
+{
+    ERHE_PROFILE_FUNCTION();
+
+    if (snapshot.written) {
+        log_gltf->error("glTF export: snapshot already written");
+        return false;
+    }
+    snapshot.written = true;
+
     fastgltf::Exporter exporter{};
-    exporter.setUserPointer(&export_extras_context);
+    exporter.setUserPointer(&snapshot.extras);
     exporter.setExtensionsWriteCallback(
         [](std::size_t object_index, std::size_t sub_object_index, fastgltf::Category object_type, void* user_pointer) -> std::optional<std::string> {
-            const Export_extras_context* context = static_cast<const Export_extras_context*>(user_pointer);
+            const Gltf_export_extras* context = static_cast<const Gltf_export_extras*>(user_pointer);
             switch (object_type) {
                 case fastgltf::Category::Asset: {
                     if (!context->asset_extensions.empty()) {
@@ -6564,35 +6821,168 @@ auto Gltf_exporter::export_gltf() -> std::string
     // (doc/gltf-scene-roundtrip-plan.md phase 3); the extras remain parsed
     // for files written before the migration.
 
-    if (m_arguments.binary)
-    {
-        auto expected_result = exporter.writeGltfBinary(m_gltf_asset, fastgltf::ExportOptions::ValidateAsset);
+    if (snapshot.binary) {
+        // fastgltf::Exporter::writeGltfBinary() needs buffer 0 in one piece
+        // and copies it into its output: two copies of every byte. It only
+        // writes the JSON here, with the buffers taken out after
+        // validation, and write_glb() streams the BIN chunk from the parts.
+        const fastgltf::Error validate_error = fastgltf::validate(snapshot.asset);
+        if (validate_error != fastgltf::Error::None) {
+            log_gltf->error("glTF export: invalid asset: {}", fastgltf::getErrorMessage(validate_error));
+            return false;
+        }
+        const bool has_buffer = !snapshot.asset.buffers.empty();
+        snapshot.asset.buffers.clear();
+        auto expected_result = exporter.writeGltfJson(snapshot.asset, fastgltf::ExportOptions::None);
         auto* result = expected_result.get_if();
         if (result == nullptr) {
-            return {};
+            log_gltf->error("glTF export: writing GLB failed: {}", fastgltf::getErrorMessage(expected_result.error()));
+            return false;
         }
-        return std::string(
-            reinterpret_cast<const char*>(result->output.data()),
-            result->output.size()
-        );
-    } 
-    else
-    {
-        auto expected_result = exporter.writeGltfJson(m_gltf_asset, 
+        std::string& json = result->output;
+        ERHE_VERIFY(!json.empty() && (json.front() == '{'));
+        if (has_buffer) {
+            // The GLB-stored buffer 0: byteLength and no uri. Key order in
+            // a JSON object does not matter, so it goes first.
+            json.insert(1, fmt::format(R"("buffers":[{{"byteLength":{}}}],)", snapshot.buffer_byte_count));
+        }
+
+        std::vector<Glb_bin_part> parts;
+        parts.reserve(snapshot.buffer_parts.size());
+        for (std::size_t i = 0, end = snapshot.buffer_parts.size(); i < end; ++i) {
+            parts.push_back(
+                Glb_bin_part{
+                    .offset = snapshot.buffer_part_offsets[i],
+                    .bytes  = std::span<const std::byte>{snapshot.buffer_parts[i].data(), snapshot.buffer_parts[i].size()}
+                }
+            );
+        }
+        const std::span<const std::byte> json_bytes      = std::as_bytes(std::span<const char>{json.data(), json.size()});
+        const std::size_t                bin_byte_count  = has_buffer ? snapshot.buffer_byte_count : 0;
+        const std::size_t                glb_byte_count  = get_glb_byte_count(json_bytes.size(), bin_byte_count);
+        const bool ok = output.begin(glb_byte_count) && write_glb(json_bytes, parts, bin_byte_count, output.write);
+        if (!ok && (glb_byte_count > std::numeric_limits<uint32_t>::max())) {
+            log_gltf->error("glTF export: {} bytes exceed the GLB size limit", glb_byte_count);
+        }
+        snapshot.buffer_parts.clear();
+        snapshot.buffer_part_offsets.clear();
+        return ok;
+    } else {
+        snapshot.assemble_buffer();
+        auto expected_result = exporter.writeGltfJson(snapshot.asset,
             fastgltf::ExportOptions::ValidateAsset |
             fastgltf::ExportOptions::PrettyPrintJson);
+        snapshot.asset.buffers.clear();
         auto* result = expected_result.get_if();
         if (result == nullptr) {
-            return {};
+            log_gltf->error("glTF export: writing glTF JSON failed: {}", fastgltf::getErrorMessage(expected_result.error()));
+            return false;
         }
-        return result->output;
+        const std::span<const std::byte> bytes = std::as_bytes(std::span<const char>{result->output.data(), result->output.size()});
+        return output.begin(bytes.size()) && output.write(bytes);
     }
 }
 
-[[nodiscard]] auto export_gltf(const Gltf_export_arguments& arguments) -> std::string
+} // anonymous namespace
+
+[[nodiscard]] auto make_gltf_export_snapshot(const Gltf_export_arguments& arguments) -> std::shared_ptr<Gltf_export_snapshot>
 {
     Gltf_exporter exporter{arguments};
-    return exporter.export_gltf();
+    return exporter.make_snapshot();
+}
+
+[[nodiscard]] auto write_gltf_export_snapshot(
+    Gltf_export_snapshot&        snapshot,
+    const std::filesystem::path& path,
+    const Gltf_export_progress&  progress
+) -> bool
+{
+    ERHE_PROFILE_FUNCTION();
+
+    // Same directory as the destination, so the final rename stays within
+    // one file system and replaces the destination atomically.
+    std::filesystem::path temp_path = path;
+    temp_path += fmt::format(".{}.tmp", reinterpret_cast<std::uintptr_t>(&snapshot));
+
+    std::ofstream file;
+    std::size_t   byte_count   {0};
+    std::size_t   bytes_written{0};
+    bool ok = serialize_gltf_export_snapshot(
+        snapshot,
+        Gltf_export_output{
+            .begin = [&](const std::size_t total_byte_count) -> bool {
+                file.open(temp_path, std::ios::binary | std::ios::trunc);
+                if (!file.is_open()) {
+                    log_gltf->error("glTF export: cannot create '{}'", temp_path.string());
+                    return false;
+                }
+                byte_count = total_byte_count;
+                if (progress) {
+                    progress(0, byte_count);
+                }
+                return true;
+            },
+            .write = [&](const std::span<const std::byte> bytes) -> bool {
+                // Chunked so progress advances while large parts are written.
+                constexpr std::size_t chunk_size = 1024 * 1024;
+                for (std::size_t offset = 0; offset < bytes.size(); ) {
+                    const std::size_t count = std::min(chunk_size, bytes.size() - offset);
+                    file.write(reinterpret_cast<const char*>(bytes.data() + offset), static_cast<std::streamsize>(count));
+                    if (!file) {
+                        log_gltf->error("glTF export: writing '{}' failed", temp_path.string());
+                        return false;
+                    }
+                    offset        += count;
+                    bytes_written += count;
+                    if (progress) {
+                        progress(bytes_written, byte_count);
+                    }
+                }
+                return true;
+            }
+        }
+    );
+    if (file.is_open()) {
+        file.close();
+        if (ok && !file) {
+            log_gltf->error("glTF export: writing '{}' failed", temp_path.string());
+            ok = false;
+        }
+    }
+
+    std::error_code error_code{};
+    if (ok) {
+        std::filesystem::rename(temp_path, path, error_code);
+        if (!error_code) {
+            return true;
+        }
+        log_gltf->error("glTF export: renaming '{}' to '{}' failed: {}", temp_path.string(), path.string(), error_code.message());
+    }
+    std::filesystem::remove(temp_path, error_code);
+    return false;
+}
+
+[[nodiscard]] auto export_gltf(const Gltf_export_arguments& arguments) -> std::string
+{
+    const std::shared_ptr<Gltf_export_snapshot> snapshot = make_gltf_export_snapshot(arguments);
+    std::string result;
+    const bool ok = serialize_gltf_export_snapshot(
+        *snapshot,
+        Gltf_export_output{
+            .begin = [&result](const std::size_t byte_count) -> bool {
+                result.reserve(byte_count);
+                return true;
+            },
+            .write = [&result](const std::span<const std::byte> bytes) -> bool {
+                result.append(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+                return true;
+            }
+        }
+    );
+    if (!ok) {
+        return {};
+    }
+    return result;
 }
 
 [[nodiscard]] auto export_gltf(const erhe::scene::Node& root_node, bool binary, const Gltf_physics_data* physics_data) -> std::string
@@ -338,6 +338,18 @@ struct Gltf_parse_arguments
     // All buffers and images must be embedded in the GLB, as with assets
     // delivered by OpenXR XR_FB_render_model / XR_EXT_render_model.
     std::span<const std::byte>                glb_data{};
+    // Memory map the input (and external .bin buffers) instead of reading
+    // them into the heap. Buffer views are then read in place from the
+    // mapping by the mesh and image decode tasks, which prefetch the pages
+    // they are about to touch; a GLB's BIN chunk is never copied. Files that
+    // cannot be mapped are read as before. glb_data is always viewed in
+    // place, regardless of this flag.
+    bool                                      memory_map{true};
+    // Use the persistent compressed image cache (image_cache.hpp) when the
+    // device prefers BC7: PNG / JPEG / ... images with a cache entry load
+    // as a BC7 mip chain without decoding, the others are decoded as usual
+    // and queued for background encoding on the executor.
+    bool                                      compressed_image_cache{true};
 };
 
 [[nodiscard]] auto parse_gltf(const Gltf_parse_arguments& arguments) -> Gltf_data;
@@ -485,4 +497,33 @@ public:
     const Gltf_physics_data* physics_data = nullptr
 ) -> std::string;
 
+// Two-phase export for saving without stalling the caller.
+//
+// make_gltf_export_snapshot() runs every pass of export_gltf() that reads
+// the scene (nodes, meshes, geometry, materials, skins, animations, uid
+// stamping, extension payloads) and keeps the result as a self-contained
+// glTF document plus the embedded buffer data. The snapshot references no
+// scene object, so the scene may be edited or destroyed once it returns.
+// Must run where export_gltf() may run (it reads items and stamps uids).
+//
+// write_gltf_export_snapshot() does the rest on any thread: serializes the
+// document and streams it to a temporary file next to path, which is then
+// renamed over path; a failed write leaves an existing file at path
+// untouched. A GLB's BIN chunk is written straight from the per-buffer
+// byte vectors, without assembling the buffer in memory.
+// progress, when set, is called from the writing thread with the bytes
+// written so far and the total. A snapshot can be written once: its
+// buffer data is released while writing.
+class Gltf_export_snapshot;
+
+using Gltf_export_progress = std::function<void(std::size_t bytes_written, std::size_t byte_count)>;
+
+[[nodiscard]] auto make_gltf_export_snapshot(const Gltf_export_arguments& arguments) -> std::shared_ptr<Gltf_export_snapshot>;
+
+[[nodiscard]] auto write_gltf_export_snapshot(
+    Gltf_export_snapshot&        snapshot,
+    const std::filesystem::path& path,
+    const Gltf_export_progress&  progress = {}
+) -> bool;
+
 }
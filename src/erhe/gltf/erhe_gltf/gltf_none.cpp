@@ -32,4 +32,14 @@ auto export_gltf(const erhe::scene::Node&, bool, const Gltf_physics_data*) -> st
     return {};
 }
 
+auto make_gltf_export_snapshot(const Gltf_export_arguments&) -> std::shared_ptr<Gltf_export_snapshot>
+{
+    return {};
+}
+
+auto write_gltf_export_snapshot(Gltf_export_snapshot&, const std::filesystem::path&, const Gltf_export_progress&) -> bool
+{
+    return false;
+}
+
 }
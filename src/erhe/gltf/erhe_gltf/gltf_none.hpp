@@ -185,6 +185,8 @@ struct Gltf_parse_arguments
     bool                                      parallel{true};
     bool                                      fix_spot_lights{false};
     std::span<const std::byte>                glb_data{};
+    bool                                      memory_map{true};
+    bool                                      compressed_image_cache{true};
 };
 
 [[nodiscard]] auto parse_gltf(const Gltf_parse_arguments& arguments) -> Gltf_data;
@@ -264,4 +266,16 @@ public:
     const Gltf_physics_data* physics_data = nullptr
 ) -> std::string;
 
+class Gltf_export_snapshot;
+
+using Gltf_export_progress = std::function<void(std::size_t bytes_written, std::size_t byte_count)>;
+
+[[nodiscard]] auto make_gltf_export_snapshot(const Gltf_export_arguments& arguments) -> std::shared_ptr<Gltf_export_snapshot>;
+
+[[nodiscard]] auto write_gltf_export_snapshot(
+    Gltf_export_snapshot&        snapshot,
+    const std::filesystem::path& path,
+    const Gltf_export_progress&  progress = {}
+) -> bool;
+
 }
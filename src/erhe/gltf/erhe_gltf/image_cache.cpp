@@ -0,0 +1,331 @@
+#include "image_cache.hpp"
+
+#include "gltf_log.hpp"
+
+#include "erhe_dataformat/dataformat.hpp"
+#include "erhe_file/file.hpp"
+#include "erhe_graphics/image_loader.hpp"
+#include "erhe_graphics/image_loader_dds.hpp"
+#include "erhe_graphics/image_loader_ktx2.hpp"
+#include "erhe_graphics/ktx2_container.hpp"
+#include "erhe_graphics/texture_compression.hpp"
+#include "erhe_hash/hash.hpp"
+#include "erhe_profile/profile.hpp"
+
+#include <fmt/format.h>
+#include <fmt/std.h>
+#include <taskflow/taskflow.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <unordered_set>
+
+namespace erhe::gltf {
+
+namespace {
+
+// Bump when the encoder or the container layout changes; older entries are
+// then simply never looked at again.
+constexpr const char* c_cache_format_version = "bc7_v1";
+
+[[nodiscard]] auto get_cache_directory() -> std::filesystem::path
+{
+    return std::filesystem::path{"cache"} / std::filesystem::path{"textures"} / std::filesystem::path{c_cache_format_version};
+}
+
+[[nodiscard]] auto as_uint8_span(const std::span<const std::byte> bytes) -> std::span<const std::uint8_t>
+{
+    return std::span<const std::uint8_t>{reinterpret_cast<const std::uint8_t*>(bytes.data()), bytes.size()};
+}
+
+[[nodiscard]] auto get_bc7_format(const bool linear) -> erhe::dataformat::Format
+{
+    return linear ? erhe::dataformat::Format::format_bc7_unorm : erhe::dataformat::Format::format_bc7_srgb;
+}
+
+// Keys (entry file names) with an encode task scheduled or running.
+std::mutex                      s_in_flight_mutex;
+std::unordered_set<std::string> s_in_flight;
+
+} // anonymous namespace
+
+auto make_compressed_image_cache_key(const std::span<const std::byte> encoded_bytes, const bool linear) -> Compressed_image_cache_key
+{
+    ERHE_PROFILE_FUNCTION();
+
+    return Compressed_image_cache_key{
+        .content_hash = erhe::hash::hash(encoded_bytes.data(), encoded_bytes.size()),
+        .byte_count   = encoded_bytes.size(),
+        .linear       = linear
+    };
+}
+
+auto is_compressed_image_cache_candidate(const std::span<const std::byte> encoded_bytes) -> bool
+{
+    const std::span<const std::uint8_t> buffer_view = as_uint8_span(encoded_bytes);
+    return
+        !encoded_bytes.empty() &&
+        !erhe::graphics::Image_loader_ktx2::is_ktx2(buffer_view) &&
+        !erhe::graphics::Image_loader_dds::is_dds(buffer_view);
+}
+
+auto get_compressed_image_cache_path(const Compressed_image_cache_key& key) -> std::filesystem::path
+{
+    return get_cache_directory() / std::filesystem::path{
+        fmt::format("{:016x}_{}_{}.ktx2", key.content_hash, key.byte_count, key.linear ? "linear" : "srgb")
+    };
+}
+
+auto load_compressed_image(
+    const Compressed_image_cache_key& key,
+    erhe::graphics::Image_info&       image_info,
+    std::vector<std::uint8_t>&        pixels
+) -> bool
+{
+    ERHE_PROFILE_FUNCTION();
+
+    const std::filesystem::path path = get_compressed_image_cache_path(key);
+    std::error_code error_code{};
+    if (!std::filesystem::is_regular_file(path, error_code)) {
+        return false;
+    }
+
+    erhe::graphics::Image_loader_ktx2 loader;
+    erhe::graphics::Image_info info{};
+    if (!loader.open(path, info, key.linear, erhe::graphics::Transcode_format_preference::bc7)) {
+        log_gltf->warn("Compressed image cache: ignoring unreadable entry '{}'", path);
+        return false;
+    }
+    if (info.format != get_bc7_format(key.linear)) {
+        log_gltf->warn("Compressed image cache: ignoring entry '{}' with unexpected format {}", path, erhe::dataformat::c_str(info.format));
+        return false;
+    }
+    pixels.resize(
+        erhe::dataformat::get_mip_chain_byte_count(
+            info.format,
+            static_cast<std::size_t>(info.width),
+            static_cast<std::size_t>(info.height),
+            static_cast<std::size_t>(info.level_count)
+        )
+    );
+    if (!loader.load(std::span<std::uint8_t>{pixels.data(), pixels.size()})) {
+        pixels.clear();
+        return false;
+    }
+    image_info = info;
+    // The modification time orders entries for trim_compressed_image_cache()
+    std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), error_code);
+    log_gltf->trace("Compressed image cache: hit '{}'", path);
+    return true;
+}
+
+auto encode_compressed_image(const Compressed_image_cache_key& key, const std::span<const std::byte> encoded_bytes) -> bool
+{
+    ERHE_PROFILE_FUNCTION();
+
+    const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+    erhe::graphics::Image_loader loader;
+    erhe::graphics::Image_info   info{};
+    if (!loader.open(as_uint8_span(encoded_bytes), info, key.linear, erhe::graphics::Transcode_format_preference::rgba8)) {
+        return false;
+    }
+    const erhe::dataformat::Format expected_format = key.linear
+        ? erhe::dataformat::Format::format_8_vec4_unorm
+        : erhe::dataformat::Format::format_8_vec4_srgb;
+    if ((info.format != expected_format) || (info.level_count != 1) || (info.row_stride != info.width * 4)) {
+        log_gltf->trace("Compressed image cache: source decodes to {}, not cached", erhe::dataformat::c_str(info.format));
+        return false;
+    }
+    std::vector<std::uint8_t> level_0(static_cast<std::size_t>(info.row_stride) * static_cast<std::size_t>(info.height));
+    if (!loader.load(std::span<std::uint8_t>{level_0.data(), level_0.size()})) {
+        return false;
+    }
+    loader.close();
+
+    const std::vector<std::uint8_t> rgba_chain  = erhe::graphics::make_rgba8_mip_chain(info.width, info.height, !key.linear, level_0);
+    const int                       level_count = erhe::graphics::get_full_mip_level_count(info.width, info.height);
+    const erhe::dataformat::Format  format      = get_bc7_format(key.linear);
+    std::vector<std::uint8_t> bc7_chain(
+        erhe::dataformat::get_mip_chain_byte_count(
+            format,
+            static_cast<std::size_t>(info.width),
+            static_cast<std::size_t>(info.height),
+            static_cast<std::size_t>(level_count)
+        )
+    );
+    std::size_t rgba_offset = 0;
+    std::size_t bc7_offset  = 0;
+    for (int level = 0; level < level_count; ++level) {
+        const int level_width  = std::max(1, info.width  >> level);
+        const int level_height = std::max(1, info.height >> level);
+        const std::size_t rgba_byte_count = static_cast<std::size_t>(level_width) * static_cast<std::size_t>(level_height) * 4;
+        const std::size_t bc7_byte_count  = erhe::dataformat::get_image_level_size_bytes(
+            format,
+            static_cast<std::size_t>(level_width),
+            static_cast<std::size_t>(level_height)
+        );
+        erhe::graphics::encode_bc7_image(
+            level_width,
+            level_height,
+            std::span<const std::uint8_t>{rgba_chain.data() + rgba_offset, rgba_byte_count},
+            std::span<std::uint8_t>{bc7_chain.data() + bc7_offset, bc7_byte_count}
+        );
+        rgba_offset += rgba_byte_count;
+        bc7_offset  += bc7_byte_count;
+    }
+
+    const std::vector<std::uint8_t> file_bytes = erhe::graphics::make_plain_ktx2(format, info.width, info.height, level_count, bc7_chain);
+    if (file_bytes.empty()) {
+        return false;
+    }
+
+    const std::filesystem::path path = get_compressed_image_cache_path(key);
+    if (!erhe::file::ensure_directory_exists(path.parent_path())) {
+        return false;
+    }
+    // Same write-then-rename scheme as the BVH cache: identical images in
+    // different files map to the same entry and may finish concurrently.
+    static std::atomic<std::uint64_t> s_temp_counter{0};
+    const std::filesystem::path temp_path = path.parent_path() / std::filesystem::path{
+        fmt::format("{}.{}.tmp", path.filename().string(), s_temp_counter.fetch_add(1))
+    };
+    {
+        std::ofstream out{temp_path, std::ofstream::binary};
+        if (!out) {
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(file_bytes.data()), static_cast<std::streamsize>(file_bytes.size()));
+        out.close();
+        if (!out) {
+            std::error_code discarded_error_code{};
+            std::filesystem::remove(temp_path, discarded_error_code);
+            return false;
+        }
+    }
+    std::error_code error_code{};
+    std::filesystem::rename(temp_path, path, error_code);
+    if (error_code) {
+        std::error_code discarded_error_code{};
+        std::filesystem::remove(temp_path, discarded_error_code);
+        return false;
+    }
+
+    const std::chrono::steady_clock::duration duration = std::chrono::steady_clock::now() - start_time;
+    log_gltf->debug(
+        "Compressed image cache: wrote '{}' ({} x {}, {} levels, {} bytes) in {} ms",
+        path,
+        info.width,
+        info.height,
+        level_count,
+        file_bytes.size(),
+        std::chrono::duration_cast<std::chrono::milliseconds>(duration).count()
+    );
+    trim_compressed_image_cache(c_compressed_image_cache_byte_budget);
+    return true;
+}
+
+auto trim_compressed_image_cache(const std::uint64_t byte_budget) -> std::size_t
+{
+    ERHE_PROFILE_FUNCTION();
+
+    class Entry
+    {
+    public:
+        std::filesystem::path           path;
+        std::filesystem::file_time_type last_write_time;
+        std::uintmax_t                  byte_count{0};
+    };
+    std::vector<Entry> entries;
+    std::uint64_t      total_byte_count{0};
+    std::error_code    error_code{};
+    for (
+        std::filesystem::directory_iterator i{get_cache_directory(), error_code}, end;
+        !error_code && (i != end);
+        i.increment(error_code)
+    ) {
+        // Temporary files of writes in progress are not entries
+        if (i->path().extension() != ".ktx2") {
+            continue;
+        }
+        std::error_code entry_error_code{};
+        Entry entry{
+            .path            = i->path(),
+            .last_write_time = i->last_write_time(entry_error_code),
+            .byte_count      = i->file_size(entry_error_code)
+        };
+        if (entry_error_code) {
+            continue;
+        }
+        total_byte_count += entry.byte_count;
+        entries.push_back(std::move(entry));
+    }
+    if (total_byte_count <= byte_budget) {
+        return 0;
+    }
+
+    std::sort(
+        entries.begin(),
+        entries.end(),
+        [](const Entry& lhs, const Entry& rhs) {
+            return lhs.last_write_time < rhs.last_write_time;
+        }
+    );
+    std::size_t removed_count = 0;
+    for (const Entry& entry : entries) {
+        if (total_byte_count <= byte_budget) {
+            break;
+        }
+        // A concurrent trim may have removed it already; either way it is gone
+        std::error_code remove_error_code{};
+        const bool      removed = std::filesystem::remove(entry.path, remove_error_code);
+        if (!remove_error_code) {
+            total_byte_count -= entry.byte_count;
+        }
+        if (removed) {
+            ++removed_count;
+        }
+    }
+    log_gltf->debug("Compressed image cache: removed {} entries, {} bytes remain", removed_count, total_byte_count);
+    return removed_count;
+}
+
+void schedule_compressed_image_encode(
+    tf::Executor&                                 executor,
+    const Compressed_image_cache_key&             key,
+    std::shared_ptr<const std::vector<std::byte>> encoded_bytes
+)
+{
+    if (!encoded_bytes || encoded_bytes->empty()) {
+        return;
+    }
+    const std::filesystem::path path = get_compressed_image_cache_path(key);
+    std::error_code error_code{};
+    if (std::filesystem::exists(path, error_code)) {
+        return;
+    }
+    std::string entry_name = path.filename().string();
+    {
+        const std::lock_guard<std::mutex> lock{s_in_flight_mutex};
+        if (!s_in_flight.insert(entry_name).second) {
+            return;
+        }
+    }
+    executor.silent_async(
+        [key, encoded_bytes = std::move(encoded_bytes), entry_name = std::move(entry_name)]() {
+            const bool ok = encode_compressed_image(key, std::span<const std::byte>{encoded_bytes->data(), encoded_bytes->size()});
+            if (!ok) {
+                log_gltf->trace("Compressed image cache: no entry written for '{}'", entry_name);
+            }
+            const std::lock_guard<std::mutex> lock{s_in_flight_mutex};
+            s_in_flight.erase(entry_name);
+        }
+    );
+}
+
+} // namespace erhe::gltf
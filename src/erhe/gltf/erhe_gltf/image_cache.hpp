@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace tf {
+    class Executor;
+}
+namespace erhe::graphics {
+    class Image_info;
+}
+
+namespace erhe::gltf {
+
+// Persistent cache of block-compressed copies of PNG / JPEG / ... images.
+//
+// The first load of an image decodes it to RGBA8 as usual and schedules a
+// background task that builds the full mip chain, encodes it to BC7 and
+// stores it as a plain KTX2 file under cache/textures/. Later loads of the
+// same bytes find the file and upload the BC7 chain directly: no decode, no
+// GPU mipmap generation, a quarter of the VRAM.
+//
+// Entries are keyed by the content of the encoded source (hash and byte
+// count) plus the color space it is loaded in, not by path, so renamed or
+// duplicated files hit and edited files miss. The format version is part of
+// the directory name; bump it when the encoder or container changes.
+//
+// Only BC7 is produced, so parse_gltf consults the cache only when the
+// device prefers BC7 (Transcode_format_preference::bc7).
+//
+// The directory is kept under c_compressed_image_cache_byte_budget: every
+// write trims least recently used entries (a hit refreshes the entry's
+// modification time).
+class Compressed_image_cache_key
+{
+public:
+    std::uint64_t content_hash{0};
+    std::size_t   byte_count  {0};
+    bool          linear      {false};
+};
+
+constexpr std::uint64_t c_compressed_image_cache_byte_budget = 1024ull * 1024ull * 1024ull;
+
+[[nodiscard]] auto make_compressed_image_cache_key(std::span<const std::byte> encoded_bytes, bool linear) -> Compressed_image_cache_key;
+
+// True for sources worth caching: anything that is not already a GPU
+// container (KTX2, DDS).
+[[nodiscard]] auto is_compressed_image_cache_candidate(std::span<const std::byte> encoded_bytes) -> bool;
+
+// Where the entry for key lives, whether it exists or not.
+[[nodiscard]] auto get_compressed_image_cache_path(const Compressed_image_cache_key& key) -> std::filesystem::path;
+
+// On a hit fills image_info and pixels with the tightly packed BC7 mip
+// chain, largest level first, marks the entry as recently used and returns
+// true. A missing, unreadable or unexpected entry is a miss.
+[[nodiscard]] auto load_compressed_image(
+    const Compressed_image_cache_key& key,
+    erhe::graphics::Image_info&       image_info,
+    std::vector<std::uint8_t>&        pixels
+) -> bool;
+
+// Decodes encoded_bytes, builds the mip chain, encodes and writes the
+// entry, then trims the cache to c_compressed_image_cache_byte_budget.
+// Entries are written to a temporary file and renamed in place, so
+// readers never observe a partial entry. Returns false if the source does
+// not decode to RGBA8 or the entry cannot be written.
+[[nodiscard]] auto encode_compressed_image(const Compressed_image_cache_key& key, std::span<const std::byte> encoded_bytes) -> bool;
+
+// Removes entries, least recently used first, until the entries in the
+// cache directory add up to at most byte_budget bytes. Returns the number
+// of entries removed.
+auto trim_compressed_image_cache(std::uint64_t byte_budget) -> std::size_t;
+
+// Runs encode_compressed_image() as a detached executor task, unless the
+// entry exists or the same key is already being encoded. The task keeps
+// encoded_bytes alive; it does not refer to anything else the caller owns,
+// so it may outlive parse_gltf. Owners of the executor drain it
+// (wait_for_all()) before exit as usual.
+void schedule_compressed_image_encode(
+    tf::Executor&                                 executor,
+    const Compressed_image_cache_key&             key,
+    std::shared_ptr<const std::vector<std::byte>> encoded_bytes
+);
+
+} // namespace erhe::gltf
@@ -0,0 +1,33 @@
+#include "erhe_file/file_log.hpp"
+#include "erhe_gltf/gltf_log.hpp"
+#include "erhe_graphics/graphics_log.hpp"
+#include "erhe_item/item_log.hpp"
+#include "erhe_primitive/primitive_log.hpp"
+#include "erhe_scene/scene_log.hpp"
+
+#include <gtest/gtest.h>
+#include <spdlog/spdlog.h>
+
+void initialize_test_logging()
+{
+    // parse_gltf() and the image cache log unconditionally (and parsing
+    // parents nodes, which logs from Hierarchy); without this the loggers
+    // are null.
+    erhe::file::log_file                   = spdlog::default_logger();
+    erhe::gltf::log_gltf                   = spdlog::default_logger();
+    erhe::graphics::log_texture            = spdlog::default_logger();
+    erhe::item::log                        = spdlog::default_logger();
+    erhe::item::log_frame                  = spdlog::default_logger();
+    erhe::primitive::log_primitive         = spdlog::default_logger();
+    erhe::primitive::log_primitive_builder = spdlog::default_logger();
+    erhe::scene::log                       = spdlog::default_logger();
+    erhe::scene::log_frame                 = spdlog::default_logger();
+    erhe::scene::log_mesh_raytrace         = spdlog::default_logger();
+}
+
+int main(int argc, char** argv)
+{
+    initialize_test_logging();
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,207 @@
+// write_gltf_export_snapshot(): a GLB with an animation (and so a BIN chunk)
+// written through a temporary file and renamed into place, read back with
+// parse_gltf(); and the failures that must leave no temporary file and an
+// existing destination untouched. No graphics Device.
+
+#include "erhe_gltf/glb_container.hpp"
+#include "erhe_gltf/gltf.hpp"
+#include "erhe_scene/animation.hpp"
+#include "erhe_scene/node.hpp"
+
+#include <gtest/gtest.h>
+#include <taskflow/taskflow.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using erhe::gltf::Gltf_data;
+using erhe::gltf::Gltf_export_arguments;
+using erhe::gltf::Gltf_export_snapshot;
+
+auto read_file(const std::filesystem::path& path) -> std::vector<std::byte>
+{
+    std::ifstream     file{path, std::ios::binary};
+    const std::string bytes{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+    const std::byte*  data = reinterpret_cast<const std::byte*>(bytes.data());
+    return std::vector<std::byte>{data, data + bytes.size()};
+}
+
+class Export_gltf : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        m_temp_path = std::filesystem::temp_directory_path() / ("erhe_gltf_export_test_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+        std::filesystem::create_directories(m_temp_path);
+
+        // root (not exported) -> "moving" -> "child"; the animation
+        // translates and rotates "moving"
+        m_root   = std::make_shared<erhe::scene::Node>("root");
+        m_moving = std::make_shared<erhe::scene::Node>("moving");
+        m_child  = std::make_shared<erhe::scene::Node>("child");
+        m_moving->set_parent(m_root);
+        m_child ->set_parent(m_moving);
+
+        m_animation = std::make_shared<erhe::scene::Animation>("move");
+        m_animation->samplers.resize(2);
+        m_animation->samplers[0].set({0.0f, 0.5f, 1.0f}, {0.0f, 0.0f, 0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f});
+        m_animation->samplers[1].set({0.0f, 1.0f}, {0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f});
+        m_animation->channels.push_back(erhe::scene::Animation_channel{
+            .path = erhe::scene::Animation_path::TRANSLATION, .sampler_index = 0, .target = m_moving, .start_position = 0, .value_offset = 0
+        });
+        m_animation->channels.push_back(erhe::scene::Animation_channel{
+            .path = erhe::scene::Animation_path::ROTATION, .sampler_index = 1, .target = m_moving, .start_position = 0, .value_offset = 0
+        });
+    }
+
+    void TearDown() override
+    {
+        std::error_code error_code{};
+        std::filesystem::remove_all(m_temp_path, error_code);
+    }
+
+    [[nodiscard]] auto make_snapshot() const -> std::shared_ptr<Gltf_export_snapshot>
+    {
+        return erhe::gltf::make_gltf_export_snapshot(
+            Gltf_export_arguments{.root_node = *m_root, .binary = true, .animations = {m_animation}}
+        );
+    }
+
+    // Everything in the temporary directory, for checking that failed
+    // writes leave no temporary files behind
+    [[nodiscard]] auto list_directory() const -> std::vector<std::filesystem::path>
+    {
+        std::vector<std::filesystem::path> paths;
+        for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator{m_temp_path}) {
+            paths.push_back(entry.path());
+        }
+        std::sort(paths.begin(), paths.end());
+        return paths;
+    }
+
+    std::filesystem::path                   m_temp_path;
+    std::shared_ptr<erhe::scene::Node>      m_root;
+    std::shared_ptr<erhe::scene::Node>      m_moving;
+    std::shared_ptr<erhe::scene::Node>      m_child;
+    std::shared_ptr<erhe::scene::Animation> m_animation;
+};
+
+TEST_F(Export_gltf, WritesGlbThroughTemporaryFile)
+{
+    // export_gltf() serializes the same way into memory; uids are stamped
+    // by the first export, so both produce the same bytes
+    const std::string in_memory = erhe::gltf::export_gltf(
+        Gltf_export_arguments{.root_node = *m_root, .binary = true, .animations = {m_animation}}
+    );
+
+    const std::filesystem::path path = m_temp_path / "scene.glb";
+    std::vector<std::pair<std::size_t, std::size_t>> progress;
+    ASSERT_TRUE(erhe::gltf::write_gltf_export_snapshot(
+        *make_snapshot(),
+        path,
+        [&progress](const std::size_t bytes_written, const std::size_t byte_count) {
+            progress.emplace_back(bytes_written, byte_count);
+        }
+    ));
+    EXPECT_EQ(list_directory(), (std::vector<std::filesystem::path>{path}));
+
+    const std::vector<std::byte> glb = read_file(path);
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(glb.data()), glb.size()), in_memory);
+
+    ASSERT_FALSE(progress.empty());
+    EXPECT_EQ(progress.front().first, 0u);
+    for (std::size_t i = 1; i < progress.size(); ++i) {
+        EXPECT_GE(progress[i].first, progress[i - 1].first);
+        EXPECT_EQ(progress[i].second, glb.size());
+    }
+    EXPECT_EQ(progress.back().first, glb.size());
+
+    const std::optional<erhe::gltf::Glb_chunks> chunks = erhe::gltf::split_glb(glb);
+    ASSERT_TRUE(chunks.has_value());
+    EXPECT_FALSE(chunks->bin.empty());
+
+    tf::Executor executor{1};
+    const std::shared_ptr<erhe::scene::Node> parsed_root = std::make_shared<erhe::scene::Node>("parsed root");
+    const Gltf_data data = erhe::gltf::parse_gltf(
+        erhe::gltf::Gltf_parse_arguments{
+            .executor               = executor,
+            .root_node              = parsed_root,
+            .path                   = path,
+            .parallel               = false,
+            .glb_data               = glb,
+            .compressed_image_cache = false
+        }
+    );
+    std::vector<std::string> node_names;
+    for (const std::shared_ptr<erhe::scene::Node>& node : data.nodes) {
+        node_names.push_back(node->get_name());
+    }
+    std::sort(node_names.begin(), node_names.end());
+    EXPECT_EQ(node_names, (std::vector<std::string>{"child", "moving"}));
+    ASSERT_EQ(data.animations.size(), 1u);
+    const erhe::scene::Animation& animation = *data.animations.front();
+    ASSERT_EQ(animation.samplers.size(), 2u);
+    EXPECT_EQ(animation.samplers[0].timestamps, m_animation->samplers[0].timestamps);
+    EXPECT_EQ(animation.samplers[0].data,       m_animation->samplers[0].data);
+    EXPECT_EQ(animation.samplers[1].timestamps, m_animation->samplers[1].timestamps);
+    EXPECT_EQ(animation.samplers[1].data,       m_animation->samplers[1].data);
+}
+
+TEST_F(Export_gltf, ReplacesExistingFile)
+{
+    const std::filesystem::path path = m_temp_path / "scene.glb";
+    {
+        std::ofstream file{path, std::ios::binary};
+        file << "previous contents";
+    }
+    ASSERT_TRUE(erhe::gltf::write_gltf_export_snapshot(*make_snapshot(), path));
+    EXPECT_EQ(list_directory(), (std::vector<std::filesystem::path>{path}));
+    EXPECT_TRUE(erhe::gltf::split_glb(read_file(path)).has_value());
+}
+
+TEST_F(Export_gltf, MissingDirectoryFails)
+{
+    const std::filesystem::path path = m_temp_path / "missing" / "scene.glb";
+    EXPECT_FALSE(erhe::gltf::write_gltf_export_snapshot(*make_snapshot(), path));
+    EXPECT_TRUE(list_directory().empty());
+}
+
+TEST_F(Export_gltf, FailedRenameRemovesTemporaryFile)
+{
+    // The destination is a non-empty directory, which a file cannot replace
+    const std::filesystem::path path = m_temp_path / "scene.glb";
+    std::filesystem::create_directories(path);
+    {
+        std::ofstream file{path / "keep"};
+        file << "keep";
+    }
+    EXPECT_FALSE(erhe::gltf::write_gltf_export_snapshot(*make_snapshot(), path));
+    EXPECT_EQ(list_directory(), (std::vector<std::filesystem::path>{path, path / "keep"}));
+}
+
+TEST_F(Export_gltf, SnapshotIsWrittenOnce)
+{
+    const std::filesystem::path path = m_temp_path / "scene.glb";
+    const std::shared_ptr<Gltf_export_snapshot> snapshot = make_snapshot();
+    ASSERT_TRUE(erhe::gltf::write_gltf_export_snapshot(*snapshot, path));
+    const std::vector<std::byte> first = read_file(path);
+
+    // The buffer data is gone: a second write fails without touching the file
+    EXPECT_FALSE(erhe::gltf::write_gltf_export_snapshot(*snapshot, path));
+    EXPECT_EQ(read_file(path), first);
+    EXPECT_EQ(list_directory(), (std::vector<std::filesystem::path>{path}));
+}
+
+} // anonymous namespace
@@ -0,0 +1,301 @@
+// GLB container splitting and the JSON-only stand-in parse_gltf() hands to
+// fastgltf: well formed files, and every way a header or chunk can be
+// broken or cut short. Also write_glb(), read back with split_glb().
+
+#include "erhe_gltf/glb_container.hpp"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+using erhe::gltf::Glb_bin_part;
+using erhe::gltf::Glb_chunks;
+using erhe::gltf::glb_chunk_bin;
+using erhe::gltf::glb_chunk_json;
+using erhe::gltf::get_glb_byte_count;
+using erhe::gltf::glb_magic;
+using erhe::gltf::make_json_only_glb;
+using erhe::gltf::split_glb;
+using erhe::gltf::write_glb;
+
+void append_u32(std::vector<std::byte>& out, const uint32_t value)
+{
+    for (int shift = 0; shift < 32; shift += 8) {
+        out.push_back(static_cast<std::byte>((value >> shift) & 0xffu));
+    }
+}
+
+void append_bytes(std::vector<std::byte>& out, const std::string_view text)
+{
+    for (const char c : text) {
+        out.push_back(static_cast<std::byte>(c));
+    }
+}
+
+void set_u32(std::vector<std::byte>& glb, const std::size_t offset, const uint32_t value)
+{
+    for (std::size_t i = 0; i < 4; ++i) {
+        glb[offset + i] = static_cast<std::byte>((value >> (8 * i)) & 0xffu);
+    }
+}
+
+auto to_string(const std::span<const std::byte> bytes) -> std::string
+{
+    return std::string{reinterpret_cast<const char*>(bytes.data()), bytes.size()};
+}
+
+constexpr std::string_view c_json = R"({"asset":{"version":"2.0"}})"; // 27 bytes
+constexpr std::string_view c_bin  = "0123456789ab";
+
+// Header, a JSON chunk padded with spaces to 4 bytes, and optionally a BIN chunk
+auto make_glb(const std::string_view json, const std::string_view bin, const bool with_bin) -> std::vector<std::byte>
+{
+    std::string padded_json{json};
+    while ((padded_json.size() % 4) != 0) {
+        padded_json.push_back(' ');
+    }
+    const std::size_t length = 12 + 8 + padded_json.size() + (with_bin ? (8 + bin.size()) : 0);
+    std::vector<std::byte> glb;
+    append_u32  (glb, glb_magic);
+    append_u32  (glb, 2);
+    append_u32  (glb, static_cast<uint32_t>(length));
+    append_u32  (glb, static_cast<uint32_t>(padded_json.size()));
+    append_u32  (glb, glb_chunk_json);
+    append_bytes(glb, padded_json);
+    if (with_bin) {
+        append_u32  (glb, static_cast<uint32_t>(bin.size()));
+        append_u32  (glb, glb_chunk_bin);
+        append_bytes(glb, bin);
+    }
+    return glb;
+}
+
+// Offsets into make_glb(c_json, ...) output: the JSON chunk is padded to 28 bytes
+constexpr std::size_t c_length_offset     = 8;
+constexpr std::size_t c_json_type_offset  = 16;
+constexpr std::size_t c_bin_header_offset = 12 + 8 + 28;
+
+TEST(SplitGlb, JsonAndBin)
+{
+    const std::vector<std::byte>    glb    = make_glb(c_json, c_bin, true);
+    const std::optional<Glb_chunks> chunks = split_glb(glb);
+    ASSERT_TRUE(chunks.has_value());
+    EXPECT_EQ(to_string(chunks->json), std::string{c_json} + " ");
+    EXPECT_EQ(to_string(chunks->bin), c_bin);
+    // Views into the input, not copies
+    EXPECT_EQ(chunks->json.data(), glb.data() + 20);
+    EXPECT_EQ(chunks->bin.data(),  glb.data() + c_bin_header_offset + 8);
+}
+
+TEST(SplitGlb, JsonOnly)
+{
+    const std::vector<std::byte>    glb    = make_glb(c_json, {}, false);
+    const std::optional<Glb_chunks> chunks = split_glb(glb);
+    ASSERT_TRUE(chunks.has_value());
+    EXPECT_EQ(chunks->json.size(), 28u);
+    EXPECT_TRUE(chunks->bin.empty());
+}
+
+TEST(SplitGlb, TrailingBytesAreIgnored)
+{
+    std::vector<std::byte> glb = make_glb(c_json, c_bin, true);
+    append_bytes(glb, "trailing");
+    const std::optional<Glb_chunks> chunks = split_glb(glb);
+    ASSERT_TRUE(chunks.has_value());
+    EXPECT_EQ(to_string(chunks->bin), c_bin);
+}
+
+TEST(SplitGlb, RejectsInvalidHeaders)
+{
+    EXPECT_FALSE(split_glb({}).has_value());
+
+    // A .gltf file is JSON, not a GLB
+    std::vector<std::byte> gltf_json;
+    append_bytes(gltf_json, R"({"asset":{"version":"2.0"},"buffers":[]})");
+    EXPECT_FALSE(split_glb(gltf_json).has_value());
+
+    std::vector<std::byte> bad_magic = make_glb(c_json, c_bin, true);
+    bad_magic[0] = std::byte{'G'};
+    EXPECT_FALSE(split_glb(bad_magic).has_value());
+
+    std::vector<std::byte> bad_version = make_glb(c_json, c_bin, true);
+    set_u32(bad_version, 4, 1);
+    EXPECT_FALSE(split_glb(bad_version).has_value());
+
+    std::vector<std::byte> short_length = make_glb(c_json, c_bin, true);
+    set_u32(short_length, c_length_offset, 12);
+    EXPECT_FALSE(split_glb(short_length).has_value());
+}
+
+TEST(SplitGlb, RejectsInvalidChunks)
+{
+    // The first chunk must be JSON
+    std::vector<std::byte> bin_first = make_glb(c_json, c_bin, true);
+    set_u32(bin_first, c_json_type_offset, glb_chunk_bin);
+    EXPECT_FALSE(split_glb(bin_first).has_value());
+
+    // A second chunk must be BIN
+    std::vector<std::byte> two_json = make_glb(c_json, c_bin, true);
+    set_u32(two_json, c_bin_header_offset + 4, glb_chunk_json);
+    EXPECT_FALSE(split_glb(two_json).has_value());
+
+    // Chunk lengths past the header length
+    std::vector<std::byte> long_json = make_glb(c_json, c_bin, true);
+    set_u32(long_json, 12, 0x7fffffffu);
+    EXPECT_FALSE(split_glb(long_json).has_value());
+
+    std::vector<std::byte> long_bin = make_glb(c_json, c_bin, true);
+    set_u32(long_bin, c_bin_header_offset, static_cast<uint32_t>(c_bin.size() + 1));
+    EXPECT_FALSE(split_glb(long_bin).has_value());
+}
+
+TEST(SplitGlb, RejectsTruncatedFiles)
+{
+    // The header length covers the whole file; any shorter prefix is truncated
+    const std::vector<std::byte> glb = make_glb(c_json, c_bin, true);
+    for (std::size_t size = 0; size < glb.size(); ++size) {
+        EXPECT_FALSE(split_glb(std::span<const std::byte>{glb.data(), size}).has_value()) << "size " << size;
+    }
+
+    // A header length larger than the data
+    std::vector<std::byte> long_length = make_glb(c_json, c_bin, true);
+    set_u32(long_length, c_length_offset, static_cast<uint32_t>(long_length.size() + 4));
+    EXPECT_FALSE(split_glb(long_length).has_value());
+}
+
+TEST(MakeJsonOnlyGlb, RoundTrip)
+{
+    const std::vector<std::byte>    glb    = make_glb(c_json, c_bin, true);
+    const std::optional<Glb_chunks> chunks = split_glb(glb);
+    ASSERT_TRUE(chunks.has_value());
+
+    const std::vector<std::byte>    json_only        = make_json_only_glb(chunks->json);
+    const std::optional<Glb_chunks> json_only_chunks = split_glb(json_only);
+    ASSERT_TRUE(json_only_chunks.has_value());
+    EXPECT_EQ(to_string(json_only_chunks->json), to_string(chunks->json));
+    // fastgltf treats an empty BIN chunk as absent, so the placeholder is 4 bytes
+    ASSERT_EQ(json_only_chunks->bin.size(), 4u);
+    for (const std::byte b : json_only_chunks->bin) {
+        EXPECT_EQ(b, std::byte{0});
+    }
+    EXPECT_EQ(json_only.size(), 12u + 8u + chunks->json.size() + 8u + 4u);
+}
+
+TEST(MakeJsonOnlyGlb, EmptyJson)
+{
+    const std::vector<std::byte>    json_only = make_json_only_glb({});
+    const std::optional<Glb_chunks> chunks    = split_glb(json_only);
+    ASSERT_TRUE(chunks.has_value());
+    EXPECT_TRUE(chunks->json.empty());
+    EXPECT_EQ(chunks->bin.size(), 4u);
+}
+
+auto as_bytes(const std::string_view text) -> std::span<const std::byte>
+{
+    return std::span<const std::byte>{reinterpret_cast<const std::byte*>(text.data()), text.size()};
+}
+
+// Collects write_glb() output; fails the write numbered fail_at, counting from 0
+class Glb_writer
+{
+public:
+    auto operator()(const std::span<const std::byte> bytes) -> bool
+    {
+        if (write_count++ == fail_at) {
+            return false;
+        }
+        output.insert(output.end(), bytes.begin(), bytes.end());
+        return true;
+    }
+
+    std::size_t            fail_at{std::numeric_limits<std::size_t>::max()};
+    std::size_t            write_count{0};
+    std::vector<std::byte> output;
+};
+
+TEST(WriteGlb, PartsGapsAndPadding)
+{
+    // 14 byte BIN chunk: "abc" at 0, a 3 byte gap, "defgh" at 6, 3 bytes
+    // unused at the end, then 2 bytes of padding
+    const std::array<Glb_bin_part, 2> parts{
+        Glb_bin_part{.offset = 0, .bytes = as_bytes("abc")},
+        Glb_bin_part{.offset = 6, .bytes = as_bytes("defgh")}
+    };
+    Glb_writer writer;
+    ASSERT_TRUE(write_glb(as_bytes(c_json), parts, 14, std::ref(writer)));
+    EXPECT_EQ(writer.output.size(), get_glb_byte_count(c_json.size(), 14));
+    EXPECT_EQ(writer.output.size(), 12u + 8u + 28u + 8u + 16u);
+
+    const std::optional<Glb_chunks> chunks = split_glb(writer.output);
+    ASSERT_TRUE(chunks.has_value());
+    EXPECT_EQ(to_string(chunks->json), std::string{c_json} + " ");
+    EXPECT_EQ(to_string(chunks->bin), std::string("abc\0\0\0defgh\0\0\0\0\0", 16));
+}
+
+TEST(WriteGlb, WithoutBin)
+{
+    Glb_writer writer;
+    ASSERT_TRUE(write_glb(as_bytes(c_json), {}, 0, std::ref(writer)));
+    EXPECT_EQ(writer.output, make_glb(c_json, {}, false));
+    EXPECT_EQ(writer.output.size(), get_glb_byte_count(c_json.size(), 0));
+}
+
+TEST(WriteGlb, MatchesHandWrittenGlb)
+{
+    const std::array<Glb_bin_part, 1> parts{Glb_bin_part{.offset = 0, .bytes = as_bytes(c_bin)}};
+    Glb_writer writer;
+    ASSERT_TRUE(write_glb(as_bytes(c_json), parts, c_bin.size(), std::ref(writer)));
+    EXPECT_EQ(writer.output, make_glb(c_json, c_bin, true));
+}
+
+TEST(WriteGlb, StopsAtFirstFailedWrite)
+{
+    const std::array<Glb_bin_part, 2> parts{
+        Glb_bin_part{.offset = 0, .bytes = as_bytes("abc")},
+        Glb_bin_part{.offset = 6, .bytes = as_bytes("defgh")}
+    };
+    Glb_writer complete;
+    ASSERT_TRUE(write_glb(as_bytes(c_json), parts, 14, std::ref(complete)));
+    for (std::size_t fail_at = 0; fail_at < complete.write_count; ++fail_at) {
+        Glb_writer writer;
+        writer.fail_at = fail_at;
+        EXPECT_FALSE(write_glb(as_bytes(c_json), parts, 14, std::ref(writer))) << "fail_at " << fail_at;
+        EXPECT_EQ(writer.write_count, fail_at + 1) << "fail_at " << fail_at;
+    }
+}
+
+TEST(WriteGlb, RejectsInvalidParts)
+{
+    const auto expect_rejected = [](const std::vector<Glb_bin_part>& parts, const std::size_t bin_byte_count) {
+        Glb_writer writer;
+        EXPECT_FALSE(write_glb(as_bytes(c_json), parts, bin_byte_count, std::ref(writer)));
+        EXPECT_EQ(writer.write_count, 0u);
+    };
+    // Out of order
+    expect_rejected({Glb_bin_part{.offset = 8, .bytes = as_bytes("ab")}, Glb_bin_part{.offset = 0, .bytes = as_bytes("cd")}}, 16);
+    // Overlapping
+    expect_rejected({Glb_bin_part{.offset = 0, .bytes = as_bytes("abcd")}, Glb_bin_part{.offset = 3, .bytes = as_bytes("ef")}}, 16);
+    // Past the end of the chunk
+    expect_rejected({Glb_bin_part{.offset = 14, .bytes = as_bytes("abc")}}, 16);
+    expect_rejected({Glb_bin_part{.offset = 0, .bytes = as_bytes("a")}}, 0);
+}
+
+TEST(WriteGlb, RejectsFilesOver4GiB)
+{
+    Glb_writer writer;
+    EXPECT_FALSE(write_glb(as_bytes(c_json), {}, std::numeric_limits<uint32_t>::max(), std::ref(writer)));
+    EXPECT_EQ(writer.write_count, 0u);
+}
+
+} // anonymous namespace
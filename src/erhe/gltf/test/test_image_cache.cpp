@@ -0,0 +1,223 @@
+// Persistent compressed image cache: a miss, an encode, then a hit returning
+// the BC7 mip chain; keys separating color spaces and contents; scheduled
+// encodes; and trimming least recently used entries to a byte budget. Runs
+// in a temporary working directory, as the cache lives under ./cache.
+
+#include "erhe_gltf/image_cache.hpp"
+
+#include "erhe_dataformat/dataformat.hpp"
+#include "erhe_graphics/image_loader.hpp"
+
+#include <gtest/gtest.h>
+#include <taskflow/taskflow.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace {
+
+using erhe::gltf::Compressed_image_cache_key;
+using erhe::gltf::encode_compressed_image;
+using erhe::gltf::get_compressed_image_cache_path;
+using erhe::gltf::load_compressed_image;
+using erhe::gltf::make_compressed_image_cache_key;
+using erhe::gltf::trim_compressed_image_cache;
+
+// 8 x 8 RGBA8 PNG
+constexpr std::uint8_t c_png[] = {
+    0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00, 0x00, 0x0d, 0x49, 0x48, 0x44, 0x52,
+    0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x08, 0x08, 0x06, 0x00, 0x00, 0x00, 0xc4, 0x0f, 0xbe,
+    0x8b, 0x00, 0x00, 0x00, 0xb3, 0x49, 0x44, 0x41, 0x54, 0x78, 0xda, 0x0d, 0xca, 0xa1, 0x81, 0x02,
+    0x51, 0x0c, 0x45, 0xd1, 0x2f, 0x10, 0x08, 0xc4, 0x08, 0xc4, 0x08, 0xc4, 0x17, 0x08, 0xe4, 0x48,
+    0x04, 0x22, 0x12, 0x89, 0xa0, 0x80, 0x88, 0x2d, 0x00, 0x89, 0x4c, 0x01, 0x88, 0x2d, 0x21, 0x92,
+    0x32, 0x22, 0xb6, 0x90, 0x74, 0x72, 0xf7, 0x89, 0xe3, 0xce, 0x18, 0x63, 0x30, 0xc5, 0xc4, 0x25,
+    0x24, 0xa5, 0xa4, 0x65, 0x8c, 0xa9, 0x30, 0x77, 0xd8, 0xdc, 0xe3, 0xf3, 0x40, 0xcc, 0x85, 0x9c,
+    0x47, 0x6a, 0xae, 0xf4, 0x3c, 0x29, 0x98, 0x82, 0xed, 0x31, 0x5b, 0x70, 0x5b, 0x09, 0x9b, 0xa4,
+    0x5d, 0x28, 0xdb, 0x68, 0xbb, 0x2a, 0xb8, 0x82, 0x1f, 0x30, 0x5f, 0x71, 0x3f, 0x13, 0xbe, 0x91,
+    0x7e, 0xa3, 0xfc, 0x4e, 0xfb, 0x53, 0x21, 0x14, 0x62, 0xc1, 0x62, 0xe2, 0xb1, 0x11, 0x61, 0x64,
+    0x3c, 0xa8, 0x70, 0x3a, 0x5e, 0x0a, 0xa9, 0x90, 0x47, 0x2c, 0x2f, 0x78, 0xde, 0x88, 0x7c, 0x90,
+    0xf9, 0x43, 0xe5, 0x9b, 0xce, 0x8f, 0x42, 0x29, 0xd4, 0x8a, 0xd5, 0x86, 0xd7, 0x9d, 0x28, 0x27,
+    0xeb, 0x4d, 0xd5, 0x2f, 0x5d, 0x5f, 0x85, 0x56, 0xe8, 0x13, 0xd6, 0x57, 0xbc, 0x9f, 0x44, 0xbf,
+    0xc8, 0xfe, 0x50, 0xfd, 0xa5, 0xfb, 0x8f, 0x7f, 0x2c, 0xdd, 0x84, 0x01, 0xd2, 0x53, 0x96, 0x83,
+    0x00, 0x00, 0x00, 0x00, 0x49, 0x45, 0x4e, 0x44, 0xae, 0x42, 0x60, 0x82
+};
+
+auto get_png_bytes() -> std::span<const std::byte>
+{
+    return std::span<const std::byte>{reinterpret_cast<const std::byte*>(c_png), sizeof(c_png)};
+}
+
+class Image_cache : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        m_previous_path = std::filesystem::current_path();
+        m_temp_path     = std::filesystem::temp_directory_path() / ("erhe_gltf_image_cache_test_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+        std::filesystem::create_directories(m_temp_path);
+        std::filesystem::current_path(m_temp_path);
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::current_path(m_previous_path);
+        std::error_code error_code{};
+        std::filesystem::remove_all(m_temp_path, error_code);
+    }
+
+    // A stand-in entry of byte_count bytes, last used age ago
+    static void write_fake_entry(const std::uint64_t content_hash, const std::size_t byte_count, const std::chrono::hours age)
+    {
+        const std::filesystem::path path = get_compressed_image_cache_path(
+            Compressed_image_cache_key{.content_hash = content_hash, .byte_count = byte_count, .linear = false}
+        );
+        std::filesystem::create_directories(path.parent_path());
+        {
+            std::ofstream out{path, std::ofstream::binary};
+            const std::vector<char> bytes(byte_count, 'x');
+            out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        }
+        std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now() - age);
+    }
+
+private:
+    std::filesystem::path m_previous_path;
+    std::filesystem::path m_temp_path;
+};
+
+TEST_F(Image_cache, Keys)
+{
+    const Compressed_image_cache_key srgb   = make_compressed_image_cache_key(get_png_bytes(), false);
+    const Compressed_image_cache_key linear = make_compressed_image_cache_key(get_png_bytes(), true);
+    EXPECT_EQ(srgb.byte_count, sizeof(c_png));
+    EXPECT_EQ(srgb.content_hash, linear.content_hash);
+    EXPECT_NE(get_compressed_image_cache_path(srgb), get_compressed_image_cache_path(linear));
+
+    const std::span<const std::byte> png_bytes = get_png_bytes();
+    std::vector<std::byte> edited(png_bytes.begin(), png_bytes.end());
+    edited.back() ^= std::byte{1};
+    EXPECT_NE(make_compressed_image_cache_key(edited, false).content_hash, srgb.content_hash);
+
+    EXPECT_TRUE (erhe::gltf::is_compressed_image_cache_candidate(get_png_bytes()));
+    EXPECT_FALSE(erhe::gltf::is_compressed_image_cache_candidate({}));
+}
+
+TEST_F(Image_cache, MissEncodeHit)
+{
+    const Compressed_image_cache_key key = make_compressed_image_cache_key(get_png_bytes(), false);
+
+    erhe::graphics::Image_info info{};
+    std::vector<std::uint8_t>  pixels;
+    EXPECT_FALSE(load_compressed_image(key, info, pixels));
+    EXPECT_TRUE(pixels.empty());
+
+    ASSERT_TRUE(encode_compressed_image(key, get_png_bytes()));
+    EXPECT_TRUE(std::filesystem::is_regular_file(get_compressed_image_cache_path(key)));
+
+    ASSERT_TRUE(load_compressed_image(key, info, pixels));
+    EXPECT_EQ(info.format,      erhe::dataformat::Format::format_bc7_srgb);
+    EXPECT_EQ(info.width,       8);
+    EXPECT_EQ(info.height,      8);
+    EXPECT_EQ(info.level_count, 4);
+    EXPECT_EQ(pixels.size(), erhe::dataformat::get_mip_chain_byte_count(info.format, 8, 8, 4));
+
+    // The same bytes loaded as linear are a different entry
+    const Compressed_image_cache_key linear_key = make_compressed_image_cache_key(get_png_bytes(), true);
+    EXPECT_FALSE(load_compressed_image(linear_key, info, pixels));
+}
+
+TEST_F(Image_cache, UnreadableEntryIsAMiss)
+{
+    const Compressed_image_cache_key key = make_compressed_image_cache_key(get_png_bytes(), false);
+    write_fake_entry(key.content_hash, key.byte_count, std::chrono::hours{0});
+
+    erhe::graphics::Image_info info{};
+    std::vector<std::uint8_t>  pixels;
+    EXPECT_FALSE(load_compressed_image(key, info, pixels));
+
+    // Not an image at all: nothing is written
+    const std::vector<std::byte> garbage(64, std::byte{0x5a});
+    const Compressed_image_cache_key garbage_key = make_compressed_image_cache_key(garbage, false);
+    EXPECT_FALSE(encode_compressed_image(garbage_key, garbage));
+    EXPECT_FALSE(std::filesystem::exists(get_compressed_image_cache_path(garbage_key)));
+}
+
+TEST_F(Image_cache, ScheduledEncode)
+{
+    const Compressed_image_cache_key key = make_compressed_image_cache_key(get_png_bytes(), true);
+    const std::span<const std::byte> png_bytes = get_png_bytes();
+    tf::Executor executor{2};
+    for (int i = 0; i < 3; ++i) {
+        erhe::gltf::schedule_compressed_image_encode(
+            executor,
+            key,
+            std::make_shared<const std::vector<std::byte>>(png_bytes.begin(), png_bytes.end())
+        );
+    }
+    executor.wait_for_all();
+
+    erhe::graphics::Image_info info{};
+    std::vector<std::uint8_t>  pixels;
+    ASSERT_TRUE(load_compressed_image(key, info, pixels));
+    EXPECT_EQ(info.format, erhe::dataformat::Format::format_bc7_unorm);
+}
+
+TEST_F(Image_cache, TrimRemovesLeastRecentlyUsed)
+{
+    write_fake_entry(1, 1000, std::chrono::hours{3});
+    write_fake_entry(2, 1000, std::chrono::hours{1});
+    write_fake_entry(3, 1000, std::chrono::hours{2});
+    const auto exists = [](const std::uint64_t content_hash) {
+        return std::filesystem::exists(
+            get_compressed_image_cache_path(Compressed_image_cache_key{.content_hash = content_hash, .byte_count = 1000, .linear = false})
+        );
+    };
+
+    // Within budget: nothing to do
+    EXPECT_EQ(trim_compressed_image_cache(3000), 0u);
+    EXPECT_TRUE(exists(1) && exists(2) && exists(3));
+
+    // Oldest first
+    EXPECT_EQ(trim_compressed_image_cache(2500), 1u);
+    EXPECT_FALSE(exists(1));
+    EXPECT_TRUE (exists(2));
+    EXPECT_TRUE (exists(3));
+
+    EXPECT_EQ(trim_compressed_image_cache(1000), 1u);
+    EXPECT_TRUE (exists(2));
+    EXPECT_FALSE(exists(3));
+
+    EXPECT_EQ(trim_compressed_image_cache(0), 1u);
+    EXPECT_FALSE(exists(2));
+
+    // No cache directory at all
+    std::filesystem::remove_all("cache");
+    EXPECT_EQ(trim_compressed_image_cache(0), 0u);
+}
+
+TEST_F(Image_cache, HitMarksEntryRecentlyUsed)
+{
+    const Compressed_image_cache_key key = make_compressed_image_cache_key(get_png_bytes(), false);
+    ASSERT_TRUE(encode_compressed_image(key, get_png_bytes()));
+    const std::filesystem::path path = get_compressed_image_cache_path(key);
+    std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now() - std::chrono::hours{5});
+    write_fake_entry(1, 1000, std::chrono::hours{1});
+
+    erhe::graphics::Image_info info{};
+    std::vector<std::uint8_t>  pixels;
+    ASSERT_TRUE(load_compressed_image(key, info, pixels));
+
+    // The hit made the encoded entry the most recent: the fake entry goes
+    EXPECT_EQ(trim_compressed_image_cache(std::filesystem::file_size(path)), 1u);
+    EXPECT_TRUE(std::filesystem::exists(path));
+}
+
+} // anonymous namespace
@@ -0,0 +1,113 @@
+// parse_gltf() on in-memory GLBs: a minimal valid asset, and truncated or
+// malformed input, which must fail with empty Gltf_data instead of reading
+// past the data.
+
+#include "erhe_gltf/glb_container.hpp"
+#include "erhe_gltf/gltf.hpp"
+#include "erhe_scene/node.hpp"
+
+#include <gtest/gtest.h>
+#include <taskflow/taskflow.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+using erhe::gltf::Gltf_data;
+using erhe::gltf::Gltf_parse_arguments;
+
+constexpr std::string_view c_minimal_json =
+    R"({"asset":{"version":"2.0"},"buffers":[{"byteLength":4}],)"
+    R"("scenes":[{"nodes":[0]}],"nodes":[{"name":"a"}],"scene":0})";
+
+void append_u32(std::vector<std::byte>& out, const uint32_t value)
+{
+    for (int shift = 0; shift < 32; shift += 8) {
+        out.push_back(static_cast<std::byte>((value >> shift) & 0xffu));
+    }
+}
+
+auto make_glb(const std::string_view json, const std::size_t bin_size) -> std::vector<std::byte>
+{
+    std::vector<std::byte> json_bytes;
+    for (const char c : json) {
+        json_bytes.push_back(static_cast<std::byte>(c));
+    }
+    while ((json_bytes.size() % 4) != 0) {
+        json_bytes.push_back(std::byte{' '});
+    }
+    const std::size_t length = 12 + 8 + json_bytes.size() + 8 + bin_size;
+    std::vector<std::byte> glb;
+    append_u32(glb, erhe::gltf::glb_magic);
+    append_u32(glb, 2);
+    append_u32(glb, static_cast<uint32_t>(length));
+    append_u32(glb, static_cast<uint32_t>(json_bytes.size()));
+    append_u32(glb, erhe::gltf::glb_chunk_json);
+    glb.insert(glb.end(), json_bytes.begin(), json_bytes.end());
+    append_u32(glb, static_cast<uint32_t>(bin_size));
+    append_u32(glb, erhe::gltf::glb_chunk_bin);
+    glb.resize(length, std::byte{0});
+    return glb;
+}
+
+auto parse(const std::span<const std::byte> glb, const bool parallel) -> Gltf_data
+{
+    tf::Executor executor{2};
+    const std::shared_ptr<erhe::scene::Node> root_node = std::make_shared<erhe::scene::Node>("root");
+    return erhe::gltf::parse_gltf(
+        Gltf_parse_arguments{
+            .executor               = executor,
+            .root_node              = root_node,
+            .path                   = "test.glb",
+            .parallel               = parallel,
+            .glb_data               = glb,
+            .compressed_image_cache = false
+        }
+    );
+}
+
+TEST(ParseGltf, MinimalGlb)
+{
+    const std::vector<std::byte> glb = make_glb(c_minimal_json, 4);
+    for (const bool parallel : {false, true}) {
+        const Gltf_data data = parse(glb, parallel);
+        ASSERT_EQ(data.nodes.size(), 1u) << "parallel " << parallel;
+        EXPECT_EQ(data.nodes.front()->get_name(), "a");
+        EXPECT_TRUE(data.meshes.empty());
+    }
+}
+
+TEST(ParseGltf, TruncatedGlbFails)
+{
+    // Every prefix of the file: split_glb() rejects it, and fastgltf then
+    // gets (and rejects) the bytes as they are.
+    const std::vector<std::byte> glb = make_glb(c_minimal_json, 4);
+    for (std::size_t size = 0; size < glb.size(); size += 7) {
+        const Gltf_data data = parse(std::span<const std::byte>{glb.data(), size}, false);
+        EXPECT_TRUE(data.nodes.empty()) << "size " << size;
+    }
+}
+
+TEST(ParseGltf, InvalidJsonFails)
+{
+    const std::vector<std::byte> glb = make_glb(R"({"asset":{"version":"2.0"},"nodes":[{"name":)", 4);
+    EXPECT_TRUE(parse(glb, false).nodes.empty());
+}
+
+TEST(ParseGltf, ShortBinChunkFails)
+{
+    // Buffer 0 declares more bytes than the BIN chunk holds
+    const std::vector<std::byte> glb = make_glb(
+        R"({"asset":{"version":"2.0"},"buffers":[{"byteLength":64}],)"
+        R"("scenes":[{"nodes":[0]}],"nodes":[{"name":"a"}],"scene":0})",
+        4
+    );
+    EXPECT_TRUE(parse(glb, false).nodes.empty());
+}
+
+} // anonymous namespace
@@ -1,24 +1,189 @@
 // #define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_TRACE
 
 #include "erhe_graphics/buffer_transfer_queue.hpp"
+#include "erhe_graphics/blit_command_encoder.hpp"
 #include "erhe_graphics/buffer.hpp"
 #include "erhe_graphics/command_buffer.hpp"
 #include "erhe_graphics/device.hpp"
+#include "erhe_graphics/enums.hpp"
 #include "erhe_graphics/graphics_log.hpp"
+#include "erhe_graphics/ring_buffer.hpp"
 #include "erhe_profile/profile.hpp"
+#include "erhe_verify/verify.hpp"
 
 #include <fmt/format.h>
 
 namespace erhe::graphics {
 
-Buffer_transfer_queue::Buffer_transfer_queue(Device& device)
-    : m_device{device}
+namespace {
+
+// Buffer to buffer copies need 4 byte aligned offsets and sizes on Metal;
+// the ring allocations are aligned to this.
+constexpr std::size_t staging_copy_alignment = 4;
+constexpr std::size_t staging_alignment      = 16;
+
+} // anonymous namespace
+
+Buffer_transfer_queue::Buffer_transfer_queue(Device& device, const std::size_t staging_byte_count)
+    : m_device     {device}
+    , m_alive_token{std::make_shared<int>(0)}
 {
+    if (staging_byte_count > 0) {
+        m_staging = std::make_unique<Ring_buffer>(
+            device,
+            Ring_buffer_create_info{
+                .size              = staging_byte_count,
+                .ring_buffer_usage = Ring_buffer_usage::CPU_write,
+                .buffer_usage      = Buffer_usage::transfer_src,
+                .debug_label       = "Buffer_transfer_queue staging"
+            }
+        );
+    }
 }
 
 Buffer_transfer_queue::~Buffer_transfer_queue() noexcept
 {
     // flush(); TODO causes GL errors in shutdown, investigate
+
+    // Reservations never committed or flushed are dropped with their data.
+    // Released ranges have their sync entries in the ring, which goes away
+    // with the queue; the completion handlers see the expired token.
+    for (Staging_allocation& allocation : m_staging_allocations) {
+        allocation.range.cancel();
+    }
+}
+
+auto Buffer_transfer_queue::reserve(const Buffer* buffer, const std::size_t offset, const std::size_t byte_count) -> Reservation
+{
+    if (
+        !m_staging ||
+        (byte_count == 0) ||
+        ((offset     % staging_copy_alignment) != 0) ||
+        ((byte_count % staging_copy_alignment) != 0)
+    ) {
+        return {};
+    }
+
+    const std::lock_guard<ERHE_PROFILE_LOCKABLE_BASE(std::mutex)> lock{m_mutex};
+
+    Ring_buffer_range range = m_staging->acquire(staging_alignment, Ring_buffer_usage::CPU_write, byte_count);
+    if (range.get_buffer() == nullptr) {
+        return {}; // ring is full (or byte_count exceeds its capacity)
+    }
+    const std::span<std::byte> bytes = range.get_span();
+    ERHE_VERIFY(bytes.size_bytes() >= byte_count);
+
+    const std::uint64_t id = m_next_staging_id++;
+    m_staging_allocations.push_back(
+        Staging_allocation{
+            .id            = id,
+            .target        = buffer,
+            .target_offset = offset,
+            .byte_count    = byte_count,
+            .range         = std::move(range),
+            .recorded      = false
+        }
+    );
+    return Reservation{
+        .id   = id,
+        .span = std::span<std::uint8_t>{reinterpret_cast<std::uint8_t*>(bytes.data()), byte_count}
+    };
+}
+
+auto Buffer_transfer_queue::get_staging_allocation(const std::uint64_t id) -> Staging_allocation&
+{
+    // Allocations leave from the front only, so ids in the deque are
+    // consecutive.
+    ERHE_VERIFY(!m_staging_allocations.empty());
+    const std::uint64_t front_id = m_staging_allocations.front().id;
+    ERHE_VERIFY((id >= front_id) && ((id - front_id) < m_staging_allocations.size()));
+    Staging_allocation& allocation = m_staging_allocations[static_cast<std::size_t>(id - front_id)];
+    ERHE_VERIFY(allocation.id == id);
+    return allocation;
+}
+
+auto Buffer_transfer_queue::commit(const std::uint64_t reservation_id) -> Ticket
+{
+    const std::lock_guard<ERHE_PROFILE_LOCKABLE_BASE(std::mutex)> lock{m_mutex};
+
+    const Staging_allocation& allocation = get_staging_allocation(reservation_id);
+    const Ticket ticket = m_next_ticket++;
+    m_queued.emplace_back(allocation.target, allocation.target_offset, allocation.byte_count, ticket, reservation_id);
+    return ticket;
+}
+
+void Buffer_transfer_queue::record(Command_buffer& command_buffer, const Transfer_entry& entry)
+{
+    if (entry.staging_id == 0) {
+        command_buffer.upload_to_buffer(*entry.target, entry.target_offset, entry.data.data(), entry.data.size());
+        return;
+    }
+
+    Staging_allocation& allocation = get_staging_allocation(entry.staging_id);
+    allocation.range.bytes_written(allocation.byte_count);
+    allocation.range.close();
+    allocation.recorded = true;
+    Blit_command_encoder blit_encoder = m_device.make_blit_command_encoder(command_buffer);
+    blit_encoder.copy_from_buffer(
+        m_staging->get_buffer(),
+        allocation.range.get_byte_start_offset_in_buffer(),
+        entry.target,
+        entry.target_offset,
+        entry.byte_count
+    );
+}
+
+void Buffer_transfer_queue::finish_recording(Command_buffer& command_buffer, const bool staged_copies)
+{
+    if (!staged_copies) {
+        return;
+    }
+
+    // upload_to_buffer() makes its copies visible to the target's users;
+    // plain buffer copies do not, so cover the ways uploaded buffers are
+    // read: vertex / index input, uniform and storage blocks, indirect
+    // draw commands and later transfers.
+    command_buffer.memory_barrier(
+        Memory_barrier_mask::vertex_attrib_array_barrier_bit |
+        Memory_barrier_mask::element_array_barrier_bit       |
+        Memory_barrier_mask::uniform_barrier_bit             |
+        Memory_barrier_mask::shader_storage_barrier_bit      |
+        Memory_barrier_mask::command_barrier_bit             |
+        Memory_barrier_mask::buffer_update_barrier_bit
+    );
+    release_staging_ranges();
+}
+
+void Buffer_transfer_queue::release_staging_ranges()
+{
+    // The ring reclaims space up to the end of the newest range completed
+    // for a frame, so ranges are released strictly in reservation order: a
+    // recorded range behind a still open (or committed but not yet drained)
+    // one waits for it.
+    bool any_released = false;
+    while (!m_staging_allocations.empty() && m_staging_allocations.front().recorded) {
+        m_staging_allocations.front().range.release();
+        m_staging_allocations.pop_front();
+        any_released = true;
+    }
+    if (!any_released) {
+        return;
+    }
+
+    // The sync entries are for the current frame; standalone ring buffers are
+    // not driven by the device, so reclaim the space from its completion
+    // handler.
+    const uint64_t frame = m_device.get_frame_index();
+    m_device.add_completion_handler(
+        [this, alive = std::weak_ptr<int>{m_alive_token}, frame]()
+        {
+            if (alive.expired()) {
+                return;
+            }
+            const std::lock_guard<ERHE_PROFILE_LOCKABLE_BASE(std::mutex)> lock{m_mutex};
+            m_staging->frame_completed(frame);
+        }
+    );
 }
 
 auto Buffer_transfer_queue::enqueue(const Buffer* buffer, const std::size_t offset, std::vector<uint8_t>&& data) -> Ticket
@@ -43,6 +208,7 @@ void Buffer_transfer_queue::flush(Command_buffer& command_buffer)
 
     const std::lock_guard<ERHE_PROFILE_LOCKABLE_BASE(std::mutex)> lock{m_mutex};
 
+    bool staged_copies = false;
     for (std::size_t i = m_drain_position, end = m_queued.size(); i < end; ++i) {
         const Transfer_entry& entry = m_queued[i];
         SPDLOG_LOGGER_TRACE(
@@ -51,10 +217,12 @@ void Buffer_transfer_queue::flush(Command_buffer& command_buffer)
             gl::c_str(entry.target.target()),
             entry.target->gl_name(),
             entry.target_offset,
-            entry.data.size()
+            entry.byte_count
         );
-        command_buffer.upload_to_buffer(*entry.target, entry.target_offset, entry.data.data(), entry.data.size());
+        record(command_buffer, entry);
+        staged_copies = staged_copies || (entry.staging_id != 0);
     }
+    finish_recording(command_buffer, staged_copies);
     m_queued.clear();
     m_drain_position = 0;
     // Everything ever enqueued has now been recorded. Taking the watermark
@@ -69,6 +237,7 @@ auto Buffer_transfer_queue::flush_budgeted(Command_buffer& command_buffer, const
 
     const std::lock_guard<ERHE_PROFILE_LOCKABLE_BASE(std::mutex)> lock{m_mutex};
 
+    bool        staged_copies       = false;
     std::size_t recorded_byte_count = 0;
     while (m_drain_position < m_queued.size()) {
         Transfer_entry& entry = m_queued[m_drain_position];
@@ -76,11 +245,12 @@ auto Buffer_transfer_queue::flush_budgeted(Command_buffer& command_buffer, const
         // still goes through as the first entry of a drain (otherwise a mesh
         // bigger than the per-frame budget would never upload at all) but
         // never as a later one.
-        if ((recorded_byte_count > 0) && ((recorded_byte_count + entry.data.size()) > max_byte_count)) {
+        if ((recorded_byte_count > 0) && ((recorded_byte_count + entry.byte_count) > max_byte_count)) {
             break;
         }
-        command_buffer.upload_to_buffer(*entry.target, entry.target_offset, entry.data.data(), entry.data.size());
-        recorded_byte_count += entry.data.size();
+        record(command_buffer, entry);
+        staged_copies        = staged_copies || (entry.staging_id != 0);
+        recorded_byte_count += entry.byte_count;
         m_watermark = entry.ticket; // FIFO: every ticket at or below this is recorded
         entry.data  = std::vector<uint8_t>{}; // recorded; release the staging copy now
         ++m_drain_position;
@@ -88,6 +258,7 @@ auto Buffer_transfer_queue::flush_budgeted(Command_buffer& command_buffer, const
             break;
         }
     }
+    finish_recording(command_buffer, staged_copies);
     if (m_drain_position == m_queued.size()) {
         // Drained to empty: nothing enqueued is outstanding, so the watermark
         // may advance all the way, exactly as a full flush would leave it.
@@ -115,7 +286,7 @@ auto Buffer_transfer_queue::get_queued_byte_count() const -> std::size_t
     const std::lock_guard<ERHE_PROFILE_LOCKABLE_BASE(std::mutex)> lock{m_mutex};
     std::size_t byte_count = 0;
     for (std::size_t i = m_drain_position, end = m_queued.size(); i < end; ++i) {
-        byte_count += m_queued[i].data.size();
+        byte_count += m_queued[i].byte_count;
     }
     return byte_count;
 }
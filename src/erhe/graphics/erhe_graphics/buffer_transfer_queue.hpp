@@ -1,10 +1,14 @@
 #pragma once
 
+#include "erhe_graphics/ring_buffer_range.hpp"
 #include "erhe_profile/profile.hpp"
 
 #include <cstddef>
 #include <cstdint>
+#include <deque>
+#include <memory>
 #include <mutex>
+#include <span>
 #include <vector>
 
 namespace erhe::graphics {
@@ -12,11 +16,15 @@ namespace erhe::graphics {
 class Buffer;
 class Command_buffer;
 class Device;
+class Ring_buffer;
 
 class Buffer_transfer_queue final
 {
 public:
-    explicit Buffer_transfer_queue(Device& device);
+    // staging_byte_count > 0 creates a persistently mapped staging ring of
+    // that size for reserve(). With 0, reserve() always declines and every
+    // transfer goes through enqueue().
+    explicit Buffer_transfer_queue(Device& device, std::size_t staging_byte_count = 0);
     ~Buffer_transfer_queue() noexcept;
     Buffer_transfer_queue(Buffer_transfer_queue&) = delete;
     auto operator=(Buffer_transfer_queue&) -> Buffer_transfer_queue& = delete;
@@ -27,19 +35,32 @@ public:
         Transfer_entry(const Buffer* target, const std::size_t target_offset, std::vector<uint8_t>&& data, const std::uint64_t ticket)
             : target       {target}
             , target_offset{target_offset}
-            , data         {data}
+            , byte_count   {data.size()}
+            , data         {std::move(data)}
             , ticket       {ticket}
         {
         }
 
+        // Bytes already in the staging ring (commit()).
+        Transfer_entry(const Buffer* target, const std::size_t target_offset, const std::size_t byte_count, const std::uint64_t ticket, const std::uint64_t staging_id)
+            : target       {target}
+            , target_offset{target_offset}
+            , byte_count   {byte_count}
+            , ticket       {ticket}
+            , staging_id   {staging_id}
+        {
+        }
+
         Transfer_entry(Transfer_entry&) = delete;
         void operator=(Transfer_entry&) = delete;
 
         Transfer_entry(Transfer_entry&& other) noexcept
             : target       {other.target}
             , target_offset{other.target_offset}
+            , byte_count   {other.byte_count}
             , data         {std::move(other.data)}
             , ticket       {other.ticket}
+            , staging_id   {other.staging_id}
         {
         }
 
@@ -47,8 +68,10 @@ public:
 
         const Buffer*        target       {nullptr};
         std::size_t          target_offset{0};
-        std::vector<uint8_t> data;
+        std::size_t          byte_count   {0};
+        std::vector<uint8_t> data;            // empty when staging_id != 0
         std::uint64_t        ticket       {0};
+        std::uint64_t        staging_id   {0};
     };
 
     // Monotonically increasing per-enqueue id. 0 is "no transfer": a
@@ -77,6 +100,31 @@ public:
 
     auto enqueue(const Buffer* buffer, std::size_t offset, std::vector<uint8_t>&& data) -> Ticket;
 
+    // Zero-copy alternative to enqueue(): reserve() hands out byte_count
+    // writable bytes inside the staging ring, the caller writes the data
+    // there (any thread) and commit() queues the transfer. The flush then
+    // records a buffer to buffer copy from the ring, so the data is never
+    // held in a heap vector nor copied again on the CPU.
+    //
+    // The ticket is assigned by commit(), not reserve(), so ticket order is
+    // FIFO order exactly as for enqueue() and the watermark / budget rules
+    // above are unchanged.
+    //
+    // Returns a reservation with id 0 (and an empty span) when there is no
+    // staging ring, the ring has no room, or offset / byte_count are not
+    // multiples of 4 (Metal buffer copy requirement); the caller then uses
+    // enqueue(). Ring space is reclaimed in reservation order once the frame
+    // that recorded the copy has completed, so a reservation that stays open
+    // for a long time holds back the space of every later one.
+    class Reservation
+    {
+    public:
+        std::uint64_t           id{0};
+        std::span<std::uint8_t> span;
+    };
+    [[nodiscard]] auto reserve(const Buffer* buffer, std::size_t offset, std::size_t byte_count) -> Reservation;
+    auto commit(std::uint64_t reservation_id) -> Ticket;
+
     // Highest ticket enqueued so far. A builder snapshots this after
     // enqueuing everything one mesh needs; the mesh may be drawn once
     // get_watermark() has reached that value.
@@ -88,6 +136,24 @@ public:
     [[nodiscard]] auto get_queued_byte_count() const -> std::size_t;
 
 private:
+    // One reserve(), kept in reservation order until the ring space can be
+    // released.
+    class Staging_allocation
+    {
+    public:
+        std::uint64_t     id           {0};
+        const Buffer*     target       {nullptr};
+        std::size_t       target_offset{0};
+        std::size_t       byte_count   {0};
+        Ring_buffer_range range;
+        bool              recorded     {false};
+    };
+
+    void record                (Command_buffer& command_buffer, const Transfer_entry& entry);
+    void finish_recording      (Command_buffer& command_buffer, bool staged_copies);
+    void release_staging_ranges();
+    [[nodiscard]] auto get_staging_allocation(std::uint64_t id) -> Staging_allocation&;
+
     mutable ERHE_PROFILE_MUTEX(std::mutex, m_mutex);
     std::vector<Transfer_entry>    m_queued;
     // Entries before this index have been recorded and their data released.
@@ -98,6 +164,13 @@ private:
     Device&                        m_device;
     Ticket                         m_next_ticket{1};
     Ticket                         m_watermark  {0};
+
+    std::unique_ptr<Ring_buffer>   m_staging;
+    std::deque<Staging_allocation> m_staging_allocations; // reserve() order, consecutive ids
+    std::uint64_t                  m_next_staging_id{1};
+    // Completion handlers registered by the flushes capture a weak_ptr to
+    // this token, so a handler that outlives the queue does nothing.
+    std::shared_ptr<int>           m_alive_token;
 };
 
 
@@ -1789,6 +1789,12 @@ auto Device_impl::allocate_ring_buffer_entry(
 
 void Device_impl::memory_barrier(const Memory_barrier_mask barriers)
 {
+    // glMemoryBarrier is GL 4.2. Below that there are no incoherent writes
+    // (image stores, SSBOs) to order, and buffer copies such as the
+    // Buffer_transfer_queue staged copies are implicitly ordered.
+    if (m_info.gl_version < 420) {
+        return;
+    }
     gl::memory_barrier(static_cast<gl::Memory_barrier_mask>(barriers)); // TODO Proper conversion
 }
 
@@ -1,5 +1,6 @@
 #include "erhe_graphics/image_loader_ktx2.hpp"
 #include "erhe_graphics/graphics_log.hpp"
+#include "erhe_graphics/ktx2_container.hpp"
 #include "erhe_profile/profile.hpp"
 
 #include <transcoder/basisu_transcoder.h>
@@ -99,6 +100,8 @@ public:
     std::vector<std::uint8_t>            owned_data;   // backing storage for the path-based open()
     Image_info                           info;
     basist::transcoder_texture_format    transcoder_format{basist::transcoder_texture_format::cTFRGBA32};
+    Ktx2_plain_image                     plain_image;  // levels are views into the buffer passed to open()
+    bool                                 is_plain{false};
     bool                                 is_open{false};
 };
 
@@ -152,9 +155,39 @@ auto Image_loader_ktx2::open(const std::span<const std::uint8_t>& buffer_view, I
     // first, because the file-based open() forwards here after filling
     // owned_data - and close() would discard it. The transcoder init below
     // resets any previous state.
+    m_state->is_open  = false;
+    m_state->is_plain = false;
+
+    // Plain KTX2 (concrete vkFormat, no supercompression), as written by the
+    // compressed image cache: the levels are uploaded as stored. As with DX10
+    // DDS headers the vkFormat is authoritative, so linear is not consulted,
+    // and neither is the transcode preference - the caller only opens these
+    // for formats the device supports.
+    const std::span<const std::byte> bytes{reinterpret_cast<const std::byte*>(buffer_view.data()), buffer_view.size()};
+    if (is_plain_ktx2(bytes)) {
+        Ktx2_plain_image& plain_image = m_state->plain_image;
+        if (!parse_plain_ktx2(bytes, plain_image)) {
+            return false;
+        }
+        const bool is_compressed = erhe::dataformat::is_block_compressed(plain_image.format);
+        m_state->info = Image_info{
+            .width       = plain_image.width,
+            .height      = plain_image.height,
+            .depth       = 1,
+            .level_count = plain_image.level_count,
+            .row_stride  = is_compressed
+                ? 0 // block-compressed data is tightly packed
+                : plain_image.width * static_cast<int>(erhe::dataformat::get_format_size_bytes(plain_image.format)),
+            .format      = plain_image.format
+        };
+        image_info        = m_state->info;
+        m_state->is_plain = true;
+        m_state->is_open  = true;
+        return true;
+    }
+
     ensure_basisu_transcoder_init();
 
-    m_state->is_open = false;
     basist::ktx2_transcoder& transcoder = m_state->transcoder;
     if (!transcoder.init(buffer_view.data(), static_cast<std::uint32_t>(buffer_view.size()))) {
         log_texture->warn("KTX2: container parse failed");
@@ -269,6 +302,22 @@ auto Image_loader_ktx2::load(std::span<std::uint8_t> transfer_buffer) -> bool
     }
     const bool is_compressed = erhe::dataformat::is_block_compressed(format);
 
+    if (m_state->is_plain) {
+        // parse_plain_ktx2() checks each level against its extent, so the
+        // levels add up to total_byte_count; check every copy anyway rather
+        // than rely on that from here.
+        std::size_t write_offset = 0;
+        for (const std::span<const std::byte>& level : m_state->plain_image.levels) {
+            if (level.size() > transfer_buffer.size() - write_offset) {
+                log_texture->warn("KTX2: level data exceeds transfer buffer: {} + {} > {}", write_offset, level.size(), transfer_buffer.size());
+                return false;
+            }
+            std::memcpy(transfer_buffer.data() + write_offset, level.data(), level.size());
+            write_offset += level.size();
+        }
+        return true;
+    }
+
     // All levels are written contiguously, largest-first, tightly packed -
     // the same layout Image_loader_dds produces and upload_to_texture expects.
     std::size_t write_offset = 0;
@@ -304,7 +353,9 @@ auto Image_loader_ktx2::load(std::span<std::uint8_t> transfer_buffer) -> bool
 
 void Image_loader_ktx2::close()
 {
-    m_state->is_open = false;
+    m_state->is_open  = false;
+    m_state->is_plain = false;
+    m_state->plain_image.levels.clear();
     m_state->owned_data.clear();
 }
 
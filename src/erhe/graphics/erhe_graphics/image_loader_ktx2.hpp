@@ -24,7 +24,10 @@ class Image_loader_ktx2_impl_state;
 // the file's mip count, load() writes all levels contiguously,
 // largest-first, tightly packed - same contract as Image_loader_dds).
 // With the rgba8 preference the image is transcoded to 8-bit RGBA, mip
-// level 0 only; the GPU mipmap generation path rebuilds the chain. Used by
+// level 0 only; the GPU mipmap generation path rebuilds the chain. Plain
+// KTX2 files (a concrete vkFormat, no supercompression - see
+// ktx2_container.hpp) bypass the transcoder: their levels are exposed as
+// stored, in the file's format, whatever the preference. Used by
 // Image_loader, which routes to this class on the KTX2 magic; same
 // open/load contract: the buffer passed to open() must stay alive until
 // load() has been called.
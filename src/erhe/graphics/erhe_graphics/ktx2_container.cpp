@@ -0,0 +1,340 @@
+#include "erhe_graphics/ktx2_container.hpp"
+#include "erhe_graphics/graphics_log.hpp"
+#include "erhe_profile/profile.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace erhe::graphics {
+
+namespace {
+
+constexpr std::uint8_t ktx2_identifier[12] = {
+    0xABu, 0x4Bu, 0x54u, 0x58u, 0x20u, 0x32u, 0x30u, 0xBBu, 0x0Du, 0x0Au, 0x1Au, 0x0Au
+};
+
+constexpr std::size_t header_byte_count      = 80; // identifier, 9 header words, index
+constexpr std::size_t level_index_entry_size = 24; // byteOffset, byteLength, uncompressedByteLength
+
+// Khronos Data Format descriptor values used by make_plain_ktx2()
+constexpr std::uint8_t khr_df_model_rgbsda         = 1;
+constexpr std::uint8_t khr_df_model_bc7            = 134;
+constexpr std::uint8_t khr_df_primaries_bt709      = 1;
+constexpr std::uint8_t khr_df_transfer_linear      = 1;
+constexpr std::uint8_t khr_df_transfer_srgb        = 2;
+constexpr std::uint8_t khr_df_channel_alpha        = 15;
+constexpr std::uint8_t khr_df_sample_linear        = 0x10u; // qualifier: alpha of an sRGB format stays linear
+
+[[nodiscard]] auto read_u32(const std::span<const std::byte> bytes, const std::size_t offset) -> std::uint32_t
+{
+    std::uint32_t value = 0;
+    std::memcpy(&value, bytes.data() + offset, sizeof(value)); // KTX2 is little-endian, as are all targets
+    return value;
+}
+
+[[nodiscard]] auto read_u64(const std::span<const std::byte> bytes, const std::size_t offset) -> std::uint64_t
+{
+    std::uint64_t value = 0;
+    std::memcpy(&value, bytes.data() + offset, sizeof(value));
+    return value;
+}
+
+void write_u8(std::vector<std::uint8_t>& out, const std::uint8_t value)
+{
+    out.push_back(value);
+}
+
+void write_u16(std::vector<std::uint8_t>& out, const std::uint16_t value)
+{
+    const std::size_t offset = out.size();
+    out.resize(offset + sizeof(value));
+    std::memcpy(out.data() + offset, &value, sizeof(value));
+}
+
+void write_u32(std::vector<std::uint8_t>& out, const std::uint32_t value)
+{
+    const std::size_t offset = out.size();
+    out.resize(offset + sizeof(value));
+    std::memcpy(out.data() + offset, &value, sizeof(value));
+}
+
+void write_u64(std::vector<std::uint8_t>& out, const std::uint64_t value)
+{
+    const std::size_t offset = out.size();
+    out.resize(offset + sizeof(value));
+    std::memcpy(out.data() + offset, &value, sizeof(value));
+}
+
+void patch_u32(std::vector<std::uint8_t>& out, const std::size_t offset, const std::uint32_t value)
+{
+    std::memcpy(out.data() + offset, &value, sizeof(value));
+}
+
+void patch_u64(std::vector<std::uint8_t>& out, const std::size_t offset, const std::uint64_t value)
+{
+    std::memcpy(out.data() + offset, &value, sizeof(value));
+}
+
+void write_dfd_sample(
+    std::vector<std::uint8_t>& out,
+    const std::uint16_t        bit_offset,
+    const std::uint8_t         bit_count,
+    const std::uint8_t         channel_and_qualifiers,
+    const std::uint32_t        upper
+)
+{
+    write_u16(out, bit_offset);
+    write_u8 (out, static_cast<std::uint8_t>(bit_count - 1));
+    write_u8 (out, channel_and_qualifiers);
+    write_u32(out, 0); // sample position 0, 0, 0, 0
+    write_u32(out, 0); // sample lower
+    write_u32(out, upper);
+}
+
+} // anonymous namespace
+
+auto get_ktx2_vk_format(const erhe::dataformat::Format format) -> std::uint32_t
+{
+    using erhe::dataformat::Format;
+    switch (format) {
+        case Format::format_8_vec4_unorm:   return 37;  // VK_FORMAT_R8G8B8A8_UNORM
+        case Format::format_8_vec4_srgb:    return 43;  // VK_FORMAT_R8G8B8A8_SRGB
+        case Format::format_bc1_rgb_unorm:  return 131; // VK_FORMAT_BC1_RGB_UNORM_BLOCK
+        case Format::format_bc1_rgb_srgb:   return 132;
+        case Format::format_bc1_rgba_unorm: return 133;
+        case Format::format_bc1_rgba_srgb:  return 134;
+        case Format::format_bc2_unorm:      return 135;
+        case Format::format_bc2_srgb:       return 136;
+        case Format::format_bc3_unorm:      return 137;
+        case Format::format_bc3_srgb:       return 138;
+        case Format::format_bc4_unorm:      return 139;
+        case Format::format_bc4_snorm:      return 140;
+        case Format::format_bc5_unorm:      return 141;
+        case Format::format_bc5_snorm:      return 142;
+        case Format::format_bc6h_ufloat:    return 143;
+        case Format::format_bc6h_sfloat:    return 144;
+        case Format::format_bc7_unorm:      return 145; // VK_FORMAT_BC7_UNORM_BLOCK
+        case Format::format_bc7_srgb:       return 146;
+        case Format::format_astc_4x4_unorm: return 157; // VK_FORMAT_ASTC_4x4_UNORM_BLOCK
+        case Format::format_astc_4x4_srgb:  return 158;
+        default:                            return 0;
+    }
+}
+
+auto get_format_from_ktx2_vk_format(const std::uint32_t vk_format) -> erhe::dataformat::Format
+{
+    using erhe::dataformat::Format;
+    switch (vk_format) {
+        case 37:  return Format::format_8_vec4_unorm;
+        case 43:  return Format::format_8_vec4_srgb;
+        case 131: return Format::format_bc1_rgb_unorm;
+        case 132: return Format::format_bc1_rgb_srgb;
+        case 133: return Format::format_bc1_rgba_unorm;
+        case 134: return Format::format_bc1_rgba_srgb;
+        case 135: return Format::format_bc2_unorm;
+        case 136: return Format::format_bc2_srgb;
+        case 137: return Format::format_bc3_unorm;
+        case 138: return Format::format_bc3_srgb;
+        case 139: return Format::format_bc4_unorm;
+        case 140: return Format::format_bc4_snorm;
+        case 141: return Format::format_bc5_unorm;
+        case 142: return Format::format_bc5_snorm;
+        case 143: return Format::format_bc6h_ufloat;
+        case 144: return Format::format_bc6h_sfloat;
+        case 145: return Format::format_bc7_unorm;
+        case 146: return Format::format_bc7_srgb;
+        case 157: return Format::format_astc_4x4_unorm;
+        case 158: return Format::format_astc_4x4_srgb;
+        default:  return Format::format_undefined;
+    }
+}
+
+auto is_plain_ktx2(const std::span<const std::byte> bytes) -> bool
+{
+    if (bytes.size() < header_byte_count) {
+        return false;
+    }
+    if (std::memcmp(bytes.data(), ktx2_identifier, sizeof(ktx2_identifier)) != 0) {
+        return false;
+    }
+    const std::uint32_t vk_format               = read_u32(bytes, 12);
+    const std::uint32_t supercompression_scheme = read_u32(bytes, 44);
+    return (vk_format != 0) && (supercompression_scheme == 0);
+}
+
+auto parse_plain_ktx2(const std::span<const std::byte> bytes, Ktx2_plain_image& image) -> bool
+{
+    ERHE_PROFILE_FUNCTION();
+
+    if (!is_plain_ktx2(bytes)) {
+        log_texture->warn("KTX2: not a plain (non-supercompressed) KTX2 file");
+        return false;
+    }
+    const std::uint32_t vk_format    = read_u32(bytes, 12);
+    const std::uint32_t pixel_width  = read_u32(bytes, 20);
+    const std::uint32_t pixel_height = read_u32(bytes, 24);
+    const std::uint32_t pixel_depth  = read_u32(bytes, 28);
+    const std::uint32_t layer_count  = read_u32(bytes, 32);
+    const std::uint32_t face_count   = read_u32(bytes, 36);
+    const std::uint32_t level_count  = std::max(read_u32(bytes, 40), 1u); // 0: the loader is asked to generate mipmaps
+
+    const erhe::dataformat::Format format = get_format_from_ktx2_vk_format(vk_format);
+    if (format == erhe::dataformat::Format::format_undefined) {
+        log_texture->warn("KTX2: unsupported vkFormat {}", vk_format);
+        return false;
+    }
+    if ((pixel_width == 0) || (pixel_height == 0) || (pixel_depth != 0) || (layer_count > 1) || (face_count != 1)) {
+        log_texture->warn(
+            "KTX2: only 2D images are supported (width {}, height {}, depth {}, layers {}, faces {})",
+            pixel_width, pixel_height, pixel_depth, layer_count, face_count
+        );
+        return false;
+    }
+    if ((level_count > 32) || (header_byte_count + level_count * level_index_entry_size > bytes.size())) {
+        log_texture->warn("KTX2: truncated level index");
+        return false;
+    }
+
+    image.format      = format;
+    image.width       = static_cast<int>(pixel_width);
+    image.height      = static_cast<int>(pixel_height);
+    image.level_count = static_cast<int>(level_count);
+    image.levels.clear();
+    for (std::uint32_t level = 0; level < level_count; ++level) {
+        const std::size_t   entry_offset = header_byte_count + level * level_index_entry_size;
+        const std::uint64_t byte_offset  = read_u64(bytes, entry_offset);
+        const std::uint64_t byte_length  = read_u64(bytes, entry_offset + 8);
+        const std::size_t   expected     = erhe::dataformat::get_image_level_size_bytes(
+            format,
+            std::max(std::size_t{1}, static_cast<std::size_t>(pixel_width)  >> level),
+            std::max(std::size_t{1}, static_cast<std::size_t>(pixel_height) >> level)
+        );
+        if ((byte_offset > bytes.size()) || (byte_length > bytes.size() - byte_offset) || (byte_length != expected)) {
+            log_texture->warn("KTX2: level {} out of range or of unexpected size ({} bytes, expected {})", level, byte_length, expected);
+            image.levels.clear();
+            return false;
+        }
+        image.levels.push_back(bytes.subspan(static_cast<std::size_t>(byte_offset), static_cast<std::size_t>(byte_length)));
+    }
+    return true;
+}
+
+auto make_plain_ktx2(
+    const erhe::dataformat::Format      format,
+    const int                           width,
+    const int                           height,
+    const int                           level_count,
+    const std::span<const std::uint8_t> mip_chain
+) -> std::vector<std::uint8_t>
+{
+    ERHE_PROFILE_FUNCTION();
+
+    using erhe::dataformat::Format;
+    const bool is_rgba8 = (format == Format::format_8_vec4_unorm) || (format == Format::format_8_vec4_srgb);
+    const bool is_bc7   = (format == Format::format_bc7_unorm)    || (format == Format::format_bc7_srgb);
+    const bool is_srgb  = (format == Format::format_8_vec4_srgb)  || (format == Format::format_bc7_srgb);
+    if (!is_rgba8 && !is_bc7) {
+        log_texture->warn("KTX2: writing format {} is not supported", erhe::dataformat::c_str(format));
+        return {};
+    }
+    if ((width <= 0) || (height <= 0) || (level_count <= 0)) {
+        return {};
+    }
+    const std::size_t chain_byte_count = erhe::dataformat::get_mip_chain_byte_count(
+        format,
+        static_cast<std::size_t>(width),
+        static_cast<std::size_t>(height),
+        static_cast<std::size_t>(level_count)
+    );
+    if (mip_chain.size() < chain_byte_count) {
+        log_texture->warn("KTX2: mip chain too small: {} < {}", mip_chain.size(), chain_byte_count);
+        return {};
+    }
+
+    std::vector<std::uint8_t> out;
+    const std::size_t level_count_size = static_cast<std::size_t>(level_count);
+    out.reserve(header_byte_count + level_count_size * level_index_entry_size + 128 + chain_byte_count + level_count_size * 16);
+
+    out.insert(out.end(), std::begin(ktx2_identifier), std::end(ktx2_identifier));
+    write_u32(out, get_ktx2_vk_format(format));
+    write_u32(out, 1); // typeSize
+    write_u32(out, static_cast<std::uint32_t>(width));
+    write_u32(out, static_cast<std::uint32_t>(height));
+    write_u32(out, 0); // pixelDepth
+    write_u32(out, 0); // layerCount
+    write_u32(out, 1); // faceCount
+    write_u32(out, static_cast<std::uint32_t>(level_count));
+    write_u32(out, 0); // supercompressionScheme
+    const std::size_t index_offset = out.size();
+    write_u32(out, 0); // dfdByteOffset, patched below
+    write_u32(out, 0); // dfdByteLength
+    write_u32(out, 0); // kvdByteOffset
+    write_u32(out, 0); // kvdByteLength
+    write_u64(out, 0); // sgdByteOffset
+    write_u64(out, 0); // sgdByteLength
+    const std::size_t level_index_offset = out.size();
+    out.resize(out.size() + level_count_size * level_index_entry_size);
+
+    // Basic data format descriptor block
+    const std::size_t dfd_offset   = out.size();
+    const int         sample_count = is_rgba8 ? 4 : 1;
+    const std::uint32_t dfd_block_size = 24 + 16 * static_cast<std::uint32_t>(sample_count);
+    write_u32(out, 4 + dfd_block_size);   // dfdTotalSize
+    write_u32(out, 0);                    // vendorId 0 (Khronos), descriptorType 0 (basic)
+    write_u16(out, 2);                    // versionNumber
+    write_u16(out, static_cast<std::uint16_t>(dfd_block_size));
+    write_u8 (out, is_rgba8 ? khr_df_model_rgbsda : khr_df_model_bc7);
+    write_u8 (out, khr_df_primaries_bt709);
+    write_u8 (out, is_srgb ? khr_df_transfer_srgb : khr_df_transfer_linear);
+    write_u8 (out, 0);                    // flags: straight alpha
+    const std::uint8_t block_dimension = is_rgba8 ? 0 : 3; // texel block extent minus one
+    write_u8 (out, block_dimension);
+    write_u8 (out, block_dimension);
+    write_u8 (out, 0);
+    write_u8 (out, 0);
+    write_u8 (out, static_cast<std::uint8_t>(is_rgba8 ? 4 : 16)); // bytesPlane0
+    for (int i = 1; i < 8; ++i) {
+        write_u8(out, 0);
+    }
+    if (is_rgba8) {
+        write_dfd_sample(out,  0, 8, 0, 255);
+        write_dfd_sample(out,  8, 8, 1, 255);
+        write_dfd_sample(out, 16, 8, 2, 255);
+        write_dfd_sample(out, 24, 8, static_cast<std::uint8_t>(khr_df_channel_alpha | (is_srgb ? khr_df_sample_linear : 0u)), 255);
+    } else {
+        write_dfd_sample(out, 0, 128, 0, 0xFFFFFFFFu); // KHR_DF_BC7_COLOR
+    }
+    patch_u32(out, index_offset + 0, static_cast<std::uint32_t>(dfd_offset));
+    patch_u32(out, index_offset + 4, static_cast<std::uint32_t>(out.size() - dfd_offset));
+
+    // Level data, smallest level first, each aligned to lcm(block size, 4).
+    const std::size_t alignment = erhe::dataformat::get_block_size_bytes(format) == 16 ? 16 : 4;
+    std::vector<std::size_t> level_source_offsets(level_count_size);
+    std::size_t source_offset = 0;
+    for (int level = 0; level < level_count; ++level) {
+        level_source_offsets[static_cast<std::size_t>(level)] = source_offset;
+        source_offset += erhe::dataformat::get_image_level_size_bytes(
+            format,
+            std::max(std::size_t{1}, static_cast<std::size_t>(width)  >> level),
+            std::max(std::size_t{1}, static_cast<std::size_t>(height) >> level)
+        );
+    }
+    for (int level = level_count - 1; level >= 0; --level) {
+        const std::size_t level_byte_count = erhe::dataformat::get_image_level_size_bytes(
+            format,
+            std::max(std::size_t{1}, static_cast<std::size_t>(width)  >> level),
+            std::max(std::size_t{1}, static_cast<std::size_t>(height) >> level)
+        );
+        out.resize((out.size() + alignment - 1) / alignment * alignment);
+        const std::size_t level_offset = out.size();
+        const std::uint8_t* source = mip_chain.data() + level_source_offsets[static_cast<std::size_t>(level)];
+        out.insert(out.end(), source, source + level_byte_count);
+        const std::size_t entry_offset = level_index_offset + static_cast<std::size_t>(level) * level_index_entry_size;
+        patch_u64(out, entry_offset +  0, level_offset);
+        patch_u64(out, entry_offset +  8, level_byte_count);
+        patch_u64(out, entry_offset + 16, level_byte_count); // uncompressedByteLength
+    }
+    return out;
+}
+
+} // namespace erhe::graphics
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "erhe_dataformat/dataformat.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace erhe::graphics {
+
+// Plain (not supercompressed) KTX2 containers: a 2D image with a concrete
+// vkFormat and its mip levels stored as-is. Image_loader_ktx2 hands these
+// to the GPU directly; Basis Universal files (vkFormat undefined) keep going
+// through the transcoder. Written by the compressed image cache.
+
+// Returns the VkFormat value for format, or 0 (VK_FORMAT_UNDEFINED) when
+// format has no plain KTX2 mapping here.
+[[nodiscard]] auto get_ktx2_vk_format(erhe::dataformat::Format format) -> std::uint32_t;
+
+// Inverse of get_ktx2_vk_format(); format_undefined for anything else.
+[[nodiscard]] auto get_format_from_ktx2_vk_format(std::uint32_t vk_format) -> erhe::dataformat::Format;
+
+class Ktx2_plain_image
+{
+public:
+    erhe::dataformat::Format                format{erhe::dataformat::Format::format_undefined};
+    int                                     width      {0};
+    int                                     height     {0};
+    int                                     level_count{0};
+    std::vector<std::span<const std::byte>> levels; // level 0 first; views into the container bytes
+};
+
+// True when bytes is a KTX2 file with a non-zero vkFormat and no
+// supercompression. Does not validate the rest of the file.
+[[nodiscard]] auto is_plain_ktx2(std::span<const std::byte> bytes) -> bool;
+
+// Parses a plain KTX2 2D image (no array layers, one face, depth 0). Fails
+// (returns false, after logging) for anything else, including a level whose
+// byte count does not match its extent, or an out of range level index.
+[[nodiscard]] auto parse_plain_ktx2(std::span<const std::byte> bytes, Ktx2_plain_image& image) -> bool;
+
+// Serializes a plain KTX2 file. mip_chain holds level_count levels,
+// largest-first, tightly packed (the Image_loader load() contract). The
+// file stores them smallest-first, as the KTX2 specification recommends,
+// with a minimal basic data format descriptor. Returns an empty vector when
+// format has no vkFormat mapping or mip_chain is too small.
+[[nodiscard]] auto make_plain_ktx2(
+    erhe::dataformat::Format      format,
+    int                           width,
+    int                           height,
+    int                           level_count,
+    std::span<const std::uint8_t> mip_chain
+) -> std::vector<std::uint8_t>;
+
+} // namespace erhe::graphics
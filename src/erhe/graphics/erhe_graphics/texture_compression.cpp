@@ -0,0 +1,407 @@
+#include "erhe_graphics/texture_compression.hpp"
+#include "erhe_dataformat/dataformat.hpp"
+#include "erhe_profile/profile.hpp"
+#include "erhe_verify/verify.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+namespace erhe::graphics {
+
+namespace {
+
+constexpr std::array<int, 16> bc7_weights_4{0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+class Srgb_tables
+{
+public:
+    Srgb_tables()
+    {
+        for (int i = 0; i < 256; ++i) {
+            to_linear[i] = erhe::dataformat::srgb_to_linear(static_cast<float>(i) / 255.0f);
+        }
+    }
+
+    [[nodiscard]] auto to_srgb_byte(const float linear) const -> std::uint8_t
+    {
+        const float srgb = erhe::dataformat::linear_rgb_to_srgb(std::clamp(linear, 0.0f, 1.0f));
+        return static_cast<std::uint8_t>(std::lround(std::clamp(srgb, 0.0f, 1.0f) * 255.0f));
+    }
+
+    std::array<float, 256> to_linear{};
+};
+
+[[nodiscard]] auto get_srgb_tables() -> const Srgb_tables&
+{
+    static const Srgb_tables tables{};
+    return tables;
+}
+
+// Endpoints of one candidate encoding: 8-bit values, each of the form
+// (7-bit value << 1) | p-bit, with one p-bit shared by all channels of an
+// endpoint.
+class Bc7_mode6_candidate
+{
+public:
+    std::array<int, 4>           endpoint_0{};
+    std::array<int, 4>           endpoint_1{};
+    int                          p_bit_0{0};
+    int                          p_bit_1{0};
+    std::array<std::uint8_t, 16> indices{};
+    long long                    error{0};
+};
+
+void quantize_endpoint(const std::array<float, 4>& value, const int p_bit, std::array<int, 4>& out)
+{
+    for (std::size_t c = 0; c < 4; ++c) {
+        const int q = static_cast<int>(std::lround((std::clamp(value[c], 0.0f, 255.0f) - static_cast<float>(p_bit)) * 0.5f));
+        out[c] = (std::clamp(q, 0, 127) << 1) | p_bit;
+    }
+}
+
+void assign_indices(const std::array<std::array<int, 4>, 16>& texels, Bc7_mode6_candidate& candidate)
+{
+    std::array<std::array<int, 4>, 16> palette{};
+    for (std::size_t i = 0; i < 16; ++i) {
+        const int w = bc7_weights_4[i];
+        for (std::size_t c = 0; c < 4; ++c) {
+            palette[i][c] = ((64 - w) * candidate.endpoint_0[c] + w * candidate.endpoint_1[c] + 32) >> 6;
+        }
+    }
+    // The weights are within one step of 64 * i / 15, so projecting onto the
+    // endpoint line and checking the neighbours of the rounded position finds
+    // the same index as testing all 16 palette entries.
+    std::array<int, 4> delta{};
+    int delta_length_squared = 0;
+    for (std::size_t c = 0; c < 4; ++c) {
+        delta[c] = candidate.endpoint_1[c] - candidate.endpoint_0[c];
+        delta_length_squared += delta[c] * delta[c];
+    }
+    const float projection_scale = (delta_length_squared > 0) ? 15.0f / static_cast<float>(delta_length_squared) : 0.0f;
+
+    candidate.error = 0;
+    for (std::size_t t = 0; t < 16; ++t) {
+        int dot = 0;
+        for (std::size_t c = 0; c < 4; ++c) {
+            dot += (texels[t][c] - candidate.endpoint_0[c]) * delta[c];
+        }
+        const int estimate  = std::clamp(static_cast<int>(std::lround(static_cast<float>(dot) * projection_scale)), 0, 15);
+        const int first     = std::max(estimate - 1, 0);
+        const int last      = std::min(estimate + 1, 15);
+        long long best_error = -1;
+        std::uint8_t best_index = 0;
+        for (int i = first; i <= last; ++i) {
+            long long error = 0;
+            for (std::size_t c = 0; c < 4; ++c) {
+                const long long d = texels[t][c] - palette[static_cast<std::size_t>(i)][c];
+                error += d * d;
+            }
+            if ((best_error < 0) || (error < best_error)) {
+                best_error = error;
+                best_index = static_cast<std::uint8_t>(i);
+            }
+        }
+        candidate.indices[t] = best_index;
+        candidate.error += best_error;
+    }
+}
+
+// Tries all four p-bit combinations for the unquantized endpoints and keeps
+// the best result in best.
+void try_endpoints(
+    const std::array<std::array<int, 4>, 16>& texels,
+    const std::array<float, 4>&               endpoint_0,
+    const std::array<float, 4>&               endpoint_1,
+    Bc7_mode6_candidate&                      best
+)
+{
+    for (int p_bit_0 = 0; p_bit_0 < 2; ++p_bit_0) {
+        for (int p_bit_1 = 0; p_bit_1 < 2; ++p_bit_1) {
+            Bc7_mode6_candidate candidate{};
+            candidate.p_bit_0 = p_bit_0;
+            candidate.p_bit_1 = p_bit_1;
+            quantize_endpoint(endpoint_0, p_bit_0, candidate.endpoint_0);
+            quantize_endpoint(endpoint_1, p_bit_1, candidate.endpoint_1);
+            assign_indices(texels, candidate);
+            if ((best.error < 0) || (candidate.error < best.error)) {
+                best = candidate;
+            }
+        }
+    }
+}
+
+class Bit_writer
+{
+public:
+    explicit Bit_writer(std::uint8_t* bytes) : m_bytes{bytes}
+    {
+        std::memset(m_bytes, 0, 16);
+    }
+
+    void write(const unsigned int value, const int bit_count)
+    {
+        for (int i = 0; i < bit_count; ++i) {
+            if (((value >> i) & 1u) != 0) {
+                m_bytes[m_position >> 3] |= static_cast<std::uint8_t>(1u << (m_position & 7));
+            }
+            ++m_position;
+        }
+    }
+
+    [[nodiscard]] auto get_position() const -> int { return m_position; }
+
+private:
+    std::uint8_t* m_bytes;
+    int           m_position{0};
+};
+
+} // anonymous namespace
+
+auto get_full_mip_level_count(const int width, const int height) -> int
+{
+    int level_count = 1;
+    int extent = std::max(width, height);
+    while (extent > 1) {
+        extent >>= 1;
+        ++level_count;
+    }
+    return level_count;
+}
+
+auto make_rgba8_mip_chain(
+    const int                           width,
+    const int                           height,
+    const bool                          srgb,
+    const std::span<const std::uint8_t> level_0
+) -> std::vector<std::uint8_t>
+{
+    ERHE_PROFILE_FUNCTION();
+
+    ERHE_VERIFY((width > 0) && (height > 0));
+    ERHE_VERIFY(level_0.size() >= static_cast<std::size_t>(width) * static_cast<std::size_t>(height) * 4);
+
+    const int level_count = get_full_mip_level_count(width, height);
+    const std::size_t byte_count = erhe::dataformat::get_mip_chain_byte_count(
+        erhe::dataformat::Format::format_8_vec4_unorm,
+        static_cast<std::size_t>(width),
+        static_cast<std::size_t>(height),
+        static_cast<std::size_t>(level_count)
+    );
+    std::vector<std::uint8_t> chain(byte_count);
+    std::memcpy(chain.data(), level_0.data(), static_cast<std::size_t>(width) * static_cast<std::size_t>(height) * 4);
+
+    const Srgb_tables& tables = get_srgb_tables();
+    std::size_t src_offset = 0;
+    int         src_width  = width;
+    int         src_height = height;
+    for (int level = 1; level < level_count; ++level) {
+        const int         dst_width  = std::max(1, src_width  >> 1);
+        const int         dst_height = std::max(1, src_height >> 1);
+        const std::size_t dst_offset = src_offset + static_cast<std::size_t>(src_width) * static_cast<std::size_t>(src_height) * 4;
+        const std::uint8_t* src = chain.data() + src_offset;
+        std::uint8_t*       dst = chain.data() + dst_offset;
+        for (int y = 0; y < dst_height; ++y) {
+            const int y0 = std::min(2 * y,     src_height - 1);
+            const int y1 = std::min(2 * y + 1, src_height - 1);
+            for (int x = 0; x < dst_width; ++x) {
+                const int x0 = std::min(2 * x,     src_width - 1);
+                const int x1 = std::min(2 * x + 1, src_width - 1);
+                const std::uint8_t* s[4] = {
+                    src + (static_cast<std::size_t>(y0) * src_width + x0) * 4,
+                    src + (static_cast<std::size_t>(y0) * src_width + x1) * 4,
+                    src + (static_cast<std::size_t>(y1) * src_width + x0) * 4,
+                    src + (static_cast<std::size_t>(y1) * src_width + x1) * 4
+                };
+                std::uint8_t* d = dst + (static_cast<std::size_t>(y) * dst_width + x) * 4;
+                for (int c = 0; c < 3; ++c) {
+                    if (srgb) {
+                        const float sum =
+                            tables.to_linear[s[0][c]] + tables.to_linear[s[1][c]] +
+                            tables.to_linear[s[2][c]] + tables.to_linear[s[3][c]];
+                        d[c] = tables.to_srgb_byte(0.25f * sum);
+                    } else {
+                        d[c] = static_cast<std::uint8_t>((s[0][c] + s[1][c] + s[2][c] + s[3][c] + 2) >> 2);
+                    }
+                }
+                d[3] = static_cast<std::uint8_t>((s[0][3] + s[1][3] + s[2][3] + s[3][3] + 2) >> 2);
+            }
+        }
+        src_offset = dst_offset;
+        src_width  = dst_width;
+        src_height = dst_height;
+    }
+    return chain;
+}
+
+void encode_bc7_block(const std::uint8_t* rgba_texels, std::uint8_t* bc7_block)
+{
+    std::array<std::array<int, 4>, 16> texels{};
+    std::array<float, 4> mean{};
+    for (std::size_t t = 0; t < 16; ++t) {
+        for (std::size_t c = 0; c < 4; ++c) {
+            texels[t][c] = rgba_texels[t * 4 + c];
+            mean[c] += static_cast<float>(texels[t][c]);
+        }
+    }
+    for (float& m : mean) {
+        m *= (1.0f / 16.0f);
+    }
+
+    // Principal axis by power iteration on the 4x4 covariance matrix,
+    // started from the bounding box diagonal.
+    std::array<std::array<float, 4>, 4> covariance{};
+    std::array<float, 4> low {255.0f, 255.0f, 255.0f, 255.0f};
+    std::array<float, 4> high{};
+    for (const std::array<int, 4>& texel : texels) {
+        std::array<float, 4> d{};
+        for (std::size_t c = 0; c < 4; ++c) {
+            d[c] = static_cast<float>(texel[c]) - mean[c];
+            low [c] = std::min(low [c], static_cast<float>(texel[c]));
+            high[c] = std::max(high[c], static_cast<float>(texel[c]));
+        }
+        for (std::size_t i = 0; i < 4; ++i) {
+            for (std::size_t j = 0; j < 4; ++j) {
+                covariance[i][j] += d[i] * d[j];
+            }
+        }
+    }
+    std::array<float, 4> axis{};
+    for (std::size_t c = 0; c < 4; ++c) {
+        axis[c] = high[c] - low[c];
+    }
+    for (int iteration = 0; iteration < 8; ++iteration) {
+        std::array<float, 4> next{};
+        for (std::size_t i = 0; i < 4; ++i) {
+            for (std::size_t j = 0; j < 4; ++j) {
+                next[i] += covariance[i][j] * axis[j];
+            }
+        }
+        const float length = std::sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2] + next[3] * next[3]);
+        if (length < 1e-6f) {
+            break; // constant block, or the diagonal is already exact
+        }
+        for (std::size_t c = 0; c < 4; ++c) {
+            axis[c] = next[c] / length;
+        }
+    }
+    const float axis_length = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2] + axis[3] * axis[3]);
+    if (axis_length > 1e-6f) {
+        for (float& a : axis) {
+            a /= axis_length;
+        }
+    }
+
+    float t_min = 0.0f;
+    float t_max = 0.0f;
+    for (const std::array<int, 4>& texel : texels) {
+        float t = 0.0f;
+        for (std::size_t c = 0; c < 4; ++c) {
+            t += (static_cast<float>(texel[c]) - mean[c]) * axis[c];
+        }
+        t_min = std::min(t_min, t);
+        t_max = std::max(t_max, t);
+    }
+    std::array<float, 4> endpoint_0{};
+    std::array<float, 4> endpoint_1{};
+    for (std::size_t c = 0; c < 4; ++c) {
+        endpoint_0[c] = mean[c] + axis[c] * t_min;
+        endpoint_1[c] = mean[c] + axis[c] * t_max;
+    }
+
+    Bc7_mode6_candidate best{};
+    best.error = -1;
+    try_endpoints(texels, endpoint_0, endpoint_1, best);
+
+    // Least squares refit of both endpoints to the chosen indices.
+    if (best.error > 0) {
+        float aa = 0.0f;
+        float ab = 0.0f;
+        float bb = 0.0f;
+        std::array<float, 4> ax{};
+        std::array<float, 4> bx{};
+        for (std::size_t t = 0; t < 16; ++t) {
+            const float w = static_cast<float>(bc7_weights_4[best.indices[t]]) / 64.0f;
+            const float a = 1.0f - w;
+            aa += a * a;
+            ab += a * w;
+            bb += w * w;
+            for (std::size_t c = 0; c < 4; ++c) {
+                ax[c] += a * static_cast<float>(texels[t][c]);
+                bx[c] += w * static_cast<float>(texels[t][c]);
+            }
+        }
+        const float determinant = aa * bb - ab * ab;
+        if (std::abs(determinant) > 1e-6f) {
+            const float inverse = 1.0f / determinant;
+            for (std::size_t c = 0; c < 4; ++c) {
+                endpoint_0[c] = (bb * ax[c] - ab * bx[c]) * inverse;
+                endpoint_1[c] = (aa * bx[c] - ab * ax[c]) * inverse;
+            }
+            try_endpoints(texels, endpoint_0, endpoint_1, best);
+        }
+    }
+
+    // The anchor (texel 0) index is stored with its top bit implied zero;
+    // swap the endpoints to make that hold.
+    if (best.indices[0] >= 8) {
+        std::swap(best.endpoint_0, best.endpoint_1);
+        std::swap(best.p_bit_0, best.p_bit_1);
+        for (std::uint8_t& index : best.indices) {
+            index = static_cast<std::uint8_t>(15 - index);
+        }
+    }
+
+    Bit_writer writer{bc7_block};
+    writer.write(1u << 6, 7); // mode 6
+    for (std::size_t c = 0; c < 4; ++c) {
+        writer.write(static_cast<unsigned int>(best.endpoint_0[c] >> 1), 7);
+        writer.write(static_cast<unsigned int>(best.endpoint_1[c] >> 1), 7);
+    }
+    writer.write(static_cast<unsigned int>(best.p_bit_0), 1);
+    writer.write(static_cast<unsigned int>(best.p_bit_1), 1);
+    writer.write(best.indices[0], 3);
+    for (std::size_t t = 1; t < 16; ++t) {
+        writer.write(best.indices[t], 4);
+    }
+    ERHE_VERIFY(writer.get_position() == 128);
+}
+
+void encode_bc7_image(
+    const int                           width,
+    const int                           height,
+    const std::span<const std::uint8_t> rgba_texels,
+    const std::span<std::uint8_t>       bc7_blocks
+)
+{
+    ERHE_PROFILE_FUNCTION();
+
+    const int block_count_x = (width  + 3) / 4;
+    const int block_count_y = (height + 3) / 4;
+    ERHE_VERIFY(rgba_texels.size() >= static_cast<std::size_t>(width) * static_cast<std::size_t>(height) * 4);
+    ERHE_VERIFY(bc7_blocks.size() >= static_cast<std::size_t>(block_count_x) * static_cast<std::size_t>(block_count_y) * 16);
+
+    std::array<std::uint8_t, 64> block_texels{};
+    for (int block_y = 0; block_y < block_count_y; ++block_y) {
+        for (int block_x = 0; block_x < block_count_x; ++block_x) {
+            for (int y = 0; y < 4; ++y) {
+                const int source_y = std::min(block_y * 4 + y, height - 1);
+                for (int x = 0; x < 4; ++x) {
+                    const int source_x = std::min(block_x * 4 + x, width - 1);
+                    std::memcpy(
+                        &block_texels[static_cast<std::size_t>(y * 4 + x) * 4],
+                        &rgba_texels[(static_cast<std::size_t>(source_y) * width + source_x) * 4],
+                        4
+                    );
+                }
+            }
+            encode_bc7_block(
+                block_texels.data(),
+                &bc7_blocks[(static_cast<std::size_t>(block_y) * block_count_x + block_x) * 16]
+            );
+        }
+    }
+}
+
+} // namespace erhe::graphics
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace erhe::graphics {
+
+// CPU-side texture compression for the persistent compressed image cache
+// (erhe::gltf image cache). Only the encoder side lives here; the GPU
+// consumes the result through the same tightly packed, largest-first mip
+// chain contract that Image_loader_dds and Image_loader_ktx2 produce.
+
+// Number of levels in a full mip chain down to 1 x 1.
+[[nodiscard]] auto get_full_mip_level_count(int width, int height) -> int;
+
+// Builds the full mip chain of a tightly packed 8-bit RGBA image with a 2x2
+// box filter, level 0 first (copied as-is), every level tightly packed. With
+// srgb the color channels are averaged in linear space, as the GPU mipmap
+// generation path does for sRGB textures; alpha is always averaged as is.
+[[nodiscard]] auto make_rgba8_mip_chain(
+    int                           width,
+    int                           height,
+    bool                          srgb,
+    std::span<const std::uint8_t> level_0
+) -> std::vector<std::uint8_t>;
+
+// Encodes one 4x4 block of 8-bit RGBA texels (row major, 64 bytes) to a
+// 16 byte BC7 block. Uses BC7 mode 6 only (one subset, 7.7.7.7 endpoints
+// plus p-bit, 4 bit indices): endpoints along the principal axis of the
+// block, refined once with a least squares fit. Quality sits between a
+// basic and a "fast" profile of a full BC7 encoder, at a small fraction of
+// the cost - the cache is filled in the background on every first load.
+void encode_bc7_block(const std::uint8_t* rgba_texels, std::uint8_t* bc7_block);
+
+// Encodes one tightly packed 8-bit RGBA level. Edge blocks of sizes that
+// are not a multiple of 4 replicate the last row / column. bc7_blocks must
+// hold ceil(width / 4) * ceil(height / 4) * 16 bytes.
+void encode_bc7_image(
+    int                           width,
+    int                           height,
+    std::span<const std::uint8_t> rgba_texels,
+    std::span<std::uint8_t>       bc7_blocks
+);
+
+} // namespace erhe::graphics
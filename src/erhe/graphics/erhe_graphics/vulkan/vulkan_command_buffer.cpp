@@ -633,6 +633,17 @@ void Command_buffer_impl::memory_barrier(Memory_barrier_mask barriers)
         dst_stage  |= VK_PIPELINE_STAGE_2_HOST_BIT;
         dst_access |= VK_ACCESS_2_HOST_READ_BIT;
     }
+    // Vertex and index data is also read by acceleration structure builds
+    // (see buffer_usage_to_vk_stage_access()); GL has no such consumer so
+    // the mask has no bit for it. Buffer_transfer_queue staged copies rely
+    // on this.
+    if (
+        ((mask & (vertex_attrib_array_barrier_bit | element_array_barrier_bit)) != 0) &&
+        m_device_impl->get_info().use_ray_query
+    ) {
+        dst_stage  |= VK_PIPELINE_STAGE_2_ACCELERATION_STRUCTURE_BUILD_BIT_KHR;
+        dst_access |= VK_ACCESS_2_SHADER_READ_BIT;
+    }
 
     if (dst_stage == 0) {
         return;
@@ -2,6 +2,7 @@
 
 #include "erhe_graphics/blit_command_encoder.hpp"
 #include "erhe_graphics/buffer.hpp"
+#include "erhe_graphics/buffer_transfer_queue.hpp"
 #include "erhe_graphics/command_buffer.hpp"
 #include "erhe_graphics/device.hpp"
 #include "erhe_graphics/enums.hpp"
@@ -122,4 +123,68 @@ TEST_F(Gpu_test, fill_buffer_constant)
     EXPECT_EQ(mismatches, 0) << mismatches << " of " << bytes << " bytes were not 0x" << std::hex << static_cast<int>(value);
 }
 
+// Buffer_transfer_queue reservations: data written straight into the
+// staging ring lands in the target after a flush, interleaved with enqueue()d
+// heap transfers, and tickets / watermark follow commit order. Unaligned and
+// oversized requests decline (id 0) and use enqueue() instead.
+TEST_F(Gpu_test, buffer_transfer_queue_staged_reservations)
+{
+    constexpr uint32_t    n     = 256;
+    constexpr std::size_t bytes = static_cast<std::size_t>(n) * sizeof(uint32_t);
+    constexpr std::size_t half  = bytes / 2;
+
+    std::vector<uint32_t> src(n);
+    for (uint32_t i = 0; i < n; ++i) {
+        src[i] = 0x5A000000u + i * 7u;
+    }
+
+    const std::shared_ptr<erhe::graphics::Buffer> buffer =
+        make_host_buffer(bytes, erhe::graphics::Buffer_usage::transfer_dst, "transfer_queue_staged");
+
+    erhe::graphics::Buffer_transfer_queue queue{device(), 4 * bytes};
+
+    EXPECT_EQ(queue.reserve(buffer.get(), 2, 16).id, 0u);             // unaligned offset
+    EXPECT_EQ(queue.reserve(buffer.get(), 0, 6).id, 0u);              // unaligned size
+    EXPECT_EQ(queue.reserve(buffer.get(), 0, 8 * bytes).id, 0u);      // larger than the ring
+
+    // First half staged, second half from the heap; reserved in the opposite
+    // order to commit so the ticket is seen to come from commit().
+    const erhe::graphics::Buffer_transfer_queue::Reservation first = queue.reserve(buffer.get(), 0, half);
+    ASSERT_NE(first.id, 0u);
+    ASSERT_EQ(first.span.size(), half);
+    std::memcpy(first.span.data(), src.data(), half);
+
+    std::vector<uint8_t> second(half);
+    std::memcpy(second.data(), reinterpret_cast<const uint8_t*>(src.data()) + half, half);
+    const erhe::graphics::Buffer_transfer_queue::Ticket heap_ticket   = queue.enqueue(buffer.get(), half, std::move(second));
+    const erhe::graphics::Buffer_transfer_queue::Ticket staged_ticket = queue.commit(first.id);
+    EXPECT_LT(heap_ticket, staged_ticket);
+    EXPECT_EQ(queue.get_last_ticket(), staged_ticket);
+    EXPECT_EQ(queue.get_queued_byte_count(), bytes);
+    EXPECT_EQ(queue.get_watermark(), 0u);
+
+    submit_and_wait(
+        [&](erhe::graphics::Command_buffer& command_buffer) {
+            // Budget below one entry: only the first (heap) entry goes through.
+            EXPECT_EQ(queue.flush_budgeted(command_buffer, 1), half);
+            EXPECT_EQ(queue.get_watermark(), heap_ticket);
+            EXPECT_EQ(queue.flush_budgeted(command_buffer, 1), half);
+            EXPECT_EQ(queue.get_watermark(), staged_ticket);
+        }
+    );
+    EXPECT_EQ(queue.get_queued_byte_count(), 0u);
+
+    const std::vector<std::byte> raw = read_buffer(*buffer, bytes);
+    std::vector<uint32_t> got(n);
+    std::memcpy(got.data(), raw.data(), bytes);
+
+    int mismatches = 0;
+    for (uint32_t i = 0; i < n; ++i) {
+        if (got[i] != src[i]) {
+            ++mismatches;
+        }
+    }
+    EXPECT_EQ(mismatches, 0) << mismatches << " of " << n << " words differed after staged transfer";
+}
+
 } // namespace erhe::graphics::test
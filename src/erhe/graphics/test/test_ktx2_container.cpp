@@ -0,0 +1,252 @@
+// Plain KTX2 containers written by the compressed image cache:
+// make_plain_ktx2() -> parse_plain_ktx2() returns the written levels
+// unchanged, and damaged files (truncated, level index pointing outside
+// the file) are rejected. Image_loader_ktx2 loads such files as stored,
+// bypassing the transcoder. Pure CPU code, no graphics Device.
+
+#include <gtest/gtest.h>
+
+#include "erhe_dataformat/dataformat.hpp"
+#include "erhe_graphics/graphics_log.hpp"
+#include "erhe_graphics/image_loader_ktx2.hpp"
+#include "erhe_graphics/ktx2_container.hpp"
+#include "erhe_graphics/texture_compression.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <vector>
+
+using erhe::dataformat::Format;
+using erhe::graphics::Ktx2_plain_image;
+using erhe::graphics::is_plain_ktx2;
+using erhe::graphics::make_plain_ktx2;
+using erhe::graphics::parse_plain_ktx2;
+
+namespace {
+
+constexpr int width  = 37;
+constexpr int height = 19;
+
+// KTX2 layout: 80 byte header (identifier, header words, index), then one
+// 24 byte level index entry (byteOffset, byteLength, uncompressedByteLength)
+// per level
+constexpr std::size_t level_count_offset     = 40;
+constexpr std::size_t level_index_offset     = 80;
+constexpr std::size_t level_index_entry_size = 24;
+
+class Ktx2_container : public ::testing::Test
+{
+protected:
+    static void SetUpTestSuite()
+    {
+        // The deviceless test binary does not initialize graphics logging;
+        // parse failures log through log_texture.
+        if (!erhe::graphics::log_texture) {
+            erhe::graphics::log_texture = spdlog::default_logger();
+        }
+    }
+};
+
+auto as_bytes(const std::vector<std::uint8_t>& data) -> std::span<const std::byte>
+{
+    return std::span<const std::byte>{reinterpret_cast<const std::byte*>(data.data()), data.size()};
+}
+
+auto make_rgba8_chain() -> std::vector<std::uint8_t>
+{
+    std::vector<std::uint8_t> image(static_cast<std::size_t>(width) * height * 4);
+    for (std::size_t i = 0; i < image.size(); ++i) {
+        image[i] = static_cast<std::uint8_t>(i * 7);
+    }
+    return erhe::graphics::make_rgba8_mip_chain(width, height, false, image);
+}
+
+auto make_bc7_chain(const std::vector<std::uint8_t>& rgba8_chain, const int level_count) -> std::vector<std::uint8_t>
+{
+    std::vector<std::uint8_t> bc7_chain;
+    std::size_t rgba8_offset = 0;
+    for (int level = 0; level < level_count; ++level) {
+        const int         level_width    = std::max(1, width  >> level);
+        const int         level_height   = std::max(1, height >> level);
+        const std::size_t rgba8_size     = static_cast<std::size_t>(level_width) * level_height * 4;
+        const std::size_t bc7_size       = erhe::dataformat::get_image_level_size_bytes(Format::format_bc7_unorm, level_width, level_height);
+        const std::size_t bc7_offset     = bc7_chain.size();
+        bc7_chain.resize(bc7_offset + bc7_size);
+        erhe::graphics::encode_bc7_image(
+            level_width,
+            level_height,
+            std::span<const std::uint8_t>{rgba8_chain.data() + rgba8_offset, rgba8_size},
+            std::span<std::uint8_t>{bc7_chain.data() + bc7_offset, bc7_size}
+        );
+        rgba8_offset += rgba8_size;
+    }
+    return bc7_chain;
+}
+
+void write_u32(std::vector<std::uint8_t>& file, const std::size_t offset, const std::uint32_t value)
+{
+    std::memcpy(file.data() + offset, &value, sizeof(value));
+}
+
+void write_u64(std::vector<std::uint8_t>& file, const std::size_t offset, const std::uint64_t value)
+{
+    std::memcpy(file.data() + offset, &value, sizeof(value));
+}
+
+} // anonymous namespace
+
+TEST_F(Ktx2_container, round_trip_returns_identical_levels)
+{
+    const int                       level_count = erhe::graphics::get_full_mip_level_count(width, height);
+    const std::vector<std::uint8_t> rgba8_chain = make_rgba8_chain();
+    const std::vector<std::uint8_t> bc7_chain   = make_bc7_chain(rgba8_chain, level_count);
+
+    for (const Format format : {Format::format_8_vec4_unorm, Format::format_8_vec4_srgb, Format::format_bc7_unorm, Format::format_bc7_srgb}) {
+        const bool is_bc7 = (format == Format::format_bc7_unorm) || (format == Format::format_bc7_srgb);
+        const std::vector<std::uint8_t>& chain = is_bc7 ? bc7_chain : rgba8_chain;
+
+        const std::vector<std::uint8_t> file = make_plain_ktx2(format, width, height, level_count, chain);
+        ASSERT_FALSE(file.empty()) << erhe::dataformat::c_str(format);
+        const std::span<const std::byte> bytes = as_bytes(file);
+        EXPECT_TRUE(is_plain_ktx2(bytes));
+
+        Ktx2_plain_image image;
+        ASSERT_TRUE(parse_plain_ktx2(bytes, image)) << erhe::dataformat::c_str(format);
+        EXPECT_EQ(image.format,      format);
+        EXPECT_EQ(image.width,       width);
+        EXPECT_EQ(image.height,      height);
+        EXPECT_EQ(image.level_count, level_count);
+        ASSERT_EQ(image.levels.size(), static_cast<std::size_t>(level_count));
+
+        // Levels come back largest-first, as passed in, regardless of file order
+        std::size_t chain_offset = 0;
+        for (int level = 0; level < level_count; ++level) {
+            const std::span<const std::byte> level_bytes = image.levels[level];
+            const std::size_t expected_size = erhe::dataformat::get_image_level_size_bytes(
+                format,
+                std::max(1, width  >> level),
+                std::max(1, height >> level)
+            );
+            ASSERT_EQ(level_bytes.size(), expected_size) << "level " << level;
+            EXPECT_GE(level_bytes.data(), bytes.data());
+            EXPECT_LE(level_bytes.data() + level_bytes.size(), bytes.data() + bytes.size());
+            EXPECT_EQ(std::memcmp(level_bytes.data(), chain.data() + chain_offset, level_bytes.size()), 0) << "level " << level;
+            chain_offset += level_bytes.size();
+        }
+        EXPECT_EQ(chain_offset, chain.size());
+    }
+}
+
+TEST_F(Ktx2_container, make_rejects_short_mip_chain)
+{
+    const std::vector<std::uint8_t> rgba8_chain = make_rgba8_chain();
+    const std::span<const std::uint8_t> short_chain{rgba8_chain.data(), rgba8_chain.size() - 1};
+    EXPECT_TRUE(make_plain_ktx2(Format::format_8_vec4_unorm, width, height, 6, short_chain).empty());
+    EXPECT_FALSE(make_plain_ktx2(Format::format_8_vec4_unorm, width, height, 5, short_chain).empty());
+}
+
+TEST_F(Ktx2_container, parse_rejects_truncated_file)
+{
+    const std::vector<std::uint8_t> file = make_plain_ktx2(Format::format_8_vec4_unorm, width, height, 6, make_rgba8_chain());
+    ASSERT_FALSE(file.empty());
+
+    // Inside the identifier, the header, the level index and the level data
+    for (const std::size_t size : {std::size_t{0}, std::size_t{11}, std::size_t{48}, std::size_t{100}, file.size() / 2, file.size() - 1}) {
+        const std::span<const std::byte> truncated = as_bytes(file).first(size);
+        Ktx2_plain_image image;
+        EXPECT_FALSE(parse_plain_ktx2(truncated, image)) << "size " << size << " of " << file.size();
+        EXPECT_TRUE(image.levels.empty());
+    }
+}
+
+TEST_F(Ktx2_container, parse_rejects_out_of_range_level_index)
+{
+    const std::vector<std::uint8_t> file = make_plain_ktx2(Format::format_8_vec4_unorm, width, height, 6, make_rgba8_chain());
+    ASSERT_FALSE(file.empty());
+    Ktx2_plain_image image;
+    ASSERT_TRUE(parse_plain_ktx2(as_bytes(file), image));
+
+    const std::size_t level_5_entry = level_index_offset + 5 * level_index_entry_size;
+
+    // Level starting past the end of the file
+    {
+        std::vector<std::uint8_t> damaged = file;
+        write_u64(damaged, level_5_entry, damaged.size() + 1);
+        EXPECT_FALSE(parse_plain_ktx2(as_bytes(damaged), image));
+        EXPECT_TRUE(image.levels.empty());
+    }
+    // Level running past the end of the file
+    {
+        std::vector<std::uint8_t> damaged = file;
+        write_u64(damaged, level_5_entry, damaged.size() - 2);
+        EXPECT_FALSE(parse_plain_ktx2(as_bytes(damaged), image));
+    }
+    // Level length not matching the level extent
+    {
+        std::vector<std::uint8_t> damaged = file;
+        write_u64(damaged, level_5_entry + 8, 8);
+        EXPECT_FALSE(parse_plain_ktx2(as_bytes(damaged), image));
+    }
+    // More levels than the level index holds: the extra entries overlap the
+    // data format descriptor and the level data
+    {
+        std::vector<std::uint8_t> damaged = file;
+        write_u32(damaged, level_count_offset, 7);
+        EXPECT_FALSE(parse_plain_ktx2(as_bytes(damaged), image));
+    }
+    // More levels than any 2D image can have
+    {
+        std::vector<std::uint8_t> damaged = file;
+        write_u32(damaged, level_count_offset, 33);
+        EXPECT_FALSE(parse_plain_ktx2(as_bytes(damaged), image));
+    }
+}
+
+TEST_F(Ktx2_container, loader_loads_plain_levels_as_stored)
+{
+    const int                       level_count = erhe::graphics::get_full_mip_level_count(width, height);
+    const std::vector<std::uint8_t> bc7_chain   = make_bc7_chain(make_rgba8_chain(), level_count);
+    const std::vector<std::uint8_t> file        = make_plain_ktx2(Format::format_bc7_srgb, width, height, level_count, bc7_chain);
+    ASSERT_FALSE(file.empty());
+    EXPECT_TRUE(erhe::graphics::Image_loader_ktx2::is_ktx2(std::span<const std::uint8_t>{file}));
+
+    // The vkFormat is authoritative: neither linear nor the preference
+    // changes the format of a plain file
+    erhe::graphics::Image_loader_ktx2 loader;
+    erhe::graphics::Image_info        info{};
+    ASSERT_TRUE(loader.open(std::span<const std::uint8_t>{file}, info, true, erhe::graphics::Transcode_format_preference::rgba8));
+    EXPECT_EQ(info.format,      Format::format_bc7_srgb);
+    EXPECT_EQ(info.width,       width);
+    EXPECT_EQ(info.height,      height);
+    EXPECT_EQ(info.level_count, level_count);
+    EXPECT_EQ(info.row_stride,  0);
+
+    std::vector<std::uint8_t> loaded(bc7_chain.size());
+    ASSERT_TRUE(loader.load(loaded));
+    EXPECT_EQ(loaded, bc7_chain);
+}
+
+TEST_F(Ktx2_container, loader_rejects_short_transfer_buffer)
+{
+    const std::vector<std::uint8_t> file = make_plain_ktx2(Format::format_8_vec4_unorm, width, height, 6, make_rgba8_chain());
+    ASSERT_FALSE(file.empty());
+
+    erhe::graphics::Image_loader_ktx2 loader;
+    erhe::graphics::Image_info        info{};
+    ASSERT_TRUE(loader.open(std::span<const std::uint8_t>{file}, info, false));
+    EXPECT_EQ(info.row_stride, width * 4);
+
+    const std::size_t chain_byte_count = erhe::dataformat::get_mip_chain_byte_count(Format::format_8_vec4_unorm, width, height, 6);
+    std::vector<std::uint8_t> loaded(chain_byte_count - 1, 0xcdu);
+    EXPECT_FALSE(loader.load(loaded));
+    EXPECT_TRUE(std::all_of(loaded.begin(), loaded.end(), [](const std::uint8_t value) { return value == 0xcdu; }));
+
+    // Not opened
+    erhe::graphics::Image_loader_ktx2 closed_loader;
+    EXPECT_FALSE(closed_loader.load(loaded));
+}
@@ -0,0 +1,274 @@
+// CPU texture compression used by the compressed image cache: BC7 mode 6
+// blocks decoded back with a reference decoder written from the BC7
+// specification, and the mip chain extent / byte count contract for sizes
+// that are not powers of two. Pure CPU code, no graphics Device.
+
+#include <gtest/gtest.h>
+
+#include "erhe_dataformat/dataformat.hpp"
+#include "erhe_graphics/texture_compression.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <vector>
+
+using erhe::graphics::encode_bc7_block;
+using erhe::graphics::encode_bc7_image;
+using erhe::graphics::get_full_mip_level_count;
+using erhe::graphics::make_rgba8_mip_chain;
+
+namespace {
+
+using Block_texels = std::array<std::uint8_t, 64>; // 4x4 RGBA, row major
+
+class Bit_reader
+{
+public:
+    explicit Bit_reader(const std::uint8_t* bytes) : m_bytes{bytes} {}
+
+    auto read(const int bit_count) -> unsigned int
+    {
+        unsigned int value = 0;
+        for (int i = 0; i < bit_count; ++i, ++m_position) {
+            value |= ((m_bytes[m_position >> 3] >> (m_position & 7)) & 1u) << i;
+        }
+        return value;
+    }
+
+    [[nodiscard]] auto get_position() const -> int { return m_position; }
+
+private:
+    const std::uint8_t* m_bytes;
+    int                 m_position{0};
+};
+
+// Decodes a BC7 mode 6 block: 7 bit mode prefix, RGBA 7.7.7.7 endpoints
+// (channel-major, endpoint 0 then 1), one p-bit per endpoint, then 16 four
+// bit indices with the anchor index (texel 0) stored in 3 bits.
+auto decode_bc7_mode_6_block(const std::uint8_t* bc7_block, Block_texels& texels) -> bool
+{
+    static constexpr std::array<int, 16> weights{0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+    Bit_reader reader{bc7_block};
+    if (reader.read(7) != (1u << 6)) {
+        return false;
+    }
+    std::array<std::array<int, 4>, 2> endpoints{};
+    for (int channel = 0; channel < 4; ++channel) {
+        endpoints[0][channel] = static_cast<int>(reader.read(7));
+        endpoints[1][channel] = static_cast<int>(reader.read(7));
+    }
+    const int p_bit_0 = static_cast<int>(reader.read(1));
+    const int p_bit_1 = static_cast<int>(reader.read(1));
+    for (int channel = 0; channel < 4; ++channel) {
+        endpoints[0][channel] = (endpoints[0][channel] << 1) | p_bit_0;
+        endpoints[1][channel] = (endpoints[1][channel] << 1) | p_bit_1;
+    }
+    for (int texel = 0; texel < 16; ++texel) {
+        const int weight = weights[reader.read((texel == 0) ? 3 : 4)];
+        for (int channel = 0; channel < 4; ++channel) {
+            const int value = ((64 - weight) * endpoints[0][channel] + weight * endpoints[1][channel] + 32) >> 6;
+            texels[texel * 4 + channel] = static_cast<std::uint8_t>(value);
+        }
+    }
+    return reader.get_position() == 128;
+}
+
+class Error_sum
+{
+public:
+    void add(const int expected, const int actual)
+    {
+        const double difference = static_cast<double>(expected - actual);
+        squared_error += difference * difference;
+        ++sample_count;
+        max_error = std::max(max_error, std::abs(expected - actual));
+    }
+
+    [[nodiscard]] auto get_psnr() const -> double
+    {
+        const double mse = squared_error / static_cast<double>(sample_count);
+        return (mse == 0.0) ? 1000.0 : 10.0 * std::log10(255.0 * 255.0 / mse);
+    }
+
+    double      squared_error{0.0};
+    std::size_t sample_count {0};
+    int         max_error    {0};
+};
+
+auto round_trip_block(const Block_texels& input, Error_sum& error) -> bool
+{
+    std::array<std::uint8_t, 16> bc7_block{};
+    encode_bc7_block(input.data(), bc7_block.data());
+    Block_texels decoded{};
+    if (!decode_bc7_mode_6_block(bc7_block.data(), decoded)) {
+        return false;
+    }
+    for (std::size_t i = 0; i < input.size(); ++i) {
+        error.add(input[i], decoded[i]);
+    }
+    return true;
+}
+
+// Smooth color image with a soft alpha ramp, typical of albedo textures
+auto make_gradient_image(const int width, const int height) -> std::vector<std::uint8_t>
+{
+    std::vector<std::uint8_t> texels(static_cast<std::size_t>(width) * static_cast<std::size_t>(height) * 4);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            std::uint8_t* texel = &texels[(static_cast<std::size_t>(y) * width + x) * 4];
+            texel[0] = static_cast<std::uint8_t>((x * 255) / std::max(1, width - 1));
+            texel[1] = static_cast<std::uint8_t>((y * 255) / std::max(1, height - 1));
+            texel[2] = static_cast<std::uint8_t>(128 + ((x + y) % 16) * 4);
+            texel[3] = static_cast<std::uint8_t>(255 - x * 2);
+        }
+    }
+    return texels;
+}
+
+} // anonymous namespace
+
+TEST(TextureCompression, bc7_constant_blocks)
+{
+    // Mode 6 endpoints are 7 bits plus one p-bit shared by all channels of
+    // the endpoint: colors whose channels are all even or all odd are exact,
+    // mixed parity colors are off by at most one.
+    for (const std::array<std::uint8_t, 4> color : {
+        std::array<std::uint8_t, 4>{  0,   0,   0,   0},
+        std::array<std::uint8_t, 4>{255, 255, 255, 255},
+        std::array<std::uint8_t, 4>{ 17, 131, 201, 255},
+        std::array<std::uint8_t, 4>{ 64,  66, 254,   2},
+        std::array<std::uint8_t, 4>{ 17, 130, 201, 255},
+        std::array<std::uint8_t, 4>{ 64,  65, 254,   1}
+    }) {
+        Block_texels input{};
+        for (int texel = 0; texel < 16; ++texel) {
+            std::copy(color.begin(), color.end(), input.begin() + texel * 4);
+        }
+        Error_sum error;
+        ASSERT_TRUE(round_trip_block(input, error));
+        const bool same_parity =
+            ((color[0] & 1) == (color[1] & 1)) &&
+            ((color[0] & 1) == (color[2] & 1)) &&
+            ((color[0] & 1) == (color[3] & 1));
+        EXPECT_LE(error.max_error, same_parity ? 0 : 1) << "color " << int{color[0]} << " " << int{color[1]} << " " << int{color[2]} << " " << int{color[3]};
+    }
+}
+
+TEST(TextureCompression, bc7_smooth_blocks_psnr)
+{
+    // std::mt19937 output (unlike the std distributions) is the same on every platform
+    std::mt19937 random{1};
+    Error_sum error;
+    for (int block = 0; block < 1000; ++block) {
+        std::array<int, 4> base{};
+        for (int& value : base) {
+            value = static_cast<int>(random() % 256);
+        }
+        const int slope = block % 5;
+        Block_texels input{};
+        for (int texel = 0; texel < 16; ++texel) {
+            for (int channel = 0; channel < 4; ++channel) {
+                const int noise = static_cast<int>(random() % 31) - 15;
+                input[texel * 4 + channel] = static_cast<std::uint8_t>(std::clamp(base[channel] + noise + texel * slope, 0, 255));
+            }
+        }
+        ASSERT_TRUE(round_trip_block(input, error));
+    }
+    EXPECT_GT(error.get_psnr(), 30.0); // 31.5 dB with the current encoder
+}
+
+TEST(TextureCompression, bc7_image_with_partial_edge_blocks)
+{
+    constexpr int width  = 37;
+    constexpr int height = 19;
+    const std::vector<std::uint8_t> image = make_gradient_image(width, height);
+
+    const int block_columns = (width  + 3) / 4;
+    const int block_rows    = (height + 3) / 4;
+    const std::size_t block_byte_count = erhe::dataformat::get_image_level_size_bytes(erhe::dataformat::Format::format_bc7_unorm, width, height);
+    ASSERT_EQ(block_byte_count, static_cast<std::size_t>(block_columns * block_rows * 16));
+
+    std::vector<std::uint8_t> bc7_blocks(block_byte_count);
+    encode_bc7_image(width, height, image, bc7_blocks);
+
+    Error_sum error;
+    for (int block_y = 0; block_y < block_rows; ++block_y) {
+        for (int block_x = 0; block_x < block_columns; ++block_x) {
+            Block_texels decoded{};
+            ASSERT_TRUE(decode_bc7_mode_6_block(&bc7_blocks[(static_cast<std::size_t>(block_y) * block_columns + block_x) * 16], decoded));
+            for (int y = 0; y < 4; ++y) {
+                for (int x = 0; x < 4; ++x) {
+                    const int image_x = block_x * 4 + x;
+                    const int image_y = block_y * 4 + y;
+                    if ((image_x >= width) || (image_y >= height)) {
+                        continue; // padding texels, replicated from the edge
+                    }
+                    for (int channel = 0; channel < 4; ++channel) {
+                        error.add(
+                            image[(static_cast<std::size_t>(image_y) * width + image_x) * 4 + channel],
+                            decoded[(y * 4 + x) * 4 + channel]
+                        );
+                    }
+                }
+            }
+        }
+    }
+    EXPECT_EQ(error.sample_count, static_cast<std::size_t>(width * height * 4));
+    EXPECT_GT(error.get_psnr(), 32.0); // 33.7 dB with the current encoder
+}
+
+TEST(TextureCompression, full_mip_level_count)
+{
+    EXPECT_EQ(get_full_mip_level_count(  1,   1), 1);
+    EXPECT_EQ(get_full_mip_level_count(  2,   1), 2);
+    EXPECT_EQ(get_full_mip_level_count( 37,  19), 6); // 37x19 18x9 9x4 4x2 2x1 1x1
+    EXPECT_EQ(get_full_mip_level_count(  1, 100), 7);
+    EXPECT_EQ(get_full_mip_level_count( 64,  64), 7);
+    EXPECT_EQ(get_full_mip_level_count(255, 256), 9);
+}
+
+TEST(TextureCompression, rgba8_mip_chain_size_non_power_of_two)
+{
+    constexpr int width  = 37;
+    constexpr int height = 19;
+    const std::vector<std::uint8_t> image = make_gradient_image(width, height);
+
+    const std::vector<std::uint8_t> chain = make_rgba8_mip_chain(width, height, false, image);
+    constexpr std::size_t texel_count = 37 * 19 + 18 * 9 + 9 * 4 + 4 * 2 + 2 * 1 + 1 * 1;
+    EXPECT_EQ(chain.size(), texel_count * 4);
+    EXPECT_EQ(
+        chain.size(),
+        erhe::dataformat::get_mip_chain_byte_count(erhe::dataformat::Format::format_8_vec4_unorm, width, height, 6)
+    );
+    EXPECT_TRUE(std::equal(image.begin(), image.end(), chain.begin())); // level 0 copied as-is
+
+    // BC7 levels round up to whole 4x4 blocks: 10x5, 5x3 and 3x1 blocks,
+    // then one block each for 4x2, 2x1 and 1x1
+    EXPECT_EQ(
+        erhe::dataformat::get_mip_chain_byte_count(erhe::dataformat::Format::format_bc7_unorm, width, height, 6),
+        static_cast<std::size_t>((50 + 15 + 3 + 1 + 1 + 1) * 16)
+    );
+}
+
+TEST(TextureCompression, mip_chain_of_constant_image_stays_constant)
+{
+    constexpr int width  = 37;
+    constexpr int height = 19;
+    constexpr std::array<std::uint8_t, 4> color{200, 100, 30, 128};
+    std::vector<std::uint8_t> image(static_cast<std::size_t>(width) * height * 4);
+    for (std::size_t i = 0; i < image.size(); ++i) {
+        image[i] = color[i % 4];
+    }
+    for (const bool srgb : {false, true}) {
+        const std::vector<std::uint8_t> chain = make_rgba8_mip_chain(width, height, srgb, image);
+        for (std::size_t i = 0; i < chain.size(); ++i) {
+            ASSERT_NEAR(chain[i], color[i % 4], 1) << "srgb " << srgb << " byte " << i;
+        }
+    }
+}
@@ -0,0 +1,212 @@
+#include "erhe_math/aabb_soa.hpp"
+#include "erhe_verify/verify.hpp"
+
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#   define ERHE_MATH_AABB_SOA_SSE2 1
+#   include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#   define ERHE_MATH_AABB_SOA_NEON 1
+#   include <arm_neon.h>
+#endif
+
+namespace erhe::math {
+
+namespace {
+
+class Center_extent
+{
+public:
+    glm::vec3 center;
+    glm::vec3 extent;
+};
+
+[[nodiscard]] auto to_center_extent(const Aabb& aabb) -> Center_extent
+{
+    if (!aabb.is_valid()) {
+        // Unbounded: the plane distance becomes a huge positive number (or
+        // +inf), never negative, so the box is never rejected. float max
+        // rather than +inf keeps |n| * extent free of 0 * inf NaNs.
+        constexpr float big = std::numeric_limits<float>::max();
+        return Center_extent{glm::vec3{0.0f}, glm::vec3{big}};
+    }
+    return Center_extent{aabb.center(), 0.5f * aabb.diagonal()};
+}
+
+} // anonymous namespace
+
+auto Aabb_soa::get(const std::size_t index) const -> Aabb
+{
+    ERHE_VERIFY(index < size());
+    const glm::vec3 center{center_x[index], center_y[index], center_z[index]};
+    const glm::vec3 extent{extent_x[index], extent_y[index], extent_z[index]};
+    return Aabb{.min = center - extent, .max = center + extent};
+}
+
+void Aabb_soa::clear()
+{
+    center_x.clear();
+    center_y.clear();
+    center_z.clear();
+    extent_x.clear();
+    extent_y.clear();
+    extent_z.clear();
+}
+
+void Aabb_soa::reserve(const std::size_t capacity)
+{
+    center_x.reserve(capacity);
+    center_y.reserve(capacity);
+    center_z.reserve(capacity);
+    extent_x.reserve(capacity);
+    extent_y.reserve(capacity);
+    extent_z.reserve(capacity);
+}
+
+void Aabb_soa::push_back(const Aabb& aabb)
+{
+    const Center_extent ce = to_center_extent(aabb);
+    center_x.push_back(ce.center.x);
+    center_y.push_back(ce.center.y);
+    center_z.push_back(ce.center.z);
+    extent_x.push_back(ce.extent.x);
+    extent_y.push_back(ce.extent.y);
+    extent_z.push_back(ce.extent.z);
+}
+
+void Aabb_soa::set(const std::size_t index, const Aabb& aabb)
+{
+    ERHE_VERIFY(index < size());
+    const Center_extent ce = to_center_extent(aabb);
+    center_x[index] = ce.center.x;
+    center_y[index] = ce.center.y;
+    center_z[index] = ce.center.z;
+    extent_x[index] = ce.extent.x;
+    extent_y[index] = ce.extent.y;
+    extent_z[index] = ce.extent.z;
+}
+
+void Aabb_soa::swap_remove(const std::size_t index)
+{
+    ERHE_VERIFY(index < size());
+    const std::size_t last = size() - 1;
+    if (index != last) {
+        center_x[index] = center_x[last];
+        center_y[index] = center_y[last];
+        center_z[index] = center_z[last];
+        extent_x[index] = extent_x[last];
+        extent_y[index] = extent_y[last];
+        extent_z[index] = extent_z[last];
+    }
+    center_x.pop_back();
+    center_y.pop_back();
+    center_z.pop_back();
+    extent_x.pop_back();
+    extent_y.pop_back();
+    extent_z.pop_back();
+}
+
+void mark_aabbs_in_convex_volume(
+    const Aabb_soa&                  bounds,
+    const std::size_t                begin,
+    const std::size_t                end,
+    const std::span<const glm::vec4> planes,
+    const std::span<uint8_t>         inout_inside
+)
+{
+    ERHE_VERIFY(begin <= end);
+    ERHE_VERIFY(end <= bounds.size());
+    ERHE_VERIFY(inout_inside.size() >= end - begin);
+
+    // Per plane, per box: distance of the most positive corner,
+    // dot(n, center) + w + dot(abs(n), extent) (p-vertex form, identical to
+    // aabb_in_convex_volume()). The box is rejected when that is negative
+    // for any plane.
+    const float* const cx = bounds.center_x.data();
+    const float* const cy = bounds.center_y.data();
+    const float* const cz = bounds.center_z.data();
+    const float* const ex = bounds.extent_x.data();
+    const float* const ey = bounds.extent_y.data();
+    const float* const ez = bounds.extent_z.data();
+    uint8_t* const out = inout_inside.data();
+
+    std::size_t i = begin;
+#if defined(ERHE_MATH_AABB_SOA_SSE2)
+    const __m128 zero     = _mm_setzero_ps();
+    const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    for (; (i + 4) <= end; i += 4) {
+        const __m128 box_cx = _mm_loadu_ps(cx + i);
+        const __m128 box_cy = _mm_loadu_ps(cy + i);
+        const __m128 box_cz = _mm_loadu_ps(cz + i);
+        const __m128 box_ex = _mm_loadu_ps(ex + i);
+        const __m128 box_ey = _mm_loadu_ps(ey + i);
+        const __m128 box_ez = _mm_loadu_ps(ez + i);
+        __m128 outside = zero;
+        for (const glm::vec4& plane : planes) {
+            const __m128 nx = _mm_set1_ps(plane.x);
+            const __m128 ny = _mm_set1_ps(plane.y);
+            const __m128 nz = _mm_set1_ps(plane.z);
+            __m128 distance = _mm_add_ps(_mm_mul_ps(nx, box_cx), _mm_set1_ps(plane.w));
+            distance = _mm_add_ps(distance, _mm_mul_ps(ny, box_cy));
+            distance = _mm_add_ps(distance, _mm_mul_ps(nz, box_cz));
+            distance = _mm_add_ps(distance, _mm_mul_ps(_mm_and_ps(nx, abs_mask), box_ex));
+            distance = _mm_add_ps(distance, _mm_mul_ps(_mm_and_ps(ny, abs_mask), box_ey));
+            distance = _mm_add_ps(distance, _mm_mul_ps(_mm_and_ps(nz, abs_mask), box_ez));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, zero));
+        }
+        const int outside_bits = _mm_movemask_ps(outside);
+        for (std::size_t lane = 0; lane < 4; ++lane) {
+            if ((outside_bits & (1 << lane)) == 0) {
+                out[i + lane - begin] = 1;
+            }
+        }
+    }
+#elif defined(ERHE_MATH_AABB_SOA_NEON)
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    for (; (i + 4) <= end; i += 4) {
+        const float32x4_t box_cx = vld1q_f32(cx + i);
+        const float32x4_t box_cy = vld1q_f32(cy + i);
+        const float32x4_t box_cz = vld1q_f32(cz + i);
+        const float32x4_t box_ex = vld1q_f32(ex + i);
+        const float32x4_t box_ey = vld1q_f32(ey + i);
+        const float32x4_t box_ez = vld1q_f32(ez + i);
+        uint32x4_t outside = vdupq_n_u32(0u);
+        for (const glm::vec4& plane : planes) {
+            float32x4_t distance = vmlaq_n_f32(vdupq_n_f32(plane.w), box_cx, plane.x);
+            distance = vmlaq_n_f32(distance, box_cy, plane.y);
+            distance = vmlaq_n_f32(distance, box_cz, plane.z);
+            distance = vmlaq_n_f32(distance, box_ex, std::abs(plane.x));
+            distance = vmlaq_n_f32(distance, box_ey, std::abs(plane.y));
+            distance = vmlaq_n_f32(distance, box_ez, std::abs(plane.z));
+            outside = vorrq_u32(outside, vcltq_f32(distance, zero));
+        }
+        if (vgetq_lane_u32(outside, 0) == 0u) { out[i + 0 - begin] = 1; }
+        if (vgetq_lane_u32(outside, 1) == 0u) { out[i + 1 - begin] = 1; }
+        if (vgetq_lane_u32(outside, 2) == 0u) { out[i + 2 - begin] = 1; }
+        if (vgetq_lane_u32(outside, 3) == 0u) { out[i + 3 - begin] = 1; }
+    }
+#endif
+    for (; i < end; ++i) {
+        bool outside = false;
+        for (const glm::vec4& plane : planes) {
+            const float distance =
+                plane.x * cx[i] + plane.w +
+                plane.y * cy[i] +
+                plane.z * cz[i] +
+                std::abs(plane.x) * ex[i] +
+                std::abs(plane.y) * ey[i] +
+                std::abs(plane.z) * ez[i];
+            if (distance < 0.0f) {
+                outside = true;
+                break;
+            }
+        }
+        if (!outside) {
+            out[i - begin] = 1;
+        }
+    }
+}
+
+} // namespace erhe::math
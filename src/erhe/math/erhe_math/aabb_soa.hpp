@@ -0,0 +1,60 @@
+#pragma once
+
+#include "erhe_math/aabb.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace erhe::math {
+
+// Structure-of-arrays copy of a list of AABBs, stored as center / half
+// extent columns so that testing many boxes against one plane is a handful
+// of multiply-adds per lane (four boxes at a time with SSE2 / NEON, scalar
+// tail). Element order is the owner's; the owner keeps it parallel to its
+// own array through push_back() / set() / swap_remove().
+//
+// Invalid boxes (Aabb::is_valid() false, e.g. a mesh without bounds) are
+// stored as unbounded so that culling never rejects them.
+class Aabb_soa
+{
+public:
+    [[nodiscard]] auto size () const -> std::size_t { return center_x.size(); }
+    [[nodiscard]] auto empty() const -> bool        { return center_x.empty(); }
+    [[nodiscard]] auto get  (std::size_t index) const -> Aabb;
+
+    void clear      ();
+    void reserve    (std::size_t capacity);
+    void push_back  (const Aabb& aabb);
+    void set        (std::size_t index, const Aabb& aabb);
+    // Moves the last element into index and drops the last element, the
+    // same swap-remove Draw_list entries use. index may be the last element.
+    void swap_remove(std::size_t index);
+
+    std::vector<float> center_x;
+    std::vector<float> center_y;
+    std::vector<float> center_z;
+    std::vector<float> extent_x;
+    std::vector<float> extent_y;
+    std::vector<float> extent_z;
+};
+
+// Tests boxes [begin, end) of bounds against a convex volume of
+// inward-facing planes (extract_frustum_planes() convention), with the same
+// conservative rule as aabb_in_convex_volume(): a box is rejected only when
+// it lies entirely outside one plane. For every box that is NOT rejected,
+// inout_inside[i - begin] is set to 1; rejected boxes leave their byte
+// untouched, so the results of several volumes (multiview eyes) can be
+// accumulated into one mask. An empty plane span accepts every box.
+void mark_aabbs_in_convex_volume(
+    const Aabb_soa&            bounds,
+    std::size_t                begin,
+    std::size_t                end,
+    std::span<const glm::vec4> planes,
+    std::span<uint8_t>         inout_inside
+);
+
+} // namespace erhe::math
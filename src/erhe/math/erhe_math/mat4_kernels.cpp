@@ -0,0 +1,127 @@
+#include "erhe_math/mat4_kernels.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#   define ERHE_MATH_MAT4_KERNELS_SSE2 1
+#   include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#   define ERHE_MATH_MAT4_KERNELS_NEON 1
+#   include <arm_neon.h>
+#else
+#   include <glm/gtx/matrix_operation.hpp>
+#   include <cstring>
+#endif
+
+namespace erhe::math {
+
+#if defined(ERHE_MATH_MAT4_KERNELS_SSE2) || defined(ERHE_MATH_MAT4_KERNELS_NEON)
+
+namespace {
+
+#if defined(ERHE_MATH_MAT4_KERNELS_SSE2)
+using Float4 = __m128;
+
+[[nodiscard]] inline auto load (const float* p)         -> Float4 { return _mm_loadu_ps(p); }
+inline void               store(float* p, Float4 v)               { _mm_storeu_ps(p, v); }
+[[nodiscard]] inline auto add  (Float4 a, Float4 b)     -> Float4 { return _mm_add_ps(a, b); }
+[[nodiscard]] inline auto sub  (Float4 a, Float4 b)     -> Float4 { return _mm_sub_ps(a, b); }
+[[nodiscard]] inline auto mul  (Float4 a, Float4 b)     -> Float4 { return _mm_mul_ps(a, b); }
+// (x, y, z, w) -> (y, z, x, w)
+[[nodiscard]] inline auto yzxw (Float4 v)               -> Float4 { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 0, 2, 1)); }
+template <int lane>
+[[nodiscard]] inline auto splat(Float4 v)               -> Float4 { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(lane, lane, lane, lane)); }
+// Only used on vectors with a zero w lane.
+[[nodiscard]] inline auto set_w(Float4 v, float w)      -> Float4 { return _mm_add_ps(v, _mm_set_ps(w, 0.0f, 0.0f, 0.0f)); }
+#else
+using Float4 = float32x4_t;
+
+[[nodiscard]] inline auto load (const float* p)         -> Float4 { return vld1q_f32(p); }
+inline void               store(float* p, Float4 v)               { vst1q_f32(p, v); }
+[[nodiscard]] inline auto add  (Float4 a, Float4 b)     -> Float4 { return vaddq_f32(a, b); }
+[[nodiscard]] inline auto sub  (Float4 a, Float4 b)     -> Float4 { return vsubq_f32(a, b); }
+[[nodiscard]] inline auto mul  (Float4 a, Float4 b)     -> Float4 { return vmulq_f32(a, b); }
+[[nodiscard]] inline auto yzxw (Float4 v)               -> Float4
+{
+    const float32x2_t xy = vget_low_f32 (v);
+    const float32x2_t zw = vget_high_f32(v);
+    return vcombine_f32(vext_f32(xy, zw, 1), vset_lane_f32(vget_lane_f32(xy, 0), zw, 0));
+}
+template <int lane>
+[[nodiscard]] inline auto splat(Float4 v)               -> Float4 { return vdupq_n_f32(vgetq_lane_f32(v, lane)); }
+[[nodiscard]] inline auto set_w(Float4 v, float w)      -> Float4 { return vsetq_lane_f32(w, v, 3); }
+#endif
+
+// xyz cross product; the w lane of the result is zero.
+[[nodiscard]] inline auto cross(const Float4 a, const Float4 b) -> Float4
+{
+    return yzxw(sub(mul(a, yzxw(b)), mul(yzxw(a), b)));
+}
+
+[[nodiscard]] inline auto dot3(const Float4 a, const Float4 b) -> float
+{
+    float p[4];
+    store(p, mul(a, b));
+    return p[0] + p[1] + p[2];
+}
+
+} // anonymous namespace
+
+void mul_with_cofactor(
+    const glm::mat4& lhs,
+    const glm::mat4& rhs,
+    float* const     out_product,
+    float* const     out_cofactor
+)
+{
+    const Float4 l0 = load(&lhs[0][0]);
+    const Float4 l1 = load(&lhs[1][0]);
+    const Float4 l2 = load(&lhs[2][0]);
+    const Float4 l3 = load(&lhs[3][0]);
+    Float4 column[4];
+    for (int j = 0; j < 4; ++j) {
+        const Float4 r = load(&rhs[j][0]);
+        column[j] = add(
+            add(mul(l0, splat<0>(r)), mul(l1, splat<1>(r))),
+            add(mul(l2, splat<2>(r)), mul(l3, splat<3>(r)))
+        );
+        store(out_product + 4 * j, column[j]);
+    }
+
+    // Cofactors from 3D cross products of the columns (Lengyel, Foundations
+    // of Game Engine Development vol. 1, 4x4 inverse without the 1 / det
+    // scale). Rows of the adjugate are the columns of the cofactor matrix.
+    const Float4 a = column[0];
+    const Float4 b = column[1];
+    const Float4 c = column[2];
+    const Float4 d = column[3];
+    const Float4 x = splat<3>(a);
+    const Float4 y = splat<3>(b);
+    const Float4 z = splat<3>(c);
+    const Float4 w = splat<3>(d);
+    const Float4 s = cross(a, b);
+    const Float4 t = cross(c, d);
+    const Float4 u = sub(mul(a, y), mul(b, x)); // w lane a.w * b.w - b.w * a.w == 0
+    const Float4 v = sub(mul(c, w), mul(d, z));
+    store(out_cofactor +  0, set_w(add(cross(b, v), mul(t, y)), -dot3(b, t)));
+    store(out_cofactor +  4, set_w(sub(cross(v, a), mul(t, x)),  dot3(a, t)));
+    store(out_cofactor +  8, set_w(add(cross(d, u), mul(s, w)), -dot3(d, s)));
+    store(out_cofactor + 12, set_w(sub(cross(u, c), mul(s, z)),  dot3(c, s)));
+}
+
+#else
+
+void mul_with_cofactor(
+    const glm::mat4& lhs,
+    const glm::mat4& rhs,
+    float* const     out_product,
+    float* const     out_cofactor
+)
+{
+    const glm::mat4 product  = lhs * rhs;
+    const glm::mat4 cofactor = glm::transpose(glm::adjugate(product));
+    std::memcpy(out_product,  &product [0][0], sizeof(glm::mat4));
+    std::memcpy(out_cofactor, &cofactor[0][0], sizeof(glm::mat4));
+}
+
+#endif
+
+} // namespace erhe::math
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+namespace erhe::math {
+
+// Computes product = lhs * rhs and the cofactor matrix of product,
+// transpose(adjugate(product)) - the matrix that transforms normals (w = 0)
+// by product. Whole columns at a time with SSE2 / NEON, glm otherwise.
+// Results are stored as 16 column-major floats each, to addresses that need
+// not be aligned (ring buffer slots can be written directly).
+void mul_with_cofactor(
+    const glm::mat4& lhs,
+    const glm::mat4& rhs,
+    float*           out_product,
+    float*           out_cofactor
+);
+
+} // namespace erhe::math
@@ -0,0 +1,46 @@
+#include "erhe_math/vec4_kernels.hpp"
+#include "erhe_verify/verify.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#   define ERHE_MATH_VEC4_KERNELS_SSE2 1
+#   include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#   define ERHE_MATH_VEC4_KERNELS_NEON 1
+#   include <arm_neon.h>
+#endif
+
+namespace erhe::math {
+
+void blend_vec4(
+    const std::span<const glm::vec4> a,
+    const std::span<const glm::vec4> b,
+    const std::span<const glm::vec2> weights,
+    const std::span<glm::vec4>       out
+)
+{
+    const std::size_t count = out.size();
+    ERHE_VERIFY(a.size() >= count);
+    ERHE_VERIFY(b.size() >= count);
+    ERHE_VERIFY(weights.size() >= count);
+
+    const float* const a_data = &a.data()[0].x;
+    const float* const b_data = &b.data()[0].x;
+    float* const       o_data = &out.data()[0].x;
+    for (std::size_t i = 0; i < count; ++i) {
+        const glm::vec2 w = weights[i];
+#if defined(ERHE_MATH_VEC4_KERNELS_SSE2)
+        const __m128 value = _mm_add_ps(
+            _mm_mul_ps(_mm_loadu_ps(a_data + 4 * i), _mm_set1_ps(w.x)),
+            _mm_mul_ps(_mm_loadu_ps(b_data + 4 * i), _mm_set1_ps(w.y))
+        );
+        _mm_storeu_ps(o_data + 4 * i, value);
+#elif defined(ERHE_MATH_VEC4_KERNELS_NEON)
+        const float32x4_t value = vmlaq_n_f32(vmulq_n_f32(vld1q_f32(a_data + 4 * i), w.x), vld1q_f32(b_data + 4 * i), w.y);
+        vst1q_f32(o_data + 4 * i, value);
+#else
+        out[i] = a[i] * w.x + b[i] * w.y;
+#endif
+    }
+}
+
+} // namespace erhe::math
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <span>
+
+namespace erhe::math {
+
+// out[i] = a[i] * weights[i].x + b[i] * weights[i].y for every i, one
+// element per SSE2 / NEON register, glm otherwise. The weighted sum of two
+// keyframe values covers lerp (1 - t, t), slerp (sin((1 - t) * angle) /
+// sin(angle), sin(t * angle) / sin(angle)) and hold (1, 0). out may alias a
+// or b.
+void blend_vec4(
+    std::span<const glm::vec4> a,
+    std::span<const glm::vec4> b,
+    std::span<const glm::vec2> weights,
+    std::span<glm::vec4>       out
+);
+
+} // namespace erhe::math
@@ -0,0 +1,154 @@
+#include "erhe_math/aabb_soa.hpp"
+#include "erhe_math/math_util.hpp"
+
+#include <glm/glm.hpp>
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+// Inward-facing planes of the box [-4, 4]^3 (extract_frustum_planes()
+// convention: p is inside when dot(vec4{p, 1}, plane) >= 0).
+const std::array<glm::vec4, 6> box_planes{
+    glm::vec4{ 1.0f,  0.0f,  0.0f, 4.0f},
+    glm::vec4{-1.0f,  0.0f,  0.0f, 4.0f},
+    glm::vec4{ 0.0f,  1.0f,  0.0f, 4.0f},
+    glm::vec4{ 0.0f, -1.0f,  0.0f, 4.0f},
+    glm::vec4{ 0.0f,  0.0f,  1.0f, 4.0f},
+    glm::vec4{ 0.0f,  0.0f, -1.0f, 4.0f}
+};
+
+auto make_box(const glm::vec3 center, const float half_size) -> erhe::math::Aabb
+{
+    return erhe::math::Aabb{.min = center - glm::vec3{half_size}, .max = center + glm::vec3{half_size}};
+}
+
+} // anonymous namespace
+
+// ============================================================================
+// Aabb_soa storage
+// ============================================================================
+
+TEST(AabbSoa, PushBackAndGetRoundTrip)
+{
+    erhe::math::Aabb_soa soa;
+    soa.push_back(erhe::math::Aabb{.min = glm::vec3{-1.0f, 0.0f, 2.0f}, .max = glm::vec3{3.0f, 1.0f, 4.0f}});
+    ASSERT_EQ(soa.size(), 1u);
+    const erhe::math::Aabb aabb = soa.get(0);
+    EXPECT_FLOAT_EQ(aabb.min.x, -1.0f);
+    EXPECT_FLOAT_EQ(aabb.min.y,  0.0f);
+    EXPECT_FLOAT_EQ(aabb.min.z,  2.0f);
+    EXPECT_FLOAT_EQ(aabb.max.x,  3.0f);
+    EXPECT_FLOAT_EQ(aabb.max.y,  1.0f);
+    EXPECT_FLOAT_EQ(aabb.max.z,  4.0f);
+}
+
+TEST(AabbSoa, SwapRemoveMovesLastIntoSlot)
+{
+    erhe::math::Aabb_soa soa;
+    soa.push_back(make_box(glm::vec3{0.0f}, 1.0f));
+    soa.push_back(make_box(glm::vec3{1.0f}, 1.0f));
+    soa.push_back(make_box(glm::vec3{2.0f}, 1.0f));
+    soa.swap_remove(0);
+    ASSERT_EQ(soa.size(), 2u);
+    EXPECT_FLOAT_EQ(soa.center_x[0], 2.0f);
+    EXPECT_FLOAT_EQ(soa.center_x[1], 1.0f);
+    soa.swap_remove(1);
+    ASSERT_EQ(soa.size(), 1u);
+    EXPECT_FLOAT_EQ(soa.center_x[0], 2.0f);
+}
+
+// ============================================================================
+// mark_aabbs_in_convex_volume
+// ============================================================================
+
+TEST(MarkAabbsInConvexVolume, MatchesScalarReferenceAcrossSimdAndTail)
+{
+    // 7 x 7 x 7 grid of boxes with centers on half-integers: none of them
+    // touches a plane of box_planes exactly, so the SIMD lanes and the
+    // scalar tail must agree with aabb_in_convex_volume() bit for bit.
+    // 343 boxes = 85 groups of 4 + a 3 box tail.
+    erhe::math::Aabb_soa           soa;
+    std::vector<erhe::math::Aabb>  boxes;
+    for (int z = 0; z < 7; ++z) {
+        for (int y = 0; y < 7; ++y) {
+            for (int x = 0; x < 7; ++x) {
+                const glm::vec3 center{
+                    -7.5f + 2.5f * static_cast<float>(x),
+                    -7.5f + 2.5f * static_cast<float>(y),
+                    -7.5f + 2.5f * static_cast<float>(z)
+                };
+                const erhe::math::Aabb box = make_box(center, 0.25f);
+                boxes.push_back(box);
+                soa.push_back(box);
+            }
+        }
+    }
+    std::vector<uint8_t> inside(boxes.size(), 0);
+    erhe::math::mark_aabbs_in_convex_volume(soa, 0, soa.size(), box_planes, inside);
+    std::size_t inside_count = 0;
+    for (std::size_t i = 0, end = boxes.size(); i < end; ++i) {
+        const bool expected = erhe::math::aabb_in_convex_volume(box_planes, boxes[i]);
+        EXPECT_EQ(inside[i] != 0, expected) << "box " << i;
+        inside_count += (inside[i] != 0) ? 1 : 0;
+    }
+    // Centers -2.5, 0.0, 2.5 per axis are inside [-4, 4].
+    EXPECT_EQ(inside_count, 27u);
+}
+
+TEST(MarkAabbsInConvexVolume, StraddlingBoxIsKept)
+{
+    erhe::math::Aabb_soa soa;
+    soa.push_back(make_box(glm::vec3{4.5f, 0.0f, 0.0f}, 1.0f)); // crosses x = 4
+    soa.push_back(make_box(glm::vec3{6.0f, 0.0f, 0.0f}, 1.0f)); // fully outside x = 4
+    std::vector<uint8_t> inside(2, 0);
+    erhe::math::mark_aabbs_in_convex_volume(soa, 0, 2, box_planes, inside);
+    EXPECT_EQ(inside[0], 1u);
+    EXPECT_EQ(inside[1], 0u);
+}
+
+TEST(MarkAabbsInConvexVolume, InvalidBoxIsNeverRejected)
+{
+    erhe::math::Aabb_soa soa;
+    soa.push_back(erhe::math::Aabb{});
+    std::vector<uint8_t> inside(1, 0);
+    erhe::math::mark_aabbs_in_convex_volume(soa, 0, 1, box_planes, inside);
+    EXPECT_EQ(inside[0], 1u);
+}
+
+TEST(MarkAabbsInConvexVolume, SubRangeAndAccumulation)
+{
+    // Two volumes (left and right half spaces shifted apart) OR'ed into one
+    // mask over a sub range; the mask is indexed relative to begin.
+    erhe::math::Aabb_soa soa;
+    for (int i = 0; i < 10; ++i) {
+        soa.push_back(make_box(glm::vec3{-9.5f + 2.0f * static_cast<float>(i), 0.0f, 0.0f}, 0.25f));
+    }
+    const std::array<glm::vec4, 1> left_of_minus_4 {glm::vec4{-1.0f, 0.0f, 0.0f, -4.0f}}; // x <= -4
+    const std::array<glm::vec4, 1> right_of_plus_4 {glm::vec4{ 1.0f, 0.0f, 0.0f, -4.0f}}; // x >=  4
+    std::vector<uint8_t> inside(8, 0);
+    erhe::math::mark_aabbs_in_convex_volume(soa, 1, 9, left_of_minus_4, inside);
+    erhe::math::mark_aabbs_in_convex_volume(soa, 1, 9, right_of_plus_4, inside);
+    // Box centers 1..8: -7.5 -5.5 -3.5 -1.5 0.5 2.5 4.5 6.5
+    const std::array<uint8_t, 8> expected{1, 1, 0, 0, 0, 0, 1, 1};
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(inside[i], expected[i]) << "box " << (i + 1);
+    }
+}
+
+TEST(MarkAabbsInConvexVolume, NoPlanesAcceptsEverything)
+{
+    erhe::math::Aabb_soa soa;
+    for (int i = 0; i < 5; ++i) {
+        soa.push_back(make_box(glm::vec3{1000.0f * static_cast<float>(i)}, 1.0f));
+    }
+    std::vector<uint8_t> inside(5, 0);
+    erhe::math::mark_aabbs_in_convex_volume(soa, 0, 5, std::span<const glm::vec4>{}, inside);
+    for (const uint8_t value : inside) {
+        EXPECT_EQ(value, 1u);
+    }
+}
@@ -0,0 +1,80 @@
+#include "erhe_math/mat4_kernels.hpp"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtx/matrix_operation.hpp>
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstddef>
+
+namespace {
+
+void expect_near(const glm::mat4& expected, const float* actual, const float tolerance)
+{
+    for (int column = 0; column < 4; ++column) {
+        for (int row = 0; row < 4; ++row) {
+            EXPECT_NEAR(expected[column][row], actual[4 * column + row], tolerance)
+                << "column " << column << " row " << row;
+        }
+    }
+}
+
+void check_against_glm(const glm::mat4& lhs, const glm::mat4& rhs)
+{
+    const glm::mat4 product  = lhs * rhs;
+    const glm::mat4 cofactor = glm::transpose(glm::adjugate(product));
+
+    std::array<float, 16> out_product {};
+    std::array<float, 16> out_cofactor{};
+    erhe::math::mul_with_cofactor(lhs, rhs, out_product.data(), out_cofactor.data());
+    expect_near(product,  out_product.data(),  1.0e-5f);
+    expect_near(cofactor, out_cofactor.data(), 1.0e-4f);
+}
+
+} // anonymous namespace
+
+TEST(Mat4Kernels, MulWithCofactorMatchesGlmForRigidAndScaledTransforms)
+{
+    glm::mat4 world_from_joint = glm::translate(glm::mat4{1.0f}, glm::vec3{1.0f, -2.0f, 3.0f});
+    world_from_joint = glm::rotate(world_from_joint, 0.7f, glm::normalize(glm::vec3{1.0f, 2.0f, -0.5f}));
+    world_from_joint = glm::scale(world_from_joint, glm::vec3{1.5f, 0.5f, 2.0f});
+    const glm::mat4 joint_from_bind = glm::inverse(
+        glm::rotate(glm::translate(glm::mat4{1.0f}, glm::vec3{0.0f, 1.0f, 0.0f}), -0.3f, glm::vec3{0.0f, 0.0f, 1.0f})
+    );
+    check_against_glm(world_from_joint, joint_from_bind);
+
+    // Mirrored: the cofactor matrix keeps the sign of the determinant.
+    check_against_glm(glm::scale(world_from_joint, glm::vec3{-1.0f, 1.0f, 1.0f}), joint_from_bind);
+}
+
+TEST(Mat4Kernels, MulWithCofactorMatchesGlmForGeneralMatrices)
+{
+    // Non-affine bottom rows exercise the w terms of the cofactors.
+    glm::mat4 lhs{1.0f};
+    glm::mat4 rhs{1.0f};
+    for (int column = 0; column < 4; ++column) {
+        for (int row = 0; row < 4; ++row) {
+            lhs[column][row] = 0.25f * static_cast<float>((column * 7 + row * 3) % 11) - 1.0f;
+            rhs[column][row] = 0.5f  * static_cast<float>((column * 5 + row * 9) % 7)  - 1.5f;
+        }
+    }
+    check_against_glm(lhs, rhs);
+    check_against_glm(glm::frustum(-1.0f, 1.0f, -1.0f, 1.0f, 0.5f, 10.0f), lhs);
+}
+
+TEST(Mat4Kernels, MulWithCofactorWritesUnalignedDestinations)
+{
+    const glm::mat4 lhs = glm::translate(glm::mat4{1.0f}, glm::vec3{4.0f, 5.0f, 6.0f});
+    const glm::mat4 rhs = glm::scale(glm::mat4{1.0f}, glm::vec3{2.0f});
+
+    // One float of offset: neither destination is 16 byte aligned.
+    std::array<float, 2 * 16 + 1> storage{};
+    float* const out_product  = storage.data() + 1;
+    float* const out_cofactor = storage.data() + 1 + 16;
+    erhe::math::mul_with_cofactor(lhs, rhs, out_product, out_cofactor);
+    expect_near(lhs * rhs, out_product, 1.0e-6f);
+    expect_near(glm::transpose(glm::adjugate(lhs * rhs)), out_cofactor, 1.0e-5f);
+    EXPECT_EQ(storage[0], 0.0f);
+}
@@ -0,0 +1,38 @@
+#include "erhe_math/vec4_kernels.hpp"
+
+#include <glm/glm.hpp>
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+TEST(Vec4Kernels, BlendMatchesScalarWeightedSum)
+{
+    std::vector<glm::vec4> a;
+    std::vector<glm::vec4> b;
+    std::vector<glm::vec2> weights;
+    for (int i = 0; i < 7; ++i) {
+        const float f = static_cast<float>(i);
+        a      .push_back(glm::vec4{f, -f, 0.5f * f, 1.0f});
+        b      .push_back(glm::vec4{1.0f - f, 2.0f, f * f, -1.0f});
+        weights.push_back(glm::vec2{0.25f * f, 1.0f - 0.125f * f});
+    }
+    std::vector<glm::vec4> out(a.size());
+    erhe::math::blend_vec4(a, b, weights, out);
+    for (std::size_t i = 0; i < out.size(); ++i) {
+        const glm::vec4 expected = a[i] * weights[i].x + b[i] * weights[i].y;
+        for (int c = 0; c < 4; ++c) {
+            EXPECT_FLOAT_EQ(expected[c], out[i][c]) << "element " << i << " component " << c;
+        }
+    }
+}
+
+TEST(Vec4Kernels, BlendMayWriteOverInput)
+{
+    std::vector<glm::vec4>       a      {glm::vec4{1.0f, 2.0f, 3.0f, 4.0f}, glm::vec4{-1.0f}};
+    const std::vector<glm::vec4> b      {glm::vec4{3.0f, 2.0f, 1.0f, 0.0f}, glm::vec4{ 1.0f}};
+    const std::vector<glm::vec2> weights{glm::vec2{0.5f, 0.5f},             glm::vec2{1.0f, 0.0f}};
+    erhe::math::blend_vec4(a, b, weights, a);
+    EXPECT_EQ(a[0], glm::vec4(2.0f, 2.0f, 2.0f, 2.0f));
+    EXPECT_EQ(a[1], glm::vec4(-1.0f));
+}
@@ -13,7 +13,8 @@ Client::~Client() noexcept
 }
 
 Client::Client(Client&& other) noexcept
-    : m_socket{std::move(other.m_socket)}
+    : m_select_sockets{std::move(other.m_select_sockets)}
+    , m_socket        {std::move(other.m_socket)}
 {
     log_client->trace("Client move constructor");
 }
@@ -21,12 +22,14 @@ Client::Client(Client&& other) noexcept
 auto Client::operator=(Client&& other) noexcept -> Client&
 {
     log_client->trace("Client move assignment");
-    m_socket = std::move(other.m_socket);
+    m_select_sockets = std::move(other.m_select_sockets);
+    m_socket         = std::move(other.m_socket);
     return *this;
 }
 
 auto Client::connect(const char* address, const int port) -> bool
 {
+    m_select_sockets = Select_sockets{};
     return m_socket.connect(address, port);
 }
 
@@ -34,6 +37,7 @@ void Client::disconnect()
 {
     log_socket->trace("Socket move assignment");
     m_socket.close();
+    m_select_sockets = Select_sockets{};
 }
 
 auto Client::poll(const int timeout_ms) -> bool
@@ -41,7 +45,8 @@ auto Client::poll(const int timeout_ms) -> bool
     if (m_socket.get_state() == Socket::State::CLOSED) {
         return true; // NOP
     }
-    Select_sockets select_sockets;
+    Select_sockets& select_sockets = m_select_sockets;
+    select_sockets.reset();
 
     m_socket.pre_select(select_sockets);
 
@@ -55,6 +60,7 @@ auto Client::poll(const int timeout_ms) -> bool
         return true; // NOP
     }
 
+    const SOCKET client_socket = m_socket.get_socket();
     switch (m_socket.get_state()) {
         case Socket::State::CLIENT_CONNECTING: {
             m_socket.post_select_connect(select_sockets);
@@ -68,6 +74,9 @@ auto Client::poll(const int timeout_ms) -> bool
             //log_client->info("client socket is not connecting nor connected");
         }
     }
+    if (m_socket.get_state() == Socket::State::CLOSED) {
+        select_sockets.remove(client_socket);
+    }
 
     return true;
 }
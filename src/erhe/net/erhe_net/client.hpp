@@ -1,5 +1,6 @@
 #pragma once
 
+#include "erhe_net/select_sockets.hpp"
 #include "erhe_net/socket.hpp"
 
 namespace erhe::net {
@@ -22,7 +23,8 @@ public:
     auto get_state          () -> Socket::State;
 
 private:
-    Socket m_socket;
+    Select_sockets m_select_sockets;
+    Socket         m_socket;
 };
 
 } // namespace erhe::net
@@ -16,6 +16,7 @@ auto c_str(const Socket_option option) -> const char*
         case Socket_option::ReceiveTimeout   : return "ReceiveTimeout";
         case Socket_option::SendTimeout      : return "SendTimeout";
         case Socket_option::NoDelay          : return "NoDelay";
+        case Socket_option::NoSigPipe        : return "NoSigPipe";
         default:                               return "?";
     }
 }
@@ -19,6 +19,7 @@ static constexpr int ERHE_NET_ERROR_CODE_CONNECTED = WSAEISCONN;
 #   include <sys/select.h>
 #   include <sys/socket.h>
 #   include <sys/types.h>
+#   include <sys/uio.h>
 #   include <unistd.h>
 
 // For now, pretent Windows like API... TODO fix
@@ -32,9 +33,18 @@ static constexpr int    SD_BOTH        = SHUT_RDWR;
 inline auto closesocket(const SOCKET s) -> int { return close(s); }
 #endif
 
+// Linux and Android poll with epoll (select_sockets_epoll.cpp), so socket
+// descriptors are not limited to FD_SETSIZE there. Other platforms use
+// select() (select_sockets.cpp).
+#if defined(ERHE_OS_LINUX) || defined(ERHE_OS_ANDROID)
+#   define ERHE_NET_USE_EPOLL 1
+#endif
+
 static constexpr int ERHE_NET_TRUE = 1;
 
+#include <cstdint>
 #include <optional>
+#include <span>
 #include <string>
 
 namespace erhe::net {
@@ -57,7 +67,8 @@ enum class Socket_option : unsigned int {
     ReuseAddress      = 4,
     ReceiveTimeout    = 5,
     SendTimeout       = 6,
-    NoDelay           = 8
+    NoDelay           = 8,
+    NoSigPipe         = 9  // SO_NOSIGPIPE where send_buffers() has no MSG_NOSIGNAL; no-op elsewhere
 };
 
 auto c_str(Socket_option) -> const char*;
@@ -66,4 +77,10 @@ auto get_socket_option(SOCKET socket, Socket_option option) -> std::optional<int
 
 auto initialize_net() -> bool;
 
+// Gathers up to c_max_send_buffers buffers into a single send call (sendmsg()
+// on Unix, WSASend() on Windows). Returns the number of bytes sent, which may
+// be less than the total, or SOCKET_ERROR.
+static constexpr std::size_t c_max_send_buffers = 64;
+auto send_buffers(SOCKET socket, std::span<const std::span<const uint8_t>> buffers) -> int64_t;
+
 } // namespace erhe::net
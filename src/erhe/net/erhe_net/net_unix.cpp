@@ -3,7 +3,10 @@
 #include <string.h>
 
 #include <fmt/format.h>
- 
+
+#include <algorithm>
+#include <array>
+
 namespace erhe::net
 {
 
@@ -189,7 +192,11 @@ auto is_error_busy(const int error_code) -> bool
 
 auto is_socket_good(const SOCKET socket) -> bool
 {
-    return (socket >= 0) && (socket <= FD_SETSIZE);
+#if defined(ERHE_NET_USE_EPOLL)
+    return socket >= 0;
+#else
+    return (socket >= 0) && (socket < FD_SETSIZE); // FD_SET() on larger fds is undefined
+#endif
 }
 
 auto set_socket_option(
@@ -213,7 +220,7 @@ auto set_socket_option(
             if (flags == -1) {
                 return false;
             }
-            flags = (value != 0) ? (flags & ~O_NONBLOCK) : (flags | O_NONBLOCK);
+            flags = (value != 0) ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK);
             result = fcntl(socket, F_SETFL, flags);
             break;
         }
@@ -241,6 +248,16 @@ auto set_socket_option(
             result = setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, optval, optlen);
             break;
         }
+        case Socket_option::NoSigPipe: {
+            // Without MSG_NOSIGNAL (macOS, BSDs), a send to a peer that closed
+            // the connection raises SIGPIPE unless the socket opts out.
+#if !defined(MSG_NOSIGNAL) && defined(SO_NOSIGPIPE)
+            result = setsockopt(socket, SOL_SOCKET, SO_NOSIGPIPE, optval, optlen);
+#else
+            result = 0;
+#endif
+            break;
+        }
         default: break;
     }
     if (result == SOCKET_ERROR) {
@@ -290,6 +307,30 @@ auto get_socket_option(
     return value;
 }
 
+auto send_buffers(const SOCKET socket, const std::span<const std::span<const uint8_t>> buffers) -> int64_t
+{
+    std::array<iovec, c_max_send_buffers> iov{};
+    const std::size_t iov_count = (std::min)(buffers.size(), iov.size());
+    for (std::size_t i = 0; i < iov_count; ++i) {
+        iov[i].iov_base = const_cast<uint8_t*>(buffers[i].data());
+        iov[i].iov_len  = buffers[i].size();
+    }
+    msghdr message{};
+    message.msg_iov    = iov.data();
+    message.msg_iovlen = static_cast<decltype(message.msg_iovlen)>(iov_count);
+
+    // sendmsg() rather than writev(): same gather, but takes MSG_NOSIGNAL so
+    // that a peer closing the connection is an EPIPE error, not SIGPIPE.
+    // Where MSG_NOSIGNAL is missing, Socket_option::NoSigPipe set on every
+    // connected socket does the same.
+#if defined(MSG_NOSIGNAL)
+    const int flags = MSG_NOSIGNAL;
+#else
+    const int flags = 0;
+#endif
+    return static_cast<int64_t>(sendmsg(socket, &message, flags));
+}
+
 auto get_net_hints(const int flags, const int family, const int socktype, const int protocol) -> addrinfo
 {
     static_cast<void>(flags);
@@ -3,6 +3,8 @@
 
 #include <fmt/format.h>
 
+#include <algorithm>
+#include <array>
 #include <cstdio>
 
 namespace erhe::net {
@@ -226,6 +228,10 @@ auto set_socket_option(const SOCKET socket, const Socket_option option, int valu
             result = setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, optval, optlen);
             break;
         }
+        case Socket_option::NoSigPipe: {
+            result = 0; // No SIGPIPE on Windows
+            break;
+        }
         default: break;
     }
     if (result == SOCKET_ERROR) {
@@ -272,6 +278,22 @@ auto get_socket_option(const SOCKET socket, const Socket_option option) -> std::
     return value;
 }
 
+auto send_buffers(const SOCKET socket, const std::span<const std::span<const uint8_t>> buffers) -> int64_t
+{
+    std::array<WSABUF, c_max_send_buffers> wsa_buffers{};
+    const std::size_t buffer_count = (std::min)(buffers.size(), wsa_buffers.size());
+    for (std::size_t i = 0; i < buffer_count; ++i) {
+        wsa_buffers[i].buf = reinterpret_cast<CHAR*>(const_cast<uint8_t*>(buffers[i].data()));
+        wsa_buffers[i].len = static_cast<ULONG>(buffers[i].size());
+    }
+    DWORD     sent_byte_count = 0;
+    const int result          = WSASend(socket, wsa_buffers.data(), static_cast<DWORD>(buffer_count), &sent_byte_count, 0, nullptr, nullptr);
+    if (result == SOCKET_ERROR) {
+        return SOCKET_ERROR;
+    }
+    return static_cast<int64_t>(sent_byte_count);
+}
+
 auto get_net_hints(const int flags, const int family, const int socktype, const int protocol) -> addrinfo
 {
     return addrinfo{
@@ -65,32 +65,18 @@ auto Ring_buffer::size() const -> std::size_t
     return m_max_size + m_write_offset - m_read_offset;
 }
 
+// Moves the readable bytes to the start of the buffer
 void Ring_buffer::rotate()
 {
+    const std::size_t readable_byte_count = size();
     rotate(m_read_offset);
+    m_read_offset  = 0;
+    m_write_offset = readable_byte_count % m_max_size;
 }
 
 void Ring_buffer::rotate(std::size_t rotate_amount)
 {
-    size_t count  = 0;
-    size_t offset = 0;
-
-    while (count < m_max_size) {
-        size_t  to_index   = offset;
-        uint8_t tmp        = m_buffer[to_index];
-        size_t  from_index = (to_index + rotate_amount) % m_max_size;
-
-        while (from_index != offset) {
-            m_buffer[to_index] = m_buffer[from_index];
-            to_index   = from_index;
-            from_index = (to_index + rotate_amount) % m_max_size;
-            ++count;
-        }
-
-        m_buffer[to_index] = tmp;
-        ++count;
-        ++offset;
-    }
+    std::rotate(m_buffer.begin(), m_buffer.begin() + (rotate_amount % m_max_size), m_buffer.end());
 }
 
 auto Ring_buffer::size_available_for_write() const -> std::size_t
@@ -168,6 +154,23 @@ auto Ring_buffer::begin_consume(
     return &m_buffer[m_read_offset];
 }
 
+void Ring_buffer::begin_consume(
+    std::span<const uint8_t>& readable_before_wrap,
+    std::span<const uint8_t>& readable_after_wrap
+) const
+{
+    const std::size_t can_read_count = size_available_for_read();
+    if (can_read_count == 0) {
+        readable_before_wrap = {};
+        readable_after_wrap  = {};
+        return;
+    }
+    const std::size_t max_count_before_wrap = m_max_size - m_read_offset;
+    const std::size_t count_before_wrap     = std::min(can_read_count, max_count_before_wrap);
+    readable_before_wrap = std::span<const uint8_t>{m_buffer.data() + m_read_offset, count_before_wrap};
+    readable_after_wrap  = std::span<const uint8_t>{m_buffer.data(), can_read_count - count_before_wrap};
+}
+
 void Ring_buffer::end_consume(std::size_t byte_count)
 {
     m_read_offset = (m_read_offset + byte_count) % m_max_size;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <span>
 #include <vector>
 
 namespace erhe::net {
@@ -37,6 +38,12 @@ public:
         std::size_t& readable_byte_count_before_wrap,
         std::size_t& readable_byte_count_after_wrap
     ) -> const uint8_t*;
+    // For gathered send: all readable bytes, as up to two spans (after_wrap
+    // is empty unless the data wraps around the end of the buffer)
+    void begin_consume           (
+        std::span<const uint8_t>& readable_before_wrap,
+        std::span<const uint8_t>& readable_after_wrap
+    ) const;
     void end_consume             (std::size_t byte_count);
 
     auto read                    (uint8_t* dst, std::size_t byte_count) -> std::size_t;
@@ -5,10 +5,28 @@
 namespace erhe::net {
 
 Select_sockets::Select_sockets()
+{
+    reset();
+}
+
+Select_sockets::~Select_sockets() noexcept = default;
+
+Select_sockets::Select_sockets(Select_sockets&& other) noexcept = default;
+
+auto Select_sockets::operator=(Select_sockets&& other) noexcept -> Select_sockets& = default;
+
+void Select_sockets::reset()
 {
     FD_ZERO(&read_fds);
     FD_ZERO(&write_fds);
     FD_ZERO(&except_fds);
+    nfds  = 0;
+    flags = 0;
+}
+
+void Select_sockets::remove(const SOCKET socket)
+{
+    static_cast<void>(socket); // fd sets are rebuilt every round
 }
 
 auto Select_sockets::has_read() const -> bool
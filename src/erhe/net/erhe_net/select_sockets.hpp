@@ -2,12 +2,31 @@
 
 #include "erhe_net/net_os.hpp"
 
+#if defined(ERHE_NET_USE_EPOLL)
+#   include <sys/epoll.h>
+#   include <vector>
+#endif
+
 namespace erhe::net {
 
+// Readiness poller. Server and Client keep one for their lifetime and, each
+// poll, call reset(), set the sockets of interest, select() and then query
+// has_*().
+//
+// With ERHE_NET_USE_EPOLL the interest set lives in a persistent epoll
+// instance: select() only issues epoll_ctl() for sockets whose interest
+// changed since the previous round, and readiness lookup is indexed by fd,
+// so there is no FD_SETSIZE limit and no per-poll rebuild of fd sets.
+// Elsewhere it is a thin wrapper around select() / fd_set.
 class Select_sockets
 {
 public:
     Select_sockets();
+    ~Select_sockets() noexcept;
+    Select_sockets(const Select_sockets&) = delete;
+    void operator=(const Select_sockets&) = delete;
+    Select_sockets(Select_sockets&& other) noexcept;
+    auto operator=(Select_sockets&& other) noexcept -> Select_sockets&;
 
     static constexpr int flag_read   = (1u << 0u);
     static constexpr int flag_write  = (1u << 1u);
@@ -24,11 +43,34 @@ public:
     void set_except(SOCKET socket);
     auto select    (int timeout_ms) -> int;
 
+    // Starts a new round: clears interest and readiness of the previous one
+    void reset();
+
+    // Forgets a socket that was closed after it was last passed to select(),
+    // so that a new socket reusing the descriptor is registered again.
+    void remove(SOCKET socket);
+
     unsigned int flags{0};
+
+#if defined(ERHE_NET_USE_EPOLL)
+private:
+    void ensure_fd(SOCKET socket);
+    void set_interest(SOCKET socket, uint32_t events, unsigned int flag);
+
+    int                      m_epoll_fd{-1};
+    std::vector<uint32_t>    m_wanted;          // by fd, EPOLL* events of interest this round
+    std::vector<uint32_t>    m_registered;      // by fd, events registered to epoll, 0 when not registered
+    std::vector<uint32_t>    m_ready;           // by fd, events reported by the last select()
+    std::vector<SOCKET>      m_wanted_fds;
+    std::vector<SOCKET>      m_registered_fds;
+    std::vector<SOCKET>      m_ready_fds;
+    std::vector<epoll_event> m_events;
+#else
     int          nfds{0};
     FD_SET       read_fds;
     FD_SET       write_fds;
     FD_SET       except_fds;
+#endif
 };
 
 } // namespace erhe::net
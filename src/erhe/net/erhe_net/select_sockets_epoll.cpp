@@ -0,0 +1,238 @@
+#include "erhe_net/select_sockets.hpp"
+#include "erhe_net/net_log.hpp"
+
+#include <algorithm>
+
+namespace erhe::net {
+
+// Level triggered: a socket that still has data to read (or room to write)
+// after post_select is reported again by the next select(), as with select().
+//
+// Errors and hangups are reported as readable and writable, which is what
+// select() does; a failed non-blocking connect() thus shows up as writable
+// and is picked up by Socket::post_select_connect().
+static constexpr uint32_t c_read_ready_events  = EPOLLIN  | EPOLLERR | EPOLLHUP;
+static constexpr uint32_t c_write_ready_events = EPOLLOUT | EPOLLERR | EPOLLHUP;
+
+Select_sockets::Select_sockets()
+    : m_epoll_fd{epoll_create1(EPOLL_CLOEXEC)}
+{
+    if (m_epoll_fd < 0) {
+        log_net->error("epoll_create1() failed with error {}", get_net_last_error_message());
+    }
+}
+
+Select_sockets::~Select_sockets() noexcept
+{
+    if (m_epoll_fd >= 0) {
+        ::close(m_epoll_fd);
+    }
+}
+
+Select_sockets::Select_sockets(Select_sockets&& other) noexcept
+    : flags           {other.flags}
+    , m_epoll_fd      {other.m_epoll_fd}
+    , m_wanted        {std::move(other.m_wanted)}
+    , m_registered    {std::move(other.m_registered)}
+    , m_ready         {std::move(other.m_ready)}
+    , m_wanted_fds    {std::move(other.m_wanted_fds)}
+    , m_registered_fds{std::move(other.m_registered_fds)}
+    , m_ready_fds     {std::move(other.m_ready_fds)}
+    , m_events        {std::move(other.m_events)}
+{
+    other.flags      = 0;
+    other.m_epoll_fd = -1;
+}
+
+auto Select_sockets::operator=(Select_sockets&& other) noexcept -> Select_sockets&
+{
+    if (this == &other) {
+        return *this;
+    }
+    if (m_epoll_fd >= 0) {
+        ::close(m_epoll_fd);
+    }
+    flags            = other.flags;
+    m_epoll_fd       = other.m_epoll_fd;
+    m_wanted         = std::move(other.m_wanted);
+    m_registered     = std::move(other.m_registered);
+    m_ready          = std::move(other.m_ready);
+    m_wanted_fds     = std::move(other.m_wanted_fds);
+    m_registered_fds = std::move(other.m_registered_fds);
+    m_ready_fds      = std::move(other.m_ready_fds);
+    m_events         = std::move(other.m_events);
+    other.flags      = 0;
+    other.m_epoll_fd = -1;
+    return *this;
+}
+
+void Select_sockets::reset()
+{
+    for (const SOCKET socket : m_wanted_fds) {
+        m_wanted[socket] = 0;
+    }
+    for (const SOCKET socket : m_ready_fds) {
+        m_ready[socket] = 0;
+    }
+    m_wanted_fds.clear();
+    m_ready_fds.clear();
+    flags = 0;
+}
+
+void Select_sockets::remove(const SOCKET socket)
+{
+    if ((socket < 0) || (static_cast<std::size_t>(socket) >= m_registered.size()) || (m_registered[socket] == 0)) {
+        return;
+    }
+    // Fails with EBADF / ENOENT when the socket has already been closed,
+    // which removed it from the epoll set; only the bookkeeping matters then.
+    static_cast<void>(epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, socket, nullptr));
+    m_registered[socket] = 0;
+}
+
+auto Select_sockets::has_read() const -> bool
+{
+    return (flags & flag_read) == flag_read;
+}
+
+auto Select_sockets::has_write() const -> bool
+{
+    return (flags & flag_write) == flag_write;
+}
+
+auto Select_sockets::has_except() const -> bool
+{
+    return (flags & flag_except) == flag_except;
+}
+
+auto Select_sockets::has_read(const SOCKET socket) const -> bool
+{
+    if ((socket < 0) || (static_cast<std::size_t>(socket) >= m_ready.size())) {
+        return false;
+    }
+    return ((m_wanted[socket] & EPOLLIN) != 0) && ((m_ready[socket] & c_read_ready_events) != 0);
+}
+
+auto Select_sockets::has_write(const SOCKET socket) const -> bool
+{
+    if ((socket < 0) || (static_cast<std::size_t>(socket) >= m_ready.size())) {
+        return false;
+    }
+    return ((m_wanted[socket] & EPOLLOUT) != 0) && ((m_ready[socket] & c_write_ready_events) != 0);
+}
+
+auto Select_sockets::has_except(const SOCKET socket) const -> bool
+{
+    if ((socket < 0) || (static_cast<std::size_t>(socket) >= m_ready.size())) {
+        return false;
+    }
+    return ((m_wanted[socket] & EPOLLPRI) != 0) && ((m_ready[socket] & EPOLLPRI) != 0);
+}
+
+void Select_sockets::ensure_fd(const SOCKET socket)
+{
+    const std::size_t required_size = static_cast<std::size_t>(socket) + 1;
+    if (m_wanted.size() < required_size) {
+        m_wanted    .resize(required_size, 0);
+        m_registered.resize(required_size, 0);
+        m_ready     .resize(required_size, 0);
+    }
+}
+
+void Select_sockets::set_interest(const SOCKET socket, const uint32_t events, const unsigned int flag)
+{
+    if (socket < 0) {
+        return;
+    }
+    ensure_fd(socket);
+    if (m_wanted[socket] == 0) {
+        m_wanted_fds.push_back(socket);
+    }
+    m_wanted[socket] |= events;
+    flags = flags | flag;
+}
+
+void Select_sockets::set_read(const SOCKET socket)
+{
+    set_interest(socket, EPOLLIN, flag_read);
+}
+
+void Select_sockets::set_write(const SOCKET socket)
+{
+    set_interest(socket, EPOLLOUT, flag_write);
+}
+
+void Select_sockets::set_except(const SOCKET socket)
+{
+    set_interest(socket, EPOLLPRI, flag_except);
+}
+
+auto Select_sockets::select(const int timeout_ms) -> int
+{
+    if (m_epoll_fd < 0) {
+        return SOCKET_ERROR;
+    }
+
+    // Unregister sockets that are no longer of interest
+    for (const SOCKET socket : m_registered_fds) {
+        if ((m_registered[socket] != 0) && (m_wanted[socket] == 0)) {
+            remove(socket);
+        }
+    }
+
+    // Register new sockets and sockets with changed interest
+    for (const SOCKET socket : m_wanted_fds) {
+        const uint32_t wanted = m_wanted[socket];
+        if (m_registered[socket] == wanted) {
+            continue;
+        }
+        epoll_event event{};
+        event.events  = wanted;
+        event.data.fd = socket;
+        int op     = (m_registered[socket] == 0) ? EPOLL_CTL_ADD : EPOLL_CTL_MOD;
+        int result = epoll_ctl(m_epoll_fd, op, socket, &event);
+        if (result != 0) {
+            // Descriptor was closed and reused behind our back (MOD -> ENOENT),
+            // or registered without our knowledge (ADD -> EEXIST): retry with
+            // the other operation.
+            const int error_code = get_net_last_error();
+            if ((error_code == ENOENT) || (error_code == EEXIST)) {
+                op     = (op == EPOLL_CTL_ADD) ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+                result = epoll_ctl(m_epoll_fd, op, socket, &event);
+            }
+        }
+        if (result != 0) {
+            log_net->warn("epoll_ctl() failed for socket {} with error {}", socket, get_net_last_error_message());
+            m_registered[socket] = 0;
+            continue;
+        }
+        m_registered[socket] = wanted;
+    }
+
+    // After the two passes above, exactly the sockets of interest are registered
+    m_registered_fds.clear();
+    for (const SOCKET socket : m_wanted_fds) {
+        if (m_registered[socket] != 0) {
+            m_registered_fds.push_back(socket);
+        }
+    }
+
+    m_events.resize((std::max)(std::size_t{1}, m_registered_fds.size()));
+    const int event_count = epoll_wait(m_epoll_fd, m_events.data(), static_cast<int>(m_events.size()), timeout_ms);
+    if (event_count < 0) {
+        if (get_net_last_error() == EINTR) {
+            return 0;
+        }
+        return SOCKET_ERROR;
+    }
+    for (int i = 0; i < event_count; ++i) {
+        const SOCKET socket = m_events[i].data.fd;
+        if (m_ready[socket] == 0) {
+            m_ready_fds.push_back(socket);
+        }
+        m_ready[socket] |= m_events[i].events;
+    }
+    return event_count;
+}
+
+} // namespace erhe::net
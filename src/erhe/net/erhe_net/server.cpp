@@ -6,6 +6,8 @@
 
 #include <fmt/format.h>
 
+#include <algorithm>
+
 namespace erhe::net {
 
 Server::Server() = default;
@@ -16,7 +18,8 @@ Server::~Server() noexcept
 }
 
 Server::Server(Server&& other) noexcept
-    : m_listen_socket  {std::move(other.m_listen_socket)}
+    : m_select_sockets {std::move(other.m_select_sockets)}
+    , m_listen_socket  {std::move(other.m_listen_socket)}
     , m_receive_handler{std::move(other.m_receive_handler)}
     , m_clients        {std::move(other.m_clients)}
 {
@@ -26,6 +29,7 @@ Server::Server(Server&& other) noexcept
 auto Server::operator=(Server&& other) noexcept -> Server&
 {
     log_server->trace("Server move assignment");
+    m_select_sockets  = std::move(other.m_select_sockets);
     m_listen_socket   = std::move(other.m_listen_socket);
     m_receive_handler = std::move(other.m_receive_handler);
     m_clients         = std::move(other.m_clients);
@@ -43,7 +47,8 @@ auto Server::poll(const int timeout_ms) -> bool
         return true; // NOP
     }
 
-    Select_sockets select_sockets;
+    Select_sockets& select_sockets = m_select_sockets;
+    select_sockets.reset();
 
     // Collect fds for select
     m_listen_socket.pre_select(select_sockets);
@@ -58,9 +63,15 @@ auto Server::poll(const int timeout_ms) -> bool
         return false; // TODO
     }
 
-    // Perform send and receive for client sockets, collect closed sockets
+    // Perform send and receive for client sockets, collect closed sockets.
+    // Sockets closed here are removed from the poller before accept() below
+    // can hand out the same descriptor to a new client.
     for (auto& client : m_clients) {
+        const SOCKET client_socket = client.get_socket();
         client.post_select_send_recv(select_sockets);
+        if (client.get_state() == Socket::State::CLOSED) {
+            select_sockets.remove(client_socket);
+        }
     }
 
     // Remove closed sockets
@@ -75,9 +86,12 @@ auto Server::poll(const int timeout_ms) -> bool
         m_clients.end()
     );
 
-    // Check for new clients
-    auto new_socket = m_listen_socket.post_select_listen(select_sockets);
-    if (new_socket.has_value()) {
+    // Check for new clients; accept all pending connections, not just one
+    for (;;) {
+        auto new_socket = m_listen_socket.post_select_listen(select_sockets);
+        if (!new_socket.has_value()) {
+            break;
+        }
         log_net->info("new client is connecting to server");
         new_socket.value().set_receive_handler(m_receive_handler);
         m_clients.push_back(std::move(new_socket.value()));
@@ -86,11 +100,18 @@ auto Server::poll(const int timeout_ms) -> bool
     return true;
 }
 
+// The message is framed once into a shared packet; each client queues a
+// reference to it, so the payload is copied once regardless of client count.
 auto Server::broadcast(const std::string& message) -> bool
 {
+    if (m_clients.empty()) {
+        return true;
+    }
+    const auto packet = std::make_shared<const Packet_buffer>(message.data(), message.length());
     std::size_t error_count = 0;
     for (auto& client : m_clients) {
-        if (!client.send(message.data(), static_cast<int>(message.length()))) {
+        // Clients closed by an earlier send are removed in the next poll()
+        if ((client.get_state() != Socket::State::CONNECTED) || !client.send(packet)) {
             ++error_count;
         }
     }
@@ -106,6 +127,7 @@ void Server::disconnect()
 {
     m_listen_socket.close();
     m_clients.clear();
+    m_select_sockets = Select_sockets{};
 }
 
 auto Server::get_state() const -> Socket::State
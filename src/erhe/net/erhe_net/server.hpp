@@ -1,5 +1,6 @@
 #pragma once
 
+#include "erhe_net/select_sockets.hpp"
 #include "erhe_net/socket.hpp"
 
 namespace erhe::net
@@ -24,6 +25,7 @@ public:
     [[nodiscard]] auto get_client_count   () const -> std::size_t;
 
 private:
+    Select_sockets      m_select_sockets;
     Socket              m_listen_socket;
     Receive_handler     m_receive_handler;
     std::vector<Socket> m_clients;
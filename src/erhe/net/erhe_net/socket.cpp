@@ -6,6 +6,9 @@
 
 #include <fmt/format.h>
 
+#include <array>
+#include <cstring>
+
 namespace erhe::net {
 
 //                                            E  r  h  e
@@ -42,6 +45,16 @@ Packet_header::Packet_header(const uint32_t length)
 {
 }
 
+Packet_buffer::Packet_buffer(const char* const data, const std::size_t length)
+{
+    const Packet_header header{static_cast<uint32_t>(length)};
+    m_bytes.resize(sizeof(Packet_header) + length);
+    memcpy(m_bytes.data(), &header, sizeof(Packet_header));
+    if (length > 0) {
+        memcpy(m_bytes.data() + sizeof(Packet_header), data, length);
+    }
+}
+
 Socket::Socket()
 {
     log_socket->trace("Socket default constructor");
@@ -81,6 +94,8 @@ Socket::Socket(Socket&& other) noexcept
     , m_address        {std::move(other.m_address)}
     , m_state          {other.m_state}
     , m_send_buffer    {std::move(other.m_send_buffer)}
+    , m_send_queue     {std::move(other.m_send_queue)}
+    , m_send_queue_byte_count{other.m_send_queue_byte_count}
     , m_receive_buffer {std::move(other.m_receive_buffer)}
     , m_receive_handler{std::move(other.m_receive_handler)}
 {
@@ -88,6 +103,8 @@ Socket::Socket(Socket&& other) noexcept
     other.m_socket    = INVALID_SOCKET;
     other.m_state     = State::CLOSED;
     other.m_addr_info = nullptr;
+    other.m_send_queue.clear();
+    other.m_send_queue_byte_count = 0;
 }
 
 auto Socket::operator=(Socket&& other) noexcept -> Socket&
@@ -99,11 +116,15 @@ auto Socket::operator=(Socket&& other) noexcept -> Socket&
     m_address         = std::move(other.m_address);
     m_state           = other.m_state;
     m_send_buffer     = std::move(other.m_send_buffer);
+    m_send_queue      = std::move(other.m_send_queue);
+    m_send_queue_byte_count = other.m_send_queue_byte_count;
     m_receive_buffer  = std::move(other.m_receive_buffer);
     m_receive_handler = std::move(other.m_receive_handler);
     other.m_socket    = INVALID_SOCKET;
     other.m_state     = State::CLOSED;
     other.m_addr_info = nullptr;
+    other.m_send_queue.clear();
+    other.m_send_queue_byte_count = 0;
     return *this;
 }
 
@@ -115,6 +136,8 @@ void Socket::close()
         m_addr_info = nullptr;
     }
     m_send_buffer.reset();
+    m_send_queue.clear();
+    m_send_queue_byte_count = 0;
     m_receive_buffer.reset();
     if (is_socket_good(m_socket)) {
         log_socket->info("Closing socket");
@@ -162,6 +185,10 @@ auto Socket::connect(const char* const address, const int port) -> bool
     if (!non_block_ok) {
         return false;
     }
+    const bool no_sigpipe_ok = set_socket_option(m_socket, Socket_option::NoSigPipe, true);
+    if (!no_sigpipe_ok) {
+        return false;
+    }
 
     log_socket->info("Connecting to {} port {}", address, port);
     set_state(State::CLIENT_CONNECTING);
@@ -221,7 +248,7 @@ auto Socket::bind(const char* const address, const int port) -> bool
         return false;
     }
 
-    const int backlog = 8;
+    const int backlog = SOMAXCONN;
     const int listen_res = listen(m_socket, backlog);
     if (listen_res == SOCKET_ERROR) {
         log_socket->error("listen() failed with error {}", get_net_last_error_message());
@@ -236,36 +263,56 @@ auto Socket::bind(const char* const address, const int port) -> bool
     return true;
 }
 
-// Attempts to send some or all of the data queued in send buffer.
+// Attempts to send some or all of the queued data, gathering queued ring
+// buffer bytes and shared packets into as few send calls as possible.
 // Returns true if no error, returns false in case of error.
 auto Socket::send_pending() -> bool
 {
     ERHE_VERIFY(m_state == State::CONNECTED);
     ERHE_VERIFY(m_send_buffer);
 
-    // Loop (at most) twice, for the case where the ring buffer
-    // wraps around, in which case two send() calls are needed.
-    for (;;) {
-        if (m_send_buffer->empty()) {
-            return true;
+    while (!m_send_queue.empty()) {
+        std::span<const uint8_t> ring_before_wrap;
+        std::span<const uint8_t> ring_after_wrap;
+        m_send_buffer->begin_consume(ring_before_wrap, ring_after_wrap);
+
+        // A ring buffer segment takes at most two buffers (when it wraps)
+        std::array<std::span<const uint8_t>, c_max_send_buffers> buffers;
+        std::size_t buffer_count = 0;
+        std::size_t byte_count   = 0;
+        std::size_t ring_offset  = 0; // of the segment, in the readable ring bytes
+        for (const Send_segment& segment : m_send_queue) {
+            if (buffer_count + 2 > buffers.size()) {
+                break;
+            }
+            if (segment.packet) {
+                buffers[buffer_count++] = segment.packet->get_bytes().subspan(segment.offset, segment.byte_count);
+            } else {
+                std::size_t offset    = ring_offset;
+                std::size_t remaining = segment.byte_count;
+                if (offset < ring_before_wrap.size()) {
+                    const std::size_t count = (std::min)(remaining, ring_before_wrap.size() - offset);
+                    buffers[buffer_count++] = ring_before_wrap.subspan(offset, count);
+                    remaining -= count;
+                    offset = 0;
+                } else {
+                    offset -= ring_before_wrap.size();
+                }
+                if (remaining > 0) {
+                    buffers[buffer_count++] = ring_after_wrap.subspan(offset, remaining);
+                }
+                ring_offset += segment.byte_count;
+            }
+            byte_count += segment.byte_count;
         }
 
-        std::size_t          can_send_byte_count_before_wrap{0};
-        std::size_t          can_send_byte_count_after_wrap {0};
-        const uint8_t* const read_pointer    = m_send_buffer->begin_consume(can_send_byte_count_before_wrap, can_send_byte_count_after_wrap);
-        const int            send_result     = ::send(m_socket, reinterpret_cast<const char*>(read_pointer), static_cast<int>(can_send_byte_count_before_wrap), 0);
-        const int            sent_byte_count = (std::max)(0, send_result);
-        if (can_send_byte_count_after_wrap > 0) {
-            log_socket->info("send() before wrap {} bytes, after wrap {} bytes", can_send_byte_count_before_wrap, can_send_byte_count_after_wrap);
-        }
+        const int64_t send_result = send_buffers(m_socket, std::span<const std::span<const uint8_t>>{buffers.data(), buffer_count});
         if (send_result < 0) {
-            m_send_buffer->end_consume(0);
             const int error_code = get_net_last_error();
-            if (is_error_fatal(error_code))
-            {
+            if (is_error_fatal(error_code)) {
                 log_socket->error(
                     "send({} bytes) failed with error {}",
-                    can_send_byte_count_before_wrap,
+                    byte_count,
                     get_net_error_message(error_code)
                 );
                 close();
@@ -273,37 +320,82 @@ auto Socket::send_pending() -> bool
             }
             return true;
         }
-        m_send_buffer->end_consume(sent_byte_count);
-        if (
-            (sent_byte_count < can_send_byte_count_before_wrap) ||
-            (can_send_byte_count_after_wrap == 0)
-        ) {
-            break;
+        const std::size_t sent_byte_count = static_cast<std::size_t>(send_result);
+        consume_sent(sent_byte_count);
+        if (sent_byte_count < byte_count) {
+            break; // Socket send buffer is full
         }
     }
     return true;
 }
 
+void Socket::consume_sent(std::size_t byte_count)
+{
+    ERHE_VERIFY(byte_count <= m_send_queue_byte_count);
+    m_send_queue_byte_count -= byte_count;
+    while (byte_count > 0) {
+        Send_segment&     segment = m_send_queue.front();
+        const std::size_t count   = (std::min)(byte_count, segment.byte_count);
+        if (segment.packet) {
+            segment.offset += count;
+        } else {
+            m_send_buffer->end_consume(count);
+        }
+        segment.byte_count -= count;
+        byte_count         -= count;
+        if (segment.byte_count == 0) {
+            m_send_queue.pop_front();
+        }
+    }
+}
+
+// Queued bytes, ring buffer and shared packets together, are limited to the
+// send ring buffer capacity.
+auto Socket::reserve_send_space(const std::size_t byte_count) -> bool
+{
+    const std::size_t capacity = m_send_buffer->max_size();
+    if (m_send_queue_byte_count + byte_count <= capacity) {
+        return true;
+    }
+
+    // Does not fit? Try to flush queued data
+    const auto send_pending_result = send_pending();
+    if (!send_pending_result) {
+        return false;
+    }
+    // Check again how much fits
+    if (m_send_queue_byte_count + byte_count <= capacity) {
+        return true;
+    }
+    log_socket->warn(
+        "message ({} bytes) does not fit to send queue ({} bytes free)",
+        byte_count,
+        capacity - m_send_queue_byte_count
+    );
+    return false;
+}
+
+void Socket::queue_send_buffer(const std::size_t byte_count)
+{
+    if (!m_send_queue.empty() && !m_send_queue.back().packet) {
+        m_send_queue.back().byte_count += byte_count;
+    } else {
+        m_send_queue.push_back(Send_segment{.packet = {}, .offset = 0, .byte_count = byte_count});
+    }
+    m_send_queue_byte_count += byte_count;
+}
+
 // Sends a packet. Returns true if there was no error, false if there was an error.
 auto Socket::send(const char* const data, const int length) -> bool
 {
     ERHE_VERIFY(m_state == State::CONNECTED);
 
-    // Check if new message fits to send buffer
-    std::size_t can_write_count = m_send_buffer->size_available_for_write();
-    if (can_write_count < sizeof(Packet_header) + length) {
-        // Does not fit? Try to flush queued data
-        const auto send_pending_result = send_pending();
-        if (!send_pending_result) {
-            return false;
-        }
-        // Check again how much fits
-        can_write_count = m_send_buffer->size_available_for_write();
-        if (can_write_count < sizeof(Packet_header) + length) {
-            m_send_buffer->end_produce(0);
-            log_socket->warn("message ({} bytes) does not fit to send queue ({} bytes free)", length, can_write_count);
-            return false;
-        }
+    if (!reserve_send_space(sizeof(Packet_header) + length)) {
+        return false;
+    }
+    // send_pending() in reserve_send_space() may have closed the socket
+    if (m_state != State::CONNECTED) {
+        return false;
     }
 
     // Write header to send buffer
@@ -315,7 +407,30 @@ auto Socket::send(const char* const data, const int length) -> bool
     const auto payload_byte_write_count = m_send_buffer->write(reinterpret_cast<const uint8_t*>(data), static_cast<size_t>(length));
     ERHE_VERIFY(payload_byte_write_count == length);
 
-    // Try to send some or all of the queued send buffer
+    queue_send_buffer(sizeof(Packet_header) + length);
+
+    // Try to send some or all of the queued data
+    return send_pending();
+}
+
+// Sends a shared packet; only a reference to it is queued.
+// Returns true if there was no error, false if there was an error.
+auto Socket::send(const std::shared_ptr<const Packet_buffer>& packet) -> bool
+{
+    ERHE_VERIFY(m_state == State::CONNECTED);
+    ERHE_VERIFY(packet);
+
+    const std::size_t byte_count = packet->get_bytes().size();
+    if (!reserve_send_space(byte_count)) {
+        return false;
+    }
+    if (m_state != State::CONNECTED) {
+        return false;
+    }
+
+    m_send_queue.push_back(Send_segment{.packet = packet, .offset = 0, .byte_count = byte_count});
+    m_send_queue_byte_count += byte_count;
+
     return send_pending();
 }
 
@@ -578,7 +693,16 @@ auto Socket::post_select_listen(Select_sockets& select_sockets) -> std::optional
             // TODO check if already added
             // TODO set buffer sizes
             log_socket->info("Server accept(): new connection");
-            return Socket{accept_res, address};
+            Socket client_socket{accept_res, address};
+            const bool non_block_ok = set_socket_option(accept_res, Socket_option::NonBlocking, true);
+            if (!non_block_ok) {
+                return {};
+            }
+            const bool no_sigpipe_ok = set_socket_option(accept_res, Socket_option::NoSigPipe, true);
+            if (!no_sigpipe_ok) {
+                return {};
+            }
+            return client_socket;
         }
     }
     return {};
@@ -3,9 +3,11 @@
 #include "erhe_net/ring_buffer.hpp"
 #include "erhe_net/net_os.hpp"
 
+#include <deque>
 #include <functional>
 #include <memory>
 #include <optional>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -15,6 +17,21 @@ using Receive_handler = std::function<void(const uint8_t* data, std::size_t leng
 
 class Select_sockets;
 
+// A complete packet (header + payload) that can be queued to any number of
+// sockets. Server::broadcast() frames the message once into a Packet_buffer
+// and every client queues a reference to it instead of copying the payload
+// into its own send ring buffer.
+class Packet_buffer
+{
+public:
+    Packet_buffer(const char* data, std::size_t length);
+
+    [[nodiscard]] auto get_bytes() const -> std::span<const uint8_t> { return m_bytes; }
+
+private:
+    std::vector<uint8_t> m_bytes;
+};
+
 class Socket
 {
 public:
@@ -38,13 +55,14 @@ public:
     [[nodiscard]] auto get_socket          () const -> SOCKET                { return m_socket; }
     [[nodiscard]] auto get_sockaddr_in     () const -> const sockaddr_in&    { return m_address_in; }
     [[nodiscard]] auto get_address_string  () const -> const std::string&    { return m_address; }
-    [[nodiscard]] auto get_send_buffer_size() const -> size_t                { return m_send_buffer ? m_send_buffer->size() : 0; }
+    [[nodiscard]] auto get_send_buffer_size() const -> size_t                { return m_send_queue_byte_count; }
     auto send                (const char* data, int length) -> bool;
+    auto send                (const std::shared_ptr<const Packet_buffer>& packet) -> bool;
     auto send_pending        () -> bool;
     auto recv                () -> bool;
     auto get_receive_buffer  () -> Ring_buffer* { return m_receive_buffer.get(); }
     void close               ();
-    auto has_pending_writes  () -> bool         { return m_send_buffer ? !m_send_buffer->empty() : false; }
+    auto has_pending_writes  () -> bool         { return !m_send_queue.empty(); }
 
     void pre_select           (Select_sockets& select_sockets);
     auto post_select_send_recv(Select_sockets& select_sockets) -> bool;
@@ -55,7 +73,20 @@ public:
     auto bind   (const char* address, int port) -> bool; // for server
 
 private:
+    // Queued outgoing bytes, in send order: either a run of bytes in
+    // m_send_buffer (packet == nullptr) or the unsent tail of a shared packet.
+    class Send_segment
+    {
+    public:
+        std::shared_ptr<const Packet_buffer> packet;
+        std::size_t                          offset    {0}; // into packet bytes
+        std::size_t                          byte_count{0}; // not yet sent
+    };
+
     auto connect              () -> bool;
+    auto reserve_send_space   (std::size_t byte_count) -> bool;
+    void queue_send_buffer    (std::size_t byte_count);
+    void consume_sent         (std::size_t byte_count);
     void set_state            (State state);
     void on_state_changed     (State old_state, State new_state);
     auto receive_packet_length() -> uint32_t;
@@ -66,6 +97,8 @@ private:
     std::string                  m_address;
     State                        m_state     {State::CLOSED};
     std::unique_ptr<Ring_buffer> m_send_buffer;
+    std::deque<Send_segment>     m_send_queue;
+    std::size_t                  m_send_queue_byte_count{0};
     std::unique_ptr<Ring_buffer> m_receive_buffer;
     Receive_handler              m_receive_handler;
 };
@@ -0,0 +1,25 @@
+#include "erhe_net/net_log.hpp"
+#include "erhe_net/net_os.hpp"
+
+#include <gtest/gtest.h>
+#include <spdlog/spdlog.h>
+
+void initialize_test_logging()
+{
+    // Sockets log every connection and message at info level
+    const std::shared_ptr<spdlog::logger> logger = spdlog::default_logger();
+    logger->set_level(spdlog::level::warn);
+
+    erhe::net::log_net    = logger;
+    erhe::net::log_socket = logger;
+    erhe::net::log_client = logger;
+    erhe::net::log_server = logger;
+}
+
+int main(int argc, char** argv)
+{
+    initialize_test_logging();
+    erhe::net::initialize_net();
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
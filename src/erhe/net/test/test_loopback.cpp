@@ -0,0 +1,318 @@
+// Server and clients over TCP loopback, polled from the test thread:
+// broadcasts reach every client in order, ring buffer and shared packet
+// sends on one socket keep their order across ring buffer wrap around, and
+// descriptors of disconnected clients can be reused by new ones.
+
+#include "erhe_benchmark/benchmark.hpp"
+#include "erhe_net/client.hpp"
+#include "erhe_net/select_sockets.hpp"
+#include "erhe_net/server.hpp"
+#include "erhe_net/socket.hpp"
+
+#include <fmt/format.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+using erhe::net::Client;
+using erhe::net::Packet_buffer;
+using erhe::net::Select_sockets;
+using erhe::net::Server;
+using erhe::net::Socket;
+
+constexpr const char* c_address = "127.0.0.1";
+
+// Binds to the first free port of a fixed range; returns 0 if none was free
+auto listen_on_free_port(Server& server) -> int
+{
+    for (int port = 47100; port < 47200; ++port) {
+        if (server.listen(c_address, port)) {
+            return port;
+        }
+        server.disconnect();
+    }
+    return 0;
+}
+
+auto make_payload(const std::size_t index, const std::size_t length) -> std::string
+{
+    std::string payload = fmt::format("{}:", index);
+    payload.reserve(length);
+    while (payload.size() < length) {
+        payload.push_back(static_cast<char>('a' + (payload.size() + index) % 26));
+    }
+    return payload;
+}
+
+class Loopback
+{
+public:
+    explicit Loopback(const std::size_t client_count, const bool keep_payloads = true)
+        : keep_payloads{keep_payloads}
+    {
+        server.set_receive_handler(
+            [this](const uint8_t* data, const std::size_t length) {
+                server_received.emplace_back(reinterpret_cast<const char*>(data), length);
+            }
+        );
+        port = listen_on_free_port(server);
+        received.resize(client_count);
+        received_count.resize(client_count, 0);
+        clients.reserve(client_count);
+        for (std::size_t i = 0; i < client_count; ++i) {
+            add_client(i);
+        }
+    }
+
+    void add_client(const std::size_t index)
+    {
+        if (index == clients.size()) {
+            clients.emplace_back();
+        }
+        Client& client = clients[index];
+        client.set_receive_handler(
+            [this, index](const uint8_t* data, const std::size_t length) {
+                if (keep_payloads) {
+                    received[index].emplace_back(reinterpret_cast<const char*>(data), length);
+                }
+                ++received_count[index];
+                received_byte_count += length;
+            }
+        );
+        client.connect(c_address, port);
+    }
+
+    void poll_once()
+    {
+        server.poll(0);
+        for (Client& client : clients) {
+            client.poll(0);
+        }
+    }
+
+    auto pump(const std::function<bool()>& done) -> bool
+    {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{30};
+        while (!done()) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                return false;
+            }
+            poll_once();
+        }
+        return true;
+    }
+
+    auto wait_connected() -> bool
+    {
+        return pump(
+            [this]() {
+                if (server.get_client_count() != clients.size()) {
+                    return false;
+                }
+                for (Client& client : clients) {
+                    if (client.get_state() != Socket::State::CONNECTED) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+        );
+    }
+
+    auto wait_received(const std::size_t message_count) -> bool
+    {
+        return pump(
+            [this, message_count]() {
+                for (const std::size_t count : received_count) {
+                    if (count < message_count) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+        );
+    }
+
+    Server                                server;
+    std::vector<Client>                   clients;
+    std::vector<std::vector<std::string>> received;
+    std::vector<std::size_t>              received_count;
+    std::vector<std::string>              server_received;
+    std::size_t                           received_byte_count{0};
+    bool                                  keep_payloads{true};
+    int                                   port{0};
+};
+
+} // anonymous namespace
+
+TEST(Loopback, broadcast_reaches_every_client_in_order)
+{
+    constexpr std::size_t client_count  = 64;
+    constexpr std::size_t message_count = 200;
+
+    Loopback loopback{client_count};
+    ASSERT_NE(loopback.port, 0);
+    ASSERT_TRUE(loopback.wait_connected());
+
+    std::vector<std::string> sent;
+    for (std::size_t i = 0; i < message_count; ++i) {
+        sent.push_back(make_payload(i, 1 + (i * 997) % 9000));
+        EXPECT_TRUE(loopback.server.broadcast(sent.back()));
+        if ((i % 16) == 15) {
+            loopback.poll_once();
+        }
+    }
+    ASSERT_TRUE(loopback.wait_received(message_count));
+
+    for (std::size_t client = 0; client < client_count; ++client) {
+        ASSERT_EQ(loopback.received[client].size(), message_count);
+        for (std::size_t i = 0; i < message_count; ++i) {
+            EXPECT_EQ(loopback.received[client][i], sent[i]) << "client " << client << " message " << i;
+        }
+    }
+}
+
+// Alternates ring buffer sends and shared packet sends on a single socket,
+// pushing several times the 4 MB ring buffer capacity through it so that
+// gathered sends cross the ring buffer wrap around.
+TEST(Loopback, ring_and_shared_sends_keep_order)
+{
+    constexpr std::size_t message_count    = 400;
+    constexpr std::size_t queue_high_water = 2 * 1024 * 1024;
+
+    Loopback loopback{0};
+    ASSERT_NE(loopback.port, 0);
+
+    Socket         socket;
+    Select_sockets select_sockets;
+    const auto poll_socket = [&]() {
+        loopback.server.poll(0);
+        select_sockets.reset();
+        socket.pre_select(select_sockets);
+        if (select_sockets.select(0) <= 0) {
+            return;
+        }
+        if (socket.get_state() == Socket::State::CLIENT_CONNECTING) {
+            socket.post_select_connect(select_sockets);
+        } else if (socket.get_state() == Socket::State::CONNECTED) {
+            socket.post_select_send_recv(select_sockets);
+        }
+    };
+
+    ASSERT_TRUE(socket.connect(c_address, loopback.port));
+    ASSERT_TRUE(
+        loopback.pump(
+            [&]() {
+                poll_socket();
+                return (socket.get_state() == Socket::State::CONNECTED) && (loopback.server.get_client_count() == 1);
+            }
+        )
+    );
+
+    std::vector<std::string> sent;
+    for (std::size_t i = 0; i < message_count; ++i) {
+        ASSERT_TRUE(loopback.pump([&]() { poll_socket(); return socket.get_send_buffer_size() < queue_high_water; }));
+        sent.push_back(make_payload(i, 1 + (i * 7919) % 40000));
+        if ((i % 3) == 2) {
+            auto packet = std::make_shared<const Packet_buffer>(sent.back().data(), sent.back().size());
+            EXPECT_TRUE(socket.send(packet));
+        } else {
+            EXPECT_TRUE(socket.send(sent.back().data(), static_cast<int>(sent.back().size())));
+        }
+    }
+    ASSERT_TRUE(loopback.pump([&]() { poll_socket(); return loopback.server_received.size() == message_count; }));
+    EXPECT_FALSE(socket.has_pending_writes());
+    EXPECT_EQ(socket.get_send_buffer_size(), 0u);
+
+    for (std::size_t i = 0; i < message_count; ++i) {
+        EXPECT_EQ(loopback.server_received[i], sent[i]) << "message " << i;
+    }
+}
+
+// Closed client sockets are dropped from the server poller before their
+// descriptors are handed out again by accept().
+TEST(Loopback, reconnected_clients_receive_broadcasts)
+{
+    constexpr std::size_t client_count = 8;
+
+    Loopback loopback{client_count};
+    ASSERT_NE(loopback.port, 0);
+    ASSERT_TRUE(loopback.wait_connected());
+
+    for (int round = 0; round < 3; ++round) {
+        for (std::size_t i = 0; i < client_count; i += 2) {
+            loopback.clients[i].disconnect();
+        }
+        ASSERT_TRUE(loopback.pump([&]() { return loopback.server.get_client_count() == client_count / 2; }));
+        for (std::size_t i = 0; i < client_count; i += 2) {
+            loopback.add_client(i);
+        }
+        ASSERT_TRUE(loopback.wait_connected());
+
+        for (std::size_t i = 0; i < client_count; ++i) {
+            loopback.received[i].clear();
+            loopback.received_count[i] = 0;
+        }
+        const std::string message = make_payload(round, 100);
+        EXPECT_TRUE(loopback.server.broadcast(message));
+        ASSERT_TRUE(loopback.wait_received(1));
+        for (std::size_t i = 0; i < client_count; ++i) {
+            ASSERT_EQ(loopback.received[i].size(), 1u) << "client " << i;
+            EXPECT_EQ(loopback.received[i][0], message);
+        }
+    }
+}
+
+// Broadcast throughput to hundreds of clients from one polling thread, for
+// small and large messages; reports delivered bytes (summed over clients)
+// per second.
+ERHE_BENCHMARK(Loopback, loopback_throughput)
+{
+    constexpr std::size_t client_count = 256;
+
+    Loopback loopback{client_count, false};
+    ASSERT_NE(loopback.port, 0);
+    ASSERT_TRUE(loopback.wait_connected());
+
+    for (const std::size_t message_size : {std::size_t{256}, std::size_t{4096}, std::size_t{65536}}) {
+        // Batches stay well within the per-client send queue capacity
+        const std::size_t batch_size    = (std::min)(std::size_t{256}, (2 * 1024 * 1024) / message_size);
+        const std::size_t message_count = (4 * 1024 * 1024) / message_size;
+        const std::string message       = make_payload(0, message_size);
+
+        std::fill(loopback.received_count.begin(), loopback.received_count.end(), 0);
+        loopback.received_byte_count = 0;
+
+        const erhe::benchmark::Stopwatch stopwatch;
+        std::size_t broadcast_count = 0;
+        while (broadcast_count < message_count) {
+            const std::size_t batch_end = (std::min)(message_count, broadcast_count + batch_size);
+            for (; broadcast_count < batch_end; ++broadcast_count) {
+                ASSERT_TRUE(loopback.server.broadcast(message));
+            }
+            ASSERT_TRUE(loopback.wait_received(broadcast_count));
+        }
+        const double seconds = stopwatch.elapsed_ms() / 1000.0;
+
+        const double megabytes = static_cast<double>(loopback.received_byte_count) / (1024.0 * 1024.0);
+        fmt::print(
+            "{} clients, {:6} byte messages x {:6}: {:8.1f} MB delivered in {:6.3f} s, {:8.1f} MB/s, {:10.0f} messages/s\n",
+            client_count,
+            message_size,
+            message_count,
+            megabytes,
+            seconds,
+            megabytes / seconds,
+            static_cast<double>(message_count * client_count) / seconds
+        );
+    }
+}
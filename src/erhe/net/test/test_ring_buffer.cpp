@@ -0,0 +1,114 @@
+#include "erhe_net/ring_buffer.hpp"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <span>
+
+namespace {
+
+auto make_bytes(const uint8_t first, const std::size_t count) -> std::array<uint8_t, 16>
+{
+    std::array<uint8_t, 16> bytes{};
+    for (std::size_t i = 0; i < count; ++i) {
+        bytes[i] = static_cast<uint8_t>(first + i);
+    }
+    return bytes;
+}
+
+} // anonymous namespace
+
+TEST(RingBuffer, begin_consume_spans_empty)
+{
+    erhe::net::Ring_buffer ring{16};
+    std::span<const uint8_t> before_wrap;
+    std::span<const uint8_t> after_wrap;
+    ring.begin_consume(before_wrap, after_wrap);
+    EXPECT_TRUE(before_wrap.empty());
+    EXPECT_TRUE(after_wrap.empty());
+}
+
+TEST(RingBuffer, begin_consume_spans_contiguous)
+{
+    erhe::net::Ring_buffer ring{16};
+    const auto bytes = make_bytes(1, 10);
+    ASSERT_EQ(ring.write(bytes.data(), 10), 10u);
+
+    std::span<const uint8_t> before_wrap;
+    std::span<const uint8_t> after_wrap;
+    ring.begin_consume(before_wrap, after_wrap);
+    ASSERT_EQ(before_wrap.size(), 10u);
+    EXPECT_TRUE(after_wrap.empty());
+    for (std::size_t i = 0; i < 10; ++i) {
+        EXPECT_EQ(before_wrap[i], bytes[i]);
+    }
+
+    // Spans do not consume
+    EXPECT_EQ(ring.size(), 10u);
+}
+
+TEST(RingBuffer, begin_consume_spans_wrapped_and_full)
+{
+    erhe::net::Ring_buffer ring{16};
+    const auto first = make_bytes(0, 12);
+    ASSERT_EQ(ring.write(first.data(), 12), 12u);
+    ring.end_consume(10);
+
+    // 2 bytes left at offset 10; 14 more fill the buffer, wrapping after 4
+    const auto second = make_bytes(100, 14);
+    ASSERT_EQ(ring.write(second.data(), 14), 14u);
+    ASSERT_TRUE(ring.full());
+
+    std::span<const uint8_t> before_wrap;
+    std::span<const uint8_t> after_wrap;
+    ring.begin_consume(before_wrap, after_wrap);
+    ASSERT_EQ(before_wrap.size(), 6u);
+    ASSERT_EQ(after_wrap.size(), 10u);
+    EXPECT_EQ(before_wrap[0], 10);
+    EXPECT_EQ(before_wrap[1], 11);
+    for (std::size_t i = 0; i < 4; ++i) {
+        EXPECT_EQ(before_wrap[2 + i], second[i]);
+    }
+    for (std::size_t i = 0; i < 10; ++i) {
+        EXPECT_EQ(after_wrap[i], second[4 + i]);
+    }
+
+    ring.end_consume(before_wrap.size());
+    ring.begin_consume(before_wrap, after_wrap);
+    EXPECT_EQ(before_wrap.size(), 10u);
+    EXPECT_TRUE(after_wrap.empty());
+    EXPECT_EQ(before_wrap[0], second[4]);
+}
+
+TEST(RingBuffer, rotate_moves_readable_bytes_to_start)
+{
+    erhe::net::Ring_buffer ring{16};
+    const auto first = make_bytes(0, 12);
+    ASSERT_EQ(ring.write(first.data(), 12), 12u);
+    ring.end_consume(10);
+    const auto second = make_bytes(100, 8);
+    ASSERT_EQ(ring.write(second.data(), 8), 8u);
+
+    ring.rotate();
+    ASSERT_EQ(ring.size(), 10u);
+    std::span<const uint8_t> before_wrap;
+    std::span<const uint8_t> after_wrap;
+    ring.begin_consume(before_wrap, after_wrap);
+    ASSERT_EQ(before_wrap.size(), 10u);
+    EXPECT_TRUE(after_wrap.empty());
+    EXPECT_EQ(before_wrap[0], 10);
+    EXPECT_EQ(before_wrap[1], 11);
+    for (std::size_t i = 0; i < 8; ++i) {
+        EXPECT_EQ(before_wrap[2 + i], second[i]);
+    }
+
+    // Writes continue after the rotated bytes
+    const auto third = make_bytes(200, 6);
+    ASSERT_EQ(ring.write(third.data(), 6), 6u);
+    EXPECT_TRUE(ring.full());
+    uint8_t last[16]{};
+    ASSERT_EQ(ring.read(last, 16), 16u);
+    EXPECT_EQ(last[10], 200);
+    EXPECT_EQ(last[15], 205);
+}
@@ -0,0 +1,96 @@
+#include "erhe_physics/jolt/jolt_job_system.hpp"
+#include "erhe_scheduler/scheduler.hpp"
+#include "erhe_profile/profile.hpp"
+
+#include <taskflow/taskflow.hpp>
+
+#include <chrono>
+#include <thread>
+
+namespace erhe::physics {
+
+Jolt_job_system::Jolt_job_system(erhe::scheduler::Scheduler& scheduler, const JPH::uint max_jobs, const JPH::uint max_barriers)
+    : JPH::JobSystemWithBarrier{max_barriers}
+    , m_scheduler              {scheduler}
+{
+    m_jobs.Init(max_jobs, max_jobs);
+}
+
+Jolt_job_system::~Jolt_job_system() noexcept
+{
+    // PhysicsSystem::Update() waits for all jobs, but a job run by the
+    // barrier wait can still have its executor task pending.
+    while (m_in_flight_count.load(std::memory_order_acquire) != 0) {
+        std::this_thread::yield();
+    }
+}
+
+auto Jolt_job_system::GetMaxConcurrency() const -> int
+{
+    // Workers plus the thread waiting for the barrier
+    return static_cast<int>(m_scheduler.get_worker_count()) + 1;
+}
+
+auto Jolt_job_system::CreateJob(
+    const char*         inName,
+    const JPH::ColorArg inColor,
+    const JobFunction&  inJobFunction,
+    const JPH::uint32   inNumDependencies
+) -> JobHandle
+{
+    ERHE_PROFILE_FUNCTION();
+
+    erhe::scheduler::Scheduler* const scheduler = &m_scheduler;
+    const JobFunction accounted_job_function = [scheduler, inJobFunction]() {
+        const erhe::scheduler::Lane_timer timer{scheduler, erhe::scheduler::Lane::e_frame};
+        inJobFunction();
+    };
+
+    // The free list is sized for a full physics step (cMaxPhysicsJobs).
+    // Like JobSystemThreadPool, wait for a job to be freed when it is full.
+    JPH::uint32 index = 0;
+    for (;;) {
+        index = m_jobs.ConstructObject(inName, inColor, this, accounted_job_function, inNumDependencies);
+        if (index != JPH::FixedSizeFreeList<Job>::cInvalidObjectIndex) {
+            break;
+        }
+        JPH_ASSERT(false, "No jobs available!");
+        std::this_thread::sleep_for(std::chrono::microseconds{100});
+    }
+    Job* const job = &m_jobs.Get(index);
+
+    // The handle holds a reference: the job may complete as soon as it is
+    // queued.
+    JobHandle handle{job};
+    if (inNumDependencies == 0) {
+        QueueJob(job);
+    }
+    return handle;
+}
+
+void Jolt_job_system::QueueJob(Job* const inJob)
+{
+    inJob->AddRef();
+    m_in_flight_count.fetch_add(1, std::memory_order_relaxed);
+    m_scheduler.get_executor().silent_async(
+        [this, inJob]() {
+            inJob->Execute(); // no-op when a barrier wait already ran it
+            inJob->Release();
+            m_in_flight_count.fetch_sub(1, std::memory_order_release);
+        }
+    );
+}
+
+void Jolt_job_system::QueueJobs(Job** const inJobs, const JPH::uint inNumJobs)
+{
+    for (JPH::uint i = 0; i < inNumJobs; ++i) {
+        QueueJob(inJobs[i]);
+    }
+}
+
+void Jolt_job_system::FreeJob(Job* const inJob)
+{
+    m_jobs.DestructObject(inJob);
+}
+
+} // namespace erhe::physics
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <Jolt/Jolt.h>
+#include <Jolt/Core/FixedSizeFreeList.h>
+#include <Jolt/Core/JobSystemWithBarrier.h>
+
+#include <atomic>
+
+namespace erhe::scheduler {
+    class Scheduler;
+}
+
+namespace erhe::physics {
+
+// JPH::JobSystem on the application's shared worker pool
+// (erhe::physics::set_scheduler()), replacing the private
+// JPH::JobSystemThreadPool a world otherwise starts.
+//
+// Jobs come from a fixed size free list like in JobSystemThreadPool, and a
+// queued job becomes one tf::Executor task. The thread that waits for a
+// barrier (the caller of PhysicsSystem::Update()) also runs ready jobs
+// itself, so a step makes progress even while every worker is busy with
+// other lanes; a task whose job already ran that way only drops its
+// reference. Job run time is accounted to erhe::scheduler::Lane::e_frame
+// wherever the job runs.
+class Jolt_job_system : public JPH::JobSystemWithBarrier
+{
+public:
+    Jolt_job_system(erhe::scheduler::Scheduler& scheduler, JPH::uint max_jobs, JPH::uint max_barriers);
+    ~Jolt_job_system() noexcept override;
+
+    // Implements JPH::JobSystem
+    auto GetMaxConcurrency() const -> int override;
+    auto CreateJob(
+        const char*        inName,
+        JPH::ColorArg      inColor,
+        const JobFunction& inJobFunction,
+        JPH::uint32        inNumDependencies = 0
+    ) -> JobHandle override;
+
+protected:
+    void QueueJob (Job* inJob)                        override;
+    void QueueJobs(Job** inJobs, JPH::uint inNumJobs) override;
+    void FreeJob  (Job* inJob)                        override;
+
+private:
+    erhe::scheduler::Scheduler&   m_scheduler;
+    JPH::FixedSizeFreeList<Job>   m_jobs;
+    // Executor tasks that still reference a job; the free list must
+    // outlive them.
+    std::atomic<int>              m_in_flight_count{0};
+};
+
+} // namespace erhe::physics
@@ -2,15 +2,18 @@
 #include "erhe_log/log_glm.hpp"
 #include "erhe_physics/collision_filter.hpp"
 #include "erhe_physics/jolt/jolt_constraint.hpp"
+#include "erhe_physics/jolt/jolt_job_system.hpp"
 #include "erhe_physics/jolt/jolt_rigid_body.hpp"
 #include "erhe_physics/jolt/glm_conversions.hpp"
 #include "erhe_physics/idebug_draw.hpp"
 #include "erhe_physics/physics_log.hpp"
+#include "erhe_physics/physics_scheduler.hpp"
 #include "erhe_renderer/jolt_debug_renderer.hpp"
 #include "erhe_verify/verify.hpp"
 
 #include <Jolt/RegisterTypes.h>
 #include <Jolt/Core/Factory.h>
+#include <Jolt/Core/JobSystemThreadPool.h>
 #include <Jolt/Physics/Body/Body.h>
 #include <Jolt/Physics/StateRecorderImpl.h>
 #include <Jolt/Physics/Collision/CollideShape.h>
@@ -420,9 +423,14 @@ void initialize_physics_system()
 
 Jolt_world::Jolt_world()
     : m_temp_allocator{10 * 1024 * 1024}
-    , m_job_system    {JPH::cMaxPhysicsJobs, JPH::cMaxPhysicsBarriers, 10}
     , m_group_filter  {new Jolt_group_filter()}
 {
+    erhe::scheduler::Scheduler* const scheduler = get_scheduler();
+    if (scheduler != nullptr) {
+        m_job_system = std::make_unique<Jolt_job_system>(*scheduler, JPH::cMaxPhysicsJobs, JPH::cMaxPhysicsBarriers);
+    } else {
+        m_job_system = std::make_unique<JPH::JobSystemThreadPool>(JPH::cMaxPhysicsJobs, JPH::cMaxPhysicsBarriers, 10);
+    }
     //m_debug_renderer              = std::make_unique<Jolt_debug_renderer             >();
     m_broad_phase_layer_interface = std::make_unique<Broad_phase_layer_interface_impl>();
     m_physics_system.Init(
@@ -462,7 +470,7 @@ void Jolt_world::update_fixed_step(const double dt)
         cCollisionSteps,
         //cIntegrationSubSteps,
         &m_temp_allocator,
-        &m_job_system
+        m_job_system.get()
     );
 
     dispatch_activation_events();
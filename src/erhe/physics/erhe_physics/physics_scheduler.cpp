@@ -0,0 +1,21 @@
+#include "erhe_physics/physics_scheduler.hpp"
+
+namespace erhe::physics {
+
+namespace {
+
+erhe::scheduler::Scheduler* g_scheduler{nullptr};
+
+}
+
+void set_scheduler(erhe::scheduler::Scheduler* scheduler)
+{
+    g_scheduler = scheduler;
+}
+
+auto get_scheduler() -> erhe::scheduler::Scheduler*
+{
+    return g_scheduler;
+}
+
+} // namespace erhe::physics
@@ -0,0 +1,18 @@
+#pragma once
+
+namespace erhe::scheduler {
+    class Scheduler;
+}
+
+namespace erhe::physics {
+
+// Shared worker pool for physics jobs. The application injects it at
+// startup, before creating worlds. Worlds created while one is set run
+// their simulation jobs on it (Jolt_job_system) instead of starting a
+// private thread pool; worlds created without one keep the private pool,
+// which keeps tests and headless tools self-contained.
+void set_scheduler(erhe::scheduler::Scheduler* scheduler);
+
+[[nodiscard]] auto get_scheduler() -> erhe::scheduler::Scheduler*;
+
+} // namespace erhe::physics
@@ -0,0 +1,151 @@
+// Jolt_job_system: jobs run on the scheduler's executor in dependency
+// order, a barrier wait completes a step even while every worker is busy
+// with other work, and job run time is accounted to Lane::e_frame.
+
+#include "erhe_physics/jolt/jolt_job_system.hpp"
+#include "erhe_scheduler/scheduler.hpp"
+
+#include <Jolt/Jolt.h>
+#include <Jolt/Core/Memory.h>
+
+#include <gtest/gtest.h>
+
+#include <taskflow/taskflow.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using erhe::physics::Jolt_job_system;
+using erhe::scheduler::Lane;
+using erhe::scheduler::Scheduler;
+using Job_handle = JPH::JobSystem::JobHandle;
+
+class Jolt_allocator
+{
+public:
+    Jolt_allocator()
+    {
+        JPH::RegisterDefaultAllocator();
+    }
+};
+
+const Jolt_allocator s_jolt_allocator;
+
+}
+
+TEST(jolt_job_system, dependent_jobs_run_after_their_dependencies)
+{
+    tf::Executor executor{4};
+    Scheduler    scheduler{executor};
+    {
+        Jolt_job_system job_system{scheduler, 256, 4};
+        EXPECT_EQ(job_system.GetMaxConcurrency(), 5);
+
+        // A fan out of 64 jobs, each releasing one dependency of a final
+        // job, the way PhysicsSystem::Update() chains its step jobs
+        constexpr int fan_out = 64;
+        std::atomic<int> finished_count{0};
+        std::atomic<int> finished_before_final{-1};
+        Job_handle final_job = job_system.CreateJob(
+            "final",
+            JPH::Color::sGrey,
+            [&]() { finished_before_final.store(finished_count.load()); },
+            fan_out
+        );
+
+        JPH::JobSystem::Barrier* barrier = job_system.CreateBarrier();
+        barrier->AddJob(final_job);
+        std::vector<Job_handle> jobs;
+        for (int i = 0; i < fan_out; ++i) {
+            jobs.push_back(
+                job_system.CreateJob(
+                    "fan out",
+                    JPH::Color::sGrey,
+                    [&finished_count, final_job]() mutable {
+                        finished_count.fetch_add(1);
+                        final_job.RemoveDependency();
+                    }
+                )
+            );
+        }
+        barrier->AddJobs(jobs.data(), static_cast<JPH::uint>(jobs.size()));
+        job_system.WaitForJobs(barrier);
+        job_system.DestroyBarrier(barrier);
+
+        EXPECT_EQ(finished_count.load(), fan_out);
+        EXPECT_EQ(finished_before_final.load(), fan_out);
+    }
+    executor.wait_for_all();
+}
+
+TEST(jolt_job_system, barrier_wait_runs_jobs_while_workers_are_busy)
+{
+    // The only worker is held by another lane until the step is done; the
+    // waiting thread has to run every job itself
+    tf::Executor executor{1};
+    Scheduler    scheduler{executor};
+    std::atomic<bool> release_worker{false};
+    std::atomic<bool> worker_held   {false};
+    executor.silent_async(
+        [&]() {
+            worker_held.store(true);
+            while (!release_worker.load()) {
+                std::this_thread::yield();
+            }
+        }
+    );
+    while (!worker_held.load()) {
+        std::this_thread::yield();
+    }
+
+    std::atomic<int> finished_count{0};
+    {
+        Jolt_job_system job_system{scheduler, 64, 1};
+        JPH::JobSystem::Barrier* barrier = job_system.CreateBarrier();
+        for (int i = 0; i < 16; ++i) {
+            Job_handle job = job_system.CreateJob("job", JPH::Color::sGrey, [&finished_count]() { finished_count.fetch_add(1); });
+            barrier->AddJob(job);
+        }
+        job_system.WaitForJobs(barrier);
+        job_system.DestroyBarrier(barrier);
+        EXPECT_EQ(finished_count.load(), 16);
+
+        // The executor tasks of jobs already run drop their references once
+        // the worker is free; the job system outlives them
+        release_worker.store(true);
+    }
+    executor.wait_for_all();
+    EXPECT_EQ(finished_count.load(), 16);
+}
+
+TEST(jolt_job_system, job_time_is_accounted_to_frame_lane)
+{
+    tf::Executor executor{2};
+    Scheduler    scheduler{executor};
+    scheduler.end_frame();
+    {
+        Jolt_job_system job_system{scheduler, 64, 1};
+        JPH::JobSystem::Barrier* barrier = job_system.CreateBarrier();
+        for (int i = 0; i < 4; ++i) {
+            Job_handle job = job_system.CreateJob(
+                "sleep",
+                JPH::Color::sGrey,
+                []() { std::this_thread::sleep_for(std::chrono::milliseconds{1}); }
+            );
+            barrier->AddJob(job);
+        }
+        job_system.WaitForJobs(barrier);
+        job_system.DestroyBarrier(barrier);
+    }
+    executor.wait_for_all();
+    scheduler.end_frame();
+
+    const erhe::scheduler::Frame_statistics& statistics = scheduler.get_frame_statistics();
+    EXPECT_EQ(statistics.lanes[static_cast<std::size_t>(Lane::e_frame)].job_count, 4u);
+    EXPECT_GE(statistics.lanes[static_cast<std::size_t>(Lane::e_frame)].busy_ns, 4'000'000u);
+    EXPECT_EQ(statistics.lanes[static_cast<std::size_t>(Lane::e_background)].job_count, 0u);
+}
@@ -53,6 +53,9 @@ Buffer_mesh& Buffer_mesh::operator=(Buffer_mesh&& other)
         corner_point_indices           = other.corner_point_indices;
         polygon_centroid_indices       = other.polygon_centroid_indices;
         expanded_triangle_fill_indices = other.expanded_triangle_fill_indices;
+        triangle_fill_lods             = std::move(other.triangle_fill_lods);
+        triangle_fill_meshlet_indices  = other.triangle_fill_meshlet_indices;
+        triangle_fill_meshlets         = std::move(other.triangle_fill_meshlets);
         vertex_buffer_ranges           = std::move(other.vertex_buffer_ranges);
         index_buffer_range             = other.index_buffer_range;
         expanded_vertex_buffer_ranges  = std::move(other.expanded_vertex_buffer_ranges);
@@ -4,6 +4,7 @@
 #include "erhe_primitive/buffer_range.hpp"
 #include "erhe_primitive/index_range.hpp"
 #include "erhe_primitive/enums.hpp"
+#include "erhe_primitive/meshlet.hpp"
 #include "erhe_math/aabb.hpp"
 #include "erhe_math/sphere.hpp"
 
@@ -27,6 +28,16 @@ namespace erhe::primitive {
 // else is acquired while it is held.
 [[nodiscard]] auto buffer_mesh_allocation_mutex() -> std::mutex&;
 
+// One coarser level of detail of Buffer_mesh::triangle_fill_indices: an
+// index range over the same vertices (same base_vertex()), so switching
+// level only changes first_index / index_count of the draw.
+class Buffer_mesh_lod
+{
+public:
+    Index_range triangle_fill_indices{};
+    float       error                {0.0f}; // object space geometric error, see erhe::geometry::operation::Lod_level
+};
+
 class Buffer_mesh
 {
 public:
@@ -68,6 +79,16 @@ public:
     // Sequential index range (values 0..3N-1) into expanded_vertex_buffer_ranges
     // for the solid-wireframe fill draw. Empty when the expanded fill was not built.
     Index_range               expanded_triangle_fill_indices{};
+    // Levels of detail of triangle_fill_indices, finest first, errors
+    // increasing. Empty when Primitive_types::fill_triangle_lods was not set
+    // or the mesh did not simplify.
+    std::vector<Buffer_mesh_lod> triangle_fill_lods{};
+    // The fill triangles reordered meshlet by meshlet, over the same
+    // vertices, and the meshlets as sub-ranges of it. Both empty when
+    // Primitive_types::fill_triangle_meshlets was not set or the mesh is
+    // below Meshlet_settings::min_triangle_count.
+    Index_range                  triangle_fill_meshlet_indices{};
+    std::vector<Buffer_meshlet>  triangle_fill_meshlets{};
 
     std::vector<Buffer_range> vertex_buffer_ranges{}; // per stream
     Buffer_range              index_buffer_range  {};
@@ -1,5 +1,4 @@
 #include "erhe_primitive/buffer_sink.hpp"
-#include "erhe_primitive/buffer_writer.hpp"
 #include "erhe_primitive/primitive_log.hpp"
 #include "erhe_buffer/ibuffer.hpp"
 #include "erhe_verify/verify.hpp"
@@ -12,6 +11,40 @@ Vertex_buffer_sink::~Vertex_buffer_sink() noexcept = default;
 
 Index_buffer_sink::~Index_buffer_sink() noexcept = default;
 
+auto make_heap_sink_write(const Buffer_range& buffer_range, const std::size_t byte_count) -> Buffer_sink_write
+{
+    Buffer_sink_write write{
+        .buffer_range = buffer_range,
+        .span         = {},
+        .heap_data    = std::vector<std::uint8_t>(byte_count, 0),
+        .sink_handle  = 0
+    };
+    write.span = write.heap_data;
+    return write;
+}
+
+auto Vertex_buffer_sink::begin_vertex_write(const Buffer_range& buffer_range, const std::size_t byte_count) -> Buffer_sink_write
+{
+    return make_heap_sink_write(buffer_range, byte_count);
+}
+
+void Vertex_buffer_sink::end_vertex_write(Buffer_sink_write&& write)
+{
+    ERHE_VERIFY(write.sink_handle == 0);
+    enqueue_vertex_data(write.buffer_range, std::move(write.heap_data));
+}
+
+auto Index_buffer_sink::begin_index_write(const Buffer_range& buffer_range, const std::size_t byte_count) -> Buffer_sink_write
+{
+    return make_heap_sink_write(buffer_range, byte_count);
+}
+
+void Index_buffer_sink::end_index_write(Buffer_sink_write&& write)
+{
+    ERHE_VERIFY(write.sink_handle == 0);
+    enqueue_index_data(write.buffer_range, std::move(write.heap_data));
+}
+
 Cpu_vertex_buffer_sink::Cpu_vertex_buffer_sink(std::initializer_list<erhe::buffer::Cpu_buffer*> vertex_buffers)
     : m_vertex_buffers{vertex_buffers}
 {
@@ -64,16 +97,6 @@ void Cpu_vertex_buffer_sink::enqueue_vertex_data(const Buffer_range& buffer_rang
     memcpy(offset_span.data(), data.data(), data.size());
 }
 
-void Cpu_vertex_buffer_sink::vertex_writer_ready(Vertex_buffer_writer& writer)
-{
-    std::lock_guard<ERHE_PROFILE_LOCKABLE_BASE(std::mutex)> lock{m_mutex};
-
-    auto        buffer_span = m_vertex_buffers.at(writer.stream)->get_span();
-    const auto& data        = writer.vertex_data;
-    auto        offset_span = buffer_span.subspan(writer.start_offset(), data.size());
-    memcpy(offset_span.data(), data.data(), data.size());
-}
-
 /////////////////////////////////////////////////////
 
 Cpu_index_buffer_sink::Cpu_index_buffer_sink(erhe::buffer::Cpu_buffer& index_buffer)
@@ -125,14 +148,4 @@ void Cpu_index_buffer_sink::enqueue_index_data(const Buffer_range& buffer_range,
     memcpy(offset_span.data(), data.data(), data.size());
 }
 
-void Cpu_index_buffer_sink::index_writer_ready(Index_buffer_writer& writer)
-{
-    std::lock_guard<ERHE_PROFILE_LOCKABLE_BASE(std::mutex)> lock{m_mutex};
-
-    auto        buffer_span = m_index_buffer.get_span();
-    const auto& data        = writer.index_data;
-    auto        offset_span = buffer_span.subspan(writer.start_offset(), data.size());
-    memcpy(offset_span.data(), data.data(), data.size());
-}
-
 } // namespace erhe::primitive
@@ -7,6 +7,7 @@
 
 #include <cstdint>
 #include <mutex>
+#include <span>
 #include <vector>
 
 namespace erhe::graphics {
@@ -30,6 +31,20 @@ public:
     erhe::buffer::Buffer_allocation allocation;
 };
 
+// Bytes being written for one buffer range, from begin_*_write() to
+// end_*_write(). The span is zero initialized and is where the producer
+// writes; it points either into heap_data or, for sinks that can do so,
+// directly into upload staging memory (sink_handle identifies that to the
+// sink). Either way the producer only sees the span.
+class Buffer_sink_write
+{
+public:
+    Buffer_range              buffer_range;
+    std::span<std::uint8_t>   span;
+    std::vector<std::uint8_t> heap_data;
+    std::uint64_t             sink_handle{0};
+};
+
 class Vertex_buffer_sink
 {
 public:
@@ -37,7 +52,13 @@ public:
 
     [[nodiscard]] virtual auto allocate_vertex_buffer_range(const erhe::dataformat::Vertex_stream& vertex_stream, std::size_t vertex_count) -> Buffer_sink_allocation = 0;
                   virtual void enqueue_vertex_data         (const Buffer_range& buffer_range, std::vector<uint8_t>&& data) = 0;
-                  virtual void vertex_writer_ready         (Vertex_buffer_writer& writer) = 0;
+
+    // Writers (Vertex_buffer_writer, triangle soup builds) fill buffer_range
+    // through begin / end instead of building a vector for
+    // enqueue_vertex_data(). The default writes to heap_data and passes it to
+    // enqueue_vertex_data().
+    [[nodiscard]] virtual auto begin_vertex_write(const Buffer_range& buffer_range, std::size_t byte_count) -> Buffer_sink_write;
+                  virtual void end_vertex_write  (Buffer_sink_write&& write);
 };
 
 class Index_buffer_sink
@@ -47,9 +68,15 @@ public:
 
     [[nodiscard]] virtual auto allocate_index_buffer_range(erhe::dataformat::Format index_format, std::size_t index_count) -> Buffer_sink_allocation = 0;
                   virtual void enqueue_index_data         (const Buffer_range& buffer_range, std::vector<uint8_t>&& data) = 0;
-                  virtual void index_writer_ready         (Index_buffer_writer& writer) = 0;
+
+    // See Vertex_buffer_sink::begin_vertex_write().
+    [[nodiscard]] virtual auto begin_index_write(const Buffer_range& buffer_range, std::size_t byte_count) -> Buffer_sink_write;
+                  virtual void end_index_write  (Buffer_sink_write&& write);
 };
 
+// Heap backed Buffer_sink_write, the default begin_*_write().
+[[nodiscard]] auto make_heap_sink_write(const Buffer_range& buffer_range, std::size_t byte_count) -> Buffer_sink_write;
+
 class Cpu_vertex_buffer_sink : public Vertex_buffer_sink
 {
 public:
@@ -57,7 +84,6 @@ public:
 
     auto allocate_vertex_buffer_range(const erhe::dataformat::Vertex_stream& vertex_stream, std::size_t vertex_count) -> Buffer_sink_allocation override;
     void enqueue_vertex_data         (const Buffer_range& buffer_range, std::vector<uint8_t>&& data) override;
-    void vertex_writer_ready         (Vertex_buffer_writer& writer)                                  override;
 
 private:
     mutable ERHE_PROFILE_MUTEX(std::mutex, m_mutex);
@@ -71,7 +97,6 @@ public:
 
     auto allocate_index_buffer_range(erhe::dataformat::Format index_format, std::size_t index_count) -> Buffer_sink_allocation override;
     void enqueue_index_data         (const Buffer_range& buffer_range, std::vector<uint8_t>&& data) override;
-    void index_writer_ready         (Index_buffer_writer&  writer)                                  override;
 
 private:
     mutable ERHE_PROFILE_MUTEX(std::mutex, m_mutex);
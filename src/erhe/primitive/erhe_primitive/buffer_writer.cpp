@@ -2,6 +2,7 @@
 #include "erhe_primitive/buffer_sink.hpp"
 #include "erhe_primitive/primitive_builder.hpp"
 #include "erhe_primitive/buffer_mesh.hpp"
+#include "erhe_dataformat/vertex_column.hpp"
 #include "erhe_geometry/geometry.hpp"
 #include "erhe_verify/verify.hpp"
 
@@ -509,8 +510,8 @@ Vertex_buffer_writer::Vertex_buffer_writer(
     , stride       {stride}
     , buffer_range {build_context.root.buffer_mesh.vertex_buffer_ranges[stream]}
 {
-    vertex_data.resize(buffer_range.count * buffer_range.element_size);
-    vertex_data_span = vertex_data;
+    vertex_write     = buffer_sink.begin_vertex_write(buffer_range, buffer_range.count * buffer_range.element_size);
+    vertex_data_span = vertex_write.span;
     ERHE_VERIFY(buffer_range.element_size == stride);
 }
 
@@ -527,14 +528,14 @@ Vertex_buffer_writer::Vertex_buffer_writer(
     , stride       {stride}
     , buffer_range {target_range}
 {
-    vertex_data.resize(buffer_range.count * buffer_range.element_size);
-    vertex_data_span = vertex_data;
+    vertex_write     = buffer_sink.begin_vertex_write(buffer_range, buffer_range.count * buffer_range.element_size);
+    vertex_data_span = vertex_write.span;
     ERHE_VERIFY(buffer_range.element_size == stride);
 }
 
 Vertex_buffer_writer::~Vertex_buffer_writer() noexcept
 {
-    buffer_sink.vertex_writer_ready(*this);
+    buffer_sink.end_vertex_write(std::move(vertex_write));
 }
 
 auto Vertex_buffer_writer::start_offset() -> std::size_t
@@ -552,8 +553,8 @@ Index_buffer_writer::Index_buffer_writer(Build_context& build_context, Index_buf
     const auto& buffer_mesh        = build_context.root.buffer_mesh;
     const auto& index_buffer_range = buffer_mesh.index_buffer_range;
     const auto& mesh_info          = build_context.root.mesh_info;
-    index_data.resize(index_buffer_range.count * index_type_size);
-    index_data_span = index_data;
+    index_write     = buffer_sink.begin_index_write(index_buffer_range, index_buffer_range.count * index_type_size);
+    index_data_span = index_write.span;
 
     const auto& primitive_types = build_context.root.build_info.primitive_types;
 
@@ -569,6 +570,20 @@ Index_buffer_writer::Index_buffer_writer(Build_context& build_context, Index_buf
             mesh_info.index_count_fill_triangles * index_type_size
         );
     }
+    if (!buffer_mesh.triangle_fill_lods.empty()) {
+        const Index_range& first = buffer_mesh.triangle_fill_lods.front().triangle_fill_indices;
+        const Index_range& last  = buffer_mesh.triangle_fill_lods.back ().triangle_fill_indices;
+        triangle_fill_lod_index_data_span = index_data_span.subspan(
+            first.first_index * index_type_size,
+            (last.first_index + last.index_count - first.first_index) * index_type_size
+        );
+    }
+    if (buffer_mesh.triangle_fill_meshlet_indices.index_count > 0) {
+        triangle_fill_meshlet_index_data_span = index_data_span.subspan(
+            buffer_mesh.triangle_fill_meshlet_indices.first_index * index_type_size,
+            buffer_mesh.triangle_fill_meshlet_indices.index_count * index_type_size
+        );
+    }
     if (primitive_types.fill_triangles_expanded && (buffer_mesh.expanded_triangle_fill_indices.index_count > 0)) {
         expanded_triangle_fill_index_data_span = index_data_span.subspan(
             buffer_mesh.expanded_triangle_fill_indices.first_index * index_type_size,
@@ -591,7 +606,7 @@ Index_buffer_writer::Index_buffer_writer(Build_context& build_context, Index_buf
 
 Index_buffer_writer::~Index_buffer_writer() noexcept
 {
-    buffer_sink.index_writer_ready(*this);
+    buffer_sink.end_index_write(std::move(index_write));
 }
 
 auto Index_buffer_writer::start_offset() -> std::size_t
@@ -740,6 +755,46 @@ void Vertex_buffer_writer::write(const Vertex_attribute_info& attribute, const g
     );
 }
 
+auto Vertex_buffer_writer::get_column_span(const Vertex_attribute_info& attribute, const std::size_t count) -> std::span<std::uint8_t>
+{
+    if (count == 0) {
+        return {};
+    }
+    return vertex_data_span.subspan(vertex_write_offset + attribute.offset, (count - 1) * stride + attribute.size);
+}
+
+void Vertex_buffer_writer::write_column(const Vertex_attribute_info& attribute, const std::span<const glm::vec2> values)
+{
+    const std::span<std::uint8_t> destination = get_column_span(attribute, values.size());
+    if (!erhe::dataformat::convert_float_column(reinterpret_cast<const float*>(values.data()), sizeof(glm::vec2), 2, destination.data(), stride, attribute.format, values.size())) {
+        ERHE_FATAL("unsupported attribute type");
+    }
+}
+
+void Vertex_buffer_writer::write_column(const Vertex_attribute_info& attribute, const std::span<const glm::vec3> values)
+{
+    const std::span<std::uint8_t> destination = get_column_span(attribute, values.size());
+    if (!erhe::dataformat::convert_float_column(reinterpret_cast<const float*>(values.data()), sizeof(glm::vec3), 3, destination.data(), stride, attribute.format, values.size())) {
+        ERHE_FATAL("unsupported attribute type");
+    }
+}
+
+void Vertex_buffer_writer::write_column(const Vertex_attribute_info& attribute, const std::span<const glm::vec4> values)
+{
+    const std::span<std::uint8_t> destination = get_column_span(attribute, values.size());
+    if (!erhe::dataformat::convert_float_column(reinterpret_cast<const float*>(values.data()), sizeof(glm::vec4), 4, destination.data(), stride, attribute.format, values.size())) {
+        ERHE_FATAL("unsupported attribute type");
+    }
+}
+
+void Vertex_buffer_writer::write_column(const Vertex_attribute_info& attribute, const std::span<const glm::uvec4> values)
+{
+    const std::span<std::uint8_t> destination = get_column_span(attribute, values.size());
+    if (!erhe::dataformat::convert_uint_column(reinterpret_cast<const uint32_t*>(values.data()), sizeof(glm::uvec4), 4, destination.data(), stride, attribute.format, values.size())) {
+        ERHE_FATAL("unsupported attribute type");
+    }
+}
+
 void Vertex_buffer_writer::move(const std::size_t relative_offset)
 {
     vertex_write_offset += relative_offset;
@@ -750,6 +805,11 @@ void Vertex_buffer_writer::next_vertex()
     move(stride);
 }
 
+void Vertex_buffer_writer::next_vertices(const std::size_t count)
+{
+    move(count * stride);
+}
+
 void Index_buffer_writer::write_corner(const uint32_t v0)
 {
     //trace_fmt(log_primitive_builder, "point {}\n", v0);
@@ -766,6 +826,22 @@ void Index_buffer_writer::write_triangle(const uint32_t v0, const uint32_t v1, c
     triangle_indices_written += 3;
 }
 
+void Index_buffer_writer::write_lod_triangle(const uint32_t v0, const uint32_t v1, const uint32_t v2)
+{
+    write_low(triangle_fill_lod_index_data_span.subspan((triangle_lod_indices_written + 0) * index_type_size, index_type_size), index_type, v0);
+    write_low(triangle_fill_lod_index_data_span.subspan((triangle_lod_indices_written + 1) * index_type_size, index_type_size), index_type, v1);
+    write_low(triangle_fill_lod_index_data_span.subspan((triangle_lod_indices_written + 2) * index_type_size, index_type_size), index_type, v2);
+    triangle_lod_indices_written += 3;
+}
+
+void Index_buffer_writer::write_meshlet_triangle(const uint32_t v0, const uint32_t v1, const uint32_t v2)
+{
+    write_low(triangle_fill_meshlet_index_data_span.subspan((triangle_meshlet_indices_written + 0) * index_type_size, index_type_size), index_type, v0);
+    write_low(triangle_fill_meshlet_index_data_span.subspan((triangle_meshlet_indices_written + 1) * index_type_size, index_type_size), index_type, v1);
+    write_low(triangle_fill_meshlet_index_data_span.subspan((triangle_meshlet_indices_written + 2) * index_type_size, index_type_size), index_type, v2);
+    triangle_meshlet_indices_written += 3;
+}
+
 void Index_buffer_writer::write_expanded_triangle(const uint32_t v0, const uint32_t v1, const uint32_t v2)
 {
     write_low(expanded_triangle_fill_index_data_span.subspan((expanded_triangle_indices_written + 0) * index_type_size, index_type_size), index_type, v0);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "erhe_primitive/buffer_range.hpp"
+#include "erhe_primitive/buffer_sink.hpp"
 #include "erhe_primitive/vertex_attribute_info.hpp"
 #include "erhe_dataformat/dataformat.hpp"
 
@@ -57,18 +58,30 @@ public:
     void write(const Vertex_attribute_info& attribute, uint32_t value);
     void write(const Vertex_attribute_info& attribute, glm::uvec2 value);
     void write(const Vertex_attribute_info& attribute, glm::uvec4 value);
-    void move (std::size_t relative_offset);
-    void next_vertex();
 
-    [[nodiscard]] auto start_offset() -> std::size_t;
+    // Column writes: values[i] goes to vertex (current + i), converted with
+    // erhe::dataformat::convert_float_column() / convert_uint_column(). The
+    // format is dispatched once per column, and the write offset is not
+    // moved; follow with next_vertices(values.size()).
+    void write_column(const Vertex_attribute_info& attribute, std::span<const glm::vec2>  values);
+    void write_column(const Vertex_attribute_info& attribute, std::span<const glm::vec3>  values);
+    void write_column(const Vertex_attribute_info& attribute, std::span<const glm::vec4>  values);
+    void write_column(const Vertex_attribute_info& attribute, std::span<const glm::uvec4> values);
+
+    void move         (std::size_t relative_offset);
+    void next_vertex  ();
+    void next_vertices(std::size_t count);
+
+    [[nodiscard]] auto start_offset   () -> std::size_t;
+    [[nodiscard]] auto get_column_span(const Vertex_attribute_info& attribute, std::size_t count) -> std::span<std::uint8_t>;
 
     Build_context&            build_context;
     Vertex_buffer_sink&       buffer_sink;
     std::size_t               stream;
     std::size_t               stride;
     Buffer_range              buffer_range;
-    std::vector<std::uint8_t> vertex_data;
-    std::span<std::uint8_t>   vertex_data_span;
+    Buffer_sink_write         vertex_write;     // from buffer_sink.begin_vertex_write()
+    std::span<std::uint8_t>   vertex_data_span; // vertex_write.span
     std::size_t               vertex_write_offset{0};
 };
 
@@ -83,6 +96,8 @@ public:
 
     void write_corner           (uint32_t v0);
     void write_triangle         (uint32_t v0, uint32_t v1, uint32_t v2);
+    void write_lod_triangle     (uint32_t v0, uint32_t v1, uint32_t v2);
+    void write_meshlet_triangle (uint32_t v0, uint32_t v1, uint32_t v2);
     void write_expanded_triangle(uint32_t v0, uint32_t v1, uint32_t v2);
     void write_edge             (uint32_t v0, uint32_t v1);
     void write_centroid         (uint32_t v0);
@@ -94,16 +109,20 @@ public:
     Buffer_range                   buffer_range;
     const erhe::dataformat::Format index_type;
     const std::size_t              index_type_size{0};
-    std::vector<std::uint8_t>      index_data;
-    std::span<std::uint8_t>        index_data_span;
+    Buffer_sink_write              index_write;     // from buffer_sink.begin_index_write()
+    std::span<std::uint8_t>        index_data_span; // index_write.span
     std::span<std::uint8_t>        corner_point_index_data_span;
     std::span<std::uint8_t>        triangle_fill_index_data_span;
+    std::span<std::uint8_t>        triangle_fill_lod_index_data_span; // all levels, consecutive
+    std::span<std::uint8_t>        triangle_fill_meshlet_index_data_span;
     std::span<std::uint8_t>        expanded_triangle_fill_index_data_span;
     std::span<std::uint8_t>        edge_line_index_data_span;
     std::span<std::uint8_t>        polygon_centroid_index_data_span;
 
     std::size_t corner_point_indices_written     {0};
     std::size_t triangle_indices_written         {0};
+    std::size_t triangle_lod_indices_written     {0};
+    std::size_t triangle_meshlet_indices_written {0};
     std::size_t expanded_triangle_indices_written{0};
     std::size_t edge_line_indices_written        {0};
     std::size_t polygon_centroid_indices_written {0};
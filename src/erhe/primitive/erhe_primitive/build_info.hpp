@@ -1,6 +1,8 @@
 #pragma once
 
 #include "erhe_primitive/buffer_info.hpp"
+#include "erhe_primitive/meshlet.hpp"
+#include "erhe_geometry/operation/generate_lods.hpp"
 
 #include <geogram/mesh/mesh.h>
 
@@ -19,6 +21,18 @@ public:
     // wireframe shares the fill's exact depth (no z-fight). Independent of
     // fill_triangles: a build may produce either, or both.
     bool fill_triangles_expanded{false};
+    // Coarser levels of detail of the fill triangles (quadric error
+    // simplification, see erhe::geometry::operation::generate_lods()), written
+    // as extra index ranges over the fill vertices into
+    // Buffer_mesh::triangle_fill_lods. Requires fill_triangles. Not built
+    // with Normal_style::polygon_normals.
+    bool fill_triangle_lods     {false};
+    // The fill triangles once more, reordered into meshlets (see
+    // build_meshlets()) in Buffer_mesh::triangle_fill_meshlet_indices, with
+    // per meshlet bounds for cluster culling in
+    // Buffer_mesh::triangle_fill_meshlets. Requires fill_triangles. Skipped
+    // for meshes below Meshlet_settings::min_triangle_count.
+    bool fill_triangle_meshlets {false};
     bool edge_lines             {false};
     bool corner_points          {false};
     bool centroid_points        {false};
@@ -34,6 +48,8 @@ public:
     Normal_style    normal_style  {Normal_style::corner_normals};
     bool            vertex_id_vec3{false};
     bool            autocolor     {false};
+    erhe::geometry::operation::Lod_settings lod_settings{};
+    Meshlet_settings                        meshlet_settings{};
 };
 
 class Element_mappings
@@ -0,0 +1,295 @@
+#include "erhe_primitive/meshlet.hpp"
+#include "erhe_geometry/geometry.hpp"
+#include "erhe_profile/profile.hpp"
+#include "erhe_verify/verify.hpp"
+
+#include <geogram/mesh/mesh.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace erhe::primitive {
+
+namespace {
+
+constexpr uint32_t no_triangle = std::numeric_limits<uint32_t>::max();
+
+class Meshlet_triangle
+{
+public:
+    GEO::index_t corners [3];
+    GEO::index_t vertices[3];
+    glm::vec3    centroid;
+    glm::vec3    normal; // unit length, zero for degenerate triangles
+};
+
+class Meshlet_builder
+{
+public:
+    Meshlet_builder(const GEO::Mesh& mesh, const Meshlet_settings& settings)
+        : m_mesh    {mesh}
+        , m_settings{settings}
+    {
+        triangulate();
+    }
+
+    [[nodiscard]] auto triangle_count() const -> std::size_t { return m_triangles.size(); }
+
+    void build(Meshlet_build& result)
+    {
+        build_vertex_triangles();
+        m_assigned    .assign(m_triangles.size(), 0);
+        m_is_candidate.assign(m_triangles.size(), 0);
+        result.triangle_corners.reserve(3 * m_triangles.size());
+
+        uint32_t next_seed = no_triangle;
+        uint32_t seed_scan = 0;
+        for (;;) {
+            // Continue next to the previous meshlet; fall back to the first
+            // unassigned triangle when it left no unassigned neighbors.
+            uint32_t seed = next_seed;
+            if ((seed == no_triangle) || (m_assigned[seed] != 0)) {
+                while ((seed_scan < m_triangles.size()) && (m_assigned[seed_scan] != 0)) {
+                    ++seed_scan;
+                }
+                if (seed_scan == m_triangles.size()) {
+                    break;
+                }
+                seed = seed_scan;
+            }
+            next_seed = build_meshlet(seed, result);
+        }
+    }
+
+private:
+    void triangulate()
+    {
+        // Same triangles and winding as Build_context::build_triangle_fill_index():
+        // (c0, c[i - 1], c[i]).
+        for (GEO::index_t facet : m_mesh.facets) {
+            const GEO::index_t corner_count = m_mesh.facets.nb_corners(facet);
+            if (corner_count < 3) {
+                continue;
+            }
+            const GEO::index_t c0 = m_mesh.facets.corner(facet, 0);
+            for (GEO::index_t i = 2; i < corner_count; ++i) {
+                Meshlet_triangle triangle{};
+                triangle.corners[0] = c0;
+                triangle.corners[1] = m_mesh.facets.corner(facet, i - 1);
+                triangle.corners[2] = m_mesh.facets.corner(facet, i);
+                glm::vec3 p[3];
+                for (std::size_t j = 0; j < 3; ++j) {
+                    triangle.vertices[j] = m_mesh.facet_corners.vertex(triangle.corners[j]);
+                    p[j] = erhe::geometry::to_glm_vec3(erhe::geometry::get_pointf(m_mesh.vertices, triangle.vertices[j]));
+                }
+                const glm::vec3 cross  = glm::cross(p[1] - p[0], p[2] - p[0]);
+                const float     length = glm::length(cross);
+                triangle.centroid = (p[0] + p[1] + p[2]) / 3.0f;
+                triangle.normal   = (length > 0.0f) ? (cross / length) : glm::vec3{0.0f};
+                m_triangles.push_back(triangle);
+            }
+        }
+    }
+
+    // Triangles around each mesh vertex, compressed rows.
+    void build_vertex_triangles()
+    {
+        m_vertex_offsets.assign(static_cast<std::size_t>(m_mesh.vertices.nb()) + 1, 0);
+        for (const Meshlet_triangle& triangle : m_triangles) {
+            for (GEO::index_t vertex : triangle.vertices) {
+                ++m_vertex_offsets[vertex + 1];
+            }
+        }
+        for (std::size_t i = 1, end = m_vertex_offsets.size(); i < end; ++i) {
+            m_vertex_offsets[i] += m_vertex_offsets[i - 1];
+        }
+        m_vertex_triangles.resize(m_vertex_offsets.back());
+        std::vector<uint32_t> cursor{m_vertex_offsets.begin(), m_vertex_offsets.end() - 1};
+        for (uint32_t t = 0, end = static_cast<uint32_t>(m_triangles.size()); t < end; ++t) {
+            for (GEO::index_t vertex : m_triangles[t].vertices) {
+                m_vertex_triangles[cursor[vertex]++] = t;
+            }
+        }
+    }
+
+    [[nodiscard]] auto get_new_corner_count(const Meshlet_triangle& triangle) const -> uint32_t
+    {
+        uint32_t count = 0;
+        for (GEO::index_t corner : triangle.corners) {
+            if (std::find(m_meshlet_corners.begin(), m_meshlet_corners.end(), corner) == m_meshlet_corners.end()) {
+                ++count;
+            }
+        }
+        return count;
+    }
+
+    void add_triangle(const uint32_t t, Meshlet_build& result)
+    {
+        const Meshlet_triangle& triangle = m_triangles[t];
+        m_assigned[t] = 1;
+        for (GEO::index_t corner : triangle.corners) {
+            result.triangle_corners.push_back(corner);
+            if (std::find(m_meshlet_corners.begin(), m_meshlet_corners.end(), corner) == m_meshlet_corners.end()) {
+                m_meshlet_corners.push_back(corner);
+            }
+        }
+        m_meshlet_triangles.push_back(t);
+        m_centroid_sum += triangle.centroid;
+        m_normal_sum   += triangle.normal;
+        for (GEO::index_t vertex : triangle.vertices) {
+            for (uint32_t i = m_vertex_offsets[vertex], end = m_vertex_offsets[vertex + 1]; i < end; ++i) {
+                const uint32_t neighbor = m_vertex_triangles[i];
+                if ((m_assigned[neighbor] == 0) && (m_is_candidate[neighbor] == 0)) {
+                    m_is_candidate[neighbor] = 1;
+                    m_candidates.push_back(neighbor);
+                }
+            }
+        }
+    }
+
+    // Grows one meshlet from seed and appends it. Returns the unassigned
+    // candidate closest to the finished meshlet (next seed), or no_triangle.
+    auto build_meshlet(const uint32_t seed, Meshlet_build& result) -> uint32_t
+    {
+        m_meshlet_corners  .clear();
+        m_meshlet_triangles.clear();
+        m_centroid_sum = glm::vec3{0.0f};
+        m_normal_sum   = glm::vec3{0.0f};
+        const std::size_t first_index = result.triangle_corners.size();
+
+        add_triangle(seed, result);
+        while (m_meshlet_triangles.size() < m_settings.max_triangle_count) {
+            const glm::vec3 center        = m_centroid_sum / static_cast<float>(m_meshlet_triangles.size());
+            const float     normal_length = glm::length(m_normal_sum);
+            const glm::vec3 axis          = (normal_length > 0.0f) ? (m_normal_sum / normal_length) : glm::vec3{0.0f};
+            uint32_t best            {no_triangle};
+            uint32_t best_new_corners{4};
+            float    best_score      {std::numeric_limits<float>::max()};
+            for (std::size_t i = 0; i < m_candidates.size();) {
+                const uint32_t candidate = m_candidates[i];
+                if (m_assigned[candidate] != 0) {
+                    m_is_candidate[candidate] = 0;
+                    m_candidates[i] = m_candidates.back();
+                    m_candidates.pop_back();
+                    continue;
+                }
+                ++i;
+                const Meshlet_triangle& triangle    = m_triangles[candidate];
+                const uint32_t          new_corners = get_new_corner_count(triangle);
+                if (m_meshlet_corners.size() + new_corners > m_settings.max_vertex_count) {
+                    continue;
+                }
+                // Fewest new vertices first (the rest of a facet fan), then
+                // compact and flat: distance to the center, up to three times
+                // longer for a normal facing the other way.
+                const float score = glm::distance(triangle.centroid, center) * (2.0f - glm::dot(triangle.normal, axis));
+                if ((new_corners < best_new_corners) || ((new_corners == best_new_corners) && (score < best_score))) {
+                    best             = candidate;
+                    best_new_corners = new_corners;
+                    best_score       = score;
+                }
+            }
+            if (best == no_triangle) {
+                break;
+            }
+            add_triangle(best, result);
+        }
+
+        result.meshlets.push_back(make_meshlet(first_index, result));
+
+        // Next seed: the leftover candidate closest to this meshlet.
+        const glm::vec3 center        = result.meshlets.back().center;
+        uint32_t        next_seed     = no_triangle;
+        float           best_distance = std::numeric_limits<float>::max();
+        for (const uint32_t candidate : m_candidates) {
+            m_is_candidate[candidate] = 0;
+            if (m_assigned[candidate] != 0) {
+                continue;
+            }
+            const float distance = glm::distance(m_triangles[candidate].centroid, center);
+            if (distance < best_distance) {
+                best_distance = distance;
+                next_seed     = candidate;
+            }
+        }
+        m_candidates.clear();
+        return next_seed;
+    }
+
+    [[nodiscard]] auto make_meshlet(const std::size_t first_index, const Meshlet_build& result) const -> Buffer_meshlet
+    {
+        Buffer_meshlet meshlet{};
+        meshlet.first_index = static_cast<uint32_t>(first_index);
+        meshlet.index_count = static_cast<uint32_t>(result.triangle_corners.size() - first_index);
+
+        glm::vec3 min_corner{std::numeric_limits<float>::max()};
+        glm::vec3 max_corner{std::numeric_limits<float>::lowest()};
+        for (const uint32_t t : m_meshlet_triangles) {
+            for (GEO::index_t vertex : m_triangles[t].vertices) {
+                const glm::vec3 p = erhe::geometry::to_glm_vec3(erhe::geometry::get_pointf(m_mesh.vertices, vertex));
+                min_corner = glm::min(min_corner, p);
+                max_corner = glm::max(max_corner, p);
+            }
+        }
+        meshlet.center = 0.5f * (min_corner + max_corner);
+        float radius2 = 0.0f;
+        for (const uint32_t t : m_meshlet_triangles) {
+            for (GEO::index_t vertex : m_triangles[t].vertices) {
+                const glm::vec3 p = erhe::geometry::to_glm_vec3(erhe::geometry::get_pointf(m_mesh.vertices, vertex));
+                const glm::vec3 d = p - meshlet.center;
+                radius2 = std::max(radius2, glm::dot(d, d));
+            }
+        }
+        meshlet.radius = std::sqrt(radius2);
+
+        // Normal cone. Beyond ~84 degrees (min dot 0.1) the test would
+        // practically never pass; leave it disabled.
+        const float normal_length = glm::length(m_normal_sum);
+        if (normal_length > 0.0f) {
+            meshlet.cone_axis = m_normal_sum / normal_length;
+            float min_dot = 1.0f;
+            for (const uint32_t t : m_meshlet_triangles) {
+                const glm::vec3& normal = m_triangles[t].normal;
+                if (normal != glm::vec3{0.0f}) {
+                    min_dot = std::min(min_dot, glm::dot(normal, meshlet.cone_axis));
+                }
+            }
+            meshlet.cone_cutoff = (min_dot > 0.1f) ? std::sqrt(1.0f - min_dot * min_dot) : 1.0f;
+        }
+        return meshlet;
+    }
+
+    const GEO::Mesh&              m_mesh;
+    const Meshlet_settings&       m_settings;
+    std::vector<Meshlet_triangle> m_triangles;
+    std::vector<uint32_t>         m_vertex_offsets;
+    std::vector<uint32_t>         m_vertex_triangles;
+    std::vector<uint8_t>          m_assigned;
+    std::vector<uint8_t>          m_is_candidate;
+    std::vector<uint32_t>         m_candidates;
+    std::vector<GEO::index_t>     m_meshlet_corners;
+    std::vector<uint32_t>         m_meshlet_triangles;
+    glm::vec3                     m_centroid_sum{0.0f};
+    glm::vec3                     m_normal_sum  {0.0f};
+};
+
+} // anonymous namespace
+
+auto build_meshlets(const GEO::Mesh& mesh, const Meshlet_settings& settings) -> Meshlet_build
+{
+    ERHE_PROFILE_FUNCTION();
+
+    ERHE_VERIFY(settings.max_vertex_count >= 3);
+    ERHE_VERIFY(settings.max_triangle_count >= 1);
+
+    Meshlet_build   result;
+    Meshlet_builder builder{mesh, settings};
+    if ((builder.triangle_count() == 0) || (builder.triangle_count() < settings.min_triangle_count)) {
+        return result;
+    }
+    builder.build(result);
+    return result;
+}
+
+} // namespace erhe::primitive
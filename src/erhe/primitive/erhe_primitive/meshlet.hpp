@@ -0,0 +1,68 @@
+#pragma once
+
+#include <geogram/basic/numeric.h>
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace GEO { class Mesh; }
+
+namespace erhe::primitive {
+
+class Meshlet_settings
+{
+public:
+    // Limits per meshlet. Vertices are fill vertices, which the builder
+    // writes one per mesh corner: triangles of one facet share vertices,
+    // triangles of different facets never do.
+    uint32_t max_vertex_count  {64};
+    uint32_t max_triangle_count{124};
+    // Meshes with fewer fill triangles are not partitioned; whole object
+    // culling is as good for them and the meshlet index range would only
+    // cost memory.
+    uint32_t min_triangle_count{4096};
+};
+
+// One cluster of fill triangles: a sub-range of
+// Buffer_mesh::triangle_fill_meshlet_indices, with object space bounds for
+// CPU cluster culling (erhe::scene_renderer::append_cluster_draw_commands()).
+class Buffer_meshlet
+{
+public:
+    uint32_t  first_index{0}; // relative to the start of the index buffer range, like Index_range::first_index
+    uint32_t  index_count{0};
+    glm::vec3 center     {0.0f}; // bounding sphere
+    float     radius     {0.0f};
+    // Normal cone of the triangles. All triangles face away from a view
+    // position p when
+    //   dot(normalize(center - p), cone_axis) >= cone_cutoff + radius / length(center - p)
+    // cone_cutoff >= 1.0f: the normals spread too wide, never back facing.
+    glm::vec3 cone_axis  {0.0f, 0.0f, 1.0f};
+    float     cone_cutoff{1.0f};
+};
+
+// Result of build_meshlets(): the fill triangles as source facet corners,
+// reordered meshlet by meshlet, and the meshlets over them. first_index is
+// relative to the start of triangle_corners until the builder offsets it by
+// the allocated index range.
+class Meshlet_build
+{
+public:
+    std::vector<GEO::index_t>   triangle_corners; // 3 per triangle
+    std::vector<Buffer_meshlet> meshlets;
+};
+
+// Greedy partition of the fan-triangulated facets (same triangles and
+// winding as the fill build) into spatially compact meshlets. A meshlet
+// grows from a seed triangle by the candidate sharing a mesh vertex with it
+// that adds the fewest new vertices, then is closest to the meshlet center
+// and best aligned with its normal; the next seed is taken next to the
+// previous meshlet. Bounding spheres are the box center plus the farthest
+// vertex; normal cones are the normalized sum of triangle normals.
+//
+// Reads only positions; safe to call concurrently for different meshes.
+[[nodiscard]] auto build_meshlets(const GEO::Mesh& mesh, const Meshlet_settings& settings = {}) -> Meshlet_build;
+
+} // namespace erhe::primitive
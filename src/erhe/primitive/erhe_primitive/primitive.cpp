@@ -451,10 +451,9 @@ auto Primitive_shape::make_geometry_build_locked() -> std::shared_ptr<erhe::geom
     Element_mappings element_mappings;
     GEO::Mesh& mesh = geometry->get_mesh();
 
-    // Geogram concurrency: mesh_from_triangle_soup (colocate) and
-    // Geometry::process serialize themselves internally on
-    // erhe::geometry::geogram_lock(); compute_mesh_tangents is
-    // mesh-local erhe code and needs no lock.
+    // Geogram concurrency: mesh_from_triangle_soup (colocate) serializes
+    // itself internally on erhe::geometry::geogram_lock(); Geometry::process
+    // and compute_mesh_tangents are mesh-local erhe code and need no lock.
     mesh_from_triangle_soup(*m_triangle_soup.get(), mesh, element_mappings);
 
     const erhe::dataformat::Attribute_stream tangent_stream = m_triangle_soup->vertex_format.find_attribute(erhe::dataformat::Vertex_attribute_usage::tangent);
@@ -882,17 +881,20 @@ auto build_buffer_mesh_from_triangle_soup(const Triangle_soup& triangle_soup, co
 
     // Copy indices to buffer
     {
-        std::vector<uint8_t> sink_index_data(index_count * index_range.element_size);
-        memcpy(sink_index_data.data(), triangle_soup.index_data.data(), index_count * index_range.element_size);
-        buffer_info.index_buffer_sink.enqueue_index_data(index_range, std::move(sink_index_data));
+        Buffer_sink_write index_write = buffer_info.index_buffer_sink.begin_index_write(index_range, index_count * index_range.element_size);
+        memcpy(index_write.span.data(), triangle_soup.index_data.data(), index_count * index_range.element_size);
+        buffer_info.index_buffer_sink.end_index_write(std::move(index_write));
     }
 
     // Copy and convert vertices to buffer
     for (size_t stream_index = 0, stream_end = buffer_info.vertex_format.streams.size(); stream_index < stream_end; ++stream_index) {
         const erhe::dataformat::Vertex_stream& sink_stream = buffer_info.vertex_format.streams[stream_index];
-        std::vector<uint8_t> sink_vertex_data(vertex_count * sink_stream.stride);
+        Buffer_sink_write vertex_write = buffer_info.vertex_buffer_sink.begin_vertex_write(
+            buffer_mesh.vertex_buffer_ranges[stream_index],
+            vertex_count * sink_stream.stride
+        );
         const std::vector<erhe::dataformat::Vertex_attribute>& attributes = sink_stream.attributes;
-        uint8_t* sink_vertex_data_base = sink_vertex_data.data();
+        uint8_t* sink_vertex_data_base = vertex_write.span.data();
         const uint8_t* src_vertex_data_base = triangle_soup.vertex_data.data();
         for (std::size_t attribute_index = 0, attribute_index_end = attributes.size(); attribute_index < attribute_index_end; ++attribute_index) {
             const erhe::dataformat::Vertex_attribute& sink_attribute = attributes[attribute_index];
@@ -916,10 +918,7 @@ auto build_buffer_mesh_from_triangle_soup(const Triangle_soup& triangle_soup, co
                 }
             }
         }
-        buffer_info.vertex_buffer_sink.enqueue_vertex_data(
-            buffer_mesh.vertex_buffer_ranges[stream_index],
-            std::move(sink_vertex_data)
-        );
+        buffer_info.vertex_buffer_sink.end_vertex_write(std::move(vertex_write));
     }
 
     const erhe::dataformat::Attribute_stream position = triangle_soup.vertex_format.find_attribute(erhe::dataformat::Vertex_attribute_usage::position);
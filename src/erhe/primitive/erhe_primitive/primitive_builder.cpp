@@ -33,12 +33,14 @@ Build_context_root::Build_context_root(
     Buffer_mesh&      buffer_mesh,
     const GEO::Mesh&  mesh,
     const Build_info& build_info,
-    Element_mappings& element_mappings_in
+    Element_mappings& element_mappings_in,
+    Normal_style      normal_style
 )
     : buffer_mesh     {buffer_mesh}
     , mesh            {mesh}
     , build_info      {build_info}
     , element_mappings{element_mappings_in}
+    , normal_style    {normal_style}
     , mesh_info       {::get_mesh_info(mesh)}
     , vertex_format   {build_info.buffer_info.vertex_format}
 {
@@ -79,6 +81,40 @@ void Build_context_root::get_mesh_info()
         element_mappings.triangle_to_mesh_facet.resize(triangle_count);
     }
 
+    // Levels of detail follow the fill range. They reference the fill
+    // vertices through mesh corners, so per facet normals (polygon_normals,
+    // one normal for all corners of a facet) would smear across the merged
+    // facets - not built for that style.
+    if (
+        primitive_types.fill_triangles &&
+        primitive_types.fill_triangle_lods &&
+        (normal_style != Normal_style::polygon_normals)
+    ) {
+        lod_levels = erhe::geometry::operation::generate_lods(mesh, build_info.lod_settings);
+        buffer_mesh.triangle_fill_lods.resize(lod_levels.size());
+        for (std::size_t i = 0, end = lod_levels.size(); i < end; ++i) {
+            const std::size_t index_count = lod_levels[i].triangle_corners.size();
+            total_index_count += index_count;
+            allocate_index_range(Primitive_type::triangles, index_count, buffer_mesh.triangle_fill_lods[i].triangle_fill_indices);
+            buffer_mesh.triangle_fill_lods[i].error = lod_levels[i].error;
+        }
+    }
+
+    // Meshlets: a reordered copy of the fill triangles. The meshlet ranges
+    // are relative to the copy until offset by its allocated first_index.
+    if (primitive_types.fill_triangles && primitive_types.fill_triangle_meshlets) {
+        meshlet_build = build_meshlets(mesh, build_info.meshlet_settings);
+        if (!meshlet_build.triangle_corners.empty()) {
+            total_index_count += meshlet_build.triangle_corners.size();
+            allocate_index_range(Primitive_type::triangles, meshlet_build.triangle_corners.size(), buffer_mesh.triangle_fill_meshlet_indices);
+            buffer_mesh.triangle_fill_meshlets = meshlet_build.meshlets;
+            const uint32_t offset = static_cast<uint32_t>(buffer_mesh.triangle_fill_meshlet_indices.first_index);
+            for (Buffer_meshlet& meshlet : buffer_mesh.triangle_fill_meshlets) {
+                meshlet.first_index += offset;
+            }
+        }
+    }
+
     // Expanded solid-wireframe fill: one sequential index per expanded vertex
     // (3 per fill triangle), values 0..3N-1 into the dedicated expanded vertex
     // buffer. Only when the caller supplied an expanded vertex format.
@@ -460,6 +496,15 @@ auto Primitive_builder::build() -> bool
             )
         );
         build_context.build_polygon_fill();
+
+        if (primitive_types.fill_triangle_lods) {
+            erhe::log::set_breadcrumb("primitive: build_triangle_fill_lods");
+            build_context.build_triangle_fill_lods();
+        }
+        if (primitive_types.fill_triangle_meshlets) {
+            erhe::log::set_breadcrumb("primitive: build_triangle_fill_meshlets");
+            build_context.build_triangle_fill_meshlets();
+        }
     }
 
     if (primitive_types.fill_triangles_expanded) {
@@ -498,7 +543,7 @@ Build_context::Build_context(
     Element_mappings&  element_mappings,
     const Normal_style normal_style
 )
-    : root           {buffer_mesh, mesh, build_info, element_mappings}
+    : root           {buffer_mesh, mesh, build_info, element_mappings, normal_style}
     , normal_style   {normal_style}
     , index_writer   {*this, build_info.buffer_info.index_buffer_sink}
     , mesh_attributes{mesh}
@@ -556,6 +601,10 @@ void Build_context::build_polygon_id()
     }
 
     const glm::vec4 id_vec4 = erhe::math::vec4_from_uint(static_cast<uint32_t>(mesh_facet));
+    if (use_vertex_columns) {
+        vertex_columns.id[vertex_buffer_index] = id_vec4;
+        return;
+    }
     attribute_writers.id->write(root.vertex_attributes.id_vec4, id_vec4);
 }
 
@@ -566,7 +615,11 @@ void Build_context::build_vertex_position()
     v_position = get_pointf(root.mesh.vertices, mesh_vertex);
 
     ERHE_VERIFY(std::isfinite(v_position.x) && std::isfinite(v_position.y) && std::isfinite(v_position.z));
-    attribute_writers.position->write(root.vertex_attributes.position, v_position);
+    if (use_vertex_columns) {
+        vertex_columns.position[vertex_buffer_index] = to_glm_vec3(v_position);
+    } else {
+        attribute_writers.position->write(root.vertex_attributes.position, v_position);
+    }
 
     SPDLOG_LOGGER_TRACE(
         log_primitive_builder,
@@ -700,7 +753,11 @@ void Build_context::build_vertex_normal(bool do_normal, bool do_normal_smooth)
     /// }
 
     if (do_normal) {
-        attribute_writers.normal->write(root.vertex_attributes.normal, to_glm_vec3(v_normal));
+        if (use_vertex_columns) {
+            vertex_columns.normal[vertex_buffer_index] = to_glm_vec3(v_normal);
+        } else {
+            attribute_writers.normal->write(root.vertex_attributes.normal, to_glm_vec3(v_normal));
+        }
     }
 
     // if (features.normal_flat && root.attributes.normal_flat.is_valid()) {
@@ -712,8 +769,9 @@ void Build_context::build_vertex_normal(bool do_normal, bool do_normal_smooth)
         ERHE_PROFILE_SCOPE("2n");
     
         std::optional<GEO::vec3f> smooth_vertex_normal = mesh_attributes.vertex_normal_smooth.try_get(mesh_vertex);
+        glm::vec3 normal_smooth{0.0f, 1.0f, 0.0f};
         if (smooth_vertex_normal.has_value()) {
-            attribute_writers.normal_smooth->write(root.vertex_attributes.normal_smooth, to_glm_vec3(smooth_vertex_normal.value()));
+            normal_smooth = to_glm_vec3(smooth_vertex_normal.value());
         } else {
             // Smooth normals are currently used only for wide line depth bias.
             // If edge lines are not used, do not generate warning about missing smooth normals.
@@ -721,19 +779,30 @@ void Build_context::build_vertex_normal(bool do_normal, bool do_normal_smooth)
                 SPDLOG_LOGGER_TRACE(log_primitive_builder, "point {} corner {} smooth unit y normal", point_id, corner_id);
                 used_fallback_smooth_normal = true;
             }
-            const GEO::vec3f fallback_vertex_normal_smooth{0.0f, 1.0f, 0.0f};
-            attribute_writers.normal_smooth->write(root.vertex_attributes.normal_smooth, fallback_vertex_normal_smooth);
+        }
+        if (use_vertex_columns) {
+            vertex_columns.normal_smooth[vertex_buffer_index] = normal_smooth;
+        } else {
+            attribute_writers.normal_smooth->write(root.vertex_attributes.normal_smooth, normal_smooth);
         }
     }
 }
 
 void Build_context::build_vertex_tangent()
 {
+    if (use_vertex_columns) {
+        vertex_columns.tangent[vertex_buffer_index] = to_glm_vec4(v_tangent);
+        return;
+    }
     attribute_writers.tangent->write(root.vertex_attributes.tangent, to_glm_vec4(v_tangent));
 }
 
 void Build_context::build_vertex_bitangent()
 {
+    if (use_vertex_columns) {
+        vertex_columns.bitangent[vertex_buffer_index] = to_glm_vec3(v_bitangent);
+        return;
+    }
     attribute_writers.bitangent->write(root.vertex_attributes.bitangent, to_glm_vec3(v_bitangent));
 }
 
@@ -746,6 +815,10 @@ void Build_context::build_vertex_texcoord(size_t usage_index)
         corner_texcoord.has_value() ? corner_texcoord.value() :
         vertex_texcoord.has_value() ? vertex_texcoord.value() : GEO::vec2f{0.0f, 0.0f};
 
+    if (use_vertex_columns) {
+        vertex_columns.texcoord[usage_index][vertex_buffer_index] = glm::vec2{texcoord.x, texcoord.y};
+        return;
+    }
     attribute_writers.texcoord_0->write(root.vertex_attributes.texcoord[usage_index], texcoord);
 }
 
@@ -753,6 +826,10 @@ void Build_context::build_vertex_joint_indices(size_t usage_index)
 {
     std::optional<GEO::vec4u> vertex_joint_indices = mesh_attributes.vertex_joint_indices(usage_index).try_get(mesh_vertex);
     GEO::vec4u joint_indices = vertex_joint_indices.has_value() ? vertex_joint_indices.value() : GEO::vec4u{0, 0, 0, 0};
+    if (use_vertex_columns) {
+        vertex_columns.joint_indices[usage_index][vertex_buffer_index] = glm::uvec4{joint_indices.x, joint_indices.y, joint_indices.z, joint_indices.w};
+        return;
+    }
     attribute_writers.joint_indices_0->write(root.vertex_attributes.joint_indices[usage_index], joint_indices);
 }
 
@@ -760,6 +837,10 @@ void Build_context::build_vertex_joint_weights(size_t usage_index)
 {
     std::optional<GEO::vec4f> vertex_joint_weights = mesh_attributes.vertex_joint_weights(usage_index).try_get(mesh_vertex);
     GEO::vec4f joint_weights = vertex_joint_weights.has_value() ? vertex_joint_weights.value() : GEO::vec4f{1.0f, 0.0f, 0.0f, 0.0f};
+    if (use_vertex_columns) {
+        vertex_columns.joint_weights[usage_index][vertex_buffer_index] = to_glm_vec4(joint_weights);
+        return;
+    }
     attribute_writers.joint_weights_0->write(root.vertex_attributes.joint_weights[usage_index], joint_weights);
 }
 
@@ -774,6 +855,10 @@ void Build_context::build_vertex_color(size_t usage_index)
         facet_color .has_value() ? facet_color .value() :
         vertex_color.has_value() ? vertex_color.value() : root.build_info.constant_color;
 
+    if (use_vertex_columns) {
+        vertex_columns.color[usage_index][vertex_buffer_index] = to_glm_vec4(color);
+        return;
+    }
     attribute_writers.color_0->write(root.vertex_attributes.color[usage_index], color);
 }
 
@@ -793,6 +878,10 @@ void Build_context::build_vertex_aniso_control()
         facet_aniso_control .has_value() ? facet_aniso_control .value() :
         vertex_aniso_control.has_value() ? vertex_aniso_control.value() : GEO::vec2f{1.0f, 1.0f};
 
+    if (use_vertex_columns) {
+        vertex_columns.aniso_control[vertex_buffer_index] = glm::vec2{aniso_control.x, aniso_control.y};
+        return;
+    }
     attribute_writers.aniso_control->write(root.vertex_attributes.aniso_control, aniso_control);
 }
 
@@ -855,6 +944,51 @@ void Build_context::build_triangle_fill_index()
     previous_index = vertex_buffer_index;
 }
 
+void Build_context::resize_vertex_columns(const std::size_t vertex_count)
+{
+    const Vertex_attributes& attributes = root.vertex_attributes;
+    Vertex_columns&          columns    = vertex_columns;
+    if (attributes.id_vec4      .is_valid() && (attribute_writers.id != nullptr)) columns.id           .resize(vertex_count);
+    if (attributes.position     .is_valid()) columns.position     .resize(vertex_count);
+    if (attributes.normal       .is_valid()) columns.normal       .resize(vertex_count);
+    if (attributes.normal_smooth.is_valid()) columns.normal_smooth.resize(vertex_count);
+    if (attributes.tangent      .is_valid()) columns.tangent      .resize(vertex_count);
+    if (attributes.bitangent    .is_valid()) columns.bitangent    .resize(vertex_count);
+    if (attributes.aniso_control.is_valid()) columns.aniso_control.resize(vertex_count);
+    for (std::size_t i = 0; i < 3; ++i) {
+        if (attributes.texcoord[i].is_valid()) columns.texcoord[i].resize(vertex_count);
+    }
+    for (std::size_t i = 0; i < 2; ++i) {
+        if (attributes.color        [i].is_valid()) columns.color        [i].resize(vertex_count);
+        if (attributes.joint_indices[i].is_valid()) columns.joint_indices[i].resize(vertex_count);
+        if (attributes.joint_weights[i].is_valid()) columns.joint_weights[i].resize(vertex_count);
+    }
+}
+
+void Build_context::write_vertex_columns()
+{
+    ERHE_PROFILE_FUNCTION();
+
+    const Vertex_attributes& attributes = root.vertex_attributes;
+    Vertex_columns&          columns    = vertex_columns;
+    if (!columns.id           .empty()) attribute_writers.id           ->write_column(attributes.id_vec4,       columns.id);
+    if (!columns.position     .empty()) attribute_writers.position     ->write_column(attributes.position,      columns.position);
+    if (!columns.normal       .empty()) attribute_writers.normal       ->write_column(attributes.normal,        columns.normal);
+    if (!columns.normal_smooth.empty()) attribute_writers.normal_smooth->write_column(attributes.normal_smooth, columns.normal_smooth);
+    if (!columns.tangent      .empty()) attribute_writers.tangent      ->write_column(attributes.tangent,       columns.tangent);
+    if (!columns.bitangent    .empty()) attribute_writers.bitangent    ->write_column(attributes.bitangent,     columns.bitangent);
+    if (!columns.aniso_control.empty()) attribute_writers.aniso_control->write_column(attributes.aniso_control, columns.aniso_control);
+    for (std::size_t i = 0; i < 3; ++i) {
+        if (!columns.texcoord[i].empty()) attribute_writers.texcoord_0->write_column(attributes.texcoord[i], columns.texcoord[i]);
+    }
+    for (std::size_t i = 0; i < 2; ++i) {
+        if (!columns.color        [i].empty()) attribute_writers.color_0        ->write_column(attributes.color        [i], columns.color        [i]);
+        if (!columns.joint_indices[i].empty()) attribute_writers.joint_indices_0->write_column(attributes.joint_indices[i], columns.joint_indices[i]);
+        if (!columns.joint_weights[i].empty()) attribute_writers.joint_weights_0->write_column(attributes.joint_weights[i], columns.joint_weights[i]);
+    }
+    columns = Vertex_columns{};
+}
+
 auto Build_context::is_ready() const -> bool
 {
     const bool ready = 
@@ -907,6 +1041,12 @@ void Build_context::build_polygon_fill()
     const bool do_corner_points        = root.build_info.primitive_types.corner_points;
     const bool do_tangent_frame = do_vertex_normal_either || do_vertex_tangent || do_vertex_bitangent;
 
+    // Attribute values are gathered per corner and written as columns after
+    // the loop, one format dispatch per attribute instead of per value.
+    const std::size_t fill_vertex_count = static_cast<std::size_t>(root.mesh.facet_corners.nb());
+    resize_vertex_columns(fill_vertex_count);
+    use_vertex_columns = true;
+
     for (GEO::index_t facet : root.mesh.facets) {
         mesh_facet = facet;
         ERHE_PROFILE_SCOPE("polygon");
@@ -948,13 +1088,17 @@ void Build_context::build_polygon_fill()
             if (do_corner_points) build_corner_point_index();
             build_triangle_fill_index();
 
-            for (const std::unique_ptr<Vertex_buffer_writer>& vertex_writer : vertex_writers) {
-                vertex_writer->next_vertex();
-            }
             ++vertex_buffer_index;
         }
     }
 
+    use_vertex_columns = false;
+    ERHE_VERIFY(vertex_buffer_index == fill_vertex_count);
+    write_vertex_columns();
+    for (const std::unique_ptr<Vertex_buffer_writer>& vertex_writer : vertex_writers) {
+        vertex_writer->next_vertices(fill_vertex_count);
+    }
+
     if (used_fallback_smooth_normal) {
         log_primitive_builder->warn("Warning: Used fallback smooth normal");
     }
@@ -969,6 +1113,48 @@ void Build_context::build_polygon_fill()
     }
 }
 
+void Build_context::build_triangle_fill_lods()
+{
+    ERHE_PROFILE_FUNCTION();
+
+    if (!is_ready()) {
+        return;
+    }
+
+    // build_polygon_fill() wrote one vertex per mesh corner; the levels
+    // select among those.
+    const std::vector<uint32_t>& corner_to_vertex = root.element_mappings.mesh_corner_to_vertex_buffer_index;
+    for (const erhe::geometry::operation::Lod_level& level : root.lod_levels) {
+        const std::vector<GEO::index_t>& corners = level.triangle_corners;
+        for (std::size_t i = 0, end = corners.size(); i < end; i += 3) {
+            index_writer.write_lod_triangle(
+                corner_to_vertex[corners[i + 0]],
+                corner_to_vertex[corners[i + 1]],
+                corner_to_vertex[corners[i + 2]]
+            );
+        }
+    }
+}
+
+void Build_context::build_triangle_fill_meshlets()
+{
+    ERHE_PROFILE_FUNCTION();
+
+    if (!is_ready()) {
+        return;
+    }
+
+    const std::vector<uint32_t>&     corner_to_vertex = root.element_mappings.mesh_corner_to_vertex_buffer_index;
+    const std::vector<GEO::index_t>& corners          = root.meshlet_build.triangle_corners;
+    for (std::size_t i = 0, end = corners.size(); i < end; i += 3) {
+        index_writer.write_meshlet_triangle(
+            corner_to_vertex[corners[i + 0]],
+            corner_to_vertex[corners[i + 1]],
+            corner_to_vertex[corners[i + 2]]
+        );
+    }
+}
+
 void Build_context::build_expanded_polygon_fill()
 {
     ERHE_PROFILE_FUNCTION();
@@ -41,7 +41,8 @@ public:
         Buffer_mesh&      buffer_mesh,
         const GEO::Mesh&  mesh,
         const Build_info& build_info,
-        Element_mappings& element_mappings
+        Element_mappings& element_mappings,
+        Normal_style      normal_style
     );
 
     void get_mesh_info                  ();
@@ -59,7 +60,10 @@ public:
     const GEO::Mesh&                       mesh;
     const Build_info&                      build_info;
     Element_mappings&                      element_mappings;
+    Normal_style                           normal_style;
     std::size_t                            next_index_range_start{0};
+    std::vector<erhe::geometry::operation::Lod_level> lod_levels; // source corners, written by build_triangle_fill_lods()
+    Meshlet_build                          meshlet_build; // source corners, written by build_triangle_fill_meshlets()
     Vertex_attributes                      vertex_attributes;
     erhe::geometry::Mesh_info              mesh_info;
     const erhe::dataformat::Vertex_format& vertex_format;
@@ -83,6 +87,8 @@ public:
     auto is_ready() const -> bool;
 
     void build_polygon_fill         ();
+    void build_triangle_fill_lods   ();
+    void build_triangle_fill_meshlets();
     void build_expanded_polygon_fill();
     void build_edge_lines           ();
     void build_centroid_points      ();
@@ -113,6 +119,9 @@ private:
     void build_corner_point_index  ();
     void build_triangle_fill_index ();
 
+    void resize_vertex_columns(std::size_t vertex_count);
+    void write_vertex_columns ();
+
     GEO::vec3f v_position {};
     GEO::vec3f v_normal   {};
     GEO::vec4f v_tangent  {};
@@ -157,6 +166,28 @@ private:
 
     };
     Vertex_writers attribute_writers;
+
+    // Attribute values gathered by build_polygon_fill(), one per fill vertex,
+    // then converted and written one column at a time with
+    // Vertex_buffer_writer::write_column(). When use_vertex_columns is false
+    // (other builds) the build_vertex_*() helpers write per value.
+    class Vertex_columns
+    {
+    public:
+        std::vector<glm::vec4>  id;
+        std::vector<glm::vec3>  position;
+        std::vector<glm::vec3>  normal;
+        std::vector<glm::vec3>  normal_smooth;
+        std::vector<glm::vec4>  tangent;
+        std::vector<glm::vec3>  bitangent;
+        std::vector<glm::vec2>  texcoord     [3];
+        std::vector<glm::vec4>  color        [2];
+        std::vector<glm::vec2>  aniso_control;
+        std::vector<glm::uvec4> joint_indices[2];
+        std::vector<glm::vec4>  joint_weights[2];
+    };
+    Vertex_columns vertex_columns;
+    bool           use_vertex_columns{false};
 };
 
 class Primitive_builder final
@@ -12,6 +12,7 @@
 #include "erhe_raytrace/bvh/bvh_instance.hpp"
 #include "erhe_raytrace/bvh/bvh_scene.hpp"
 #include "erhe_raytrace/bvh/glm_conversions.hpp"
+#include "erhe_raytrace/raytrace_executor.hpp"
 #include "erhe_raytrace/raytrace_log.hpp"
 #include "erhe_raytrace/ray.hpp"
 
@@ -26,13 +27,19 @@
 #include <bvh/v2/executor.h>
 #include <bvh/v2/node.h>
 #include <bvh/v2/ray.h>
+#include <bvh/v2/reinsertion_optimizer.h>
 #include <bvh/v2/stack.h>
+#include <bvh/v2/sweep_sah_builder.h>
 #include <bvh/v2/thread_pool.h>
 
+#include <taskflow/taskflow.hpp>
+#include <taskflow/algorithm/for_each.hpp>
+
 #include <algorithm>
 #include <atomic>
 #include <fstream>
 #include <system_error>
+#include <vector>
 
 namespace erhe::raytrace {
 
@@ -221,6 +228,88 @@ private:
     bvh::v2::ParallelExecutor m_executor;
 };
 
+// bvh::v2 executor on a tf::Executor: splits ranges into tasks of at least
+// c_min_range_size items, co-running when called from one of its workers.
+class Taskflow_executor : public bvh::v2::Executor<Taskflow_executor>
+{
+public:
+    static constexpr std::size_t c_min_range_size = 1024;
+
+    explicit Taskflow_executor(tf::Executor& executor)
+        : m_executor{executor}
+    {
+    }
+
+    template <typename Loop>
+    void for_each(const std::size_t begin, const std::size_t end, const Loop& loop)
+    {
+        const std::size_t range_count = get_range_count(begin, end);
+        if (range_count < 2) {
+            loop(begin, end);
+            return;
+        }
+        tf::Taskflow taskflow;
+        taskflow.for_each_index(
+            std::size_t{0},
+            range_count,
+            std::size_t{1},
+            [&](const std::size_t range) {
+                loop(get_range_begin(begin, end, range_count, range), get_range_begin(begin, end, range_count, range + 1));
+            }
+        );
+        run(taskflow);
+    }
+
+    template <typename T, typename Reduce, typename Join>
+    auto reduce(const std::size_t begin, const std::size_t end, const T& init, const Reduce& reduce, const Join& join) -> T
+    {
+        const std::size_t range_count = get_range_count(begin, end);
+        if (range_count < 2) {
+            T result(init);
+            reduce(result, begin, end);
+            return result;
+        }
+        std::vector<T> results(range_count, init);
+        tf::Taskflow taskflow;
+        taskflow.for_each_index(
+            std::size_t{0},
+            range_count,
+            std::size_t{1},
+            [&](const std::size_t range) {
+                reduce(results[range], get_range_begin(begin, end, range_count, range), get_range_begin(begin, end, range_count, range + 1));
+            }
+        );
+        run(taskflow);
+        for (std::size_t range = 1; range < range_count; ++range) {
+            join(results[0], std::move(results[range]));
+        }
+        return std::move(results[0]);
+    }
+
+private:
+    [[nodiscard]] auto get_range_count(const std::size_t begin, const std::size_t end) const -> std::size_t
+    {
+        const std::size_t item_count = end - begin;
+        return std::min(item_count / c_min_range_size, std::max<std::size_t>(1, m_executor.num_workers()));
+    }
+
+    [[nodiscard]] static auto get_range_begin(const std::size_t begin, const std::size_t end, const std::size_t range_count, const std::size_t range) -> std::size_t
+    {
+        return begin + ((end - begin) * range) / range_count;
+    }
+
+    void run(tf::Taskflow& taskflow)
+    {
+        if (m_executor.this_worker_id() >= 0) {
+            m_executor.corun(taskflow);
+        } else {
+            m_executor.run(taskflow).wait();
+        }
+    }
+
+    tf::Executor& m_executor;
+};
+
 void Bvh_geometry::commit()
 {
     ERHE_PROFILE_FUNCTION();
@@ -305,7 +394,13 @@ void Bvh_geometry::commit()
             log_geometry->trace("BVH hash for {} : {:x}", debug_label(), hash_code);
         }
 
-        Executor_resources& executor_resources = Executor_resources::get_instance();
+        // With an injected executor, the parallel parts of the build run on
+        // its workers (co-running when commit() itself is an executor task)
+        // instead of on the bvh library's private thread pool, which would
+        // put a second pool of threads on the cores the shared workers use.
+        // The private pool is only created (on first use) when no executor
+        // is injected.
+        tf::Executor* const executor = get_executor();
 
         const bool load_ok = load_bvh(m_bvh, hash_code, triangle_count);
         if (!load_ok) {
@@ -317,12 +412,21 @@ void Bvh_geometry::commit()
                 erhe::time::Timer timer{m_debug_label.c_str()};
 
                 timer.begin();
-                m_bvh = bvh::v2::DefaultBuilder<Node>::build(
-                    executor_resources.get_thread_pool(),
-                    bboxes,
-                    centers,
-                    config
-                );
+                if (executor == nullptr) {
+                    m_bvh = bvh::v2::DefaultBuilder<Node>::build(
+                        Executor_resources::get_instance().get_thread_pool(),
+                        bboxes,
+                        centers,
+                        config
+                    );
+                } else {
+                    // What DefaultBuilder does for Quality::High: a sweep
+                    // SAH build, which is serial, then the parallel
+                    // reinsertion optimization
+                    Taskflow_executor taskflow_executor{*executor};
+                    m_bvh = bvh::v2::SweepSahBuilder<Node>::build(bboxes, centers, config);
+                    bvh::v2::ReinsertionOptimizer<Node>::optimize(taskflow_executor, m_bvh);
+                }
                 timer.end();
 
                 const auto time = std::chrono::duration_cast<std::chrono::milliseconds>(timer.duration().value()).count();
@@ -341,16 +445,17 @@ void Bvh_geometry::commit()
             m_precomputed_triangles.clear();
             m_precomputed_triangles.resize(tris.size());
 
-            executor_resources.get_executor().for_each(
-                0,
-                tris.size(),
-                [&] (const size_t begin, const size_t end) {
-                    for (size_t i = begin; i < end; ++i) {
-                        auto j = should_permute ? m_bvh.prim_ids[i] : i;
-                        m_precomputed_triangles[i] = tris[j];
-                    }
+            const auto precompute = [&] (const size_t begin, const size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    auto j = should_permute ? m_bvh.prim_ids[i] : i;
+                    m_precomputed_triangles[i] = tris[j];
                 }
-            );
+            };
+            if (executor == nullptr) {
+                Executor_resources::get_instance().get_executor().for_each(0, tris.size(), precompute);
+            } else {
+                Taskflow_executor{*executor}.for_each(0, tris.size(), precompute);
+            }
         }
     }
 
@@ -466,6 +571,48 @@ auto Bvh_geometry::intersect_instance(Ray& ray, Hit& hit, Bvh_instance* instance
     return false;
 }
 
+auto Bvh_geometry::occluded(const Ray& ray) -> bool
+{
+    ERHE_PROFILE_FUNCTION();
+
+    if (!m_enabled) {
+        return false;
+    }
+    if ((ray.mask & m_mask) == 0) {
+        return false;
+    }
+
+    bvh::v2::Ray<Scalar, 3> bvh_ray{
+        to_bvh(ray.origin),
+        to_bvh(ray.direction),
+        ray.t_near,
+        ray.t_far
+    };
+
+    static constexpr size_t stack_size = 64;
+    static constexpr bool   use_robust_traversal = false;
+
+    // Any hit traversal: the leaf callback returning true ends the traversal.
+    bool is_occluded = false;
+    bvh::v2::SmallStack<Bvh::Index, stack_size> stack;
+    m_bvh.intersect<true, use_robust_traversal>(
+        bvh_ray,
+        m_bvh.get_root().index,
+        stack,
+        [&] (const size_t begin, const size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                size_t j = should_permute ? i : m_bvh.prim_ids[i];
+                if (m_precomputed_triangles[j].intersect(bvh_ray)) {
+                    is_occluded = true;
+                    return true;
+                }
+            }
+            return false;
+        }
+    );
+    return is_occluded;
+}
+
 /// auto Bvh_geometry::get_sphere() const -> const erhe::math::Sphere&
 /// {
 ///     return m_bounding_sphere;
@@ -161,6 +161,25 @@ auto Bvh_instance::intersect(Ray& ray, Hit& hit) -> bool
     return is_hit;
 }
 
+auto Bvh_instance::occluded(const Ray& ray) -> bool
+{
+    ERHE_PROFILE_FUNCTION();
+
+    if (!m_enabled) {
+        return false;
+    }
+    if ((ray.mask & m_mask) == 0) {
+        return false;
+    }
+    if (m_scene == nullptr) {
+        return false;
+    }
+
+    const Ray  local_ray = ray.transform(glm::inverse(get_transform()));
+    Bvh_scene* bvh_scene = reinterpret_cast<Bvh_scene*>(get_scene());
+    return bvh_scene->occluded(local_ray);
+}
+
 #if 0
 void Bvh_instance::collect_spheres(
     std::vector<bvh::Sphere<float>>& spheres,
@@ -10,6 +10,7 @@
 #include "erhe_raytrace/bvh/bvh_instance.hpp"
 #include "erhe_raytrace/bvh/glm_conversions.hpp"
 #include "erhe_raytrace/iinstance.hpp"
+#include "erhe_raytrace/ray_batch.hpp"
 #include "erhe_raytrace/raytrace_executor.hpp"
 #include "erhe_raytrace/raytrace_log.hpp"
 #include "erhe_raytrace/ray.hpp"
@@ -533,6 +534,56 @@ auto Bvh_scene::intersect(Ray& ray, Hit& hit) -> bool
     return intersect_children(ray, hit, nullptr);
 }
 
+auto Bvh_scene::occluded(const Ray& ray) -> bool
+{
+    ERHE_PROFILE_FUNCTION();
+
+    return occluded_children(ray);
+}
+
+auto Bvh_scene::intersect_batch(std::span<Ray> rays, std::span<Hit> hits) -> std::size_t
+{
+    ERHE_PROFILE_FUNCTION();
+    ERHE_VERIFY(hits.size() >= rays.size());
+
+    // madmann91/bvh has no packet traversal; the batch win here is one
+    // virtual call and one profile zone per batch, and the parallel split.
+    return for_each_ray_range(
+        rays.size(),
+        [this, rays, hits](const std::size_t begin, const std::size_t end) -> std::size_t {
+            std::size_t hit_count = 0;
+            for (std::size_t i = begin; i < end; ++i) {
+                hits[i] = Hit{};
+                if (intersect_children(rays[i], hits[i], nullptr)) {
+                    ++hit_count;
+                }
+            }
+            return hit_count;
+        }
+    );
+}
+
+auto Bvh_scene::occluded_batch(std::span<const Ray> rays, std::span<uint8_t> out_occluded) -> std::size_t
+{
+    ERHE_PROFILE_FUNCTION();
+    ERHE_VERIFY(out_occluded.size() >= rays.size());
+
+    return for_each_ray_range(
+        rays.size(),
+        [this, rays, out_occluded](const std::size_t begin, const std::size_t end) -> std::size_t {
+            std::size_t occluded_count = 0;
+            for (std::size_t i = begin; i < end; ++i) {
+                const bool is_occluded = occluded_children(rays[i]);
+                out_occluded[i] = is_occluded ? 1 : 0;
+                if (is_occluded) {
+                    ++occluded_count;
+                }
+            }
+            return occluded_count;
+        }
+    );
+}
+
 auto Bvh_scene::intersect_instance(Ray& ray, Hit& hit, Bvh_instance* in_instance) -> bool
 {
     return intersect_children(ray, hit, in_instance);
@@ -600,6 +651,67 @@ auto Bvh_scene::intersect_tlas(Ray& ray, Hit& hit, Bvh_instance* in_instance) ->
     return is_hit;
 }
 
+auto Bvh_scene::occluded_children(const Ray& ray) -> bool
+{
+    // Any hit ends the query, so unlike intersect_children() there is no
+    // t_far to narrow: the linear pass only runs when the BVH found nothing.
+    if (m_tlas_ready && occluded_tlas(ray)) {
+        return true;
+    }
+    for (const Bvh_scene_child& child : m_children) {
+        if (child.in_tlas) {
+            continue;
+        }
+        const bool child_is_occluded = (child.instance != nullptr)
+            ? child.instance->occluded(ray)
+            : child.geometry->occluded(ray);
+        if (child_is_occluded) {
+            return true;
+        }
+    }
+    return false;
+}
+
+auto Bvh_scene::occluded_tlas(const Ray& ray) -> bool
+{
+    ERHE_PROFILE_FUNCTION();
+
+    static constexpr std::size_t stack_size           = 64;
+    static constexpr bool        use_robust_traversal = false;
+
+    bvh::v2::Ray<float, 3> bvh_ray{
+        to_bvh(ray.origin),
+        to_bvh(ray.direction),
+        ray.t_near,
+        ray.t_far
+    };
+
+    bool is_occluded = false;
+    bvh::v2::SmallStack<Tlas::Index, stack_size> stack;
+    m_tlas.intersect<true, use_robust_traversal>(
+        bvh_ray,
+        m_tlas.get_root().index,
+        stack,
+        [&](const std::size_t begin, const std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                const Tlas_member& member = m_tlas_members[m_tlas.prim_ids[i]];
+                if ((member.geometry == nullptr) && (member.instance == nullptr)) {
+                    continue; // evicted: traversed linearly instead
+                }
+                const bool member_is_occluded = (member.instance != nullptr)
+                    ? member.instance->occluded(ray)
+                    : member.geometry->occluded(ray);
+                if (member_is_occluded) {
+                    is_occluded = true;
+                    return true; // any hit: stop the traversal
+                }
+            }
+            return false;
+        }
+    );
+    return is_occluded;
+}
+
 auto Bvh_scene::debug_label() const -> std::string_view
 {
     return m_debug_label;
@@ -68,8 +68,8 @@ public:
 // Threading contract:
 //  - Mutation (attach, detach, commit, and modification of attached children)
 //    is single threaded.
-//  - intersect() is read only. Several threads may intersect the same scene
-//    concurrently, but not concurrently with mutation.
+//  - intersect() and occluded() are read only. Several threads may query the
+//    same scene concurrently, but not concurrently with mutation.
 class Bvh_scene : public IScene
 {
 public:
@@ -102,6 +102,9 @@ public:
     void detach     (IInstance* geometry)        override;
     void commit     ()                           override;
     auto intersect  (Ray& ray, Hit& hit) -> bool override;
+    auto occluded   (const Ray& ray) -> bool     override;
+    auto intersect_batch(std::span<Ray> rays, std::span<Hit> hits) -> std::size_t override;
+    auto occluded_batch (std::span<const Ray> rays, std::span<uint8_t> out_occluded) -> std::size_t override;
     auto debug_label() const -> std::string_view override;
 
     // Bvh_scene public API
@@ -165,6 +168,8 @@ private:
 
     auto intersect_children(Ray& ray, Hit& hit, Bvh_instance* in_instance) -> bool;
     auto intersect_tlas    (Ray& ray, Hit& hit, Bvh_instance* in_instance) -> bool;
+    auto occluded_children (const Ray& ray) -> bool;
+    auto occluded_tlas     (const Ray& ray) -> bool;
 
     // Collects the children which have been static long enough. Main thread.
     [[nodiscard]] auto make_tlas_build_input() -> Tlas_build_input;
@@ -2,8 +2,12 @@
 #include "erhe_raytrace/embree/embree_device.hpp"
 #include "erhe_raytrace/embree/embree_scene.hpp"
 #include "erhe_raytrace/raytrace_log.hpp"
+#include "erhe_raytrace/ray.hpp"
 #include "erhe_buffer/ibuffer.hpp"
 #include "erhe_log/log_glm.hpp"
+#include "erhe_profile/profile.hpp"
+
+#include <limits>
 
 namespace erhe::raytrace
 {
@@ -68,6 +72,10 @@ Embree_geometry::Embree_geometry(
 
 Embree_geometry::~Embree_geometry() noexcept
 {
+    if (m_standalone_scene != nullptr)
+    {
+        rtcReleaseScene(m_standalone_scene);
+    }
     SPDLOG_LOGGER_TRACE(log_embree, "rtcReleaseGeometry({})", m_debug_label);
     rtcReleaseGeometry(m_geometry);
 }
@@ -81,6 +89,7 @@ void Embree_geometry::commit()
 {
     SPDLOG_LOGGER_TRACE(log_embree, "rtcCommitGeometry({})", m_debug_label);
     rtcCommitGeometry(m_geometry);
+    mark_standalone_scene_dirty();
 }
 
 void Embree_geometry::enable()
@@ -88,6 +97,7 @@ void Embree_geometry::enable()
     SPDLOG_LOGGER_TRACE(log_embree, "rtcEnableGeometry(geometry = {})", m_debug_label);
     rtcEnableGeometry(m_geometry);
     rtcCommitGeometry(m_geometry);
+    mark_standalone_scene_dirty();
     m_enabled = true;
 }
 
@@ -96,6 +106,7 @@ void Embree_geometry::disable()
     SPDLOG_LOGGER_TRACE(log_embree, "rtcDisableGeometry(geometry = {})", m_debug_label);
     rtcDisableGeometry(m_geometry);
     rtcCommitGeometry(m_geometry);
+    mark_standalone_scene_dirty();
     m_enabled = false;
 }
 
@@ -109,6 +120,7 @@ void Embree_geometry::set_mask(const uint32_t mask)
     SPDLOG_LOGGER_TRACE(log_embree, "rtcSetGeometryMask(geometry = {}, mask = {:#04x})", m_debug_label, mask);
     rtcSetGeometryMask(m_geometry, mask);
     rtcCommitGeometry(m_geometry);
+    mark_standalone_scene_dirty();
     m_mask = mask;
 }
 
@@ -174,4 +186,72 @@ auto Embree_geometry::debug_label() const -> std::string_view
     return m_debug_label;
 }
 
+void Embree_geometry::mark_standalone_scene_dirty()
+{
+    const std::lock_guard<std::mutex> lock{m_standalone_scene_mutex};
+    m_standalone_scene_dirty = true;
+}
+
+auto Embree_geometry::get_standalone_scene() -> RTCScene
+{
+    const std::lock_guard<std::mutex> lock{m_standalone_scene_mutex};
+    if (m_standalone_scene == nullptr)
+    {
+        const RTCDevice device = Embree_device::get_instance().get_rtc_device();
+        if ((device == nullptr) || (m_geometry == nullptr))
+        {
+            return nullptr;
+        }
+        // A geometry can be attached to several scenes; this one is never
+        // visible outside of occluded().
+        m_standalone_scene = rtcNewScene(device);
+        if (m_standalone_scene == nullptr)
+        {
+            log_scene->error("rtcNewScene() failed");
+            return nullptr;
+        }
+        rtcAttachGeometry(m_standalone_scene, m_geometry);
+        m_standalone_scene_dirty = true;
+    }
+    if (m_standalone_scene_dirty)
+    {
+        SPDLOG_LOGGER_TRACE(log_embree, "rtcCommitScene({} standalone)", m_debug_label);
+        rtcCommitScene(m_standalone_scene);
+        m_standalone_scene_dirty = false;
+    }
+    return m_standalone_scene;
+}
+
+auto Embree_geometry::occluded(const Ray& ray) -> bool
+{
+    ERHE_PROFILE_FUNCTION();
+
+    if (!m_enabled || ((ray.mask & m_mask) == 0))
+    {
+        return false;
+    }
+    const RTCScene scene = get_standalone_scene();
+    if (scene == nullptr)
+    {
+        return false;
+    }
+
+    RTCRay rtc_ray{
+        .org_x = ray.origin.x,
+        .org_y = ray.origin.y,
+        .org_z = ray.origin.z,
+        .tnear = ray.t_near,
+        .dir_x = ray.direction.x,
+        .dir_y = ray.direction.y,
+        .dir_z = ray.direction.z,
+        .time  = ray.time,
+        .tfar  = ray.t_far,
+        .mask  = ray.mask,
+        .id    = ray.id,
+        .flags = 0
+    };
+    rtcOccluded1(scene, &rtc_ray, nullptr);
+    return rtc_ray.tfar == -std::numeric_limits<float>::infinity();
+}
+
 } // namespace erhe::raytrace
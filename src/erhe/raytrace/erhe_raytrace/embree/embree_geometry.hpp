@@ -5,6 +5,7 @@
 
 #include <embree4/rtcore.h>
 
+#include <mutex>
 #include <string>
 
 namespace erhe::buffer {
@@ -40,6 +41,7 @@ public:
         std::size_t               item_count
     ) override;
     void set_user_data(const void* ptr) override;
+    auto occluded     (const Ray& ray) -> bool override; // rtcOccluded1()
     [[nodiscard]] auto get_mask     () const -> uint32_t         override;
     [[nodiscard]] auto get_user_data() const -> const void*      override;
     [[nodiscard]] auto is_enabled   () const -> bool             override;
@@ -51,12 +53,21 @@ public:
     unsigned int geometry_id{0};
 
 private:
+    void mark_standalone_scene_dirty();
+    auto get_standalone_scene       () -> RTCScene;
+
     RTCGeometry  m_geometry {nullptr};
     const void*  m_user_data{nullptr};
     std::string  m_debug_label;
     bool         m_enabled  {true};
     uint32_t     m_mask     {0xffffffffu};
 
+    // Embree only traces scenes. occluded() on the geometry alone uses a
+    // private scene holding just this geometry, committed on first use after
+    // a change.
+    std::mutex   m_standalone_scene_mutex;
+    RTCScene     m_standalone_scene      {nullptr};
+    bool         m_standalone_scene_dirty{true};
 };
 
 }
@@ -2,6 +2,7 @@
 #include "erhe_raytrace/embree/embree_device.hpp"
 #include "erhe_raytrace/embree/embree_scene.hpp"
 #include "erhe_raytrace/raytrace_log.hpp"
+#include "erhe_raytrace/ray.hpp"
 #include "erhe_log/log_glm.hpp"
 #include "erhe_profile/profile.hpp"
 
@@ -140,6 +141,17 @@ void Embree_instance::set_scene(IScene* scene)
     );
 }
 
+auto Embree_instance::occluded(const Ray& ray) -> bool
+{
+    ERHE_PROFILE_FUNCTION();
+
+    if (!m_enabled || ((ray.mask & m_mask) == 0) || (m_scene == nullptr))
+    {
+        return false;
+    }
+    return m_scene->occluded(ray.transform(glm::inverse(get_transform())));
+}
+
 auto Embree_instance::get_embree_scene() const -> Embree_scene*
 {
     return m_scene;
@@ -4,7 +4,12 @@
 #include "erhe_raytrace/embree/embree_instance.hpp"
 #include "erhe_raytrace/raytrace_log.hpp"
 #include "erhe_raytrace/ray.hpp"
+#include "erhe_raytrace/ray_batch.hpp"
 #include "erhe_profile/profile.hpp"
+#include "erhe_verify/verify.hpp"
+
+#include <algorithm>
+#include <limits>
 
 namespace erhe::raytrace
 {
@@ -176,12 +181,179 @@ auto Embree_scene::intersect(Ray& ray, Hit& hit) -> bool
     hit.normal       = glm::vec3{ray_hit.hit.Ng_x, ray_hit.hit.Ng_y, ray_hit.hit.Ng_z};
     hit.uv           = glm::vec2{ray_hit.hit.u, ray_hit.hit.v};
     hit.triangle_id  = ray_hit.hit.primID;
-    hit.geometry     = nullptr;
-    hit.instance     = nullptr;
+    set_hit_geometry(hit, ray_hit.hit.geomID, ray_hit.hit.instID[0]);
+
+    return true;
+}
 
-    if (ray_hit.hit.instID[0] != RTC_INVALID_GEOMETRY_ID)
+auto Embree_scene::occluded(const Ray& ray) -> bool
+{
+    ERHE_PROFILE_FUNCTION();
+
+    if (m_scene == nullptr)
     {
-        const RTCGeometry instance_geometry = rtcGetGeometry(m_scene, ray_hit.hit.instID[0]);
+        return false;
+    }
+
+    RTCRay rtc_ray{
+        .org_x = ray.origin.x,
+        .org_y = ray.origin.y,
+        .org_z = ray.origin.z,
+        .tnear = ray.t_near,
+        .dir_x = ray.direction.x,
+        .dir_y = ray.direction.y,
+        .dir_z = ray.direction.z,
+        .time  = ray.time,
+        .tfar  = ray.t_far,
+        .mask  = ray.mask,
+        .id    = ray.id,
+        .flags = 0
+    };
+
+    SPDLOG_LOGGER_TRACE(log_embree, "rtcOccluded1({})", m_debug_label);
+    rtcOccluded1(m_scene, &rtc_ray, nullptr);
+
+    // Embree marks an occluded ray by setting tfar to -inf.
+    return rtc_ray.tfar == -std::numeric_limits<float>::infinity();
+}
+
+namespace {
+
+constexpr std::size_t c_packet_size = 16;
+
+}
+
+auto Embree_scene::intersect_batch(std::span<Ray> rays, std::span<Hit> hits) -> std::size_t
+{
+    ERHE_PROFILE_FUNCTION();
+    ERHE_VERIFY(hits.size() >= rays.size());
+
+    if (m_scene == nullptr)
+    {
+        std::fill_n(hits.begin(), rays.size(), Hit{});
+        return 0;
+    }
+
+    // Packets of 16 consecutive rays; a partial last packet masks off the
+    // unused lanes. Embree traverses the packet in SIMD where the ISA allows
+    // and falls back to single rays inside for incoherent lanes.
+    return for_each_ray_range(
+        rays.size(),
+        [this, rays, hits](const std::size_t begin, const std::size_t end) -> std::size_t {
+            std::size_t hit_count = 0;
+            for (std::size_t packet_begin = begin; packet_begin < end; packet_begin += c_packet_size) {
+                const std::size_t lane_count = std::min(c_packet_size, end - packet_begin);
+                // Embree requires the valid mask aligned like the packet (64 bytes)
+                alignas(64) int valid[c_packet_size];
+                RTCRayHit16     ray_hit;
+                for (std::size_t lane = 0; lane < c_packet_size; ++lane) {
+                    valid[lane] = (lane < lane_count) ? -1 : 0;
+                    if (lane >= lane_count) {
+                        continue;
+                    }
+                    const Ray& ray = rays[packet_begin + lane];
+                    ray_hit.ray.org_x    [lane] = ray.origin.x;
+                    ray_hit.ray.org_y    [lane] = ray.origin.y;
+                    ray_hit.ray.org_z    [lane] = ray.origin.z;
+                    ray_hit.ray.tnear    [lane] = ray.t_near;
+                    ray_hit.ray.dir_x    [lane] = ray.direction.x;
+                    ray_hit.ray.dir_y    [lane] = ray.direction.y;
+                    ray_hit.ray.dir_z    [lane] = ray.direction.z;
+                    ray_hit.ray.time     [lane] = ray.time;
+                    ray_hit.ray.tfar     [lane] = ray.t_far;
+                    ray_hit.ray.mask     [lane] = ray.mask;
+                    ray_hit.ray.id       [lane] = ray.id;
+                    ray_hit.ray.flags    [lane] = 0;
+                    ray_hit.hit.primID   [lane] = RTC_INVALID_GEOMETRY_ID;
+                    ray_hit.hit.geomID   [lane] = RTC_INVALID_GEOMETRY_ID;
+                    ray_hit.hit.instID[0][lane] = RTC_INVALID_GEOMETRY_ID;
+                }
+
+                rtcIntersect16(valid, m_scene, &ray_hit, nullptr);
+
+                for (std::size_t lane = 0; lane < lane_count; ++lane) {
+                    Ray& ray = rays[packet_begin + lane];
+                    Hit& hit = hits[packet_begin + lane];
+                    hit = Hit{};
+                    if (ray_hit.hit.geomID[lane] == RTC_INVALID_GEOMETRY_ID) {
+                        continue;
+                    }
+                    ray.t_far       = ray_hit.ray.tfar[lane];
+                    hit.normal      = glm::vec3{ray_hit.hit.Ng_x[lane], ray_hit.hit.Ng_y[lane], ray_hit.hit.Ng_z[lane]};
+                    hit.uv          = glm::vec2{ray_hit.hit.u[lane], ray_hit.hit.v[lane]};
+                    hit.triangle_id = ray_hit.hit.primID[lane];
+                    set_hit_geometry(hit, ray_hit.hit.geomID[lane], ray_hit.hit.instID[0][lane]);
+                    ++hit_count;
+                }
+            }
+            return hit_count;
+        }
+    );
+}
+
+auto Embree_scene::occluded_batch(std::span<const Ray> rays, std::span<uint8_t> out_occluded) -> std::size_t
+{
+    ERHE_PROFILE_FUNCTION();
+    ERHE_VERIFY(out_occluded.size() >= rays.size());
+
+    if (m_scene == nullptr)
+    {
+        std::fill_n(out_occluded.begin(), rays.size(), uint8_t{0});
+        return 0;
+    }
+
+    return for_each_ray_range(
+        rays.size(),
+        [this, rays, out_occluded](const std::size_t begin, const std::size_t end) -> std::size_t {
+            std::size_t occluded_count = 0;
+            for (std::size_t packet_begin = begin; packet_begin < end; packet_begin += c_packet_size) {
+                const std::size_t lane_count = std::min(c_packet_size, end - packet_begin);
+                alignas(64) int valid[c_packet_size];
+                RTCRay16        rtc_ray;
+                for (std::size_t lane = 0; lane < c_packet_size; ++lane) {
+                    valid[lane] = (lane < lane_count) ? -1 : 0;
+                    if (lane >= lane_count) {
+                        continue;
+                    }
+                    const Ray& ray = rays[packet_begin + lane];
+                    rtc_ray.org_x[lane] = ray.origin.x;
+                    rtc_ray.org_y[lane] = ray.origin.y;
+                    rtc_ray.org_z[lane] = ray.origin.z;
+                    rtc_ray.tnear[lane] = ray.t_near;
+                    rtc_ray.dir_x[lane] = ray.direction.x;
+                    rtc_ray.dir_y[lane] = ray.direction.y;
+                    rtc_ray.dir_z[lane] = ray.direction.z;
+                    rtc_ray.time [lane] = ray.time;
+                    rtc_ray.tfar [lane] = ray.t_far;
+                    rtc_ray.mask [lane] = ray.mask;
+                    rtc_ray.id   [lane] = ray.id;
+                    rtc_ray.flags[lane] = 0;
+                }
+
+                rtcOccluded16(valid, m_scene, &rtc_ray, nullptr);
+
+                // Embree marks an occluded lane by setting tfar to -inf.
+                for (std::size_t lane = 0; lane < lane_count; ++lane) {
+                    const bool is_occluded = rtc_ray.tfar[lane] == -std::numeric_limits<float>::infinity();
+                    out_occluded[packet_begin + lane] = is_occluded ? 1 : 0;
+                    if (is_occluded) {
+                        ++occluded_count;
+                    }
+                }
+            }
+            return occluded_count;
+        }
+    );
+}
+
+void Embree_scene::set_hit_geometry(Hit& hit, const unsigned int geometry_id, const unsigned int instance_id)
+{
+    hit.geometry = nullptr;
+    hit.instance = nullptr;
+
+    if (instance_id != RTC_INVALID_GEOMETRY_ID)
+    {
+        const RTCGeometry instance_geometry = rtcGetGeometry(m_scene, instance_id);
         if (instance_geometry != nullptr)
         {
             void* user_data                    = rtcGetGeometryUserData(instance_geometry);
@@ -192,19 +364,17 @@ auto Embree_scene::intersect(Ray& ray, Hit& hit) -> bool
                 Embree_scene* embree_instance_scene = embree_instance->get_embree_scene();
                 if (embree_instance_scene != nullptr)
                 {
-                    hit.geometry = embree_instance_scene->get_geometry_from_id(ray_hit.hit.geomID);
+                    hit.geometry = embree_instance_scene->get_geometry_from_id(geometry_id);
                 }
             }
         }
     }
     else
     {
-        hit.geometry = (ray_hit.hit.geomID != RTC_INVALID_GEOMETRY_ID)
-            ? get_geometry_from_id(ray_hit.hit.geomID)
+        hit.geometry = (geometry_id != RTC_INVALID_GEOMETRY_ID)
+            ? get_geometry_from_id(geometry_id)
             : nullptr;
     }
-
-    return true;
 }
 
 auto Embree_scene::get_rtc_scene() -> RTCScene
@@ -47,12 +47,17 @@ public:
     // rtcGetSceneLinearBounds()
 
     auto intersect(Ray& ray, Hit& hit) -> bool override;
+    auto occluded (const Ray& ray) -> bool     override; // rtcOccluded1()
+    auto intersect_batch(std::span<Ray> rays, std::span<Hit> hits) -> std::size_t override; // rtcIntersect16()
+    auto occluded_batch (std::span<const Ray> rays, std::span<uint8_t> out_occluded) -> std::size_t override; // rtcOccluded16()
 
     //void set_dirty();
     auto get_rtc_scene() -> RTCScene;
     auto get_geometry_from_id(const unsigned int id) -> Embree_geometry*;
 
 private:
+    void set_hit_geometry(Hit& hit, unsigned int geometry_id, unsigned int instance_id);
+
     RTCScene    m_scene{nullptr};
     std::string m_debug_label;
     //bool        m_dirty{true};
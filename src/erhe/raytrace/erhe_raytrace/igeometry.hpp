@@ -61,6 +61,11 @@ public:
         std::size_t               item_count
     ) = 0;
     virtual void set_user_data(const void* ptr) = 0;
+
+    // Any hit against this geometry alone, see IScene::occluded(). The ray is
+    // in the space of the geometry; enable state and mask are respected.
+    [[nodiscard]] virtual auto occluded(const Ray& ray) -> bool = 0;
+
     [[nodiscard]] virtual auto get_mask     () const -> uint32_t         = 0;
     [[nodiscard]] virtual auto get_user_data() const -> const void*      = 0;
     [[nodiscard]] virtual auto is_enabled   () const -> bool             = 0;
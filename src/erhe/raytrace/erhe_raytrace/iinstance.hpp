@@ -23,6 +23,12 @@ public:
     virtual void set_scene    (IScene* scene) = 0;
     virtual void set_mask     (uint32_t mask) = 0;
     virtual void set_user_data(void* ptr) = 0;
+
+    // Any hit against the instanced scene, see IScene::occluded(). The ray is
+    // in the space of the scene this instance is attached to; enable state
+    // and mask are respected.
+    [[nodiscard]] virtual auto occluded(const Ray& ray) -> bool = 0;
+
     [[nodiscard]] virtual auto get_transform() const -> glm::mat4        = 0;
     [[nodiscard]] virtual auto get_scene    () const -> IScene*          = 0;
     [[nodiscard]] virtual auto get_mask     () const -> uint32_t         = 0;
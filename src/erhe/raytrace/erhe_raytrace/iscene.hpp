@@ -1,6 +1,9 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <span>
 #include <string_view>
 
 namespace erhe::raytrace {
@@ -21,6 +24,26 @@ public:
     virtual void detach   (IInstance* instance) = 0;
     virtual void commit   () = 0;
     virtual auto intersect(Ray& ray, Hit& hit) -> bool = 0;
+
+    // Any hit: true when anything intersects the ray within [t_near, t_far].
+    // Traversal stops at the first hit found, so this is cheaper than
+    // intersect() for visibility and shadow rays. The ray is not modified.
+    [[nodiscard]] virtual auto occluded(const Ray& ray) -> bool = 0;
+
+    // Closest hit for every ray of a batch, with one virtual call. hits[i]
+    // receives the hit of rays[i] and rays[i].t_far is narrowed to it, as
+    // with intersect(); a ray that misses leaves hits[i] default constructed
+    // (geometry and instance null). hits must hold at least rays.size()
+    // entries. Returns the number of rays that hit. Batches of at least
+    // c_parallel_ray_batch_size rays are split over the raytrace executor
+    // (ray_batch.hpp), so the scene must not be mutated during the call.
+    virtual auto intersect_batch(std::span<Ray> rays, std::span<Hit> hits) -> std::size_t = 0;
+
+    // Any hit variant for visibility / shadow rays: out_occluded[i] is set to
+    // 1 when anything intersects rays[i] within [t_near, t_far], else 0. The
+    // rays are not modified. Returns the number of occluded rays.
+    virtual auto occluded_batch(std::span<const Ray> rays, std::span<uint8_t> out_occluded) -> std::size_t = 0;
+
     [[nodiscard]] virtual auto debug_label() const -> std::string_view = 0;
 
     [[nodiscard]] static auto create       (std::string_view debug_label) -> IScene*;
@@ -34,6 +34,7 @@ public:
         std::size_t               item_count
     ) override;
     void set_user_data(const void* ptr) override;
+    auto occluded     (const Ray&) -> bool             override { return false; }
     auto get_mask     () const -> uint32_t         override { return m_mask; }
     auto get_user_data() const -> const void*      override { return nullptr; }
     auto is_enabled   () const -> bool             override { return m_enabled; }
@@ -76,6 +76,11 @@ void Null_instance::set_user_data(void* ptr)
     m_user_data = ptr;
 }
 
+auto Null_instance::occluded(const Ray&) -> bool
+{
+    return false;
+}
+
 auto Null_instance::get_user_data() const -> void*
 {
     return m_user_data;
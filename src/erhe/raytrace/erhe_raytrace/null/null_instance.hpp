@@ -27,6 +27,7 @@ public:
     void set_scene    (IScene* scene)       override;
     void set_mask     (uint32_t mask)       override;
     void set_user_data(void* ptr)           override;
+    auto occluded     (const Ray& ray) -> bool  override;
     [[nodiscard]] auto get_transform() const -> glm::mat4        override;
     [[nodiscard]] auto get_scene    () const -> IScene*          override;
     [[nodiscard]] auto get_mask     () const -> uint32_t         override;
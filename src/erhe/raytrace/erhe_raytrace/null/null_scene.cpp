@@ -1,7 +1,11 @@
 #include "erhe_raytrace/null/null_scene.hpp"
 #include "erhe_raytrace/null/null_geometry.hpp"
 #include "erhe_raytrace/iinstance.hpp"
+#include "erhe_raytrace/ray.hpp"
 #include "erhe_raytrace/raytrace_log.hpp"
+#include "erhe_verify/verify.hpp"
+
+#include <algorithm>
 
 namespace erhe::raytrace {
 
@@ -88,6 +92,25 @@ auto Null_scene::intersect(Ray&, Hit&) -> bool
     return false;
 }
 
+auto Null_scene::occluded(const Ray&) -> bool
+{
+    return false;
+}
+
+auto Null_scene::intersect_batch(std::span<Ray> rays, std::span<Hit> hits) -> std::size_t
+{
+    ERHE_VERIFY(hits.size() >= rays.size());
+    std::fill_n(hits.begin(), rays.size(), Hit{});
+    return 0;
+}
+
+auto Null_scene::occluded_batch(std::span<const Ray> rays, std::span<uint8_t> out_occluded) -> std::size_t
+{
+    ERHE_VERIFY(out_occluded.size() >= rays.size());
+    std::fill_n(out_occluded.begin(), rays.size(), uint8_t{0});
+    return 0;
+}
+
 auto Null_scene::debug_label() const -> std::string_view
 {
     return m_debug_label;
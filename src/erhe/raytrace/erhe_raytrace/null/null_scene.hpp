@@ -24,6 +24,9 @@ public:
     void detach     (IInstance* geometry)        override;
     void commit     ()                           override;
     auto intersect  (Ray& ray, Hit& hit) -> bool override;
+    auto occluded   (const Ray& ray) -> bool     override;
+    auto intersect_batch(std::span<Ray> rays, std::span<Hit> hits) -> std::size_t override;
+    auto occluded_batch (std::span<const Ray> rays, std::span<uint8_t> out_occluded) -> std::size_t override;
     auto debug_label() const -> std::string_view override;
 
 private:
@@ -0,0 +1,46 @@
+#include "erhe_raytrace/ray_batch.hpp"
+#include "erhe_raytrace/raytrace_executor.hpp"
+#include "erhe_profile/profile.hpp"
+
+#include <taskflow/taskflow.hpp>
+#include <taskflow/algorithm/for_each.hpp>
+
+#include <algorithm>
+#include <atomic>
+
+namespace erhe::raytrace {
+
+auto for_each_ray_range(
+    const std::size_t                                             ray_count,
+    const std::function<std::size_t(std::size_t, std::size_t)>&   range_function
+) -> std::size_t
+{
+    ERHE_PROFILE_FUNCTION();
+
+    tf::Executor* const executor = get_executor();
+    if ((executor == nullptr) || (ray_count < c_parallel_ray_batch_size)) {
+        return range_function(0, ray_count);
+    }
+
+    const std::size_t range_count = (ray_count + c_ray_batch_range_size - 1) / c_ray_batch_range_size;
+    std::atomic<std::size_t> total{0};
+    tf::Taskflow taskflow;
+    taskflow.for_each_index(
+        std::size_t{0},
+        range_count,
+        std::size_t{1},
+        [&](const std::size_t range) {
+            const std::size_t begin = range * c_ray_batch_range_size;
+            const std::size_t end   = std::min(begin + c_ray_batch_range_size, ray_count);
+            total.fetch_add(range_function(begin, end), std::memory_order_relaxed);
+        }
+    );
+    if (executor->this_worker_id() >= 0) {
+        executor->corun(taskflow);
+    } else {
+        executor->run(taskflow).wait();
+    }
+    return total.load(std::memory_order_relaxed);
+}
+
+} // namespace erhe::raytrace
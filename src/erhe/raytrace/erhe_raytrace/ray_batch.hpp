@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+namespace erhe::raytrace {
+
+// Batches shorter than this are traced by the calling thread. Splitting a
+// batch costs a taskflow submit and wake-up, which a few hundred rays do not
+// pay back.
+static constexpr std::size_t c_parallel_ray_batch_size = 1024;
+
+// Rays per task when a batch is split.
+static constexpr std::size_t c_ray_batch_range_size = 256;
+
+// Calls range_function(begin, end) over consecutive ranges covering
+// [0, ray_count) and returns the sum of the returned counts. Batches of at
+// least c_parallel_ray_batch_size rays are split into ranges of
+// c_ray_batch_range_size on the raytrace executor (raytrace_executor.hpp),
+// when one is set; the calling thread waits (or coruns, when it is an
+// executor worker). range_function must only read the scene and write the
+// outputs of its own range.
+auto for_each_ray_range(
+    std::size_t                                                 ray_count,
+    const std::function<std::size_t(std::size_t, std::size_t)>& range_function
+) -> std::size_t;
+
+} // namespace erhe::raytrace
@@ -7,6 +7,7 @@
 #include "erhe_file/file.hpp"
 #include "erhe_raytrace/tinybvh/tinybvh_geometry.hpp"
 #include "erhe_raytrace/tinybvh/tinybvh_instance.hpp"
+#include "erhe_raytrace/tinybvh/tinybvh_ray.hpp"
 #include "erhe_raytrace/raytrace_log.hpp"
 #include "erhe_raytrace/ray.hpp"
 
@@ -231,6 +232,27 @@ void Tinybvh_geometry::set_user_data(const void* ptr)
     m_user_data = ptr;
 }
 
+auto Tinybvh_geometry::occluded(const Ray& ray) -> bool
+{
+    ERHE_PROFILE_FUNCTION();
+
+    if (!m_enabled) {
+        return false;
+    }
+    if ((ray.mask & m_mask) == 0) {
+        return false;
+    }
+    if (m_triangle_count == 0) {
+        return false;
+    }
+
+    const Tinybvh_ray_space ray_space{ray};
+    if (ray_space.is_empty(ray)) {
+        return false;
+    }
+    return m_bvh->IsOccluded(ray_space.make_ray(ray));
+}
+
 auto Tinybvh_geometry::intersect_instance(Ray& ray, Hit& hit, Tinybvh_instance* instance) -> bool
 {
     ERHE_PROFILE_FUNCTION();
@@ -247,23 +269,20 @@ auto Tinybvh_geometry::intersect_instance(Ray& ray, Hit& hit, Tinybvh_instance*
 
     const glm::mat4 transform = (instance != nullptr) ? instance->get_transform() : glm::mat4{1.0f};
 
-    // tinybvh normalizes the direction in its Ray constructor, which changes
-    // the meaning of t. We need to account for the direction length so that
-    // t values are correct in the caller's coordinate space.
-    const float direction_length = glm::length(ray.direction);
-    const float t_far_normalized = (direction_length > 0.0f) ? (ray.t_far * direction_length) : ray.t_far;
-
-    tinybvh::Ray tinybvh_ray{
-        tinybvh::bvhvec3{ray.origin.x,    ray.origin.y,    ray.origin.z},
-        tinybvh::bvhvec3{ray.direction.x, ray.direction.y, ray.direction.z},
-        t_far_normalized
-    };
+    const Tinybvh_ray_space ray_space{ray};
+    if (ray_space.is_empty(ray)) {
+        return false;
+    }
+    tinybvh::Ray tinybvh_ray = ray_space.make_ray(ray);
 
+    // A miss leaves hit.t at the ray's initial extent. Compare in tinybvh
+    // space: converting back can round below ray.t_far.
+    const float tinybvh_t_far = tinybvh_ray.hit.t;
     m_bvh->Intersect(tinybvh_ray);
 
-    const float t_original_space = (direction_length > 0.0f) ? (tinybvh_ray.hit.t / direction_length) : tinybvh_ray.hit.t;
+    const float t_original_space = ray_space.from_tinybvh_t(tinybvh_ray.hit.t);
 
-    if (t_original_space < ray.t_far) {
+    if (tinybvh_ray.hit.t < tinybvh_t_far) {
         const uint32_t prim_id = tinybvh_ray.hit.prim;
 
         // Compute triangle normal from stored vertices
@@ -47,6 +47,7 @@ public:
         std::size_t               item_count
     ) override;
     void set_user_data(const void* ptr) override;
+    auto occluded     (const Ray& ray) -> bool override;
     auto get_mask     () const -> uint32_t         override;
     auto get_user_data() const -> const void*      override;
     auto is_enabled   () const -> bool             override;
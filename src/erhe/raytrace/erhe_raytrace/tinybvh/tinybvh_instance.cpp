@@ -97,6 +97,25 @@ auto Tinybvh_instance::intersect(Ray& ray, Hit& hit) -> bool
     return is_hit;
 }
 
+auto Tinybvh_instance::occluded(const Ray& ray) -> bool
+{
+    ERHE_PROFILE_FUNCTION();
+
+    if (!m_enabled) {
+        return false;
+    }
+    if ((ray.mask & m_mask) == 0) {
+        return false;
+    }
+    if (m_scene == nullptr) {
+        return false;
+    }
+
+    const Ray      local_ray     = ray.transform(glm::inverse(get_transform()));
+    Tinybvh_scene* tinybvh_scene = static_cast<Tinybvh_scene*>(get_scene());
+    return tinybvh_scene->occluded_instance(local_ray);
+}
+
 auto Tinybvh_instance::get_transform() const -> glm::mat4
 {
     return m_transform;
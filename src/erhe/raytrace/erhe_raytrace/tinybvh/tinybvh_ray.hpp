@@ -0,0 +1,70 @@
+#pragma once
+
+#include "erhe_raytrace/ray.hpp"
+
+#include <glm/glm.hpp>
+
+#include "tiny_bvh.h"
+
+#include <algorithm>
+
+namespace erhe::raytrace {
+
+// tinybvh::Ray has no t_near, and its constructor normalizes the direction,
+// which changes the meaning of t. Tinybvh_ray_space starts the tinybvh ray
+// at t_near and converts t between the caller's space and tinybvh's, so
+// every intersect and occluded query sees the same [t_near, t_far] segment.
+class Tinybvh_ray_space
+{
+public:
+    explicit Tinybvh_ray_space(const Ray& ray)
+        : m_direction_length{glm::length(ray.direction)}
+        , m_t_near          {std::max(ray.t_near, 0.0f)}
+    {
+    }
+
+    // True when [t_near, t_far] is empty: nothing can be hit.
+    [[nodiscard]] auto is_empty(const Ray& ray) const -> bool
+    {
+        return !(m_t_near < ray.t_far);
+    }
+
+    [[nodiscard]] auto make_ray(const Ray& ray) const -> tinybvh::Ray
+    {
+        const glm::vec3 origin = ray.origin + m_t_near * ray.direction;
+        return tinybvh::Ray{
+            tinybvh::bvhvec3{origin.x,        origin.y,        origin.z},
+            tinybvh::bvhvec3{ray.direction.x, ray.direction.y, ray.direction.z},
+            to_tinybvh_t(ray.t_far)
+        };
+    }
+
+    // TLAS rays also carry the instance mask
+    [[nodiscard]] auto make_masked_ray(const Ray& ray) const -> tinybvh::Ray
+    {
+        const glm::vec3 origin = ray.origin + m_t_near * ray.direction;
+        return tinybvh::Ray{
+            tinybvh::bvhvec3{origin.x,        origin.y,        origin.z},
+            tinybvh::bvhvec3{ray.direction.x, ray.direction.y, ray.direction.z},
+            to_tinybvh_t(ray.t_far),
+            ray.mask
+        };
+    }
+
+    [[nodiscard]] auto to_tinybvh_t(const float t) const -> float
+    {
+        const float t_from_near = t - m_t_near;
+        return (m_direction_length > 0.0f) ? (t_from_near * m_direction_length) : t_from_near;
+    }
+
+    [[nodiscard]] auto from_tinybvh_t(const float tinybvh_t) const -> float
+    {
+        return m_t_near + ((m_direction_length > 0.0f) ? (tinybvh_t / m_direction_length) : tinybvh_t);
+    }
+
+private:
+    float m_direction_length;
+    float m_t_near;
+};
+
+} // namespace erhe::raytrace
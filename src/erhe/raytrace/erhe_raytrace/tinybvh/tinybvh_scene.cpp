@@ -1,7 +1,9 @@
 #include "erhe_raytrace/tinybvh/tinybvh_scene.hpp"
 #include "erhe_raytrace/tinybvh/tinybvh_geometry.hpp"
 #include "erhe_raytrace/tinybvh/tinybvh_instance.hpp"
+#include "erhe_raytrace/tinybvh/tinybvh_ray.hpp"
 #include "erhe_raytrace/iinstance.hpp"
+#include "erhe_raytrace/ray_batch.hpp"
 #include "erhe_raytrace/raytrace_log.hpp"
 #include "erhe_raytrace/ray.hpp"
 #include "erhe_profile/profile.hpp"
@@ -204,6 +206,62 @@ auto Tinybvh_scene::intersect(Ray& ray, Hit& hit) -> bool
 {
     ERHE_PROFILE_FUNCTION();
 
+    return intersect_closest(ray, hit);
+}
+
+auto Tinybvh_scene::occluded(const Ray& ray) -> bool
+{
+    ERHE_PROFILE_FUNCTION();
+
+    return occluded_scene(ray);
+}
+
+auto Tinybvh_scene::intersect_batch(std::span<Ray> rays, std::span<Hit> hits) -> std::size_t
+{
+    ERHE_PROFILE_FUNCTION();
+    ERHE_VERIFY(hits.size() >= rays.size());
+
+    // tinybvh packet traversal (Intersect256Rays) needs coherent 16x16 tiles
+    // from one origin, which arbitrary batches are not; rays are traced one
+    // by one, split over the raytrace executor.
+    return for_each_ray_range(
+        rays.size(),
+        [this, rays, hits](const std::size_t begin, const std::size_t end) -> std::size_t {
+            std::size_t hit_count = 0;
+            for (std::size_t i = begin; i < end; ++i) {
+                hits[i] = Hit{};
+                if (intersect_closest(rays[i], hits[i])) {
+                    ++hit_count;
+                }
+            }
+            return hit_count;
+        }
+    );
+}
+
+auto Tinybvh_scene::occluded_batch(std::span<const Ray> rays, std::span<uint8_t> out_occluded) -> std::size_t
+{
+    ERHE_PROFILE_FUNCTION();
+    ERHE_VERIFY(out_occluded.size() >= rays.size());
+
+    return for_each_ray_range(
+        rays.size(),
+        [this, rays, out_occluded](const std::size_t begin, const std::size_t end) -> std::size_t {
+            std::size_t occluded_count = 0;
+            for (std::size_t i = begin; i < end; ++i) {
+                const bool is_occluded = occluded_scene(rays[i]);
+                out_occluded[i] = is_occluded ? 1 : 0;
+                if (is_occluded) {
+                    ++occluded_count;
+                }
+            }
+            return occluded_count;
+        }
+    );
+}
+
+auto Tinybvh_scene::intersect_closest(Ray& ray, Hit& hit) -> bool
+{
     if (s_use_tlas && m_tlas_valid && !m_tlas_data->instances.empty()) {
         // Use TLAS for instances, then linear scan for direct geometries
         bool is_hit = intersect_tlas(ray, hit);
@@ -243,16 +301,19 @@ auto Tinybvh_scene::intersect_tlas(Ray& ray, Hit& hit) -> bool
 
     Tlas_data& td = *m_tlas_data;
 
-    tinybvh::Ray tinybvh_ray{
-        tinybvh::bvhvec3{ray.origin.x,    ray.origin.y,    ray.origin.z},
-        tinybvh::bvhvec3{ray.direction.x, ray.direction.y, ray.direction.z},
-        ray.t_far,
-        ray.mask
-    };
+    const Tinybvh_ray_space ray_space{ray};
+    if (ray_space.is_empty(ray)) {
+        return false;
+    }
+    tinybvh::Ray tinybvh_ray = ray_space.make_masked_ray(ray);
 
+    // A miss leaves hit.t at the ray's initial extent. Compare in tinybvh
+    // space: converting back can round below ray.t_far.
+    const float tinybvh_t_far = tinybvh_ray.hit.t;
     td.tlas.Intersect(tinybvh_ray);
 
-    if (tinybvh_ray.hit.t < ray.t_far) {
+    const float t_original_space = ray_space.from_tinybvh_t(tinybvh_ray.hit.t);
+    if (tinybvh_ray.hit.t < tinybvh_t_far) {
         const uint32_t tlas_instance_index = tinybvh_ray.hit.inst;
         const uint32_t prim_id             = tinybvh_ray.hit.prim;
 
@@ -275,7 +336,7 @@ auto Tinybvh_scene::intersect_tlas(Ray& ray, Hit& hit) -> bool
                 local_normal = glm::cross(edge1, edge2);
             }
 
-            ray.t_far       = tinybvh_ray.hit.t;
+            ray.t_far       = t_original_space;
             hit.triangle_id = prim_id;
             hit.uv          = glm::vec2{tinybvh_ray.hit.u, tinybvh_ray.hit.v};
             // Cofactor matrix, not the instance transform: see the note in
@@ -322,6 +383,51 @@ auto Tinybvh_scene::intersect_instance(Ray& ray, Hit& hit, Tinybvh_instance* in_
     return is_hit;
 }
 
+auto Tinybvh_scene::occluded_scene(const Ray& ray) -> bool
+{
+    // Same traversal split as intersect_closest(), stopping at the first hit.
+    if (s_use_tlas && m_tlas_valid && !m_tlas_data->instances.empty()) {
+        if (occluded_tlas(ray)) {
+            return true;
+        }
+        for (Tinybvh_geometry* geometry : m_geometries) {
+            if (geometry->occluded(ray)) {
+                return true;
+            }
+        }
+        return false;
+    }
+    return occluded_instance(ray);
+}
+
+auto Tinybvh_scene::occluded_tlas(const Ray& ray) -> bool
+{
+    ERHE_PROFILE_FUNCTION();
+
+    const Tinybvh_ray_space ray_space{ray};
+    if (ray_space.is_empty(ray)) {
+        return false;
+    }
+    return m_tlas_data->tlas.IsOccluded(ray_space.make_masked_ray(ray));
+}
+
+auto Tinybvh_scene::occluded_instance(const Ray& ray) -> bool
+{
+    // Linear scan, like intersect_instance(): the TLAS only covers the top
+    // level scene.
+    for (Tinybvh_instance* instance : m_instances) {
+        if (instance->occluded(ray)) {
+            return true;
+        }
+    }
+    for (Tinybvh_geometry* geometry : m_geometries) {
+        if (geometry->occluded(ray)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 auto Tinybvh_scene::debug_label() const -> std::string_view
 {
     return m_debug_label;
@@ -27,17 +27,24 @@ public:
     void detach     (IInstance* instance)        override;
     void commit     ()                           override;
     auto intersect  (Ray& ray, Hit& hit) -> bool override;
+    auto occluded   (const Ray& ray) -> bool     override;
+    auto intersect_batch(std::span<Ray> rays, std::span<Hit> hits) -> std::size_t override;
+    auto occluded_batch (std::span<const Ray> rays, std::span<uint8_t> out_occluded) -> std::size_t override;
     auto debug_label() const -> std::string_view override;
 
     // Tinybvh_scene public API
     auto intersect_instance(Ray& ray, Hit& hit, Tinybvh_instance* instance) -> bool;
+    auto occluded_instance (const Ray& ray) -> bool;
 
     // TLAS configuration
     static bool s_use_tlas;
 
 private:
-    auto intersect_linear(Ray& ray, Hit& hit) -> bool;
-    auto intersect_tlas  (Ray& ray, Hit& hit) -> bool;
+    auto intersect_closest(Ray& ray, Hit& hit) -> bool;
+    auto intersect_linear (Ray& ray, Hit& hit) -> bool;
+    auto intersect_tlas   (Ray& ray, Hit& hit) -> bool;
+    auto occluded_scene   (const Ray& ray) -> bool;
+    auto occluded_tlas    (const Ray& ray) -> bool;
     void build_tlas();
 
     std::vector<Tinybvh_geometry*> m_geometries;
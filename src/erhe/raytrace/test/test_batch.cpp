@@ -0,0 +1,135 @@
+#include "test_helpers.hpp"
+
+#include <taskflow/taskflow.hpp>
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace {
+
+using namespace erhe::raytrace;
+using namespace erhe::raytrace::test;
+
+// Eight cube instances in a 4 x 2 grid, two units apart, in the z = 0 plane.
+class Batch_fixture
+{
+public:
+    Batch_fixture()
+        : cube       {make_cube()}
+        , child_scene{IScene::create_unique("child")}
+        , root_scene {IScene::create_unique("root")}
+    {
+        child_scene->attach(cube.geometry.get());
+        child_scene->commit();
+        for (int i = 0; i < 8; ++i) {
+            const glm::vec3 position{2.0f * static_cast<float>(i % 4), 2.0f * static_cast<float>(i / 4), 0.0f};
+            std::unique_ptr<IInstance> instance = IInstance::create_unique("cube");
+            instance->set_scene(child_scene.get());
+            instance->set_transform(glm::translate(glm::mat4{1.0f}, position));
+            instance->set_mask(0xffffffffu);
+            instance->commit();
+            root_scene->attach(instance.get());
+            instances.push_back(std::move(instance));
+        }
+        root_scene->commit();
+    }
+
+    Test_geometry                           cube;
+    std::unique_ptr<IScene>                 child_scene;
+    std::unique_ptr<IScene>                 root_scene;
+    std::vector<std::unique_ptr<IInstance>> instances;
+};
+
+// Rays down the -z axis over a grid covering the cubes and the gaps between
+// them. Every third ray is too short to reach the cubes.
+auto make_grid_rays(const std::size_t count) -> std::vector<Ray>
+{
+    std::vector<Ray> rays;
+    rays.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const float x = -1.0f + 9.0f * static_cast<float>(i % 61) / 60.0f;
+        const float y = -1.0f + 4.0f * static_cast<float>((i / 61) % 37) / 36.0f;
+        const float t_far = ((i % 3) == 0) ? 2.0f : 1000.0f;
+        rays.push_back(make_ray({x, y, 5.0f}, {0.0f, 0.0f, -1.0f}, t_far));
+    }
+    return rays;
+}
+
+void expect_batch_matches_single_rays(IScene& scene, const std::size_t count)
+{
+    const std::vector<Ray> reference_rays = make_grid_rays(count);
+
+    std::vector<Ray> rays = reference_rays;
+    std::vector<Hit> hits(count);
+    const std::size_t hit_count = scene.intersect_batch(rays, hits);
+
+    std::vector<uint8_t> occluded(count, 2);
+    const std::size_t occluded_count = scene.occluded_batch(reference_rays, occluded);
+
+    std::size_t expected_hit_count = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        Ray        ray    = reference_rays[i];
+        Hit        hit{};
+        const bool is_hit = scene.intersect(ray, hit);
+        if (is_hit) {
+            ++expected_hit_count;
+            EXPECT_FLOAT_EQ(rays[i].t_far, ray.t_far) << "ray " << i;
+            EXPECT_EQ(hits[i].triangle_id, hit.triangle_id) << "ray " << i;
+            EXPECT_EQ(hits[i].instance, hit.instance) << "ray " << i;
+            EXPECT_EQ(hits[i].geometry, hit.geometry) << "ray " << i;
+        } else {
+            EXPECT_FLOAT_EQ(rays[i].t_far, reference_rays[i].t_far) << "ray " << i;
+            EXPECT_EQ(hits[i].instance, nullptr) << "ray " << i;
+            EXPECT_EQ(hits[i].geometry, nullptr) << "ray " << i;
+        }
+        EXPECT_EQ(occluded[i], is_hit ? 1 : 0) << "ray " << i;
+    }
+    EXPECT_EQ(hit_count, expected_hit_count);
+    EXPECT_EQ(occluded_count, expected_hit_count);
+}
+
+TEST(Batch, EmptyBatch)
+{
+    Batch_fixture fixture;
+    EXPECT_EQ(fixture.root_scene->intersect_batch(std::span<Ray>{}, std::span<Hit>{}), 0u);
+    EXPECT_EQ(fixture.root_scene->occluded_batch(std::span<const Ray>{}, std::span<uint8_t>{}), 0u);
+}
+
+TEST(Batch, PartialPacketMatchesSingleRays)
+{
+    Batch_fixture fixture;
+    expect_batch_matches_single_rays(*fixture.root_scene, 37);
+}
+
+TEST(Batch, LargeBatchMatchesSingleRays)
+{
+    Batch_fixture fixture;
+    expect_batch_matches_single_rays(*fixture.root_scene, 2257);
+}
+
+TEST(Batch, ParallelSplitMatchesSingleRays)
+{
+    tf::Executor    executor{4};
+    Scoped_executor scoped_executor{executor};
+
+    Batch_fixture fixture;
+    expect_batch_matches_single_rays(*fixture.root_scene, 2257);
+}
+
+TEST(Batch, BatchInsideExecutorTask)
+{
+    // A batch issued from an executor worker must corun, not block the
+    // worker waiting for tasks only it could run.
+    tf::Executor    executor{1};
+    Scoped_executor scoped_executor{executor};
+
+    Batch_fixture fixture;
+    tf::Taskflow taskflow;
+    taskflow.emplace([&fixture]() {
+        expect_batch_matches_single_rays(*fixture.root_scene, 2257);
+    });
+    executor.run(taskflow).wait();
+}
+
+} // anonymous namespace
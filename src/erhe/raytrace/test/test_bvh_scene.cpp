@@ -6,7 +6,6 @@
 #include "test_helpers.hpp"
 
 #include "erhe_raytrace/bvh/bvh_scene.hpp"
-#include "erhe_raytrace/raytrace_executor.hpp"
 
 #include <taskflow/taskflow.hpp>
 
@@ -518,21 +517,6 @@ TEST(Bvh_scene, DisabledMemberStaysInTlasButIsNotHit)
     }
 }
 
-// Sets the raytrace executor for the duration of a test, so that a failing
-// assertion cannot leave a dangling executor behind for the tests after it.
-class Scoped_executor
-{
-public:
-    explicit Scoped_executor(tf::Executor& executor)
-    {
-        erhe::raytrace::set_executor(&executor);
-    }
-    ~Scoped_executor()
-    {
-        erhe::raytrace::set_executor(nullptr);
-    }
-};
-
 TEST(Bvh_scene, AsyncTlasBuild)
 {
     tf::Executor    executor{2};
@@ -6,6 +6,7 @@
 #include "erhe_raytrace/iinstance.hpp"
 #include "erhe_raytrace/iscene.hpp"
 #include "erhe_raytrace/ray.hpp"
+#include "erhe_raytrace/raytrace_executor.hpp"
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -150,4 +151,19 @@ inline auto make_ray(const glm::vec3& origin, const glm::vec3& direction, float
     return ray;
 }
 
+// Sets the raytrace executor for the duration of a test, so that a failing
+// assertion cannot leave a dangling executor behind for the tests after it.
+class Scoped_executor
+{
+public:
+    explicit Scoped_executor(tf::Executor& executor)
+    {
+        erhe::raytrace::set_executor(&executor);
+    }
+    ~Scoped_executor()
+    {
+        erhe::raytrace::set_executor(nullptr);
+    }
+};
+
 } // namespace erhe::raytrace::test
@@ -0,0 +1,214 @@
+#include "test_helpers.hpp"
+
+#include <gtest/gtest.h>
+
+namespace {
+
+using namespace erhe::raytrace;
+using namespace erhe::raytrace::test;
+
+TEST(Occluded, GeometryHitAndMiss)
+{
+    Test_geometry tg = make_unit_triangle();
+
+    EXPECT_TRUE (tg.geometry->occluded(make_ray({0.25f, 0.25f, 1.0f}, {0.0f, 0.0f, -1.0f})));
+    EXPECT_FALSE(tg.geometry->occluded(make_ray({2.0f,  2.0f,  1.0f}, {0.0f, 0.0f, -1.0f})));
+    // Occluder beyond t_far does not count.
+    EXPECT_FALSE(tg.geometry->occluded(make_ray({0.25f, 0.25f, 1.0f}, {0.0f, 0.0f, -1.0f}, 0.5f)));
+}
+
+TEST(Occluded, GeometryMaskAndDisable)
+{
+    Test_geometry tg = make_unit_triangle();
+    tg.geometry->set_mask(0x2u);
+
+    Ray ray = make_ray({0.25f, 0.25f, 1.0f}, {0.0f, 0.0f, -1.0f});
+    ray.mask = 0x1u;
+    EXPECT_FALSE(tg.geometry->occluded(ray));
+    ray.mask = 0x2u;
+    EXPECT_TRUE(tg.geometry->occluded(ray));
+
+    tg.geometry->disable();
+    EXPECT_FALSE(tg.geometry->occluded(ray));
+    tg.geometry->enable();
+    EXPECT_TRUE(tg.geometry->occluded(ray));
+}
+
+TEST(Occluded, SceneDoesNotModifyRay)
+{
+    Test_geometry tg = make_quad();
+    auto scene = IScene::create_unique("scene");
+    scene->attach(tg.geometry.get());
+    scene->commit();
+
+    const Ray ray = make_ray({0.5f, 0.5f, 1.0f}, {0.0f, 0.0f, -1.0f});
+    EXPECT_TRUE(scene->occluded(ray));
+    EXPECT_FLOAT_EQ(ray.t_far, 1000.0f);
+}
+
+TEST(Occluded, InstanceTransformAndMask)
+{
+    Test_geometry tg = make_unit_triangle();
+
+    auto child_scene = IScene::create_unique("child");
+    child_scene->attach(tg.geometry.get());
+    child_scene->commit();
+
+    auto instance = IInstance::create_unique("inst");
+    instance->set_scene(child_scene.get());
+    instance->set_transform(glm::translate(glm::mat4{1.0f}, glm::vec3{5.0f, 0.0f, 0.0f}));
+    instance->set_mask(0x4u);
+    instance->commit();
+
+    auto root_scene = IScene::create_unique("root");
+    root_scene->attach(instance.get());
+    root_scene->commit();
+
+    Ray ray = make_ray({5.25f, 0.25f, 1.0f}, {0.0f, 0.0f, -1.0f});
+    EXPECT_TRUE (instance  ->occluded(ray));
+    EXPECT_TRUE (root_scene->occluded(ray));
+    EXPECT_FALSE(root_scene->occluded(make_ray({0.25f, 0.25f, 1.0f}, {0.0f, 0.0f, -1.0f})));
+
+    ray.mask = 0x1u;
+    EXPECT_FALSE(instance  ->occluded(ray));
+    EXPECT_FALSE(root_scene->occluded(ray));
+}
+
+TEST(Occluded, NestedInstances)
+{
+    Test_geometry tg = make_cube();
+
+    auto leaf_scene = IScene::create_unique("leaf");
+    leaf_scene->attach(tg.geometry.get());
+    leaf_scene->commit();
+
+    auto inner = IInstance::create_unique("inner");
+    inner->set_scene(leaf_scene.get());
+    inner->set_transform(glm::translate(glm::mat4{1.0f}, glm::vec3{0.0f, 3.0f, 0.0f}));
+    inner->set_mask(0xffffffffu);
+    inner->commit();
+
+    auto middle_scene = IScene::create_unique("middle");
+    middle_scene->attach(inner.get());
+    middle_scene->commit();
+
+    auto outer = IInstance::create_unique("outer");
+    outer->set_scene(middle_scene.get());
+    outer->set_transform(glm::translate(glm::mat4{1.0f}, glm::vec3{4.0f, 0.0f, 0.0f}));
+    outer->set_mask(0xffffffffu);
+    outer->commit();
+
+    auto root_scene = IScene::create_unique("root");
+    root_scene->attach(outer.get());
+    root_scene->commit();
+
+    EXPECT_TRUE (root_scene->occluded(make_ray({4.0f, 3.0f, 5.0f}, {0.0f, 0.0f, -1.0f})));
+    EXPECT_FALSE(root_scene->occluded(make_ray({4.0f, 0.0f, 5.0f}, {0.0f, 0.0f, -1.0f})));
+    EXPECT_FALSE(root_scene->occluded(make_ray({4.0f, 3.0f, 5.0f}, {0.0f, 0.0f, -1.0f}, 4.0f)));
+}
+
+TEST(Occluded, MatchesIntersect)
+{
+    // Two overlapping quads and a cube; any-hit must agree with closest-hit
+    // on whether something was hit, for rays that pass through several
+    // occluders, one, or none.
+    Test_geometry quad = make_quad();
+    Test_geometry cube = make_cube();
+
+    auto child_scene = IScene::create_unique("child");
+    child_scene->attach(quad.geometry.get());
+    child_scene->commit();
+
+    auto near_instance = IInstance::create_unique("near");
+    near_instance->set_scene(child_scene.get());
+    near_instance->set_transform(glm::translate(glm::mat4{1.0f}, glm::vec3{0.0f, 0.0f, 1.0f}));
+    near_instance->set_mask(0xffffffffu);
+    near_instance->commit();
+
+    auto far_instance = IInstance::create_unique("far");
+    far_instance->set_scene(child_scene.get());
+    far_instance->set_transform(glm::translate(glm::mat4{1.0f}, glm::vec3{0.5f, 0.5f, -1.0f}));
+    far_instance->set_mask(0xffffffffu);
+    far_instance->commit();
+
+    auto root_scene = IScene::create_unique("root");
+    root_scene->attach(near_instance.get());
+    root_scene->attach(far_instance.get());
+    root_scene->attach(cube.geometry.get());
+    root_scene->commit();
+
+    for (int y = -4; y <= 8; ++y) {
+        for (int x = -4; x <= 8; ++x) {
+            const glm::vec3 origin{0.15f * static_cast<float>(x), 0.15f * static_cast<float>(y), 3.0f};
+            for (const float t_far : {1.5f, 2.7f, 1000.0f}) {
+                Ray ray = make_ray(origin, {0.0f, 0.0f, -1.0f}, t_far);
+                Hit hit{};
+                const bool is_occluded = root_scene->occluded(ray);
+                EXPECT_EQ(is_occluded, root_scene->intersect(ray, hit)) << "x = " << x << " y = " << y << " t_far = " << t_far;
+            }
+        }
+    }
+}
+
+TEST(Occluded, RespectsTNear)
+{
+    Test_geometry tg = make_unit_triangle();
+    auto scene = IScene::create_unique("scene");
+    scene->attach(tg.geometry.get());
+    scene->commit();
+
+    // Occluder at t = 1: inside [0.5, 1000], outside [1.5, 1000].
+    Ray ray = make_ray({0.25f, 0.25f, 1.0f}, {0.0f, 0.0f, -1.0f});
+    ray.t_near = 0.5f;
+    EXPECT_TRUE(tg.geometry->occluded(ray));
+    EXPECT_TRUE(scene->occluded(ray));
+    ray.t_near = 1.5f;
+    EXPECT_FALSE(tg.geometry->occluded(ray));
+    EXPECT_FALSE(scene->occluded(ray));
+
+    Hit hit{};
+    EXPECT_FALSE(scene->intersect(ray, hit));
+    ray.t_near = 0.5f;
+    EXPECT_TRUE(scene->intersect(ray, hit));
+    EXPECT_NEAR(ray.t_far, 1.0f, 1.0e-5f);
+}
+
+TEST(Occluded, NonUnitDirectionThroughInstance)
+{
+    // Top level instances take the TLAS path where the backend has one; t
+    // must mean the same there as for geometry, in units of the direction.
+    Test_geometry tg = make_quad();
+
+    auto child_scene = IScene::create_unique("child");
+    child_scene->attach(tg.geometry.get());
+    child_scene->commit();
+
+    auto instance = IInstance::create_unique("inst");
+    instance->set_scene(child_scene.get());
+    instance->set_transform(glm::translate(glm::mat4{1.0f}, glm::vec3{0.0f, 0.0f, -2.0f}));
+    instance->set_mask(0xffffffffu);
+    instance->commit();
+
+    auto root_scene = IScene::create_unique("root");
+    root_scene->attach(instance.get());
+    root_scene->commit();
+
+    // Quad at z = -2, origin at z = 2, direction length 4: hit at t = 1.
+    const glm::vec3 origin   {0.5f, 0.5f, 2.0f};
+    const glm::vec3 direction{0.0f, 0.0f, -4.0f};
+    for (const float t_far : {0.9f, 1.1f}) {
+        for (const float t_near : {0.0f, 0.5f, 1.05f}) {
+            Ray ray = make_ray(origin, direction, t_far);
+            ray.t_near = t_near;
+            const bool expected = (t_near < 1.0f) && (1.0f < t_far);
+            Hit hit{};
+            EXPECT_EQ(root_scene->occluded(ray), expected) << "t_near = " << t_near << " t_far = " << t_far;
+            EXPECT_EQ(root_scene->intersect(ray, hit), expected) << "t_near = " << t_near << " t_far = " << t_far;
+            if (expected) {
+                EXPECT_NEAR(ray.t_far, 1.0f, 1.0e-5f);
+            }
+        }
+    }
+}
+
+} // anonymous namespace
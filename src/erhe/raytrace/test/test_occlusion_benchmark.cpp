@@ -0,0 +1,154 @@
+// Closest hit vs any hit microbenchmark (see erhe_benchmark/benchmark.hpp
+// for running it). The scene is a stack of tessellated planes, so a ray straight down passes
+// through every layer: closest hit has to search all of them for the nearest
+// one, any hit can stop at the first triangle it meets.
+
+#include "test_helpers.hpp"
+
+#include "erhe_benchmark/benchmark.hpp"
+
+#include <fmt/format.h>
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace {
+
+using namespace erhe::raytrace;
+using namespace erhe::raytrace::test;
+using erhe::benchmark::time_ms;
+
+// size x size quads in the XY plane, covering [0, 1] x [0, 1].
+auto make_grid(const uint32_t size) -> Test_geometry
+{
+    std::vector<glm::vec3>  vertices;
+    std::vector<glm::uvec3> triangles;
+    const float scale = 1.0f / static_cast<float>(size);
+    for (uint32_t y = 0; y <= size; ++y) {
+        for (uint32_t x = 0; x <= size; ++x) {
+            vertices.push_back(glm::vec3{scale * static_cast<float>(x), scale * static_cast<float>(y), 0.0f});
+        }
+    }
+    const uint32_t row = size + 1;
+    for (uint32_t y = 0; y < size; ++y) {
+        for (uint32_t x = 0; x < size; ++x) {
+            const uint32_t i = y * row + x;
+            triangles.push_back(glm::uvec3{i, i + 1, i + row + 1});
+            triangles.push_back(glm::uvec3{i, i + row + 1, i + row});
+        }
+    }
+    return make_triangle_geometry("grid", vertices, triangles);
+}
+
+class Layered_scene
+{
+public:
+    explicit Layered_scene(const int layer_count)
+        : grid       {make_grid(128)}
+        , child_scene{IScene::create_unique("grid")}
+        , root_scene {IScene::create_unique("layers")}
+    {
+        child_scene->attach(grid.geometry.get());
+        child_scene->commit();
+        for (int i = 0; i < layer_count; ++i) {
+            std::unique_ptr<IInstance> instance = IInstance::create_unique("layer");
+            instance->set_scene(child_scene.get());
+            instance->set_transform(
+                glm::scale(
+                    glm::translate(glm::mat4{1.0f}, glm::vec3{-8.0f, -8.0f, -static_cast<float>(i)}),
+                    glm::vec3{16.0f, 16.0f, 1.0f}
+                )
+            );
+            instance->set_mask(0xffffffffu);
+            instance->commit();
+            root_scene->attach(instance.get());
+            instances.push_back(std::move(instance));
+        }
+        // The bvh backend builds its scene level BVH only for children that
+        // stayed unmodified for a while: commit until it has.
+        for (int i = 0; i < 64; ++i) {
+            root_scene->commit();
+        }
+    }
+
+    Test_geometry                           grid;
+    std::unique_ptr<IScene>                 child_scene;
+    std::unique_ptr<IScene>                 root_scene;
+    std::vector<std::unique_ptr<IInstance>> instances;
+};
+
+auto make_rays(const std::size_t count) -> std::vector<Ray>
+{
+    std::vector<Ray> rays;
+    rays.reserve(count);
+    uint32_t state = 0x12345678u;
+    const auto next = [&state]() -> float {
+        state = state * 1664525u + 1013904223u;
+        return static_cast<float>(state >> 8) / static_cast<float>(1u << 24);
+    };
+    for (std::size_t i = 0; i < count; ++i) {
+        const glm::vec3 origin   {-7.0f + 14.0f * next(), -7.0f + 14.0f * next(), 5.0f};
+        const glm::vec3 direction{0.2f * (next() - 0.5f), 0.2f * (next() - 0.5f), -1.0f};
+        rays.push_back(make_ray(origin, direction));
+    }
+    return rays;
+}
+
+ERHE_BENCHMARK(Occlusion, closest_hit_vs_any_hit)
+{
+    constexpr std::size_t ray_count = 1u << 16;
+    constexpr int         repeat    = 5;
+
+    const std::vector<Ray> rays = make_rays(ray_count);
+
+    fmt::print("\n{:>7} {:>14} {:>14} {:>8} {:>14} {:>14}\n", "layers", "closest ms", "any ms", "ratio", "closest batch", "any batch");
+    for (const int layer_count : {1, 4, 16}) {
+        Layered_scene scene{layer_count};
+
+        std::size_t closest_hit_count = 0;
+        std::size_t any_hit_count     = 0;
+        double closest_ms       = 0.0;
+        double any_ms           = 0.0;
+        double closest_batch_ms = 0.0;
+        double any_batch_ms     = 0.0;
+        std::vector<Ray>     batch_rays;
+        std::vector<Hit>     hits(ray_count);
+        std::vector<uint8_t> occluded(ray_count);
+        for (int r = 0; r < repeat; ++r) {
+            closest_hit_count = 0;
+            any_hit_count     = 0;
+            closest_ms += time_ms([&]() {
+                for (const Ray& source : rays) {
+                    Ray ray = source;
+                    Hit hit{};
+                    if (scene.root_scene->intersect(ray, hit)) {
+                        ++closest_hit_count;
+                    }
+                }
+            });
+            any_ms += time_ms([&]() {
+                for (const Ray& ray : rays) {
+                    if (scene.root_scene->occluded(ray)) {
+                        ++any_hit_count;
+                    }
+                }
+            });
+            batch_rays = rays;
+            closest_batch_ms += time_ms([&]() { scene.root_scene->intersect_batch(batch_rays, hits); });
+            any_batch_ms     += time_ms([&]() { scene.root_scene->occluded_batch (rays, occluded); });
+        }
+        EXPECT_EQ(closest_hit_count, any_hit_count);
+
+        fmt::print(
+            "{:>7} {:>14.3f} {:>14.3f} {:>8.2f} {:>14.3f} {:>14.3f}\n",
+            layer_count,
+            closest_ms / repeat,
+            any_ms / repeat,
+            (any_ms > 0.0) ? (closest_ms / any_ms) : 0.0,
+            closest_batch_ms / repeat,
+            any_batch_ms / repeat
+        );
+    }
+}
+
+} // anonymous namespace
@@ -104,7 +104,8 @@ Text_renderer::Text_renderer(
     erhe::graphics::Command_buffer& init_command_buffer,
     const bool                      enabled,
     const int                       font_size,
-    const int                       view_count
+    const int                       view_count,
+    const bool                      glyph_cache
 )
     : m_graphics_device          {graphics_device}
     , m_view_count           {std::max(1, view_count)}
@@ -237,8 +238,9 @@ Text_renderer::Text_renderer(
 {
     ERHE_PROFILE_FUNCTION();
 
-    config.enabled   = enabled;
-    config.font_size = font_size;
+    config.enabled     = enabled;
+    config.font_size   = font_size;
+    config.glyph_cache = glyph_cache;
 
     if (m_view_count >= 2) {
         m_multiview_shader_stages.emplace(
@@ -264,7 +266,8 @@ Text_renderer::Text_renderer(
         init_command_buffer,
         "res/fonts/SourceSansPro-Regular.otf",
         config.font_size,
-        0.0f // TODO reimplement outline better 1.0f
+        0.0f, // TODO reimplement outline better 1.0f
+        config.glyph_cache
     );
 
     if (m_use_buffer_texture) {
@@ -359,6 +362,14 @@ void Text_renderer::print(const glm::vec3 text_position, const uint32_t text_col
     vertex_buffer_range.bytes_written(quad_count_printed * 4 * vertex_stride);
 }
 
+void Text_renderer::upload_glyphs(erhe::graphics::Command_buffer& command_buffer)
+{
+    if (!config.enabled || !m_font) {
+        return;
+    }
+    m_font->upload_glyphs(command_buffer);
+}
+
 auto Text_renderer::font_size() -> float
 {
     return static_cast<float>(config.font_size);
@@ -43,8 +43,9 @@ public:
     class Config
     {
     public:
-        bool enabled{true};
-        int  font_size{14};
+        bool enabled    {true};
+        int  font_size  {14};
+        bool glyph_cache{false}; // see erhe::ui::Font use_glyph_cache_file
     };
     Config config;
 
@@ -54,12 +55,15 @@ public:
     // it appear on every layer in one draw. Default 1 keeps existing
     // single-view callers unchanged. Mirrors the pattern used by
     // Content_wide_line_renderer / Debug_renderer.
+    // glyph_cache: keep the font's rasterized glyphs in a file under
+    // cache/fonts/ between runs.
     Text_renderer(
         erhe::graphics::Device&         graphics_device,
         erhe::graphics::Command_buffer& init_command_buffer,
-        bool                            enabled        = true,
-        int                             font_size      = 14,
-        int                             view_count = 1
+        bool                            enabled     = true,
+        int                             font_size   = 14,
+        int                             view_count  = 1,
+        bool                            glyph_cache = false
     );
     ~Text_renderer() noexcept;
 
@@ -70,6 +74,10 @@ public:
 
     // Public API
     void print(glm::vec3 text_position, uint32_t text_color, std::string_view text);
+    // Uploads glyphs that print() / measure() rasterized since the previous
+    // call; print() skips them until then. Must be called outside of a
+    // render pass, before the render() that draws the text.
+    void upload_glyphs(erhe::graphics::Command_buffer& command_buffer);
     [[nodiscard]] auto font_size() -> float;
     [[nodiscard]] auto measure  (std::string_view text) const -> erhe::ui::Rectangle;
 
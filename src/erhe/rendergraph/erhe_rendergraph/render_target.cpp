@@ -1,5 +1,8 @@
 #include "erhe_rendergraph/render_target.hpp"
+#include "erhe_rendergraph/rendergraph.hpp"
 #include "erhe_rendergraph/rendergraph_log.hpp"
+#include "erhe_rendergraph/rendergraph_node.hpp"
+#include "erhe_rendergraph/transient_texture_pool.hpp"
 #include "erhe_graphics/device.hpp"
 #include "erhe_graphics/gpu_timer.hpp"
 #include "erhe_graphics/render_pass.hpp"
@@ -16,6 +19,8 @@ Render_target::Render_target(const Render_target_create_info& create_info)
     , m_depth_stencil_format{create_info.depth_stencil_format}
     , m_sample_count       {create_info.sample_count}
     , m_store_depth_stencil{create_info.store_depth_stencil}
+    , m_transient_owner    {create_info.transient_owner}
+    , m_transient_key      {create_info.transient_key}
 {
 }
 
@@ -43,6 +48,35 @@ void Render_target::reconfigure(int sample_count)
     m_render_pass.reset();
 }
 
+auto Render_target::make_texture(
+    const void*                                slot,
+    const bool                                 whole_lifetime,
+    const erhe::graphics::Texture_create_info& create_info
+) -> std::shared_ptr<erhe::graphics::Texture>
+{
+    if (!m_transient_active) {
+        return std::make_shared<erhe::graphics::Texture>(m_graphics_device, create_info);
+    }
+    return m_transient_owner->get_rendergraph().get_transient_texture_pool().acquire(
+        slot,
+        m_transient_first_use,
+        whole_lifetime ? m_transient_last_use : m_transient_first_use,
+        create_info
+    );
+}
+
+void Render_target::release_transient_textures()
+{
+    if (!m_transient_active) {
+        return;
+    }
+    Transient_texture_pool& pool = m_transient_owner->get_rendergraph().get_transient_texture_pool();
+    pool.release(&m_color_texture);
+    pool.release(&m_multisampled_color_texture);
+    pool.release(&m_depth_stencil_texture);
+    m_transient_active = false;
+}
+
 void Render_target::update(int width, int height, erhe::graphics::Swapchain* swapchain)
 {
     ERHE_PROFILE_FUNCTION();
@@ -68,6 +102,7 @@ void Render_target::update(int width, int height, erhe::graphics::Swapchain* swa
 
     if ((width < 1) || (height < 1)) {
         if (m_render_pass) {
+            release_transient_textures();
             m_gpu_timer.reset();
             m_color_texture.reset();
             m_multisampled_color_texture.reset();
@@ -77,11 +112,27 @@ void Render_target::update(int width, int height, erhe::graphics::Swapchain* swa
         return;
     }
 
+    // A transient render target follows its output's lifetime, which moves
+    // whenever the graph is sorted again. Without a lifetime (graph not
+    // sorted, output not registered) it falls back to textures of its own.
+    const Rendergraph_output_lifetime* lifetime = (m_transient_owner != nullptr)
+        ? m_transient_owner->get_rendergraph().get_output_lifetime(m_transient_owner, m_transient_key)
+        : nullptr;
+    const bool transient_changed = (lifetime == nullptr)
+        ? m_transient_active
+        : (
+            !m_transient_active ||
+            (m_transient_serial    != m_transient_owner->get_rendergraph().get_transient_texture_pool().get_serial()) ||
+            (m_transient_first_use != lifetime->first_use) ||
+            (m_transient_last_use  != lifetime->last_use)
+        );
+
     // Resize framebuffer if necessary
     if (
         !m_color_texture ||
         (m_color_texture->get_width () != width ) ||
-        (m_color_texture->get_height() != height)
+        (m_color_texture->get_height() != height) ||
+        transient_changed
     ) {
         log_tail->trace(
             "Resizing Render_target '{}' to {} x {}",
@@ -90,11 +141,21 @@ void Render_target::update(int width, int height, erhe::graphics::Swapchain* swa
             height
         );
 
+        release_transient_textures();
+        if (lifetime != nullptr) {
+            m_transient_active    = true;
+            m_transient_serial    = m_transient_owner->get_rendergraph().get_transient_texture_pool().get_serial();
+            m_transient_first_use = lifetime->first_use;
+            m_transient_last_use  = lifetime->last_use;
+        }
+
         m_multisampled_color_texture.reset();
         m_color_texture.reset();
         if (m_sample_count > 1) {
-            m_multisampled_color_texture = std::make_shared<Texture>(
-                m_graphics_device,
+            // Resolved within the pass, never read after it
+            m_multisampled_color_texture = make_texture(
+                &m_multisampled_color_texture,
+                false,
                 erhe::graphics::Texture_create_info{
                     .device       = m_graphics_device,
                     .usage_mask   =
@@ -114,8 +175,9 @@ void Render_target::update(int width, int height, erhe::graphics::Swapchain* swa
             );
         }
 
-        m_color_texture = std::make_shared<Texture>(
-            m_graphics_device,
+        m_color_texture = make_texture(
+            &m_color_texture,
+            true,
             erhe::graphics::Texture_create_info{
                 .device       = m_graphics_device,
                 .usage_mask   =
@@ -141,8 +203,9 @@ void Render_target::update(int width, int height, erhe::graphics::Swapchain* swa
         if (m_depth_stencil_format == erhe::dataformat::Format::format_undefined) {
             m_depth_stencil_texture.reset();
         } else {
-            m_depth_stencil_texture = std::make_unique<erhe::graphics::Texture>(
-                m_graphics_device,
+            m_depth_stencil_texture = make_texture(
+                &m_depth_stencil_texture,
+                m_store_depth_stencil,
                 erhe::graphics::Texture_create_info{
                     .device       = m_graphics_device,
                     .usage_mask   =
@@ -3,6 +3,8 @@
 #include "erhe_dataformat/dataformat.hpp"
 #include "erhe_utility/debug_label.hpp"
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -12,10 +14,13 @@ namespace erhe::graphics {
     class Render_pass;
     class Swapchain;
     class Texture;
+    class Texture_create_info;
 }
 
 namespace erhe::rendergraph {
 
+class Rendergraph_node;
+
 class Render_target_create_info
 {
 public:
@@ -29,6 +34,16 @@ public:
     // depth-test against this render target's content. Used by the editor's
     // post-processing overlay pass (issue #230).
     bool                       store_depth_stencil  {false};
+    // When set, the textures come from the rendergraph's
+    // Transient_texture_pool and may be shared with render targets of other
+    // nodes whose outputs are not live at the same time. The color texture
+    // lives over the lifetime of transient_owner's transient_key output,
+    // the multisampled color and (unless stored) depth-stencil textures only
+    // while transient_owner executes. Only for outputs that are read through
+    // rendergraph links: a texture read outside the graph (an ImGui image,
+    // a side channel) may have been overwritten by then.
+    Rendergraph_node*          transient_owner      {nullptr};
+    int                        transient_key        {0};
 };
 
 // Manages color texture (possibly multisampled), depth/stencil texture,
@@ -48,6 +63,13 @@ public:
     [[nodiscard]] auto get_render_pass          () const -> erhe::graphics::Render_pass*;
 
 private:
+    [[nodiscard]] auto make_texture(
+        const void*                                slot,
+        bool                                       whole_lifetime,
+        const erhe::graphics::Texture_create_info& create_info
+    ) -> std::shared_ptr<erhe::graphics::Texture>;
+    void release_transient_textures();
+
     erhe::graphics::Device&                      m_graphics_device;
     erhe::utility::Debug_label                   m_debug_label;
     erhe::dataformat::Format                     m_color_format;
@@ -56,10 +78,19 @@ private:
     bool                                         m_store_depth_stencil{false};
     std::shared_ptr<erhe::graphics::Texture>     m_color_texture;
     std::shared_ptr<erhe::graphics::Texture>     m_multisampled_color_texture;
-    std::unique_ptr<erhe::graphics::Texture>     m_depth_stencil_texture;
+    std::shared_ptr<erhe::graphics::Texture>     m_depth_stencil_texture;
     std::unique_ptr<erhe::graphics::Render_pass> m_render_pass;
     std::string                                  m_gpu_timer_label;
     std::unique_ptr<erhe::graphics::Gpu_timer>   m_gpu_timer;
+
+    Rendergraph_node*                            m_transient_owner{nullptr};
+    int                                          m_transient_key  {0};
+    // Valid while the textures come from the pool; the pool serial they
+    // were acquired with, and the owner's output lifetime at that time.
+    uint64_t                                     m_transient_serial   {0};
+    std::size_t                                  m_transient_first_use{0};
+    std::size_t                                  m_transient_last_use {0};
+    bool                                         m_transient_active   {false};
 };
 
 } // namespace erhe::rendergraph
@@ -14,13 +14,16 @@
 #include "erhe_profile/profile.hpp"
 #include "erhe_verify/verify.hpp"
 
+#include <algorithm>
 #include <optional>
+#include <unordered_map>
 
 namespace erhe::rendergraph {
 
 Rendergraph::Rendergraph(erhe::graphics::Device& graphics_device)
-    : m_graphics_device{graphics_device}
-    , m_graph          {std::make_unique<erhe::graph::Graph>()}
+    : m_graphics_device       {graphics_device}
+    , m_graph                 {std::make_unique<erhe::graph::Graph>()}
+    , m_transient_texture_pool{graphics_device}
 {
     m_nodes.reserve(128);
 }
@@ -77,6 +80,99 @@ void Rendergraph::sort()
     }
 
     m_is_sorted = true;
+
+    compile_lifetimes();
+}
+
+void Rendergraph::compile_lifetimes()
+{
+    ERHE_PROFILE_FUNCTION();
+
+    std::unordered_map<const erhe::graph::Node*, std::size_t> positions;
+    for (std::size_t i = 0, end = m_nodes.size(); i < end; ++i) {
+        positions[m_nodes[i]] = i;
+    }
+
+    // A consumer that also has an output pin with the same key may pass the
+    // input texture through as its own output (Viewport_overlay_node does),
+    // so the output then lives as long as the consumer's output. Walking the
+    // sorted order backwards has every consumer's lifetime ready before its
+    // producer's.
+    m_output_lifetimes.clear();
+    for (std::size_t i = m_nodes.size(); i > 0; --i) {
+        const std::size_t position = i - 1;
+        Rendergraph_node* node = m_nodes[position];
+        for (erhe::graph::Pin& output_pin : node->get_output_pins()) {
+            const int   key      = static_cast<int>(output_pin.get_key());
+            std::size_t last_use = position;
+            for (erhe::graph::Link* link : output_pin.get_links()) {
+                erhe::graph::Pin* sink_pin = link->get_sink();
+                if (sink_pin == nullptr) {
+                    continue;
+                }
+                const Rendergraph_node* consumer = static_cast<Rendergraph_node*>(sink_pin->get_owner_node());
+                const auto consumer_position = positions.find(consumer);
+                if (consumer_position == positions.end()) {
+                    continue;
+                }
+                last_use = std::max(last_use, consumer_position->second);
+                const Rendergraph_output_lifetime* forwarded = get_output_lifetime(consumer, key);
+                if (forwarded != nullptr) {
+                    last_use = std::max(last_use, forwarded->last_use);
+                }
+            }
+            m_output_lifetimes.push_back(
+                Rendergraph_output_lifetime{
+                    .producer  = node,
+                    .key       = key,
+                    .first_use = position,
+                    .last_use  = last_use
+                }
+            );
+        }
+    }
+    std::reverse(m_output_lifetimes.begin(), m_output_lifetimes.end());
+
+    for (const Rendergraph_output_lifetime& lifetime : m_output_lifetimes) {
+        log_tail->trace(
+            "Rendergraph output '{}' key {} live [{}, {}]",
+            lifetime.producer->get_name(),
+            lifetime.key,
+            lifetime.first_use,
+            lifetime.last_use
+        );
+    }
+
+    // Positions changed, so every transient render target must acquire again.
+    m_transient_texture_pool.reset_assignments();
+}
+
+auto Rendergraph::get_output_lifetimes() const -> const std::vector<Rendergraph_output_lifetime>&
+{
+    return m_output_lifetimes;
+}
+
+auto Rendergraph::get_output_lifetime(const Rendergraph_node* producer, const int key) const -> const Rendergraph_output_lifetime*
+{
+    if (!m_is_sorted) {
+        return nullptr;
+    }
+    for (const Rendergraph_output_lifetime& lifetime : m_output_lifetimes) {
+        if ((lifetime.producer == producer) && (lifetime.key == key)) {
+            return &lifetime;
+        }
+    }
+    return nullptr;
+}
+
+auto Rendergraph::get_transient_texture_pool() -> Transient_texture_pool&
+{
+    return m_transient_texture_pool;
+}
+
+auto Rendergraph::get_transient_statistics() const -> Transient_texture_statistics
+{
+    return m_transient_texture_pool.get_statistics();
 }
 
 void Rendergraph::execute(erhe::graphics::Command_buffer& command_buffer)
@@ -138,6 +234,21 @@ void Rendergraph::execute(erhe::graphics::Command_buffer& command_buffer)
     // Nodes may defer resource destruction during execute when old resources
     // are still referenced by nodes that execute later in the same frame.
     m_deferred_resources.clear();
+
+    // Render targets acquire their transient textures while executing, so
+    // the footprint is known only now; log it when it changes.
+    const Transient_texture_statistics statistics = m_transient_texture_pool.get_statistics();
+    if (statistics != m_logged_transient_statistics) {
+        m_logged_transient_statistics = statistics;
+        log_frame->debug(
+            "Rendergraph transient textures: {} requests in {} textures, {} bytes unaliased, {} bytes aliased, {} bytes peak live",
+            statistics.request_count,
+            statistics.texture_count,
+            statistics.unaliased_byte_count,
+            statistics.aliased_byte_count,
+            statistics.peak_live_byte_count
+        );
+    }
 }
 
 void Rendergraph::defer_resource(std::shared_ptr<void> resource)
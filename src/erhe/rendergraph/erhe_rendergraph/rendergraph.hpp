@@ -1,7 +1,9 @@
 #pragma once
 
+#include "erhe_rendergraph/transient_texture_pool.hpp"
 #include "erhe_profile/profile.hpp"
 
+#include <cstddef>
 #include <memory>
 #include <mutex>
 #include <vector>
@@ -19,6 +21,19 @@ namespace erhe::rendergraph {
 
 class Rendergraph_node;
 
+// Lifetime of one node output over the sorted node order, computed when the
+// graph is sorted. first_use is the producer's position, last_use the
+// position of the last node that may read the output (first_use when
+// nothing is connected).
+class Rendergraph_output_lifetime
+{
+public:
+    const Rendergraph_node* producer {nullptr};
+    int                     key      {0};
+    std::size_t             first_use{0};
+    std::size_t             last_use {0};
+};
+
 class Rendergraph final
 {
 public:
@@ -45,7 +60,20 @@ public:
     // may still be referenced by nodes executing later in the same frame.
     void defer_resource(std::shared_ptr<void> resource);
 
+    // Output lifetimes for the current sorted order; empty until the first
+    // successful sort(). get_output_lifetime() returns nullptr for an
+    // unknown node / key, or when the graph is not sorted.
+    [[nodiscard]] auto get_output_lifetimes() const -> const std::vector<Rendergraph_output_lifetime>&;
+    [[nodiscard]] auto get_output_lifetime (const Rendergraph_node* producer, int key) const -> const Rendergraph_output_lifetime*;
+
+    // Textures of transient render targets, shared between outputs whose
+    // lifetimes do not overlap. See Transient_texture_pool.
+    [[nodiscard]] auto get_transient_texture_pool() -> Transient_texture_pool&;
+    [[nodiscard]] auto get_transient_statistics  () const -> Transient_texture_statistics;
+
 private:
+    void compile_lifetimes();
+
     erhe::graphics::Device&        m_graphics_device;
     ERHE_PROFILE_MUTEX(std::mutex, m_mutex);
     std::vector<Rendergraph_node*> m_nodes;
@@ -56,6 +84,10 @@ private:
 
     // Resources deferred for destruction until after execute() completes
     std::vector<std::shared_ptr<void>> m_deferred_resources;
+
+    std::vector<Rendergraph_output_lifetime> m_output_lifetimes;
+    Transient_texture_pool                   m_transient_texture_pool;
+    Transient_texture_statistics             m_logged_transient_statistics;
 };
 
 } // namespace erhe::rendergraph
@@ -16,7 +16,9 @@ Texture_rendergraph_node::Texture_rendergraph_node(const Texture_rendergraph_nod
             .color_format         = create_info.color_format,
             .depth_stencil_format = create_info.depth_stencil_format,
             .sample_count         = create_info.sample_count,
-            .store_depth_stencil  = create_info.store_depth_stencil
+            .store_depth_stencil  = create_info.store_depth_stencil,
+            .transient_owner      = (create_info.transient && (create_info.output_key != Rendergraph_node_key::none)) ? this : nullptr,
+            .transient_key        = create_info.output_key
         }
     }
     , m_output_key{create_info.output_key}
@@ -30,6 +30,11 @@ public:
     // Forwarded to Render_target: store depth/stencil so a later pass can load
     // the same attachment (post-processing overlay pass, issue #230).
     bool                       store_depth_stencil {false};
+    // Take the render target textures from the rendergraph's transient pool,
+    // aliased with other transient outputs that are not live at the same
+    // time (see Render_target_create_info::transient_owner). Requires an
+    // output_key, and that the output is only read through the graph.
+    bool                       transient           {false};
 };
 
 // Rendergraph node that holds a render target (color/depth textures and render pass).
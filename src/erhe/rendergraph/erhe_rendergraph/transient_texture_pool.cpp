@@ -0,0 +1,202 @@
+#include "erhe_rendergraph/transient_texture_pool.hpp"
+#include "erhe_rendergraph/rendergraph_log.hpp"
+#include "erhe_graphics/texture.hpp"
+#include "erhe_profile/profile.hpp"
+#include "erhe_verify/verify.hpp"
+
+#include <fmt/format.h>
+
+#include <algorithm>
+
+namespace erhe::rendergraph {
+
+Transient_texture_pool::Transient_texture_pool(erhe::graphics::Device& graphics_device)
+    : m_graphics_device{graphics_device}
+{
+}
+
+Transient_texture_pool::~Transient_texture_pool() noexcept = default;
+
+auto Transient_texture_pool::get_descriptor(const erhe::graphics::Texture_create_info& create_info) -> Descriptor
+{
+    return Descriptor{
+        .usage_mask   = create_info.usage_mask,
+        .type         = static_cast<int>(create_info.type),
+        .pixelformat  = create_info.pixelformat,
+        .sample_count = create_info.sample_count,
+        .width        = create_info.width,
+        .height       = create_info.height
+    };
+}
+
+auto Transient_texture_pool::get_byte_count(const Descriptor& descriptor) -> std::size_t
+{
+    const std::size_t level_byte_count = erhe::dataformat::get_image_level_size_bytes(
+        descriptor.pixelformat,
+        static_cast<std::size_t>(descriptor.width),
+        static_cast<std::size_t>(descriptor.height)
+    );
+    return level_byte_count * static_cast<std::size_t>(std::max(descriptor.sample_count, 1));
+}
+
+void Transient_texture_pool::reset_assignments()
+{
+    m_entries.erase(
+        std::remove_if(
+            m_entries.begin(),
+            m_entries.end(),
+            [](const Entry& entry) { return entry.assignments.empty(); }
+        ),
+        m_entries.end()
+    );
+    for (Entry& entry : m_entries) {
+        entry.assignments.clear();
+    }
+    ++m_serial;
+}
+
+void Transient_texture_pool::release(const void* owner)
+{
+    for (auto i = m_entries.begin(), end = m_entries.end(); i != end; ++i) {
+        std::vector<Assignment>& assignments = i->assignments;
+        const auto j = std::find_if(
+            assignments.begin(),
+            assignments.end(),
+            [owner](const Assignment& assignment) { return assignment.owner == owner; }
+        );
+        if (j == assignments.end()) {
+            continue;
+        }
+        assignments.erase(j);
+        if (assignments.empty()) {
+            // The render target still holds its reference until it replaces
+            // the texture; the pool just stops handing it out.
+            m_entries.erase(i);
+        }
+        return; // an owner has at most one assignment
+    }
+}
+
+auto Transient_texture_pool::acquire(
+    const void*                                owner,
+    const std::size_t                          first_use,
+    const std::size_t                          last_use,
+    const erhe::graphics::Texture_create_info& create_info
+) -> std::shared_ptr<erhe::graphics::Texture>
+{
+    ERHE_PROFILE_FUNCTION();
+
+    ERHE_VERIFY(owner != nullptr);
+    ERHE_VERIFY(first_use <= last_use);
+
+    const Descriptor descriptor = get_descriptor(create_info);
+
+    // Unchanged request: keep the texture (and with it the render pass the
+    // render target built around it).
+    for (const Entry& entry : m_entries) {
+        for (const Assignment& assignment : entry.assignments) {
+            if (
+                (assignment.owner     == owner)     &&
+                (assignment.first_use == first_use) &&
+                (assignment.last_use  == last_use)  &&
+                (entry.descriptor     == descriptor)
+            ) {
+                return entry.texture;
+            }
+        }
+    }
+
+    release(owner);
+
+    for (Entry& entry : m_entries) {
+        if (entry.descriptor != descriptor) {
+            continue;
+        }
+        const bool overlaps = std::any_of(
+            entry.assignments.begin(),
+            entry.assignments.end(),
+            [first_use, last_use](const Assignment& assignment) {
+                return (first_use <= assignment.last_use) && (assignment.first_use <= last_use);
+            }
+        );
+        if (!overlaps) {
+            entry.assignments.push_back(Assignment{.owner = owner, .first_use = first_use, .last_use = last_use});
+            return entry.texture;
+        }
+    }
+
+    erhe::graphics::Texture_create_info texture_create_info = create_info;
+    texture_create_info.debug_label = erhe::utility::Debug_label{
+        fmt::format("{} (transient {})", create_info.debug_label.string_view(), m_entries.size())
+    };
+    Entry& entry = m_entries.emplace_back(
+        Entry{
+            .descriptor  = descriptor,
+            .byte_count  = get_byte_count(descriptor),
+            .texture     = std::make_shared<erhe::graphics::Texture>(m_graphics_device, texture_create_info),
+            .assignments = {Assignment{.owner = owner, .first_use = first_use, .last_use = last_use}}
+        }
+    );
+    log_tail->trace(
+        "Transient texture '{}' {} x {}, {} bytes",
+        texture_create_info.debug_label.string_view(),
+        descriptor.width,
+        descriptor.height,
+        entry.byte_count
+    );
+    return entry.texture;
+}
+
+auto Transient_texture_pool::get_serial() const -> uint64_t
+{
+    return m_serial;
+}
+
+auto Transient_texture_pool::get_statistics() const -> Transient_texture_statistics
+{
+    Transient_texture_statistics statistics{};
+
+    // Sweep over the sorted positions: +bytes where a lifetime begins,
+    // -bytes one past where it ends.
+    class Event
+    {
+    public:
+        std::size_t position;
+        std::size_t byte_count;
+        bool        begin;
+    };
+    std::vector<Event> events;
+    for (const Entry& entry : m_entries) {
+        if (entry.assignments.empty()) {
+            continue;
+        }
+        ++statistics.texture_count;
+        statistics.aliased_byte_count += entry.byte_count;
+        for (const Assignment& assignment : entry.assignments) {
+            ++statistics.request_count;
+            statistics.unaliased_byte_count += entry.byte_count;
+            events.push_back(Event{.position = assignment.first_use,    .byte_count = entry.byte_count, .begin = true});
+            events.push_back(Event{.position = assignment.last_use + 1, .byte_count = entry.byte_count, .begin = false});
+        }
+    }
+    std::sort(
+        events.begin(),
+        events.end(),
+        [](const Event& lhs, const Event& rhs) {
+            // Ends before begins at the same position: [0, 1] and [2, 3] do not overlap.
+            return (lhs.position != rhs.position) ? (lhs.position < rhs.position) : (!lhs.begin && rhs.begin);
+        }
+    );
+    std::size_t live_byte_count = 0;
+    for (const Event& event : events) {
+        if (event.begin) {
+            live_byte_count += event.byte_count;
+            statistics.peak_live_byte_count = std::max(statistics.peak_live_byte_count, live_byte_count);
+        } else {
+            live_byte_count -= event.byte_count;
+        }
+    }
+    return statistics;
+}
+
+} // namespace erhe::rendergraph
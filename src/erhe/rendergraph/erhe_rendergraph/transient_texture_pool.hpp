@@ -0,0 +1,120 @@
+#pragma once
+
+#include "erhe_dataformat/dataformat.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace erhe::graphics {
+    class Device;
+    class Texture;
+    class Texture_create_info;
+}
+
+namespace erhe::rendergraph {
+
+// Footprint of the transient textures, in bytes computed from the texture
+// descriptors (not queried from the graphics API), so the numbers are the
+// same on every backend including null.
+class Transient_texture_statistics
+{
+public:
+    std::size_t request_count       {0}; // transient textures requested by render targets
+    std::size_t texture_count       {0}; // textures the pool actually holds
+    std::size_t unaliased_byte_count{0}; // every request owning its own texture - the footprint without aliasing
+    std::size_t peak_live_byte_count{0}; // largest sum of requests live at the same sorted position - the lower bound
+    std::size_t aliased_byte_count  {0}; // what the pool holds - the footprint with aliasing
+
+    auto operator==(const Transient_texture_statistics&) const -> bool = default;
+};
+
+// Shares textures between transient render targets whose lifetimes in the
+// sorted rendergraph do not overlap.
+//
+// The graphics layer has no placement / heap API, so aliasing happens at
+// texture granularity: two requests share a texture only when their
+// descriptors (type, format, size, sample count, usage) are identical. A
+// texture is handed to a request only if none of the lifetimes already
+// assigned to it overlaps the new one, so a texture is never written by one
+// node while another node may still read it in the same frame. Since the
+// assignment is the same every frame, the next frame's first writer runs
+// after the previous frame's last reader in submission order.
+//
+// Render targets acquire during Rendergraph::execute(), that is in sorted
+// order, which makes the first-fit search an interval scheduling by start
+// position - optimal per descriptor.
+//
+// Render thread only, same as Rendergraph::execute().
+class Transient_texture_pool
+{
+public:
+    explicit Transient_texture_pool(erhe::graphics::Device& graphics_device);
+    ~Transient_texture_pool() noexcept;
+    Transient_texture_pool(const Transient_texture_pool&) = delete;
+    auto operator=(const Transient_texture_pool&) -> Transient_texture_pool& = delete;
+
+    // Called by Rendergraph when the sorted order changes. Drops every
+    // assignment, since positions from the previous order are meaningless,
+    // and bumps the serial so render targets acquire again. Textures that
+    // were not acquired by anyone since the previous call are released.
+    void reset_assignments();
+
+    // Returns a texture for create_info, live over sorted positions
+    // [first_use, last_use]. owner identifies the requesting slot (a render
+    // target texture member): asking again with the same owner, descriptor
+    // and lifetime returns the same texture, a changed request replaces the
+    // owner's previous assignment.
+    [[nodiscard]] auto acquire(
+        const void*                                owner,
+        std::size_t                                first_use,
+        std::size_t                                last_use,
+        const erhe::graphics::Texture_create_info& create_info
+    ) -> std::shared_ptr<erhe::graphics::Texture>;
+
+    void release(const void* owner);
+
+    [[nodiscard]] auto get_serial    () const -> uint64_t;
+    [[nodiscard]] auto get_statistics() const -> Transient_texture_statistics;
+
+private:
+    class Descriptor
+    {
+    public:
+        uint64_t                 usage_mask  {0};
+        int                      type        {0};
+        erhe::dataformat::Format pixelformat {erhe::dataformat::Format::format_undefined};
+        int                      sample_count{0};
+        int                      width       {0};
+        int                      height      {0};
+
+        auto operator==(const Descriptor&) const -> bool = default;
+    };
+
+    class Assignment
+    {
+    public:
+        const void* owner    {nullptr};
+        std::size_t first_use{0};
+        std::size_t last_use {0};
+    };
+
+    class Entry
+    {
+    public:
+        Descriptor                               descriptor;
+        std::size_t                              byte_count{0};
+        std::shared_ptr<erhe::graphics::Texture> texture;
+        std::vector<Assignment>                  assignments;
+    };
+
+    [[nodiscard]] static auto get_descriptor(const erhe::graphics::Texture_create_info& create_info) -> Descriptor;
+    [[nodiscard]] static auto get_byte_count(const Descriptor& descriptor) -> std::size_t;
+
+    erhe::graphics::Device& m_graphics_device;
+    std::vector<Entry>      m_entries;
+    uint64_t                m_serial{1};
+};
+
+} // namespace erhe::rendergraph
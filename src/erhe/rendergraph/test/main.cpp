@@ -0,0 +1,30 @@
+#include "erhe_dataformat/dataformat_log.hpp"
+#include "erhe_file/file_log.hpp"
+#include "erhe_graph/graph_log.hpp"
+#include "erhe_graphics/graphics_log.hpp"
+#include "erhe_item/item_log.hpp"
+#include "erhe_log/log.hpp"
+#include "erhe_rendergraph/rendergraph_log.hpp"
+
+#include <spdlog/spdlog.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+
+#include <gtest/gtest.h>
+
+int main(int argc, char** argv)
+{
+    erhe::log::initialize_log_sinks();
+
+    // Same bootstrap as erhe_graph_tests: make_logger() reads the logging
+    // configuration through erhe::file, which logs through log_file.
+    erhe::file::log_file = spdlog::stdout_color_mt("erhe.file.bootstrap");
+
+    erhe::item::initialize_logging();
+    erhe::graph::initialize_logging();
+    erhe::dataformat::initialize_logging();
+    erhe::graphics::initialize_logging();
+    erhe::rendergraph::initialize_logging();
+
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
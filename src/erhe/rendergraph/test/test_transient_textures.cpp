@@ -0,0 +1,232 @@
+// Output lifetimes and transient texture aliasing of a sorted rendergraph,
+// on the null graphics device. Every graph here is a single chain, so the
+// sorted order (and with it every position) is fully determined.
+
+#include "erhe_rendergraph/rendergraph.hpp"
+#include "erhe_rendergraph/rendergraph_node.hpp"
+#include "erhe_rendergraph/resource_routing.hpp"
+#include "erhe_rendergraph/texture_rendergraph_node.hpp"
+#include "erhe_rendergraph/transient_texture_pool.hpp"
+#include "erhe_dataformat/dataformat.hpp"
+#include "erhe_graphics/device.hpp"
+#include "erhe_graphics/generated/graphics_config.hpp"
+#include "erhe_graphics/surface.hpp"
+#include "erhe_graphics/texture.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace {
+
+using erhe::rendergraph::Rendergraph;
+using erhe::rendergraph::Rendergraph_node;
+using erhe::rendergraph::Rendergraph_node_key;
+using erhe::rendergraph::Rendergraph_output_lifetime;
+using erhe::rendergraph::Texture_rendergraph_node;
+using erhe::rendergraph::Texture_rendergraph_node_create_info;
+using erhe::rendergraph::Transient_texture_statistics;
+
+// Keys private to these tests, clear of Rendergraph_node_key values
+constexpr int key_a = 10;
+constexpr int key_b = 11;
+constexpr int key_c = 12;
+constexpr int key_d = 13;
+
+constexpr int width  = 64;
+constexpr int height = 32;
+
+constexpr erhe::dataformat::Format color_format = erhe::dataformat::Format::format_8_vec4_unorm;
+
+// Transient color-only render target, optionally reading one input
+class Transient_node : public Texture_rendergraph_node
+{
+public:
+    Transient_node(Rendergraph& rendergraph, const char* label, const int input_key, const int output_key)
+        : Texture_rendergraph_node{
+            Texture_rendergraph_node_create_info{
+                .rendergraph  = rendergraph,
+                .debug_label  = label,
+                .output_key   = output_key,
+                .color_format = color_format,
+                .transient    = true
+            }
+        }
+    {
+        if (input_key != Rendergraph_node_key::none) {
+            register_input(label, input_key);
+        }
+    }
+
+    void execute_rendergraph_node(erhe::graphics::Command_buffer&) override {}
+
+    // What Rendergraph::execute() would have the node do, without a command buffer
+    void update()
+    {
+        get_render_target().update(width, height, nullptr);
+    }
+
+    [[nodiscard]] auto color() const -> erhe::graphics::Texture*
+    {
+        return get_render_target().get_color_texture().get();
+    }
+};
+
+// Reads key and outputs the same key, passing the input texture through
+// (as Viewport_overlay_node does); owns no textures
+class Forwarding_node : public Rendergraph_node
+{
+public:
+    Forwarding_node(Rendergraph& rendergraph, const char* label, const int key)
+        : Rendergraph_node{rendergraph, label}
+    {
+        register_input (label, key);
+        register_output(label, key);
+    }
+
+    void execute_rendergraph_node(erhe::graphics::Command_buffer&) override {}
+};
+
+class Sink_node : public Rendergraph_node
+{
+public:
+    Sink_node(Rendergraph& rendergraph, const char* label, const int input_key)
+        : Rendergraph_node{rendergraph, label}
+    {
+        register_input(label, input_key);
+    }
+
+    void execute_rendergraph_node(erhe::graphics::Command_buffer&) override {}
+};
+
+auto make_device() -> std::unique_ptr<erhe::graphics::Device>
+{
+    const erhe::graphics::Surface_create_info surface_create_info{
+        .context_window = nullptr
+    };
+    const Graphics_config graphics_config{};
+    return std::make_unique<erhe::graphics::Device>(surface_create_info, graphics_config);
+}
+
+auto texture_byte_count() -> std::size_t
+{
+    return erhe::dataformat::get_image_level_size_bytes(color_format, width, height);
+}
+
+void expect_lifetime(
+    const Rendergraph&      rendergraph,
+    const Rendergraph_node& producer,
+    const int               key,
+    const std::size_t       first_use,
+    const std::size_t       last_use
+)
+{
+    const Rendergraph_output_lifetime* lifetime = rendergraph.get_output_lifetime(&producer, key);
+    ASSERT_NE(lifetime, nullptr) << producer.get_name() << " key " << key;
+    EXPECT_EQ(lifetime->first_use, first_use) << producer.get_name() << " key " << key;
+    EXPECT_EQ(lifetime->last_use,  last_use ) << producer.get_name() << " key " << key;
+}
+
+} // anonymous namespace
+
+// a -> b -> c -> d -> sink: each output is live from its producer to its
+// only consumer, so outputs two apart never overlap and share a texture.
+TEST(Rendergraph_transient, chain_aliases_non_overlapping_outputs)
+{
+    std::unique_ptr<erhe::graphics::Device> device = make_device();
+    Rendergraph rendergraph{*device.get()};
+
+    Transient_node a   {rendergraph, "a", Rendergraph_node_key::none, key_a};
+    Transient_node b   {rendergraph, "b", key_a, key_b};
+    Transient_node c   {rendergraph, "c", key_b, key_c};
+    Transient_node d   {rendergraph, "d", key_c, key_d};
+    Sink_node      sink{rendergraph, "sink", key_d};
+
+    ASSERT_TRUE(rendergraph.connect(key_a, &a, &b));
+    ASSERT_TRUE(rendergraph.connect(key_b, &b, &c));
+    ASSERT_TRUE(rendergraph.connect(key_c, &c, &d));
+    ASSERT_TRUE(rendergraph.connect(key_d, &d, &sink));
+    rendergraph.sort();
+
+    const std::vector<Rendergraph_node*> expected_order{&a, &b, &c, &d, &sink};
+    ASSERT_EQ(rendergraph.get_nodes(), expected_order);
+
+    EXPECT_EQ(rendergraph.get_output_lifetimes().size(), 4u);
+    expect_lifetime(rendergraph, a, key_a, 0, 1);
+    expect_lifetime(rendergraph, b, key_b, 1, 2);
+    expect_lifetime(rendergraph, c, key_c, 2, 3);
+    expect_lifetime(rendergraph, d, key_d, 3, 4);
+
+    for (Transient_node* node : {&a, &b, &c, &d}) {
+        node->update();
+        ASSERT_NE(node->color(), nullptr);
+    }
+    EXPECT_EQ(a.color(), c.color());
+    EXPECT_EQ(b.color(), d.color());
+    EXPECT_NE(a.color(), b.color());
+
+    const std::size_t bytes = texture_byte_count();
+    ASSERT_EQ(bytes, std::size_t{width * height * 4});
+    const Transient_texture_statistics expected{
+        .request_count        = 4,
+        .texture_count        = 2,
+        .unaliased_byte_count = 4 * bytes,
+        .peak_live_byte_count = 2 * bytes, // two outputs live at positions 1, 2 and 3
+        .aliased_byte_count   = 2 * bytes
+    };
+    EXPECT_EQ(rendergraph.get_transient_statistics(), expected);
+
+    // Acquiring again with an unchanged sort keeps every assignment
+    erhe::graphics::Texture* const a_color = a.color();
+    a.update();
+    EXPECT_EQ(a.color(), a_color);
+    EXPECT_EQ(rendergraph.get_transient_statistics(), expected);
+}
+
+// a -> forward -> g -> h -> sink, where forward reads and outputs key_a:
+// a's texture must stay live until forward's output is consumed by g, so a
+// and g cannot share, while h (after g) can take a's texture.
+TEST(Rendergraph_transient, same_key_forwarding_extends_lifetime)
+{
+    std::unique_ptr<erhe::graphics::Device> device = make_device();
+    Rendergraph rendergraph{*device.get()};
+
+    Transient_node  a      {rendergraph, "a", Rendergraph_node_key::none, key_a};
+    Forwarding_node forward{rendergraph, "forward", key_a};
+    Transient_node  g      {rendergraph, "g", key_a, key_b};
+    Transient_node  h      {rendergraph, "h", key_b, key_c};
+    Sink_node       sink   {rendergraph, "sink", key_c};
+
+    ASSERT_TRUE(rendergraph.connect(key_a, &a, &forward));
+    ASSERT_TRUE(rendergraph.connect(key_a, &forward, &g));
+    ASSERT_TRUE(rendergraph.connect(key_b, &g, &h));
+    ASSERT_TRUE(rendergraph.connect(key_c, &h, &sink));
+    rendergraph.sort();
+
+    const std::vector<Rendergraph_node*> expected_order{&a, &forward, &g, &h, &sink};
+    ASSERT_EQ(rendergraph.get_nodes(), expected_order);
+
+    expect_lifetime(rendergraph, forward, key_a, 1, 2);
+    expect_lifetime(rendergraph, a,       key_a, 0, 2); // not [0, 1]: forwarded to g
+    expect_lifetime(rendergraph, g,       key_b, 2, 3);
+    expect_lifetime(rendergraph, h,       key_c, 3, 4);
+
+    for (Transient_node* node : {&a, &g, &h}) {
+        node->update();
+        ASSERT_NE(node->color(), nullptr);
+    }
+    EXPECT_NE(a.color(), g.color());
+    EXPECT_EQ(a.color(), h.color());
+
+    const std::size_t bytes = texture_byte_count();
+    const Transient_texture_statistics expected{
+        .request_count        = 3,
+        .texture_count        = 2,
+        .unaliased_byte_count = 3 * bytes,
+        .peak_live_byte_count = 2 * bytes, // a and g at 2, g and h at 3
+        .aliased_byte_count   = 2 * bytes
+    };
+    EXPECT_EQ(rendergraph.get_transient_statistics(), expected);
+}
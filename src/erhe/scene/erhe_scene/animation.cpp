@@ -392,6 +392,16 @@ auto Animation::evaluate(const float time_current, const std::size_t channel_ind
     return value[static_cast<glm::vec4::length_type>(component)];
 }
 
+void Animation::mark_data_changed()
+{
+    ++m_data_serial;
+}
+
+auto Animation::get_data_serial() const -> uint64_t
+{
+    return m_data_serial;
+}
+
 void Animation::apply(float time_current)
 {
     // Animation_sampler::apply() writes the sampled component directly into the
@@ -82,6 +82,12 @@ public:
 
     void apply(float time_current);
 
+    // Sampler data is edited in place; editors call mark_data_changed() after
+    // every change to timestamps, data or interpolation modes so that
+    // Compiled_animation copies know to rebuild.
+    void mark_data_changed();
+    [[nodiscard]] auto get_data_serial() const -> uint64_t;
+
     std::vector<Animation_sampler> samplers;
     std::vector<Animation_channel> channels;
 
@@ -89,6 +95,7 @@ private:
     // Distinct channel target nodes of the last apply(). A member only to keep
     // its capacity across frames; carries no state between calls.
     std::vector<Node*> m_applied_nodes;
+    uint64_t           m_data_serial{0};
 };
 
 } // namespace erhe::scene
@@ -0,0 +1,348 @@
+#include "erhe_scene/compiled_animation.hpp"
+
+#include "erhe_math/vec4_kernels.hpp"
+#include "erhe_profile/profile.hpp"
+#include "erhe_scene/node.hpp"
+#include "erhe_scene/trs_transform.hpp"
+#include "erhe_verify/verify.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+
+namespace erhe::scene {
+
+namespace {
+
+// Same as the identity value Animation_sampler::evaluate() returns for a
+// channel its sampler has no usable data for.
+[[nodiscard]] auto identity_value(const Animation_path path) -> glm::vec4
+{
+    switch (path) {
+        case Animation_path::ROTATION: return glm::vec4{0.0f, 0.0f, 0.0f, 1.0f}; // x, y, z, w
+        case Animation_path::SCALE:    return glm::vec4{1.0f, 1.0f, 1.0f, 0.0f};
+        default:                       return glm::vec4{0.0f, 0.0f, 0.0f, 0.0f};
+    }
+}
+
+[[nodiscard]] auto get_path_bit(const Animation_path path) -> uint32_t
+{
+    switch (path) {
+        case Animation_path::TRANSLATION: return Compiled_animation::c_translation;
+        case Animation_path::ROTATION:    return Compiled_animation::c_rotation;
+        case Animation_path::SCALE:       return Compiled_animation::c_scale;
+        default:                          return 0;
+    }
+}
+
+// Missing trailing components (out tangents of the last key) read as zero.
+[[nodiscard]] auto read_key_value(
+    const std::vector<float>& data,
+    const std::size_t         offset,
+    const std::size_t         component_count
+) -> glm::vec4
+{
+    glm::vec4 value{0.0f};
+    for (std::size_t c = 0; (c < component_count) && (offset + c < data.size()); ++c) {
+        value[static_cast<glm::vec4::length_type>(c)] = data[offset + c];
+    }
+    return value;
+}
+
+// glm::normalize(glm::quat) on x, y, z, w: identity for a zero quaternion.
+[[nodiscard]] auto normalize_rotation(const glm::vec4 q) -> glm::vec4
+{
+    const float length = glm::length(q);
+    if (!(length > 0.0f)) {
+        return glm::vec4{0.0f, 0.0f, 0.0f, 1.0f};
+    }
+    return q / length;
+}
+
+// Last key at or before time, 0 before the first key. Playback moves
+// forward by less than one key per frame most of the time, so the previous
+// cursor and the key after it are tried before the binary search.
+[[nodiscard]] auto find_key(
+    const float* const times,
+    const std::size_t  key_count,
+    const float        time,
+    std::size_t        cursor
+) -> std::size_t
+{
+    if (!(time >= times[0])) {
+        return 0;
+    }
+    cursor = std::min(cursor, key_count - 1);
+    const auto contains = [&](const std::size_t key) -> bool {
+        return (times[key] <= time) && ((key + 1 == key_count) || (time < times[key + 1]));
+    };
+    if (contains(cursor)) {
+        return cursor;
+    }
+    if ((cursor + 1 < key_count) && contains(cursor + 1)) {
+        return cursor + 1;
+    }
+    const float* const upper = std::upper_bound(times, times + key_count, time);
+    return static_cast<std::size_t>(upper - times) - 1;
+}
+
+} // anonymous namespace
+
+Compiled_animation::Compiled_animation(const Animation& animation)
+    : data_serial{animation.get_data_serial()}
+{
+    ERHE_PROFILE_FUNCTION();
+
+    groups.reserve(animation.samplers.size());
+    for (const Animation_sampler& sampler : animation.samplers) {
+        groups.push_back(
+            Key_group{
+                .time_offset = times.size(),
+                .key_count   = sampler.timestamps.size()
+            }
+        );
+        times.insert(times.end(), sampler.timestamps.begin(), sampler.timestamps.end());
+    }
+
+    std::unordered_map<const Node*, std::size_t> slot_from_node;
+    channel_targets.reserve(animation.channels.size());
+    for (std::size_t channel_index = 0, end = animation.channels.size(); channel_index < end; ++channel_index) {
+        const Animation_channel& channel = animation.channels[channel_index];
+        channel_targets.push_back(channel.target.get());
+
+        const std::size_t component_count = get_component_count(channel.path);
+        if (!channel.target || (component_count == 0) || (channel.sampler_index >= animation.samplers.size())) {
+            continue;
+        }
+        const Animation_sampler& sampler = animation.samplers[channel.sampler_index];
+        if (sampler.interpolation_mode == Animation_interpolation_mode::INVALID) {
+            continue;
+        }
+        const bool        cubic      = (sampler.interpolation_mode == Animation_interpolation_mode::CUBICSPLINE);
+        const bool        rotation   = (channel.path == Animation_path::ROTATION);
+        const std::size_t key_values = cubic ? 3 : 1;
+        const std::size_t key_stride = component_count * key_values; // floats per key in sampler data
+
+        const auto [slot_i, inserted] = slot_from_node.try_emplace(channel.target.get(), target_slots.size());
+        if (inserted) {
+            target_slots.push_back(Target_slot{.channel_index = channel_index, .path_mask = 0});
+        }
+        target_slots[slot_i->second].path_mask |= get_path_bit(channel.path);
+
+        Track track{
+            .path               = channel.path,
+            .interpolation_mode = sampler.interpolation_mode,
+            .channel_index      = channel_index,
+            .group              = channel.sampler_index,
+            .value_offset       = values.size(),
+            .key_count          = 0,
+            .target_slot        = slot_i->second
+        };
+        // value_offset already points at the value of a CUBICSPLINE key
+        // block (in tangent, value, out tangent); the in tangent of the next
+        // key follows the out tangent.
+        for (std::size_t key = 0, key_end = sampler.timestamps.size(); key < key_end; ++key) {
+            const std::size_t offset = key * key_stride + channel.value_offset;
+            if (offset + component_count > sampler.data.size()) {
+                break;
+            }
+            const glm::vec4 value = read_key_value(sampler.data, offset, component_count);
+            values.push_back((rotation && !cubic) ? normalize_rotation(value) : value);
+            if (cubic) {
+                values.push_back(read_key_value(sampler.data, offset +     component_count, component_count));
+                values.push_back(read_key_value(sampler.data, offset + 2 * component_count, component_count));
+            }
+            ++track.key_count;
+        }
+        tracks.push_back(track);
+    }
+}
+
+auto Compiled_animation::is_stale(const Animation& animation) const -> bool
+{
+    if ((animation.get_data_serial() != data_serial) || (animation.channels.size() != channel_targets.size())) {
+        return true;
+    }
+    for (std::size_t i = 0, end = channel_targets.size(); i < end; ++i) {
+        if (animation.channels[i].target.get() != channel_targets[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+Animation_instance::Animation_instance(const std::shared_ptr<Animation>& animation)
+    : m_animation{animation}
+{
+    ERHE_VERIFY(m_animation);
+    m_compiled = Compiled_animation{*m_animation};
+    m_group_cursors.assign(m_compiled.groups.size(), 0);
+    m_poses        .assign(m_compiled.target_slots.size(), Target_pose{});
+}
+
+auto Animation_instance::get_animation() const -> const std::shared_ptr<Animation>&
+{
+    return m_animation;
+}
+
+auto Animation_instance::get_compiled() const -> const Compiled_animation&
+{
+    return m_compiled;
+}
+
+void Animation_instance::set_time(const float time)
+{
+    m_time = time;
+}
+
+auto Animation_instance::get_time() const -> float
+{
+    return m_time;
+}
+
+void Animation_instance::prepare()
+{
+    if (!m_compiled.is_stale(*m_animation)) {
+        return;
+    }
+    m_compiled = Compiled_animation{*m_animation};
+    m_group_cursors.assign(m_compiled.groups.size(), 0);
+    m_poses        .assign(m_compiled.target_slots.size(), Target_pose{});
+}
+
+void Animation_instance::evaluate()
+{
+    ERHE_PROFILE_FUNCTION();
+
+    const float time = m_time;
+    for (std::size_t i = 0, end = m_compiled.groups.size(); i < end; ++i) {
+        const Compiled_animation::Key_group& group = m_compiled.groups[i];
+        if (group.key_count > 0) {
+            m_group_cursors[i] = find_key(m_compiled.times.data() + group.time_offset, group.key_count, time, m_group_cursors[i]);
+        }
+    }
+
+    // Every track becomes a * w.x + b * w.y; holds and cubic spline results
+    // are computed here and pass through with weights (1, 0).
+    const std::size_t track_count = m_compiled.tracks.size();
+    m_a      .resize(track_count);
+    m_b      .resize(track_count);
+    m_weights.resize(track_count);
+    m_blended.resize(track_count);
+    for (std::size_t i = 0; i < track_count; ++i) {
+        const Compiled_animation::Track& track = m_compiled.tracks[i];
+        m_b      [i] = glm::vec4{0.0f};
+        m_weights[i] = glm::vec2{1.0f, 0.0f};
+
+        const std::size_t key = m_group_cursors[track.group];
+        if (key >= track.key_count) {
+            m_a[i] = identity_value(track.path);
+            continue;
+        }
+
+        const bool             cubic  = (track.interpolation_mode == Animation_interpolation_mode::CUBICSPLINE);
+        const std::size_t      stride = cubic ? 3 : 1;
+        const glm::vec4* const keys   = m_compiled.values.data() + track.value_offset;
+        const float* const     times  = m_compiled.times.data() + m_compiled.groups[track.group].time_offset;
+        m_a[i] = keys[key * stride];
+
+        // Holds, as in Animation_sampler::evaluate()
+        if (
+            (track.interpolation_mode == Animation_interpolation_mode::STEP) ||
+            (time < times[0]) ||
+            (times[key] == time) ||
+            (key + 1 >= track.key_count)
+        ) {
+            continue;
+        }
+        const float t_d = times[key + 1] - times[key];
+        if (!(t_d > 0.0f)) {
+            continue;
+        }
+        const float     t    = (time - times[key]) / t_d;
+        const glm::vec4 next = keys[(key + 1) * stride];
+
+        if (cubic) {
+            // glTF 2.0 appendix C, tangents scaled by t_d
+            const float t2 = t * t;
+            const float t3 = t2 * t;
+            const float s0 =  2.0f * t3 - 3.0f * t2 + 1.0f;
+            const float s1 =  t_d * (t3 - 2.0f * t2 + t);
+            const float s2 = -2.0f * t3 + 3.0f * t2;
+            const float s3 =  t_d * (t3 - t2);
+            const glm::vec4 value = s0 * m_a[i] + s1 * keys[key * 3 + 1] + s2 * next + s3 * keys[key * 3 + 2];
+            m_a[i] = (track.path == Animation_path::ROTATION) ? normalize_rotation(value) : value;
+            continue;
+        }
+
+        m_b[i] = next;
+        m_weights[i] = glm::vec2{1.0f - t, t};
+        if (track.path == Animation_path::ROTATION) {
+            // glm::slerp(): shortest path, linear mix when nearly parallel
+            float cos_theta = glm::dot(m_a[i], next);
+            if (cos_theta < 0.0f) {
+                m_b[i]    = -next;
+                cos_theta = -cos_theta;
+            }
+            if (cos_theta <= 1.0f - std::numeric_limits<float>::epsilon()) {
+                const float angle     = std::acos(cos_theta);
+                const float sin_angle = std::sin(angle);
+                m_weights[i] = glm::vec2{std::sin((1.0f - t) * angle), std::sin(t * angle)} / sin_angle;
+            }
+        }
+    }
+
+    erhe::math::blend_vec4(m_a, m_b, m_weights, m_blended);
+
+    for (std::size_t i = 0; i < track_count; ++i) {
+        const Compiled_animation::Track& track = m_compiled.tracks[i];
+        const glm::vec4                  value = m_blended[i];
+        Target_pose&                     pose  = m_poses[track.target_slot];
+        switch (track.path) {
+            case Animation_path::TRANSLATION: pose.translation = glm::vec3{value}; break;
+            case Animation_path::ROTATION:    pose.rotation    = glm::quat{value.w, value.x, value.y, value.z}; break;
+            case Animation_path::SCALE:       pose.scale       = glm::vec3{value}; break;
+            default: break;
+        }
+    }
+}
+
+void Animation_instance::write_pose(const uint64_t serial)
+{
+    ERHE_PROFILE_FUNCTION();
+
+    const std::vector<Animation_channel>& channels = m_animation->channels;
+    for (std::size_t i = 0, end = m_compiled.target_slots.size(); i < end; ++i) {
+        const Compiled_animation::Target_slot& slot = m_compiled.target_slots[i];
+        // The animation may have been retargeted after prepare().
+        if (slot.channel_index >= channels.size()) {
+            continue;
+        }
+        Node* const node = channels[slot.channel_index].target.get();
+        if ((node == nullptr) || (node != m_compiled.channel_targets[slot.channel_index])) {
+            continue;
+        }
+
+        // One set_trs() (one matrix compose) per node instead of one setter
+        // per channel; components no channel animates keep their value.
+        const Target_pose& pose = m_poses[i];
+        Trs_transform&     trs  = node->node_data.transforms.parent_from_node;
+        trs.set_trs(
+            ((slot.path_mask & Compiled_animation::c_translation) != 0) ? pose.translation : trs.get_translation(),
+            ((slot.path_mask & Compiled_animation::c_rotation   ) != 0) ? pose.rotation    : trs.get_rotation   (),
+            ((slot.path_mask & Compiled_animation::c_scale      ) != 0) ? pose.scale       : trs.get_scale      ()
+        );
+        node->update_world_from_node();
+        node->handle_transform_update(serial);
+    }
+}
+
+void Animation_instance::apply()
+{
+    prepare();
+    evaluate();
+    write_pose(Node_transforms::get_next_serial());
+}
+
+} // namespace erhe::scene
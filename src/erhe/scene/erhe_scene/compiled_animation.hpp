@@ -0,0 +1,132 @@
+#pragma once
+
+#include "erhe_scene/animation.hpp"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace erhe::scene {
+
+class Node;
+
+// Flat, read-only copy of one Animation's keyframes, laid out for playback:
+// the timestamps of all samplers back to back in one array (one key group
+// per sampler, shared by every channel that uses the sampler) and the key
+// values of all channels as vec4 in another. Rotation keys are stored as
+// x, y, z, w and, except for CUBICSPLINE, already normalized. Channel target
+// nodes are not copied; only their addresses are kept to notice a retarget.
+class Compiled_animation
+{
+public:
+    class Key_group
+    {
+    public:
+        std::size_t time_offset{0}; // in times
+        std::size_t key_count  {0};
+    };
+
+    class Track
+    {
+    public:
+        Animation_path               path              {Animation_path::INVALID};
+        Animation_interpolation_mode interpolation_mode{Animation_interpolation_mode::LINEAR};
+        std::size_t                  channel_index     {0};
+        std::size_t                  group             {0};
+        // in values: one vec4 per key, or for CUBICSPLINE three (value, out
+        // tangent, in tangent of the next key)
+        std::size_t                  value_offset      {0};
+        // keys whose value is fully present in the sampler data; at most the
+        // key count of the group
+        std::size_t                  key_count         {0};
+        std::size_t                  target_slot       {0};
+    };
+
+    // Bits of Target_slot::path_mask
+    static constexpr uint32_t c_translation = (1u << 0u);
+    static constexpr uint32_t c_rotation    = (1u << 1u);
+    static constexpr uint32_t c_scale       = (1u << 2u);
+
+    class Target_slot
+    {
+    public:
+        std::size_t channel_index{0}; // a channel whose target is the slot node
+        uint32_t    path_mask    {0};
+    };
+
+    Compiled_animation() = default;
+    explicit Compiled_animation(const Animation& animation);
+
+    // True when animation was edited (Animation::mark_data_changed()) or
+    // had channels added, removed or retargeted since compiling.
+    [[nodiscard]] auto is_stale(const Animation& animation) const -> bool;
+
+    uint64_t                 data_serial{0};
+    std::vector<float>       times;
+    std::vector<glm::vec4>   values;
+    std::vector<Key_group>   groups;
+    std::vector<Track>       tracks;       // channels with a supported path and a target
+    std::vector<Target_slot> target_slots; // distinct target nodes
+    std::vector<const Node*> channel_targets; // per Animation channel, at compile time
+};
+
+// Playback state of one Animation: a compiled copy of its keys, a key
+// cursor per key group and the sampled pose of every target node.
+//
+// Sampling gives the same values as Animation_sampler::evaluate(). Keys are
+// found from the cursor of the previous evaluate() (same or next key, the
+// common case for playback) with a binary search fallback for seeks. All
+// tracks are then blended in one erhe::math::blend_vec4() pass: lerp and
+// slerp are both a weighted sum of the two surrounding keys, only the
+// weights differ. CUBICSPLINE tracks are evaluated one by one.
+class Animation_instance
+{
+public:
+    explicit Animation_instance(const std::shared_ptr<Animation>& animation);
+
+    [[nodiscard]] auto get_animation() const -> const std::shared_ptr<Animation>&;
+    [[nodiscard]] auto get_compiled () const -> const Compiled_animation&;
+
+    void set_time(float time);
+    [[nodiscard]] auto get_time() const -> float;
+
+    // Recompiles when the animation is stale. Reads the Animation; do not run
+    // concurrently with edits to it.
+    void prepare();
+
+    // Samples all tracks at get_time() into the pose. Reads only this
+    // instance, so evaluate() of different instances may run concurrently.
+    void evaluate();
+
+    // Writes the pose to the target nodes: one Trs_transform::set_trs() per
+    // node, then world transform update and handle_transform_update(serial),
+    // which queues the node in the scene dirty list.
+    void write_pose(uint64_t serial);
+
+    // prepare(), evaluate() and write_pose() with a new serial
+    void apply();
+
+private:
+    class Target_pose
+    {
+    public:
+        glm::vec3 translation{0.0f};
+        glm::quat rotation   {1.0f, 0.0f, 0.0f, 0.0f};
+        glm::vec3 scale      {1.0f};
+    };
+
+    std::shared_ptr<Animation> m_animation;
+    Compiled_animation         m_compiled;
+    float                      m_time{0.0f};
+    std::vector<std::size_t>   m_group_cursors;
+    std::vector<glm::vec4>     m_a;
+    std::vector<glm::vec4>     m_b;
+    std::vector<glm::vec2>     m_weights;
+    std::vector<glm::vec4>     m_blended;
+    std::vector<Target_pose>   m_poses;
+};
+
+} // namespace erhe::scene
@@ -293,6 +293,11 @@ void Node::handle_parent_update(erhe::Hierarchy* const old_parent_item, erhe::Hi
     // e.g. scene teardown): attachments may already be severed from their
     // host resources there.
     if (new_parent != nullptr) {
+        // A reparent within one scene does not re-register the node.
+        Scene* const scene = get_scene();
+        if (scene != nullptr) {
+            scene->invalidate_transform_table();
+        }
         update_world_from_node();
         handle_transform_update(0);
     }
@@ -409,15 +414,20 @@ void Node::update_transform(uint64_t serial)
         // read) - this loop runs for every node under a moving subtree.
         const float determinant = glm::determinant(glm::mat3{world_from_node});
 
-        node_data.transforms.world_from_node.set(world_from_node);
+        apply_propagated_world_from_node(world_from_node, determinant < 0.0f, serial);
+    }
+}
 
-        if (determinant < 0.0f) {
-            enable_flag_bits(erhe::Item_flags::negative_determinant);
-        } else {
-            disable_flag_bits(erhe::Item_flags::negative_determinant);
-        }
-        handle_transform_update(serial);
+void Node::apply_propagated_world_from_node(const glm::mat4& world_from_node, const bool negative_determinant, const uint64_t serial)
+{
+    node_data.transforms.world_from_node.set(world_from_node);
+
+    if (negative_determinant) {
+        enable_flag_bits(erhe::Item_flags::negative_determinant);
+    } else {
+        disable_flag_bits(erhe::Item_flags::negative_determinant);
     }
+    handle_transform_update(serial);
 }
 
 void Node::update_world_from_node()
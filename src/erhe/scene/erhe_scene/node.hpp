@@ -4,6 +4,7 @@
 #include "erhe_scene/trs_transform.hpp"
 
 #include <cstdint>
+#include <limits>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -35,6 +36,10 @@ public:
     // writer's dirt CARRIES them (ancestor edits move body-driven subtrees).
     mutable bool          scene_transform_dirty_by_owner{false};
 
+    // Index in the Scene's Transform_table; validated by the table (stale
+    // after the node leaves the hierarchy or the table is rebuilt).
+    mutable uint32_t      transform_table_index{std::numeric_limits<uint32_t>::max()};
+
     // One of these is normative, and the other is calculated by update_transform()
     Trs_transform         parent_from_node;
     mutable Trs_transform world_from_node;  
@@ -128,6 +133,10 @@ public:
     void node_sanity_check     (bool destruction_in_progress = false) const;
     void update_world_from_node();
     void update_transform      (uint64_t serial);
+    // Second half of update_transform(): stores a world transform computed
+    // from the parent's (by update_transform() or the Scene's parallel
+    // Transform_table pass) and notifies. serial is at least the parent's.
+    void apply_propagated_world_from_node(const glm::mat4& world_from_node, bool negative_determinant, uint64_t serial);
     void set_parent_from_node  (glm::mat4 parent_from_node);
     void set_parent_from_node  (const Transform& parent_from_node);
     void set_parent_from_node  (const Trs_transform& parent_from_node);
@@ -277,6 +277,15 @@ void Scene::mark_node_transform_dirty(const Node& node)
     m_transform_dirty_nodes.push_back(const_cast<Node*>(&node));
 }
 
+namespace {
+
+[[nodiscard]] auto to_ms(const std::chrono::steady_clock::duration duration) -> double
+{
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()) * 1.0e-6;
+}
+
+} // anonymous namespace
+
 void Scene::update_node_transforms()
 {
     ERHE_PROFILE_FUNCTION();
@@ -302,6 +311,24 @@ void Scene::update_node_transforms()
     m_updating_node_transforms = true;
     std::swap(m_transform_dirty_nodes, m_transform_dirty_processing);
 
+    m_transform_update_stats.pass_count   += 1;
+    m_transform_update_stats.dirty_count  += m_transform_dirty_processing.size();
+    m_transform_update_stats.lock_wait_ms += to_ms(time_after_lock - time_before_lock);
+
+    // Many dirty nodes (animation, physics): one data-parallel pass over the
+    // flat hierarchy beats walking every dirty subtree through shared_ptr
+    // children. The table pass touches every scene node, so the dirty count
+    // must also be a fair share of the scene, else a few moved nodes in a
+    // large scene would pay for a full pass.
+    const std::size_t table_min_dirty_count = (m_transform_table_min_dirty_count == 0)
+        ? 0
+        : std::max(m_transform_table_min_dirty_count, get_node_count() / c_transform_table_nodes_per_dirty_node);
+    if ((m_transform_dirty_processing.size() >= table_min_dirty_count) && update_table_transforms()) {
+        m_transform_dirty_processing.clear();
+        m_updating_node_transforms = false;
+        return;
+    }
+
     // Ancestors first: when a dirty node lies inside another dirty node's
     // subtree, the ancestor's walk updates it (and records it in the visited
     // set), so its own entry is skipped instead of re-walking the subtree.
@@ -327,13 +354,7 @@ void Scene::update_node_transforms()
     }
 
     const std::chrono::steady_clock::time_point time_after_propagate = std::chrono::steady_clock::now();
-    const auto to_ms = [](const std::chrono::steady_clock::duration duration) -> double {
-        return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()) * 1.0e-6;
-    };
-    m_transform_update_stats.pass_count    += 1;
-    m_transform_update_stats.dirty_count   += m_transform_dirty_processing.size();
     m_transform_update_stats.visited_count += m_transform_update_visited.size();
-    m_transform_update_stats.lock_wait_ms  += to_ms(time_after_lock      - time_before_lock);
     m_transform_update_stats.sort_ms       += to_ms(time_after_sort      - time_after_lock);
     m_transform_update_stats.propagate_ms  += to_ms(time_after_propagate - time_after_sort);
 
@@ -341,6 +362,48 @@ void Scene::update_node_transforms()
     m_updating_node_transforms = false;
 }
 
+auto Scene::update_table_transforms() -> bool
+{
+    ERHE_PROFILE_FUNCTION();
+
+    const std::chrono::steady_clock::time_point time_before_flatten = std::chrono::steady_clock::now();
+    if (!m_transform_table.is_valid()) {
+        m_transform_table.rebuild(*m_root_node);
+    }
+    const std::chrono::steady_clock::time_point time_after_flatten = std::chrono::steady_clock::now();
+    m_transform_update_stats.flatten_ms += to_ms(time_after_flatten - time_before_flatten);
+
+    for (const Node* node : m_transform_dirty_processing) {
+        const Transform_table::State state = node->node_data.transforms.scene_transform_dirty_by_owner
+            ? Transform_table::State::owner
+            : Transform_table::State::carry;
+        if (!m_transform_table.seed(*node, state)) {
+            // Not reachable from the root through the table (hierarchy
+            // changed without a hook): the serial walk handles this pass.
+            log->warn("Node {} not in transform table, using serial transform update", node->get_name());
+            m_transform_table.clear_seeds();
+            m_transform_table.invalidate();
+            return false;
+        }
+    }
+    for (const Node* node : m_transform_dirty_processing) {
+        node->node_data.transforms.scene_transform_dirty          = false;
+        node->node_data.transforms.scene_transform_dirty_by_owner = false;
+    }
+
+    m_transform_table.propagate();
+    const std::chrono::steady_clock::time_point time_after_propagate = std::chrono::steady_clock::now();
+
+    const std::size_t touched_count = m_transform_table.apply();
+    const std::chrono::steady_clock::time_point time_after_apply = std::chrono::steady_clock::now();
+
+    m_transform_update_stats.table_pass_count += 1;
+    m_transform_update_stats.visited_count    += touched_count;
+    m_transform_update_stats.propagate_ms     += to_ms(time_after_propagate - time_after_flatten);
+    m_transform_update_stats.apply_ms         += to_ms(time_after_apply     - time_after_propagate);
+    return true;
+}
+
 void Scene::update_subtree_transforms(Node& node, const bool carry_body_driven)
 {
     // The dirty node itself is already up to date: every write path updates
@@ -462,6 +525,7 @@ void Scene::register_node(const std::shared_ptr<erhe::scene::Node>& node)
         // node_data wholesale); reset it so the node can be enqueued here.
         node->node_data.transforms.scene_transform_dirty = false;
         mark_node_transform_dirty(*node);
+        m_transform_table.invalidate();
     }
 
     ERHE_VERIFY(!node->get_parent().expired());
@@ -501,6 +565,8 @@ void Scene::unregister_node(const std::shared_ptr<erhe::scene::Node>& node)
         }
     }
 
+    m_transform_table.invalidate();
+
 #if !defined(NDEBUG)
     sanity_check();
 #endif
@@ -508,6 +574,7 @@ void Scene::unregister_node(const std::shared_ptr<erhe::scene::Node>& node)
 
 void Scene::handle_node_no_transform_update_changed(Node& node)
 {
+    m_transform_table.invalidate(); // the table mirrors the flag
     // The node moves out of the bucket that no longer matches its flag value.
     auto* source_bucket = node.is_no_transform_update() ? &m_transform_update_nodes    : &m_no_transform_update_nodes;
     auto* target_bucket = node.is_no_transform_update() ? &m_no_transform_update_nodes : &m_transform_update_nodes;
@@ -2,6 +2,7 @@
 
 #include "erhe_item/item.hpp"
 #include "erhe_item/unique_id.hpp"
+#include "erhe_scene/transform_table.hpp"
 
 #include <glm/glm.hpp>
 
@@ -92,6 +93,13 @@ public:
     // Per-pass cost of update_node_transforms(), accumulated across passes
     // until sampled. Passes with an empty dirty list record nothing, so the
     // steady-state overhead is a single clock read per pass.
+    //
+    // Passes with at least get_transform_table_min_dirty_count() dirty nodes
+    // use the flat Transform_table instead of the serial subtree walk
+    // (table_pass_count): flatten_ms is the table rebuild after hierarchy
+    // changes, propagate_ms the level-by-level (parallel) world transform
+    // computation, apply_ms the main-thread write-back and attachment
+    // notification. Serial passes report sort_ms and propagate_ms only.
     class Transform_update_stats
     {
     public:
@@ -101,26 +109,45 @@ public:
         }
         void add(const Transform_update_stats& other)
         {
-            pass_count    += other.pass_count;
-            dirty_count   += other.dirty_count;
-            visited_count += other.visited_count;
-            lock_wait_ms  += other.lock_wait_ms;
-            sort_ms       += other.sort_ms;
-            propagate_ms  += other.propagate_ms;
+            pass_count       += other.pass_count;
+            table_pass_count += other.table_pass_count;
+            dirty_count      += other.dirty_count;
+            visited_count    += other.visited_count;
+            lock_wait_ms     += other.lock_wait_ms;
+            sort_ms          += other.sort_ms;
+            flatten_ms       += other.flatten_ms;
+            propagate_ms     += other.propagate_ms;
+            apply_ms         += other.apply_ms;
         }
         [[nodiscard]] auto total_ms() const -> double
         {
-            return lock_wait_ms + sort_ms + propagate_ms;
+            return lock_wait_ms + sort_ms + flatten_ms + propagate_ms + apply_ms;
         }
 
-        std::size_t pass_count   {0}; // update_node_transforms() passes that had work
-        std::size_t dirty_count  {0}; // dirty-list entries swapped in and sorted
-        std::size_t visited_count{0}; // unique nodes recorded in the visited set (dirty roots + subtree descendants updated)
-        double      lock_wait_ms {0.0};
-        double      sort_ms     {0.0};
-        double      propagate_ms{0.0};
+        std::size_t pass_count      {0}; // update_node_transforms() passes that had work
+        std::size_t table_pass_count{0}; // of those, passes that used the Transform_table
+        std::size_t dirty_count     {0}; // dirty-list entries swapped in and sorted
+        std::size_t visited_count   {0}; // unique nodes recorded in the visited set (dirty roots + subtree descendants updated)
+        double      lock_wait_ms    {0.0};
+        double      sort_ms         {0.0};
+        double      flatten_ms      {0.0};
+        double      propagate_ms    {0.0};
+        double      apply_ms        {0.0};
     };
 
+    // Dirty node count from which update_node_transforms() propagates through
+    // the flat Transform_table (O(scene nodes), level-parallel on the scene
+    // executor) instead of walking each dirty subtree (O(moved nodes)). The
+    // effective threshold grows with the scene: at least one dirty node per
+    // c_transform_table_nodes_per_dirty_node scene nodes is also required.
+    // 0 always uses the table; std::numeric_limits<std::size_t>::max() never.
+    static constexpr std::size_t c_transform_table_nodes_per_dirty_node = 16;
+    void set_transform_table_min_dirty_count(std::size_t count) { m_transform_table_min_dirty_count = count; }
+    [[nodiscard]] auto get_transform_table_min_dirty_count() const -> std::size_t { return m_transform_table_min_dirty_count; }
+    // Called by Node::handle_parent_update() and the node registration hooks:
+    // the Transform_table is rebuilt before its next use.
+    void invalidate_transform_table() { m_transform_table.invalidate(); }
+
     // Returns the stats accumulated since the previous sample and resets the
     // accumulator. Main thread only (the same thread that runs the passes).
     [[nodiscard]] auto sample_transform_update_stats() -> Transform_update_stats
@@ -238,6 +265,9 @@ public:
 
 private:
     void update_subtree_transforms(Node& node, bool carry_body_driven);
+    // The Transform_table path of update_node_transforms(); false (nothing
+    // done) when a dirty node is not in the table.
+    auto update_table_transforms() -> bool;
 
     Scene_host*                               m_host       {nullptr};
     std::shared_ptr<erhe::scene::Node>        m_root_node;
@@ -261,6 +291,8 @@ private:
     std::vector<Node*>                        m_transform_dirty_processing;
     std::unordered_set<const Node*>           m_transform_update_visited;
     Transform_update_stats                    m_transform_update_stats;
+    Transform_table                           m_transform_table;
+    std::size_t                               m_transform_table_min_dirty_count{64};
     bool                                      m_updating_node_transforms{false};
     // See set_transform_owner_writes().
     bool                                      m_transform_owner_writes{false};
@@ -0,0 +1,21 @@
+#include "erhe_scene/scene_executor.hpp"
+
+namespace erhe::scene {
+
+namespace {
+
+tf::Executor* g_executor{nullptr};
+
+}
+
+void set_executor(tf::Executor* executor)
+{
+    g_executor = executor;
+}
+
+auto get_executor() -> tf::Executor*
+{
+    return g_executor;
+}
+
+} // namespace erhe::scene
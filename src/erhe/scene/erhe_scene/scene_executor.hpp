@@ -0,0 +1,18 @@
+#pragma once
+
+namespace tf {
+    class Executor;
+}
+
+namespace erhe::scene {
+
+// Executor used for data parallel scene work: the level-by-level world
+// transform propagation of Scene::update_node_transforms() and the per skin
+// joint palettes of erhe::scene_renderer::Joint_palette_cache. The
+// application injects one at startup. When none is set, that work runs on
+// the calling thread, which keeps tests and headless tools deterministic.
+void set_executor(tf::Executor* executor);
+
+[[nodiscard]] auto get_executor() -> tf::Executor*;
+
+} // namespace erhe::scene
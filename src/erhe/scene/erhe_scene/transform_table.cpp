@@ -0,0 +1,205 @@
+#include "erhe_scene/transform_table.hpp"
+#include "erhe_scene/node.hpp"
+#include "erhe_scene/scene_executor.hpp"
+#include "erhe_profile/profile.hpp"
+#include "erhe_verify/verify.hpp"
+
+#include <taskflow/taskflow.hpp>
+#include <taskflow/algorithm/for_each.hpp>
+
+#include <limits>
+
+namespace erhe::scene {
+
+auto Transform_table::rebuild(Node& root) -> std::size_t
+{
+    ERHE_PROFILE_FUNCTION();
+
+    // A node that left the table keeps a stale index; seed() checks the
+    // entry, so clearing the old indices is not needed.
+    m_nodes.clear();
+    m_parent_index.clear();
+    m_level_begin.clear();
+    m_no_transform_update.clear();
+
+    m_nodes.push_back(&root);
+    m_parent_index.push_back(0);
+    m_level_begin.push_back(0);
+    std::size_t level_begin = 0;
+    while (level_begin < m_nodes.size()) {
+        const std::size_t level_end = m_nodes.size();
+        for (std::size_t i = level_begin; i < level_end; ++i) {
+            for (const std::shared_ptr<erhe::Hierarchy>& child : m_nodes[i]->get_children()) {
+                if (!erhe::is<Node>(child.get())) {
+                    continue;
+                }
+                m_nodes.push_back(static_cast<Node*>(child.get()));
+                m_parent_index.push_back(static_cast<uint32_t>(i));
+            }
+        }
+        m_level_begin.push_back(level_end);
+        level_begin = level_end;
+    }
+    ERHE_VERIFY(m_nodes.size() < std::numeric_limits<uint32_t>::max());
+
+    const std::size_t node_count = m_nodes.size();
+    m_no_transform_update.resize(node_count);
+    for (std::size_t i = 0; i < node_count; ++i) {
+        m_nodes[i]->node_data.transforms.transform_table_index = static_cast<uint32_t>(i);
+        m_no_transform_update[i] = m_nodes[i]->is_no_transform_update() ? 1 : 0;
+    }
+    m_world_from_node     .resize(node_count);
+    m_seed                .assign(node_count, State::unchanged);
+    m_state               .resize(node_count);
+    m_recomputed          .resize(node_count);
+    m_negative_determinant.resize(node_count);
+    m_seeded_indices.clear();
+
+    m_structure_valid = true;
+    return node_count;
+}
+
+auto Transform_table::seed(const Node& node, const State state) -> bool
+{
+    ERHE_VERIFY(m_structure_valid);
+    const std::size_t index = node.node_data.transforms.transform_table_index;
+    if ((index >= m_nodes.size()) || (m_nodes[index] != &node)) {
+        return false;
+    }
+    if (m_seed[index] == State::unchanged) {
+        m_seeded_indices.push_back(index);
+    }
+    // Several writers dirtied the same node: carry wins, as in
+    // Scene::mark_node_transform_dirty().
+    if ((m_seed[index] == State::unchanged) || (state == State::carry)) {
+        m_seed[index] = state;
+    }
+    return true;
+}
+
+void Transform_table::clear_seeds()
+{
+    for (const std::size_t index : m_seeded_indices) {
+        m_seed[index] = State::unchanged;
+    }
+    m_seeded_indices.clear();
+}
+
+void Transform_table::propagate_entry(const std::size_t index)
+{
+    // Same rules as Scene::update_subtree_transforms(): a seeded node is
+    // already up to date (its writer updated it eagerly), descendants of a
+    // changed node are recomputed, and owner dirt does not carry
+    // no_transform_update branches. Inheriting from an ancestor takes
+    // precedence over the node's own seed, like the serial visited set.
+    State inherited = State::unchanged;
+    if (index > 0) {
+        const std::size_t parent_index = m_parent_index[index];
+        const State       parent_state = m_state[parent_index];
+        if ((parent_state == State::carry) || ((parent_state == State::owner) && (m_no_transform_update[index] == 0))) {
+            inherited = parent_state;
+        }
+        if (inherited != State::unchanged) {
+            const glm::mat4 world_from_node = m_world_from_node[parent_index] * m_nodes[index]->parent_from_node();
+            m_world_from_node     [index] = world_from_node;
+            m_negative_determinant[index] = (glm::determinant(glm::mat3{world_from_node}) < 0.0f) ? 1 : 0;
+            m_state               [index] = inherited;
+            m_recomputed          [index] = 1;
+            return;
+        }
+    }
+    m_recomputed[index] = 0;
+    m_state     [index] = m_seed[index];
+    if (m_seed[index] != State::unchanged) {
+        m_world_from_node[index] = m_nodes[index]->world_from_node();
+    }
+}
+
+void Transform_table::propagate_range(const std::size_t begin, const std::size_t end)
+{
+    for (std::size_t i = begin; i < end; ++i) {
+        propagate_entry(i);
+    }
+}
+
+void Transform_table::propagate()
+{
+    ERHE_PROFILE_FUNCTION();
+    ERHE_VERIFY(m_structure_valid);
+
+    const std::size_t level_count = this->level_count();
+    tf::Executor* const executor = get_executor();
+    if (executor == nullptr) {
+        propagate_range(0, m_nodes.size());
+        return;
+    }
+
+    // One task chain: small consecutive levels are merged into one inline
+    // task (they are already in dependency order), each large level becomes
+    // a parallel for over its index range.
+    tf::Taskflow taskflow;
+    tf::Task     previous;
+    std::size_t  inline_begin = 0;
+    const auto chain = [&previous](tf::Task task) {
+        if (!previous.empty()) {
+            previous.precede(task);
+        }
+        previous = task;
+    };
+    for (std::size_t level = 0; level < level_count; ++level) {
+        const std::size_t begin = m_level_begin[level];
+        const std::size_t end   = m_level_begin[level + 1];
+        if ((end - begin) < c_parallel_level_size) {
+            continue;
+        }
+        if (inline_begin < begin) {
+            chain(taskflow.emplace([this, inline_begin, begin]() { propagate_range(inline_begin, begin); }));
+        }
+        chain(
+            taskflow.for_each_index(
+                begin,
+                end,
+                std::size_t{1},
+                [this](const std::size_t i) { propagate_entry(i); },
+                tf::StaticPartitioner{c_parallel_level_size / 4}
+            )
+        );
+        inline_begin = end;
+    }
+    if (taskflow.empty()) {
+        propagate_range(0, m_nodes.size());
+        return;
+    }
+    if (inline_begin < m_nodes.size()) {
+        chain(taskflow.emplace([this, inline_begin]() { propagate_range(inline_begin, m_nodes.size()); }));
+    }
+    if (executor->this_worker_id() >= 0) {
+        executor->corun(taskflow);
+    } else {
+        executor->run(taskflow).wait();
+    }
+}
+
+auto Transform_table::apply() -> std::size_t
+{
+    ERHE_PROFILE_FUNCTION();
+    ERHE_VERIFY(m_structure_valid);
+
+    std::size_t touched_count = 0;
+    for (std::size_t i = 0, end = m_nodes.size(); i < end; ++i) {
+        if (m_state[i] == State::unchanged) {
+            continue;
+        }
+        ++touched_count;
+        if (m_recomputed[i] == 0) {
+            continue;
+        }
+        // Parents are applied first, so the parent serial is this pass's.
+        const uint64_t serial = m_nodes[m_parent_index[i]]->node_data.transforms.parent_from_node_serial;
+        m_nodes[i]->apply_propagated_world_from_node(m_world_from_node[i], m_negative_determinant[i] != 0, serial);
+    }
+    clear_seeds();
+    return touched_count;
+}
+
+} // namespace erhe::scene
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace erhe::scene {
+
+class Node;
+
+// Flattened, depth-ordered mirror of a scene's node hierarchy for the
+// data-parallel path of Scene::update_node_transforms(). Nodes are stored
+// breadth first from the scene root, so every depth level is one contiguous
+// index range and every parent precedes its children; parent links are
+// indices. The per-node columns (local / world matrices, propagation state)
+// are structure-of-arrays so one level can be propagated in parallel
+// without touching the Node objects beyond reading their local transform.
+//
+// The structure is rebuilt lazily: the hierarchy mutation hooks
+// (Scene::register_node / unregister_node, Node::handle_parent_update) only
+// call invalidate(). Only the owning Scene uses this class, under its
+// Item_host mutex.
+class Transform_table
+{
+public:
+    // Propagation state of one node in the current pass. owner: moved by the
+    // owner of no_transform_update transforms only (the physics writeback),
+    // so no_transform_update children are not carried; see
+    // Scene::Transform_owner_writes_scope.
+    enum class State : uint8_t {
+        unchanged = 0,
+        carry     = 1,
+        owner     = 2
+    };
+
+    void invalidate() { m_structure_valid = false; }
+    [[nodiscard]] auto is_valid() const -> bool { return m_structure_valid; }
+
+    // Walks the hierarchy under root breadth first. Returns the number of
+    // nodes in the table.
+    auto rebuild(Node& root) -> std::size_t;
+
+    // Seeds a dirty node for the next propagate(). False when the node is
+    // not in the table (then the caller must use the serial walk and
+    // clear_seeds()).
+    [[nodiscard]] auto seed(const Node& node, State state) -> bool;
+    void clear_seeds();
+
+    // Computes world transforms of every node under a seeded node, level by
+    // level; levels of at least c_parallel_level_size nodes run on the
+    // scene executor (scene_executor.hpp) when one is set. Only reads the
+    // nodes.
+    void propagate();
+
+    // Writes the recomputed world transforms back to the nodes in depth
+    // order (parents before children) through
+    // Node::apply_propagated_world_from_node(), then clears the seeds.
+    // Main thread (attachments are notified). Returns the number of nodes
+    // touched (seeded or recomputed).
+    auto apply() -> std::size_t;
+
+    [[nodiscard]] auto size       () const -> std::size_t { return m_nodes.size(); }
+    [[nodiscard]] auto level_count() const -> std::size_t { return (m_level_begin.size() > 0) ? (m_level_begin.size() - 1) : 0; }
+
+    // Levels smaller than this run inline, merged with their neighbours.
+    static constexpr std::size_t c_parallel_level_size = 512;
+
+private:
+    void propagate_range(std::size_t begin, std::size_t end);
+    void propagate_entry(std::size_t index);
+
+    bool                     m_structure_valid{false};
+    std::vector<Node*>       m_nodes;          // breadth first, m_nodes[0] is the root
+    std::vector<uint32_t>    m_parent_index;   // m_parent_index[0] is unused
+    std::vector<std::size_t> m_level_begin;    // level L is [m_level_begin[L], m_level_begin[L + 1])
+    std::vector<uint8_t>     m_no_transform_update;
+    std::vector<glm::mat4>   m_world_from_node;
+    std::vector<State>       m_seed;
+    std::vector<State>       m_state;
+    std::vector<uint8_t>     m_recomputed;
+    std::vector<uint8_t>     m_negative_determinant;
+    std::vector<std::size_t> m_seeded_indices;
+};
+
+} // namespace erhe::scene
@@ -12,7 +12,8 @@
 #include "erhe_scene/animation.hpp"
 #include "erhe_scene/node.hpp"
 #include "erhe_scene/scene.hpp"
-#include "erhe_scene/scene_host.hpp"
+
+#include "test_scene_host.hpp"
 
 #include <gtest/gtest.h>
 
@@ -23,36 +24,7 @@
 
 namespace {
 
-class Test_scene_host : public erhe::scene::Scene_host
-{
-public:
-    Test_scene_host() : scene{"test scene", this} {}
-
-    auto get_host_name   () const -> const char*        override { return "Test_scene_host"; }
-    auto get_hosted_scene()       -> erhe::scene::Scene* override { return &scene; }
-
-    void register_node    (const std::shared_ptr<erhe::scene::Node>&   node)   override { scene.register_node  (node); }
-    void unregister_node  (const std::shared_ptr<erhe::scene::Node>&   node)   override { scene.unregister_node(node); }
-    void register_camera  (const std::shared_ptr<erhe::scene::Camera>&)        override {}
-    void unregister_camera(const std::shared_ptr<erhe::scene::Camera>&)        override {}
-    void register_mesh    (const std::shared_ptr<erhe::scene::Mesh>&)          override {}
-    void unregister_mesh  (const std::shared_ptr<erhe::scene::Mesh>&)          override {}
-    void register_skin    (const std::shared_ptr<erhe::scene::Skin>&)          override {}
-    void unregister_skin  (const std::shared_ptr<erhe::scene::Skin>&)          override {}
-    void register_light   (const std::shared_ptr<erhe::scene::Light>&)         override {}
-    void unregister_light (const std::shared_ptr<erhe::scene::Light>&)         override {}
-    void register_layout  (const std::shared_ptr<erhe::scene::Layout>&)        override {}
-    void unregister_layout(const std::shared_ptr<erhe::scene::Layout>&)        override {}
-
-    void on_mesh_primitives_changed    (const std::shared_ptr<erhe::scene::Mesh>&) override {}
-    void on_mesh_material_changed      (const std::shared_ptr<erhe::scene::Mesh>&) override {}
-    void on_mesh_flags_changed         (const std::shared_ptr<erhe::scene::Mesh>&, uint64_t, uint64_t) override {}
-    void on_mesh_transform_changed     (const std::shared_ptr<erhe::scene::Mesh>&) override {}
-    void on_mesh_primitive_data_changed(const std::shared_ptr<erhe::scene::Mesh>&) override {}
-    void on_light_changed              (const std::shared_ptr<erhe::scene::Light>&) override {}
-
-    erhe::scene::Scene scene;
-};
+using erhe::scene::test::Test_scene_host;
 
 // One translation channel on X: key 0 at t=0, key 10 at t=1.
 // Fills in place: Animation's copy constructor is explicit, so it cannot be
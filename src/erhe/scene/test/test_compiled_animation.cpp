@@ -0,0 +1,405 @@
+// Animation_instance against Animation_sampler::evaluate() and
+// Animation::apply(): the compiled playback path must give the same pose for
+// every interpolation mode, keep doing so across seeks, and pick up edits
+// reported through Animation::mark_data_changed().
+
+#include "erhe_benchmark/benchmark.hpp"
+#include "erhe_scene/animation.hpp"
+#include "erhe_scene/compiled_animation.hpp"
+#include "erhe_scene/node.hpp"
+#include "erhe_scene/scene.hpp"
+
+#include "test_scene_host.hpp"
+
+#include <fmt/format.h>
+
+#include <gtest/gtest.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <taskflow/taskflow.hpp>
+#include <taskflow/algorithm/for_each.hpp>
+
+#include <cmath>
+#include <memory>
+#include <vector>
+
+namespace {
+
+using erhe::scene::test::Test_scene_host;
+
+constexpr float tol = 1e-4f;
+
+using erhe::scene::Animation_interpolation_mode;
+using erhe::scene::Animation_path;
+
+void add_channel(
+    erhe::scene::Animation&                   animation,
+    const Animation_path                      path,
+    const Animation_interpolation_mode        mode,
+    std::vector<float>&&                      times,
+    std::vector<float>&&                      data,
+    const std::shared_ptr<erhe::scene::Node>& target
+)
+{
+    erhe::scene::Animation_sampler sampler{mode};
+    sampler.set(std::move(times), std::move(data));
+    animation.samplers.push_back(std::move(sampler));
+
+    erhe::scene::Animation_channel channel{};
+    channel.path           = path;
+    channel.sampler_index  = animation.samplers.size() - 1;
+    channel.target         = target;
+    channel.start_position = 0;
+    // CUBICSPLINE: value_offset skips the in tangent of the key block
+    channel.value_offset   = (mode == Animation_interpolation_mode::CUBICSPLINE) ? erhe::scene::get_component_count(path) : 0;
+    animation.channels.push_back(channel);
+}
+
+[[nodiscard]] auto axis_angle(const glm::vec3 axis, const float angle) -> std::vector<float>
+{
+    const glm::quat q = glm::angleAxis(angle, glm::normalize(axis));
+    return std::vector<float>{q.x, q.y, q.z, q.w};
+}
+
+[[nodiscard]] auto concat(std::initializer_list<std::vector<float>> parts) -> std::vector<float>
+{
+    std::vector<float> result;
+    for (const std::vector<float>& part : parts) {
+        result.insert(result.end(), part.begin(), part.end());
+    }
+    return result;
+}
+
+// Two nodes covering every interpolation mode and path. Linear rotation
+// keys 0 and 1 are stored with a negative dot product, which exercises the
+// shortest path flip; keys 2 and 3 are nearly equal (linear mix branch).
+void make_mixed_animation(
+    erhe::scene::Animation&                   animation,
+    const std::shared_ptr<erhe::scene::Node>& a,
+    const std::shared_ptr<erhe::scene::Node>& b
+)
+{
+    const std::vector<float> times{0.0f, 0.5f, 1.25f, 2.0f};
+    add_channel(
+        animation, Animation_path::TRANSLATION, Animation_interpolation_mode::LINEAR, std::vector<float>{times},
+        std::vector<float>{0.0f, 0.0f, 0.0f,  4.0f, 1.0f, 0.0f,  4.0f, 3.0f, -2.0f,  0.0f, 0.0f, 1.0f},
+        a
+    );
+    const std::vector<float> q0 = axis_angle(glm::vec3{0.0f, 1.0f, 0.0f}, 0.0f);
+    std::vector<float>       q1 = axis_angle(glm::vec3{0.0f, 1.0f, 0.0f}, 1.5f);
+    for (float& f : q1) {
+        f = -f;
+    }
+    add_channel(
+        animation, Animation_path::ROTATION, Animation_interpolation_mode::LINEAR, std::vector<float>{times},
+        concat({q0, q1, axis_angle(glm::vec3{1.0f, 1.0f, 0.0f}, 2.5f), axis_angle(glm::vec3{1.0f, 1.0f, 0.0f}, 2.5001f)}),
+        a
+    );
+    add_channel(
+        animation, Animation_path::SCALE, Animation_interpolation_mode::STEP, std::vector<float>{0.0f, 1.0f},
+        std::vector<float>{1.0f, 1.0f, 1.0f,  2.0f, 0.5f, 3.0f},
+        a
+    );
+    // Cubic blocks: in tangent, value, out tangent
+    add_channel(
+        animation, Animation_path::TRANSLATION, Animation_interpolation_mode::CUBICSPLINE, std::vector<float>{0.0f, 0.75f, 2.0f},
+        std::vector<float>{
+            0.0f, 0.0f, 0.0f,   1.0f, 2.0f, 3.0f,   4.0f, 0.0f, -1.0f,
+            1.0f, 1.0f, 1.0f,   5.0f, 2.0f, 0.0f,   2.0f, -3.0f, 0.0f,
+            0.0f, 2.0f, 0.0f,  -1.0f, 0.0f, 1.0f,   0.0f, 0.0f,  0.0f
+        },
+        b
+    );
+    add_channel(
+        animation, Animation_path::ROTATION, Animation_interpolation_mode::CUBICSPLINE, std::vector<float>{0.0f, 2.0f},
+        concat({
+            std::vector<float>{0.0f, 0.0f, 0.0f, 0.0f}, q0, std::vector<float>{0.0f, 0.5f, 0.0f, 0.0f},
+            std::vector<float>{0.0f, 0.5f, 0.0f, 0.0f}, axis_angle(glm::vec3{0.0f, 0.0f, 1.0f}, 1.0f), std::vector<float>{0.0f, 0.0f, 0.0f, 0.0f}
+        }),
+        b
+    );
+}
+
+[[nodiscard]] auto get_node_value(const erhe::scene::Node& node, const Animation_path path) -> glm::vec4
+{
+    const erhe::scene::Trs_transform& trs = node.node_data.transforms.parent_from_node;
+    switch (path) {
+        case Animation_path::TRANSLATION: return glm::vec4{trs.get_translation(), 0.0f};
+        case Animation_path::ROTATION: {
+            const glm::quat q = trs.get_rotation();
+            return glm::vec4{q.x, q.y, q.z, q.w};
+        }
+        case Animation_path::SCALE:       return glm::vec4{trs.get_scale(), 0.0f};
+        default:                          return glm::vec4{0.0f};
+    }
+}
+
+void expect_matches_sampler(erhe::scene::Animation& animation, const float time)
+{
+    for (std::size_t i = 0, end = animation.channels.size(); i < end; ++i) {
+        erhe::scene::Animation_channel channel = animation.channels[i]; // private seek position
+        channel.start_position = 0;
+        const glm::vec4 expected = animation.samplers[channel.sampler_index].evaluate(channel, time);
+        const glm::vec4 actual   = get_node_value(*channel.target, channel.path);
+        // q and -q are the same rotation
+        const float sign = ((channel.path == Animation_path::ROTATION) && (glm::dot(expected, actual) < 0.0f)) ? -1.0f : 1.0f;
+        for (int c = 0; c < 4; ++c) {
+            EXPECT_NEAR(expected[c], sign * actual[c], tol) << "time " << time << " channel " << i << " component " << c;
+        }
+    }
+}
+
+TEST(compiled_animation, matches_sampler_evaluate)
+{
+    Test_scene_host host;
+    auto a = std::make_shared<erhe::scene::Node>("a");
+    auto b = std::make_shared<erhe::scene::Node>("b");
+    a->set_parent(host.scene.get_root_node());
+    b->set_parent(host.scene.get_root_node());
+
+    auto animation = std::make_shared<erhe::scene::Animation>("mixed");
+    make_mixed_animation(*animation.get(), a, b);
+
+    erhe::scene::Animation_instance instance{animation};
+    EXPECT_EQ(instance.get_compiled().tracks.size(),       5u);
+    EXPECT_EQ(instance.get_compiled().target_slots.size(), 2u);
+
+    // Playback forward, past the end, then seeks back and before the start.
+    std::vector<float> times;
+    for (int i = 0; i <= 50; ++i) {
+        times.push_back(0.05f * static_cast<float>(i));
+    }
+    for (const float time : {0.5f, 1.25f, 1.9f, 0.1f, -1.0f, 0.75f, 2.0f, 0.0f}) {
+        times.push_back(time);
+    }
+    for (const float time : times) {
+        instance.set_time(time);
+        instance.apply();
+        expect_matches_sampler(*animation.get(), time);
+    }
+}
+
+TEST(compiled_animation, holds_on_malformed_data)
+{
+    Test_scene_host host;
+    auto node = std::make_shared<erhe::scene::Node>("node");
+    node->set_parent(host.scene.get_root_node());
+
+    auto animation = std::make_shared<erhe::scene::Animation>("malformed");
+    // Third key has no value
+    add_channel(
+        *animation.get(), Animation_path::TRANSLATION, Animation_interpolation_mode::LINEAR,
+        std::vector<float>{0.0f, 1.0f, 2.0f},
+        std::vector<float>{1.0f, 2.0f, 3.0f,  4.0f, 5.0f, 6.0f},
+        node
+    );
+    // No keys at all: identity
+    add_channel(
+        *animation.get(), Animation_path::SCALE, Animation_interpolation_mode::LINEAR,
+        std::vector<float>{},
+        std::vector<float>{},
+        node
+    );
+
+    erhe::scene::Animation_instance instance{animation};
+    for (const float time : {-1.0f, 0.0f, 0.5f, 1.0f, 1.5f, 2.0f, 3.0f}) {
+        instance.set_time(time);
+        instance.apply();
+        expect_matches_sampler(*animation.get(), time);
+    }
+}
+
+TEST(compiled_animation, recompiles_after_edits)
+{
+    Test_scene_host host;
+    auto a = std::make_shared<erhe::scene::Node>("a");
+    auto b = std::make_shared<erhe::scene::Node>("b");
+    a->set_parent(host.scene.get_root_node());
+    b->set_parent(host.scene.get_root_node());
+
+    auto animation = std::make_shared<erhe::scene::Animation>("edited");
+    add_channel(
+        *animation.get(), Animation_path::TRANSLATION, Animation_interpolation_mode::LINEAR,
+        std::vector<float>{0.0f, 1.0f},
+        std::vector<float>{0.0f, 0.0f, 0.0f,  10.0f, 0.0f, 0.0f},
+        a
+    );
+
+    erhe::scene::Animation_instance instance{animation};
+    instance.set_time(0.5f);
+    instance.apply();
+    EXPECT_NEAR(a->node_data.transforms.parent_from_node.get_translation().x, 5.0f, tol);
+
+    animation->samplers[0].data[3] = 20.0f;
+    animation->mark_data_changed();
+    instance.apply();
+    EXPECT_NEAR(a->node_data.transforms.parent_from_node.get_translation().x, 10.0f, tol);
+
+    // Retargeting is noticed without mark_data_changed()
+    animation->channels[0].target = b;
+    instance.apply();
+    EXPECT_NEAR(b->node_data.transforms.parent_from_node.get_translation().x, 10.0f, tol);
+
+    animation->channels[0].target.reset();
+    instance.apply();
+    EXPECT_TRUE(instance.get_compiled().tracks.empty());
+}
+
+TEST(compiled_animation, apply_moves_children)
+{
+    Test_scene_host host;
+    auto parent = std::make_shared<erhe::scene::Node>("animated parent");
+    auto child  = std::make_shared<erhe::scene::Node>("child");
+    parent->set_parent(host.scene.get_root_node());
+    child->set_parent(parent);
+    child->set_parent_from_node(glm::translate(glm::mat4{1.0f}, glm::vec3{0.0f, 2.0f, 0.0f}));
+
+    auto animation = std::make_shared<erhe::scene::Animation>("parent");
+    add_channel(
+        *animation.get(), Animation_path::TRANSLATION, Animation_interpolation_mode::LINEAR,
+        std::vector<float>{0.0f, 1.0f},
+        std::vector<float>{0.0f, 0.0f, 0.0f,  10.0f, 0.0f, 0.0f},
+        parent
+    );
+
+    erhe::scene::Animation_instance instance{animation};
+    instance.set_time(1.0f);
+    instance.apply();
+    host.scene.update_node_transforms();
+
+    EXPECT_FLOAT_EQ(child->world_from_node()[3][0], 10.0f);
+    EXPECT_FLOAT_EQ(child->world_from_node()[3][1],  2.0f);
+}
+
+TEST(compiled_animation, concurrent_evaluate_matches_sampler)
+{
+    constexpr std::size_t count = 64;
+
+    Test_scene_host host;
+    std::vector<std::shared_ptr<erhe::scene::Animation>> animations;
+    std::vector<std::unique_ptr<erhe::scene::Animation_instance>> instances;
+    std::vector<erhe::scene::Animation_instance*> instance_pointers;
+    for (std::size_t i = 0; i < count; ++i) {
+        auto a = std::make_shared<erhe::scene::Node>("a");
+        auto b = std::make_shared<erhe::scene::Node>("b");
+        a->set_parent(host.scene.get_root_node());
+        b->set_parent(host.scene.get_root_node());
+        auto animation = std::make_shared<erhe::scene::Animation>("mixed");
+        make_mixed_animation(*animation.get(), a, b);
+        animations.push_back(animation);
+        instances.push_back(std::make_unique<erhe::scene::Animation_instance>(animation));
+        instances.back()->set_time(0.03f * static_cast<float>(i));
+        instance_pointers.push_back(instances.back().get());
+    }
+
+    // evaluate() reads only its own instance: prepare on this thread,
+    // evaluate on workers, write the poses back on this thread
+    for (erhe::scene::Animation_instance* instance : instance_pointers) {
+        instance->prepare();
+    }
+    tf::Executor executor{4};
+    tf::Taskflow taskflow;
+    taskflow.for_each_index(
+        std::size_t{0},
+        count,
+        std::size_t{1},
+        [&instance_pointers](const std::size_t i) { instance_pointers[i]->evaluate(); }
+    );
+    executor.run(taskflow).wait();
+    const uint64_t serial = erhe::scene::Node_transforms::get_next_serial();
+    for (erhe::scene::Animation_instance* instance : instance_pointers) {
+        instance->write_pose(serial);
+    }
+
+    for (std::size_t i = 0; i < count; ++i) {
+        expect_matches_sampler(*animations[i].get(), instances[i]->get_time());
+    }
+}
+
+// Crowd playback: per character one animation with rotation keys on every
+// joint and translation on the root, at 30 keys per second. Compares
+// Animation::apply() against Animation_instance::apply() per character.
+ERHE_BENCHMARK(compiled_animation, crowd)
+{
+    constexpr std::size_t character_count = 1000;
+    constexpr std::size_t joint_count     = 32;
+    constexpr std::size_t key_count       = 90;
+    constexpr float       key_rate        = 30.0f;
+
+    Test_scene_host host;
+    std::vector<std::shared_ptr<erhe::scene::Animation>> animations;
+    for (std::size_t character = 0; character < character_count; ++character) {
+        std::vector<float> times;
+        for (std::size_t key = 0; key < key_count; ++key) {
+            times.push_back(static_cast<float>(key) / key_rate);
+        }
+
+        auto animation = std::make_shared<erhe::scene::Animation>("crowd");
+        auto root = std::make_shared<erhe::scene::Node>("character");
+        root->set_parent(host.scene.get_root_node());
+        std::vector<float> root_translations;
+        for (std::size_t key = 0; key < key_count; ++key) {
+            const float f = static_cast<float>(key);
+            root_translations.insert(root_translations.end(), {static_cast<float>(character % 40), 0.01f * f, static_cast<float>(character / 40) + 0.05f * f});
+        }
+        add_channel(*animation.get(), Animation_path::TRANSLATION, Animation_interpolation_mode::LINEAR, std::vector<float>{times}, std::move(root_translations), root);
+
+        std::shared_ptr<erhe::scene::Node> parent = root;
+        for (std::size_t joint_index = 0; joint_index < joint_count; ++joint_index) {
+            auto joint = std::make_shared<erhe::scene::Node>("joint");
+            joint->set_parent(parent);
+            std::vector<float> rotations;
+            for (std::size_t key = 0; key < key_count; ++key) {
+                const float angle = 0.5f * std::sin(0.2f * static_cast<float>(key + joint_index + character));
+                const std::vector<float> q = axis_angle(glm::vec3{1.0f, 0.3f * static_cast<float>(joint_index % 3), 0.0f}, angle);
+                rotations.insert(rotations.end(), q.begin(), q.end());
+            }
+            add_channel(*animation.get(), Animation_path::ROTATION, Animation_interpolation_mode::LINEAR, std::vector<float>{times}, std::move(rotations), joint);
+            parent = (joint_index % 8 == 7) ? root : joint;
+        }
+        animations.push_back(animation);
+    }
+    host.scene.update_node_transforms();
+
+    std::vector<std::unique_ptr<erhe::scene::Animation_instance>> instances;
+    for (const std::shared_ptr<erhe::scene::Animation>& animation : animations) {
+        instances.push_back(std::make_unique<erhe::scene::Animation_instance>(animation));
+    }
+
+    constexpr int   frame_count = 120;
+    constexpr float frame_time  = 1.0f / 60.0f;
+    for (const bool compiled : {false, true}) {
+        double animate_ms   = 0.0;
+        double transform_ms = 0.0;
+        for (int frame = 0; frame < frame_count; ++frame) {
+            const float time = frame_time * static_cast<float>(frame);
+            erhe::benchmark::Stopwatch stopwatch;
+            if (compiled) {
+                for (const std::unique_ptr<erhe::scene::Animation_instance>& instance : instances) {
+                    instance->set_time(time);
+                    instance->apply();
+                }
+            } else {
+                for (const std::shared_ptr<erhe::scene::Animation>& animation : animations) {
+                    animation->apply(time);
+                }
+            }
+            animate_ms   += stopwatch.lap_ms();
+            host.scene.update_node_transforms();
+            transform_ms += stopwatch.lap_ms();
+        }
+        fmt::print(
+            "{} characters, {} channels, {:<18}: animate {:.3f} ms, transforms {:.3f} ms per frame\n",
+            character_count,
+            character_count * (joint_count + 1),
+            compiled ? "Animation_instance" : "Animation::apply",
+            animate_ms   / frame_count,
+            transform_ms / frame_count
+        );
+    }
+}
+
+} // anonymous namespace
@@ -0,0 +1,220 @@
+// Scene::update_node_transforms() has two propagation paths: the serial
+// subtree walk (few dirty nodes) and the flat, level-parallel Transform_table
+// (many dirty nodes). Both must produce the same world transforms, including
+// the no_transform_update carry rules, and the table must follow hierarchy
+// changes made through the Hierarchy hooks.
+
+#include "erhe_scene/node.hpp"
+#include "erhe_scene/scene.hpp"
+#include "erhe_scene/scene_executor.hpp"
+
+#include "test_scene_host.hpp"
+
+#include <gtest/gtest.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <taskflow/taskflow.hpp>
+
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace {
+
+using erhe::scene::test::Test_scene_host;
+
+auto local_transform(const std::size_t i) -> glm::mat4
+{
+    const float f = static_cast<float>(i);
+    glm::mat4 m = glm::translate(glm::mat4{1.0f}, glm::vec3{0.25f * f, 1.0f, -0.5f * f});
+    m = glm::rotate(m, 0.01f * f, glm::normalize(glm::vec3{1.0f, 2.0f, 3.0f}));
+    // Every 7th node mirrored: exercises the negative determinant flag.
+    return glm::scale(m, ((i % 7) == 0) ? glm::vec3{-1.0f, 1.0f, 1.0f} : glm::vec3{1.0f});
+}
+
+// Root -> 8 chains of 4 -> 600 leaves per chain end: one level of 4800
+// nodes, larger than Transform_table::c_parallel_level_size. Every 10th leaf
+// is no_transform_update.
+class Test_hierarchy
+{
+public:
+    explicit Test_hierarchy(const std::size_t table_min_dirty_count)
+    {
+        host.scene.set_transform_table_min_dirty_count(table_min_dirty_count);
+        std::size_t serial = 0;
+        for (std::size_t chain = 0; chain < 8; ++chain) {
+            std::shared_ptr<erhe::scene::Node> parent = host.scene.get_root_node();
+            for (std::size_t depth = 0; depth < 4; ++depth) {
+                auto node = std::make_shared<erhe::scene::Node>("chain");
+                node->set_parent(parent);
+                node->set_parent_from_node(local_transform(serial++));
+                chain_nodes.push_back(node);
+                nodes.push_back(node);
+                parent = node;
+            }
+            for (std::size_t leaf = 0; leaf < 600; ++leaf) {
+                auto node = std::make_shared<erhe::scene::Node>("leaf");
+                node->set_parent(parent);
+                node->set_parent_from_node(local_transform(serial++));
+                if ((leaf % 10) == 0) {
+                    node->enable_flag_bits(erhe::Item_flags::no_transform_update);
+                }
+                leaf_nodes.push_back(node);
+                nodes.push_back(node);
+            }
+        }
+        host.scene.update_node_transforms();
+    }
+
+    Test_scene_host                                 host;
+    std::vector<std::shared_ptr<erhe::scene::Node>> nodes;
+    std::vector<std::shared_ptr<erhe::scene::Node>> chain_nodes;
+    std::vector<std::shared_ptr<erhe::scene::Node>> leaf_nodes;
+};
+
+void expect_same_world_transforms(const Test_hierarchy& serial, const Test_hierarchy& table)
+{
+    ASSERT_EQ(serial.nodes.size(), table.nodes.size());
+    for (std::size_t i = 0, end = serial.nodes.size(); i < end; ++i) {
+        const glm::mat4 a = serial.nodes[i]->world_from_node();
+        const glm::mat4 b = table .nodes[i]->world_from_node();
+        for (int column = 0; column < 4; ++column) {
+            for (int row = 0; row < 4; ++row) {
+                ASSERT_FLOAT_EQ(a[column][row], b[column][row]) << "node " << i;
+            }
+        }
+        ASSERT_EQ(
+            serial.nodes[i]->get_flag_bits() & erhe::Item_flags::negative_determinant,
+            table .nodes[i]->get_flag_bits() & erhe::Item_flags::negative_determinant
+        ) << "node " << i;
+    }
+}
+
+// Moves every chain node (32 dirty roots over 4800 descendants) and a few
+// leaves, in both hierarchies.
+void move_nodes(Test_hierarchy& hierarchy, const float offset)
+{
+    for (const std::shared_ptr<erhe::scene::Node>& node : hierarchy.chain_nodes) {
+        glm::mat4 m = node->parent_from_node();
+        m[3][0] += offset;
+        node->set_parent_from_node(m);
+    }
+    for (std::size_t i = 0; i < hierarchy.leaf_nodes.size(); i += 97) {
+        glm::mat4 m = hierarchy.leaf_nodes[i]->parent_from_node();
+        m[3][2] -= offset;
+        hierarchy.leaf_nodes[i]->set_parent_from_node(m);
+    }
+}
+
+constexpr std::size_t never = std::numeric_limits<std::size_t>::max();
+
+TEST(transform_table, matches_serial_propagation)
+{
+    Test_hierarchy serial{never};
+    Test_hierarchy table {0};
+    expect_same_world_transforms(serial, table);
+
+    move_nodes(serial, 1.5f);
+    move_nodes(table,  1.5f);
+    serial.host.scene.update_node_transforms();
+    table .host.scene.update_node_transforms();
+    expect_same_world_transforms(serial, table);
+
+    const erhe::scene::Scene::Transform_update_stats serial_stats = serial.host.scene.sample_transform_update_stats();
+    const erhe::scene::Scene::Transform_update_stats table_stats  = table .host.scene.sample_transform_update_stats();
+    EXPECT_EQ(serial_stats.table_pass_count, 0u);
+    EXPECT_GT(table_stats .table_pass_count, 0u);
+    EXPECT_EQ(serial_stats.visited_count, table_stats.visited_count);
+}
+
+TEST(transform_table, matches_serial_propagation_on_executor)
+{
+    tf::Executor executor{4};
+    erhe::scene::set_executor(&executor);
+    {
+        Test_hierarchy serial{never};
+        Test_hierarchy table {0};
+        for (int frame = 0; frame < 3; ++frame) {
+            move_nodes(serial, 0.5f * static_cast<float>(frame + 1));
+            move_nodes(table,  0.5f * static_cast<float>(frame + 1));
+            serial.host.scene.update_node_transforms();
+            table .host.scene.update_node_transforms();
+            expect_same_world_transforms(serial, table);
+        }
+    }
+    erhe::scene::set_executor(nullptr);
+}
+
+TEST(transform_table, owner_writes_do_not_carry_no_transform_update_nodes)
+{
+    Test_hierarchy serial{never};
+    Test_hierarchy table {0};
+    {
+        erhe::scene::Scene::Transform_owner_writes_scope serial_scope{serial.host.scene};
+        erhe::scene::Scene::Transform_owner_writes_scope table_scope {table .host.scene};
+        move_nodes(serial, 2.0f);
+        move_nodes(table,  2.0f);
+    }
+    serial.host.scene.update_node_transforms();
+    table .host.scene.update_node_transforms();
+    expect_same_world_transforms(serial, table);
+}
+
+// 4833 scene nodes: with the default minimum of 64, the table needs one
+// dirty node per 16 scene nodes (302), so a few moved leaves stay on the
+// serial walk while a large batch switches to the table.
+TEST(transform_table, threshold_scales_with_scene_size)
+{
+    Test_hierarchy serial{never};
+    Test_hierarchy scaled{64};
+    const std::size_t node_count = scaled.host.scene.get_node_count();
+    ASSERT_GT(node_count / erhe::scene::Scene::c_transform_table_nodes_per_dirty_node, 64u);
+    static_cast<void>(scaled.host.scene.sample_transform_update_stats());
+
+    const auto move_leaves = [](Test_hierarchy& hierarchy, const std::size_t count) {
+        for (std::size_t i = 0; i < count; ++i) {
+            glm::mat4 m = hierarchy.leaf_nodes[i]->parent_from_node();
+            m[3][1] += 0.25f;
+            hierarchy.leaf_nodes[i]->set_parent_from_node(m);
+        }
+    };
+
+    move_leaves(serial, 100);
+    move_leaves(scaled, 100);
+    serial.host.scene.update_node_transforms();
+    scaled.host.scene.update_node_transforms();
+    expect_same_world_transforms(serial, scaled);
+    EXPECT_EQ(scaled.host.scene.sample_transform_update_stats().table_pass_count, 0u);
+
+    const std::size_t large_batch = node_count / erhe::scene::Scene::c_transform_table_nodes_per_dirty_node + 1;
+    move_leaves(serial, large_batch);
+    move_leaves(scaled, large_batch);
+    serial.host.scene.update_node_transforms();
+    scaled.host.scene.update_node_transforms();
+    expect_same_world_transforms(serial, scaled);
+    EXPECT_EQ(scaled.host.scene.sample_transform_update_stats().table_pass_count, 1u);
+}
+
+TEST(transform_table, follows_reparenting)
+{
+    Test_hierarchy serial{never};
+    Test_hierarchy table {0};
+    // Move the last chain under the first chain's tip: the table must be
+    // rebuilt (Node::handle_parent_update), or the moved subtree would keep
+    // its old parent index.
+    serial.chain_nodes[28]->set_parent(serial.chain_nodes[3]);
+    table .chain_nodes[28]->set_parent(table .chain_nodes[3]);
+    serial.host.scene.update_node_transforms();
+    table .host.scene.update_node_transforms();
+    expect_same_world_transforms(serial, table);
+
+    move_nodes(serial, -1.0f);
+    move_nodes(table,  -1.0f);
+    serial.host.scene.update_node_transforms();
+    table .host.scene.update_node_transforms();
+    expect_same_world_transforms(serial, table);
+}
+
+} // anonymous namespace
@@ -2,7 +2,7 @@ from erhe_codegen import *
 
 struct("Mesh_memory_config",
     reflect=True,
-    version=1,
+    version=2,
     short_desc="Mesh Memory",
     long_desc="",
     developer=False,
@@ -51,5 +51,18 @@ struct("Mesh_memory_config",
             visible=True,
             developer=True
         ),
+        # Mesh builds and async loads write vertex and index data directly
+        # into a persistently mapped staging ring of this size (one per
+        # transfer queue); when it is full they fall back to heap vectors.
+        field(
+            "transfer_staging_size_mb",
+            Int,
+            added_in=2,
+            default="32",
+            short_desc="Transfer Staging Size (MB)",
+            long_desc="Size of the upload staging ring of each mesh transfer queue. 0 disables staging; mesh data is then built in heap memory and copied at flush time.",
+            visible=True,
+            developer=True
+        ),
     ],
 )
@@ -18,4 +18,6 @@ namespace erhe::scene_renderer {
 
 #define glyph_buffer_binding_point         8
 
+#define light_cluster_buffer_binding_point 9
+
 } // namespace erhe::scene_renderer
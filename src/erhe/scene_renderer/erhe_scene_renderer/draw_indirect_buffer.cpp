@@ -180,18 +180,88 @@ auto Draw_indirect_buffer::update(
     };
 }
 
+namespace {
+
+[[nodiscard]] auto get_lod_level(const Draw_list& draw_list, const uint32_t entry_index, const uint8_t lod_level) -> const Draw_list_entry_lod*
+{
+    if (lod_level == 0) {
+        return nullptr;
+    }
+    const Draw_list_entry_lods& lods = draw_list.entry_lods[entry_index];
+    ERHE_VERIFY(lod_level <= lods.level_count);
+    return &lods.levels[lod_level - 1];
+}
+
+} // anonymous namespace
+
+auto Draw_indirect_buffer::update(
+    const Draw_list&                draw_list,
+    const std::span<const uint32_t> entry_indices,
+    const std::span<const uint8_t>  lod_levels
+) -> Draw_indirect_buffer_range
+{
+    ERHE_PROFILE_FUNCTION();
+
+    const std::size_t                 max_draw_count = entry_indices.size();
+    const std::size_t                 entry_size     = sizeof(erhe::graphics::Draw_indexed_primitives_indirect_command);
+    const std::size_t                 max_byte_count = max_draw_count * entry_size;
+    erhe::graphics::Ring_buffer_range buffer_range   = acquire(erhe::graphics::Ring_buffer_usage::CPU_write, max_byte_count);
+    const std::span<std::byte>        gpu_data       = buffer_range.get_span();
+    std::size_t        write_offset       {0};
+    constexpr uint32_t instance_count     {1};
+    constexpr uint32_t base_instance      {0};
+    std::size_t        draw_indirect_count{0};
+
+    ERHE_VERIFY(lod_levels.empty() || (lod_levels.size() == entry_indices.size()));
+    for (std::size_t k = 0, end = entry_indices.size(); k < end; ++k) {
+        const uint32_t i = entry_indices[k];
+        ERHE_VERIFY(i < draw_list.entries.size());
+        const Draw_list_entry&     entry = draw_list.entries[i];
+        const Draw_list_entry_lod* lod   = lod_levels.empty() ? nullptr : get_lod_level(draw_list, i, lod_levels[k]);
+        uint32_t index_count = (lod != nullptr) ? lod->index_count : entry.index_count;
+        if (m_max_index_count_enable) {
+            index_count = std::min(index_count, static_cast<uint32_t>(m_max_index_count));
+        }
+        const erhe::graphics::Draw_indexed_primitives_indirect_command draw_command{
+            index_count,
+            instance_count,
+            (lod != nullptr) ? lod->first_index : entry.first_index,
+            entry.base_vertex,
+            base_instance
+        };
+        erhe::graphics::write(gpu_data, write_offset, erhe::graphics::as_span(draw_command));
+        write_offset += entry_size;
+        ++draw_indirect_count;
+    }
+
+    buffer_range.bytes_written(write_offset);
+    buffer_range.close();
+
+    return Draw_indirect_buffer_range{
+        std::move(buffer_range),
+        draw_indirect_count
+    };
+}
+
 auto Draw_indirect_buffer::update(
-    const Draw_list&         draw_list,
-    const std::size_t        begin,
-    const std::size_t        end,
-    const erhe::Item_filter& filter
+    const Draw_list&                draw_list,
+    const std::size_t               begin,
+    const std::size_t               end,
+    const std::span<const uint32_t> visible_entry_indices,
+    const std::span<const uint8_t>  lod_levels
 ) -> Draw_indirect_buffer_range
 {
     ERHE_PROFILE_FUNCTION();
 
     ERHE_VERIFY(begin <= end);
     ERHE_VERIFY(end <= draw_list.entries.size());
-    const std::size_t                 max_draw_count = end - begin;
+    ERHE_VERIFY(!visible_entry_indices.empty());
+    ERHE_VERIFY(visible_entry_indices.front() >= begin);
+    ERHE_VERIFY(visible_entry_indices.back() < end);
+    ERHE_VERIFY(lod_levels.empty() || (lod_levels.size() == visible_entry_indices.size()));
+
+    const std::size_t                 command_end    = static_cast<std::size_t>(visible_entry_indices.back()) + 1;
+    const std::size_t                 max_draw_count = command_end - begin;
     const std::size_t                 entry_size     = sizeof(erhe::graphics::Draw_indexed_primitives_indirect_command);
     const std::size_t                 max_byte_count = max_draw_count * entry_size;
     erhe::graphics::Ring_buffer_range buffer_range   = acquire(erhe::graphics::Ring_buffer_usage::CPU_write, max_byte_count);
@@ -200,20 +270,28 @@ auto Draw_indirect_buffer::update(
     constexpr uint32_t instance_count     {1};
     constexpr uint32_t base_instance      {0};
     std::size_t        draw_indirect_count{0};
+    std::size_t        visible_cursor     {0};
 
-    for (std::size_t i = begin; i < end; ++i) {
+    for (std::size_t i = begin; i < command_end; ++i) {
         const Draw_list_entry& entry = draw_list.entries[i];
-        if (!filter(entry.flag_bits)) {
-            continue;
-        }
-        uint32_t index_count = entry.index_count;
-        if (m_max_index_count_enable) {
-            index_count = std::min(index_count, static_cast<uint32_t>(m_max_index_count));
+        const bool visible = (visible_cursor < visible_entry_indices.size()) && (visible_entry_indices[visible_cursor] == i);
+        uint32_t index_count = 0;
+        uint32_t first_index = entry.first_index;
+        if (visible) {
+            const Draw_list_entry_lod* lod = lod_levels.empty() ? nullptr : get_lod_level(draw_list, static_cast<uint32_t>(i), lod_levels[visible_cursor]);
+            ++visible_cursor;
+            index_count = (lod != nullptr) ? lod->index_count : entry.index_count;
+            if (lod != nullptr) {
+                first_index = lod->first_index;
+            }
+            if (m_max_index_count_enable) {
+                index_count = std::min(index_count, static_cast<uint32_t>(m_max_index_count));
+            }
         }
         const erhe::graphics::Draw_indexed_primitives_indirect_command draw_command{
             index_count,
             instance_count,
-            entry.first_index,
+            first_index,
             entry.base_vertex,
             base_instance
         };
@@ -221,6 +299,7 @@ auto Draw_indirect_buffer::update(
         write_offset += entry_size;
         ++draw_indirect_count;
     }
+    ERHE_VERIFY(visible_cursor == visible_entry_indices.size());
 
     buffer_range.bytes_written(write_offset);
     buffer_range.close();
@@ -231,4 +310,33 @@ auto Draw_indirect_buffer::update(
     };
 }
 
+auto Draw_indirect_buffer::update(
+    const std::span<const erhe::graphics::Draw_indexed_primitives_indirect_command> commands
+) -> Draw_indirect_buffer_range
+{
+    ERHE_PROFILE_FUNCTION();
+
+    const std::size_t                 entry_size     = sizeof(erhe::graphics::Draw_indexed_primitives_indirect_command);
+    const std::size_t                 max_byte_count = commands.size() * entry_size;
+    erhe::graphics::Ring_buffer_range buffer_range   = acquire(erhe::graphics::Ring_buffer_usage::CPU_write, max_byte_count);
+    const std::span<std::byte>        gpu_data       = buffer_range.get_span();
+    std::size_t                       write_offset   {0};
+
+    for (erhe::graphics::Draw_indexed_primitives_indirect_command draw_command : commands) {
+        if (m_max_index_count_enable) {
+            draw_command.index_count = std::min(draw_command.index_count, static_cast<uint32_t>(m_max_index_count));
+        }
+        erhe::graphics::write(gpu_data, write_offset, erhe::graphics::as_span(draw_command));
+        write_offset += entry_size;
+    }
+
+    buffer_range.bytes_written(write_offset);
+    buffer_range.close();
+
+    return Draw_indirect_buffer_range{
+        std::move(buffer_range),
+        commands.size()
+    };
+}
+
 } // namespace erhe::renderer
@@ -9,6 +9,7 @@
 #include <span>
 
 namespace erhe { class Item_filter; }
+namespace erhe::graphics { class Draw_indexed_primitives_indirect_command; }
 namespace erhe::scene {
     class Mesh;
     class Mesh_primitive_ref;
@@ -46,16 +47,39 @@ public:
         erhe::primitive::Primitive_mode primitive_mode
     ) -> Draw_indirect_buffer_range;
 
-    // Draw-list overload: one draw command per entry in [begin, end) of
-    // draw_list that passes filter, in entry order - the exact counterpart of
+    // Draw-list overload: one draw command per entry of draw_list listed in
+    // entry_indices, in that order - the exact counterpart of
     // Primitive_buffer::update(Draw_list, ...) so ERHE_DRAW_ID indexes line
     // up. Uses the index_count / first_index / base_vertex baked into the
-    // entries at registration; touches no Mesh.
+    // entries at registration; touches no Mesh. lod_levels, when not empty,
+    // is parallel to entry_indices: 0 draws the entry, N > 0 its level
+    // Draw_list::entry_lods[i].levels[N - 1] (Draw_list_scene LOD selection).
     auto update(
-        const Draw_list&         draw_list,
-        std::size_t              begin,
-        std::size_t              end,
-        const erhe::Item_filter& filter
+        const Draw_list&          draw_list,
+        std::span<const uint32_t> entry_indices,
+        std::span<const uint8_t>  lod_levels = {}
+    ) -> Draw_indirect_buffer_range;
+
+    // Resident-record overload (static draw lists, Draw_list_scene): one
+    // draw command per entry in [begin, end) of draw_list, in entry order, so
+    // ERHE_DRAW_ID is the entry's position in the bound resident chunk.
+    // Entries not listed in visible_entry_indices (ascending, all inside
+    // [begin, end)) get an empty command (index_count 0); commands after the
+    // last visible entry are not emitted. lod_levels as above, parallel to
+    // visible_entry_indices.
+    auto update(
+        const Draw_list&          draw_list,
+        std::size_t               begin,
+        std::size_t               end,
+        std::span<const uint32_t> visible_entry_indices,
+        std::span<const uint8_t>  lod_levels = {}
+    ) -> Draw_indirect_buffer_range;
+
+    // Command overload: copies prebuilt commands as they are (cluster draws,
+    // Draw_list_scene; one command per meshlet, see
+    // append_cluster_draw_commands()).
+    auto update(
+        std::span<const erhe::graphics::Draw_indexed_primitives_indirect_command> commands
     ) -> Draw_indirect_buffer_range;
 
     //// void debug_properties_window();
@@ -1,5 +1,178 @@
 #include "erhe_scene_renderer/draw_list.hpp"
 
+#include <algorithm>
+#include <cmath>
+
 namespace erhe::scene_renderer {
 
+namespace {
+
+[[nodiscard]] auto get_clip_z_near(const erhe::math::Depth_range depth_range) -> float
+{
+    return (depth_range == erhe::math::Depth_range::negative_one_to_one) ? -1.0f : 0.0f;
+}
+
+} // anonymous namespace
+
+auto make_view_cull_volume(const glm::mat4& clip_from_world, const erhe::math::Depth_range depth_range) -> Draw_cull_volume
+{
+    const std::array<glm::vec4, 6> planes = erhe::math::extract_frustum_planes(clip_from_world, get_clip_z_near(depth_range), 1.0f);
+    Draw_cull_volume volume{};
+    volume.planes      = planes;
+    volume.plane_count = planes.size();
+    return volume;
+}
+
+auto make_shadow_cull_volume(const glm::mat4& clip_from_world, const erhe::math::Depth_range depth_range, const bool reverse_depth) -> Draw_cull_volume
+{
+    const std::array<glm::vec4, 6> planes = erhe::math::extract_frustum_planes(clip_from_world, get_clip_z_near(depth_range), 1.0f);
+    // plane_near is the clip_z_near side, which is the far plane when using
+    // reverse depth (see extract_frustum_planes()); plane_far is then the one
+    // closest to the light.
+    const std::size_t light_side_plane = reverse_depth ? erhe::math::plane_far : erhe::math::plane_near;
+    Draw_cull_volume volume{};
+    for (std::size_t i = 0; i < planes.size(); ++i) {
+        if (i == light_side_plane) {
+            continue;
+        }
+        volume.planes[volume.plane_count++] = planes[i];
+    }
+    return volume;
+}
+
+auto make_lod_selection(
+    const glm::mat4& clip_from_view,
+    const glm::vec3& view_position,
+    const int        viewport_height,
+    const float      max_pixel_error
+) -> Draw_lod_selection
+{
+    // clip_from_view[1][1] is 1 / tan(fov_y / 2) for perspective and
+    // 2 / view height for orthographic projections (sign depends on the y
+    // convention); either way half the viewport height times it is the
+    // pixel_scale. Perspective projections have w = -z: [3][3] == 0.
+    return Draw_lod_selection{
+        .view_position   = view_position,
+        .pixel_scale     = 0.5f * static_cast<float>(viewport_height) * std::abs(clip_from_view[1][1]),
+        .perspective     = (clip_from_view[3][3] == 0.0f),
+        .max_pixel_error = max_pixel_error
+    };
+}
+
+auto select_lod_level(
+    const Draw_lod_selection&   selection,
+    const Draw_list_entry_lods& lods,
+    const erhe::math::Aabb&     world_aabb,
+    const uint8_t               previous_level
+) -> uint8_t
+{
+    if (lods.level_count == 0) {
+        return 0;
+    }
+
+    // Distance to the nearest point of the bounds: conservative for every
+    // part of the primitive.
+    float distance = 1.0f;
+    if (selection.perspective) {
+        distance = world_aabb.is_valid()
+            ? glm::distance(selection.view_position, glm::clamp(selection.view_position, world_aabb.min, world_aabb.max))
+            : 0.0f;
+    }
+    if (distance <= 0.0f) {
+        return 0;
+    }
+
+    // Levels are ordered by increasing error: coarsest acceptable first.
+    const float coarsen_max_pixel_error = (1.0f - selection.hysteresis) * selection.max_pixel_error;
+    for (uint32_t level = lods.level_count; level > 0; --level) {
+        const float world_error     = lods.levels[level - 1].error * lods.world_scale;
+        const float max_pixel_error = (level > previous_level) ? coarsen_max_pixel_error : selection.max_pixel_error;
+        if (selection.get_pixel_error(world_error, distance) <= max_pixel_error) {
+            return static_cast<uint8_t>(level);
+        }
+    }
+    return 0;
+}
+
+auto get_max_axis_scale(const glm::mat4& world_from_node) -> float
+{
+    return std::sqrt(
+        std::max(
+            glm::dot(glm::vec3{world_from_node[0]}, glm::vec3{world_from_node[0]}),
+            std::max(
+                glm::dot(glm::vec3{world_from_node[1]}, glm::vec3{world_from_node[1]}),
+                glm::dot(glm::vec3{world_from_node[2]}, glm::vec3{world_from_node[2]})
+            )
+        )
+    );
+}
+
+auto append_cluster_draw_commands(
+    const std::span<const erhe::primitive::Buffer_meshlet>                  meshlets,
+    const uint32_t                                                          base_index,
+    const uint32_t                                                          base_vertex,
+    const glm::mat4&                                                        world_from_node,
+    const std::span<const Draw_cull_volume>                                 cull_volumes,
+    const std::span<const glm::vec3>                                        view_positions_in_node,
+    std::vector<erhe::graphics::Draw_indexed_primitives_indirect_command>& commands
+) -> std::size_t
+{
+    const float       world_scale = get_max_axis_scale(world_from_node);
+    const std::size_t start_count = commands.size();
+    for (const erhe::primitive::Buffer_meshlet& meshlet : meshlets) {
+        // Frustum: bounding sphere in world space, inside (or touching) every
+        // plane of at least one volume.
+        bool inside = cull_volumes.empty();
+        if (!inside) {
+            const glm::vec4 center{glm::vec3{world_from_node * glm::vec4{meshlet.center, 1.0f}}, 1.0f};
+            const float     radius = meshlet.radius * world_scale;
+            for (const Draw_cull_volume& volume : cull_volumes) {
+                bool inside_volume = true;
+                for (const glm::vec4& plane : volume.get_planes()) {
+                    if (glm::dot(plane, center) < -radius) {
+                        inside_volume = false;
+                        break;
+                    }
+                }
+                if (inside_volume) {
+                    inside = true;
+                    break;
+                }
+            }
+        }
+        if (!inside) {
+            continue;
+        }
+
+        // Back face: every triangle faces away from every view position.
+        // dot(normalize(d), axis) >= cutoff + radius / length(d), multiplied
+        // by length(d).
+        if ((meshlet.cone_cutoff < 1.0f) && !view_positions_in_node.empty()) {
+            bool back_facing = true;
+            for (const glm::vec3& view_position : view_positions_in_node) {
+                const glm::vec3 d        = meshlet.center - view_position;
+                const float     distance = glm::length(d);
+                if (glm::dot(d, meshlet.cone_axis) < meshlet.cone_cutoff * distance + meshlet.radius) {
+                    back_facing = false;
+                    break;
+                }
+            }
+            if (back_facing) {
+                continue;
+            }
+        }
+
+        commands.push_back(
+            erhe::graphics::Draw_indexed_primitives_indirect_command{
+                meshlet.index_count,
+                1,
+                base_index + meshlet.first_index,
+                base_vertex,
+                0
+            }
+        );
+    }
+    return commands.size() - start_count;
+}
+
 } // namespace erhe::scene_renderer
@@ -3,9 +3,16 @@
 #include "erhe_scene_renderer/draw_list_entry.hpp"
 #include "erhe_scene_renderer/draw_list_key.hpp"
 
+#include "erhe_graphics/draw_indirect.hpp"
+#include "erhe_math/aabb_soa.hpp"
+#include "erhe_math/math_util.hpp"
+
+#include <glm/glm.hpp>
+
 #include <array>
 #include <cstddef>
 #include <cstdint>
+#include <span>
 #include <vector>
 
 namespace erhe::graphics {
@@ -37,11 +44,114 @@ enum class Draw_blending_selection : uint8_t
 class Draw_statistics
 {
 public:
-    std::size_t draw_list_count{0}; // lists that produced at least one draw
-    std::size_t entry_count    {0}; // entries drawn (after flag filtering)
-    std::size_t draw_call_count{0}; // multi-draw submissions (chunks)
+    std::size_t draw_list_count     {0}; // lists that produced at least one draw
+    std::size_t entry_count         {0}; // entries drawn (after flag filtering and culling)
+    std::size_t draw_call_count     {0}; // multi-draw submissions (chunks)
+    std::size_t culled_entry_count  {0}; // entries that passed the flag filter but were outside every cull volume
+    std::size_t lod_entry_count     {0}; // entries drawn with a coarser level of detail (Draw_lod_selection)
+    std::size_t cluster_draw_count  {0}; // meshlet draw commands of cluster culled entries (Draw_cluster_culling)
+    std::size_t culled_cluster_count{0}; // meshlets of those entries outside every cull volume or back facing
+};
+
+// Convex culling volume of one view or one shadow pass: inward-facing planes
+// in erhe::math::extract_frustum_planes() convention. Entries whose world
+// bounds are entirely outside one plane are not drawn.
+class Draw_cull_volume
+{
+public:
+    std::array<glm::vec4, 6> planes     {};
+    std::size_t              plane_count{0};
+
+    [[nodiscard]] auto get_planes() const -> std::span<const glm::vec4> { return std::span<const glm::vec4>{planes.data(), plane_count}; }
+};
+
+// All six planes of a camera frustum. A degenerate far plane (infinite far
+// projection) is kept as an all-zero plane, which rejects nothing.
+[[nodiscard]] auto make_view_cull_volume(const glm::mat4& clip_from_world, erhe::math::Depth_range depth_range) -> Draw_cull_volume;
+// Shadow caster volume of one light pass: the light frustum without its near
+// plane. Casters between the light and the frustum still throw shadows into
+// it (and are drawn clamped when the pass uses depth clamp).
+[[nodiscard]] auto make_shadow_cull_volume(const glm::mat4& clip_from_world, erhe::math::Depth_range depth_range, bool reverse_depth) -> Draw_cull_volume;
+
+// Screen-space error level of detail selection of one color pass. An entry
+// with levels (Draw_list::entry_lods) draws the coarsest level whose world
+// space error, projected at the entry's distance from view_position, is at
+// most max_pixel_error pixels. Entries whose bounds contain view_position
+// draw full detail.
+//
+// Going coarser than the level an entry drew last needs the projected error
+// to be at most (1 - hysteresis) * max_pixel_error, so an entry that sits at
+// a threshold does not alternate between two levels from frame to frame.
+// Going finer is never delayed.
+class Draw_lod_selection
+{
+public:
+    glm::vec3 view_position  {0.0f};
+    // Perspective: pixels per world unit at distance 1 (viewport height /
+    // (2 tan(fov_y / 2))). Orthographic: pixels per world unit.
+    float     pixel_scale    {0.0f};
+    bool      perspective    {true};
+    float     max_pixel_error{1.0f};
+    float     hysteresis     {0.2f};
+
+    // Projected error of a world space error at distance (perspective) from
+    // the view.
+    [[nodiscard]] auto get_pixel_error(const float world_error, const float distance) const -> float
+    {
+        return perspective ? (world_error * pixel_scale / distance) : (world_error * pixel_scale);
+    }
 };
 
+// Selection from the projection of the view (clip_from_view, as built for
+// the view's viewport) and the viewport height in pixels.
+[[nodiscard]] auto make_lod_selection(
+    const glm::mat4& clip_from_view,
+    const glm::vec3& view_position,
+    int              viewport_height,
+    float            max_pixel_error
+) -> Draw_lod_selection;
+
+// Level (0 full detail, N lods.levels[N - 1]) to draw for an entry with
+// world bounds world_aabb, given the level it drew last (previous_level).
+[[nodiscard]] auto select_lod_level(
+    const Draw_lod_selection&   selection,
+    const Draw_list_entry_lods& lods,
+    const erhe::math::Aabb&     world_aabb,
+    uint8_t                     previous_level
+) -> uint8_t;
+
+// CPU cluster culling of one color pass. Visible entries with meshlets
+// (Draw_list::entry_clusters) that draw full detail are replaced by one draw
+// command per meshlet that is inside at least one of the pass cull volumes
+// and, for lists that are not double sided, not back facing from every one
+// of view_positions (world space; empty: no back face test).
+class Draw_cluster_culling
+{
+public:
+    std::span<const glm::vec3> view_positions{};
+};
+
+// Largest axis scale of a world transform: bounds object space lengths in
+// world space.
+[[nodiscard]] auto get_max_axis_scale(const glm::mat4& world_from_node) -> float;
+
+// Appends one indexed draw command per visible meshlet of one primitive
+// instance to commands and returns the number appended. Meshlet bounds are
+// tested against cull_volumes in world space (empty: no frustum test); the
+// normal cone against view_positions_in_node, the view positions in the
+// primitive's object space, where the test stays exact under non-uniform
+// scale (empty: no back face test). base_index is added to the meshlet
+// first_index, base_vertex is used as is.
+[[nodiscard]] auto append_cluster_draw_commands(
+    std::span<const erhe::primitive::Buffer_meshlet>                        meshlets,
+    uint32_t                                                                base_index,
+    uint32_t                                                                base_vertex,
+    const glm::mat4&                                                        world_from_node,
+    std::span<const Draw_cull_volume>                                       cull_volumes,
+    std::span<const glm::vec3>                                              view_positions_in_node,
+    std::vector<erhe::graphics::Draw_indexed_primitives_indirect_command>& commands
+) -> std::size_t;
+
 // Resolved shader stages for one color view configuration (R19).
 class Draw_list_color_resolution
 {
@@ -73,8 +183,29 @@ public:
     // (swap-removed together). Written at registration and kept current by
     // the transform / refresh hooks and the draw-time GPU-slot sync;
     // Primitive_buffer::update(Draw_list, ...) memcpys them per pass and only
-    // patches the pass-dependent color / size fields.
+    // patches the pass-dependent color / size fields. Static lists also keep
+    // patched copies resident on the GPU (Draw_list_scene resident records).
     std::vector<std::byte>                            primitive_records;
+    // World bounds of every entry (Draw_list_entry::world_aabb) in SIMD
+    // friendly SoA form for the culling stage of draw_color() / draw_shadow().
+    // Parallel to entries and primitive_records (swap-removed together),
+    // rewritten with the records by the transform hook.
+    erhe::math::Aabb_soa                              culling_bounds;
+    // Level of detail chain of every entry, parallel to entries (swap-removed
+    // together); level_count 0 for entries without levels. lod_entry_count
+    // counts the entries with levels so lists without any skip the selection.
+    std::vector<Draw_list_entry_lods>                 entry_lods;
+    std::size_t                                       lod_entry_count{0};
+    // Meshlets of every entry, parallel to entries (swap-removed together);
+    // empty spans for entries without. cluster_entry_count as above.
+    std::vector<Draw_list_entry_clusters>             entry_clusters;
+    std::size_t                                       cluster_entry_count{0};
+    // Static lists only: entries [dirty_record_begin, dirty_record_end)
+    // whose record or flag bits changed since Draw_list_scene last patched
+    // the list's resident record copies (empty when begin == end). Entries
+    // appended or removed since then are covered through the entry count.
+    uint32_t                                          dirty_record_begin{0};
+    uint32_t                                          dirty_record_end  {0};
 
     std::vector<Draw_list_color_resolution>           color_resolutions;
     std::array<
@@ -1,8 +1,14 @@
 #pragma once
 
 #include "erhe_math/aabb.hpp"
+#include "erhe_primitive/meshlet.hpp"
 
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstddef>
 #include <cstdint>
+#include <span>
 
 namespace erhe::scene_renderer {
 
@@ -30,9 +36,54 @@ public:
     uint32_t         index_count         {0};
     uint32_t         first_index         {0};
     uint32_t         base_vertex         {0};
-    // World-space bounds at registration (Q6: culling is future work; stale
-    // for dynamic objects, unused by the initial draw path).
+    // World-space bounds of the primitive: local bounding box under the node
+    // world transform, written at registration and by the transform hook.
+    // Mirrored into Draw_list::culling_bounds for the culling stage. Not kept
+    // current for skinned entries (joints move without a hook); skinned lists
+    // are never culled.
     erhe::math::Aabb world_aabb          {};
 };
 
+// One coarser level of detail of an entry (Buffer_mesh::triangle_fill_lods):
+// indexed draw parameters over the same vertices (same base_vertex), baked at
+// registration like Draw_list_entry::index_count / first_index.
+class Draw_list_entry_lod
+{
+public:
+    uint32_t index_count{0};
+    uint32_t first_index{0};
+    float    error      {0.0f}; // object space geometric error
+};
+
+// Level of detail chain of one entry, in Draw_list::entry_lods (parallel to
+// the entries). Kept out of Draw_list_entry: only the LOD selection of
+// draw_color() reads it, and most entries have no levels.
+class Draw_list_entry_lods
+{
+public:
+    static constexpr std::size_t max_level_count = 4;
+
+    std::array<Draw_list_entry_lod, max_level_count> levels     {};
+    uint32_t                                         level_count{0};
+    // Largest axis scale of the node world transform: object space errors
+    // times this are world space errors. Written with world_aabb.
+    float                                            world_scale{1.0f};
+    // Level drawn by the last color pass that drew the entry (0 full
+    // detail), for the hysteresis of select_lod_level().
+    uint8_t                                          last_level {0};
+};
+
+// Meshlets of an entry (Buffer_mesh::triangle_fill_meshlets), in
+// Draw_list::entry_clusters (parallel to the entries), for the cluster
+// culling of draw_color(). The span points into the Buffer_mesh, valid as
+// long as the index ranges baked into the entry are.
+class Draw_list_entry_clusters
+{
+public:
+    std::span<const erhe::primitive::Buffer_meshlet> meshlets       {};
+    uint32_t                                         base_index     {0}; // Buffer_mesh::base_index(), meshlet first_index is relative to it
+    // Node world transform, written with world_aabb.
+    glm::mat4                                        world_from_node{1.0f};
+};
+
 } // namespace erhe::scene_renderer
@@ -4,6 +4,9 @@
 #include "erhe_scene_renderer/scene_renderer_log.hpp"
 #include "erhe_scene_renderer/shader_variant_cache.hpp"
 
+#include "erhe_graphics/buffer.hpp"
+#include "erhe_graphics/command_buffer.hpp"
+#include "erhe_graphics/device.hpp"
 #include "erhe_graphics/draw_indirect.hpp"
 #include "erhe_graphics/render_command_encoder.hpp"
 #include "erhe_graphics/render_pass.hpp"
@@ -21,6 +24,7 @@
 #include "erhe_scene/mesh.hpp"
 #include "erhe_scene/node.hpp"
 #include "erhe_scene/skin.hpp"
+#include "erhe_utility/align.hpp"
 #include "erhe_verify/verify.hpp"
 
 #include <fmt/format.h>
@@ -196,21 +200,20 @@ auto Color_environment::operator==(const Color_environment& other) const -> bool
         (shadow_bias       == other.shadow_bias      ) &&
         (shadow_technique  == other.shadow_technique ) &&
         (shadow_depth_bits == other.shadow_depth_bits) &&
-        (ddgi_enabled      == other.ddgi_enabled     );
+        (ddgi_enabled      == other.ddgi_enabled     ) &&
+        (clustered_lights  == other.clustered_lights );
 }
 
-auto Color_environment::make_environment_key() const -> Shader_key
+auto Color_environment::make_environment_key(const uint16_t multiview_count) const -> Shader_key
 {
     // Mirrors the environment key built in Forward_renderer::render():
     // light counts per type, shadow axes, SHADER_DEBUG = 0 (draw lists never
     // carry the debug axis; those passes use the fallback).
     Shader_key key{};
-    key.set(Shader_int::LIGHT_COUNT_DIRECTIONAL_NOT_SHADOWMAPPED, static_cast<uint32_t>(light_partition.per_type_nonshadow[0]));
-    key.set(Shader_int::LIGHT_COUNT_DIRECTIONAL_SHADOWMAPPED,     static_cast<uint32_t>(light_partition.per_type_shadow   [0]));
-    key.set(Shader_int::LIGHT_COUNT_SPOT_NOT_SHADOWMAPPED,        static_cast<uint32_t>(light_partition.per_type_nonshadow[1]));
-    key.set(Shader_int::LIGHT_COUNT_SPOT_SHADOWMAPPED,            static_cast<uint32_t>(light_partition.per_type_shadow   [1]));
-    key.set(Shader_int::LIGHT_COUNT_POINT_NOT_SHADOWMAPPED,       static_cast<uint32_t>(light_partition.per_type_nonshadow[2]));
-    key.set(Shader_int::LIGHT_COUNT_POINT_SHADOWMAPPED,           static_cast<uint32_t>(light_partition.per_type_shadow   [2]));
+    // Same gate as Forward_renderer::begin_pass(): clusters are built for
+    // single view passes only, and those always bind a grid (one cluster
+    // with all lights when the camera has no usable cluster view).
+    set_light_count_axes(key, light_partition, clustered_lights && (multiview_count < 2));
     key.set(Shader_int::SHADER_DEBUG,                             0u);
     key.set(Shader_int::SHADOW_FILTER,                            shadow_filter);
     key.set(Shader_int::SHADOW_BIAS,                              shadow_bias);
@@ -232,8 +235,18 @@ Draw_list_scene::Draw_list_scene(
     , m_primitive_record_stride{primitive_interface.primitive_struct.get_size_bytes()}
     , m_multiview_view_counts  {multiview_view_counts.begin(), multiview_view_counts.end()}
     , m_owner_thread_id        {std::this_thread::get_id()}
+    , m_alive_token            {std::make_shared<int>(0)}
 {
     ERHE_VERIFY(m_primitive_record_stride > 0);
+    // Resident copies are bound one chunk (<= max_primitive_count records,
+    // the P3a multi-draw bound) at a time; every chunk starts at an offset
+    // the primitive block binding accepts.
+    erhe::graphics::Device& graphics_device = m_mesh_memory.get_graphics_device();
+    const std::size_t alignment = graphics_device.get_buffer_alignment(m_primitive_interface.primitive_block.get_binding_target());
+    m_resident_chunk_byte_stride = erhe::utility::align_offset_non_power_of_two(
+        std::max<std::size_t>(std::size_t{1}, m_primitive_interface.max_primitive_count) * m_primitive_record_stride,
+        alignment
+    );
 }
 
 Draw_list_scene::~Draw_list_scene() noexcept = default;
@@ -300,7 +313,6 @@ void Draw_list_scene::add_entries(const uint32_t object_index)
     constexpr erhe::primitive::Primitive_mode primitive_mode = erhe::primitive::Primitive_mode::polygon_fill;
     constexpr Draw_purpose purposes[] = { Draw_purpose::color, Draw_purpose::shadow };
 
-    const erhe::math::Aabb                          world_aabb = mesh->get_aabb_world();
     const std::vector<erhe::scene::Mesh_primitive>& primitives = mesh->get_primitives();
     if (primitives.size() > 0xffffu) {
         log_draw_list->error("Mesh '{}' has {} primitives, exceeds Draw_list_entry limit of 65535; not registered", mesh->get_name(), primitives.size());
@@ -339,7 +351,31 @@ void Draw_list_scene::add_entries(const uint32_t object_index)
             entry.base_vertex          = (primitive_mode == erhe::primitive::Primitive_mode::solid_wireframe)
                 ? buffer_mesh.expanded_base_vertex()
                 : buffer_mesh.base_vertex();
-            entry.world_aabb           = world_aabb;
+            entry.world_aabb           = get_entry_world_aabb(object, static_cast<uint16_t>(i));
+
+            // Levels of detail: color lists only (a coarser shadow caster
+            // than the receiver it shades would self-shadow).
+            Draw_list_entry_lods entry_lods{};
+            if (purpose == Draw_purpose::color) {
+                const std::size_t level_count = std::min(buffer_mesh.triangle_fill_lods.size(), Draw_list_entry_lods::max_level_count);
+                for (std::size_t level = 0; level < level_count; ++level) {
+                    const erhe::primitive::Buffer_mesh_lod& lod = buffer_mesh.triangle_fill_lods[level];
+                    entry_lods.levels[level] = Draw_list_entry_lod{
+                        .index_count = static_cast<uint32_t>(lod.triangle_fill_indices.index_count),
+                        .first_index = static_cast<uint32_t>(lod.triangle_fill_indices.first_index) + buffer_mesh.base_index(),
+                        .error       = lod.error
+                    };
+                }
+                entry_lods.level_count = static_cast<uint32_t>(level_count);
+                entry_lods.world_scale = get_max_axis_scale(mesh->get_node()->world_from_node());
+            }
+            // Meshlets: color lists only, like the levels of detail.
+            Draw_list_entry_clusters entry_clusters{};
+            if ((purpose == Draw_purpose::color) && !buffer_mesh.triangle_fill_meshlets.empty()) {
+                entry_clusters.meshlets        = buffer_mesh.triangle_fill_meshlets;
+                entry_clusters.base_index      = buffer_mesh.base_index();
+                entry_clusters.world_from_node = mesh->get_node()->world_from_node();
+            }
 
             object.locations.push_back(
                 Draw_list_entry_location{
@@ -352,6 +388,16 @@ void Draw_list_scene::add_entries(const uint32_t object_index)
             ERHE_VERIFY(draw_list.primitive_records.size() == (draw_list.entries.size() - 1) * m_primitive_record_stride);
             draw_list.primitive_records.resize(draw_list.entries.size() * m_primitive_record_stride);
             write_entry_record(object, entry, get_record(object.locations.back()));
+            draw_list.culling_bounds.push_back(entry.world_aabb);
+            ERHE_VERIFY(draw_list.culling_bounds.size() == draw_list.entries.size());
+            draw_list.entry_lods.push_back(entry_lods);
+            if (entry_lods.level_count > 0) {
+                ++draw_list.lod_entry_count;
+            }
+            draw_list.entry_clusters.push_back(entry_clusters);
+            if (!entry_clusters.meshlets.empty()) {
+                ++draw_list.cluster_entry_count;
+            }
 
             // R17: resolve at registration (color: every enumerated view
             // config, once the environment is known; shadow sub-variants
@@ -370,6 +416,12 @@ void Draw_list_scene::remove_entry(const Draw_list_entry_location& location)
     Draw_list& draw_list = m_draw_lists[location.draw_list_index];
     ERHE_VERIFY(location.entry_index < draw_list.entries.size());
     const uint32_t last_index = static_cast<uint32_t>(draw_list.entries.size() - 1);
+    if (draw_list.entry_lods[location.entry_index].level_count > 0) {
+        --draw_list.lod_entry_count;
+    }
+    if (!draw_list.entry_clusters[location.entry_index].meshlets.empty()) {
+        --draw_list.cluster_entry_count;
+    }
     if (location.entry_index != last_index) {
         // Swap-remove: the moved entry's owner must be told its new index.
         const Draw_list_entry& moved = draw_list.entries[last_index];
@@ -384,12 +436,18 @@ void Draw_list_scene::remove_entry(const Draw_list_entry_location& location)
         }
         ERHE_VERIFY(patched);
         draw_list.entries[location.entry_index] = moved;
+        draw_list.entry_lods[location.entry_index] = draw_list.entry_lods[last_index];
+        draw_list.entry_clusters[location.entry_index] = draw_list.entry_clusters[last_index];
         std::memcpy(
             draw_list.primitive_records.data() + static_cast<std::size_t>(location.entry_index) * m_primitive_record_stride,
             draw_list.primitive_records.data() + static_cast<std::size_t>(last_index)           * m_primitive_record_stride,
             m_primitive_record_stride
         );
+        mark_record_dirty(draw_list, location.entry_index);
     }
+    draw_list.culling_bounds.swap_remove(location.entry_index);
+    draw_list.entry_lods.pop_back();
+    draw_list.entry_clusters.pop_back();
     draw_list.entries.pop_back();
     draw_list.primitive_records.resize(draw_list.entries.size() * m_primitive_record_stride);
 }
@@ -401,9 +459,25 @@ auto Draw_list_scene::get_record(const Draw_list_entry_location& location) -> st
     Draw_list& draw_list = m_draw_lists[location.draw_list_index];
     ERHE_VERIFY(location.entry_index < draw_list.entries.size());
     ERHE_VERIFY(draw_list.primitive_records.size() == draw_list.entries.size() * m_primitive_record_stride);
+    // Every record write goes through here.
+    mark_record_dirty(draw_list, location.entry_index);
     return draw_list.primitive_records.data() + static_cast<std::size_t>(location.entry_index) * m_primitive_record_stride;
 }
 
+void Draw_list_scene::mark_record_dirty(Draw_list& draw_list, const uint32_t entry_index)
+{
+    if (draw_list.key.mobility != Draw_mobility::static_) {
+        return;
+    }
+    if (draw_list.dirty_record_begin == draw_list.dirty_record_end) {
+        draw_list.dirty_record_begin = entry_index;
+        draw_list.dirty_record_end   = entry_index + 1;
+    } else {
+        draw_list.dirty_record_begin = std::min(draw_list.dirty_record_begin, entry_index);
+        draw_list.dirty_record_end   = std::max(draw_list.dirty_record_end,   entry_index + 1);
+    }
+}
+
 namespace {
 
 // Same math as Primitive_buffer::write_primitive(): the normal matrix is the
@@ -441,6 +515,25 @@ void write_slot_fields(std::byte* record, const Primitive_struct& offsets, const
 
 } // anonymous namespace
 
+auto Draw_list_scene::get_entry_world_aabb(const Draw_list_object& object, const uint16_t mesh_primitive_index) const -> erhe::math::Aabb
+{
+    const erhe::scene::Mesh* mesh = object.info.mesh.get();
+    ERHE_VERIFY(mesh != nullptr);
+    const erhe::scene::Node* node = mesh->get_node();
+    ERHE_VERIFY(node != nullptr);
+    const std::vector<erhe::scene::Mesh_primitive>& mesh_primitives = mesh->get_primitives();
+    ERHE_VERIFY(mesh_primitive_index < mesh_primitives.size());
+    const erhe::scene::Mesh_primitive& mesh_primitive = mesh_primitives[mesh_primitive_index];
+    if (!mesh_primitive.primitive) {
+        return erhe::math::Aabb{}; // invalid: never culled
+    }
+    const erhe::math::Aabb local_aabb = mesh_primitive.primitive->get_bounding_box();
+    if (!local_aabb.is_valid()) {
+        return erhe::math::Aabb{};
+    }
+    return local_aabb.transformed_by(node->world_from_node());
+}
+
 void Draw_list_scene::write_entry_record(const Draw_list_object& object, const Draw_list_entry& entry, std::byte* record) const
 {
     const Primitive_struct&  offsets = m_primitive_interface.offsets;
@@ -468,9 +561,16 @@ void Draw_list_scene::write_object_transform(const uint32_t object_index)
     ERHE_VERIFY(mesh != nullptr);
     const erhe::scene::Node* node = mesh->get_node();
     ERHE_VERIFY(node != nullptr);
-    const Primitive_struct& offsets = m_primitive_interface.offsets;
+    const Primitive_struct& offsets     = m_primitive_interface.offsets;
+    const float             world_scale = get_max_axis_scale(node->world_from_node());
     for (const Draw_list_entry_location& location : object.locations) {
         write_transform_fields(get_record(location), offsets, *node);
+        Draw_list&       draw_list = m_draw_lists[location.draw_list_index];
+        Draw_list_entry& entry     = draw_list.entries[location.entry_index];
+        entry.world_aabb = get_entry_world_aabb(object, entry.mesh_primitive_index);
+        draw_list.culling_bounds.set(location.entry_index, entry.world_aabb);
+        draw_list.entry_lods[location.entry_index].world_scale = world_scale;
+        draw_list.entry_clusters[location.entry_index].world_from_node = node->world_from_node();
     }
     object.transform_serial = node->node_data.transforms.world_from_node_serial;
 }
@@ -809,7 +909,10 @@ void Draw_list_scene::set_object_flags(const Draw_list_object_id id, const uint6
     }
     object.flag_bits = item_flag_bits;
     for (const Draw_list_entry_location& location : object.locations) {
-        m_draw_lists[location.draw_list_index].entries[location.entry_index].flag_bits = item_flag_bits;
+        Draw_list& draw_list = m_draw_lists[location.draw_list_index];
+        draw_list.entries[location.entry_index].flag_bits = item_flag_bits;
+        // Selected / hovered pick the patched color of resident copies.
+        mark_record_dirty(draw_list, location.entry_index);
     }
 }
 
@@ -845,6 +948,10 @@ void Draw_list_scene::rebuild_all()
     m_draw_lists.clear();
     m_draw_list_index_by_key.clear();
     m_skinned_object_indices.clear();
+    // The side table is parallel to m_draw_lists. Buffer destruction is
+    // deferred by the device until frames in flight have completed.
+    m_resident_records.clear();
+    m_resident_requests.clear();
     for (std::size_t i = 0, end = m_objects.size(); i < end; ++i) {
         Draw_list_object& object = m_objects[i];
         if (!object.alive) {
@@ -1056,6 +1163,273 @@ void Draw_list_scene::flush_pending()
     check_material_changes();
 }
 
+// --- Resident records of static lists ------------------------------------------
+
+namespace {
+
+// A resident copy not requested by any draw for this many frames (a pass
+// that stopped running, a changed pass setting) is released.
+constexpr uint64_t    c_resident_idle_frame_count    = 120;
+// Patches (pass configurations) kept resident per list, and copies per
+// patch (a copy drawn by a frame in flight is never patched).
+constexpr std::size_t c_max_resident_sets_per_list   = 4;
+constexpr std::size_t c_max_resident_buffers_per_set = 4;
+
+} // anonymous namespace
+
+void Draw_list_scene::set_resident_records_enabled(const bool value)
+{
+    assert_main_thread();
+    m_resident_records_enabled = value;
+    if (!value) {
+        m_resident_records.clear();
+        m_resident_requests.clear();
+    }
+}
+
+auto Draw_list_scene::get_resident_byte_count() const -> std::size_t
+{
+    std::size_t byte_count = 0;
+    for (const Resident_record_list& list : m_resident_records) {
+        for (const Resident_record_set& set : list.sets) {
+            for (const Resident_record_buffer& resident : set.buffers) {
+                if (resident.buffer) {
+                    byte_count += resident.buffer->get_capacity_byte_count();
+                }
+            }
+        }
+    }
+    return byte_count;
+}
+
+auto Draw_list_scene::get_resident_record_offset(const std::size_t entry_index) const -> std::size_t
+{
+    const std::size_t max_per_chunk = std::max<std::size_t>(std::size_t{1}, m_primitive_interface.max_primitive_count);
+    return (entry_index / max_per_chunk) * m_resident_chunk_byte_stride + (entry_index % max_per_chunk) * m_primitive_record_stride;
+}
+
+auto Draw_list_scene::get_resident_byte_size(const std::size_t entry_count) const -> std::size_t
+{
+    return (entry_count == 0) ? 0 : get_resident_record_offset(entry_count - 1) + m_primitive_record_stride;
+}
+
+auto Draw_list_scene::find_resident_set(const uint32_t draw_list_index, const Primitive_record_patch& patch) -> Resident_record_set*
+{
+    if (draw_list_index >= m_resident_records.size()) {
+        return nullptr;
+    }
+    for (Resident_record_set& set : m_resident_records[draw_list_index].sets) {
+        if (set.patch == patch) {
+            return &set;
+        }
+    }
+    return nullptr;
+}
+
+void Draw_list_scene::upload_resident_buffer(
+    const Draw_list&                draw_list,
+    const Primitive_record_patch&   patch,
+    Resident_record_buffer&         resident,
+    erhe::graphics::Command_buffer& command_buffer
+)
+{
+    const std::size_t entry_count = draw_list.entries.size();
+    ERHE_VERIFY(entry_count > 0);
+
+    std::size_t begin = resident.dirty_begin;
+    std::size_t end   = resident.dirty_end;
+    if (resident.entry_count < entry_count) { // appended since the last upload
+        begin = (begin == end) ? resident.entry_count : std::min(begin, resident.entry_count);
+        end   = entry_count;
+    }
+
+    if (resident.capacity_entry_count < entry_count) {
+        // Grow geometrically; a new buffer holds nothing yet. The replaced
+        // buffer's destruction is deferred by the device past frames in
+        // flight.
+        const std::size_t capacity_entry_count = std::max(entry_count, 2 * resident.capacity_entry_count);
+        resident.buffer = std::make_unique<erhe::graphics::Buffer>(
+            m_mesh_memory.get_graphics_device(),
+            erhe::graphics::Buffer_create_info{
+                .capacity_byte_count                    = get_resident_byte_size(capacity_entry_count),
+                .memory_allocation_create_flag_bit_mask = erhe::graphics::Memory_allocation_create_flag_bit_mask::none,
+                .usage                                  =
+                    erhe::graphics::get_buffer_usage(m_primitive_interface.primitive_block.get_binding_target()) |
+                    erhe::graphics::Buffer_usage::transfer_dst,
+                .required_memory_property_bit_mask      = erhe::graphics::Memory_property_flag_bit_mask::device_local,
+                .preferred_memory_property_bit_mask     = erhe::graphics::Memory_property_flag_bit_mask::none,
+                .debug_label                            = "Draw_list_scene resident records"
+            }
+        );
+        resident.capacity_entry_count = capacity_entry_count;
+        begin = 0;
+        end   = entry_count;
+    }
+    end = std::min(end, entry_count);
+
+    // One upload per chunk touched; records are patched in the scratch copy.
+    const std::size_t max_per_chunk = std::max<std::size_t>(std::size_t{1}, m_primitive_interface.max_primitive_count);
+    std::size_t i = begin;
+    while (i < end) {
+        const std::size_t chunk_end  = std::min(end, ((i / max_per_chunk) + 1) * max_per_chunk);
+        const std::size_t byte_count = (chunk_end - i) * m_primitive_record_stride;
+        m_resident_scratch.resize(byte_count);
+        std::memcpy(m_resident_scratch.data(), draw_list.primitive_records.data() + i * m_primitive_record_stride, byte_count);
+        for (std::size_t j = i; j < chunk_end; ++j) {
+            patch.apply(m_resident_scratch.data() + (j - i) * m_primitive_record_stride, m_primitive_interface.offsets, draw_list.entries[j].flag_bits);
+        }
+        command_buffer.upload_to_buffer(*resident.buffer.get(), get_resident_record_offset(i), m_resident_scratch.data(), byte_count);
+        m_resident_upload_byte_count += byte_count;
+        i = chunk_end;
+    }
+
+    resident.entry_count = entry_count;
+    resident.dirty_begin = 0;
+    resident.dirty_end   = 0;
+}
+
+void Draw_list_scene::update_resident_records(erhe::graphics::Command_buffer& command_buffer)
+{
+    ERHE_PROFILE_FUNCTION();
+    assert_main_thread();
+
+    if (!m_resident_records_enabled) {
+        return;
+    }
+
+    erhe::graphics::Device& graphics_device = m_mesh_memory.get_graphics_device();
+    m_resident_frame_index = graphics_device.get_frame_index();
+    uint64_t completed_frame_end = 0;
+    {
+        const std::lock_guard<std::mutex> lock{m_completed_frame_mutex};
+        completed_frame_end = m_completed_frame_end;
+    }
+    // Copies drawn this frame become patchable again once it completes.
+    graphics_device.add_completion_handler(
+        [this, alive = std::weak_ptr<int>{m_alive_token}, frame_end = m_resident_frame_index + 1]()
+        {
+            if (alive.expired()) {
+                return;
+            }
+            const std::lock_guard<std::mutex> lock{m_completed_frame_mutex};
+            m_completed_frame_end = std::max(m_completed_frame_end, frame_end);
+        }
+    );
+
+    m_resident_records.resize(m_draw_lists.size());
+
+    // Copies requested by last frame's draws.
+    for (const Resident_request& request : m_resident_requests) {
+        if (request.draw_list_index >= m_draw_lists.size()) {
+            continue;
+        }
+        if (find_resident_set(request.draw_list_index, request.patch) != nullptr) {
+            continue;
+        }
+        std::vector<Resident_record_set>& sets = m_resident_records[request.draw_list_index].sets;
+        if (sets.size() >= c_max_resident_sets_per_list) {
+            std::vector<Resident_record_set>::iterator oldest = std::min_element(
+                sets.begin(),
+                sets.end(),
+                [](const Resident_record_set& lhs, const Resident_record_set& rhs) {
+                    return lhs.last_request_frame < rhs.last_request_frame;
+                }
+            );
+            sets.erase(oldest);
+        }
+        sets.push_back(
+            Resident_record_set{
+                .patch              = request.patch,
+                .buffers            = {},
+                .current_buffer     = -1,
+                .last_request_frame = m_resident_frame_index
+            }
+        );
+    }
+    m_resident_requests.clear();
+
+    for (std::size_t list_index = 0, list_end = m_draw_lists.size(); list_index < list_end; ++list_index) {
+        Draw_list&                        draw_list = m_draw_lists[list_index];
+        std::vector<Resident_record_set>& sets      = m_resident_records[list_index].sets;
+        const std::size_t                 dirty_begin = draw_list.dirty_record_begin;
+        const std::size_t                 dirty_end   = draw_list.dirty_record_end;
+        draw_list.dirty_record_begin = 0;
+        draw_list.dirty_record_end   = 0;
+        if (sets.empty()) {
+            continue;
+        }
+
+        sets.erase(
+            std::remove_if(
+                sets.begin(),
+                sets.end(),
+                [this](const Resident_record_set& set) {
+                    return (m_resident_frame_index - set.last_request_frame) > c_resident_idle_frame_count;
+                }
+            ),
+            sets.end()
+        );
+
+        const std::size_t entry_count = draw_list.entries.size();
+        for (Resident_record_set& set : sets) {
+            // Distribute this frame's dirty range to every copy; none is up
+            // to date until one has been uploaded below.
+            for (Resident_record_buffer& resident : set.buffers) {
+                if (dirty_begin != dirty_end) {
+                    if (resident.dirty_begin == resident.dirty_end) {
+                        resident.dirty_begin = dirty_begin;
+                        resident.dirty_end   = dirty_end;
+                    } else {
+                        resident.dirty_begin = std::min(resident.dirty_begin, dirty_begin);
+                        resident.dirty_end   = std::max(resident.dirty_end,   dirty_end);
+                    }
+                }
+                if (resident.entry_count > entry_count) { // removed since the last upload
+                    resident.entry_count = entry_count;
+                }
+            }
+            if (set.current_buffer >= 0) {
+                const Resident_record_buffer& current = set.buffers[static_cast<std::size_t>(set.current_buffer)];
+                const bool up_to_date = (current.dirty_begin == current.dirty_end) && (current.entry_count == entry_count);
+                if (up_to_date) {
+                    continue;
+                }
+            }
+            set.current_buffer = -1;
+            if (entry_count == 0) {
+                continue;
+            }
+
+            // Patch a copy no frame in flight reads, preferring the least
+            // dirty one; grow the set while all are in flight.
+            int         chosen       = -1;
+            std::size_t chosen_dirty = 0;
+            for (std::size_t buffer_index = 0, buffer_end = set.buffers.size(); buffer_index < buffer_end; ++buffer_index) {
+                const Resident_record_buffer& resident = set.buffers[buffer_index];
+                if (resident.in_flight_until > completed_frame_end) {
+                    continue;
+                }
+                const std::size_t dirty =
+                    (resident.dirty_end - resident.dirty_begin) +
+                    (entry_count - std::min(entry_count, resident.entry_count));
+                if ((chosen < 0) || (dirty < chosen_dirty)) {
+                    chosen       = static_cast<int>(buffer_index);
+                    chosen_dirty = dirty;
+                }
+            }
+            if ((chosen < 0) && (set.buffers.size() < c_max_resident_buffers_per_set)) {
+                set.buffers.emplace_back();
+                chosen = static_cast<int>(set.buffers.size() - 1);
+            }
+            if (chosen < 0) {
+                continue; // every copy is in flight: the ring buffer path draws this frame
+            }
+            upload_resident_buffer(draw_list, set.patch, set.buffers[static_cast<std::size_t>(chosen)], command_buffer);
+            set.current_buffer = chosen;
+        }
+    }
+}
+
 // --- Resolution ----------------------------------------------------------------
 
 auto Draw_list_scene::get_object_mesh(const uint32_t object_index) const -> erhe::scene::Mesh*
@@ -1097,7 +1471,7 @@ auto Draw_list_scene::resolve_color_stages(Draw_list& draw_list, const uint16_t
     // primitive key never sets those axes when SHADER_DEBUG == 0), multiview
     // axis per view configuration, blending mode from the primitive key.
     Shader_key       key = draw_list.key.primitive_key;
-    const Shader_key env = m_color_environment.make_environment_key();
+    const Shader_key env = m_color_environment.make_environment_key(multiview_count);
     key.bool_mask |= env.bool_mask;
     for (std::size_t i = 0, end = key.int_values.size(); i < end; ++i) {
         if (env.int_values[i] != 0u) {
@@ -1186,6 +1560,301 @@ namespace {
 
 } // anonymous namespace
 
+void Draw_list_scene::collect_visible_entries(
+    const Draw_list&                        draw_list,
+    const erhe::Item_filter&                filter,
+    const std::span<const Draw_cull_volume> cull_volumes,
+    Draw_statistics&                        statistics
+)
+{
+    ERHE_PROFILE_FUNCTION();
+
+    const std::size_t entry_count = draw_list.entries.size();
+    m_visible_entry_indices.clear();
+
+    // Skinned entries are posed by their joints, which move without a
+    // transform hook: their bounds are not current, never cull them.
+    const bool cull =
+        m_culling_enabled &&
+        !cull_volumes.empty() &&
+        (draw_list.key.mobility != Draw_mobility::skinned);
+    if (!cull) {
+        for (std::size_t i = 0; i < entry_count; ++i) {
+            if (filter(draw_list.entries[i].flag_bits)) {
+                m_visible_entry_indices.push_back(static_cast<uint32_t>(i));
+            }
+        }
+        return;
+    }
+
+    // Bounds of the whole list against every volume first (SoA, SIMD; cheap
+    // compared to evaluating the filter per entry), then one pass that
+    // applies filter and mask.
+    ERHE_VERIFY(draw_list.culling_bounds.size() == entry_count);
+    m_cull_inside_mask.assign(entry_count, uint8_t{0});
+    for (const Draw_cull_volume& volume : cull_volumes) {
+        erhe::math::mark_aabbs_in_convex_volume(draw_list.culling_bounds, 0, entry_count, volume.get_planes(), m_cull_inside_mask);
+    }
+    std::size_t tested_count = 0;
+    for (std::size_t i = 0; i < entry_count; ++i) {
+        if (!filter(draw_list.entries[i].flag_bits)) {
+            continue;
+        }
+        ++tested_count;
+        if (m_cull_inside_mask[i] != 0) {
+            m_visible_entry_indices.push_back(static_cast<uint32_t>(i));
+        }
+    }
+    const std::size_t culled_count = tested_count - m_visible_entry_indices.size();
+    statistics.culled_entry_count += culled_count;
+    m_cull_tested_count           += tested_count;
+    m_culled_count                += culled_count;
+}
+
+void Draw_list_scene::select_entry_lods(
+    Draw_list&                draw_list,
+    const Draw_lod_selection* lod_selection,
+    Draw_statistics&          statistics
+)
+{
+    m_visible_entry_lod_levels.clear();
+    // Skinned entries: world bounds are not current (see collect_visible_entries()).
+    if (
+        (lod_selection == nullptr) ||
+        (draw_list.lod_entry_count == 0) ||
+        (draw_list.key.mobility == Draw_mobility::skinned)
+    ) {
+        return;
+    }
+
+    ERHE_PROFILE_FUNCTION();
+
+    const std::size_t visible_count = m_visible_entry_indices.size();
+    m_visible_entry_lod_levels.resize(visible_count);
+    std::size_t lod_count = 0;
+    for (std::size_t k = 0; k < visible_count; ++k) {
+        const uint32_t        i        = m_visible_entry_indices[k];
+        Draw_list_entry_lods& lods     = draw_list.entry_lods[i];
+        const uint8_t         selected = select_lod_level(*lod_selection, lods, draw_list.entries[i].world_aabb, lods.last_level);
+        lods.last_level               = selected;
+        m_visible_entry_lod_levels[k] = selected;
+        if (selected != 0) {
+            ++lod_count;
+        }
+    }
+    statistics.lod_entry_count += lod_count;
+    m_lod_entry_count          += lod_count;
+}
+
+auto Draw_list_scene::build_cluster_draws(
+    const Draw_list&                        draw_list,
+    const Draw_cluster_culling*             cluster_culling,
+    const std::span<const Draw_cull_volume> cull_volumes,
+    Draw_statistics&                        statistics
+) -> bool
+{
+    m_cluster_entry_indices.clear();
+    m_cluster_commands.clear();
+    // Skinned entries: vertices move with the joints, meshlet bounds are
+    // not valid for the posed mesh.
+    if (
+        (cluster_culling == nullptr) ||
+        (draw_list.cluster_entry_count == 0) ||
+        (draw_list.key.mobility == Draw_mobility::skinned)
+    ) {
+        return false;
+    }
+
+    ERHE_PROFILE_FUNCTION();
+
+    const std::span<const Draw_cull_volume> volumes = m_culling_enabled ? cull_volumes : std::span<const Draw_cull_volume>{};
+    const bool back_face_test = !draw_list.key.double_sided && !cluster_culling->view_positions.empty();
+    std::size_t cluster_draw_count   = 0;
+    std::size_t culled_cluster_count = 0;
+    for (std::size_t k = 0, end = m_visible_entry_indices.size(); k < end; ++k) {
+        const uint32_t                  i        = m_visible_entry_indices[k];
+        const Draw_list_entry&          entry    = draw_list.entries[i];
+        const Draw_list_entry_clusters& clusters = draw_list.entry_clusters[i];
+        const uint8_t                   lod      = m_visible_entry_lod_levels.empty() ? uint8_t{0} : m_visible_entry_lod_levels[k];
+        if (clusters.meshlets.empty() || (lod != 0)) {
+            // Whole entry (or its selected level) as one command.
+            const Draw_list_entry_lod* level = (lod != 0) ? &draw_list.entry_lods[i].levels[lod - 1] : nullptr;
+            m_cluster_commands.push_back(
+                erhe::graphics::Draw_indexed_primitives_indirect_command{
+                    (level != nullptr) ? level->index_count : entry.index_count,
+                    1,
+                    (level != nullptr) ? level->first_index : entry.first_index,
+                    entry.base_vertex,
+                    0
+                }
+            );
+            m_cluster_entry_indices.push_back(i);
+            continue;
+        }
+        m_cluster_view_positions.clear();
+        if (back_face_test) {
+            const glm::mat4 node_from_world = glm::inverse(clusters.world_from_node);
+            for (const glm::vec3& view_position : cluster_culling->view_positions) {
+                m_cluster_view_positions.push_back(glm::vec3{node_from_world * glm::vec4{view_position, 1.0f}});
+            }
+        }
+        const std::size_t count = append_cluster_draw_commands(
+            clusters.meshlets,
+            clusters.base_index,
+            entry.base_vertex,
+            clusters.world_from_node,
+            volumes,
+            m_cluster_view_positions,
+            m_cluster_commands
+        );
+        // Every command of the entry uses the entry's record.
+        m_cluster_entry_indices.insert(m_cluster_entry_indices.end(), count, i);
+        cluster_draw_count   += count;
+        culled_cluster_count += clusters.meshlets.size() - count;
+    }
+    statistics.cluster_draw_count   += cluster_draw_count;
+    statistics.culled_cluster_count += culled_cluster_count;
+    m_cluster_draw_count            += cluster_draw_count;
+    m_culled_cluster_count          += culled_cluster_count;
+    return true;
+}
+
+void Draw_list_scene::draw_cluster_chunks(
+    Draw_list&                               draw_list,
+    erhe::graphics::Render_command_encoder&  render_encoder,
+    erhe::graphics::Render_pipeline&         render_pipeline,
+    Primitive_buffer&                        primitive_buffer,
+    Draw_indirect_buffer&                    draw_indirect_buffer,
+    const Primitive_interface_settings&      primitive_settings,
+    const erhe::dataformat::Format           index_format,
+    Draw_statistics&                         statistics
+)
+{
+    // Same chunking as the ring buffer path, by command: each command gets
+    // its own (repeated) record so ERHE_DRAW_ID keeps indexing records.
+    const std::size_t max_per_chunk = std::max<std::size_t>(std::size_t{1}, primitive_buffer.get_max_primitive_count());
+    const std::size_t command_count = m_cluster_commands.size();
+    ERHE_VERIFY(m_cluster_entry_indices.size() == command_count);
+    for (std::size_t begin = 0; begin < command_count; begin += max_per_chunk) {
+        const std::size_t end = std::min(command_count, begin + max_per_chunk);
+        const std::span<const uint32_t> entry_indices{m_cluster_entry_indices.data() + begin, end - begin};
+        const std::span<const erhe::graphics::Draw_indexed_primitives_indirect_command> commands{m_cluster_commands.data() + begin, end - begin};
+
+        erhe::graphics::Ring_buffer_range primitive_range     = primitive_buffer.update(draw_list, entry_indices, *this, primitive_settings);
+        Draw_indirect_buffer_range        draw_indirect_range = draw_indirect_buffer.update(commands);
+
+        primitive_buffer.bind(render_encoder, primitive_range);
+        draw_indirect_buffer.bind(render_encoder, draw_indirect_range.range);
+
+        render_encoder.multi_draw_indexed_primitives_indirect(
+            render_pipeline.get_create_info().base.input_assembly.primitive_topology,
+            index_format,
+            draw_indirect_range.range.get_byte_start_offset_in_buffer(),
+            draw_indirect_range.draw_indirect_count,
+            sizeof(erhe::graphics::Draw_indexed_primitives_indirect_command)
+        );
+
+        primitive_range.release();
+        draw_indirect_range.range.release();
+
+        statistics.draw_call_count += 1;
+    }
+    statistics.entry_count += m_visible_entry_indices.size();
+}
+
+auto Draw_list_scene::draw_resident_chunks(
+    Draw_list&                               draw_list,
+    erhe::graphics::Render_command_encoder&  render_encoder,
+    erhe::graphics::Render_pipeline&         render_pipeline,
+    Primitive_buffer&                        primitive_buffer,
+    Draw_indirect_buffer&                    draw_indirect_buffer,
+    const Primitive_interface_settings&      primitive_settings,
+    const erhe::dataformat::Format           index_format,
+    Draw_statistics&                         statistics
+) -> bool
+{
+    if (
+        !m_resident_records_enabled ||
+        (draw_list.key.mobility != Draw_mobility::static_) ||
+        !Primitive_record_patch::is_patchable(primitive_settings)
+    ) {
+        return false;
+    }
+    ERHE_VERIFY(primitive_buffer.get_max_primitive_count() == m_primitive_interface.max_primitive_count);
+
+    const uint32_t               draw_list_index = static_cast<uint32_t>(&draw_list - m_draw_lists.data());
+    const Primitive_record_patch patch           = Primitive_record_patch::from_settings(primitive_settings);
+    Resident_record_set*         set             = find_resident_set(draw_list_index, patch);
+    if (set == nullptr) {
+        for (const Resident_request& request : m_resident_requests) {
+            if ((request.draw_list_index == draw_list_index) && (request.patch == patch)) {
+                return false;
+            }
+        }
+        m_resident_requests.push_back(Resident_request{.draw_list_index = draw_list_index, .patch = patch});
+        return false;
+    }
+    set->last_request_frame = m_resident_frame_index;
+
+    // Records changed after update_resident_records() (draw-time GPU slot
+    // sync) are not in any copy yet: the ring buffer path draws this frame.
+    if ((draw_list.dirty_record_begin != draw_list.dirty_record_end) || (set->current_buffer < 0)) {
+        return false;
+    }
+    Resident_record_buffer& resident = set->buffers[static_cast<std::size_t>(set->current_buffer)];
+    if (resident.entry_count != draw_list.entries.size()) {
+        return false;
+    }
+
+    // One multi-draw per resident chunk with visible entries. Commands cover
+    // the chunk up to its last visible entry so that ERHE_DRAW_ID equals the
+    // record position in the bound chunk; hidden entries draw nothing.
+    const std::size_t max_per_chunk = std::max<std::size_t>(std::size_t{1}, m_primitive_interface.max_primitive_count);
+    const std::size_t visible_count = m_visible_entry_indices.size();
+    std::size_t cursor = 0;
+    while (cursor < visible_count) {
+        const std::size_t chunk_begin = (m_visible_entry_indices[cursor] / max_per_chunk) * max_per_chunk;
+        const std::size_t chunk_end   = std::min(draw_list.entries.size(), chunk_begin + max_per_chunk);
+        std::size_t cursor_end = cursor;
+        while ((cursor_end < visible_count) && (m_visible_entry_indices[cursor_end] < chunk_end)) {
+            ++cursor_end;
+        }
+        const std::span<const uint32_t> entry_indices{m_visible_entry_indices.data() + cursor, cursor_end - cursor};
+        const std::span<const uint8_t>  lod_levels = m_visible_entry_lod_levels.empty()
+            ? std::span<const uint8_t>{}
+            : std::span<const uint8_t>{m_visible_entry_lod_levels.data() + cursor, cursor_end - cursor};
+
+        Draw_indirect_buffer_range draw_indirect_range = draw_indirect_buffer.update(draw_list, chunk_begin, chunk_end, entry_indices, lod_levels);
+        const std::size_t command_count = draw_indirect_range.draw_indirect_count;
+        ERHE_VERIFY((command_count > 0) && (command_count <= chunk_end - chunk_begin));
+
+        primitive_buffer.bind_resident(
+            render_encoder,
+            *resident.buffer.get(),
+            get_resident_record_offset(chunk_begin),
+            command_count * m_primitive_record_stride
+        );
+        draw_indirect_buffer.bind(render_encoder, draw_indirect_range.range);
+
+        render_encoder.multi_draw_indexed_primitives_indirect(
+            render_pipeline.get_create_info().base.input_assembly.primitive_topology,
+            index_format,
+            draw_indirect_range.range.get_byte_start_offset_in_buffer(),
+            draw_indirect_range.draw_indirect_count,
+            sizeof(erhe::graphics::Draw_indexed_primitives_indirect_command)
+        );
+
+        draw_indirect_range.range.release();
+
+        statistics.entry_count     += entry_indices.size();
+        statistics.draw_call_count += 1;
+        m_resident_entry_count     += entry_indices.size();
+        cursor = cursor_end;
+    }
+    resident.in_flight_until = m_resident_frame_index + 1;
+    return true;
+}
+
 void Draw_list_scene::draw_list_chunks(
     Draw_list&                               draw_list,
     erhe::graphics::Render_command_encoder&  render_encoder,
@@ -1194,53 +1863,61 @@ void Draw_list_scene::draw_list_chunks(
     Draw_indirect_buffer&                    draw_indirect_buffer,
     const Primitive_interface_settings&      primitive_settings,
     const erhe::Item_filter&                 filter,
+    const std::span<const Draw_cull_volume>  cull_volumes,
+    const Draw_lod_selection*                lod_selection,
+    const Draw_cluster_culling*              cluster_culling,
     Draw_statistics&                         statistics
 )
 {
+    collect_visible_entries(draw_list, filter, cull_volumes, statistics);
+    // Lists with nothing visible acquire no ring buffer space (e.g. the
+    // "selected" passes when nothing is selected, lists behind the camera).
+    if (m_visible_entry_indices.empty()) {
+        return;
+    }
+
     // P3a: chunk entries so no multi-draw exceeds the primitive block capacity
     // (ERHE_DRAW_ID indexes the primitives[] array).
     const std::size_t max_per_chunk = std::max<std::size_t>(std::size_t{1}, primitive_buffer.get_max_primitive_count());
-    const std::size_t entry_count   = draw_list.entries.size();
-    bool list_drew = false;
+    const std::size_t visible_count = m_visible_entry_indices.size();
 
     erhe::graphics::Buffer* index_buffer = m_mesh_memory.get_index_buffer(draw_list.key.buffer_set.index_buffer);
     const erhe::dataformat::Format index_format = m_mesh_memory.get_index_format(draw_list.key.buffer_set.index_buffer);
-    bool buffers_bound = false;
 
-    for (std::size_t begin = 0; begin < entry_count; begin += max_per_chunk) {
-        const std::size_t end = std::min(entry_count, begin + max_per_chunk);
+    render_encoder.set_render_pipeline(render_pipeline);
+    render_encoder.set_index_buffer(index_buffer);
+    for (std::size_t stream_index = 0, stream_end = draw_list.key.buffer_set.vertex_buffers.size(); stream_index < stream_end; ++stream_index) {
+        erhe::graphics::Buffer* vertex_buffer = m_mesh_memory.get_vertex_buffer(draw_list.key.buffer_set.vertex_buffers[stream_index]);
+        render_encoder.set_vertex_buffer(vertex_buffer, 0, static_cast<uint32_t>(stream_index));
+    }
 
-        // Skip chunks with no passing entries without acquiring ring buffer
-        // space (e.g. the "selected" passes when nothing is selected).
-        bool any_passing = false;
-        for (std::size_t i = begin; i < end; ++i) {
-            if (filter(draw_list.entries[i].flag_bits)) {
-                any_passing = true;
-                break;
-            }
-        }
-        if (!any_passing) {
-            continue;
-        }
+    select_entry_lods(draw_list, lod_selection, statistics);
 
-        std::size_t primitive_count = 0;
-        erhe::graphics::Ring_buffer_range primitive_range = primitive_buffer.update(draw_list, begin, end, *this, filter, primitive_settings, primitive_count);
-        if (primitive_count == 0) {
-            primitive_range.release();
-            continue;
-        }
-        Draw_indirect_buffer_range draw_indirect_range = draw_indirect_buffer.update(draw_list, begin, end, filter);
-        ERHE_VERIFY(draw_indirect_range.draw_indirect_count == primitive_count);
-
-        if (!buffers_bound) {
-            render_encoder.set_render_pipeline(render_pipeline);
-            render_encoder.set_index_buffer(index_buffer);
-            for (std::size_t stream_index = 0, stream_end = draw_list.key.buffer_set.vertex_buffers.size(); stream_index < stream_end; ++stream_index) {
-                erhe::graphics::Buffer* vertex_buffer = m_mesh_memory.get_vertex_buffer(draw_list.key.buffer_set.vertex_buffers[stream_index]);
-                render_encoder.set_vertex_buffer(vertex_buffer, 0, static_cast<uint32_t>(stream_index));
-            }
-            buffers_bound = true;
+    // Cluster culled lists draw through the ring buffer: a resident copy
+    // holds one record per entry, not one per meshlet command.
+    if (build_cluster_draws(draw_list, cluster_culling, cull_volumes, statistics)) {
+        if (!m_cluster_commands.empty()) {
+            draw_cluster_chunks(draw_list, render_encoder, render_pipeline, primitive_buffer, draw_indirect_buffer, primitive_settings, index_format, statistics);
+            statistics.draw_list_count += 1;
         }
+        return;
+    }
+
+    if (draw_resident_chunks(draw_list, render_encoder, render_pipeline, primitive_buffer, draw_indirect_buffer, primitive_settings, index_format, statistics)) {
+        statistics.draw_list_count += 1;
+        return;
+    }
+
+    for (std::size_t begin = 0; begin < visible_count; begin += max_per_chunk) {
+        const std::size_t end = std::min(visible_count, begin + max_per_chunk);
+        const std::span<const uint32_t> entry_indices{m_visible_entry_indices.data() + begin, end - begin};
+        const std::span<const uint8_t>  lod_levels = m_visible_entry_lod_levels.empty()
+            ? std::span<const uint8_t>{}
+            : std::span<const uint8_t>{m_visible_entry_lod_levels.data() + begin, end - begin};
+
+        erhe::graphics::Ring_buffer_range primitive_range     = primitive_buffer.update(draw_list, entry_indices, *this, primitive_settings);
+        Draw_indirect_buffer_range        draw_indirect_range = draw_indirect_buffer.update(draw_list, entry_indices, lod_levels);
+        ERHE_VERIFY(draw_indirect_range.draw_indirect_count == entry_indices.size());
 
         primitive_buffer.bind(render_encoder, primitive_range);
         draw_indirect_buffer.bind(render_encoder, draw_indirect_range.range);
@@ -1256,13 +1933,10 @@ void Draw_list_scene::draw_list_chunks(
         primitive_range.release();
         draw_indirect_range.range.release();
 
-        statistics.entry_count     += primitive_count;
+        statistics.entry_count     += entry_indices.size();
         statistics.draw_call_count += 1;
-        list_drew = true;
-    }
-    if (list_drew) {
-        statistics.draw_list_count += 1;
     }
+    statistics.draw_list_count += 1;
 }
 
 auto Draw_list_scene::has_drawable_entries(
@@ -1361,6 +2035,9 @@ auto Draw_list_scene::draw_color(const Draw_color_parameters& parameters) -> Dra
                 parameters.draw_indirect_buffer,
                 parameters.primitive_settings,
                 parameters.filter,
+                parameters.cull_volumes,
+                parameters.lod_selection,
+                parameters.cluster_culling,
                 statistics
             );
         }
@@ -1418,6 +2095,9 @@ auto Draw_list_scene::draw_shadow(const Draw_shadow_parameters& parameters) -> D
             parameters.draw_indirect_buffer,
             Primitive_interface_settings{},
             parameters.filter,
+            parameters.cull_volumes,
+            nullptr, // shadow casters draw full detail, see add_entries()
+            nullptr, // and whole entries: one meshlet command per caster would not pay off
             statistics
         );
     }
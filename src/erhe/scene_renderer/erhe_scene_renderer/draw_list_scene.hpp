@@ -5,6 +5,7 @@
 #include "erhe_scene_renderer/primitive_buffer.hpp"
 #include "erhe_scene_renderer/shader_key.hpp"
 
+#include "erhe_dataformat/dataformat.hpp"
 #include "erhe_item/item.hpp"
 
 #include <cstdint>
@@ -18,7 +19,9 @@
 
 namespace erhe::graphics {
     class Base_render_pipeline;
+    class Buffer;
     class Color_blend_state;
+    class Command_buffer;
     class Render_command_encoder;
     class Render_pass;
     class Render_pipeline;
@@ -47,12 +50,15 @@ public:
     // this frame. Toggling it changes the shader variant of every color
     // draw, so it belongs in the environment the cached resolutions key on.
     bool                  ddgi_enabled     {false};
+    // Clustered light assignment (Forward_renderer::set_clustered_lights()).
+    // Single view passes only: multiview keys keep the flat light loops.
+    bool                  clustered_lights {false};
 
     [[nodiscard]] auto operator==(const Color_environment& other) const -> bool;
     // The environment Shader_key exactly as Forward_renderer::render() builds
-    // it (light counts, shadow axes; SHADER_DEBUG 0), before the multiview
-    // axis is added per view configuration.
-    [[nodiscard]] auto make_environment_key() const -> Shader_key;
+    // it (light counts, shadow axes; SHADER_DEBUG 0) for the given view
+    // configuration, before the multiview axis itself is added.
+    [[nodiscard]] auto make_environment_key(uint16_t multiview_count) const -> Shader_key;
 };
 
 // Everything draw_color() needs beyond what the lists carry (R6/R7/R8/R8a).
@@ -77,6 +83,15 @@ public:
     // nullptr: pick color_blend_disabled / color_blend_premultiplied by the
     // list's blending class, as Forward_renderer::render() does.
     const erhe::graphics::Color_blend_state* color_blend_override{nullptr};
+    // Culling stage: an entry is drawn when its world bounds are inside at
+    // least one volume (one per view for multiview). Empty: no culling.
+    std::span<const Draw_cull_volume>       cull_volumes        {};
+    // Level of detail selection of the visible entries that have levels
+    // (Buffer_mesh::triangle_fill_lods). nullptr: always full detail.
+    const Draw_lod_selection*               lod_selection       {nullptr};
+    // Meshlet level culling of the visible full detail entries that have
+    // meshlets (Buffer_mesh::triangle_fill_meshlets). nullptr: whole entries.
+    const Draw_cluster_culling*             cluster_culling     {nullptr};
     std::string_view                        debug_label         {};
 };
 
@@ -92,6 +107,8 @@ public:
     erhe::Item_filter                       filter              {};
     std::span<const erhe::scene::Layer_id>  layers              {};
     Shadow_sub_variant                      sub_variant         {Shadow_sub_variant::depth_only};
+    // Caster culling (make_shadow_cull_volume()). Empty: no culling.
+    std::span<const Draw_cull_volume>       cull_volumes        {};
     std::string_view                        debug_label         {};
 };
 
@@ -181,8 +198,9 @@ public:
 
     // --- Drawing (main thread, inside the owning renderer's pass) ------------
     // Draws every list matching layers / blending, filtering entries by
-    // parameters.filter against their mirrored flag bits (R7a). Cached
-    // resolutions are used (R20); a not-yet-resolved (view config,
+    // parameters.filter against their mirrored flag bits (R7a) and culling
+    // them against parameters.cull_volumes (skinned lists are not culled).
+    // Cached resolutions are used (R20); a not-yet-resolved (view config,
     // sub-variant) resolves once, lazily. Returns what was drawn.
     auto draw_color (const Draw_color_parameters&  parameters) -> Draw_statistics;
     auto draw_shadow(const Draw_shadow_parameters& parameters) -> Draw_statistics;
@@ -196,6 +214,26 @@ public:
         const erhe::Item_filter&               filter
     ) const -> bool;
 
+    // Culling stage switch (default on). Off draws every entry that passes
+    // the flag filter, ignoring the cull volumes (pixel parity checks).
+    void set_culling_enabled(bool value) { m_culling_enabled = value; }
+    [[nodiscard]] auto get_culling_enabled() const -> bool { return m_culling_enabled; }
+
+    // --- Resident records of static lists -----------------------------------
+    // (doc/draw_list_performance_improvements.md) Static lists keep GPU
+    // copies of their records, one per pass patch (Primitive_record_patch)
+    // that has drawn the list recently - the per-pass side table - so their
+    // passes bind a persistent buffer instead of copying every record into
+    // the ring buffer each frame. Main thread, once per frame after
+    // flush_pending() and before any draw, outside render passes: creates
+    // the copies requested by last frame's draws and uploads the record
+    // ranges dirtied since the previous call into command_buffer.
+    void update_resident_records(erhe::graphics::Command_buffer& command_buffer);
+    // Default on. Off releases every resident copy; all lists draw through
+    // the ring buffer.
+    void set_resident_records_enabled(bool value);
+    [[nodiscard]] auto get_resident_records_enabled() const -> bool { return m_resident_records_enabled; }
+
     // Object mesh lookup for per-entry upload (Primitive_buffer slow path).
     [[nodiscard]] auto get_object_mesh(uint32_t object_index) const -> erhe::scene::Mesh*;
     // Byte stride of one record in Draw_list::primitive_records
@@ -212,6 +250,24 @@ public:
     [[nodiscard]] auto get_transform_update_count        () const -> std::size_t { return m_transform_update_count; }
     [[nodiscard]] auto get_refresh_count                 () const -> std::size_t { return m_refresh_count; }
     [[nodiscard]] auto get_slot_sync_count               () const -> std::size_t { return m_slot_sync_count; }
+    // Culling counters, accumulated over every draw_color() / draw_shadow()
+    // since construction: entries tested against cull volumes (passed the
+    // flag filter in a culled list) and entries rejected.
+    [[nodiscard]] auto get_cull_tested_count             () const -> std::size_t { return m_cull_tested_count; }
+    [[nodiscard]] auto get_culled_count                  () const -> std::size_t { return m_culled_count; }
+    // Entries drawn with a coarser level of detail, accumulated over every
+    // draw_color() since construction.
+    [[nodiscard]] auto get_lod_entry_count               () const -> std::size_t { return m_lod_entry_count; }
+    // Cluster culling: meshlet draw commands emitted and meshlets culled,
+    // accumulated over every draw_color() since construction.
+    [[nodiscard]] auto get_cluster_draw_count            () const -> std::size_t { return m_cluster_draw_count; }
+    [[nodiscard]] auto get_culled_cluster_count          () const -> std::size_t { return m_culled_cluster_count; }
+    // Resident records: entries drawn from resident copies and bytes
+    // uploaded to them (both accumulated since construction), and the bytes
+    // currently allocated for them.
+    [[nodiscard]] auto get_resident_entry_count          () const -> std::size_t { return m_resident_entry_count; }
+    [[nodiscard]] auto get_resident_upload_byte_count    () const -> std::size_t { return m_resident_upload_byte_count; }
+    [[nodiscard]] auto get_resident_byte_count           () const -> std::size_t;
 
 private:
     class Pending_op
@@ -224,6 +280,42 @@ private:
         uint64_t                           flag_bits {0};
     };
 
+    // One GPU copy of a static list's records with one patch applied. A
+    // list keeps several per patch so a changed list is never patched in a
+    // copy a frame in flight may still read.
+    class Resident_record_buffer
+    {
+    public:
+        std::unique_ptr<erhe::graphics::Buffer> buffer;
+        std::size_t                             capacity_entry_count{0};
+        std::size_t                             entry_count         {0}; // records uploaded
+        // Records changed since this copy was last uploaded.
+        std::size_t                             dirty_begin         {0};
+        std::size_t                             dirty_end           {0};
+        // Device frame index + 1 of the last draw from this copy; 0: never.
+        uint64_t                                in_flight_until     {0};
+    };
+    class Resident_record_set
+    {
+    public:
+        Primitive_record_patch              patch;
+        std::vector<Resident_record_buffer> buffers;
+        int                                 current_buffer    {-1}; // up to date copy, -1 none
+        uint64_t                            last_request_frame{0};
+    };
+    // Side table entry of one draw list (parallel to m_draw_lists).
+    class Resident_record_list
+    {
+    public:
+        std::vector<Resident_record_set> sets;
+    };
+    class Resident_request
+    {
+    public:
+        uint32_t               draw_list_index{0};
+        Primitive_record_patch patch;
+    };
+
     void assert_main_thread() const;
     auto allocate_object   () -> uint32_t;
     void release_object    (uint32_t object_index);
@@ -235,10 +327,13 @@ private:
     void remove_entry      (const Draw_list_entry_location& location);
     // --- Primitive records (doc/draw_list_performance_improvements.md) ---
     [[nodiscard]] auto get_record(const Draw_list_entry_location& location) -> std::byte*;
+    // World bounds of one entry from the live node transform.
+    [[nodiscard]] auto get_entry_world_aabb(const Draw_list_object& object, uint16_t mesh_primitive_index) const -> erhe::math::Aabb;
     // Full record from the live mesh / node / primitive for one entry.
     void write_entry_record      (const Draw_list_object& object, const Draw_list_entry& entry, std::byte* record) const;
-    // world_from_node / normal_transform of every record of the object from
-    // its node; records object.transform_serial.
+    // world_from_node / normal_transform of every record of the object, and
+    // its entries' world bounds, from its node; records
+    // object.transform_serial.
     void write_object_transform  (uint32_t object_index);
     // material_index / skinning_factor / base_joint_index of every record of
     // the object from the live GPU slots; records object.joint_slot.
@@ -263,7 +358,72 @@ private:
     auto resolve_color_stages(Draw_list& draw_list, uint16_t multiview_count) -> const erhe::graphics::Reloadable_shader_stages*;
     auto resolve_shadow_stages(Draw_list& draw_list, Shadow_sub_variant sub_variant) -> const erhe::graphics::Reloadable_shader_stages*;
     void set_color_environment(const Color_environment& environment);
-    // Draw one list in chunks of <= max primitives per multi-draw (P3a).
+    // Culling stage: fills m_visible_entry_indices with the entries of the
+    // list that pass filter and are inside at least one of cull_volumes.
+    void collect_visible_entries(
+        const Draw_list&                         draw_list,
+        const erhe::Item_filter&                 filter,
+        std::span<const Draw_cull_volume>        cull_volumes,
+        Draw_statistics&                         statistics
+    );
+    // Level of detail stage: fills m_visible_entry_lod_levels (parallel to
+    // m_visible_entry_indices; 0 full detail, N entry_lods.levels[N - 1]),
+    // or leaves it empty when every visible entry draws full detail. The
+    // selected levels are kept in Draw_list_entry_lods::last_level.
+    void select_entry_lods(
+        Draw_list&                               draw_list,
+        const Draw_lod_selection*                lod_selection,
+        Draw_statistics&                         statistics
+    );
+    // Cluster culling stage: fills m_cluster_commands with one command per
+    // visible meshlet of the visible full detail entries with meshlets and
+    // one per other visible entry (its selected level), and
+    // m_cluster_entry_indices (parallel) with the entry of each command.
+    // False when the list is not cluster culled (draws entries as usual).
+    auto build_cluster_draws(
+        const Draw_list&                         draw_list,
+        const Draw_cluster_culling*              cluster_culling,
+        std::span<const Draw_cull_volume>        cull_volumes,
+        Draw_statistics&                         statistics
+    ) -> bool;
+    void draw_cluster_chunks(
+        Draw_list&                               draw_list,
+        erhe::graphics::Render_command_encoder&  render_encoder,
+        erhe::graphics::Render_pipeline&         render_pipeline,
+        Primitive_buffer&                        primitive_buffer,
+        Draw_indirect_buffer&                    draw_indirect_buffer,
+        const Primitive_interface_settings&      primitive_settings,
+        erhe::dataformat::Format                 index_format,
+        Draw_statistics&                         statistics
+    );
+    // Static list records changed: widen the list's dirty range.
+    void mark_record_dirty(Draw_list& draw_list, uint32_t entry_index);
+    // Resident copy layout: chunks of max_primitive_count records, each chunk
+    // starting at a buffer offset aligned for binding.
+    [[nodiscard]] auto get_resident_record_offset(std::size_t entry_index) const -> std::size_t;
+    [[nodiscard]] auto get_resident_byte_size    (std::size_t entry_count) const -> std::size_t;
+    [[nodiscard]] auto find_resident_set(uint32_t draw_list_index, const Primitive_record_patch& patch) -> Resident_record_set*;
+    void upload_resident_buffer(
+        const Draw_list&                draw_list,
+        const Primitive_record_patch&   patch,
+        Resident_record_buffer&         resident,
+        erhe::graphics::Command_buffer& command_buffer
+    );
+    // Draws the visible entries of a static list from its up to date
+    // resident copy for the pass patch; false (nothing drawn) when there is
+    // none, in which case the copy is requested for the next frame.
+    auto draw_resident_chunks(
+        Draw_list&                               draw_list,
+        erhe::graphics::Render_command_encoder&  render_encoder,
+        erhe::graphics::Render_pipeline&         render_pipeline,
+        Primitive_buffer&                        primitive_buffer,
+        Draw_indirect_buffer&                    draw_indirect_buffer,
+        const Primitive_interface_settings&      primitive_settings,
+        erhe::dataformat::Format                 index_format,
+        Draw_statistics&                         statistics
+    ) -> bool;
+    // Draw the visible entries of one list in chunks of <= max primitives
+    // per multi-draw (P3a).
     void draw_list_chunks(
         Draw_list&                               draw_list,
         erhe::graphics::Render_command_encoder&  render_encoder,
@@ -272,6 +432,9 @@ private:
         Draw_indirect_buffer&                    draw_indirect_buffer,
         const Primitive_interface_settings&      primitive_settings,
         const erhe::Item_filter&                 filter,
+        std::span<const Draw_cull_volume>        cull_volumes,
+        const Draw_lod_selection*                lod_selection,
+        const Draw_cluster_culling*              cluster_culling,
         Draw_statistics&                         statistics
     );
 
@@ -299,6 +462,34 @@ private:
     std::size_t                                                      m_refresh_count{0};
     std::size_t                                                      m_slot_sync_count{0};
 
+    // Culling stage scratch (capacity kept between draws) and counters.
+    bool                                                             m_culling_enabled{true};
+    std::vector<uint8_t>                                             m_cull_inside_mask;
+    std::vector<uint32_t>                                            m_visible_entry_indices;
+    std::vector<uint8_t>                                             m_visible_entry_lod_levels;
+    std::size_t                                                      m_cull_tested_count{0};
+    std::size_t                                                      m_culled_count{0};
+    std::size_t                                                      m_lod_entry_count{0};
+    std::vector<uint32_t>                                            m_cluster_entry_indices;
+    std::vector<erhe::graphics::Draw_indexed_primitives_indirect_command> m_cluster_commands;
+    std::vector<glm::vec3>                                           m_cluster_view_positions;
+    std::size_t                                                      m_cluster_draw_count{0};
+    std::size_t                                                      m_culled_cluster_count{0};
+
+    // Resident records of static lists (side table) and their bookkeeping.
+    bool                                                             m_resident_records_enabled{true};
+    std::vector<Resident_record_list>                                m_resident_records;
+    std::vector<Resident_request>                                    m_resident_requests;
+    std::vector<std::byte>                                           m_resident_scratch;
+    std::size_t                                                      m_resident_chunk_byte_stride{0};
+    uint64_t                                                         m_resident_frame_index{0};
+    // Frame completion (device completion handlers; guarded by the mutex).
+    std::shared_ptr<int>                                             m_alive_token;
+    mutable std::mutex                                               m_completed_frame_mutex;
+    uint64_t                                                         m_completed_frame_end{0};
+    std::size_t                                                      m_resident_entry_count{0};
+    std::size_t                                                      m_resident_upload_byte_count{0};
+
     class Material_watch
     {
     public:
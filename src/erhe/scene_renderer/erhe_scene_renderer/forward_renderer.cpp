@@ -28,6 +28,7 @@
 #include <fmt/format.h>
 
 #include <functional>
+#include <optional>
 
 namespace erhe::scene_renderer {
 
@@ -50,6 +51,7 @@ Forward_renderer::Forward_renderer(
     , m_draw_indirect_buffer{graphics_device, program_interface.config.max_draw_count}
     , m_joint_buffer        {graphics_device, program_interface.joint_interface}
     , m_light_buffer        {graphics_device, init_command_buffer, program_interface.light_interface}
+    , m_light_cluster_buffer{graphics_device, program_interface.light_cluster_interface}
     , m_material_buffer     {graphics_device, program_interface.material_interface}
     , m_primitive_buffer    {graphics_device, program_interface.primitive_interface}
     , m_fallback_sampler{
@@ -103,6 +105,11 @@ const char* safe_str(const char* str)
 
 }
 
+auto Forward_renderer::use_clustered_lights() const -> bool
+{
+    return m_clustered_lights && m_program_interface.light_cluster_interface.supported;
+}
+
 auto Forward_renderer::begin_pass(
     const Base_render_parameters& base,
     const glm::uvec4&             debug_joint_indices,
@@ -196,6 +203,33 @@ auto Forward_renderer::begin_pass(
         m_ddgi_probe_data_texture.get()
     );
 
+    // Cluster light lists from the same camera as the camera UBO above.
+    // Single view passes with clustering enabled always get a valid grid:
+    // when no cluster view can be made (no projection, z_near <= 0) one
+    // cluster holds all lights, so the environment key (and with it the
+    // draw list caches) depends only on the setting and the view count.
+    // Passes that do not use the clusters still bind an empty grid so the
+    // shared bind group is always complete.
+    state.clustered_lights = use_clustered_lights() && (base.views.size() == 1);
+    if (state.clustered_lights) {
+        uint32_t spot_light_count = 0;
+        if (base.light_projections != nullptr) {
+            spot_light_count = collect_cluster_lights(*base.light_projections, m_program_interface.light_interface.max_light_count, m_light_cluster_lights);
+        } else {
+            m_light_cluster_lights.clear();
+        }
+        Light_cluster_view cluster_view{};
+        if (make_light_cluster_view(base.views[0], base.reverse_depth, base.depth_range, base.conventions, cluster_view)) {
+            m_light_cluster_builder.build(cluster_view, m_light_cluster_lights, m_light_cluster_settings, m_light_clusters);
+        } else {
+            make_single_light_cluster(m_light_cluster_lights, m_light_clusters);
+        }
+        state.light_cluster_range = m_light_cluster_buffer.update(&m_light_clusters, spot_light_count);
+    } else {
+        state.light_cluster_range = m_light_cluster_buffer.update(nullptr, 0);
+    }
+    m_light_cluster_buffer.bind(render_encoder, state.light_cluster_range);
+
     m_texture_heap->bind(render_encoder);
 
     render_encoder.set_viewport_rect(base.viewport.x, base.viewport.y, base.viewport.width, base.viewport.height);
@@ -213,6 +247,7 @@ void Forward_renderer::end_pass(Pass_state& state, erhe::graphics::Render_comman
     state.material_range.release();
     state.joint_range.release();
     state.light_range.release();
+    state.light_cluster_range.release();
 
     m_texture_heap->unbind(render_encoder.get_command_buffer());
 }
@@ -240,9 +275,63 @@ auto Forward_renderer::render_draw_lists(const Draw_list_render_parameters& para
     environment.shadow_technique  = parameters.shadow_technique;
     environment.shadow_depth_bits = parameters.shadow_depth_bits;
     environment.ddgi_enabled      = m_ddgi.is_valid();
+    // The setting, not Pass_state::clustered_lights: the environment stays
+    // the same from pass to pass, and make_environment_key() drops the
+    // clustered path for multiview the same way begin_pass() does.
+    environment.clustered_lights  = use_clustered_lights();
     // Same convention as render(): 0 for single view, N for multiview.
     const uint16_t multiview_count = (base.views.size() >= 2) ? static_cast<uint16_t>(base.views.size()) : uint16_t{0};
 
+    // One cull volume per view, from the same clip_from_world that
+    // Camera_buffer::update_views() writes; an entry is drawn if any view
+    // can see it. Views without projection or node are left unculled.
+    m_cull_volumes.clear();
+    bool cull_views = true;
+    for (const Camera_view_input& view : base.views) {
+        if ((view.projection == nullptr) || (view.node == nullptr)) {
+            cull_views = false;
+            break;
+        }
+        const glm::mat4 clip_from_node  = view.projection->clip_from_node_transform(view.viewport, base.reverse_depth, base.depth_range, base.conventions).get_matrix();
+        const glm::mat4 clip_from_world = clip_from_node * view.node->node_from_world();
+        m_cull_volumes.push_back(make_view_cull_volume(clip_from_world, base.depth_range));
+    }
+    if (!cull_views) {
+        m_cull_volumes.clear();
+    }
+
+    std::optional<Draw_lod_selection> lod_selection{};
+    if ((parameters.lod_max_pixel_error > 0.0f) && !base.views.empty()) {
+        const Camera_view_input& view = base.views.front();
+        if ((view.projection != nullptr) && (view.node != nullptr)) {
+            lod_selection = make_lod_selection(
+                view.projection->clip_from_node_transform(view.viewport, base.reverse_depth, base.depth_range, base.conventions).get_matrix(),
+                glm::vec3{view.node->position_in_world()},
+                view.viewport.height,
+                parameters.lod_max_pixel_error
+            );
+        }
+    }
+
+    // Back face tests need the eye of every view: a meshlet is dropped only
+    // when it faces away from all of them. Views without node leave it out.
+    std::optional<Draw_cluster_culling> cluster_culling{};
+    if (parameters.cluster_culling) {
+        m_cluster_view_positions.clear();
+        bool view_positions = true;
+        for (const Camera_view_input& view : base.views) {
+            if (view.node == nullptr) {
+                view_positions = false;
+                break;
+            }
+            m_cluster_view_positions.push_back(glm::vec3{view.node->position_in_world()});
+        }
+        if (!view_positions) {
+            m_cluster_view_positions.clear();
+        }
+        cluster_culling = Draw_cluster_culling{.view_positions = m_cluster_view_positions};
+    }
+
     Draw_statistics statistics{};
     for (erhe::graphics::Base_render_pipeline* base_render_pipeline : parameters.base_render_pipelines) {
         erhe::graphics::Scoped_debug_group pipeline_scope{
@@ -263,12 +352,19 @@ auto Forward_renderer::render_draw_lists(const Draw_list_render_parameters& para
                 .multiview_count      = multiview_count,
                 .environment          = environment,
                 .color_blend_override = parameters.color_blend_override,
+                .cull_volumes         = m_cull_volumes,
+                .lod_selection        = lod_selection.has_value() ? &lod_selection.value() : nullptr,
+                .cluster_culling      = cluster_culling.has_value() ? &cluster_culling.value() : nullptr,
                 .debug_label          = base.debug_label
             }
         );
-        statistics.draw_list_count += pass_statistics.draw_list_count;
-        statistics.entry_count     += pass_statistics.entry_count;
-        statistics.draw_call_count += pass_statistics.draw_call_count;
+        statistics.draw_list_count      += pass_statistics.draw_list_count;
+        statistics.entry_count          += pass_statistics.entry_count;
+        statistics.culled_entry_count   += pass_statistics.culled_entry_count;
+        statistics.lod_entry_count      += pass_statistics.lod_entry_count;
+        statistics.draw_call_count      += pass_statistics.draw_call_count;
+        statistics.cluster_draw_count   += pass_statistics.cluster_draw_count;
+        statistics.culled_cluster_count += pass_statistics.culled_cluster_count;
     }
 
     end_pass(pass_state, render_encoder);
@@ -307,12 +403,7 @@ void Forward_renderer::render(const Render_parameters& parameters)
     const Light_layer_partition partition = get_light_layer_partition(base);
 
     Shader_key environment_key{};
-    environment_key.set(Shader_int::LIGHT_COUNT_DIRECTIONAL_NOT_SHADOWMAPPED, static_cast<uint32_t>(partition.per_type_nonshadow[0]));
-    environment_key.set(Shader_int::LIGHT_COUNT_DIRECTIONAL_SHADOWMAPPED,     static_cast<uint32_t>(partition.per_type_shadow   [0]));
-    environment_key.set(Shader_int::LIGHT_COUNT_SPOT_NOT_SHADOWMAPPED,        static_cast<uint32_t>(partition.per_type_nonshadow[1]));
-    environment_key.set(Shader_int::LIGHT_COUNT_SPOT_SHADOWMAPPED,            static_cast<uint32_t>(partition.per_type_shadow   [1]));
-    environment_key.set(Shader_int::LIGHT_COUNT_POINT_NOT_SHADOWMAPPED,       static_cast<uint32_t>(partition.per_type_nonshadow[2]));
-    environment_key.set(Shader_int::LIGHT_COUNT_POINT_SHADOWMAPPED,           static_cast<uint32_t>(partition.per_type_shadow   [2]));
+    set_light_count_axes(environment_key, partition, pass_state.clustered_lights);
     environment_key.set(Shader_int::SHADER_DEBUG,                             static_cast<uint32_t>(parameters.shader_debug)); // TODO proper conversion
     environment_key.set(Shader_int::SHADOW_FILTER,                            parameters.shadow_filter);
     environment_key.set(Shader_int::SHADOW_BIAS,                              parameters.shadow_bias);
@@ -538,6 +629,10 @@ void Forward_renderer::draw_primitives(
         m_ddgi_probe_data_texture.get()
     );
 
+    // Fullscreen passes never use the clustered light path.
+    Ring_buffer_range light_cluster_range = m_light_cluster_buffer.update(nullptr, 0);
+    m_light_cluster_buffer.bind(render_encoder, light_cluster_range);
+
     m_texture_heap->bind(render_encoder);
 
     const erhe::graphics::Base_render_pipeline_create_info& pipeline = parameters.base_render_pipeline.data;
@@ -565,6 +660,7 @@ void Forward_renderer::draw_primitives(
 
     material_range.release();
     light_range.release();
+    light_cluster_range.release();
 
     if (light_control_range.has_value()) {
         light_control_range.value().release();
@@ -599,12 +695,7 @@ auto Forward_renderer::prewarm_standard_variants(const Prewarm_parameters& param
             // per-primitive Shader_key::derive sees the same light counts +
             // multiview width the runtime would.
             Shader_key environment_key{};
-            environment_key.set(Shader_int::LIGHT_COUNT_DIRECTIONAL_NOT_SHADOWMAPPED, static_cast<uint32_t>(parameters.light_partition.per_type_nonshadow[0]));
-            environment_key.set(Shader_int::LIGHT_COUNT_DIRECTIONAL_SHADOWMAPPED,     static_cast<uint32_t>(parameters.light_partition.per_type_shadow   [0]));
-            environment_key.set(Shader_int::LIGHT_COUNT_SPOT_NOT_SHADOWMAPPED,        static_cast<uint32_t>(parameters.light_partition.per_type_nonshadow[1]));
-            environment_key.set(Shader_int::LIGHT_COUNT_SPOT_SHADOWMAPPED,            static_cast<uint32_t>(parameters.light_partition.per_type_shadow   [1]));
-            environment_key.set(Shader_int::LIGHT_COUNT_POINT_NOT_SHADOWMAPPED,       static_cast<uint32_t>(parameters.light_partition.per_type_nonshadow[2]));
-            environment_key.set(Shader_int::LIGHT_COUNT_POINT_SHADOWMAPPED,           static_cast<uint32_t>(parameters.light_partition.per_type_shadow   [2]));
+            set_light_count_axes(environment_key, parameters.light_partition, parameters.clustered_lights && m_program_interface.light_cluster_interface.supported && (view_count < 2));
             environment_key.set(Shader_int::SHADER_DEBUG,                             static_cast<uint32_t>(parameters.shader_debug));
             environment_key.set(Shader_int::SHADOW_FILTER,                            parameters.shadow_filter);
             environment_key.set(Shader_int::SHADOW_BIAS,                              parameters.shadow_bias);
@@ -8,6 +8,8 @@
 #include "erhe_scene_renderer/glyph_buffer.hpp"
 #include "erhe_scene_renderer/joint_buffer.hpp"
 #include "erhe_scene_renderer/light_buffer.hpp"
+#include "erhe_scene_renderer/light_cluster_buffer.hpp"
+#include "erhe_scene_renderer/light_clusters.hpp"
 #include "erhe_scene_renderer/material_buffer.hpp"
 #include "erhe_scene_renderer/mesh_memory.hpp"
 #include "erhe_scene_renderer/primitive_buffer.hpp"
@@ -69,6 +71,13 @@ public:
     // Viewport lightmap filtering: bicubic B-spline reconstruction when
     // true (the default), plain bilinear when false.
     void set_lightmap_bicubic(const bool enabled) { m_lightmap_bicubic = enabled; }
+    // Clustered light assignment: single view color passes bin the
+    // non-shadow spot and point lights into view space clusters
+    // (Light_cluster_builder) and shade each fragment with its cluster's
+    // lights only (USE_CLUSTERED_LIGHTS). Ignored without shader storage
+    // buffer support; multiview passes always use the flat light loops.
+    void set_clustered_lights(const bool enabled) { m_clustered_lights = enabled; }
+    void set_light_cluster_settings(const Light_cluster_settings& settings) { m_light_cluster_settings = settings; }
 
     // DDGI probe volume sampled by standard.frag (doc/ddgi-plan.md phase 6).
     // A default-constructed Ddgi_parameters (or null textures) means no
@@ -255,6 +264,12 @@ public:
         // joint slot by Joint_buffer::update(). nullptr = none.
         const erhe::scene::Node*                               debug_target_joint{nullptr};
         const erhe::graphics::Color_blend_state*               color_blend_override{nullptr};
+        // Screen-space error threshold (pixels) of the level of detail
+        // selection, from the first view. 0: always full detail.
+        float                                                  lod_max_pixel_error{0.0f};
+        // Meshlet level culling (frustum and normal cone, from every view)
+        // of entries that have meshlets.
+        bool                                                   cluster_culling{false};
     };
     auto render_draw_lists(const Draw_list_render_parameters& parameters) -> Draw_statistics;
 
@@ -305,6 +320,9 @@ public:
         // Shadow map depth bit count to prewarm (ERHE_SHADOW_DEPTH_BITS axis).
         // Same single-valued, warm-the-active-mode policy as shadow_filter.
         uint32_t                                                    shadow_depth_bits{0};
+        // Clustered light path (USE_CLUSTERED_LIGHTS) for the single view
+        // bucket, as selected by set_clustered_lights().
+        bool                                                        clustered_lights{false};
     };
 
     // Returns the number of Device::warmup_render_pipeline calls issued
@@ -331,6 +349,10 @@ private:
         erhe::graphics::Ring_buffer_range                material_range{};
         erhe::graphics::Ring_buffer_range                joint_range{};
         erhe::graphics::Ring_buffer_range                light_range{};
+        erhe::graphics::Ring_buffer_range                light_cluster_range{};
+        // The clusters were built for this pass; the environment key selects
+        // the clustered light path.
+        bool                                             clustered_lights{false};
     };
     auto begin_pass(
         const Base_render_parameters& base,
@@ -339,6 +361,7 @@ private:
         const erhe::scene::Node*      debug_target_joint
     ) -> Pass_state;
     void end_pass  (Pass_state& state, erhe::graphics::Render_command_encoder& render_encoder);
+    [[nodiscard]] auto use_clustered_lights() const -> bool;
 
     erhe::graphics::Device&                       m_graphics_device;
     Mesh_memory&                                  m_mesh_memory;
@@ -349,6 +372,7 @@ private:
     erhe::scene_renderer::Draw_indirect_buffer    m_draw_indirect_buffer;
     Joint_buffer                                  m_joint_buffer;
     Light_buffer                                  m_light_buffer;
+    Light_cluster_buffer                          m_light_cluster_buffer;
     Material_buffer                               m_material_buffer;
     Primitive_buffer                              m_primitive_buffer;
     erhe::graphics::Sampler                       m_fallback_sampler;
@@ -360,6 +384,13 @@ private:
     std::shared_ptr<erhe::graphics::Texture>      m_ddgi_distance_texture;
     std::shared_ptr<erhe::graphics::Texture>      m_ddgi_probe_data_texture;
     bool                                          m_lightmap_bicubic{true};
+    bool                                          m_clustered_lights{false};
+    Light_cluster_settings                        m_light_cluster_settings{};
+    Light_cluster_builder                         m_light_cluster_builder;
+    Light_clusters                                m_light_clusters;        // begin_pass() scratch
+    std::vector<Light_cluster_light>              m_light_cluster_lights;  // begin_pass() scratch
+    std::vector<Draw_cull_volume>                 m_cull_volumes; // render_draw_lists() scratch
+    std::vector<glm::vec3>                        m_cluster_view_positions; // render_draw_lists() scratch
 };
 
 } // namespace erhe::scene_renderer
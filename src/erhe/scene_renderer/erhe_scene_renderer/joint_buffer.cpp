@@ -5,13 +5,9 @@
 
 #include "erhe_graphics/span.hpp"
 #include "erhe_profile/profile.hpp"
-#include "erhe_scene/node.hpp"
-#include "erhe_scene/skin.hpp"
 #include "erhe_scene_renderer/scene_renderer_log.hpp"
 #include "erhe_verify/verify.hpp"
 
-#include <glm/gtx/matrix_operation.hpp>
-
 namespace erhe::scene_renderer {
 
 Joint_interface::Joint_interface(erhe::graphics::Device& graphics_device, const int max_joint_count)
@@ -55,6 +51,15 @@ Joint_interface::Joint_interface(erhe::graphics::Device& graphics_device, const
         array_size = this->max_joint_count;
     }
     offsets.joint_struct = joint_block.add_struct("joints", &joint_struct, array_size)->get_offset_in_parent();
+
+    palette_cache = Joint_palette_cache{
+        Joint_slot_layout{
+            .slot_size               = joint_struct.get_size_bytes(),
+            .world_from_bind_offset  = offsets.joint.world_from_bind,
+            .normal_transform_offset = offsets.joint.normal_transform,
+            .debug_flags_offset      = offsets.joint.debug_flags
+        }
+    };
 }
 
 Joint_buffer::Joint_buffer(erhe::graphics::Device& graphics_device, Joint_interface& joint_interface)
@@ -80,15 +85,7 @@ auto Joint_buffer::update(
 
     SPDLOG_LOGGER_TRACE(log_render, "skins.size() = {}, m_writer.write_offset = {}", skins.size(), m_writer.write_offset);
 
-    std::size_t joint_count = 0;
-    std::size_t skin_index = 0;
-    for (const std::shared_ptr<erhe::scene::Skin>& skin : skins) {
-        ERHE_VERIFY(skin);
-        ++skin_index;
-
-        const auto& skin_data = skin->skin_data;
-        joint_count += skin_data.joints.size();
-    }
+    const std::size_t joint_count = Joint_palette_cache::get_joint_count(skins);
 
     const auto        entry_size       = m_joint_interface.joint_struct.get_size_bytes();
     const auto&       offsets          = m_joint_interface.offsets;
@@ -137,39 +134,23 @@ auto Joint_buffer::update(
 
     write_offset += offsets.joint_struct;
 
-    uint32_t joint_index = 0;
-    for (auto& skin : skins) {
-        ERHE_VERIFY(skin);
-
-        erhe::scene::Skin_data& skin_data = skin->skin_data;
-        skin_data.joint_buffer_index = joint_index;
-        for (std::size_t i = 0, end_i = skin->skin_data.joints.size(); i < end_i; ++i) {
-            const std::shared_ptr<erhe::scene::Node>& joint = skin->skin_data.joints[i];
-            const glm::mat4 joint_from_bind  = skin->skin_data.inverse_bind_matrices[i];
-            const glm::mat4 world_from_joint = joint->world_from_node();
-            const glm::mat4 world_from_bind  = world_from_joint * joint_from_bind;
-            const glm::mat4 normal_transform = glm::transpose(glm::adjugate(world_from_bind)); // TODO compute shader pass?
-
-            // Weight-display target marker for this slot.
-            const glm::uvec4 debug_flags{
-                ((debug_target_joint != nullptr) && (joint.get() == debug_target_joint)) ? 1u : 0u,
-                0u,
-                0u,
-                0u
-            };
-
-            write(primitive_gpu_data, write_offset + offsets.joint.world_from_bind,  as_span(world_from_bind ));
-            write(primitive_gpu_data, write_offset + offsets.joint.normal_transform, as_span(normal_transform));
-            write(primitive_gpu_data, write_offset + offsets.joint.debug_flags,      as_span(debug_flags     ));
-            write_offset += entry_size;
-            ++joint_index;
-        }
-    }
+    m_joint_interface.palette_cache.write(
+        skins,
+        debug_target_joint,
+        primitive_gpu_data.subspan(write_offset, joint_count * entry_size)
+    );
+    write_offset += joint_count * entry_size;
 
     buffer_range.bytes_written(write_offset);
     buffer_range.close();
 
-    SPDLOG_LOGGER_TRACE(log_draw, "wrote {} entries to joint buffer", joint_index);
+    SPDLOG_LOGGER_TRACE(
+        log_draw,
+        "wrote {} entries to joint buffer, recomputed {} of {} skins",
+        joint_count,
+        m_joint_interface.palette_cache.get_recomputed_skin_count(),
+        m_joint_interface.palette_cache.get_skin_count()
+    );
 
     return buffer_range;
 }
@@ -3,6 +3,7 @@
 #include "erhe_graphics/device.hpp"
 #include "erhe_graphics/ring_buffer_client.hpp"
 #include "erhe_graphics/shader_resource.hpp"
+#include "erhe_scene_renderer/joint_palette.hpp"
 
 #include <glm/glm.hpp>
 
@@ -48,6 +49,10 @@ public:
     erhe::graphics::Shader_resource joint_struct;
     Joint_block                     offsets;
     std::size_t                     max_joint_count{1000};
+
+    // Shared by every Joint_buffer of this interface (forward and shadow
+    // passes), so a skin that moved is recomputed once per frame.
+    Joint_palette_cache             palette_cache;
 };
 
 class Joint_buffer : public erhe::graphics::Ring_buffer_client
@@ -57,7 +62,9 @@ public:
 
     // debug_target_joint: the weight display's active joint, or nullptr.
     // Every slot whose joint Node is this node gets debug_flags.x = 1, in
-    // every skin that uses it.
+    // every skin that uses it. Joint slots come from
+    // Joint_interface::palette_cache: only skins whose joints moved since
+    // the previous update are recomputed.
     auto update(
         const glm::uvec4&                                          debug_joint_indices,
         const std::span<glm::vec4>&                                debug_joint_colors,
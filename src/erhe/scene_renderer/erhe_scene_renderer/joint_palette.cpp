@@ -0,0 +1,205 @@
+#include "erhe_scene_renderer/joint_palette.hpp"
+
+#include "erhe_math/mat4_kernels.hpp"
+#include "erhe_profile/profile.hpp"
+#include "erhe_scene/node.hpp"
+#include "erhe_scene/scene_executor.hpp"
+#include "erhe_scene/skin.hpp"
+#include "erhe_verify/verify.hpp"
+
+#include <glm/glm.hpp>
+
+#include <taskflow/taskflow.hpp>
+#include <taskflow/algorithm/for_each.hpp>
+
+#include <cstring>
+
+namespace erhe::scene_renderer {
+
+Joint_palette_cache::Joint_palette_cache(const Joint_slot_layout& layout)
+    : m_layout{layout}
+{
+    ERHE_VERIFY(m_layout.world_from_bind_offset  + sizeof(glm::mat4)  <= m_layout.slot_size);
+    ERHE_VERIFY(m_layout.normal_transform_offset + sizeof(glm::mat4)  <= m_layout.slot_size);
+    ERHE_VERIFY(m_layout.debug_flags_offset      + sizeof(glm::uvec4) <= m_layout.slot_size);
+}
+
+void Joint_palette_cache::clear()
+{
+    m_cache.clear();
+}
+
+auto Joint_palette_cache::get_joint_count(const std::span<const std::shared_ptr<erhe::scene::Skin>> skins) -> std::size_t
+{
+    std::size_t joint_count = 0;
+    for (const std::shared_ptr<erhe::scene::Skin>& skin : skins) {
+        ERHE_VERIFY(skin);
+        joint_count += skin->skin_data.joints.size();
+    }
+    return joint_count;
+}
+
+auto Joint_palette_cache::refresh(const erhe::scene::Skin& skin, Skin_slots& cached) const -> bool
+{
+    const erhe::scene::Skin_data& skin_data   = skin.skin_data;
+    const std::size_t             joint_count = skin_data.joints.size();
+
+    // Each slot is checked against the joint node and world transform
+    // serial it was computed from: serials are shared by every node one
+    // pose write moves, so only the pair tells that nothing changed. 0 is
+    // "not computed yet" - never trusted.
+    bool unchanged = cached.valid && (cached.joint_keys.size() == joint_count) && (cached.slots.size() == joint_count * m_layout.slot_size);
+    for (std::size_t i = 0; unchanged && (i < joint_count); ++i) {
+        const erhe::scene::Node* const joint  = skin_data.joints[i].get();
+        const std::uint64_t            serial = (joint != nullptr) ? joint->node_data.transforms.world_from_node_serial : 0;
+        const Joint_key&               key    = cached.joint_keys[i];
+        unchanged = (serial != 0) && (key.joint == joint) && (key.serial == serial);
+    }
+    if (unchanged) {
+        return false;
+    }
+
+    // Zero fill also clears the debug flags of every slot.
+    cached.slots.assign(joint_count * m_layout.slot_size, std::byte{0});
+    cached.joint_keys.resize(joint_count);
+    bool unset_serial = false;
+    const glm::mat4 identity{1.0f};
+    for (std::size_t i = 0; i < joint_count; ++i) {
+        const std::shared_ptr<erhe::scene::Node>& joint = skin_data.joints[i];
+        const std::uint64_t serial = joint ? joint->node_data.transforms.world_from_node_serial : 0;
+        unset_serial = unset_serial || (serial == 0);
+        cached.joint_keys[i] = Joint_key{.joint = joint.get(), .serial = serial};
+        const glm::mat4 world_from_joint = joint ? joint->world_from_node() : identity;
+        const glm::mat4& joint_from_bind = (i < skin_data.inverse_bind_matrices.size())
+            ? skin_data.inverse_bind_matrices[i]
+            : identity;
+        std::byte* const slot = cached.slots.data() + i * m_layout.slot_size;
+        erhe::math::mul_with_cofactor(
+            world_from_joint,
+            joint_from_bind,
+            reinterpret_cast<float*>(slot + m_layout.world_from_bind_offset),
+            reinterpret_cast<float*>(slot + m_layout.normal_transform_offset)
+        );
+    }
+    cached.valid = !unset_serial;
+    return true;
+}
+
+void Joint_palette_cache::write_job(
+    const Skin_job&                job,
+    const erhe::scene::Node* const debug_target_joint,
+    const std::span<std::byte>     destination
+) const
+{
+    const std::vector<std::byte>& slots = job.cached->slots;
+    if (slots.empty()) {
+        return;
+    }
+    std::memcpy(destination.data() + job.byte_offset, slots.data(), slots.size());
+
+    if (debug_target_joint == nullptr) {
+        return;
+    }
+    const std::vector<std::shared_ptr<erhe::scene::Node>>& joints = job.skin->skin_data.joints;
+    const glm::uvec4 debug_flags{1u, 0u, 0u, 0u};
+    for (std::size_t i = 0, end = joints.size(); i < end; ++i) {
+        if (joints[i].get() == debug_target_joint) {
+            std::memcpy(
+                destination.data() + job.byte_offset + i * m_layout.slot_size + m_layout.debug_flags_offset,
+                &debug_flags,
+                sizeof(debug_flags)
+            );
+        }
+    }
+}
+
+void Joint_palette_cache::write(
+    const std::span<const std::shared_ptr<erhe::scene::Skin>> skins,
+    const erhe::scene::Node* const                            debug_target_joint,
+    const std::span<std::byte>                                destination
+)
+{
+    ERHE_PROFILE_FUNCTION();
+
+    // Drop the slots of destroyed skins first: after that no key can be the
+    // address of a dead skin that a new skin now reuses.
+    for (auto i = m_cache.begin(); i != m_cache.end();) {
+        if (i->second.skin.expired()) {
+            i = m_cache.erase(i);
+        } else {
+            ++i;
+        }
+    }
+
+    ++m_write_serial;
+    m_jobs.clear();
+    std::size_t byte_offset = 0;
+    uint32_t    joint_index = 0;
+    for (const std::shared_ptr<erhe::scene::Skin>& skin : skins) {
+        ERHE_VERIFY(skin);
+        skin->skin_data.joint_buffer_index = joint_index;
+
+        // unordered_map nodes are stable, so the job can keep a pointer.
+        const auto [i, inserted] = m_cache.try_emplace(skin.get());
+        Skin_slots& cached = i->second;
+        if (inserted) {
+            cached.skin = skin;
+        }
+        const bool duplicate = (cached.write_serial == m_write_serial);
+        cached.write_serial = m_write_serial;
+        m_jobs.push_back(
+            Skin_job{
+                .skin        = skin.get(),
+                .cached      = &cached,
+                .byte_offset = byte_offset,
+                .duplicate   = duplicate
+            }
+        );
+        const std::size_t joint_count = skin->skin_data.joints.size();
+        byte_offset += joint_count * m_layout.slot_size;
+        joint_index += static_cast<uint32_t>(joint_count);
+    }
+    ERHE_VERIFY(byte_offset <= destination.size());
+
+    // Jobs of different skins touch disjoint cache entries and destination
+    // ranges. A skin listed twice is recomputed once, by its first job;
+    // the later copies are written after all first jobs are done.
+    const auto run_job = [this, debug_target_joint, destination](Skin_job& job) {
+        if (job.duplicate) {
+            return;
+        }
+        job.recomputed = refresh(*job.skin, *job.cached);
+        write_job(job, debug_target_joint, destination);
+    };
+    tf::Executor* const executor = erhe::scene::get_executor();
+    if ((executor == nullptr) || (m_jobs.size() < 2) || (joint_index < c_parallel_joint_count)) {
+        for (Skin_job& job : m_jobs) {
+            run_job(job);
+        }
+    } else {
+        tf::Taskflow taskflow;
+        taskflow.for_each_index(
+            std::size_t{0},
+            m_jobs.size(),
+            std::size_t{1},
+            [this, &run_job](const std::size_t i) { run_job(m_jobs[i]); }
+        );
+        if (executor->this_worker_id() >= 0) {
+            executor->corun(taskflow);
+        } else {
+            executor->run(taskflow).wait();
+        }
+    }
+
+    m_skin_count            = m_jobs.size();
+    m_recomputed_skin_count = 0;
+    for (const Skin_job& job : m_jobs) {
+        if (job.duplicate) {
+            write_job(job, debug_target_joint, destination);
+        } else if (job.recomputed) {
+            ++m_recomputed_skin_count;
+        }
+    }
+}
+
+} // namespace erhe::scene_renderer
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace erhe::scene { class Node; class Skin; }
+
+namespace erhe::scene_renderer {
+
+// Byte layout of one joint slot of the joint block (Joint_interface::offsets
+// and joint_struct size).
+class Joint_slot_layout
+{
+public:
+    std::size_t slot_size              {0};
+    std::size_t world_from_bind_offset {0}; // mat4
+    std::size_t normal_transform_offset{0}; // mat4
+    std::size_t debug_flags_offset     {0}; // uvec4
+};
+
+// CPU side of Joint_buffer: per skin, a copy of the skin's joint slots as
+// they are laid out in the joint block (world_from_bind, its cofactor normal
+// transform, zero debug flags). No graphics dependency.
+//
+// A skin's slots are recomputed only when one of its joints is a different
+// node or has a different world transform serial
+// (Node_transforms::world_from_node_serial) than at the previous write, or
+// an unset one; a skeleton that did not move is a plain copy of its cached
+// slots. Recomputation uses
+// erhe::math::mul_with_cofactor() and runs one task per skin on
+// erhe::scene::get_executor() when one is set. Every task writes its skin's
+// range of the destination directly.
+//
+// Cached slots are dropped when their skin is destroyed. Edits to
+// Skin_data::inverse_bind_matrices are not tracked; call clear() after
+// making one.
+class Joint_palette_cache
+{
+public:
+    // Below this many joints in one write() the skins are done on the
+    // calling thread.
+    static constexpr std::size_t c_parallel_joint_count = 512;
+
+    Joint_palette_cache() = default;
+    explicit Joint_palette_cache(const Joint_slot_layout& layout);
+
+    // Writes the slots of skins back to back into destination, which must
+    // hold at least get_joint_count(skins) slots, and sets every skin's
+    // Skin_data::joint_buffer_index to its first slot. Slots whose joint
+    // node is debug_target_joint get debug_flags.x = 1.
+    void write(
+        std::span<const std::shared_ptr<erhe::scene::Skin>> skins,
+        const erhe::scene::Node*                            debug_target_joint,
+        std::span<std::byte>                                destination
+    );
+
+    void clear();
+
+    [[nodiscard]] static auto get_joint_count(std::span<const std::shared_ptr<erhe::scene::Skin>> skins) -> std::size_t;
+
+    // Statistics of the last write()
+    [[nodiscard]] auto get_skin_count          () const -> std::size_t { return m_skin_count; }
+    [[nodiscard]] auto get_recomputed_skin_count() const -> std::size_t { return m_recomputed_skin_count; }
+
+private:
+    // What the slot of one joint was computed from
+    class Joint_key
+    {
+    public:
+        const erhe::scene::Node* joint {nullptr};
+        std::uint64_t            serial{0};
+    };
+
+    class Skin_slots
+    {
+    public:
+        std::weak_ptr<erhe::scene::Skin> skin;
+        std::vector<Joint_key>           joint_keys;
+        std::uint64_t                    write_serial{0}; // last write() that listed the skin
+        bool                             valid       {false};
+        std::vector<std::byte>           slots;
+    };
+
+    class Skin_job
+    {
+    public:
+        const erhe::scene::Skin* skin       {nullptr};
+        Skin_slots*              cached     {nullptr};
+        std::size_t              byte_offset{0};
+        bool                     duplicate  {false}; // skin listed earlier in the same write()
+        bool                     recomputed {false};
+    };
+
+    [[nodiscard]] auto refresh(const erhe::scene::Skin& skin, Skin_slots& cached) const -> bool;
+    void write_job(
+        const Skin_job&          job,
+        const erhe::scene::Node* debug_target_joint,
+        std::span<std::byte>     destination
+    ) const;
+
+    Joint_slot_layout                                           m_layout;
+    std::unordered_map<const erhe::scene::Skin*, Skin_slots>    m_cache;
+    std::vector<Skin_job>                                       m_jobs;
+    std::uint64_t                                               m_write_serial         {0};
+    std::size_t                                                 m_skin_count           {0};
+    std::size_t                                                 m_recomputed_skin_count{0};
+};
+
+} // namespace erhe::scene_renderer
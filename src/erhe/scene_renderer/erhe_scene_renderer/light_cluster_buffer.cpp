@@ -0,0 +1,170 @@
+#include "erhe_scene_renderer/light_cluster_buffer.hpp"
+#include "erhe_scene_renderer/buffer_binding_points.hpp"
+#include "erhe_scene_renderer/camera_buffer.hpp"
+#include "erhe_scene_renderer/light_buffer.hpp"
+
+#include "erhe_graphics/device.hpp"
+#include "erhe_graphics/span.hpp"
+#include "erhe_profile/profile.hpp"
+#include "erhe_scene/light.hpp"
+#include "erhe_scene/node.hpp"
+#include "erhe_scene/projection.hpp"
+#include "erhe_verify/verify.hpp"
+
+#include <algorithm>
+
+namespace erhe::scene_renderer {
+
+Light_cluster_interface::Light_cluster_interface(erhe::graphics::Device& graphics_device)
+    : supported{graphics_device.get_info().use_shader_storage_buffers}
+    , light_cluster_block{
+        graphics_device,
+        {
+            .name          = "light_cluster",
+            .binding_point = light_cluster_buffer_binding_point,
+            .type          = supported
+                ? erhe::graphics::Shader_resource::Type::shader_storage_block
+                : erhe::graphics::Shader_resource::Type::uniform_block,
+            .readonly      = true
+        }
+    }
+{
+    offsets.grid            = light_cluster_block.add_uvec4("grid"           )->get_offset_in_parent();
+    offsets.depth_plane     = light_cluster_block.add_vec4 ("depth_plane"    )->get_offset_in_parent();
+    offsets.slice_params    = light_cluster_block.add_vec4 ("slice_params"   )->get_offset_in_parent();
+    offsets.clip_from_world = light_cluster_block.add_mat4 ("clip_from_world")->get_offset_in_parent();
+
+    // The data array must be the last member: it is unsized in the SSBO
+    // case. The dummy uniform block fallback gets one element; it is never
+    // read because the clustered path is not selected without SSBOs.
+    offsets.data = light_cluster_block.add_uint(
+        "data",
+        supported ? erhe::graphics::Shader_resource::unsized_array : std::size_t{1}
+    )->get_offset_in_parent();
+
+    // uint array stride: 4 in std430, 16 in std140 (SSBOs below GLSL 4.30).
+    data_stride = (graphics_device.get_info().glsl_version >= 430) ? std::size_t{4} : std::size_t{16};
+}
+
+Light_cluster_buffer::Light_cluster_buffer(erhe::graphics::Device& graphics_device, Light_cluster_interface& light_cluster_interface)
+    : Ring_buffer_client{
+        graphics_device,
+        light_cluster_interface.light_cluster_block.get_binding_target(),
+        "Light_cluster_buffer",
+        light_cluster_interface.light_cluster_block.get_binding_point()
+    }
+    , m_light_cluster_interface{light_cluster_interface}
+{
+}
+
+auto Light_cluster_buffer::update(const Light_clusters* clusters, const uint32_t spot_light_count) -> erhe::graphics::Ring_buffer_range
+{
+    ERHE_PROFILE_FUNCTION();
+
+    const Light_cluster_block& offsets = m_light_cluster_interface.offsets;
+    const std::size_t stride        = m_light_cluster_interface.data_stride;
+    const std::size_t cluster_count = (clusters != nullptr) ? clusters->get_cluster_count() : 0;
+    const std::size_t index_count   = (clusters != nullptr) ? clusters->light_indices.size() : 0;
+    const std::size_t data_count    = 2 * cluster_count + index_count;
+
+    // At least the block's reported size (one data element), see Joint_buffer::update().
+    const std::size_t exact_byte_count   = offsets.data + data_count * stride;
+    const std::size_t acquire_byte_count = std::max(exact_byte_count, m_light_cluster_interface.light_cluster_block.get_size_bytes());
+
+    erhe::graphics::Ring_buffer_range buffer_range = acquire(erhe::graphics::Ring_buffer_usage::CPU_write, acquire_byte_count);
+    std::span<std::byte>              gpu_data     = buffer_range.get_span();
+
+    using erhe::graphics::as_span;
+    using erhe::graphics::write;
+
+    if (clusters == nullptr) {
+        const glm::uvec4 grid{0u, 0u, 0u, 0u};
+        write(gpu_data, offsets.grid, as_span(grid));
+        buffer_range.bytes_written(acquire_byte_count);
+        buffer_range.close();
+        return buffer_range;
+    }
+
+    const glm::uvec4 grid{clusters->tile_count_x, clusters->tile_count_y, clusters->slice_count, spot_light_count};
+    const glm::vec4  slice_params{clusters->z_near, clusters->slice_scale, clusters->slice_bias, 0.0f};
+    write(gpu_data, offsets.grid,            as_span(grid));
+    write(gpu_data, offsets.depth_plane,     as_span(clusters->depth_plane));
+    write(gpu_data, offsets.slice_params,    as_span(slice_params));
+    write(gpu_data, offsets.clip_from_world, as_span(clusters->clip_from_world));
+
+    // Cluster ranges index data[] directly: offsets move past the ranges.
+    std::size_t    write_offset = offsets.data;
+    const uint32_t index_base   = static_cast<uint32_t>(2 * cluster_count);
+    for (const glm::uvec2& range : clusters->cluster_ranges) {
+        const uint32_t offset = index_base + range.x;
+        write(gpu_data, write_offset,          as_span(offset));
+        write(gpu_data, write_offset + stride, as_span(range.y));
+        write_offset += 2 * stride;
+    }
+    if (stride == sizeof(uint32_t)) {
+        write(gpu_data, write_offset, std::span<const uint32_t>{clusters->light_indices});
+        write_offset += index_count * stride;
+    } else {
+        for (const uint32_t light_index : clusters->light_indices) {
+            write(gpu_data, write_offset, as_span(light_index));
+            write_offset += stride;
+        }
+    }
+
+    buffer_range.bytes_written(std::max(write_offset, acquire_byte_count));
+    buffer_range.close();
+    return buffer_range;
+}
+
+auto make_light_cluster_view(
+    const Camera_view_input&                  view,
+    const bool                                reverse_depth,
+    const erhe::math::Depth_range             depth_range,
+    const erhe::math::Coordinate_conventions& conventions,
+    Light_cluster_view&                       out
+) -> bool
+{
+    if ((view.projection == nullptr) || (view.node == nullptr)) {
+        return false;
+    }
+    out.view_from_world = view.node->node_from_world();
+    out.clip_from_view  = view.projection->clip_from_node_transform(view.viewport, reverse_depth, depth_range, conventions).get_matrix();
+    out.z_near          = view.projection->z_near;
+    out.z_far           = view.projection->z_far;
+    return (out.z_near > 0.0f) && (out.z_far > out.z_near);
+}
+
+auto collect_cluster_lights(
+    const Light_projections&          light_projections,
+    const std::size_t                 max_light_count,
+    std::vector<Light_cluster_light>& out
+) -> uint32_t
+{
+    out.clear();
+    uint32_t spot_light_count = 0;
+    const std::size_t light_count = std::min(light_projections.light_projection_transforms.size(), max_light_count);
+    for (std::size_t slot = 0; slot < light_count; ++slot) {
+        const erhe::scene::Light_projection_transforms& transforms = light_projections.light_projection_transforms[slot];
+        const erhe::scene::Light* const light = transforms.light;
+        ERHE_VERIFY(light != nullptr);
+        if (transforms.is_shadow_mapped() || (light->type == erhe::scene::Light_type::directional)) {
+            continue;
+        }
+        const bool is_spot = (light->type == erhe::scene::Light_type::spot);
+        if (is_spot) {
+            ++spot_light_count;
+        }
+        // Same position as Light_buffer::update() writes.
+        out.push_back(
+            Light_cluster_light{
+                .position_in_world = glm::vec3{transforms.world_from_light_camera.get_matrix() * glm::vec4{0.0f, 0.0f, 0.0f, 1.0f}},
+                .range             = light->range,
+                .light_index       = static_cast<uint32_t>(slot),
+                .is_spot           = is_spot
+            }
+        );
+    }
+    return spot_light_count;
+}
+
+} // namespace erhe::scene_renderer
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "erhe_graphics/ring_buffer_client.hpp"
+#include "erhe_graphics/shader_resource.hpp"
+#include "erhe_scene_renderer/light_clusters.hpp"
+
+#include <vector>
+
+namespace erhe::graphics {
+    class Device;
+}
+
+namespace erhe::scene_renderer {
+
+class Camera_view_input;
+class Light_projections;
+
+class Light_cluster_block
+{
+public:
+    std::size_t grid;            // uvec4 tile_count_x, tile_count_y, slice_count, spot light count
+    std::size_t depth_plane;     // vec4
+    std::size_t slice_params;    // vec4 z_near, slice_scale, slice_bias, unused
+    std::size_t clip_from_world; // mat4
+    std::size_t data;            // uint[] per cluster (offset, count), then light indices
+};
+
+// Shader interface of the clustered light path (Shader_bool::
+// USE_CLUSTERED_LIGHTS). The "light_cluster" block holds the cluster grid
+// parameters and the per cluster light index lists of Light_clusters.
+//
+// The unsized index array needs shader storage buffers. Without them the
+// block falls back to a dummy uniform block so the shared bind group layout
+// stays uniform, `supported` is false and Forward_renderer never selects
+// the clustered path.
+class Light_cluster_interface
+{
+public:
+    explicit Light_cluster_interface(erhe::graphics::Device& graphics_device);
+
+    bool                            supported{false};
+    erhe::graphics::Shader_resource light_cluster_block;
+    Light_cluster_block             offsets;
+    std::size_t                     data_stride{4};
+};
+
+class Light_cluster_buffer : public erhe::graphics::Ring_buffer_client
+{
+public:
+    Light_cluster_buffer(erhe::graphics::Device& graphics_device, Light_cluster_interface& light_cluster_interface);
+
+    // spot_light_count: the non-shadow spot light slots, which the
+    // clustered shader path skips in the flat light loops. clusters ==
+    // nullptr writes an empty grid (passes that do not use the clustered
+    // path still bind the block).
+    auto update(const Light_clusters* clusters, uint32_t spot_light_count) -> erhe::graphics::Ring_buffer_range;
+
+private:
+    Light_cluster_interface& m_light_cluster_interface;
+};
+
+// The camera of a single view pass, with the same projection as
+// Camera_buffer::update(). Returns false when the view has no projection
+// or node.
+[[nodiscard]] auto make_light_cluster_view(
+    const Camera_view_input&                  view,
+    bool                                      reverse_depth,
+    erhe::math::Depth_range                   depth_range,
+    const erhe::math::Coordinate_conventions& conventions,
+    Light_cluster_view&                       out
+) -> bool;
+
+// The lights the clustered path shades: non-shadow spot and point light
+// slots of light_projections, below max_light_count (Light_buffer writes no
+// more). Shadow-mapped and directional lights stay in the flat loops.
+// Returns the number of non-shadow spot slots.
+auto collect_cluster_lights(
+    const Light_projections&          light_projections,
+    std::size_t                       max_light_count,
+    std::vector<Light_cluster_light>& out
+) -> uint32_t;
+
+} // namespace erhe::scene_renderer
@@ -0,0 +1,256 @@
+#include "erhe_scene_renderer/light_clusters.hpp"
+#include "erhe_profile/profile.hpp"
+#include "erhe_verify/verify.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace erhe::scene_renderer {
+
+namespace {
+
+// Slice k starts at view depth z_near * (z_far / z_near)^(k / slice_count).
+[[nodiscard]] auto get_slice_depth(const float z_near, const float z_far, const uint32_t slice, const uint32_t slice_count) -> float
+{
+    return z_near * std::pow(z_far / z_near, static_cast<float>(slice) / static_cast<float>(slice_count));
+}
+
+// Point of the line a -> b at view depth (z = -view_depth).
+[[nodiscard]] auto intersect_depth(const glm::vec3& a, const glm::vec3& b, const float view_depth) -> glm::vec3
+{
+    const float t = (-view_depth - a.z) / (b.z - a.z);
+    return a + t * (b - a);
+}
+
+[[nodiscard]] auto unproject(const glm::mat4& view_from_clip, const float x, const float y, const float z) -> glm::vec3
+{
+    const glm::vec4 p = view_from_clip * glm::vec4{x, y, z, 1.0f};
+    return glm::vec3{p} / p.w;
+}
+
+[[nodiscard]] auto clamp_index(const float value, const uint32_t count) -> uint32_t
+{
+    if (!(value > 0.0f)) { // also NaN
+        return 0;
+    }
+    return std::min(static_cast<uint32_t>(value), count - 1);
+}
+
+} // anonymous namespace
+
+auto Light_clusters::get_cluster_index(const uint32_t tile_x, const uint32_t tile_y, const uint32_t slice) const -> uint32_t
+{
+    return (slice * tile_count_y + tile_y) * tile_count_x + tile_x;
+}
+
+auto Light_clusters::get_cluster_lights(const uint32_t cluster_index) const -> std::span<const uint32_t>
+{
+    const glm::uvec2 range = cluster_ranges.at(cluster_index);
+    return std::span<const uint32_t>{light_indices}.subspan(range.x, range.y);
+}
+
+auto Light_clusters::find_cluster(const glm::vec3& position_in_world) const -> uint32_t
+{
+    const glm::vec4 p{position_in_world, 1.0f};
+    const glm::vec4 clip       = clip_from_world * p;
+    const glm::vec2 ndc        = glm::vec2{clip} / clip.w;
+    const float     view_depth = std::max(glm::dot(depth_plane, p), z_near);
+    const uint32_t  tile_x     = clamp_index(std::floor((ndc.x * 0.5f + 0.5f) * static_cast<float>(tile_count_x)), tile_count_x);
+    const uint32_t  tile_y     = clamp_index(std::floor((ndc.y * 0.5f + 0.5f) * static_cast<float>(tile_count_y)), tile_count_y);
+    const uint32_t  slice      = clamp_index(std::floor(std::log(view_depth) * slice_scale + slice_bias), slice_count);
+    return get_cluster_index(tile_x, tile_y, slice);
+}
+
+void make_single_light_cluster(const std::span<const Light_cluster_light> lights, Light_clusters& out)
+{
+    out.tile_count_x    = 1;
+    out.tile_count_y    = 1;
+    out.slice_count     = 1;
+    // log(max(view_depth, 1)) * 0 + 0 = slice 0 for any depth_plane
+    out.z_near          = 1.0f;
+    out.slice_scale     = 0.0f;
+    out.slice_bias      = 0.0f;
+    out.depth_plane     = glm::vec4{0.0f};
+    out.clip_from_world = glm::mat4{1.0f};
+    out.cluster_ranges.assign(1, glm::uvec2{0u, static_cast<uint32_t>(lights.size())});
+    out.light_indices.resize(lights.size());
+    for (std::size_t i = 0, end = lights.size(); i < end; ++i) {
+        out.light_indices[i] = lights[i].light_index | (lights[i].is_spot ? Light_clusters::spot_light_bit : 0u);
+    }
+}
+
+void Light_cluster_builder::update_cluster_bounds(const Light_cluster_view& view, const Light_cluster_settings& settings)
+{
+    if (
+        (view.clip_from_view      == m_clip_from_view) &&
+        (view.z_near              == m_z_near        ) &&
+        (view.z_far               == m_z_far         ) &&
+        (settings.tile_count_x    == m_settings.tile_count_x) &&
+        (settings.tile_count_y    == m_settings.tile_count_y) &&
+        (settings.slice_count     == m_settings.slice_count )
+    ) {
+        return;
+    }
+
+    ERHE_PROFILE_FUNCTION();
+
+    m_clip_from_view = view.clip_from_view;
+    m_z_near         = view.z_near;
+    m_z_far          = view.z_far;
+    m_settings       = settings;
+    const float log_depth_ratio = std::log(view.z_far / view.z_near);
+    m_slice_scale = static_cast<float>(settings.slice_count) / log_depth_ratio;
+    m_slice_bias  = -static_cast<float>(settings.slice_count) * std::log(view.z_near) / log_depth_ratio;
+
+    const uint32_t X = settings.tile_count_x;
+    const uint32_t Y = settings.tile_count_y;
+    const uint32_t Z = settings.slice_count;
+    m_cluster_min.resize(static_cast<std::size_t>(X) * Y * Z);
+    m_cluster_max.resize(static_cast<std::size_t>(X) * Y * Z);
+    m_column_x   .assign(static_cast<std::size_t>(X) * Z, glm::vec2{std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest()});
+    m_row_y      .assign(static_cast<std::size_t>(Y) * Z, glm::vec2{std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest()});
+
+    // Each tile corner is a line in view space (through the eye for
+    // perspective, parallel to -Z for orthographic). Two points on it at
+    // NDC depths inside every depth range convention, finite also for
+    // infinite far planes, define it.
+    const glm::mat4 view_from_clip = glm::inverse(view.clip_from_view);
+    std::vector<glm::vec3> line_a((X + 1) * (Y + 1));
+    std::vector<glm::vec3> line_b((X + 1) * (Y + 1));
+    for (uint32_t y = 0; y <= Y; ++y) {
+        const float ndc_y = -1.0f + 2.0f * static_cast<float>(y) / static_cast<float>(Y);
+        for (uint32_t x = 0; x <= X; ++x) {
+            const float ndc_x = -1.0f + 2.0f * static_cast<float>(x) / static_cast<float>(X);
+            line_a[y * (X + 1) + x] = unproject(view_from_clip, ndc_x, ndc_y, 0.25f);
+            line_b[y * (X + 1) + x] = unproject(view_from_clip, ndc_x, ndc_y, 0.75f);
+        }
+    }
+
+    for (uint32_t z = 0; z < Z; ++z) {
+        const float depth_near = get_slice_depth(view.z_near, view.z_far, z,     Z);
+        const float depth_far  = get_slice_depth(view.z_near, view.z_far, z + 1, Z);
+        for (uint32_t y = 0; y < Y; ++y) {
+            for (uint32_t x = 0; x < X; ++x) {
+                glm::vec3 min_corner{std::numeric_limits<float>::max()};
+                glm::vec3 max_corner{std::numeric_limits<float>::lowest()};
+                for (uint32_t corner = 0; corner < 4; ++corner) {
+                    const uint32_t line = (y + (corner >> 1u)) * (X + 1) + (x + (corner & 1u));
+                    for (const float depth : {depth_near, depth_far}) {
+                        const glm::vec3 p = intersect_depth(line_a[line], line_b[line], depth);
+                        min_corner = glm::min(min_corner, p);
+                        max_corner = glm::max(max_corner, p);
+                    }
+                }
+                const std::size_t cluster = (static_cast<std::size_t>(z) * Y + y) * X + x;
+                m_cluster_min[cluster] = min_corner;
+                m_cluster_max[cluster] = max_corner;
+                glm::vec2& column = m_column_x[z * X + x];
+                glm::vec2& row    = m_row_y   [z * Y + y];
+                column = glm::vec2{std::min(column.x, min_corner.x), std::max(column.y, max_corner.x)};
+                row    = glm::vec2{std::min(row.x,    min_corner.y), std::max(row.y,    max_corner.y)};
+            }
+        }
+    }
+}
+
+auto Light_cluster_builder::get_slice(const float view_depth) const -> uint32_t
+{
+    return clamp_index(std::floor(std::log(view_depth) * m_slice_scale + m_slice_bias), m_settings.slice_count);
+}
+
+void Light_cluster_builder::add_light(const uint32_t light, const glm::vec3& center, const float radius)
+{
+    const uint32_t X = m_settings.tile_count_x;
+    const uint32_t Y = m_settings.tile_count_y;
+    const float    view_depth = -center.z;
+    if ((view_depth + radius < m_z_near) || (view_depth - radius > m_z_far)) {
+        return;
+    }
+    const uint32_t first_slice = get_slice(std::max(view_depth - radius, m_z_near));
+    const uint32_t last_slice  = get_slice(std::min(view_depth + radius, m_z_far));
+    const float    radius2     = radius * radius;
+    for (uint32_t z = first_slice; z <= last_slice; ++z) {
+        for (uint32_t y = 0; y < Y; ++y) {
+            const glm::vec2 row = m_row_y[z * Y + y];
+            if ((row.x > center.y + radius) || (row.y < center.y - radius)) {
+                continue;
+            }
+            for (uint32_t x = 0; x < X; ++x) {
+                const glm::vec2 column = m_column_x[z * X + x];
+                if ((column.x > center.x + radius) || (column.y < center.x - radius)) {
+                    continue;
+                }
+                const uint32_t  cluster = (z * Y + y) * X + x;
+                const glm::vec3 closest = glm::clamp(center, m_cluster_min[cluster], m_cluster_max[cluster]);
+                const glm::vec3 d       = closest - center;
+                if (glm::dot(d, d) <= radius2) {
+                    m_hit_clusters.push_back(cluster);
+                    m_hit_lights  .push_back(light);
+                }
+            }
+        }
+    }
+}
+
+void Light_cluster_builder::build(
+    const Light_cluster_view&            view,
+    std::span<const Light_cluster_light> lights,
+    const Light_cluster_settings&        settings,
+    Light_clusters&                      out
+)
+{
+    ERHE_PROFILE_FUNCTION();
+
+    ERHE_VERIFY((settings.tile_count_x > 0) && (settings.tile_count_y > 0) && (settings.slice_count > 0));
+    ERHE_VERIFY((view.z_near > 0.0f) && (view.z_far > view.z_near));
+
+    update_cluster_bounds(view, settings);
+
+    out.tile_count_x    = settings.tile_count_x;
+    out.tile_count_y    = settings.tile_count_y;
+    out.slice_count     = settings.slice_count;
+    out.z_near          = view.z_near;
+    out.slice_scale     = m_slice_scale;
+    out.slice_bias      = m_slice_bias;
+    out.depth_plane     = -glm::vec4{view.view_from_world[0][2], view.view_from_world[1][2], view.view_from_world[2][2], view.view_from_world[3][2]};
+    out.clip_from_world = view.clip_from_view * view.view_from_world;
+
+    const uint32_t cluster_count = out.get_cluster_count();
+    m_hit_clusters.clear();
+    m_hit_lights  .clear();
+    for (uint32_t light = 0, end = static_cast<uint32_t>(lights.size()); light < end; ++light) {
+        const Light_cluster_light& cluster_light = lights[light];
+        if (cluster_light.range <= 0.0f) {
+            for (uint32_t cluster = 0; cluster < cluster_count; ++cluster) {
+                m_hit_clusters.push_back(cluster);
+                m_hit_lights  .push_back(light);
+            }
+            continue;
+        }
+        const glm::vec3 center{view.view_from_world * glm::vec4{cluster_light.position_in_world, 1.0f}};
+        add_light(light, center, cluster_light.range);
+    }
+
+    // Count, prefix sum, scatter. Hits are in light order, so each
+    // cluster's list is too.
+    out.cluster_ranges.assign(cluster_count, glm::uvec2{0u, 0u});
+    for (const uint32_t cluster : m_hit_clusters) {
+        ++out.cluster_ranges[cluster].y;
+    }
+    uint32_t offset = 0;
+    for (glm::uvec2& range : out.cluster_ranges) {
+        range.x = offset;
+        offset += range.y;
+        range.y = 0;
+    }
+    out.light_indices.resize(m_hit_clusters.size());
+    for (std::size_t i = 0, end = m_hit_clusters.size(); i < end; ++i) {
+        glm::uvec2&                range         = out.cluster_ranges[m_hit_clusters[i]];
+        const Light_cluster_light& cluster_light = lights[m_hit_lights[i]];
+        out.light_indices[range.x + range.y] = cluster_light.light_index | (cluster_light.is_spot ? Light_clusters::spot_light_bit : 0u);
+        ++range.y;
+    }
+}
+
+} // namespace erhe::scene_renderer
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace erhe::scene_renderer {
+
+class Light_cluster_settings
+{
+public:
+    // Screen tiles (NDC is split evenly) and view depth slices (exponential
+    // between z_near and z_far) of the cluster grid.
+    uint32_t tile_count_x{16};
+    uint32_t tile_count_y{9};
+    uint32_t slice_count {24};
+};
+
+// The camera the clusters are built for. View space is the camera node
+// space: the camera looks along -Z and view depth is -z. clip_from_view is
+// the same projection the pass renders with (any depth range, reverse
+// depth, orthographic or perspective).
+class Light_cluster_view
+{
+public:
+    glm::mat4 view_from_world{1.0f};
+    glm::mat4 clip_from_view {1.0f};
+    float     z_near         {0.03f};
+    float     z_far          {64.0f};
+};
+
+// One light to bin: its light UBO slot and bounding sphere.
+class Light_cluster_light
+{
+public:
+    glm::vec3 position_in_world{0.0f};
+    float     range            {0.0f}; // <= 0: unbounded, binned into every cluster
+    uint32_t  light_index      {0};
+    bool      is_spot          {false};
+};
+
+// Result of Light_cluster_builder::build(): per cluster light index lists,
+// plus the parameters the shader needs to find a fragment's cluster.
+class Light_clusters
+{
+public:
+    // Set in light_indices entries of spot lights; the rest is the slot.
+    static constexpr uint32_t spot_light_bit = 0x80000000u;
+
+    [[nodiscard]] auto get_cluster_count() const -> uint32_t { return tile_count_x * tile_count_y * slice_count; }
+    [[nodiscard]] auto get_cluster_index(uint32_t tile_x, uint32_t tile_y, uint32_t slice) const -> uint32_t;
+    [[nodiscard]] auto get_cluster_lights(uint32_t cluster_index) const -> std::span<const uint32_t>;
+
+    // Cluster of a world space position, computed the same way as the
+    // clustered path in standard.frag. Positions outside the view volume
+    // clamp to the nearest cluster.
+    [[nodiscard]] auto find_cluster(const glm::vec3& position_in_world) const -> uint32_t;
+
+    uint32_t                tile_count_x   {0};
+    uint32_t                tile_count_y   {0};
+    uint32_t                slice_count    {0};
+    float                   z_near         {0.0f};
+    // slice = floor(log(view_depth) * slice_scale + slice_bias)
+    float                   slice_scale    {0.0f};
+    float                   slice_bias     {0.0f};
+    // view_depth = dot(depth_plane, vec4(position_in_world, 1.0))
+    glm::vec4               depth_plane    {0.0f};
+    glm::mat4               clip_from_world{1.0f};
+    // Per cluster (offset, count) into light_indices. Cluster index is
+    // (slice * tile_count_y + tile_y) * tile_count_x + tile_x.
+    std::vector<glm::uvec2> cluster_ranges;
+    std::vector<uint32_t>   light_indices;
+};
+
+// A 1 x 1 x 1 grid whose only cluster lists every light, in light order.
+// Every fragment finds that cluster, so the clustered shader path shades
+// the same lights as the flat loops. Bound when the pass has no usable
+// cluster view (no projection, z_near <= 0), so that whether a draw uses
+// the clustered variant never depends on the camera.
+void make_single_light_cluster(std::span<const Light_cluster_light> lights, Light_clusters& out);
+
+// CPU light binning. Lights are bounding spheres (range); a light goes to
+// every cluster whose view space bounding box the sphere touches. Lights
+// that end before z_near or start beyond z_far are dropped; fragments beyond
+// z_far use the last slice. Cluster bounds depend only on the projection
+// and settings and are kept between builds until either changes.
+class Light_cluster_builder
+{
+public:
+    void build(
+        const Light_cluster_view&                view,
+        std::span<const Light_cluster_light>     lights,
+        const Light_cluster_settings&            settings,
+        Light_clusters&                          out
+    );
+
+private:
+    void update_cluster_bounds(const Light_cluster_view& view, const Light_cluster_settings& settings);
+    void add_light(uint32_t light, const glm::vec3& center, float radius);
+    [[nodiscard]] auto get_slice(float view_depth) const -> uint32_t;
+
+    glm::mat4              m_clip_from_view{0.0f};
+    float                  m_z_near        {0.0f};
+    float                  m_z_far         {0.0f};
+    Light_cluster_settings m_settings      {0, 0, 0};
+    float                  m_slice_scale   {0.0f};
+    float                  m_slice_bias    {0.0f};
+
+    // View space bounding boxes, cluster index order.
+    std::vector<glm::vec3> m_cluster_min;
+    std::vector<glm::vec3> m_cluster_max;
+    // Per slice x extent of each tile column and y extent of each tile row;
+    // narrows the clusters a light is tested against.
+    std::vector<glm::vec2> m_column_x;
+    std::vector<glm::vec2> m_row_y;
+
+    // (cluster, light) pairs of the current build, light order.
+    std::vector<uint32_t>  m_hit_clusters;
+    std::vector<uint32_t>  m_hit_lights;
+};
+
+} // namespace erhe::scene_renderer
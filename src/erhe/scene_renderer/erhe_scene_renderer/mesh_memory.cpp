@@ -15,12 +15,16 @@
 #include "erhe_verify/verify.hpp"
 
 #include <algorithm>
+#include <cstring>
 
 namespace erhe::scene_renderer {
 
 using Format                 = erhe::dataformat::Format;
 using Vertex_attribute_usage = erhe::dataformat::Vertex_attribute_usage;
 
+constexpr std::size_t kilo = 1024;
+constexpr std::size_t mega = 1024 * kilo;
+
 Mesh_memory::Mesh_memory(
     const Mesh_memory_config& mesh_memory_config,
     erhe::graphics::Device&   graphics_device
@@ -192,8 +196,8 @@ Mesh_memory::Mesh_memory(
     }
     , m_mesh_memory_config   {mesh_memory_config}
     , m_graphics_device      {graphics_device}
-    , m_buffer_transfer_queue{graphics_device}
-    , m_loader_transfer_queue{graphics_device}
+    , m_buffer_transfer_queue{graphics_device, static_cast<std::size_t>(std::max(mesh_memory_config.transfer_staging_size_mb, 0)) * mega}
+    , m_loader_transfer_queue{graphics_device, static_cast<std::size_t>(std::max(mesh_memory_config.transfer_staging_size_mb, 0)) * mega}
     , m_loader_sink          {*this}
     , m_alive_token          {std::make_shared<int>(0)}
 {
@@ -208,9 +212,6 @@ Mesh_memory::Mesh_memory(
 
 Mesh_memory::~Mesh_memory() noexcept = default;
 
-constexpr std::size_t kilo = 1024;
-constexpr std::size_t mega = 1024 * kilo;
-
 // Pool selection rule: one Buffer_pool per Vertex_stream INSTANCE address
 // (NOT per Vertex_stream byte layout). The Vertex_format objects whose
 // streams we pass here -- vertex_format_skinned, vertex_format_not_skinned,
@@ -353,26 +354,16 @@ void Mesh_memory::enqueue_vertex_data(const erhe::primitive::Buffer_range& buffe
     enqueue_vertex_data_to(m_buffer_transfer_queue, buffer_range, std::move(data));
 }
 
-void Mesh_memory::vertex_writer_ready_to(
-    erhe::graphics::Buffer_transfer_queue& queue,
-    erhe::primitive::Vertex_buffer_writer& writer
-)
+auto Mesh_memory::begin_vertex_write(const erhe::primitive::Buffer_range& buffer_range, const std::size_t byte_count) -> erhe::primitive::Buffer_sink_write
 {
-    log_mesh_memory->trace(
-        "Vertex buffer writer ready for pool_id = {}, buffer_id = {}, byte_offset = {}, byte_count = {}",
-        writer.buffer_range.pool_id,
-        writer.buffer_range.buffer_id,
-        writer.start_offset(),
-        writer.vertex_data.size()
-    );
-    const Buffer_pool&      buffer_pool = m_vertex_pools.at(writer.buffer_range.pool_id);
-    erhe::graphics::Buffer* buffer      = buffer_pool.get_buffer(writer.buffer_range.buffer_id);
-    static_cast<void>(queue.enqueue(buffer, writer.start_offset(), std::move(writer.vertex_data)));
+    erhe::graphics::Buffer* buffer = m_vertex_pools.at(buffer_range.pool_id).get_buffer(buffer_range.buffer_id);
+    return begin_write_to(m_buffer_transfer_queue, buffer, buffer_range, byte_count);
 }
 
-void Mesh_memory::vertex_writer_ready(erhe::primitive::Vertex_buffer_writer& writer)
+void Mesh_memory::end_vertex_write(erhe::primitive::Buffer_sink_write&& write)
 {
-    vertex_writer_ready_to(m_buffer_transfer_queue, writer);
+    erhe::graphics::Buffer* buffer = m_vertex_pools.at(write.buffer_range.pool_id).get_buffer(write.buffer_range.buffer_id);
+    end_write_to(m_buffer_transfer_queue, buffer, std::move(write));
 }
 
 auto Mesh_memory::allocate_index_buffer_range(
@@ -435,26 +426,61 @@ void Mesh_memory::enqueue_index_data(const erhe::primitive::Buffer_range& buffer
     enqueue_index_data_to(m_buffer_transfer_queue, buffer_range, std::move(data));
 }
 
-void Mesh_memory::index_writer_ready_to(
+auto Mesh_memory::begin_index_write(const erhe::primitive::Buffer_range& buffer_range, const std::size_t byte_count) -> erhe::primitive::Buffer_sink_write
+{
+    erhe::graphics::Buffer* buffer = m_index_pools.at(buffer_range.pool_id).get_buffer(buffer_range.buffer_id);
+    return begin_write_to(m_buffer_transfer_queue, buffer, buffer_range, byte_count);
+}
+
+void Mesh_memory::end_index_write(erhe::primitive::Buffer_sink_write&& write)
+{
+    erhe::graphics::Buffer* buffer = m_index_pools.at(write.buffer_range.pool_id).get_buffer(write.buffer_range.buffer_id);
+    end_write_to(m_buffer_transfer_queue, buffer, std::move(write));
+}
+
+auto Mesh_memory::begin_write_to(
     erhe::graphics::Buffer_transfer_queue& queue,
-    erhe::primitive::Index_buffer_writer&  writer
+    erhe::graphics::Buffer*                buffer,
+    const erhe::primitive::Buffer_range&   buffer_range,
+    const std::size_t                      byte_count
+) -> erhe::primitive::Buffer_sink_write
+{
+    const erhe::graphics::Buffer_transfer_queue::Reservation reservation = queue.reserve(buffer, buffer_range.byte_offset, byte_count);
+    if (reservation.id == 0) {
+        // No staging room (or unaligned range): build in a heap vector and
+        // enqueue it at end_write_to(), as before.
+        return erhe::primitive::make_heap_sink_write(buffer_range, byte_count);
+    }
+    // Writers leave padding and unused attributes untouched; the heap path
+    // zero fills those bytes, so do the same here.
+    std::memset(reservation.span.data(), 0, reservation.span.size_bytes());
+    return erhe::primitive::Buffer_sink_write{
+        .buffer_range = buffer_range,
+        .span         = reservation.span,
+        .heap_data    = {},
+        .sink_handle  = reservation.id
+    };
+}
+
+void Mesh_memory::end_write_to(
+    erhe::graphics::Buffer_transfer_queue& queue,
+    erhe::graphics::Buffer*                buffer,
+    erhe::primitive::Buffer_sink_write&&   write
 )
 {
     log_mesh_memory->trace(
-        "Index buffer writer ready for pool_id = {}, buffer_id = {}, byte_offset = {}, byte_count = {}",
-        writer.buffer_range.pool_id,
-        writer.buffer_range.buffer_id,
-        writer.start_offset(),
-        writer.index_data.size()
+        "Buffer sink write ready for pool_id = {}, buffer_id = {}, byte_offset = {}, byte_count = {}, staged = {}",
+        write.buffer_range.pool_id,
+        write.buffer_range.buffer_id,
+        write.buffer_range.byte_offset,
+        write.span.size_bytes(),
+        write.sink_handle != 0
     );
-    const Buffer_pool&      buffer_pool = m_index_pools.at(writer.buffer_range.pool_id);
-    erhe::graphics::Buffer* buffer      = buffer_pool.get_buffer(writer.buffer_range.buffer_id);
-    static_cast<void>(queue.enqueue(buffer, writer.start_offset(), std::move(writer.index_data)));
-}
-
-void Mesh_memory::index_writer_ready(erhe::primitive::Index_buffer_writer& writer)
-{
-    index_writer_ready_to(m_buffer_transfer_queue, writer);
+    if (write.sink_handle != 0) {
+        static_cast<void>(queue.commit(write.sink_handle));
+    } else {
+        static_cast<void>(queue.enqueue(buffer, write.buffer_range.byte_offset, std::move(write.heap_data)));
+    }
 }
 
 // --- Loader_buffer_sink ---------------------------------------------------
@@ -480,9 +506,16 @@ void Mesh_memory::Loader_buffer_sink::enqueue_vertex_data(const erhe::primitive:
     m_mesh_memory.enqueue_vertex_data_to(m_mesh_memory.m_loader_transfer_queue, buffer_range, std::move(data));
 }
 
-void Mesh_memory::Loader_buffer_sink::vertex_writer_ready(erhe::primitive::Vertex_buffer_writer& writer)
+auto Mesh_memory::Loader_buffer_sink::begin_vertex_write(const erhe::primitive::Buffer_range& buffer_range, const std::size_t byte_count) -> erhe::primitive::Buffer_sink_write
+{
+    erhe::graphics::Buffer* buffer = m_mesh_memory.m_vertex_pools.at(buffer_range.pool_id).get_buffer(buffer_range.buffer_id);
+    return m_mesh_memory.begin_write_to(m_mesh_memory.m_loader_transfer_queue, buffer, buffer_range, byte_count);
+}
+
+void Mesh_memory::Loader_buffer_sink::end_vertex_write(erhe::primitive::Buffer_sink_write&& write)
 {
-    m_mesh_memory.vertex_writer_ready_to(m_mesh_memory.m_loader_transfer_queue, writer);
+    erhe::graphics::Buffer* buffer = m_mesh_memory.m_vertex_pools.at(write.buffer_range.pool_id).get_buffer(write.buffer_range.buffer_id);
+    m_mesh_memory.end_write_to(m_mesh_memory.m_loader_transfer_queue, buffer, std::move(write));
 }
 
 auto Mesh_memory::Loader_buffer_sink::allocate_index_buffer_range(
@@ -498,9 +531,16 @@ void Mesh_memory::Loader_buffer_sink::enqueue_index_data(const erhe::primitive::
     m_mesh_memory.enqueue_index_data_to(m_mesh_memory.m_loader_transfer_queue, buffer_range, std::move(data));
 }
 
-void Mesh_memory::Loader_buffer_sink::index_writer_ready(erhe::primitive::Index_buffer_writer& writer)
+auto Mesh_memory::Loader_buffer_sink::begin_index_write(const erhe::primitive::Buffer_range& buffer_range, const std::size_t byte_count) -> erhe::primitive::Buffer_sink_write
+{
+    erhe::graphics::Buffer* buffer = m_mesh_memory.m_index_pools.at(buffer_range.pool_id).get_buffer(buffer_range.buffer_id);
+    return m_mesh_memory.begin_write_to(m_mesh_memory.m_loader_transfer_queue, buffer, buffer_range, byte_count);
+}
+
+void Mesh_memory::Loader_buffer_sink::end_index_write(erhe::primitive::Buffer_sink_write&& write)
 {
-    m_mesh_memory.index_writer_ready_to(m_mesh_memory.m_loader_transfer_queue, writer);
+    erhe::graphics::Buffer* buffer = m_mesh_memory.m_index_pools.at(write.buffer_range.pool_id).get_buffer(write.buffer_range.buffer_id);
+    m_mesh_memory.end_write_to(m_mesh_memory.m_loader_transfer_queue, buffer, std::move(write));
 }
 
 auto Mesh_memory::get_empty_vertex_input() -> const Vertex_input_entry&
@@ -161,16 +161,19 @@ public:
 
     [[nodiscard]] auto get_vertex_stream(const Pool_buffer_identity& buffer_identity) -> erhe::dataformat::Vertex_stream;
     [[nodiscard]] auto get_index_format (const Pool_buffer_identity& buffer_identity) -> erhe::dataformat::Format;
+    [[nodiscard]] auto get_graphics_device() -> erhe::graphics::Device& { return m_graphics_device; }
 
     // Implements erhe::primitive::Vertex_buffer_sink
     auto allocate_vertex_buffer_range(const erhe::dataformat::Vertex_stream& vertex_stream, std::size_t vertex_count) -> erhe::primitive::Buffer_sink_allocation override;
     void enqueue_vertex_data         (const erhe::primitive::Buffer_range& buffer_range, std::vector<uint8_t>&& data) override;
-    void vertex_writer_ready         (erhe::primitive::Vertex_buffer_writer& writer)                                  override;
+    auto begin_vertex_write          (const erhe::primitive::Buffer_range& buffer_range, std::size_t byte_count)      -> erhe::primitive::Buffer_sink_write override;
+    void end_vertex_write            (erhe::primitive::Buffer_sink_write&& write)                                      override;
 
     // Implements erhe::primitive::Index_buffer_sink
     auto allocate_index_buffer_range(const erhe::dataformat::Format index_format, std::size_t index_count) -> erhe::primitive::Buffer_sink_allocation override;
     void enqueue_index_data         (const erhe::primitive::Buffer_range& buffer_range, std::vector<uint8_t>&& data) override;
-    void index_writer_ready         (erhe::primitive::Index_buffer_writer&  writer)                                  override;
+    auto begin_index_write          (const erhe::primitive::Buffer_range& buffer_range, std::size_t byte_count)      -> erhe::primitive::Buffer_sink_write override;
+    void end_index_write            (erhe::primitive::Buffer_sink_write&& write)                                      override;
 
     erhe::dataformat::Vertex_format vertex_format_empty;
     erhe::dataformat::Vertex_format vertex_format_skinned;
@@ -230,11 +233,13 @@ public:
 
         auto allocate_vertex_buffer_range(const erhe::dataformat::Vertex_stream& vertex_stream, std::size_t vertex_count) -> erhe::primitive::Buffer_sink_allocation override;
         void enqueue_vertex_data         (const erhe::primitive::Buffer_range& buffer_range, std::vector<uint8_t>&& data) override;
-        void vertex_writer_ready         (erhe::primitive::Vertex_buffer_writer& writer)                                  override;
+        auto begin_vertex_write          (const erhe::primitive::Buffer_range& buffer_range, std::size_t byte_count)      -> erhe::primitive::Buffer_sink_write override;
+        void end_vertex_write            (erhe::primitive::Buffer_sink_write&& write)                                      override;
 
         auto allocate_index_buffer_range(erhe::dataformat::Format index_format, std::size_t index_count) -> erhe::primitive::Buffer_sink_allocation override;
         void enqueue_index_data         (const erhe::primitive::Buffer_range& buffer_range, std::vector<uint8_t>&& data) override;
-        void index_writer_ready         (erhe::primitive::Index_buffer_writer&  writer)                                  override;
+        auto begin_index_write          (const erhe::primitive::Buffer_range& buffer_range, std::size_t byte_count)      -> erhe::primitive::Buffer_sink_write override;
+        void end_index_write            (erhe::primitive::Buffer_sink_write&& write)                                      override;
 
     private:
         Mesh_memory& m_mesh_memory;
@@ -245,8 +250,11 @@ private:
 
     void enqueue_vertex_data_to(erhe::graphics::Buffer_transfer_queue& queue, const erhe::primitive::Buffer_range& buffer_range, std::vector<uint8_t>&& data);
     void enqueue_index_data_to (erhe::graphics::Buffer_transfer_queue& queue, const erhe::primitive::Buffer_range& buffer_range, std::vector<uint8_t>&& data);
-    void vertex_writer_ready_to(erhe::graphics::Buffer_transfer_queue& queue, erhe::primitive::Vertex_buffer_writer& writer);
-    void index_writer_ready_to (erhe::graphics::Buffer_transfer_queue& queue, erhe::primitive::Index_buffer_writer&  writer);
+    // Writes go straight into the queue's staging ring when it has room
+    // (Buffer_transfer_queue::reserve()), so a mesh build does not hold its
+    // vertex and index data in heap vectors until the next flush.
+    [[nodiscard]] auto begin_write_to(erhe::graphics::Buffer_transfer_queue& queue, erhe::graphics::Buffer* buffer, const erhe::primitive::Buffer_range& buffer_range, std::size_t byte_count) -> erhe::primitive::Buffer_sink_write;
+    void end_write_to(erhe::graphics::Buffer_transfer_queue& queue, erhe::graphics::Buffer* buffer, erhe::primitive::Buffer_sink_write&& write);
 
     // Applies every pending free whose loader ticket the watermark has now
     // passed. Called from flush().
@@ -6,6 +6,8 @@
 #include "erhe_scene_renderer/buffer_binding_points.hpp"
 #include "erhe_scene_renderer/face_id_base_provider.hpp"
 #include "erhe_scene_renderer/mesh_memory.hpp"
+#include "erhe_graphics/buffer.hpp"
+#include "erhe_graphics/command_encoder.hpp"
 #include "erhe_graphics/span.hpp"
 
 #include "erhe_math/math_util.hpp"
@@ -63,6 +65,54 @@ Primitive_interface::Primitive_interface(erhe::graphics::Device& graphics_device
     primitive_block.add_struct("primitives", &primitive_struct, array_size);
 }
 
+auto Primitive_record_patch::is_patchable(const Primitive_interface_settings& settings) -> bool
+{
+    return
+        (settings.face_id_base_provider == nullptr) &&
+        (settings.color_source != Primitive_color_source::id_offset) &&
+        (settings.size_source == Primitive_size_source::constant_size);
+}
+
+auto Primitive_record_patch::from_settings(const Primitive_interface_settings& settings) -> Primitive_record_patch
+{
+    ERHE_VERIFY(is_patchable(settings));
+    return Primitive_record_patch{
+        .wireframe       = (settings.color_source == Primitive_color_source::mesh_wireframe_color),
+        .constant_color0 = settings.constant_color0,
+        .constant_color1 = settings.constant_color1,
+        .constant_size   = settings.constant_size
+    };
+}
+
+auto Primitive_record_patch::operator==(const Primitive_record_patch& other) const -> bool
+{
+    // The wireframe color is a constant; the constant colors do not matter
+    // for wireframe patches.
+    if (wireframe != other.wireframe) {
+        return false;
+    }
+    if (constant_size != other.constant_size) {
+        return false;
+    }
+    return wireframe || ((constant_color0 == other.constant_color0) && (constant_color1 == other.constant_color1));
+}
+
+void Primitive_record_patch::apply(std::byte* const record, const Primitive_struct& offsets, const uint64_t flag_bits) const
+{
+    constexpr glm::vec4 wireframe_color{1.0f, 1.0f, 1.0f, 1.0f};
+    // Same selection as write_primitive(): Item_base::is_selected() /
+    // is_hovered() on the mirrored flag word.
+    const bool selected = (flag_bits & erhe::Item_flags::selected) != 0u;
+    const bool hovered  = (flag_bits & (erhe::Item_flags::hovered_in_viewport | erhe::Item_flags::hovered_in_item_tree)) != 0u;
+    const glm::vec4& color = wireframe
+        ? wireframe_color
+        : (selected || !hovered)
+            ? constant_color0
+            : constant_color1;
+    std::memcpy(record + offsets.color, &color,         sizeof(glm::vec4));
+    std::memcpy(record + offsets.size,  &constant_size, sizeof(float));
+}
+
 Primitive_buffer::Primitive_buffer(erhe::graphics::Device& graphics_device, Primitive_interface& primitive_interface)
     : Ring_buffer_client{
         graphics_device,
@@ -424,19 +474,14 @@ auto Primitive_buffer::update(
 
 auto Primitive_buffer::update(
     const Draw_list&                    draw_list,
-    const std::size_t                   begin,
-    const std::size_t                   end,
+    const std::span<const uint32_t>     entry_indices,
     const Draw_list_scene&              draw_list_scene,
-    const erhe::Item_filter&            filter,
-    const Primitive_interface_settings& settings,
-    std::size_t&                        out_primitive_count
+    const Primitive_interface_settings& settings
 ) -> erhe::graphics::Ring_buffer_range
 {
     ERHE_PROFILE_FUNCTION();
 
-    ERHE_VERIFY(begin <= end);
-    ERHE_VERIFY(end <= draw_list.entries.size());
-    const std::size_t max_primitive_count = end - begin;
+    const std::size_t max_primitive_count = entry_indices.size();
     const std::size_t entry_size          = m_primitive_interface.primitive_struct.get_size_bytes();
     const std::size_t max_byte_count      = max_primitive_count * entry_size;
     const std::size_t acquire_byte_count  = std::max(max_byte_count, m_primitive_interface.primitive_block.get_size_bytes());
@@ -444,65 +489,57 @@ auto Primitive_buffer::update(
     erhe::graphics::Ring_buffer_range buffer_range       = acquire(erhe::graphics::Ring_buffer_usage::CPU_write, acquire_byte_count);
     std::span<std::byte>              primitive_gpu_data = buffer_range.get_span();
     std::size_t                       write_offset       = 0;
-    std::size_t                       primitive_count    = 0;
 
     // Fast path (doc/draw_list_performance_improvements.md): the draw list
     // owns a complete GPU-layout record per entry; copy it and patch only the
     // pass-dependent color / size. Settings that need per-mesh evaluation
     // (id offsets, face-id bases, mesh point size / line width) take the
     // generic per-entry writer below; no draw-list-routed pass uses them.
-    const bool fast_path =
-        (settings.face_id_base_provider == nullptr) &&
-        (settings.color_source != Primitive_color_source::id_offset) &&
-        (settings.size_source == Primitive_size_source::constant_size);
-    if (fast_path) {
+    if (Primitive_record_patch::is_patchable(settings)) {
         ERHE_VERIFY(draw_list.primitive_records.size() == draw_list.entries.size() * entry_size);
-        const std::byte* records = draw_list.primitive_records.data();
-        std::byte*       dst     = primitive_gpu_data.data();
-        const auto&      offsets = m_primitive_interface.offsets;
-        constexpr glm::vec4 wireframe_color{1.0f, 1.0f, 1.0f, 1.0f};
-        const bool  wireframe = (settings.color_source == Primitive_color_source::mesh_wireframe_color);
-        const float size      = settings.constant_size;
-        for (std::size_t i = begin; i < end; ++i) {
+        const Primitive_record_patch patch   = Primitive_record_patch::from_settings(settings);
+        const std::byte*             records = draw_list.primitive_records.data();
+        std::byte*                   dst     = primitive_gpu_data.data();
+        for (const uint32_t i : entry_indices) {
+            ERHE_VERIFY(i < draw_list.entries.size());
             const Draw_list_entry& entry = draw_list.entries[i];
-            if (!filter(entry.flag_bits)) {
-                continue;
-            }
-            std::memcpy(dst + write_offset, records + i * entry_size, entry_size);
-            // Same selection as write_primitive(): Item_base::is_selected() /
-            // is_hovered() on the mirrored flag word.
-            const bool selected = (entry.flag_bits & erhe::Item_flags::selected) != 0u;
-            const bool hovered  = (entry.flag_bits & (erhe::Item_flags::hovered_in_viewport | erhe::Item_flags::hovered_in_item_tree)) != 0u;
-            const glm::vec4& color = wireframe
-                ? wireframe_color
-                : (selected || !hovered)
-                    ? settings.constant_color0
-                    : settings.constant_color1;
-            std::memcpy(dst + write_offset + offsets.color, &color, sizeof(glm::vec4));
-            std::memcpy(dst + write_offset + offsets.size,  &size,  sizeof(float));
+            std::memcpy(dst + write_offset, records + static_cast<std::size_t>(i) * entry_size, entry_size);
+            patch.apply(dst + write_offset, m_primitive_interface.offsets, entry.flag_bits);
             write_offset += entry_size;
-            ++primitive_count;
         }
     } else {
         const erhe::primitive::Primitive_mode primitive_mode = draw_list.key.primitive_mode;
-        for (std::size_t i = begin; i < end; ++i) {
+        for (const uint32_t i : entry_indices) {
+            ERHE_VERIFY(i < draw_list.entries.size());
             const Draw_list_entry& entry = draw_list.entries[i];
-            if (!filter(entry.flag_bits)) {
-                continue;
-            }
             erhe::scene::Mesh* mesh = draw_list_scene.get_object_mesh(entry.object_index);
             ERHE_VERIFY(mesh != nullptr);
             write_primitive(*mesh, entry.mesh_primitive_index, primitive_mode, settings, false, primitive_gpu_data, write_offset);
-            ++primitive_count;
         }
     }
 
     buffer_range.bytes_written(write_offset);
     buffer_range.close();
-    out_primitive_count = primitive_count;
     return buffer_range;
 }
 
+void Primitive_buffer::bind_resident(
+    erhe::graphics::Command_encoder& command_encoder,
+    const erhe::graphics::Buffer&    buffer,
+    const std::size_t                byte_offset,
+    const std::size_t                byte_count
+)
+{
+    ERHE_VERIFY(byte_count > 0);
+    ERHE_VERIFY(byte_offset + byte_count <= buffer.get_capacity_byte_count());
+    const erhe::graphics::Buffer_target target = m_primitive_interface.primitive_block.get_binding_target();
+    ERHE_VERIFY(
+        (target != erhe::graphics::Buffer_target::uniform) ||
+        (byte_count <= static_cast<std::size_t>(m_graphics_device.get_info().max_uniform_block_size))
+    );
+    command_encoder.set_buffer(target, &buffer, byte_offset, byte_count, m_primitive_interface.primitive_block.get_binding_point());
+}
+
 auto Primitive_buffer::update(
     const std::span<const std::shared_ptr<erhe::scene::Node>>& nodes,
     const Primitive_interface_settings&                        primitive_settings
@@ -15,6 +15,10 @@
 namespace erhe {
     class Item_filter;
 }
+namespace erhe::graphics {
+    class Buffer;
+    class Command_encoder;
+}
 namespace erhe::scene {
     class Mesh;
     class Mesh_layer;
@@ -113,6 +117,33 @@ public:
     const Face_id_base_provider* face_id_base_provider{nullptr};
 };
 
+// The pass-dependent fields (color / size) of a draw list primitive record
+// (doc/draw_list_performance_improvements.md). Draw_list::primitive_records
+// carry zero there; every pass whose settings is_patchable() derives its
+// values from the settings and the mirrored entry flag bits alone, so one
+// patch applied to a copy of the records gives the exact bytes
+// Primitive_buffer::write_primitive() would write. Also the key of the
+// resident record copies of static draw lists (Draw_list_scene).
+class Primitive_record_patch
+{
+public:
+    // False for settings that need per-mesh evaluation (id offsets, face-id
+    // bases, mesh point size / line width).
+    [[nodiscard]] static auto is_patchable (const Primitive_interface_settings& settings) -> bool;
+    [[nodiscard]] static auto from_settings(const Primitive_interface_settings& settings) -> Primitive_record_patch;
+
+    [[nodiscard]] auto operator==(const Primitive_record_patch& other) const -> bool;
+
+    // Writes color / size of one record; flag_bits is the entry's mirrored
+    // Item_flags word (selected / hovered pick the color).
+    void apply(std::byte* record, const Primitive_struct& offsets, uint64_t flag_bits) const;
+
+    bool      wireframe      {false};
+    glm::vec4 constant_color0{1.0f, 1.0f, 1.0f, 1.0f};
+    glm::vec4 constant_color1{1.0f, 0.0f, 0.0f, 1.0f};
+    float     constant_size  {1.0f};
+};
+
 class Primitive_buffer : public erhe::graphics::Ring_buffer_client
 {
 public:
@@ -137,24 +168,31 @@ public:
     ) -> erhe::graphics::Ring_buffer_range;
 
     // Draw-list overload (doc/draw_list_renderer_requirements.md R8/R8a):
-    // writes one primitive record per entry in [begin, end) of draw_list that
-    // passes filter (evaluated on the entry's mirrored flag bits), in entry
-    // order. Draw_indirect_buffer::update(Draw_list, ...) with the same
-    // arguments emits exactly the matching draw commands. Records are copied
+    // writes one primitive record per entry of draw_list listed in
+    // entry_indices (already flag filtered and culled by Draw_list_scene), in
+    // that order. Draw_indirect_buffer::update(Draw_list, ...) with the same
+    // indices emits exactly the matching draw commands. Records are copied
     // from draw_list.primitive_records (doc/draw_list_performance_improvements.md)
     // with only the pass-dependent color / size patched; settings that need
     // per-mesh evaluation fall back to write_primitive() via draw_list_scene.
     // No id ranges.
     auto update(
         const Draw_list&                    draw_list,
-        std::size_t                         begin,
-        std::size_t                         end,
+        std::span<const uint32_t>           entry_indices,
         const Draw_list_scene&              draw_list_scene,
-        const erhe::Item_filter&            filter,
-        const Primitive_interface_settings& settings,
-        std::size_t&                        out_primitive_count
+        const Primitive_interface_settings& settings
     ) -> erhe::graphics::Ring_buffer_range;
 
+    // Binds byte_count bytes of a persistent buffer holding records in the
+    // primitive block layout (resident records of static draw lists) to the
+    // primitive block binding point, in place of a ring buffer range.
+    void bind_resident(
+        erhe::graphics::Command_encoder& command_encoder,
+        const erhe::graphics::Buffer&    buffer,
+        std::size_t                      byte_offset,
+        std::size_t                      byte_count
+    );
+
     auto update(
         const std::span<const std::shared_ptr<erhe::scene::Node>>& nodes,
         const Primitive_interface_settings&                        primitive_settings
@@ -34,6 +34,7 @@ Program_interface::Program_interface(
     , glyph_interface    {graphics_device}
     , joint_interface    {graphics_device, config.max_joint_count}
     , light_interface    {graphics_device, config.max_light_count}
+    , light_cluster_interface{graphics_device}
     , material_interface {graphics_device, config.max_material_count}
     , primitive_interface{graphics_device, config.max_primitive_count}
 {
@@ -78,6 +79,8 @@ Program_interface::Program_interface(
             {.binding_point = joint_buffer_binding_point,         .type = to_binding_type(joint_interface.joint_block),          .stage_flags = Stage::vertex},
             // glyph: grid axis-label coverage in grid.frag only.
             {.binding_point = glyph_buffer_binding_point,         .type = to_binding_type(glyph_interface.glyph_block),          .stage_flags = Stage::fragment},
+            // light_cluster: clustered light loop in standard.frag only.
+            {.binding_point = light_cluster_buffer_binding_point, .type = to_binding_type(light_cluster_interface.light_cluster_block), .stage_flags = Stage::fragment},
             // The shadow samplers are wired in as immutable samplers in the
             // descriptor set layout. The Vulkan portability subset on
             // MoltenVK rejects comparison samplers via push descriptors
@@ -239,6 +242,7 @@ auto Program_interface::make_prototype(
     create_info.add_interface_block(&primitive_interface.primitive_block);
     create_info.add_interface_block(&joint_interface.joint_block);
     create_info.add_interface_block(&glyph_interface.glyph_block);
+    create_info.add_interface_block(&light_cluster_interface.light_cluster_block);
     create_info.bind_group_layout = bind_group_layout.get();
     create_info.defines.emplace_back("ERHE_SHADOW_MAPS", "1");
     if (glyph_interface.supported) {
@@ -9,6 +9,7 @@
 #include "erhe_scene_renderer/glyph_buffer.hpp"
 #include "erhe_scene_renderer/joint_buffer.hpp"
 #include "erhe_scene_renderer/light_buffer.hpp"
+#include "erhe_scene_renderer/light_cluster_buffer.hpp"
 #include "erhe_scene_renderer/material_buffer.hpp"
 #include "erhe_scene_renderer/primitive_buffer.hpp"
 
@@ -64,6 +65,7 @@ public:
     Glyph_interface                                    glyph_interface;
     Joint_interface                                    joint_interface;
     Light_interface                                    light_interface;
+    Light_cluster_interface                            light_cluster_interface;
     Material_interface                                 material_interface;
     Primitive_interface                                primitive_interface;
     std::unique_ptr<erhe::graphics::Bind_group_layout> bind_group_layout;
@@ -320,4 +320,15 @@ auto compute_light_layer_partition(
     return partition;
 }
 
+void set_light_count_axes(Shader_key& key, const Light_layer_partition& partition, const bool clustered_lights)
+{
+    key.set(Shader_int::LIGHT_COUNT_DIRECTIONAL_NOT_SHADOWMAPPED, static_cast<uint32_t>(partition.per_type_nonshadow[0]));
+    key.set(Shader_int::LIGHT_COUNT_DIRECTIONAL_SHADOWMAPPED,     static_cast<uint32_t>(partition.per_type_shadow   [0]));
+    key.set(Shader_int::LIGHT_COUNT_SPOT_NOT_SHADOWMAPPED,        clustered_lights ? 0u : static_cast<uint32_t>(partition.per_type_nonshadow[1]));
+    key.set(Shader_int::LIGHT_COUNT_SPOT_SHADOWMAPPED,            static_cast<uint32_t>(partition.per_type_shadow   [1]));
+    key.set(Shader_int::LIGHT_COUNT_POINT_NOT_SHADOWMAPPED,       clustered_lights ? 0u : static_cast<uint32_t>(partition.per_type_nonshadow[2]));
+    key.set(Shader_int::LIGHT_COUNT_POINT_SHADOWMAPPED,           static_cast<uint32_t>(partition.per_type_shadow   [2]));
+    key.set(Shader_bool::USE_CLUSTERED_LIGHTS,                    clustered_lights);
+}
+
 } // namespace erhe::scene_renderer
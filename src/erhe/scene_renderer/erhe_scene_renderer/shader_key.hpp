@@ -131,7 +131,8 @@ inline constexpr const char* c_shader_debug_strings[] = {
     X(EDGE_LINES_FROM_ID)               \
     X(EDGE_LINES_CORNER_CAP)            \
     X(VARIANT_FACE_ID_SEED)             \
-    X(USE_DDGI)
+    X(USE_DDGI)                         \
+    X(USE_CLUSTERED_LIGHTS)
 
 #define ERHE_SHADER_INT(X) \
     X(LIGHT_COUNT_DIRECTIONAL_SHADOWMAPPED)     \
@@ -319,4 +320,10 @@ public:
     const Light_count_limits&                            light_count_limits
 ) -> Light_layer_partition;
 
+// Sets the LIGHT_COUNT_* axes from the partition. With clustered_lights the
+// non-shadow spot and point lights are shaded from the per cluster light
+// lists (USE_CLUSTERED_LIGHTS, see Light_cluster_builder) instead of the flat
+// loops, so their counts are left at 0 and do not multiply the variants.
+void set_light_count_axes(Shader_key& key, const Light_layer_partition& partition, bool clustered_lights);
+
 } // namespace erhe::scene_renderer
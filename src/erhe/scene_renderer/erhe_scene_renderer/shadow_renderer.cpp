@@ -507,6 +507,14 @@ auto Shadow_renderer::render(const Render_parameters& parameters) -> bool
             : &erhe::graphics::Color_blend_state::color_writes_disabled; // depth-only
 
         if (parameters.draw_list_scene != nullptr) {
+            // Casters outside the light frustum cannot affect the map; the
+            // light-side plane is dropped so casters between the light and
+            // the fitted near plane are kept.
+            const Draw_cull_volume cull_volume = make_shadow_cull_volume(
+                light_projection_transform->clip_from_world.get_matrix(),
+                parameters.depth_range,
+                parameters.reverse_depth
+            );
             static_cast<void>(
                 parameters.draw_list_scene->draw_shadow(
                     Draw_shadow_parameters{
@@ -519,6 +527,7 @@ auto Shadow_renderer::render(const Render_parameters& parameters) -> bool
                         .filter               = shadow_filter,
                         .layers               = parameters.draw_list_layers,
                         .sub_variant          = parameters.use_distance ? Shadow_sub_variant::depth_only_distance : Shadow_sub_variant::depth_only,
+                        .cull_volumes         = std::span<const Draw_cull_volume>{&cull_volume, 1},
                         .debug_label          = "shadow draw lists"
                     }
                 )
@@ -677,6 +686,17 @@ auto Shadow_renderer::render(const Render_parameters& parameters) -> bool
                 m_texture_heap->bind(encoder);
 
                 if (parameters.draw_list_scene != nullptr) {
+                    const glm::mat4 clip_from_face = lpt->projection.clip_from_node_transform(
+                        parameters.point_shadow_viewport,
+                        parameters.reverse_depth,
+                        parameters.depth_range,
+                        cube_conventions
+                    ).get_matrix();
+                    const Draw_cull_volume cull_volume = make_shadow_cull_volume(
+                        clip_from_face * face_transform.get_inverse_matrix(),
+                        parameters.depth_range,
+                        parameters.reverse_depth
+                    );
                     static_cast<void>(
                         parameters.draw_list_scene->draw_shadow(
                             Draw_shadow_parameters{
@@ -689,6 +709,7 @@ auto Shadow_renderer::render(const Render_parameters& parameters) -> bool
                                 .filter               = shadow_filter,
                                 .layers               = parameters.draw_list_layers,
                                 .sub_variant          = Shadow_sub_variant::cube,
+                                .cull_volumes         = std::span<const Draw_cull_volume>{&cull_volume, 1},
                                 .debug_label          = "shadow cube draw lists"
                             }
                         )
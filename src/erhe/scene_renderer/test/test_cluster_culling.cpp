@@ -0,0 +1,181 @@
+// Meshlet build + CPU cluster culling: the draw commands emitted for a
+// primitive instance must stay inside its meshlet index range, cover every
+// meshlet when nothing culls, and only drop meshlets that are outside the
+// cull volumes or back facing. Needs no graphics device.
+
+#include "erhe_scene_renderer/draw_list.hpp"
+#include "erhe_geometry/geometry.hpp"
+#include "erhe_geometry/shapes/sphere.hpp"
+#include "erhe_primitive/meshlet.hpp"
+
+#include <geogram/mesh/mesh.h>
+#include <glm/glm.hpp>
+#include <gtest/gtest.h>
+
+#include <set>
+#include <vector>
+
+namespace {
+
+using erhe::graphics::Draw_indexed_primitives_indirect_command;
+using erhe::primitive::Buffer_meshlet;
+using erhe::scene_renderer::Draw_cull_volume;
+using erhe::scene_renderer::append_cluster_draw_commands;
+
+constexpr uint32_t base_index  = 1000;
+constexpr uint32_t base_vertex = 77;
+
+class Sphere_meshlets
+{
+public:
+    Sphere_meshlets()
+    {
+        erhe::geometry::shapes::make_sphere(mesh, 1.0f, 64, 32);
+        build = erhe::primitive::build_meshlets(mesh, erhe::primitive::Meshlet_settings{.min_triangle_count = 0});
+    }
+
+    GEO::Mesh                      mesh;
+    erhe::primitive::Meshlet_build build;
+};
+
+auto get_corner_position(const GEO::Mesh& mesh, const GEO::index_t corner) -> glm::vec3
+{
+    return erhe::geometry::to_glm_vec3(erhe::geometry::get_pointf(mesh.vertices, mesh.facet_corners.vertex(corner)));
+}
+
+auto make_half_space(const glm::vec4& plane) -> Draw_cull_volume
+{
+    Draw_cull_volume volume{};
+    volume.planes[0]   = plane;
+    volume.plane_count = 1;
+    return volume;
+}
+
+TEST(ClusterCulling, MeshletsPartitionFillTriangles)
+{
+    const Sphere_meshlets sphere;
+    const erhe::primitive::Meshlet_settings settings{};
+    ASSERT_FALSE(sphere.build.meshlets.empty());
+    ASSERT_EQ(sphere.build.triangle_corners.size() % 3, 0u);
+
+    std::size_t index_total = 0;
+    for (const Buffer_meshlet& meshlet : sphere.build.meshlets) {
+        EXPECT_EQ(meshlet.first_index, index_total);
+        EXPECT_EQ(meshlet.index_count % 3, 0u);
+        EXPECT_LE(meshlet.index_count / 3, settings.max_triangle_count);
+        std::set<GEO::index_t> corners;
+        for (uint32_t i = 0; i < meshlet.index_count; ++i) {
+            const GEO::index_t corner = sphere.build.triangle_corners[meshlet.first_index + i];
+            corners.insert(corner);
+            // Bounding sphere contains every vertex.
+            const glm::vec3 d = get_corner_position(sphere.mesh, corner) - meshlet.center;
+            EXPECT_LE(glm::length(d), meshlet.radius * 1.0001f + 1e-6f);
+        }
+        EXPECT_LE(corners.size(), settings.max_vertex_count);
+        index_total += meshlet.index_count;
+    }
+    EXPECT_EQ(index_total, sphere.build.triangle_corners.size());
+
+    // Every fan triangle of the fill build, once.
+    std::size_t fan_corner_count = 0;
+    for (GEO::index_t facet : sphere.mesh.facets) {
+        fan_corner_count += 3 * (sphere.mesh.facets.nb_corners(facet) - 2);
+    }
+    EXPECT_EQ(sphere.build.triangle_corners.size(), fan_corner_count);
+}
+
+TEST(ClusterCulling, NoCullingDrawsEveryMeshlet)
+{
+    const Sphere_meshlets sphere;
+    std::vector<Draw_indexed_primitives_indirect_command> commands;
+    const std::size_t count = append_cluster_draw_commands(sphere.build.meshlets, base_index, base_vertex, glm::mat4{1.0f}, {}, {}, commands);
+    ASSERT_EQ(count, sphere.build.meshlets.size());
+    ASSERT_EQ(commands.size(), sphere.build.meshlets.size());
+    for (std::size_t i = 0, end = commands.size(); i < end; ++i) {
+        const Draw_indexed_primitives_indirect_command& command = commands[i];
+        EXPECT_EQ(command.index_count,    sphere.build.meshlets[i].index_count);
+        EXPECT_EQ(command.first_index,    base_index + sphere.build.meshlets[i].first_index);
+        EXPECT_EQ(command.base_vertex,    base_vertex);
+        EXPECT_EQ(command.instance_count, 1u);
+        EXPECT_EQ(command.base_instance,  0u);
+        EXPECT_LE(command.first_index + command.index_count, base_index + sphere.build.triangle_corners.size());
+    }
+}
+
+TEST(ClusterCulling, BackFacingMeshletsAreCulledConservatively)
+{
+    const Sphere_meshlets sphere;
+    const glm::vec3 view_position{0.0f, 0.0f, 10.0f};
+    const glm::vec3 view_positions[] = { view_position };
+    std::vector<Draw_indexed_primitives_indirect_command> commands;
+    const std::size_t count = append_cluster_draw_commands(sphere.build.meshlets, base_index, base_vertex, glm::mat4{1.0f}, {}, view_positions, commands);
+
+    // About half of a sphere faces away; cones are not tight, so fewer are
+    // culled, but a meaningful share must be.
+    EXPECT_LT(count, (sphere.build.meshlets.size() * 3) / 4);
+    EXPECT_GE(count, sphere.build.meshlets.size() / 3);
+
+    // Conservative: no culled meshlet has a triangle facing the view.
+    std::set<uint32_t> drawn_first_indices;
+    for (const Draw_indexed_primitives_indirect_command& command : commands) {
+        drawn_first_indices.insert(command.first_index - base_index);
+    }
+    for (const Buffer_meshlet& meshlet : sphere.build.meshlets) {
+        if (drawn_first_indices.contains(meshlet.first_index)) {
+            continue;
+        }
+        for (uint32_t i = 0; i < meshlet.index_count; i += 3) {
+            glm::vec3 p[3];
+            for (uint32_t j = 0; j < 3; ++j) {
+                p[j] = get_corner_position(sphere.mesh, sphere.build.triangle_corners[meshlet.first_index + i + j]);
+            }
+            const glm::vec3 normal = glm::cross(p[1] - p[0], p[2] - p[0]);
+            EXPECT_LE(glm::dot(normal, view_position - p[0]), 1e-5f) << "front facing triangle culled";
+        }
+    }
+
+    // View positions are given in node space: moving the instance alone
+    // changes nothing.
+    const glm::mat4 world_from_node{
+        glm::vec4{1.0f, 0.0f, 0.0f, 0.0f},
+        glm::vec4{0.0f, 1.0f, 0.0f, 0.0f},
+        glm::vec4{0.0f, 0.0f, 1.0f, 0.0f},
+        glm::vec4{5.0f, 0.0f, 0.0f, 1.0f}
+    };
+    std::vector<Draw_indexed_primitives_indirect_command> moved_commands;
+    EXPECT_EQ(append_cluster_draw_commands(sphere.build.meshlets, base_index, base_vertex, world_from_node, {}, view_positions, moved_commands), count);
+}
+
+TEST(ClusterCulling, FrustumCullsOutsideMeshlets)
+{
+    const Sphere_meshlets sphere;
+    std::vector<Draw_indexed_primitives_indirect_command> commands;
+
+    // Volume x >= 5: the whole unit sphere is outside.
+    const Draw_cull_volume far_volumes[] = { make_half_space(glm::vec4{1.0f, 0.0f, 0.0f, -5.0f}) };
+    EXPECT_EQ(append_cluster_draw_commands(sphere.build.meshlets, base_index, base_vertex, glm::mat4{1.0f}, far_volumes, {}, commands), 0u);
+    EXPECT_TRUE(commands.empty());
+
+    // Volume x >= 0: roughly half, and every drawn meshlet touches it.
+    const Draw_cull_volume half_volumes[] = { make_half_space(glm::vec4{1.0f, 0.0f, 0.0f, 0.0f}) };
+    const std::size_t count = append_cluster_draw_commands(sphere.build.meshlets, base_index, base_vertex, glm::mat4{1.0f}, half_volumes, {}, commands);
+    EXPECT_GT(count, 0u);
+    EXPECT_LT(count, sphere.build.meshlets.size());
+    for (const Buffer_meshlet& meshlet : sphere.build.meshlets) {
+        bool drawn = false;
+        for (const Draw_indexed_primitives_indirect_command& command : commands) {
+            drawn = drawn || (command.first_index == base_index + meshlet.first_index);
+        }
+        EXPECT_EQ(drawn, meshlet.center.x >= -meshlet.radius);
+    }
+
+    // A second volume containing everything: union, nothing culled.
+    const Draw_cull_volume union_volumes[] = {
+        make_half_space(glm::vec4{1.0f, 0.0f, 0.0f, -5.0f}),
+        make_half_space(glm::vec4{1.0f, 0.0f, 0.0f, 5.0f})
+    };
+    commands.clear();
+    EXPECT_EQ(append_cluster_draw_commands(sphere.build.meshlets, base_index, base_vertex, glm::mat4{1.0f}, union_volumes, {}, commands), sphere.build.meshlets.size());
+}
+
+} // anonymous namespace
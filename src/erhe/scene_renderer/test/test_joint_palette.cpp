@@ -0,0 +1,314 @@
+// Joint_palette_cache: the slots it writes must match the per joint
+// world_from_joint * inverse_bind and transpose(adjugate()) math Joint_buffer
+// used to do inline, and only skins whose joints got a new world transform
+// or were reordered are recomputed. No graphics device.
+
+#include "erhe_scene_renderer/joint_palette.hpp"
+
+#include "erhe_benchmark/benchmark.hpp"
+#include "erhe_scene/node.hpp"
+#include "erhe_scene/scene.hpp"
+#include "erhe_scene/scene_executor.hpp"
+#include "erhe_scene/skin.hpp"
+
+#include "test_scene_host.hpp"
+
+#include <fmt/format.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtx/matrix_operation.hpp>
+#include <gtest/gtest.h>
+
+#include <taskflow/taskflow.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace {
+
+using erhe::scene_renderer::Joint_palette_cache;
+using erhe::scene_renderer::Joint_slot_layout;
+using erhe::scene::test::Test_scene_host;
+
+// Same shape as the std430 Joint struct: two mat4 and a uvec4.
+constexpr Joint_slot_layout slot_layout{
+    .slot_size               = 144,
+    .world_from_bind_offset  = 0,
+    .normal_transform_offset = 64,
+    .debug_flags_offset      = 128
+};
+
+auto local_transform(const std::size_t i, const float angle) -> glm::mat4
+{
+    const float f = static_cast<float>(i);
+    glm::mat4 m = glm::translate(glm::mat4{1.0f}, glm::vec3{0.1f * f, 0.5f, -0.2f * f});
+    return glm::rotate(m, angle + 0.05f * f, glm::normalize(glm::vec3{1.0f, 2.0f, 3.0f}));
+}
+
+auto make_skin(const std::size_t joint_count, const std::size_t seed) -> std::shared_ptr<erhe::scene::Skin>
+{
+    auto skin = std::make_shared<erhe::scene::Skin>("skin");
+    for (std::size_t i = 0; i < joint_count; ++i) {
+        auto joint = std::make_shared<erhe::scene::Node>("joint");
+        joint->set_parent_from_node(local_transform(seed + i, 0.0f));
+        skin->skin_data.joints.push_back(joint);
+        skin->skin_data.inverse_bind_matrices.push_back(glm::inverse(local_transform(seed + i, 0.25f)));
+    }
+    return skin;
+}
+
+auto read_mat4(const std::vector<std::byte>& buffer, const std::size_t offset) -> glm::mat4
+{
+    glm::mat4 m;
+    std::memcpy(&m, buffer.data() + offset, sizeof(m));
+    return m;
+}
+
+auto read_uvec4(const std::vector<std::byte>& buffer, const std::size_t offset) -> glm::uvec4
+{
+    glm::uvec4 v;
+    std::memcpy(&v, buffer.data() + offset, sizeof(v));
+    return v;
+}
+
+void expect_slots_match(
+    const std::vector<std::shared_ptr<erhe::scene::Skin>>& skins,
+    const std::vector<std::byte>&                          buffer,
+    const erhe::scene::Node*                               debug_target_joint
+)
+{
+    std::size_t slot = 0;
+    for (const std::shared_ptr<erhe::scene::Skin>& skin : skins) {
+        ASSERT_EQ(skin->skin_data.joint_buffer_index, slot);
+        for (std::size_t i = 0, end = skin->skin_data.joints.size(); i < end; ++i, ++slot) {
+            const erhe::scene::Node& joint = *skin->skin_data.joints[i];
+            const glm::mat4 world_from_bind  = joint.world_from_node() * skin->skin_data.inverse_bind_matrices[i];
+            const glm::mat4 normal_transform = glm::transpose(glm::adjugate(world_from_bind));
+            const std::size_t offset = slot * slot_layout.slot_size;
+            const glm::mat4 written_world_from_bind  = read_mat4(buffer, offset + slot_layout.world_from_bind_offset);
+            const glm::mat4 written_normal_transform = read_mat4(buffer, offset + slot_layout.normal_transform_offset);
+            for (int column = 0; column < 4; ++column) {
+                for (int row = 0; row < 4; ++row) {
+                    ASSERT_NEAR(written_world_from_bind [column][row], world_from_bind [column][row], 1.0e-4f) << "slot " << slot;
+                    ASSERT_NEAR(written_normal_transform[column][row], normal_transform[column][row], 1.0e-4f) << "slot " << slot;
+                }
+            }
+            const glm::uvec4 debug_flags = read_uvec4(buffer, offset + slot_layout.debug_flags_offset);
+            EXPECT_EQ(debug_flags.x, (&joint == debug_target_joint) ? 1u : 0u) << "slot " << slot;
+        }
+    }
+}
+
+} // anonymous namespace
+
+TEST(JointPalette, SlotsMatchPerJointMath)
+{
+    std::vector<std::shared_ptr<erhe::scene::Skin>> skins{make_skin(5, 0), make_skin(3, 100), make_skin(7, 200)};
+    const std::size_t joint_count = Joint_palette_cache::get_joint_count(skins);
+    ASSERT_EQ(joint_count, 15u);
+
+    Joint_palette_cache    cache{slot_layout};
+    std::vector<std::byte> buffer(joint_count * slot_layout.slot_size);
+    const erhe::scene::Node* debug_target_joint = skins[1]->skin_data.joints[2].get();
+    cache.write(skins, debug_target_joint, buffer);
+    expect_slots_match(skins, buffer, debug_target_joint);
+    EXPECT_EQ(cache.get_skin_count(), 3u);
+    EXPECT_EQ(cache.get_recomputed_skin_count(), 3u);
+
+    // Cached slots, new debug target: the old target's flag must not stick.
+    std::fill(buffer.begin(), buffer.end(), std::byte{0xff});
+    cache.write(skins, nullptr, buffer);
+    expect_slots_match(skins, buffer, nullptr);
+    EXPECT_EQ(cache.get_recomputed_skin_count(), 0u);
+}
+
+TEST(JointPalette, RecomputesOnlySkinsWithMovedJoints)
+{
+    std::vector<std::shared_ptr<erhe::scene::Skin>> skins{make_skin(4, 0), make_skin(4, 10), make_skin(4, 20)};
+    Joint_palette_cache    cache{slot_layout};
+    std::vector<std::byte> buffer(Joint_palette_cache::get_joint_count(skins) * slot_layout.slot_size);
+    cache.write(skins, nullptr, buffer);
+    EXPECT_EQ(cache.get_recomputed_skin_count(), 3u);
+
+    skins[1]->skin_data.joints[3]->set_parent_from_node(local_transform(13, 1.0f));
+    std::fill(buffer.begin(), buffer.end(), std::byte{0});
+    cache.write(skins, nullptr, buffer);
+    EXPECT_EQ(cache.get_recomputed_skin_count(), 1u);
+    expect_slots_match(skins, buffer, nullptr);
+
+    // Reordered list: cached slots move with their skin.
+    std::swap(skins[0], skins[2]);
+    cache.write(skins, nullptr, buffer);
+    EXPECT_EQ(cache.get_recomputed_skin_count(), 0u);
+    expect_slots_match(skins, buffer, nullptr);
+}
+
+TEST(JointPalette, RecomputesSkinsWithReorderedJoints)
+{
+    std::vector<std::shared_ptr<erhe::scene::Skin>> skins{make_skin(4, 0), make_skin(4, 10)};
+    Joint_palette_cache    cache{slot_layout};
+    std::vector<std::byte> buffer(Joint_palette_cache::get_joint_count(skins) * slot_layout.slot_size);
+    cache.write(skins, nullptr, buffer);
+    EXPECT_EQ(cache.get_recomputed_skin_count(), 2u);
+
+    // Same nodes, same serials, different slots: no joint moved, yet the
+    // palette of the first skin changes.
+    std::swap(skins[0]->skin_data.joints[0], skins[0]->skin_data.joints[2]);
+    cache.write(skins, nullptr, buffer);
+    EXPECT_EQ(cache.get_recomputed_skin_count(), 1u);
+    expect_slots_match(skins, buffer, nullptr);
+
+    // A joint swapped for a node of another skin
+    std::swap(skins[0]->skin_data.joints[1], skins[1]->skin_data.joints[1]);
+    cache.write(skins, nullptr, buffer);
+    EXPECT_EQ(cache.get_recomputed_skin_count(), 2u);
+    expect_slots_match(skins, buffer, nullptr);
+
+    cache.write(skins, nullptr, buffer);
+    EXPECT_EQ(cache.get_recomputed_skin_count(), 0u);
+}
+
+TEST(JointPalette, SkinListedTwiceIsWrittenTwice)
+{
+    const std::shared_ptr<erhe::scene::Skin> shared = make_skin(3, 0);
+    std::vector<std::shared_ptr<erhe::scene::Skin>> skins{shared, make_skin(2, 50), shared};
+    Joint_palette_cache    cache{slot_layout};
+    std::vector<std::byte> buffer(Joint_palette_cache::get_joint_count(skins) * slot_layout.slot_size);
+    cache.write(skins, shared->skin_data.joints[0].get(), buffer);
+    EXPECT_EQ(cache.get_recomputed_skin_count(), 2u);
+
+    // joint_buffer_index is the last occurrence, like before; both ranges hold the slots.
+    EXPECT_EQ(shared->skin_data.joint_buffer_index, 5u);
+    EXPECT_EQ(std::memcmp(buffer.data(), buffer.data() + 5 * slot_layout.slot_size, 3 * slot_layout.slot_size), 0);
+}
+
+TEST(JointPalette, ParallelWriteMatchesSerialWrite)
+{
+    std::vector<std::shared_ptr<erhe::scene::Skin>> skins;
+    for (std::size_t i = 0; i < 64; ++i) {
+        skins.push_back(make_skin(24, 31 * i));
+    }
+    const std::size_t joint_count = Joint_palette_cache::get_joint_count(skins);
+    ASSERT_GE(joint_count, Joint_palette_cache::c_parallel_joint_count);
+
+    Joint_palette_cache    serial_cache{slot_layout};
+    std::vector<std::byte> serial_buffer(joint_count * slot_layout.slot_size);
+    serial_cache.write(skins, nullptr, serial_buffer);
+
+    tf::Executor executor{4};
+    erhe::scene::set_executor(&executor);
+    Joint_palette_cache    parallel_cache{slot_layout};
+    std::vector<std::byte> parallel_buffer(joint_count * slot_layout.slot_size);
+    parallel_cache.write(skins, nullptr, parallel_buffer);
+    erhe::scene::set_executor(nullptr);
+
+    EXPECT_EQ(parallel_cache.get_recomputed_skin_count(), skins.size());
+    EXPECT_EQ(std::memcmp(serial_buffer.data(), parallel_buffer.data(), serial_buffer.size()), 0);
+}
+
+// Crowd of 1000 skinned characters, 33 joints each (spine of 8, four limbs
+// of 6, all below one root), in a scene. Per frame: pose writes, the scene
+// transform pass and the joint palette, for a crowd that stands still, one
+// with every tenth character animated and one that is fully animated, on
+// the calling thread and on an executor. "inline" is the per joint glm
+// loop Joint_buffer used to run for every joint of every skin.
+ERHE_BENCHMARK(JointPalette, crowd)
+{
+    constexpr std::size_t character_count = 1000;
+    constexpr std::size_t spine_length    = 8;
+    constexpr std::size_t limb_length     = 6;
+
+    Test_scene_host host;
+    std::vector<std::shared_ptr<erhe::scene::Skin>> skins;
+    std::vector<std::vector<std::shared_ptr<erhe::scene::Node>>> poses; // per character, the joints an animation writes
+    for (std::size_t character = 0; character < character_count; ++character) {
+        auto skin = std::make_shared<erhe::scene::Skin>("crowd skin");
+        std::vector<std::shared_ptr<erhe::scene::Node>> pose;
+        const auto add_joint = [&](const std::shared_ptr<erhe::scene::Node>& parent) {
+            auto joint = std::make_shared<erhe::scene::Node>("joint");
+            joint->set_parent(parent);
+            joint->set_parent_from_node(local_transform(skin->skin_data.joints.size(), 0.0f));
+            skin->skin_data.joints.push_back(joint);
+            skin->skin_data.inverse_bind_matrices.push_back(glm::inverse(local_transform(skin->skin_data.joints.size(), 0.1f)));
+            pose.push_back(joint);
+            return joint;
+        };
+        auto root = std::make_shared<erhe::scene::Node>("character");
+        root->set_parent(host.scene.get_root_node());
+        root->set_parent_from_node(glm::translate(glm::mat4{1.0f}, glm::vec3{static_cast<float>(character % 40), 0.0f, static_cast<float>(character / 40)}));
+        std::shared_ptr<erhe::scene::Node> parent = add_joint(root);
+        for (std::size_t i = 1; i < spine_length; ++i) {
+            parent = add_joint(parent);
+        }
+        const std::shared_ptr<erhe::scene::Node> chest = parent;
+        for (std::size_t limb = 0; limb < 4; ++limb) {
+            std::shared_ptr<erhe::scene::Node> limb_parent = chest;
+            for (std::size_t i = 0; i < limb_length; ++i) {
+                limb_parent = add_joint(limb_parent);
+            }
+        }
+        skins.push_back(skin);
+        poses.push_back(std::move(pose));
+    }
+    host.scene.update_node_transforms();
+
+    const std::size_t joint_count = Joint_palette_cache::get_joint_count(skins);
+    std::vector<std::byte> buffer(joint_count * slot_layout.slot_size);
+    tf::Executor executor;
+
+    constexpr int frame_count = 60;
+    for (const std::size_t animated_stride : {std::size_t{0}, std::size_t{10}, std::size_t{1}}) {
+        for (const bool parallel : {false, true}) {
+            erhe::scene::set_executor(parallel ? &executor : nullptr);
+            Joint_palette_cache cache{slot_layout};
+            cache.write(skins, nullptr, buffer); // first fill
+
+            double pose_ms      = 0.0;
+            double palette_ms   = 0.0;
+            double inline_ms    = 0.0;
+            std::size_t recomputed = 0;
+            for (int frame = 0; frame < frame_count; ++frame) {
+                erhe::benchmark::Stopwatch stopwatch;
+                if (animated_stride != 0) {
+                    const float angle = 0.01f * static_cast<float>(frame + 1);
+                    for (std::size_t character = frame % animated_stride; character < character_count; character += animated_stride) {
+                        for (std::size_t i = 0, end = poses[character].size(); i < end; ++i) {
+                            poses[character][i]->set_parent_from_node(local_transform(i, angle));
+                        }
+                    }
+                }
+                host.scene.update_node_transforms();
+                pose_ms += stopwatch.lap_ms();
+                cache.write(skins, nullptr, buffer);
+                palette_ms += stopwatch.lap_ms();
+                recomputed += cache.get_recomputed_skin_count();
+
+                std::size_t offset = 0;
+                for (const std::shared_ptr<erhe::scene::Skin>& skin : skins) {
+                    for (std::size_t i = 0, end = skin->skin_data.joints.size(); i < end; ++i) {
+                        const glm::mat4 world_from_bind  = skin->skin_data.joints[i]->world_from_node() * skin->skin_data.inverse_bind_matrices[i];
+                        const glm::mat4 normal_transform = glm::transpose(glm::adjugate(world_from_bind));
+                        std::memcpy(buffer.data() + offset + slot_layout.world_from_bind_offset,  &world_from_bind,  sizeof(glm::mat4));
+                        std::memcpy(buffer.data() + offset + slot_layout.normal_transform_offset, &normal_transform, sizeof(glm::mat4));
+                        offset += slot_layout.slot_size;
+                    }
+                }
+                inline_ms += stopwatch.lap_ms();
+            }
+            fmt::print(
+                "{} characters, {} joints, {:<14} {:<8}: pose + transforms {:.3f} ms, palette {:.3f} ms ({:.0f} skins recomputed), inline {:.3f} ms per frame\n",
+                character_count,
+                joint_count,
+                (animated_stride == 0) ? "static" : (animated_stride == 1) ? "all animated" : "1/10 animated",
+                parallel ? "parallel" : "serial",
+                pose_ms    / frame_count,
+                palette_ms / frame_count,
+                static_cast<double>(recomputed) / frame_count,
+                inline_ms  / frame_count
+            );
+        }
+    }
+    erhe::scene::set_executor(nullptr);
+}
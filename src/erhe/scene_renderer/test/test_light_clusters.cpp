@@ -0,0 +1,243 @@
+// Clustered light assignment: every light whose range reaches a position
+// must be in the light list of the cluster the shader finds for that
+// position, for perspective and orthographic projections. Pure CPU binning,
+// no graphics device.
+
+#include "erhe_scene_renderer/light_clusters.hpp"
+
+#include "erhe_benchmark/benchmark.hpp"
+
+#include <fmt/format.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace {
+
+using erhe::scene_renderer::Light_cluster_builder;
+using erhe::scene_renderer::Light_cluster_light;
+using erhe::scene_renderer::Light_cluster_settings;
+using erhe::scene_renderer::Light_cluster_view;
+using erhe::scene_renderer::Light_clusters;
+
+constexpr float z_near = 0.1f;
+constexpr float z_far  = 100.0f;
+
+auto make_perspective_view(const bool zero_to_one) -> Light_cluster_view
+{
+    Light_cluster_view view{};
+    const glm::vec3 eye{3.0f, 2.0f, 10.0f};
+    view.view_from_world = glm::lookAt(eye, glm::vec3{0.0f, 0.0f, -20.0f}, glm::vec3{0.0f, 1.0f, 0.0f});
+    view.clip_from_view  = zero_to_one
+        ? glm::perspectiveRH_ZO(glm::radians(60.0f), 16.0f / 9.0f, z_near, z_far)
+        : glm::perspectiveRH_NO(glm::radians(60.0f), 16.0f / 9.0f, z_near, z_far);
+    view.z_near = z_near;
+    view.z_far  = z_far;
+    return view;
+}
+
+auto make_ortho_view() -> Light_cluster_view
+{
+    Light_cluster_view view{};
+    view.view_from_world = glm::lookAt(glm::vec3{0.0f, 0.0f, 10.0f}, glm::vec3{0.0f}, glm::vec3{0.0f, 1.0f, 0.0f});
+    view.clip_from_view  = glm::orthoRH_ZO(-20.0f, 20.0f, -12.0f, 12.0f, z_near, z_far);
+    view.z_near = z_near;
+    view.z_far  = z_far;
+    return view;
+}
+
+auto make_lights(const std::size_t count, const uint32_t seed) -> std::vector<Light_cluster_light>
+{
+    std::mt19937 random{seed};
+    std::uniform_real_distribution<float> xy   {-30.0f, 30.0f};
+    std::uniform_real_distribution<float> z    {-90.0f, 12.0f};
+    std::uniform_real_distribution<float> range{0.5f, 8.0f};
+    std::vector<Light_cluster_light> lights(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        lights[i].position_in_world = glm::vec3{xy(random), xy(random), z(random)};
+        lights[i].range             = range(random);
+        lights[i].light_index       = static_cast<uint32_t>(i);
+        lights[i].is_spot           = (i % 3) == 0;
+    }
+    return lights;
+}
+
+// Random positions inside the view volume.
+auto make_positions(const Light_cluster_view& view, const std::size_t count, const uint32_t seed) -> std::vector<glm::vec3>
+{
+    std::mt19937 random{seed};
+    std::uniform_real_distribution<float> ndc{-0.999f, 0.999f};
+    std::uniform_real_distribution<float> t  {0.0f, 1.0f};
+    const glm::mat4 world_from_clip = glm::inverse(view.clip_from_view * view.view_from_world);
+    const glm::mat4 world_from_view = glm::inverse(view.view_from_world);
+    std::vector<glm::vec3> positions;
+    while (positions.size() < count) {
+        // Pick a point on the NDC ray, then move it to a random view depth.
+        const glm::vec4 a = world_from_clip * glm::vec4{ndc(random), ndc(random), 0.5f, 1.0f};
+        const glm::vec3 on_ray = glm::vec3{a} / a.w;
+        const glm::vec3 eye    = glm::vec3{world_from_view[3]};
+        const float     depth  = z_near * std::pow(z_far / z_near, t(random));
+        const glm::vec3 view_position{view.view_from_world * glm::vec4{on_ray, 1.0f}};
+        const bool      ortho  = (view.clip_from_view[3][3] == 1.0f);
+        glm::vec3 p;
+        if (ortho) {
+            p = glm::vec3{world_from_view * glm::vec4{view_position.x, view_position.y, -depth, 1.0f}};
+        } else {
+            p = eye + (on_ray - eye) * (depth / -view_position.z);
+        }
+        positions.push_back(p);
+    }
+    return positions;
+}
+
+void expect_lights_reaching_positions_are_listed(const Light_cluster_view& view, const std::vector<Light_cluster_light>& lights)
+{
+    Light_cluster_builder builder;
+    Light_clusters        clusters;
+    builder.build(view, lights, Light_cluster_settings{}, clusters);
+
+    std::size_t checked = 0;
+    for (const glm::vec3& p : make_positions(view, 4000, 7)) {
+        const std::span<const uint32_t> list = clusters.get_cluster_lights(clusters.find_cluster(p));
+        for (const Light_cluster_light& light : lights) {
+            if (glm::distance(p, light.position_in_world) >= light.range * 0.999f) {
+                continue;
+            }
+            const uint32_t expected = light.light_index | (light.is_spot ? Light_clusters::spot_light_bit : 0u);
+            EXPECT_NE(std::find(list.begin(), list.end(), expected), list.end())
+                << "light " << light.light_index << " missing at (" << p.x << ", " << p.y << ", " << p.z << ")";
+            ++checked;
+        }
+    }
+    EXPECT_GT(checked, 100u);
+}
+
+} // anonymous namespace
+
+TEST(LightClusters, ListsAreCompactAndOrdered)
+{
+    const std::vector<Light_cluster_light> lights = make_lights(64, 1);
+    Light_cluster_builder builder;
+    Light_clusters        clusters;
+    builder.build(make_perspective_view(true), lights, Light_cluster_settings{}, clusters);
+
+    ASSERT_EQ(clusters.cluster_ranges.size(), std::size_t{16 * 9 * 24});
+    uint32_t expected_offset = 0;
+    for (const glm::uvec2& range : clusters.cluster_ranges) {
+        EXPECT_EQ(range.x, expected_offset);
+        expected_offset += range.y;
+        for (uint32_t i = 1; i < range.y; ++i) {
+            const uint32_t previous = clusters.light_indices[range.x + i - 1] & ~Light_clusters::spot_light_bit;
+            const uint32_t current  = clusters.light_indices[range.x + i    ] & ~Light_clusters::spot_light_bit;
+            EXPECT_LT(previous, current);
+        }
+    }
+    EXPECT_EQ(expected_offset, clusters.light_indices.size());
+    for (const uint32_t packed : clusters.light_indices) {
+        const uint32_t light_index = packed & ~Light_clusters::spot_light_bit;
+        ASSERT_LT(light_index, lights.size());
+        EXPECT_EQ((packed & Light_clusters::spot_light_bit) != 0, lights[light_index].is_spot);
+    }
+}
+
+TEST(LightClusters, PerspectiveZeroToOneCoversLightRanges)
+{
+    expect_lights_reaching_positions_are_listed(make_perspective_view(true), make_lights(200, 2));
+}
+
+TEST(LightClusters, PerspectiveMinusOneToOneCoversLightRanges)
+{
+    expect_lights_reaching_positions_are_listed(make_perspective_view(false), make_lights(200, 3));
+}
+
+TEST(LightClusters, OrthographicCoversLightRanges)
+{
+    expect_lights_reaching_positions_are_listed(make_ortho_view(), make_lights(200, 4));
+}
+
+TEST(LightClusters, CullsLightsOutsideTheView)
+{
+    const Light_cluster_view view = make_perspective_view(true);
+    const glm::mat4 world_from_view = glm::inverse(view.view_from_world);
+    auto at_view = [&](const glm::vec3& p) { return glm::vec3{world_from_view * glm::vec4{p, 1.0f}}; };
+    const std::vector<Light_cluster_light> lights{
+        {.position_in_world = at_view(glm::vec3{0.0f, 0.0f,   5.0f}), .range = 2.0f, .light_index = 0}, // behind the camera
+        {.position_in_world = at_view(glm::vec3{0.0f, 0.0f, -150.0f}), .range = 5.0f, .light_index = 1}, // beyond z_far
+        {.position_in_world = at_view(glm::vec3{0.0f, 0.0f, -10.0f}), .range = 0.5f, .light_index = 2}, // small, centered
+        {.position_in_world = at_view(glm::vec3{0.0f, 0.0f, -10.0f}), .range = 0.0f, .light_index = 3}  // unbounded
+    };
+    Light_cluster_builder builder;
+    Light_clusters        clusters;
+    builder.build(view, lights, Light_cluster_settings{}, clusters);
+
+    std::size_t small_count     = 0;
+    std::size_t unbounded_count = 0;
+    for (const uint32_t light_index : clusters.light_indices) {
+        EXPECT_NE(light_index, 0u);
+        EXPECT_NE(light_index, 1u);
+        small_count     += (light_index == 2u) ? 1 : 0;
+        unbounded_count += (light_index == 3u) ? 1 : 0;
+    }
+    EXPECT_GT(small_count, 0u);
+    EXPECT_LT(small_count, 16u);
+    EXPECT_EQ(unbounded_count, clusters.get_cluster_count());
+
+    const uint32_t center_cluster = clusters.find_cluster(lights[2].position_in_world);
+    const std::span<const uint32_t> center_lights = clusters.get_cluster_lights(center_cluster);
+    EXPECT_NE(std::find(center_lights.begin(), center_lights.end(), 2u), center_lights.end());
+}
+
+TEST(LightClusters, SingleClusterListsEveryLight)
+{
+    const std::vector<Light_cluster_light> lights = make_lights(20, 5);
+    Light_clusters clusters;
+    erhe::scene_renderer::make_single_light_cluster(lights, clusters);
+
+    ASSERT_EQ(clusters.get_cluster_count(), 1u);
+    const std::span<const uint32_t> cluster_lights = clusters.get_cluster_lights(0);
+    ASSERT_EQ(cluster_lights.size(), lights.size());
+    for (std::size_t i = 0; i < lights.size(); ++i) {
+        EXPECT_EQ(cluster_lights[i] & ~Light_clusters::spot_light_bit, lights[i].light_index);
+        EXPECT_EQ((cluster_lights[i] & Light_clusters::spot_light_bit) != 0, lights[i].is_spot);
+    }
+    for (const glm::vec3 position : {glm::vec3{0.0f}, glm::vec3{-1000.0f, 5.0f, 3.0f}, glm::vec3{1e6f, -1e6f, 1e6f}}) {
+        EXPECT_EQ(clusters.find_cluster(position), 0u);
+    }
+}
+
+// CPU binning cost and how many lights a fragment loops over, flat versus
+// clustered (average over clusters that have lights), at 16 / 256 / 4096
+// lights.
+ERHE_BENCHMARK(LightClusters, build)
+{
+    const Light_cluster_view view = make_perspective_view(true);
+    for (const std::size_t light_count : {std::size_t{16}, std::size_t{256}, std::size_t{4096}}) {
+        const std::vector<Light_cluster_light> lights = make_lights(light_count, 11);
+        Light_cluster_builder builder;
+        Light_clusters        clusters;
+        builder.build(view, lights, Light_cluster_settings{}, clusters); // cluster bounds, first allocation
+
+        constexpr int iteration_count = 50;
+        const double build_ms = erhe::benchmark::time_ms([&]() {
+            for (int i = 0; i < iteration_count; ++i) {
+                builder.build(view, lights, Light_cluster_settings{}, clusters);
+            }
+        }) / iteration_count;
+
+        std::size_t occupied = 0;
+        std::size_t maximum  = 0;
+        for (const glm::uvec2& range : clusters.cluster_ranges) {
+            occupied += (range.y > 0) ? 1 : 0;
+            maximum   = std::max<std::size_t>(maximum, range.y);
+        }
+        const double average = (occupied > 0) ? static_cast<double>(clusters.light_indices.size()) / static_cast<double>(occupied) : 0.0;
+        fmt::print(
+            "{:5} lights: build {:.3f} ms, {} indices, lights per fragment flat {} / clustered avg {:.1f} max {}\n",
+            light_count, build_ms, clusters.light_indices.size(), light_count, average, maximum
+        );
+    }
+}
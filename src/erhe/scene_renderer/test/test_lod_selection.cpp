@@ -0,0 +1,157 @@
+// Screen-space error level of detail selection: the pixel scale taken from
+// the projection, the level picked at and around each threshold, and the
+// hysteresis that keeps an entry at a threshold from alternating levels.
+// Needs no graphics device.
+
+#include "erhe_scene_renderer/draw_list.hpp"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <gtest/gtest.h>
+
+namespace {
+
+using erhe::scene_renderer::Draw_list_entry_lod;
+using erhe::scene_renderer::Draw_list_entry_lods;
+using erhe::scene_renderer::Draw_lod_selection;
+using erhe::scene_renderer::make_lod_selection;
+using erhe::scene_renderer::select_lod_level;
+
+// Two levels with object space errors 0.01 and 0.1. With 500 pixels per
+// world unit at distance 1 and a 1 pixel limit, level 1 is acceptable from
+// distance 5 and level 2 from distance 50.
+auto make_lods() -> Draw_list_entry_lods
+{
+    Draw_list_entry_lods lods{};
+    lods.levels[0]   = Draw_list_entry_lod{.index_count = 300, .first_index = 1000, .error = 0.01f};
+    lods.levels[1]   = Draw_list_entry_lod{.index_count = 30,  .first_index = 1300, .error = 0.1f};
+    lods.level_count = 2;
+    return lods;
+}
+
+auto make_selection(const float hysteresis) -> Draw_lod_selection
+{
+    return Draw_lod_selection{
+        .view_position   = glm::vec3{0.0f},
+        .pixel_scale     = 500.0f,
+        .perspective     = true,
+        .max_pixel_error = 1.0f,
+        .hysteresis      = hysteresis
+    };
+}
+
+// Unit cube whose nearest point is at distance from the origin, along -z
+auto make_bounds_at(const float distance) -> erhe::math::Aabb
+{
+    return erhe::math::Aabb{
+        .min = glm::vec3{-0.5f, -0.5f, -distance - 1.0f},
+        .max = glm::vec3{ 0.5f,  0.5f, -distance}
+    };
+}
+
+TEST(LodSelection, PixelScaleFromProjection)
+{
+    // 90 degree vertical field of view: tan(fov_y / 2) = 1
+    const glm::mat4 perspective = glm::perspective(glm::radians(90.0f), 1.5f, 0.1f, 100.0f);
+    const Draw_lod_selection perspective_selection = make_lod_selection(perspective, glm::vec3{1.0f, 2.0f, 3.0f}, 1000, 2.0f);
+    EXPECT_TRUE(perspective_selection.perspective);
+    EXPECT_FLOAT_EQ(perspective_selection.pixel_scale, 500.0f);
+    EXPECT_FLOAT_EQ(perspective_selection.max_pixel_error, 2.0f);
+    EXPECT_EQ(perspective_selection.view_position, (glm::vec3{1.0f, 2.0f, 3.0f}));
+
+    // 4 world units tall view into 1000 pixels
+    const glm::mat4 orthographic = glm::ortho(-3.0f, 3.0f, -2.0f, 2.0f, 0.1f, 100.0f);
+    const Draw_lod_selection orthographic_selection = make_lod_selection(orthographic, glm::vec3{0.0f}, 1000, 1.0f);
+    EXPECT_FALSE(orthographic_selection.perspective);
+    EXPECT_FLOAT_EQ(orthographic_selection.pixel_scale, 250.0f);
+}
+
+TEST(LodSelection, Thresholds)
+{
+    const Draw_list_entry_lods lods      = make_lods();
+    const Draw_lod_selection   selection = make_selection(0.0f);
+
+    EXPECT_EQ(select_lod_level(selection, lods, make_bounds_at(  1.0f), 0), 0);
+    EXPECT_EQ(select_lod_level(selection, lods, make_bounds_at(  4.9f), 0), 0);
+    EXPECT_EQ(select_lod_level(selection, lods, make_bounds_at(  5.1f), 0), 1);
+    EXPECT_EQ(select_lod_level(selection, lods, make_bounds_at( 49.0f), 0), 1);
+    EXPECT_EQ(select_lod_level(selection, lods, make_bounds_at( 51.0f), 0), 2);
+    EXPECT_EQ(select_lod_level(selection, lods, make_bounds_at(500.0f), 0), 2);
+
+    // Node scale multiplies the error: twice as far for the same level
+    Draw_list_entry_lods scaled_lods = make_lods();
+    scaled_lods.world_scale = 2.0f;
+    EXPECT_EQ(select_lod_level(selection, scaled_lods, make_bounds_at( 51.0f), 0), 1);
+    EXPECT_EQ(select_lod_level(selection, scaled_lods, make_bounds_at(101.0f), 0), 2);
+
+    // A larger pixel budget picks coarser levels closer
+    Draw_lod_selection relaxed = selection;
+    relaxed.max_pixel_error = 10.0f;
+    EXPECT_EQ(select_lod_level(relaxed, lods, make_bounds_at(6.0f), 0), 2);
+}
+
+TEST(LodSelection, FullDetailCases)
+{
+    const Draw_lod_selection selection = make_selection(0.0f);
+
+    // No levels
+    EXPECT_EQ(select_lod_level(selection, Draw_list_entry_lods{}, make_bounds_at(500.0f), 0), 0);
+
+    // View inside the bounds
+    const erhe::math::Aabb around_view{
+        .min = glm::vec3{-1.0f},
+        .max = glm::vec3{ 1.0f}
+    };
+    EXPECT_EQ(select_lod_level(selection, make_lods(), around_view, 0), 0);
+
+    // Bounds not known
+    EXPECT_EQ(select_lod_level(selection, make_lods(), erhe::math::Aabb{}, 0), 0);
+}
+
+TEST(LodSelection, OrthographicIgnoresDistance)
+{
+    Draw_lod_selection selection = make_selection(0.0f);
+    selection.perspective = false;
+    selection.pixel_scale = 20.0f; // level 1 error 0.2 pixels, level 2 error 2 pixels
+    for (const float distance : {0.5f, 5.0f, 500.0f}) {
+        EXPECT_EQ(select_lod_level(selection, make_lods(), make_bounds_at(distance), 0), 1) << "distance " << distance;
+    }
+    // Orthographic views need no bounds either
+    EXPECT_EQ(select_lod_level(selection, make_lods(), erhe::math::Aabb{}, 0), 1);
+}
+
+TEST(LodSelection, HysteresisDelaysCoarserLevels)
+{
+    const Draw_list_entry_lods lods      = make_lods();
+    const Draw_lod_selection   selection = make_selection(0.2f);
+
+    // Level 2 projects to 0.91 pixels at 55: acceptable, but not 20% below
+    // the limit, so an entry drawing level 1 stays there while one already
+    // at level 2 keeps it.
+    EXPECT_EQ(select_lod_level(selection, lods, make_bounds_at(55.0f), 1), 1);
+    EXPECT_EQ(select_lod_level(selection, lods, make_bounds_at(55.0f), 2), 2);
+    // 0.71 pixels at 70: coarser from either level
+    EXPECT_EQ(select_lod_level(selection, lods, make_bounds_at(70.0f), 1), 2);
+    EXPECT_EQ(select_lod_level(selection, lods, make_bounds_at(70.0f), 0), 2);
+
+    // Going finer is immediate: level 2 at 45 is 1.11 pixels
+    EXPECT_EQ(select_lod_level(selection, lods, make_bounds_at(45.0f), 2), 1);
+    EXPECT_EQ(select_lod_level(selection, lods, make_bounds_at( 4.0f), 2), 0);
+
+    // Moving back and forth across the level 2 threshold (50) switches once
+    // each way instead of every frame
+    uint8_t level = 1;
+    int     switch_count = 0;
+    for (int frame = 0; frame < 40; ++frame) {
+        const float   distance = 50.0f + (((frame % 2) == 0) ? 2.0f : -2.0f) + 0.5f * static_cast<float>(frame);
+        const uint8_t selected = select_lod_level(selection, lods, make_bounds_at(distance), level);
+        if (selected != level) {
+            ++switch_count;
+        }
+        level = selected;
+    }
+    EXPECT_EQ(level, 2);
+    EXPECT_EQ(switch_count, 1);
+}
+
+} // anonymous namespace
@@ -0,0 +1,180 @@
+#include "erhe_scheduler/scheduler.hpp"
+
+#include <taskflow/taskflow.hpp>
+
+#include <thread>
+#include <vector>
+
+namespace erhe::scheduler {
+
+auto c_str(const Lane lane) -> const char*
+{
+    switch (lane) {
+        case Lane::e_frame:       return "Frame";
+        case Lane::e_interactive: return "Interactive";
+        case Lane::e_background:  return "Background";
+        default:                  return "?";
+    }
+}
+
+namespace {
+
+[[nodiscard]] auto to_ns(const std::chrono::steady_clock::duration duration) -> std::uint64_t
+{
+    const std::int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+    return (ns > 0) ? static_cast<std::uint64_t>(ns) : 0;
+}
+
+}
+
+Scheduler::Scheduler(tf::Executor& executor)
+    : m_executor        {executor}
+    , m_frame_start_time{std::chrono::steady_clock::now()}
+{
+    m_frame_statistics.worker_count = m_executor.num_workers();
+}
+
+Scheduler::~Scheduler() noexcept
+{
+    // Running jobs hand their lane slot to waiting ones before they finish,
+    // so no job is waiting once nothing is in flight.
+    while (m_in_flight_count.load(std::memory_order_acquire) != 0) {
+        std::this_thread::yield();
+    }
+}
+
+auto Scheduler::get_executor() -> tf::Executor&
+{
+    return m_executor;
+}
+
+auto Scheduler::get_worker_count() const -> std::size_t
+{
+    return m_executor.num_workers();
+}
+
+void Scheduler::set_lane_concurrency(const Lane lane, const std::size_t max_running_jobs)
+{
+    Lane_state& state = m_lanes[static_cast<std::size_t>(lane)];
+    std::vector<std::function<void()>> unblocked;
+    {
+        const std::lock_guard<ERHE_PROFILE_LOCKABLE_BASE(std::mutex)> lock{state.mutex};
+        state.max_running_jobs = max_running_jobs;
+        while (
+            !state.waiting.empty() &&
+            ((state.max_running_jobs == 0) || (state.running_job_count < state.max_running_jobs))
+        ) {
+            unblocked.push_back(std::move(state.waiting.front()));
+            state.waiting.pop_front();
+            ++state.running_job_count;
+        }
+    }
+    for (std::function<void()>& job : unblocked) {
+        launch(lane, std::move(job));
+    }
+}
+
+auto Scheduler::get_lane_concurrency(const Lane lane) const -> std::size_t
+{
+    const Lane_state& state = m_lanes[static_cast<std::size_t>(lane)];
+    const std::lock_guard<ERHE_PROFILE_LOCKABLE_BASE(std::mutex)> lock{state.mutex};
+    return state.max_running_jobs;
+}
+
+void Scheduler::silent_async(const Lane lane, std::function<void()> job)
+{
+    Lane_state& state = m_lanes[static_cast<std::size_t>(lane)];
+    {
+        const std::lock_guard<ERHE_PROFILE_LOCKABLE_BASE(std::mutex)> lock{state.mutex};
+        if ((state.max_running_jobs != 0) && (state.running_job_count >= state.max_running_jobs)) {
+            state.waiting.push_back(std::move(job));
+            state.deferred_count.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        ++state.running_job_count;
+    }
+    launch(lane, std::move(job));
+}
+
+void Scheduler::launch(const Lane lane, std::function<void()>&& job)
+{
+    m_in_flight_count.fetch_add(1, std::memory_order_relaxed);
+    m_executor.silent_async(
+        [this, lane, job = std::move(job)]() mutable {
+            ERHE_PROFILE_SCOPE("scheduler job");
+            Lane_state& state = m_lanes[static_cast<std::size_t>(lane)];
+            std::function<void()> next = std::move(job);
+            for (;;) {
+                const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+                next();
+                state.busy_ns  .fetch_add(to_ns(std::chrono::steady_clock::now() - start_time), std::memory_order_relaxed);
+                state.job_count.fetch_add(1, std::memory_order_relaxed);
+                next = {};
+
+                // Hand the lane slot to the oldest waiting job, on this
+                // worker, or release it.
+                const std::lock_guard<ERHE_PROFILE_LOCKABLE_BASE(std::mutex)> lock{state.mutex};
+                if (
+                    state.waiting.empty() ||
+                    ((state.max_running_jobs != 0) && (state.running_job_count > state.max_running_jobs))
+                ) {
+                    --state.running_job_count;
+                    break;
+                }
+                next = std::move(state.waiting.front());
+                state.waiting.pop_front();
+            }
+            m_in_flight_count.fetch_sub(1, std::memory_order_release);
+        }
+    );
+}
+
+auto Scheduler::get_pending_job_count(const Lane lane) const -> std::size_t
+{
+    const Lane_state& state = m_lanes[static_cast<std::size_t>(lane)];
+    const std::lock_guard<ERHE_PROFILE_LOCKABLE_BASE(std::mutex)> lock{state.mutex};
+    return state.running_job_count + state.waiting.size();
+}
+
+void Scheduler::add_busy_time(const Lane lane, const std::chrono::steady_clock::duration duration)
+{
+    Lane_state& state = m_lanes[static_cast<std::size_t>(lane)];
+    state.busy_ns  .fetch_add(to_ns(duration), std::memory_order_relaxed);
+    state.job_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Scheduler::end_frame()
+{
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    m_frame_statistics.frame_ns     = to_ns(now - m_frame_start_time);
+    m_frame_statistics.worker_count = m_executor.num_workers();
+    m_frame_start_time = now;
+    for (std::size_t i = 0; i < c_lane_count; ++i) {
+        Lane_state&      state      = m_lanes[i];
+        Lane_statistics& statistics = m_frame_statistics.lanes[i];
+        statistics.busy_ns        = state.busy_ns       .exchange(0, std::memory_order_relaxed);
+        statistics.job_count      = state.job_count     .exchange(0, std::memory_order_relaxed);
+        statistics.deferred_count = state.deferred_count.exchange(0, std::memory_order_relaxed);
+    }
+}
+
+auto Scheduler::get_frame_statistics() const -> const Frame_statistics&
+{
+    return m_frame_statistics;
+}
+
+Lane_timer::Lane_timer(Scheduler* const scheduler, const Lane lane)
+    : m_scheduler {scheduler}
+    , m_lane      {lane}
+    , m_start_time{std::chrono::steady_clock::now()}
+{
+}
+
+Lane_timer::~Lane_timer() noexcept
+{
+    if (m_scheduler != nullptr) {
+        m_scheduler->add_busy_time(m_lane, std::chrono::steady_clock::now() - m_start_time);
+    }
+}
+
+} // namespace erhe::scheduler
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "erhe_profile/profile.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+namespace tf {
+    class Executor;
+}
+
+namespace erhe::scheduler {
+
+// Priority lanes of the shared worker pool. All lanes run on the same
+// tf::Executor workers; a lane only decides how many of its jobs may run at
+// the same time and where its run time is accounted.
+enum class Lane : unsigned int {
+    e_frame       = 0, // work the current frame waits for (physics steps, transform propagation)
+    e_interactive = 1, // results the user is waiting for (geometry operations, graph evaluation)
+    e_background  = 2  // everything else (asset loads, scans, streaming reads)
+};
+
+static constexpr std::size_t c_lane_count = 3;
+
+[[nodiscard]] auto c_str(Lane lane) -> const char*;
+
+class Lane_statistics
+{
+public:
+    std::uint64_t busy_ns       {0}; // run time of finished jobs, summed over workers
+    std::uint64_t job_count     {0}; // jobs finished
+    std::uint64_t deferred_count{0}; // jobs that had to wait for a lane slot
+};
+
+class Frame_statistics
+{
+public:
+    std::uint64_t                             frame_ns    {0}; // wall time between end_frame() calls
+    std::size_t                               worker_count{0};
+    std::array<Lane_statistics, c_lane_count> lanes{};
+};
+
+// The one worker pool shared by every subsystem of an application: Jolt
+// physics jobs (erhe::physics::Jolt_job_system), raytrace and scene work
+// (their injected executors) and application tasks such as asset loads.
+//
+// Lanes with a concurrency limit never occupy more than that many workers;
+// further jobs of the lane wait in submission order and are launched as
+// running ones finish. Limiting the background lane keeps workers free for
+// frame work: a long import can not hold every worker while a physics step
+// queues its jobs behind it. Lanes without a limit go straight to the
+// executor. A lane limit does not preempt anything - jobs that are already
+// running always run to completion.
+//
+// Time accounting is per lane: every job submitted through silent_async()
+// (and every Lane_timer scope) adds its run time when it finishes.
+// end_frame() publishes the sums of the frame that ended and starts new
+// ones. Thread safe, except end_frame() and get_frame_statistics(), which
+// belong to the thread that drives frames.
+class Scheduler
+{
+public:
+    explicit Scheduler(tf::Executor& executor);
+    ~Scheduler() noexcept;
+
+    Scheduler(const Scheduler&) = delete;
+    Scheduler& operator=(const Scheduler&) = delete;
+
+    [[nodiscard]] auto get_executor    () -> tf::Executor&;
+    [[nodiscard]] auto get_worker_count() const -> std::size_t;
+
+    // 0 removes the limit. Lowering a limit does not stop running jobs.
+    void               set_lane_concurrency(Lane lane, std::size_t max_running_jobs);
+    [[nodiscard]] auto get_lane_concurrency(Lane lane) const -> std::size_t;
+
+    // Like tf::Executor::silent_async(), in the given lane. The job must not
+    // throw.
+    void silent_async(Lane lane, std::function<void()> job);
+
+    // Jobs of lane that are running or waiting for a lane slot.
+    [[nodiscard]] auto get_pending_job_count(Lane lane) const -> std::size_t;
+
+    // Accounts run time of work that does not go through silent_async(),
+    // such as jobs a subsystem feeds to the executor itself.
+    void add_busy_time(Lane lane, std::chrono::steady_clock::duration duration);
+
+    void               end_frame           ();
+    [[nodiscard]] auto get_frame_statistics() const -> const Frame_statistics&;
+
+private:
+    class Lane_state
+    {
+    public:
+        mutable ERHE_PROFILE_MUTEX(std::mutex, mutex);
+        std::deque<std::function<void()>> waiting;
+        std::size_t                       max_running_jobs{0};
+        std::size_t                       running_job_count{0};
+        std::atomic<std::uint64_t>        busy_ns{0};
+        std::atomic<std::uint64_t>        job_count{0};
+        std::atomic<std::uint64_t>        deferred_count{0};
+    };
+
+    void launch(Lane lane, std::function<void()>&& job);
+
+    tf::Executor&                             m_executor;
+    std::array<Lane_state, c_lane_count>      m_lanes;
+    std::atomic<std::size_t>                  m_in_flight_count{0};
+    std::chrono::steady_clock::time_point     m_frame_start_time;
+    Frame_statistics                          m_frame_statistics;
+};
+
+// Accounts the lifetime of the scope to lane. scheduler may be nullptr.
+class Lane_timer
+{
+public:
+    Lane_timer(Scheduler* scheduler, Lane lane);
+    ~Lane_timer() noexcept;
+
+    Lane_timer(const Lane_timer&) = delete;
+    Lane_timer& operator=(const Lane_timer&) = delete;
+
+private:
+    Scheduler*                            m_scheduler;
+    Lane                                  m_lane;
+    std::chrono::steady_clock::time_point m_start_time;
+};
+
+} // namespace erhe::scheduler
@@ -0,0 +1,174 @@
+// Scheduler lanes: a limited lane never runs more jobs at once than its
+// limit and still runs every job, unlimited lanes bypass it, and the frame
+// statistics account finished jobs to their lane.
+
+#include "erhe_scheduler/scheduler.hpp"
+
+#include <gtest/gtest.h>
+
+#include <taskflow/taskflow.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace {
+
+using erhe::scheduler::Lane;
+using erhe::scheduler::Scheduler;
+
+void wait_for_jobs(const std::atomic<int>& finished_count, const int expected_count)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{10};
+    while ((finished_count.load() < expected_count) && (std::chrono::steady_clock::now() < deadline)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+}
+
+class Concurrency_probe
+{
+public:
+    void enter()
+    {
+        const int running = running_count.fetch_add(1) + 1;
+        int peak = peak_count.load();
+        while ((running > peak) && !peak_count.compare_exchange_weak(peak, running)) {
+        }
+    }
+    void leave()
+    {
+        running_count.fetch_sub(1);
+        finished_count.fetch_add(1);
+    }
+
+    std::atomic<int> running_count {0};
+    std::atomic<int> peak_count    {0};
+    std::atomic<int> finished_count{0};
+};
+
+}
+
+TEST(scheduler, limited_lane_caps_running_jobs)
+{
+    tf::Executor executor{8};
+    Scheduler    scheduler{executor};
+    scheduler.set_lane_concurrency(Lane::e_background, 2);
+
+    constexpr int job_count = 32;
+    Concurrency_probe probe;
+    for (int i = 0; i < job_count; ++i) {
+        scheduler.silent_async(
+            Lane::e_background,
+            [&probe]() {
+                probe.enter();
+                std::this_thread::sleep_for(std::chrono::milliseconds{2});
+                probe.leave();
+            }
+        );
+    }
+    wait_for_jobs(probe.finished_count, job_count);
+    EXPECT_EQ(probe.finished_count.load(), job_count);
+    EXPECT_LE(probe.peak_count.load(), 2);
+    executor.wait_for_all();
+    EXPECT_EQ(scheduler.get_pending_job_count(Lane::e_background), 0u);
+}
+
+TEST(scheduler, unlimited_lane_runs_beside_saturated_limited_lane)
+{
+    tf::Executor executor{4};
+    Scheduler    scheduler{executor};
+    scheduler.set_lane_concurrency(Lane::e_background, 2);
+
+    // Keep the background lane full until the frame job has run.
+    std::atomic<bool> release{false};
+    std::atomic<int>  background_finished{0};
+    for (int i = 0; i < 8; ++i) {
+        scheduler.silent_async(
+            Lane::e_background,
+            [&release, &background_finished]() {
+                while (!release.load()) {
+                    std::this_thread::sleep_for(std::chrono::microseconds{100});
+                }
+                background_finished.fetch_add(1);
+            }
+        );
+    }
+    EXPECT_EQ(scheduler.get_pending_job_count(Lane::e_background), 8u);
+
+    std::atomic<int> frame_finished{0};
+    scheduler.silent_async(Lane::e_frame, [&frame_finished]() { frame_finished.fetch_add(1); });
+    wait_for_jobs(frame_finished, 1);
+    EXPECT_EQ(frame_finished.load(), 1);
+
+    release.store(true);
+    wait_for_jobs(background_finished, 8);
+    EXPECT_EQ(background_finished.load(), 8);
+    executor.wait_for_all();
+}
+
+TEST(scheduler, raising_limit_launches_waiting_jobs)
+{
+    tf::Executor executor{4};
+    Scheduler    scheduler{executor};
+    scheduler.set_lane_concurrency(Lane::e_background, 1);
+
+    std::atomic<bool> release{false};
+    Concurrency_probe probe;
+    for (int i = 0; i < 4; ++i) {
+        scheduler.silent_async(
+            Lane::e_background,
+            [&release, &probe]() {
+                probe.enter();
+                while (!release.load()) {
+                    std::this_thread::sleep_for(std::chrono::microseconds{100});
+                }
+                probe.leave();
+            }
+        );
+    }
+    scheduler.set_lane_concurrency(Lane::e_background, 0);
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{10};
+    while ((probe.running_count.load() < 4) && (std::chrono::steady_clock::now() < deadline)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    EXPECT_EQ(probe.running_count.load(), 4);
+    release.store(true);
+    wait_for_jobs(probe.finished_count, 4);
+    executor.wait_for_all();
+}
+
+TEST(scheduler, frame_statistics_account_jobs_to_their_lane)
+{
+    tf::Executor executor{2};
+    Scheduler    scheduler{executor};
+
+    std::atomic<int> finished_count{0};
+    for (int i = 0; i < 3; ++i) {
+        scheduler.silent_async(
+            Lane::e_interactive,
+            [&finished_count]() {
+                std::this_thread::sleep_for(std::chrono::milliseconds{1});
+                finished_count.fetch_add(1);
+            }
+        );
+    }
+    {
+        erhe::scheduler::Lane_timer timer{&scheduler, Lane::e_frame};
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    wait_for_jobs(finished_count, 3);
+    executor.wait_for_all();
+
+    scheduler.end_frame();
+    const erhe::scheduler::Frame_statistics& statistics = scheduler.get_frame_statistics();
+    EXPECT_EQ(statistics.worker_count, 2u);
+    EXPECT_EQ(statistics.lanes[static_cast<std::size_t>(Lane::e_interactive)].job_count, 3u);
+    EXPECT_GE(statistics.lanes[static_cast<std::size_t>(Lane::e_interactive)].busy_ns, 3'000'000u);
+    EXPECT_EQ(statistics.lanes[static_cast<std::size_t>(Lane::e_frame)].job_count, 1u);
+    EXPECT_GE(statistics.lanes[static_cast<std::size_t>(Lane::e_frame)].busy_ns, 1'000'000u);
+    EXPECT_EQ(statistics.lanes[static_cast<std::size_t>(Lane::e_background)].job_count, 0u);
+
+    // The next frame starts from zero.
+    scheduler.end_frame();
+    EXPECT_EQ(scheduler.get_frame_statistics().lanes[static_cast<std::size_t>(Lane::e_interactive)].job_count, 0u);
+}
@@ -86,6 +86,42 @@ public:
         }
     }
 
+    // Same as post_process() for a 2 component bitmap, limited to a
+    // rectangle, writing tightly packed rows to destination.
+    void post_process(
+        const int                x0,
+        const int                y0,
+        const int                rect_width,
+        const int                rect_height,
+        const std::span<uint8_t> destination
+    ) const
+    {
+        ERHE_VERIFY(m_components == 2);
+        ERHE_VERIFY(destination.size() >= static_cast<std::size_t>(rect_width) * static_cast<std::size_t>(rect_height) * 2);
+        std::size_t offset = 0;
+        for (int y = y0; y < y0 + rect_height; ++y) {
+            for (int x = x0; x < x0 + rect_width; ++x) {
+                const auto inside  = static_cast<float>(get(x, y, 0)) / 255.0f;
+                const auto outside = static_cast<float>(get(x, y, 1)) / 255.0f;
+                const auto alpha   = std::max(inside, outside);
+                const auto color   = inside * alpha; // premultiplied
+                destination[offset++] = static_cast<uint8_t>(color * 255.0f);
+                destination[offset++] = static_cast<uint8_t>(alpha * 255.0f);
+            }
+        }
+    }
+
+    void fill(const int x0, const int y0, const int rect_width, const int rect_height, const value_t value)
+    {
+        for (int y = y0; y < y0 + rect_height; ++y) {
+            for (int x = x0; x < x0 + rect_width; ++x) {
+                for (component_t c = 0; c < m_components; ++c) {
+                    put(x, y, c, value);
+                }
+            }
+        }
+    }
+
     void put(const int x, const int y, const component_t c, const value_t value)
     {
         if (
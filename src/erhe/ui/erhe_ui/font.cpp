@@ -9,6 +9,7 @@
 #include "erhe_graphics/ring_buffer.hpp"
 #include "erhe_graphics/ring_buffer_client.hpp"
 #include "erhe_graphics/ring_buffer_range.hpp"
+#include "erhe_hash/hash.hpp"
 #include "erhe_profile/profile.hpp"
 
 #include <fmt/printf.h>
@@ -25,16 +26,19 @@
 #   include <hb-ft.h>
 #endif
 
-#include <SkylineBinPack.h> // RectangleBinPack
-
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <optional>
 #include <span>
 #include <stdexcept>
 #include <string_view>
+#include <system_error>
 
 namespace erhe::ui {
 
 using erhe::graphics::Texture;
-using std::map;
 using std::shared_ptr;
 using std::unique_ptr;
 using std::make_shared;
@@ -44,6 +48,8 @@ Font::~Font() noexcept
 {
     ERHE_PROFILE_FUNCTION();
 
+    static_cast<void>(save_glyph_cache());
+
 #if defined(ERHE_TEXT_LAYOUT_LIBRARY_HARFBUZZ)
     hb_buffer_destroy(m_harfbuzz_buffer);
     hb_font_destroy(m_harfbuzz_font);
@@ -61,12 +67,14 @@ Font::Font(
     erhe::graphics::Command_buffer& init_command_buffer,
     const std::filesystem::path&    path,
     const unsigned int              size,
-    const float                     outline_thickness
+    const float                     outline_thickness,
+    const bool                      use_glyph_cache_file
 )
-    : m_graphics_device  {graphics_device}
-    , m_path             {path}
-    , m_bolding          {(size > 10) ? 0.5f : 0.0f}
-    , m_outline_thickness{outline_thickness}
+    : m_graphics_device     {graphics_device}
+    , m_use_glyph_cache_file{use_glyph_cache_file}
+    , m_path                {path}
+    , m_bolding             {(size > 10) ? 0.5f : 0.0f}
+    , m_outline_thickness   {outline_thickness}
 {
     ERHE_PROFILE_FUNCTION();
 
@@ -82,13 +90,6 @@ Font::Font(
         m_hint_mode = FT_LOAD_TARGET_LIGHT; // NOLINT(hicpp-signed-bitwise)
     }
 
-    m_chars =
-        " \"\\@#$%&/" // latin
-        "0123456789"
-        "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-        "abcdefghijklmnopqrstuvwxyz"
-        "<>*+-.,:;=!?'`^~_|()[]{}";
-
     m_pixel_size = size;
 
     const bool render_ok = render(init_command_buffer);
@@ -169,184 +170,516 @@ auto Font::render(erhe::graphics::Command_buffer& init_command_buffer) -> bool
 
     m_line_height = std::ceil(static_cast<float>(face->size->metrics.height) / 64.0f);
 
-    using GlyphSet = map<char, unique_ptr<Glyph>>;
-
-    GlyphSet glyphs;
-
-    std::vector<float> outline_sizes;
+    m_outline_sizes.clear();
     for (float outline_thickness = m_outline_thickness;
          outline_thickness > 0.0f;
          outline_thickness -= 10.0f
     ) {
-        outline_sizes.emplace_back(outline_thickness);
+        m_outline_sizes.emplace_back(outline_thickness);
     }
 
-    std::vector<GlyphSet> outline_glyphs_vector(outline_sizes.size());
+    // Glyphs are rasterized on demand (rasterize_glyph()); the atlas starts
+    // empty, or with the glyphs from the glyph cache file.
+    m_texture_width  = c_atlas_size;
+    m_texture_height = c_atlas_size;
+    m_bitmap = make_unique<Bitmap>(m_texture_width, m_texture_height, 2);
+    m_atlas_allocator.reset();
+    m_glyphs.clear();
+    m_pending_glyphs.clear();
+    if (m_use_glyph_cache_file) {
+        static_cast<void>(load_glyph_cache());
+    }
 
-    map<char, Glyph::BitmapLayout> glyph_box; // all glyphs fit inside
+    const erhe::graphics::Texture_create_info create_info{
+        .device      = m_graphics_device,
+        .usage_mask  =
+            erhe::graphics::Image_usage_flag_bit_mask::sampled |
+            erhe::graphics::Image_usage_flag_bit_mask::transfer_dst,
+        .type        = erhe::graphics::Texture_type::texture_2d,
+        .pixelformat = erhe::dataformat::Format::format_8_vec2_unorm,
+        .use_mipmaps = false,
+        .width       = m_texture_width,
+        .height      = m_texture_height,
+        .debug_label = erhe::utility::Debug_label{ fmt::format("Font::m_texture {}", m_path.filename().generic_string())}
+    };
 
-    // First pass: Render glyphs to bitmaps, keep track of glyph box
-    for (auto c : m_chars)
-{
-        const auto uc = static_cast<unsigned char>(c);
-        glyphs[c] = make_unique<Glyph>(m_freetype_library, face, uc, m_bolding, 0.0f, m_hint_mode);
-        const auto glyph = glyphs[c].get();
-        glyph_box[c] = glyphs[c]->bitmap;
-        m_glyph_to_char[glyph->glyph_index] = c;
+    m_texture = std::make_unique<Texture>(m_graphics_device, create_info);
 
-        if (m_outline_thickness == 0.0f) {
-            continue;
-        }
+    // The whole page is uploaded once, so the unused part of the texture is
+    // defined; later uploads only cover new glyphs.
+    const std::size_t                  byte_count = static_cast<std::size_t>(2 * m_texture_width * m_texture_height);
+    erhe::graphics::Ring_buffer_client texture_upload_buffer{m_graphics_device, erhe::graphics::Buffer_target::transfer_src, "font upload"};
+    erhe::graphics::Ring_buffer_range  buffer_range = texture_upload_buffer.acquire(erhe::graphics::Ring_buffer_usage::CPU_write, byte_count);
+    std::span<std::byte>               dst_span     = buffer_range.get_span();
+    m_bitmap->post_process(
+        0,
+        0,
+        m_texture_width,
+        m_texture_height,
+        std::span<std::uint8_t>{reinterpret_cast<std::uint8_t*>(dst_span.data()), byte_count}
+    );
+    buffer_range.bytes_written(byte_count);
+    buffer_range.close();
+
+    // Record the upload into the caller-supplied init cb. The caller
+    // is responsible for ending and submitting the cb (and waiting on
+    // the GPU) before the font texture is sampled.
+    erhe::graphics::Blit_command_encoder encoder{m_graphics_device, init_command_buffer};
+    encoder.copy_from_buffer(
+        buffer_range.get_buffer()->get_buffer(),          // source_buffer
+        buffer_range.get_byte_start_offset_in_buffer(),   // source_offset
+        2 * m_texture_width,                              // source_bytes_per_row
+        2 * m_texture_width * m_texture_height,           // source_bytes_per_image
+        glm::ivec3{m_texture_width, m_texture_height, 1}, // source_size
+        m_texture.get(),                                  // destination_texture
+        0,                                                // destination_slice
+        0,                                                // destination_level
+        glm::ivec3{0, 0, 0}                               // destination_origin
+    );
+
+    buffer_range.release();
+
+    for (auto& [glyph_index, glyph] : m_glyphs) {
+        static_cast<void>(glyph_index);
+        glyph.resident = true;
+    }
+
+    return true;
+}
 
-        auto& box = glyph_box[c];
-        for (size_t i = 0; i < outline_glyphs_vector.size(); ++i) {
-            auto& outline_glyphs = outline_glyphs_vector[i];
-            auto  og             = make_unique<Glyph>(m_freetype_library, face, uc, m_bolding, outline_sizes[i], m_hint_mode);
-            box.left   = std::min(box.left,   og->bitmap.left);
-            box.right  = std::max(box.right,  og->bitmap.right);
-            box.top    = std::max(box.top,    og->bitmap.top);
-            box.bottom = std::min(box.bottom, og->bitmap.bottom);
-            outline_glyphs[c] = std::move(og);
+auto Font::get_glyph(const uint32_t glyph_index) -> const Cached_glyph*
+{
+    const std::uint64_t frame = m_graphics_device.get_frame_index();
+    const auto i = m_glyphs.find(glyph_index);
+    if (i != m_glyphs.end()) {
+        Cached_glyph& glyph = i->second;
+        const bool has_pixels = (glyph.width != 0) && (glyph.height != 0);
+        if (!has_pixels || glyph.atlas.is_valid() || (glyph.last_used_frame == frame)) {
+            glyph.last_used_frame = frame;
+            return &glyph;
         }
+        // Did not fit into the atlas in an earlier frame - try again
+        m_glyphs.erase(i);
+    }
+    return rasterize_glyph(glyph_index, frame);
+}
+
+auto Font::rasterize_glyph(const uint32_t glyph_index, const std::uint64_t frame) -> const Cached_glyph*
+{
+    ERHE_PROFILE_FUNCTION();
+
+    if (m_bitmap == nullptr) {
+        return nullptr;
     }
 
-    // Second pass: Search pack resolution
-    rbp::SkylineBinPack packer;
-    m_texture_width  = 2;
-    m_texture_height = 2;
-    for (;;) {
+    FT_Face face = m_freetype_face;
+    const Glyph glyph{m_freetype_library, face, glyph_index, m_bolding, 0.0f, m_hint_mode};
+
+    // Box where the glyph and all its outlines fit
+    Glyph::BitmapLayout box = glyph.bitmap;
+    std::vector<unique_ptr<Glyph>> outline_glyphs;
+    for (const float outline_size : m_outline_sizes) {
+        auto og = make_unique<Glyph>(m_freetype_library, face, glyph_index, m_bolding, outline_size, m_hint_mode);
+        box.left   = std::min(box.left,   og->bitmap.left);
+        box.right  = std::max(box.right,  og->bitmap.right);
+        box.top    = std::max(box.top,    og->bitmap.top);
+        box.bottom = std::min(box.bottom, og->bitmap.bottom);
+        outline_glyphs.push_back(std::move(og));
+    }
+
+    Cached_glyph entry{
+        .width           = box.right - box.left,
+        .height          = box.top   - box.bottom,
+        .g_bottom        = glyph.bitmap.bottom,
+        .g_top           = glyph.bitmap.top,
+        .b_left          = box.left,
+        .b_bottom        = box.bottom,
+        .b_top           = box.top,
+        .atlas           = {},
+        .last_used_frame = frame,
+        .resident        = false
+    };
+
+    if ((entry.width != 0) && (entry.height != 0)) {
         // Reserve 1 pixel border
-        packer.Init(m_texture_width - 2, m_texture_height - 2, false);
-
-        bool pack_failed = false;
-        for (auto c : m_chars) {
-            const auto& box = glyph_box[c];
-            const int width  = box.right - box.left;
-            const int height = box.top   - box.bottom;
-            if (width == 0 || height == 0) {
-                glyphs[c]->atlas_rect = {};
-                continue;
+        entry.atlas = allocate_atlas_rect(entry.width + 1, entry.height + 1, frame);
+        if (entry.atlas.is_valid()) {
+            const Shelf_allocator::Allocation& r = entry.atlas;
+            m_bitmap->fill(r.x, r.y, r.width, r.height, 0); // may hold an evicted glyph
+            m_bitmap->blit<false>(
+                glyph.bitmap.width,
+                glyph.bitmap.height,
+                r.x + 1 + std::max(0, glyph.bitmap.left   - box.left  ),
+                r.y + 1 + std::max(0, glyph.bitmap.bottom - box.bottom),
+                glyph.buffer(),
+                glyph.bitmap.pitch,
+                glyph.bitmap.width,
+                1,
+                0,
+                false
+            );
+            for (const auto& og : outline_glyphs) {
+                m_bitmap->blit<true>(
+                    og->bitmap.width,
+                    og->bitmap.height,
+                    r.x + 1 + std::max(0, og->bitmap.left   - box.left  ),
+                    r.y + 1 + std::max(0, og->bitmap.bottom - box.bottom),
+                    og->buffer(),
+                    og->bitmap.pitch,
+                    og->bitmap.width,
+                    1,
+                    1,
+                    false
+                );
             }
+            m_pending_glyphs.push_back(glyph_index);
+        } else if (!m_atlas_full_reported) {
+            log_font->warn(
+                "Font {} glyph atlas is full, glyph {} ({} x {}) is not shown",
+                m_path.filename().string(),
+                glyph_index,
+                entry.width,
+                entry.height
+            );
+            m_atlas_full_reported = true;
+        }
+    }
+
+    m_glyph_cache_dirty = true;
+    const auto [i, inserted] = m_glyphs.insert_or_assign(glyph_index, entry);
+    static_cast<void>(inserted);
+    return &i->second;
+}
 
-            glyphs[c]->atlas_rect = packer.Insert(width + 1, height + 1, rbp::SkylineBinPack::LevelBottomLeft);
-            if (
-                (glyphs[c]->atlas_rect.width  == 0) ||
-                (glyphs[c]->atlas_rect.height == 0)
-            ) {
-                pack_failed = true;
-                break;
+auto Font::allocate_atlas_rect(const int width, const int height, const std::uint64_t frame) -> Shelf_allocator::Allocation
+{
+    Shelf_allocator::Allocation allocation = m_atlas_allocator.allocate(width, height);
+    if (allocation.is_valid()) {
+        return allocation;
+    }
+
+    // Evict least recently used glyphs until the rectangle fits. Glyphs
+    // used in recent frames are kept: frames in flight may still sample
+    // them, and the upload would overwrite their pixels.
+    std::vector<Shelf_allocator::Lru_entry> entries;
+    entries.reserve(m_glyphs.size());
+    for (const auto& [glyph_index, glyph] : m_glyphs) {
+        entries.push_back(
+            Shelf_allocator::Lru_entry{
+                .last_used_frame = glyph.last_used_frame,
+                .key             = glyph_index,
+                .allocation      = glyph.atlas
             }
+        );
+    }
+    std::vector<std::uint32_t> evicted_glyphs;
+    allocation = m_atlas_allocator.allocate_evicting_lru(width, height, frame, c_eviction_frame_delay, std::move(entries), evicted_glyphs);
+    for (const std::uint32_t glyph_index : evicted_glyphs) {
+        m_glyphs.erase(glyph_index);
+    }
+    if (!evicted_glyphs.empty()) {
+        log_font->trace("Font {} evicted {} glyphs", m_path.filename().string(), evicted_glyphs.size());
+    }
+    return allocation;
+}
+
+void Font::upload_glyphs(erhe::graphics::Command_buffer& command_buffer)
+{
+    if (m_pending_glyphs.empty() || !m_texture) {
+        return;
+    }
+
+    ERHE_PROFILE_FUNCTION();
+
+    class Upload_rect
+    {
+    public:
+        int         x     {0};
+        int         y     {0};
+        int         width {0};
+        int         height{0};
+        std::size_t offset{0};
+    };
+    std::vector<Upload_rect> rects;
+    rects.reserve(m_pending_glyphs.size());
+    for (const uint32_t glyph_index : m_pending_glyphs) {
+        const auto i = m_glyphs.find(glyph_index);
+        if ((i == m_glyphs.end()) || i->second.resident || !i->second.atlas.is_valid()) {
+            continue; // evicted, or pending twice
         }
+        const Shelf_allocator::Allocation& r = i->second.atlas;
+        rects.push_back(Upload_rect{.x = r.x, .y = r.y, .width = r.width, .height = r.height});
+        i->second.resident = true;
+    }
+    m_pending_glyphs.clear();
+    if (rects.empty()) {
+        return;
+    }
 
-        if (!pack_failed) {
-            break;
+    if (rects.size() > c_max_upload_rect_count) {
+        int x0 = m_texture_width;
+        int y0 = m_texture_height;
+        int x1 = 0;
+        int y1 = 0;
+        for (const Upload_rect& rect : rects) {
+            x0 = std::min(x0, rect.x);
+            y0 = std::min(y0, rect.y);
+            x1 = std::max(x1, rect.x + rect.width);
+            y1 = std::max(y1, rect.y + rect.height);
         }
+        rects.clear();
+        rects.push_back(Upload_rect{.x = x0, .y = y0, .width = x1 - x0, .height = y1 - y0});
+    }
+
+    // One staging range for all rectangles, each starting at an aligned offset
+    constexpr std::size_t alignment = 16;
+    std::size_t byte_count = 0;
+    for (Upload_rect& rect : rects) {
+        rect.offset = byte_count;
+        byte_count += (static_cast<std::size_t>(2 * rect.width * rect.height) + alignment - 1) & ~(alignment - 1);
+    }
+
+    erhe::graphics::Ring_buffer_client texture_upload_buffer{m_graphics_device, erhe::graphics::Buffer_target::transfer_src, "font glyph upload"};
+    erhe::graphics::Ring_buffer_range  buffer_range = texture_upload_buffer.acquire(erhe::graphics::Ring_buffer_usage::CPU_write, byte_count);
+    std::span<std::byte>               dst_span     = buffer_range.get_span();
+    for (const Upload_rect& rect : rects) {
+        const std::size_t rect_byte_count = static_cast<std::size_t>(2 * rect.width * rect.height);
+        m_bitmap->post_process(
+            rect.x,
+            rect.y,
+            rect.width,
+            rect.height,
+            std::span<std::uint8_t>{reinterpret_cast<std::uint8_t*>(dst_span.data() + rect.offset), rect_byte_count}
+        );
+    }
+    buffer_range.bytes_written(byte_count);
+    buffer_range.close();
+
+    erhe::graphics::Blit_command_encoder encoder{m_graphics_device, command_buffer};
+    for (const Upload_rect& rect : rects) {
+        encoder.copy_from_buffer(
+            buffer_range.get_buffer()->get_buffer(),                      // source_buffer
+            buffer_range.get_byte_start_offset_in_buffer() + rect.offset, // source_offset
+            2 * rect.width,                                               // source_bytes_per_row
+            2 * rect.width * rect.height,                                 // source_bytes_per_image
+            glm::ivec3{rect.width, rect.height, 1},                       // source_size
+            m_texture.get(),                                              // destination_texture
+            0,                                                            // destination_slice
+            0,                                                            // destination_level
+            glm::ivec3{rect.x, rect.y, 0}                                 // destination_origin
+        );
+    }
+    buffer_range.release();
+}
 
-        if (m_texture_width <= m_texture_height) {
-            m_texture_width *= 2;
-        } else {
-            m_texture_height *= 2;
+// Glyph cache file
+//
+// Everything that affects rasterization is hashed into the file name, so a
+// file is only ever read by a Font that would produce the same pixels:
+//
+//   uint32 magic, uint32 version, uint32 glyph count
+//   per glyph: uint32 glyph index, int32 width, height, g_bottom, g_top,
+//              b_left, b_bottom, b_top, then (width + 1) * (height + 1) * 2
+//              bytes of unprocessed atlas pixels (none when width or height
+//              is zero)
+//
+// Glyphs are stored most recently used first, so if the atlas would not
+// hold them all, the most used ones are kept.
+namespace {
+
+constexpr std::uint32_t c_glyph_cache_magic  {0x48504c47u}; // "GLPH"
+constexpr std::uint32_t c_glyph_cache_version{1};
+
+template <typename T>
+void append_value(std::vector<std::uint8_t>& bytes, const T value)
+{
+    const std::size_t offset = bytes.size();
+    bytes.resize(offset + sizeof(T));
+    memcpy(bytes.data() + offset, &value, sizeof(T));
+}
+
+template <typename T>
+[[nodiscard]] auto read_value(const std::string& bytes, std::size_t& offset, T& value) -> bool
+{
+    if (offset + sizeof(T) > bytes.size()) {
+        return false;
+    }
+    memcpy(&value, bytes.data() + offset, sizeof(T));
+    offset += sizeof(T);
+    return true;
+}
+
+} // anonymous namespace
+
+auto Font::get_glyph_cache_path() const -> std::filesystem::path
+{
+    uint64_t key = erhe::hash::hash(m_font_data.data(), m_font_data.size());
+    key = erhe::hash::hash(static_cast<uint64_t>(c_glyph_cache_version), key);
+    key = erhe::hash::hash(static_cast<uint64_t>(c_atlas_size),          key);
+    key = erhe::hash::hash(static_cast<uint64_t>(m_pixel_size),          key);
+    key = erhe::hash::hash(static_cast<uint64_t>(m_dpi),                 key);
+    key = erhe::hash::hash(static_cast<uint64_t>(m_hint_mode),           key);
+    key = erhe::hash::hash(m_bolding,                                    key);
+    key = erhe::hash::hash(m_outline_thickness,                          key);
+    return
+        std::filesystem::path{"cache"} /
+        std::filesystem::path{"fonts"} /
+        std::filesystem::path{fmt::format("{}_{}_{:016x}.glyphs", m_path.stem().string(), m_pixel_size, key)};
+}
+
+auto Font::load_glyph_cache() -> bool
+{
+    ERHE_PROFILE_FUNCTION();
+
+    const std::filesystem::path path = get_glyph_cache_path();
+    std::error_code error_code{};
+    if (!std::filesystem::is_regular_file(path, error_code)) {
+        return false;
+    }
+    const std::optional<std::string> data = erhe::file::read("Font glyph cache", path);
+    if (!data.has_value()) {
+        return false;
+    }
+    const std::string& bytes = data.value();
+
+    std::size_t   offset     {0};
+    std::uint32_t magic      {0};
+    std::uint32_t version    {0};
+    std::uint32_t glyph_count{0};
+    if (
+        !read_value(bytes, offset, magic)      || (magic   != c_glyph_cache_magic) ||
+        !read_value(bytes, offset, version)    || (version != c_glyph_cache_version) ||
+        !read_value(bytes, offset, glyph_count)
+    ) {
+        log_font->warn("Ignoring glyph cache file '{}' with unexpected header", path.string());
+        return false;
+    }
+
+    for (std::uint32_t n = 0; n < glyph_count; ++n) {
+        std::uint32_t glyph_index{0};
+        Cached_glyph  glyph{};
+        const bool header_ok =
+            read_value(bytes, offset, glyph_index)    &&
+            read_value(bytes, offset, glyph.width)    &&
+            read_value(bytes, offset, glyph.height)   &&
+            read_value(bytes, offset, glyph.g_bottom) &&
+            read_value(bytes, offset, glyph.g_top)    &&
+            read_value(bytes, offset, glyph.b_left)   &&
+            read_value(bytes, offset, glyph.b_bottom) &&
+            read_value(bytes, offset, glyph.b_top);
+        const bool size_ok =
+            header_ok &&
+            (glyph.width  >= 0) && (glyph.width  < c_atlas_size) &&
+            (glyph.height >= 0) && (glyph.height < c_atlas_size);
+        const bool has_pixels = size_ok && (glyph.width != 0) && (glyph.height != 0);
+        const std::size_t pixel_byte_count = has_pixels
+            ? static_cast<std::size_t>(2 * (glyph.width + 1) * (glyph.height + 1))
+            : 0;
+        if (!size_ok || (offset + pixel_byte_count > bytes.size())) {
+            log_font->warn("Ignoring truncated glyph cache file '{}'", path.string());
+            m_glyphs.clear();
+            m_atlas_allocator.reset();
+            m_bitmap->fill(0);
+            return false;
         }
+        if (has_pixels) {
+            glyph.atlas = m_atlas_allocator.allocate(glyph.width + 1, glyph.height + 1);
+            if (!glyph.atlas.is_valid()) {
+                offset += pixel_byte_count;
+                continue; // Rasterized again when used
+            }
+            const Shelf_allocator::Allocation& r = glyph.atlas;
+            for (int y = r.y; y < r.y + r.height; ++y) {
+                for (int x = r.x; x < r.x + r.width; ++x) {
+                    m_bitmap->put(x, y, 0, static_cast<std::uint8_t>(bytes[offset++]));
+                    m_bitmap->put(x, y, 1, static_cast<std::uint8_t>(bytes[offset++]));
+                }
+            }
+        }
+        m_glyphs.insert_or_assign(glyph_index, glyph);
+    }
+
+    m_glyph_cache_dirty = false;
+    log_font->debug("Read {} glyphs from glyph cache file '{}'", m_glyphs.size(), path.string());
+    return true;
+}
 
-        ERHE_VERIFY(m_texture_width <= 16384);
+auto Font::save_glyph_cache() -> bool
+{
+    if (!m_use_glyph_cache_file || !m_glyph_cache_dirty || !m_bitmap) {
+        return false;
     }
 
-    log_font->trace("packing glyps to {} x {} succeeded", m_texture_width, m_texture_height);
+    ERHE_PROFILE_FUNCTION();
 
-    // Third pass: render glyphs
-    m_bitmap = make_unique<Bitmap>(m_texture_width, m_texture_height, 2);
-    m_bitmap->fill(0);
-    for (auto c : m_chars) {
-        auto uc = static_cast<unsigned char>(c);
-        if (!glyphs[c]) {
+    std::vector<std::pair<std::uint64_t, uint32_t>> order;
+    order.reserve(m_glyphs.size());
+    for (const auto& [glyph_index, glyph] : m_glyphs) {
+        const bool has_pixels = (glyph.width != 0) && (glyph.height != 0);
+        if (has_pixels && !glyph.atlas.is_valid()) {
             continue;
         }
-        auto  g          = glyphs[c].get();
-        auto& box        = glyph_box[c];
-        int   box_width  = box.right - box.left;
-        int   box_height = box.top   - box.bottom;
-        bool  render     = (box_width != 0) && (box_height != 0);
-
-        const auto& r = g->atlas_rect;
-        log_font->trace("char '{}' blit size {} * {}", c, face->glyph->bitmap.width, face->glyph->bitmap.rows);
-
-        bool  rotated = (r.width != r.height) && ((box_width + 1) == r.height) && ((box_height + 1) == r.width);
-        float x_scale = 1.0f / static_cast<float>(m_texture_width);
-        float y_scale = 1.0f / static_cast<float>(m_texture_height);
-        auto  fx      = static_cast<float>(r.x) + 1.0f;
-        auto  fy      = static_cast<float>(r.y) + 1.0f;
-        auto  fw      = static_cast<float>(box_width);
-        auto  fh      = static_cast<float>(box_height);
-
-        ft_char d;
-        d.width    = box_width;
-        d.height   = box_height;
-        d.g_left   = g->bitmap.left;
-        d.g_bottom = g->bitmap.bottom;
-        d.g_top    = g->bitmap.top;
-        d.g_height = g->bitmap.height;
-        d.b_left   = box.left;  // g->bitmap.left    - x_extra;
-        d.b_bottom = box.bottom;// g->bitmap.bottom  - y_extra;
-        d.b_top    = box.top;
-        d.rotated  = rotated;
-
-        if (!rotated) {
-            d.u[0] =  fx       * x_scale;
-            d.v[0] =  fy       * y_scale;
-            d.u[1] = (fx + fw) * x_scale;
-            d.v[1] =  fy       * y_scale;
-            d.u[2] = (fx + fw) * x_scale;
-            d.v[2] = (fy + fh) * y_scale;
-            d.u[3] =  fx       * x_scale;
-            d.v[3] = (fy + fh) * y_scale;
-        } else {
-            d.u[0] = (fx + fh) * x_scale;
-            d.v[0] =  fy       * y_scale;
-            d.u[1] = (fx + fh) * x_scale;
-            d.v[1] = (fy + fw) * y_scale;
-            d.u[2] =  fx       * x_scale;
-            d.v[2] = (fy + fw) * y_scale;
-            d.u[3] =  fx       * x_scale;
-            d.v[3] =  fy       * y_scale;
+        order.emplace_back(glyph.last_used_frame, glyph_index);
+    }
+    std::sort(order.begin(), order.end(), std::greater<>{});
+
+    std::vector<std::uint8_t> bytes;
+    append_value(bytes, c_glyph_cache_magic);
+    append_value(bytes, c_glyph_cache_version);
+    append_value(bytes, static_cast<std::uint32_t>(order.size()));
+    for (const auto& [last_used_frame, glyph_index] : order) {
+        static_cast<void>(last_used_frame);
+        const Cached_glyph& glyph = m_glyphs.at(glyph_index);
+        append_value(bytes, glyph_index);
+        append_value(bytes, glyph.width);
+        append_value(bytes, glyph.height);
+        append_value(bytes, glyph.g_bottom);
+        append_value(bytes, glyph.g_top);
+        append_value(bytes, glyph.b_left);
+        append_value(bytes, glyph.b_bottom);
+        append_value(bytes, glyph.b_top);
+        if (!glyph.atlas.is_valid()) {
+            continue;
         }
-        if (render) {
-            m_bitmap->blit<false>(
-                g->bitmap.width,
-                g->bitmap.height,
-                r.x + 1 + std::max(0, rotated ? (g->bitmap.bottom - box.bottom) : (g->bitmap.left   - box.left  )),
-                r.y + 1 + std::max(0, rotated ? (g->bitmap.left   - box.left  ) : (g->bitmap.bottom - box.bottom)),
-                g->buffer(),
-                g->bitmap.pitch,
-                g->bitmap.width,
-                1,
-                0,
-                rotated
-            );
-            if (m_outline_thickness > 0.0f) {
-                for (auto& outline_glyphs : outline_glyphs_vector) {
-                    const auto og = outline_glyphs[c].get();
-                    m_bitmap->blit<true>(
-                        og->bitmap.width,
-                        og->bitmap.height,
-                        r.x + 1 + std::max(0, rotated ? (og->bitmap.bottom - box.bottom) : (og->bitmap.left   - box.left  )),
-                        r.y + 1 + std::max(0, rotated ? (og->bitmap.left   - box.left  ) : (og->bitmap.bottom - box.bottom)),
-                        og->buffer(),
-                        og->bitmap.pitch,
-                        og->bitmap.width,
-                        1,
-                        1,
-                        rotated
-                    );
-                }
+        const Shelf_allocator::Allocation& r = glyph.atlas;
+        for (int y = r.y; y < r.y + r.height; ++y) {
+            for (int x = r.x; x < r.x + r.width; ++x) {
+                bytes.push_back(m_bitmap->get(x, y, 0));
+                bytes.push_back(m_bitmap->get(x, y, 1));
             }
         }
-        m_chars_256[uc] = d;
     }
 
-    post_process(init_command_buffer);
-
+    const std::filesystem::path path = get_glyph_cache_path();
+    if (!erhe::file::ensure_directory_exists(path.parent_path())) {
+        return false;
+    }
+    // Write to a temporary file and rename, so a reader never sees a
+    // partial file, as in the other caches under cache/.
+    const std::filesystem::path temp_path = path.parent_path() / std::filesystem::path{path.filename().string() + ".tmp"};
+    {
+        std::ofstream out{temp_path, std::ofstream::binary};
+        if (!out) {
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        out.close();
+        if (!out) {
+            std::error_code discarded_error_code{};
+            std::filesystem::remove(temp_path, discarded_error_code);
+            return false;
+        }
+    }
+    std::error_code error_code{};
+    std::filesystem::rename(temp_path, path, error_code);
+    if (error_code) {
+        std::error_code discarded_error_code{};
+        std::filesystem::remove(temp_path, discarded_error_code);
+        return false;
+    }
+    m_glyph_cache_dirty = false;
+    log_font->debug("Wrote {} glyphs to glyph cache file '{}'", order.size(), path.string());
     return true;
-    //m_bitmap->dump();
 }
 
 namespace {
@@ -463,71 +796,17 @@ Font::Font(
     erhe::graphics::Command_buffer& /*init_command_buffer*/,
     const std::filesystem::path&,
     const unsigned int,
-    const float
+    const float,
+    const bool
 )
     : m_graphics_device{graphics_device}
 {}
 auto Font::render(erhe::graphics::Command_buffer& /*init_command_buffer*/) -> bool { return false; }
-void Font::post_process(erhe::graphics::Command_buffer& /*init_command_buffer*/) {}
+void Font::upload_glyphs(erhe::graphics::Command_buffer& /*command_buffer*/) {}
+auto Font::save_glyph_cache() -> bool { return false; }
 void Font::trace_info() const {}
 #endif
 
-#if defined(ERHE_FONT_RASTERIZATION_LIBRARY_FREETYPE) && defined(ERHE_TEXT_LAYOUT_LIBRARY_HARFBUZZ)
-void Font::post_process(erhe::graphics::Command_buffer& init_command_buffer)
-{
-    ERHE_PROFILE_FUNCTION();
-
-    Bitmap bm{
-        m_bitmap->width(),
-        m_bitmap->height(),
-        m_bitmap->components()
-    };
-    m_bitmap->post_process(bm, m_gamma);
-
-    const erhe::graphics::Texture_create_info create_info{
-        .device      = m_graphics_device,
-        .usage_mask  =
-            erhe::graphics::Image_usage_flag_bit_mask::sampled |
-            erhe::graphics::Image_usage_flag_bit_mask::transfer_dst,
-        .type        = erhe::graphics::Texture_type::texture_2d,
-        .pixelformat = erhe::dataformat::Format::format_8_vec2_unorm,
-        .use_mipmaps = false,
-        .width       = m_texture_width,
-        .height      = m_texture_height,
-        .debug_label = erhe::utility::Debug_label{ fmt::format("Font::m_texture {}", m_path.filename().generic_string())}
-    };
-
-    m_texture = std::make_unique<Texture>(m_graphics_device, create_info);
-
-    std::span<std::uint8_t>            src_span   = bm.as_span();
-    std::size_t                        byte_count = src_span.size_bytes();
-    erhe::graphics::Ring_buffer_client texture_upload_buffer{m_graphics_device, erhe::graphics::Buffer_target::transfer_src, "font upload"};
-    erhe::graphics::Ring_buffer_range  buffer_range = texture_upload_buffer.acquire(erhe::graphics::Ring_buffer_usage::CPU_write, byte_count);
-    std::span<std::byte>               dst_span     = buffer_range.get_span();
-    memcpy(dst_span.data(), src_span.data(), byte_count);
-    buffer_range.bytes_written(byte_count);
-    buffer_range.close();
-
-    // Record the upload into the caller-supplied init cb. The caller
-    // is responsible for ending and submitting the cb (and waiting on
-    // the GPU) before the font texture is sampled.
-    erhe::graphics::Blit_command_encoder encoder{m_graphics_device, init_command_buffer};
-    encoder.copy_from_buffer(
-        buffer_range.get_buffer()->get_buffer(),          // source_buffer
-        buffer_range.get_byte_start_offset_in_buffer(),   // source_offset
-        2 * m_texture_width,                              // source_bytes_per_row
-        2 * m_texture_width * m_texture_height,           // source_bytes_per_image
-        glm::ivec3{m_texture_width, m_texture_height, 1}, // source_size
-        m_texture.get(),                                  // destination_texture
-        0,                                                // destination_slice
-        0,                                                // destination_level
-        glm::ivec3{0, 0, 0}                               // destination_origin
-    );
-
-    buffer_range.release();
-}
-#endif
-
 // https://en.wikipedia.org/wiki/List_of_typographic_features
 
 // Default
@@ -560,7 +839,7 @@ auto Font::print(
     const uint32_t      text_color,
     Rectangle&          out_bounds,
     const float         y_scale
-) const -> size_t
+) -> size_t
 {
     if ((text_position.z < -1.0f) || (text_position.z >  1.0f))
     {
@@ -608,28 +887,32 @@ auto Font::print(
         const int  y_offset  = glyph_pos[i].y_offset  / 64;
         const int  x_advance = glyph_pos[i].x_advance / 64;
         const int  y_advance = glyph_pos[i].y_advance / 64;
-        auto j = m_glyph_to_char.find(glyph_id);
-        if (j != m_glyph_to_char.end()) {
-            auto c = j->second;
-            auto uc = static_cast<unsigned char>(c);
-            const ft_char& font_char = m_chars_256[uc];
-            if (font_char.width != 0) {
+        const Cached_glyph* font_char = get_glyph(glyph_id);
+        // Glyphs rasterized this frame are drawn once upload_glyphs() has
+        // copied them to the texture
+        if ((font_char != nullptr) && font_char->resident) {
+            if (font_char->width != 0) {
 
                 if (glyph_space_remaining-- == 0) {
                     return chars_printed;
                 }
 
-                const int b  = font_char.g_bottom - font_char.b_bottom;
-                const int t  = font_char.g_top    - font_char.b_top;
-                const int w  = font_char.width;
-                const int h  = font_char.height;
-                const int ox = font_char.b_left;
-                const int oy = static_cast<int>(static_cast<float>(font_char.b_bottom + t + b) * y_scale);
+                const int b  = font_char->g_bottom - font_char->b_bottom;
+                const int t  = font_char->g_top    - font_char->b_top;
+                const int w  = font_char->width;
+                const int h  = font_char->height;
+                const int ox = font_char->b_left;
+                const int oy = static_cast<int>(static_cast<float>(font_char->b_bottom + t + b) * y_scale);
                 const int x0 = static_cast<int>(text_position.x) + x_offset + ox;
                 const int y0 = static_cast<int>(text_position.y) + y_offset + oy;
                 const int x1 = x0 + w;
                 const int y1 = y0 + static_cast<int>(static_cast<float>(h) * y_scale);
 
+                const float u0 = static_cast<float>(font_char->atlas.x + 1    ) / static_cast<float>(m_texture_width);
+                const float v0 = static_cast<float>(font_char->atlas.y + 1    ) / static_cast<float>(m_texture_height);
+                const float u1 = static_cast<float>(font_char->atlas.x + 1 + w) / static_cast<float>(m_texture_width);
+                const float v1 = static_cast<float>(font_char->atlas.y + 1 + h) / static_cast<float>(m_texture_height);
+
                 //  3---2
                 //  |  /|
                 //  | / |
@@ -639,22 +922,22 @@ auto Font::print(
                 uint_data[word_offset++] = erhe::dataformat::pack_int2x16(x0, y0);
                 uint_data[word_offset++] = text_position_zw;
                 uint_data[word_offset++] = text_color;
-                uint_data[word_offset++] = erhe::dataformat::pack_unorm2x16(font_char.u[0], font_char.v[0]);
+                uint_data[word_offset++] = erhe::dataformat::pack_unorm2x16(u0, v0);
 
                 uint_data[word_offset++] = erhe::dataformat::pack_int2x16(x1, y0);
                 uint_data[word_offset++] = text_position_zw;
                 uint_data[word_offset++] = text_color;
-                uint_data[word_offset++] = erhe::dataformat::pack_unorm2x16(font_char.u[1], font_char.v[1]);
+                uint_data[word_offset++] = erhe::dataformat::pack_unorm2x16(u1, v0);
 
                 uint_data[word_offset++] = erhe::dataformat::pack_int2x16(x1, y1);
                 uint_data[word_offset++] = text_position_zw;
                 uint_data[word_offset++] = text_color;
-                uint_data[word_offset++] = erhe::dataformat::pack_unorm2x16(font_char.u[2], font_char.v[2]);
+                uint_data[word_offset++] = erhe::dataformat::pack_unorm2x16(u1, v1);
 
                 uint_data[word_offset++] = erhe::dataformat::pack_int2x16(x0, y1);
                 uint_data[word_offset++] = text_position_zw;
                 uint_data[word_offset++] = text_color;
-                uint_data[word_offset++] = erhe::dataformat::pack_unorm2x16(font_char.u[3], font_char.v[3]);
+                uint_data[word_offset++] = erhe::dataformat::pack_unorm2x16(u0, v1);
 
                 out_bounds.extend_by(static_cast<float>(x0), static_cast<float>(y0));
                 out_bounds.extend_by(static_cast<float>(x1), static_cast<float>(y1));
@@ -668,7 +951,7 @@ auto Font::print(
     return chars_printed;
 }
 
-auto Font::get_glyph_count(const std::string_view text) const -> size_t
+auto Font::get_glyph_count(const std::string_view text) -> size_t
 {
     if (text.empty()) {
         return 0;
@@ -692,22 +975,17 @@ auto Font::get_glyph_count(const std::string_view text) const -> size_t
 
     std::size_t chars_printed{0};
     for (unsigned int i = 0; i < glyph_count; ++i) {
-        const auto glyph_id = glyph_info[i].codepoint;
-        auto j = m_glyph_to_char.find(glyph_id);
-        if (j != m_glyph_to_char.end()) {
-            auto c = j->second;
-            auto uc = static_cast<unsigned char>(c);
-            const ft_char& font_char = m_chars_256[uc];
-            if (font_char.width != 0) {
-                ++chars_printed;
-            }
+        const auto          glyph_id  = glyph_info[i].codepoint;
+        const Cached_glyph* font_char = get_glyph(glyph_id);
+        if ((font_char != nullptr) && (font_char->width != 0)) {
+            ++chars_printed;
         }
     }
 
     return chars_printed;
 }
 
-auto Font::measure(const std::string_view text) const -> Rectangle
+auto Font::measure(const std::string_view text) -> Rectangle
 {
     ERHE_PROFILE_FUNCTION();
 
@@ -735,18 +1013,15 @@ auto Font::measure(const std::string_view text) const -> Rectangle
         const float y_offset  = static_cast<float>(glyph_pos[i].y_offset ) / 64.0f;
         const float x_advance = static_cast<float>(glyph_pos[i].x_advance) / 64.0f;
         const float y_advance = static_cast<float>(glyph_pos[i].y_advance) / 64.0f;
-        const auto  j = m_glyph_to_char.find(glyph_id);
-        if (j != m_glyph_to_char.end()) {
-            const auto c = j->second;
-            const auto uc = static_cast<unsigned char>(c);
-            const ft_char& font_char = m_chars_256[uc];
-            if (font_char.width != 0) {
-                const float b  = static_cast<float>(font_char.g_bottom - font_char.b_bottom);
-                const float t  = static_cast<float>(font_char.g_top    - font_char.b_top);
-                const float w  = static_cast<float>(font_char.width);
-                const float h  = static_cast<float>(font_char.height);
-                const float ox = static_cast<float>(font_char.b_left);
-                const float oy = static_cast<float>(font_char.b_bottom + t + b);
+        const Cached_glyph* font_char = get_glyph(glyph_id);
+        if (font_char != nullptr) {
+            if (font_char->width != 0) {
+                const float b  = static_cast<float>(font_char->g_bottom - font_char->b_bottom);
+                const float t  = static_cast<float>(font_char->g_top    - font_char->b_top);
+                const float w  = static_cast<float>(font_char->width);
+                const float h  = static_cast<float>(font_char->height);
+                const float ox = static_cast<float>(font_char->b_left);
+                const float oy = static_cast<float>(font_char->b_bottom + t + b);
                 const float x0 = x + x_offset + ox;
                 const float y0 = y + y_offset + oy;
                 const float x1 = x0 + w;
@@ -769,15 +1044,15 @@ auto Font::print(
     uint32_t            ,
     Rectangle&          ,
     float
-) const -> size_t
+) -> size_t
 {
     return 0;
 }
-auto Font::get_glyph_count(const std::string_view) const -> size_t
+auto Font::get_glyph_count(const std::string_view) -> size_t
 {
     return 0;
 }
-auto Font::measure(const std::string_view text) const -> Rectangle
+auto Font::measure(const std::string_view text) -> Rectangle
 {
     static_cast<void>(text);
     return {};
@@ -3,13 +3,15 @@
 #include "erhe_graphics/texture.hpp"
 #include "erhe_ui/bitmap.hpp"
 #include "erhe_ui/rectangle.hpp"
+#include "erhe_ui/shelf_allocator.hpp"
 
-#include <array>
+#include <cstdint>
 #include <filesystem>
-#include <map>
 #include <memory>
 #include <span>
+#include <string>
 #include <string_view>
+#include <unordered_map>
 #include <vector>
 
 struct FT_LibraryRec_;
@@ -23,6 +25,16 @@ namespace erhe::graphics {
 
 namespace erhe::ui {
 
+// Glyphs are rasterized on demand: the first time harfbuzz emits a glyph
+// index, the glyph is rendered with FreeType into a fixed size atlas page
+// (Shelf_allocator). When the page is full, glyphs not used for a few
+// frames are evicted, least recently used first. New glyphs become visible
+// once upload_glyphs() has copied their atlas rectangles to the texture;
+// until then print() skips them.
+//
+// With use_glyph_cache_file, the glyphs resident when the Font is destroyed
+// are written to cache/fonts/ and the next Font with the same font file and
+// rasterization settings starts from them, without FreeType rasterization.
 class Font final
 {
 public:
@@ -35,7 +47,8 @@ public:
         erhe::graphics::Command_buffer& init_command_buffer,
         const std::filesystem::path&    path,
         unsigned int                    size,
-        float                           outline_thickness = 0.0f
+        float                           outline_thickness    = 0.0f,
+        bool                            use_glyph_cache_file = false
     );
 
     ~Font() noexcept;
@@ -45,6 +58,7 @@ public:
         return m_line_height;
     }
 
+    // The glyph functions below rasterize glyphs missing from the atlas.
     auto print(
         std::span<uint32_t> uint_data,
         std::string_view    text,
@@ -52,11 +66,19 @@ public:
         uint32_t            text_color,
         Rectangle&          out_bounds,
         float               y_scale = 1.0f
-    ) const -> size_t;
+    ) -> size_t;
 
-    [[nodiscard]] auto get_glyph_count(std::string_view text) const -> size_t;
+    [[nodiscard]] auto get_glyph_count(std::string_view text) -> size_t;
 
-    [[nodiscard]] auto measure(std::string_view text) const -> Rectangle;
+    [[nodiscard]] auto measure(std::string_view text) -> Rectangle;
+
+    // Records copies of the atlas rectangles of glyphs rasterized since the
+    // previous call. Must be called outside of a render pass.
+    void upload_glyphs(erhe::graphics::Command_buffer& command_buffer);
+
+    // Writes the glyph cache file, if enabled and glyphs were added since it
+    // was read. Also called by the destructor.
+    auto save_glyph_cache() -> bool;
 
     [[nodiscard]] auto texture() const -> erhe::graphics::Texture*
     {
@@ -85,11 +107,6 @@ public:
         return m_saturation;
     }
 
-    [[nodiscard]] auto chars() const -> const std::string&
-    {
-        return m_chars;
-    }
-
     [[nodiscard]] auto pixel_size() const -> unsigned int
     {
         return m_pixel_size;
@@ -125,11 +142,6 @@ public:
         m_saturation = value;
     }
 
-    void set_chars(const std::string& value)
-    {
-        m_chars = value;
-    }
-
     void set_pixel_size(unsigned int value)
     {
         m_pixel_size = value;
@@ -145,37 +157,51 @@ public:
         m_outline_thickness = value;
     }
 
+    // Sets up FreeType and harfbuzz, creates the atlas texture, reads the
+    // glyph cache file and records the initial texture upload.
     auto render(erhe::graphics::Command_buffer& init_command_buffer) -> bool;
 
-    void post_process(erhe::graphics::Command_buffer& init_command_buffer);
-
     void trace_info() const;
 
 private:
-
-    struct ft_char
-    {
-        int width    {0};
-        int height   {0};
-        int g_left   {0};
-        int g_bottom {0};
-        int g_top    {0};
-        int g_height {0};
-        int b_left   {0};
-        int b_bottom {0};
-        int b_top    {0};
-        bool rotated{false};
-        std::array<float, 4> u{0.0f, 0.0f, 0.0f, 0.0f};
-        std::array<float, 4> v{0.0f, 0.0f, 0.0f, 0.0f};
+    class Cached_glyph
+    {
+    public:
+        int                         width          {0}; // box of glyph and outlines
+        int                         height         {0};
+        int                         g_bottom       {0};
+        int                         g_top          {0};
+        int                         b_left         {0};
+        int                         b_bottom       {0};
+        int                         b_top          {0};
+        Shelf_allocator::Allocation atlas;              // glyph pixels start at (x + 1, y + 1)
+        std::uint64_t               last_used_frame{0};
+        bool                        resident       {false}; // atlas rectangle uploaded to m_texture
     };
 
-    erhe::graphics::Device&    m_graphics_device;
-
-    std::map<uint32_t, size_t> m_glyph_to_char;
-
-    ft_char               m_chars_256[256];
-    std::string           m_chars;
-    std::filesystem::path m_path;
+    [[nodiscard]] auto get_glyph           (uint32_t glyph_index) -> const Cached_glyph*;
+    [[nodiscard]] auto rasterize_glyph     (uint32_t glyph_index, std::uint64_t frame) -> const Cached_glyph*;
+    [[nodiscard]] auto allocate_atlas_rect (int width, int height, std::uint64_t frame) -> Shelf_allocator::Allocation;
+    [[nodiscard]] auto get_glyph_cache_path() const -> std::filesystem::path;
+    [[nodiscard]] auto load_glyph_cache    () -> bool;
+
+    static constexpr int           c_atlas_size          {1024};
+    // Glyphs used within this many frames are never evicted; their atlas
+    // rectangles may still be read by frames in flight.
+    static constexpr std::uint64_t c_eviction_frame_delay{4};
+    // More dirty rectangles than this are uploaded as their bounding box.
+    static constexpr std::size_t   c_max_upload_rect_count{32};
+
+    erhe::graphics::Device& m_graphics_device;
+
+    std::unordered_map<uint32_t, Cached_glyph> m_glyphs; // by glyph index
+    std::vector<uint32_t>                      m_pending_glyphs;
+    Shelf_allocator                            m_atlas_allocator{c_atlas_size - 1, c_atlas_size - 1};
+    std::vector<float>                         m_outline_sizes;
+    bool                                       m_use_glyph_cache_file{false};
+    bool                                       m_glyph_cache_dirty   {false};
+    bool                                       m_atlas_full_reported {false};
+    std::filesystem::path                      m_path;
 
     bool         m_hinting          {true};
     unsigned int m_dpi              {96};
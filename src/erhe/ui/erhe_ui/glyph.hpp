@@ -11,8 +11,6 @@
 #include <freetype/ftglyph.h>
 #include <freetype/ftbitmap.h>
 
-#include <Rect.h>
-
 #include <cstdio>
 #include <map>
 #include <stdexcept>
@@ -25,12 +23,12 @@ class Glyph
 {
 public:
     Glyph(
-        FT_Library    library,
-        FT_Face       font_face,
-        unsigned char c,
-        float         bolding,
-        float         outline_thickness,
-        int           hint_mode
+        FT_Library   library,
+        FT_Face      font_face,
+        unsigned int glyph_index,
+        float        bolding,
+        float        outline_thickness,
+        int          hint_mode
     );
 
     [[nodiscard]] auto buffer() const -> const std::vector<unsigned char>&
@@ -40,9 +38,7 @@ public:
 
     void dump() const;
 
-    rbp::Rect    atlas_rect       {0, 0, 0, 0};     // atlas space
     Rectangle    font_rect;      // font metric space
-    FT_ULong     char_code        {0};
     unsigned int glyph_index      {0};
     float        outline_thickness{0.0f};
 
@@ -0,0 +1,177 @@
+#include "erhe_ui/shelf_allocator.hpp"
+
+#include "erhe_verify/verify.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace erhe::ui {
+
+Shelf_allocator::Shelf_allocator(const int width, const int height)
+    : m_width {width}
+    , m_height{height}
+{
+}
+
+void Shelf_allocator::reset()
+{
+    m_shelves.clear();
+    m_used_height      = 0;
+    m_allocation_count = 0;
+}
+
+auto Shelf_allocator::allocate(const int width, const int height) -> Allocation
+{
+    if ((width <= 0) || (height <= 0) || (width > m_width) || (height > m_height)) {
+        return {};
+    }
+
+    const int shelf_height = ((height + c_height_granularity - 1) / c_height_granularity) * c_height_granularity;
+
+    // Best fit: the least vertical waste among shelves with a wide enough
+    // free span. First fit within a shelf.
+    int best_shelf_index = -1;
+    int best_span_index  = -1;
+    int best_waste       = std::numeric_limits<int>::max();
+    for (int shelf_index = 0, end = static_cast<int>(m_shelves.size()); shelf_index < end; ++shelf_index) {
+        const Shelf& shelf = m_shelves[shelf_index];
+        if (shelf.height < height) {
+            continue;
+        }
+        const int waste = shelf.height - height;
+        if (waste >= best_waste) {
+            continue;
+        }
+        for (int span_index = 0, span_end = static_cast<int>(shelf.free_spans.size()); span_index < span_end; ++span_index) {
+            if (shelf.free_spans[span_index].width >= width) {
+                best_shelf_index = shelf_index;
+                best_span_index  = span_index;
+                best_waste       = waste;
+                break;
+            }
+        }
+    }
+
+    // Rather open a new shelf than put a glyph on a shelf more than twice
+    // its height, while the page still has room.
+    const bool can_open_shelf = (m_used_height + shelf_height) <= m_height;
+    if ((best_shelf_index < 0) || ((best_waste > shelf_height) && can_open_shelf)) {
+        if (!can_open_shelf) {
+            return {};
+        }
+        m_shelves.push_back(
+            Shelf{
+                .y                = m_used_height,
+                .height           = shelf_height,
+                .allocation_count = 0,
+                .free_spans       = { Span{.x = 0, .width = m_width} }
+            }
+        );
+        m_used_height += shelf_height;
+        best_shelf_index = static_cast<int>(m_shelves.size()) - 1;
+        best_span_index  = 0;
+    }
+
+    Shelf& shelf = m_shelves[best_shelf_index];
+    Span&  span  = shelf.free_spans[best_span_index];
+    const Allocation allocation{
+        .x      = span.x,
+        .y      = shelf.y,
+        .width  = width,
+        .height = height,
+        .shelf  = best_shelf_index
+    };
+    span.x     += width;
+    span.width -= width;
+    if (span.width == 0) {
+        shelf.free_spans.erase(shelf.free_spans.begin() + best_span_index);
+    }
+    ++shelf.allocation_count;
+    ++m_allocation_count;
+    return allocation;
+}
+
+void Shelf_allocator::free(const Allocation& allocation)
+{
+    if (!allocation.is_valid()) {
+        return;
+    }
+    ERHE_VERIFY(allocation.shelf < static_cast<int>(m_shelves.size()));
+
+    Shelf& shelf = m_shelves[allocation.shelf];
+    ERHE_VERIFY(shelf.allocation_count > 0);
+
+    std::vector<Span>& spans = shelf.free_spans;
+    auto i = std::lower_bound(
+        spans.begin(),
+        spans.end(),
+        allocation.x,
+        [](const Span& span, const int x) { return span.x < x; }
+    );
+    i = spans.insert(i, Span{.x = allocation.x, .width = allocation.width});
+    const auto next = std::next(i);
+    if ((next != spans.end()) && (i->x + i->width == next->x)) {
+        i->width += next->width;
+        spans.erase(next);
+    }
+    if (i != spans.begin()) {
+        const auto previous = std::prev(i);
+        if (previous->x + previous->width == i->x) {
+            previous->width += i->width;
+            spans.erase(i);
+        }
+    }
+
+    --shelf.allocation_count;
+    --m_allocation_count;
+
+    // Empty shelves at the top go back to the page, so a different height
+    // can use the space. Only the topmost shelves are removed: indices of
+    // the remaining shelves, held by live allocations, stay valid.
+    while (!m_shelves.empty() && (m_shelves.back().allocation_count == 0)) {
+        m_used_height = m_shelves.back().y;
+        m_shelves.pop_back();
+    }
+}
+
+auto Shelf_allocator::allocate_evicting_lru(
+    const int                   width,
+    const int                   height,
+    const std::uint64_t         frame,
+    const std::uint64_t         eviction_frame_delay,
+    std::vector<Lru_entry>      entries,
+    std::vector<std::uint32_t>& evicted_keys
+) -> Allocation
+{
+    Allocation allocation = allocate(width, height);
+    if (allocation.is_valid()) {
+        return allocation;
+    }
+
+    std::erase_if(
+        entries,
+        [frame, eviction_frame_delay](const Lru_entry& entry) {
+            return !entry.allocation.is_valid() || (entry.last_used_frame + eviction_frame_delay >= frame);
+        }
+    );
+    std::sort(
+        entries.begin(),
+        entries.end(),
+        [](const Lru_entry& lhs, const Lru_entry& rhs) {
+            return (lhs.last_used_frame != rhs.last_used_frame)
+                ? (lhs.last_used_frame < rhs.last_used_frame)
+                : (lhs.key < rhs.key);
+        }
+    );
+    for (const Lru_entry& entry : entries) {
+        free(entry.allocation);
+        evicted_keys.push_back(entry.key);
+        allocation = allocate(width, height);
+        if (allocation.is_valid()) {
+            break;
+        }
+    }
+    return allocation;
+}
+
+} // namespace erhe::ui
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace erhe::ui {
+
+// Rectangle allocator for the Font glyph atlas. Unlike rbp::SkylineBinPack
+// it can free individual rectangles, which the glyph cache needs for LRU
+// eviction.
+//
+// The page is cut into horizontal shelves on demand, bottom up. Each shelf
+// keeps a sorted list of free horizontal spans; freeing a rectangle returns
+// its span and merges it with its neighbours. Shelf heights are rounded up
+// to c_height_granularity so glyphs of similar height share shelves. A
+// shelf that becomes empty can be reused for any rectangle that is not
+// taller than it, and empty shelves at the top are returned to the page.
+class Shelf_allocator
+{
+public:
+    class Allocation
+    {
+    public:
+        [[nodiscard]] auto is_valid() const -> bool
+        {
+            return shelf >= 0;
+        }
+
+        int x     {0};
+        int y     {0};
+        int width {0};
+        int height{0};
+        int shelf {-1};
+    };
+
+    // A rectangle the caller may give up to make room, keyed by the
+    // caller's own id (the glyph index, for the Font atlas).
+    class Lru_entry
+    {
+    public:
+        std::uint64_t last_used_frame{0};
+        std::uint32_t key            {0};
+        Allocation    allocation;
+    };
+
+    Shelf_allocator(int width, int height);
+
+    // Returns an invalid allocation when the rectangle does not fit.
+    [[nodiscard]] auto allocate(int width, int height) -> Allocation;
+    void free (const Allocation& allocation);
+    void reset();
+
+    // LRU eviction: like allocate(), but while the rectangle does not fit,
+    // frees the least recently used of entries and retries. Entries used
+    // within eviction_frame_delay frames of frame are never freed. The keys
+    // of freed entries are appended to evicted_keys; the caller drops its
+    // references to them. Returns an invalid allocation when the rectangle
+    // does not fit even after evicting every eligible entry.
+    [[nodiscard]] auto allocate_evicting_lru(
+        int                         width,
+        int                         height,
+        std::uint64_t               frame,
+        std::uint64_t               eviction_frame_delay,
+        std::vector<Lru_entry>      entries,
+        std::vector<std::uint32_t>& evicted_keys
+    ) -> Allocation;
+
+    [[nodiscard]] auto width() const -> int
+    {
+        return m_width;
+    }
+
+    [[nodiscard]] auto height() const -> int
+    {
+        return m_height;
+    }
+
+    [[nodiscard]] auto used_height() const -> int
+    {
+        return m_used_height;
+    }
+
+    [[nodiscard]] auto allocation_count() const -> int
+    {
+        return m_allocation_count;
+    }
+
+private:
+    static constexpr int c_height_granularity{4};
+
+    class Span
+    {
+    public:
+        int x    {0};
+        int width{0};
+    };
+
+    class Shelf
+    {
+    public:
+        int               y               {0};
+        int               height          {0};
+        int               allocation_count{0};
+        std::vector<Span> free_spans;
+    };
+
+    int                m_width           {0};
+    int                m_height          {0};
+    int                m_used_height     {0};
+    int                m_allocation_count{0};
+    std::vector<Shelf> m_shelves;
+};
+
+} // namespace erhe::ui
@@ -0,0 +1,221 @@
+// Shelf_allocator, the glyph atlas allocator of erhe::ui::Font: shelf
+// placement, freeing and span merging, page exhaustion, and the LRU
+// eviction Font uses when the atlas page is full. No graphics Device.
+
+#include "erhe_ui/shelf_allocator.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+
+using erhe::ui::Shelf_allocator;
+using Allocation = Shelf_allocator::Allocation;
+using Lru_entry  = Shelf_allocator::Lru_entry;
+
+auto overlaps(const Allocation& a, const Allocation& b) -> bool
+{
+    return
+        (a.x < b.x + b.width ) && (b.x < a.x + a.width ) &&
+        (a.y < b.y + b.height) && (b.y < a.y + a.height);
+}
+
+TEST(ShelfAllocator, RejectsInvalidSizes)
+{
+    Shelf_allocator allocator{64, 32};
+    EXPECT_FALSE(allocator.allocate( 0,  4).is_valid());
+    EXPECT_FALSE(allocator.allocate( 4,  0).is_valid());
+    EXPECT_FALSE(allocator.allocate(-1,  4).is_valid());
+    EXPECT_FALSE(allocator.allocate(65,  4).is_valid());
+    EXPECT_FALSE(allocator.allocate( 4, 33).is_valid());
+    EXPECT_EQ(allocator.allocation_count(), 0);
+    EXPECT_EQ(allocator.used_height(), 0);
+}
+
+TEST(ShelfAllocator, SimilarHeightsShareShelves)
+{
+    Shelf_allocator allocator{64, 64};
+
+    // Shelf heights are rounded up to multiples of 4
+    const Allocation a = allocator.allocate(10, 5);
+    ASSERT_TRUE(a.is_valid());
+    EXPECT_EQ(a.x, 0);
+    EXPECT_EQ(a.y, 0);
+    EXPECT_EQ(allocator.used_height(), 8);
+
+    const Allocation b = allocator.allocate(10, 7);
+    ASSERT_TRUE(b.is_valid());
+    EXPECT_EQ(b.shelf, a.shelf);
+    EXPECT_EQ(b.x, 10);
+    EXPECT_EQ(b.y, 0);
+
+    // Much taller: a new shelf above
+    const Allocation c = allocator.allocate(10, 20);
+    ASSERT_TRUE(c.is_valid());
+    EXPECT_NE(c.shelf, a.shelf);
+    EXPECT_EQ(c.y, 8);
+    EXPECT_EQ(allocator.used_height(), 28);
+
+    // Much shorter: a new shelf rather than one more than twice its height
+    const Allocation d = allocator.allocate(10, 2);
+    ASSERT_TRUE(d.is_valid());
+    EXPECT_EQ(d.y, 28);
+    EXPECT_EQ(allocator.allocation_count(), 4);
+}
+
+TEST(ShelfAllocator, FreeMergesSpans)
+{
+    Shelf_allocator allocator{30, 8};
+    const Allocation a = allocator.allocate(10, 8);
+    const Allocation b = allocator.allocate(10, 8);
+    const Allocation c = allocator.allocate(10, 8);
+    ASSERT_TRUE(a.is_valid() && b.is_valid() && c.is_valid());
+    EXPECT_FALSE(allocator.allocate(1, 1).is_valid());
+
+    // Two separate 10 wide holes do not fit 20
+    allocator.free(a);
+    allocator.free(c);
+    EXPECT_FALSE(allocator.allocate(20, 8).is_valid());
+
+    // Freeing b joins all three
+    allocator.free(b);
+    EXPECT_EQ(allocator.allocation_count(), 0);
+    const Allocation wide = allocator.allocate(30, 8);
+    ASSERT_TRUE(wide.is_valid());
+    EXPECT_EQ(wide.x, 0);
+}
+
+TEST(ShelfAllocator, EmptyTopShelvesReturnToPage)
+{
+    Shelf_allocator allocator{16, 16};
+    const Allocation low  = allocator.allocate(16, 8);
+    const Allocation high = allocator.allocate(16, 8);
+    ASSERT_TRUE(low.is_valid() && high.is_valid());
+    EXPECT_EQ(allocator.used_height(), 16);
+
+    // The page is full, so a 16 tall rectangle needs both shelves back
+    EXPECT_FALSE(allocator.allocate(16, 16).is_valid());
+    allocator.free(high);
+    EXPECT_EQ(allocator.used_height(), 8);
+    EXPECT_FALSE(allocator.allocate(16, 16).is_valid());
+    allocator.free(low);
+    EXPECT_EQ(allocator.used_height(), 0);
+    EXPECT_TRUE(allocator.allocate(16, 16).is_valid());
+
+    allocator.reset();
+    EXPECT_EQ(allocator.used_height(), 0);
+    EXPECT_EQ(allocator.allocation_count(), 0);
+}
+
+TEST(ShelfAllocator, RandomAllocationsStayDisjoint)
+{
+    Shelf_allocator         allocator{256, 256};
+    std::vector<Allocation> live;
+    std::mt19937            random{12345u};
+    std::uniform_int_distribution<int> size_distribution{1, 24};
+    for (int step = 0; step < 4000; ++step) {
+        if (!live.empty() && ((random() % 3u) == 0u)) {
+            const std::size_t index = random() % live.size();
+            allocator.free(live[index]);
+            live[index] = live.back();
+            live.pop_back();
+            continue;
+        }
+        const Allocation allocation = allocator.allocate(size_distribution(random), size_distribution(random));
+        if (!allocation.is_valid()) {
+            continue;
+        }
+        ASSERT_GE(allocation.x, 0);
+        ASSERT_GE(allocation.y, 0);
+        ASSERT_LE(allocation.x + allocation.width,  allocator.width());
+        ASSERT_LE(allocation.y + allocation.height, allocator.height());
+        for (const Allocation& other : live) {
+            ASSERT_FALSE(overlaps(allocation, other)) << "step " << step;
+        }
+        live.push_back(allocation);
+    }
+    EXPECT_EQ(allocator.allocation_count(), static_cast<int>(live.size()));
+}
+
+// One 16 x 8 shelf holding four 4 x 8 glyphs, keys 1 to 4, last used in
+// frames 1, 5, 3 and 10.
+class Lru_page
+{
+public:
+    Lru_page()
+    {
+        const std::uint64_t frames[] = {1, 5, 3, 10};
+        for (std::uint32_t key = 1; key <= 4; ++key) {
+            const Allocation allocation = allocator.allocate(4, 8);
+            EXPECT_TRUE(allocation.is_valid());
+            entries.push_back(Lru_entry{.last_used_frame = frames[key - 1], .key = key, .allocation = allocation});
+        }
+    }
+
+    Shelf_allocator        allocator{16, 8};
+    std::vector<Lru_entry> entries;
+};
+
+TEST(ShelfAllocator, LruEvictsOldestUntilItFits)
+{
+    Lru_page page;
+    std::vector<std::uint32_t> evicted;
+
+    // An 8 wide hole needs adjacent glyphs: freeing 1 (x 0) and 3 (x 8)
+    // leaves two 4 wide holes, so 2 (x 4) goes as well. 4 is kept.
+    const Allocation allocation = page.allocator.allocate_evicting_lru(8, 8, 20, 4, page.entries, evicted);
+    ASSERT_TRUE(allocation.is_valid());
+    EXPECT_EQ(allocation.x, 0);
+    EXPECT_EQ(evicted, (std::vector<std::uint32_t>{1, 3, 2}));
+    EXPECT_EQ(page.allocator.allocation_count(), 2);
+}
+
+TEST(ShelfAllocator, LruStopsAtFirstFit)
+{
+    Lru_page page;
+    std::vector<std::uint32_t> evicted;
+    const Allocation allocation = page.allocator.allocate_evicting_lru(4, 8, 20, 4, page.entries, evicted);
+    ASSERT_TRUE(allocation.is_valid());
+    EXPECT_EQ(evicted, (std::vector<std::uint32_t>{1}));
+
+    // No eviction at all while there is room
+    Shelf_allocator roomy{32, 8};
+    const Allocation first = roomy.allocate(4, 8);
+    evicted.clear();
+    EXPECT_TRUE(roomy.allocate_evicting_lru(4, 8, 20, 4, {Lru_entry{.last_used_frame = 0, .key = 1, .allocation = first}}, evicted).is_valid());
+    EXPECT_TRUE(evicted.empty());
+}
+
+TEST(ShelfAllocator, LruKeepsRecentlyUsed)
+{
+    // At frame 9 with a delay of 4, glyphs used in frames 5 and later are
+    // still read by frames in flight: only 1 and 3 may go, which does not
+    // make room for 12
+    Lru_page page;
+    std::vector<std::uint32_t> evicted;
+    EXPECT_FALSE(page.allocator.allocate_evicting_lru(12, 8, 9, 4, page.entries, evicted).is_valid());
+    EXPECT_EQ(evicted, (std::vector<std::uint32_t>{1, 3}));
+
+    // Everything recent: nothing evicted
+    Lru_page recent_page;
+    evicted.clear();
+    EXPECT_FALSE(recent_page.allocator.allocate_evicting_lru(4, 8, 4, 4, recent_page.entries, evicted).is_valid());
+    EXPECT_TRUE(evicted.empty());
+    EXPECT_EQ(recent_page.allocator.allocation_count(), 4);
+}
+
+TEST(ShelfAllocator, LruSkipsEntriesWithoutRectangles)
+{
+    // Font lists glyphs with no pixels (spaces) and glyphs that did not fit;
+    // they hold no rectangle to free
+    Lru_page page;
+    page.entries.push_back(Lru_entry{.last_used_frame = 0, .key = 100, .allocation = {}});
+    std::vector<std::uint32_t> evicted;
+    EXPECT_TRUE(page.allocator.allocate_evicting_lru(4, 8, 20, 4, page.entries, evicted).is_valid());
+    EXPECT_EQ(evicted, (std::vector<std::uint32_t>{1}));
+}
+
+} // anonymous namespace
@@ -425,6 +425,10 @@ void Map_window::render(erhe::graphics::Command_buffer& command_buffer)
     const auto& terrain_shapes = m_tile_renderer.get_terrain_shapes();
     const auto& unit_shapes    = m_tile_renderer.get_unit_shapes();
 
+    // Glyphs rasterized by print() / measure() since the previous frame must
+    // be uploaded outside of the render pass; print() skips them until then.
+    m_text_renderer.upload_glyphs(command_buffer);
+
     erhe::graphics::Render_command_encoder encoder = m_graphics_device.make_render_command_encoder(command_buffer);
     erhe::graphics::Scoped_render_pass scoped_render_pass{*m_render_pass.get(), command_buffer};
 